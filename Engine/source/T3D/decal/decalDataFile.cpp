@@ -26,6 +26,8 @@
 #include "math/mathIO.h"
 #include "core/tAlgorithm.h"
 #include "core/stream/fileStream.h"
+#include "core/stream/memStream.h"
+#include "core/util/endian.h"
 
 #include "T3D/decal/decalManager.h"
 #include "T3D/decal/decalData.h"
@@ -34,13 +36,13 @@
 template<>
 void* Resource<DecalDataFile>::create( const Torque::Path &path )
 {
-   FileStream stream;
-   stream.open( path.getFullPath(), Torque::FS::File::Read );
-   if ( stream.getStatus() != Stream::Ok )
+   // Map the file so that flat files can be loaded in place.
+   Torque::FS::MappedFile mappedFile;
+   if ( !mappedFile.open( path ) )
       return NULL;
 
    DecalDataFile *file = new DecalDataFile();
-   if ( !file->read( stream ) )
+   if ( !file->read( mappedFile.getData(), mappedFile.getSize() ) )
    {
       delete file;
       return NULL;
@@ -56,6 +58,36 @@ ResourceBase::Signature Resource<DecalDataFile>::signature()
 }
 
 
+//-----------------------------------------------------------------------------
+
+/// Finds the datablock for a decal read from disk, creating a
+/// stub for it if the datablock doesn't exist.
+static DecalData* _findDatablock( const String &lookupName )
+{
+   DecalData *data = DecalData::findDatablock( lookupName );
+
+   if ( !data )
+   {
+		char name[512];
+		dSprintf(name, 512, "%s_missing", lookupName.c_str());
+
+		DecalData *stubCheck = DecalData::findDatablock( name );
+		if( !stubCheck )
+		{
+			data = new DecalData;
+			data->lookupName = name;
+			data->registerObject(name);
+			Sim::getRootGroup()->addObject( data );
+			data->materialName = "WarningMaterial";
+			data->material = dynamic_cast<Material*>(Sim::findObject("WarningMaterial"));
+		
+			Con::errorf( "DecalDataFile::read() - DecalData %s does not exist! Temporarily created %s_missing.", lookupName.c_str() );
+		}
+   }
+
+   return data;
+}
+
 //-----------------------------------------------------------------------------
 
 DecalDataFile::DecalDataFile()
@@ -95,20 +127,30 @@ bool DecalDataFile::write( Stream& stream )
    // This identifier stands for "Torque Decal Data File".
    stream.write( 4, "TDDF" );
 
-   // Now the version number.
+   // Now the version number and the padding
+   // which aligns the rest of the header.
    stream.write( (U8)FILE_VERSION );
+   const U8 pad[3] = { 0 };
+   stream.write( 3, pad );
 
    Vector<DecalInstance*> allDecals;
+   Vector<const DecalSphere*> allSpheres;
 
-   // Gather all DecalInstances that should be saved.
+   // Gather all DecalInstances that should be saved
+   // along with the spheres that contain them.
    for ( U32 i = 0; i < mSphereList.size(); i++ )  
    {      
+      const U32 firstDecal = allDecals.size();
+
       Vector<DecalInstance*>::const_iterator item = mSphereList[i]->mItems.begin();
       for ( ; item != mSphereList[i]->mItems.end(); item++ )
       {
          if ( (*item)->mFlags & SaveDecal )
             allDecals.push_back( (*item) );
       }
+
+      if ( allDecals.size() > firstDecal )
+         allSpheres.push_back( mSphereList[i] );
    }
 
    // Gather all the DecalData datablocks used.
@@ -116,31 +158,65 @@ bool DecalDataFile::write( Stream& stream )
    for ( U32 i = 0; i < allDecals.size(); i++ )
       allDatablocks.push_back_unique( allDecals[i]->mDataBlock );
 
-   // Write out datablock lookupNames.
-   U32 count = allDatablocks.size();
-   stream.write( count );
-   for ( U32 i = 0; i < count; i++ )
-      stream.write( allDatablocks[i]->lookupName );
+   // The arrays follow the header and the datablock names
+   // come last, so that the arrays are aligned in memory.
+   const U32 spheresOffset = sizeof( FlatHeader );
+   const U32 decalsOffset = spheresOffset + allSpheres.size() * sizeof( FlatSphere );
+   const U32 namesOffset = decalsOffset + allDecals.size() * sizeof( FlatDecal );
+
+   stream.write( (U32)allSpheres.size() );
+   stream.write( spheresOffset );
+   stream.write( (U32)allDecals.size() );
+   stream.write( decalsOffset );
+   stream.write( (U32)allDatablocks.size() );
+   stream.write( namesOffset );
+
+   // Write out the spheres.
+   U32 firstDecal = 0;
+   for ( U32 i = 0; i < allSpheres.size(); i++ )
+   {
+      const DecalSphere *sphere = allSpheres[i];
+
+      U32 count = 0;
+      for ( U32 j = 0; j < sphere->mItems.size(); j++ )
+      {
+         if ( sphere->mItems[j]->mFlags & SaveDecal )
+            count++;
+      }
+
+      mathWrite( stream, sphere->mWorldSphere.center );
+      stream.write( sphere->mWorldSphere.radius );
+      stream.write( firstDecal );
+      stream.write( count );
+
+      firstDecal += count;
+   }
 
    Vector<const DecalData*>::iterator dataIter;
 
    // Write out the DecalInstance list.
-   count = allDecals.size();
-   stream.write( count );
-   for ( U32 i = 0; i < count; i++ )
+   for ( U32 i = 0; i < allDecals.size(); i++ )
    {
       DecalInstance *inst = allDecals[i];
 
       dataIter = find( allDatablocks.begin(), allDatablocks.end(), inst->mDataBlock );
-      U8 dataIndex = dataIter - allDatablocks.begin();
+      U32 dataIndex = dataIter - allDatablocks.begin();
       
       stream.write( dataIndex );
       mathWrite( stream, inst->mPosition );
       mathWrite( stream, inst->mNormal );
       mathWrite( stream, inst->mTangent );
-		stream.write( inst->mTextureRectIdx );   
       stream.write( inst->mSize );
+      stream.write( inst->mTextureRectIdx );   
       stream.write( inst->mRenderPriority );
+      stream.write( 3, pad );
+   }
+
+   // Write out datablock lookupNames.
+   for ( U32 i = 0; i < allDatablocks.size(); i++ )
+   {
+      const String &lookupName = allDatablocks[i]->lookupName;
+      stream.write( lookupName.length() + 1, lookupName.c_str() );
    }
 
    // Clear the dirty flag.
@@ -175,13 +251,28 @@ bool DecalDataFile::read( Stream &stream )
    // Now the version number.
    U8 version;
    stream.read( &version );
-   if ( version != (U8)FILE_VERSION )
+   if ( version != (U8)FILE_VERSION_STREAM && version != (U8)FILE_VERSION_FLAT )
    {
       Con::errorf( "DecalDataFile::read() - file versions do not match!" );
       Con::errorf( "You must manually delete the old .decals file before continuing!" );
       return false;
    }
 
+   // Flat files are read in one go and loaded from memory.
+   if ( version == (U8)FILE_VERSION_FLAT )
+   {
+      const U32 size = stream.getStreamSize();
+      Vector<U8> buffer;
+      buffer.setSize( size );
+      if ( !stream.setPosition( 0 ) || !stream.read( size, buffer.address() ) )
+      {
+         Con::errorf( "DecalDataFile::read() - Failed reading the file!" );
+         return false;
+      }
+
+      return _readFlat( buffer.address(), size );
+   }
+
    // Read in the lookupNames of the DecalData datablocks and recover the datablock.   
    Vector<DecalData*> allDatablocks;
    U32 count;
@@ -192,28 +283,7 @@ bool DecalDataFile::read( Stream &stream )
       String lookupName;      
       stream.read( &lookupName );
       
-      DecalData *data = DecalData::findDatablock( lookupName );
-
-      if ( !data )
-      {
-			char name[512];
-			dSprintf(name, 512, "%s_missing", lookupName.c_str());
-
-			DecalData *stubCheck = DecalData::findDatablock( name );
-			if( !stubCheck )
-			{
-				data = new DecalData;
-				data->lookupName = name;
-				data->registerObject(name);
-				Sim::getRootGroup()->addObject( data );
-				data->materialName = "WarningMaterial";
-				data->material = dynamic_cast<Material*>(Sim::findObject("WarningMaterial"));
-			
-				Con::errorf( "DecalDataFile::read() - DecalData %s does not exist! Temporarily created %s_missing.", lookupName.c_str() );
-			}
-      }
-		
-		allDatablocks[ i ] = data;
+		allDatablocks[ i ] = _findDatablock( lookupName );
    }
 
    U8 dataIndex;   
@@ -268,6 +338,170 @@ bool DecalDataFile::read( Stream &stream )
 
 //-----------------------------------------------------------------------------
 
+bool DecalDataFile::read( const U8 *data, U32 size )
+{
+   if ( size < 5 )
+   {
+      Con::errorf( "DecalDataFile::read() - This is not a Decal file!" );
+      return false;
+   }
+
+   if (  size >= sizeof( FlatHeader ) &&
+         dMemcmp( data, "TDDF", 4 ) == 0 &&
+         data[4] == (U8)FILE_VERSION_FLAT )
+      return _readFlat( data, size );
+
+   // Older files are read thru a stream on the memory.
+   MemStream stream( size, const_cast<U8*>( data ), true, false );
+   return read( stream );
+}
+
+//-----------------------------------------------------------------------------
+
+bool DecalDataFile::_readFlat( const U8 *buffer, U32 size )
+{
+   PROFILE_SCOPE( DecalDataFile_readFlat );
+
+   const FlatHeader *header = (const FlatHeader*)buffer;
+   if ( size < sizeof( FlatHeader ) || dMemcmp( header->id, "TDDF", 4 ) != 0 )
+   {
+      Con::errorf( "DecalDataFile::read() - This is not a Decal file!" );
+      return false;
+   }
+
+   const U32 sphereCount = convertLEndianToHost( header->sphereCount );
+   const U32 spheresOffset = convertLEndianToHost( header->spheresOffset );
+   const U32 decalCount = convertLEndianToHost( header->decalCount );
+   const U32 decalsOffset = convertLEndianToHost( header->decalsOffset );
+   const U32 datablockCount = convertLEndianToHost( header->datablockCount );
+   const U32 namesOffset = convertLEndianToHost( header->datablockNamesOffset );
+
+   // Validate the layout before we touch any of it.
+   if (  spheresOffset > size || ( spheresOffset & 3 ) != 0 ||
+         sphereCount > ( size - spheresOffset ) / sizeof( FlatSphere ) ||
+         decalsOffset > size || ( decalsOffset & 3 ) != 0 ||
+         decalCount > ( size - decalsOffset ) / sizeof( FlatDecal ) ||
+         namesOffset > size )
+   {
+      Con::errorf( "DecalDataFile::read() - The file is truncated or corrupt!" );
+      return false;
+   }
+
+   // Empty ourselves before we really begin reading.
+   clear();
+
+   // Recover the datablocks from their null terminated lookupNames.
+   Vector<DecalData*> allDatablocks;
+   allDatablocks.setSize( datablockCount );
+
+   const char *name = (const char*)( buffer + namesOffset );
+   const char *end = (const char*)( buffer + size );
+   for ( U32 i = 0; i < datablockCount; i++ )
+   {
+      const char *nameEnd = name;
+      while ( nameEnd < end && *nameEnd )
+         nameEnd++;
+
+      if ( nameEnd == end )
+      {
+         Con::errorf( "DecalDataFile::read() - The file is truncated or corrupt!" );
+         return false;
+      }
+
+      allDatablocks[ i ] = _findDatablock( String( name ) );
+      name = nameEnd + 1;
+   }
+
+   const FlatSphere *flatSpheres = (const FlatSphere*)( buffer + spheresOffset );
+   const FlatDecal *flatDecals = (const FlatDecal*)( buffer + decalsOffset );
+
+   const U32 createTime = Sim::getCurrentTime();
+
+   // The spheres were saved with their decals, so we can
+   // skip searching for a sphere to put each decal in.
+   mSphereList.reserve( sphereCount );
+   for ( U32 i = 0; i < sphereCount; i++ )
+   {
+      const FlatSphere &flatSphere = flatSpheres[i];
+
+      const U32 firstDecal = convertLEndianToHost( flatSphere.firstDecal );
+      const U32 count = convertLEndianToHost( flatSphere.decalCount );
+      if ( firstDecal > decalCount || count > decalCount - firstDecal )
+      {
+         Con::errorf( "DecalDataFile::read() - The file is truncated or corrupt!" );
+         return false;
+      }
+
+      const Point3F center(   convertLEndianToHost( flatSphere.center[0] ),
+                              convertLEndianToHost( flatSphere.center[1] ),
+                              convertLEndianToHost( flatSphere.center[2] ) );
+
+      DecalSphere *sphere = new DecalSphere( center, convertLEndianToHost( flatSphere.radius ) );
+      sphere->mItems.reserve( count );
+
+      for ( U32 j = 0; j < count; j++ )
+      {
+         const FlatDecal &flat = flatDecals[ firstDecal + j ];
+
+         const U32 dataIndex = convertLEndianToHost( flat.dataIndex );
+         DecalData *data = dataIndex < datablockCount ? allDatablocks[ dataIndex ] : NULL;
+         if ( !data )
+         {
+            Con::errorf( "DecalDataFile::read - cannot find DecalData for DecalInstance read from disk." );
+            continue;
+         }
+
+         DecalInstance *inst = _allocateInstance();
+
+         inst->mDataBlock = data;
+         inst->mPosition.set( convertLEndianToHost( flat.pos[0] ), convertLEndianToHost( flat.pos[1] ), convertLEndianToHost( flat.pos[2] ) );
+         inst->mNormal.set( convertLEndianToHost( flat.normal[0] ), convertLEndianToHost( flat.normal[1] ), convertLEndianToHost( flat.normal[2] ) );
+         inst->mTangent.set( convertLEndianToHost( flat.tangent[0] ), convertLEndianToHost( flat.tangent[1] ), convertLEndianToHost( flat.tangent[2] ) );
+         inst->mSize = convertLEndianToHost( flat.size );
+         inst->mTextureRectIdx = convertLEndianToHost( flat.textureRectIdx );
+         inst->mRenderPriority = flat.renderPriority;
+
+         inst->mVisibility = 1.0f;
+         inst->mLastAlpha = -1.0f;
+         inst->mFlags = PermanentDecal | SaveDecal | ClipDecal;
+         inst->mCreateTime = createTime;
+         inst->mVerts = NULL;
+         inst->mIndices = NULL;
+         inst->mVertCount = 0;
+         inst->mIndxCount = 0;
+         inst->mGeometryVersion = 0;
+         inst->mCustomTex = NULL;
+
+         sphere->mItems.push_back( inst );
+
+         // onload set instances should get added to the appropriate vec
+         inst->mId = gDecalManager->mDecalInstanceVec.size();
+         gDecalManager->mDecalInstanceVec.push_back( inst );
+      }
+
+      if ( sphere->mItems.empty() )
+      {
+         delete sphere;
+         continue;
+      }
+
+      // Shrink the sphere if we lost some decals.
+      if ( sphere->mItems.size() != count )
+         sphere->updateWorldSphere();
+
+      mSphereList.push_back( sphere );
+   }
+
+   mSphereWithLastInsertion = mSphereList.empty() ? NULL : mSphereList.last();
+
+   // Clear the dirty flag.
+   mIsDirty = false;
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
 DecalInstance* DecalDataFile::addDecal( const Point3F& pos, const Point3F& normal, const Point3F& tangent,
                                         DecalData* decalData, F32 decalScale, S32 decalTexIndex, U8 flags )
 {
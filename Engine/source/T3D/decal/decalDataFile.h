@@ -48,7 +48,60 @@ class DecalDataFile
 {
    protected:
 
-      enum { FILE_VERSION = 5 };
+      /// Version 5 files are read decal by decal from a stream and the
+      /// spheres are rebuilt.  Version 6 files store the spheres and
+      /// decals in flat arrays which are read in place from a memory
+      /// mapped file.
+      enum 
+      {
+         FILE_VERSION_STREAM = 5,
+         FILE_VERSION_FLAT = 6,
+         FILE_VERSION = FILE_VERSION_FLAT
+      };
+
+      /// The header of the flat file format.  All values
+      /// are little endian and the arrays are 4 byte aligned.
+      struct FlatHeader
+      {
+         char id[4];
+         U8 version;
+         U8 pad[3];
+
+         U32 sphereCount;
+         U32 spheresOffset;
+
+         U32 decalCount;
+         U32 decalsOffset;
+
+         U32 datablockCount;
+         U32 datablockNamesOffset;
+      };
+
+      /// A sphere of the flat file format.  Its decals
+      /// are stored contiguously in the decal array.
+      struct FlatSphere
+      {
+         F32 center[3];
+         F32 radius;
+         U32 firstDecal;
+         U32 decalCount;
+      };
+
+      /// A decal of the flat file format.
+      struct FlatDecal
+      {
+         U32 dataIndex;
+         F32 pos[3];
+         F32 normal[3];
+         F32 tangent[3];
+         F32 size;
+         U32 textureRectIdx;
+         U8 renderPriority;
+         U8 pad[3];
+      };
+
+      /// Loads a flat file from memory.
+      bool _readFlat( const U8 *data, U32 size );
 
       /// Set to true if the file is dirty and
       /// needs to be saved before being destroyed.
@@ -112,6 +165,10 @@ class DecalDataFile
       /// Read the decal data from the given stream.
       bool read( Stream& stream );
 
+      /// Read the decal data from memory.  Flat files are
+      /// consumed in place without any stream reads.
+      bool read( const U8 *data, U32 size );
+
       /// @}
 
       /// @name Decal Management
@@ -56,6 +56,10 @@ class DecalInstance
 
       F32 mLastAlpha;
 
+      /// Whether the alpha of the decal's current geometry changed
+      /// in the last prepRenderImage().
+      bool mFading;
+
       U32 mTextureRectIdx;      
 
       DecalVertex *mVerts;
@@ -64,6 +68,10 @@ class DecalInstance
       U32 mVertCount;
       U32 mIndxCount;
 
+      /// Changes whenever new geometry is allocated for the decal, so
+      /// the DecalManager knows which decals it has to upload again.
+      U32 mGeometryVersion;
+
       U8 mFlags;
 
       U8 mRenderPriority;
@@ -87,7 +95,7 @@ class DecalInstance
       /// Calculates the size of this decal onscreen in pixels, used for LOD.
       F32 calcPixelSize( U32 viewportHeight, const Point3F &cameraPos, F32 worldToScreenScaleY ) const;
    		
-	   DecalInstance() : mId(-1) {}   
+	   DecalInstance() : mFading(false), mGeometryVersion(0), mId(-1) {}   
 };
 
 #endif // _DECALINSTANCE_H_
@@ -48,6 +48,9 @@
 #include "core/module.h"
 #include "T3D/decal/decalData.h"
 #include "console/engineAPI.h"
+#include "platform/threads/threadPool.h"
+#include "collision/concretePolyList.h"
+#include "platform/platformIntrinsics.h"
 
 
 extern bool gEditingMission;
@@ -81,9 +84,15 @@ bool      DecalManager::smDecalsOn = true;
 bool      DecalManager::smDebugRender = false;
 F32       DecalManager::smDecalLifeTimeScale = 1.0f;
 bool      DecalManager::smPoolBuffers = true;
+bool      DecalManager::smCacheBuffers = true;
+bool      DecalManager::smAsyncClipping = true;
 const U32 DecalManager::smMaxVerts = 6000;
 const U32 DecalManager::smMaxIndices = 10000;
 
+/// Incremented for each geometry allocation so a decal recycled
+/// at the same address never gets an earlier version.
+static U32 gDecalGeometryVersion = 0;
+
 DecalManager *gDecalManager = NULL;
 
 IMPLEMENT_CONOBJECT(DecalManager);
@@ -227,6 +236,8 @@ DecalManager::DecalManager()
 
    mDirty = false;
 
+   mPrepCount = 0;
+
    mChunkers[0] = new FreeListChunkerUntyped( SIZE_CLASS_0 * sizeof( U8 ) );
    mChunkers[1] = new FreeListChunkerUntyped( SIZE_CLASS_1 * sizeof( U8 ) );
    mChunkers[2] = new FreeListChunkerUntyped( SIZE_CLASS_2 * sizeof( U8 ) );
@@ -261,6 +272,17 @@ void DecalManager::consoleInit()
       "If false, will just clear them at the end of a frame.\n"
       "@ingroup Decals" );
 
+   Con::addVariable( "$Decals::cacheBuffers", TypeBool, &smCacheBuffers,
+      "If true, batches of decals keep their buffers between frames and only "
+      "decals whose geometry or fade changed are uploaded again.\n"
+      "If false, all visible decals are copied into dynamic buffers each frame.\n"
+      "@ingroup Decals" );
+
+   Con::addVariable( "$Decals::asyncClipping", TypeBool, &smAsyncClipping,
+      "If true, new decals are clipped against the scene on the thread pool and "
+      "show up once their geometry is ready.\n"
+      "@ingroup Decals" );
+
    Con::addVariable( "$Decals::debugRender", TypeBool, &smDebugRender,
       "If true, the decal spheres will be visualized when in the editor.\n\n"
       "@ingroup Decals" );
@@ -297,6 +319,8 @@ bool DecalManager::_handleGFXEvent(GFXDevice::GFXDeviceEventType event)
          _freePools();
       }
 
+      _recycleBatchBuffers();
+
       break;
       
    default: ;
@@ -305,13 +329,154 @@ bool DecalManager::_handleGFXEvent(GFXDevice::GFXDeviceEventType event)
    return true;
 }
 
-bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts, const Point2F *clipDepth )
+/// The state needed to clip the gathered polys and build the decal
+/// geometry, copied out of the DecalInstance so the clipping jobs
+/// don't touch it.
+struct DecalClipParams
 {
-   PROFILE_SCOPE( DecalManager_clipDecal );
+   /// The planes around the decal which the polys are clipped to.
+   PlaneF planes[6];
 
-   // Free old verts and indices.
-   _freeBuffers( decal );
+   /// Polys facing away from the decal normal by more than
+   /// the clipping angle are rejected.
+   VectorF normal;
+   F32 normalTolCosineRadians;
+
+   /// The world box the polys are gathered from.
+   Box3F box;
+   U32 clippingMasks;
+
+   /// Transforms world space points into decal space.
+   MatrixF worldToDecal;
+
+   Point3F halfSize;
+
+   /// The decal space quad which is mapped onto the texture rect.
+   Point2F quad[4];
+
+   RectF texRect;
+
+   bool generateNormals;
+};
+
+/// The scene polys around a decal, gathered unclipped on the main
+/// thread.  Keeps the vertex normals the meshes pass in, which the
+/// clipper would have used.
+class DecalClipPolyList : public ConcretePolyList
+{
+   typedef ConcretePolyList Parent;
+
+public:
 
+   Vector<VectorF> mNormalList;
+
+   void clear()
+   {
+      Parent::clear();
+      mNormalList.clear();
+   }
+
+   // ConcretePolyList
+   virtual U32 addPoint( const Point3F &p )
+   {
+      return addPointAndNormal( p, Point3F::Zero );
+   }
+
+   virtual U32 addPointAndNormal( const Point3F &p, const Point3F &normal )
+   {
+      const U32 index = Parent::addPoint( p );
+
+      mNormalList.increment();
+      VectorF &n = mNormalList.last();
+      n = normal;
+      if ( !n.isZero() )
+         mMatrix.mulV( n );
+
+      return index;
+   }
+};
+
+/// Clips and triangulates the polys gathered for a decal and
+/// builds its vertices and indices on the ThreadPool.
+struct DecalClipItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   /// The decal the geometry is for.  Only used on the main thread
+   /// and cleared if the decal is removed or clipped again.
+   DecalInstance *mDecal;
+
+   DecalClipParams mParams;
+   DecalClipPolyList mPolys;
+
+   ClippedPolyList mClipper;
+
+   Vector<DecalVertex> mVerts;
+   Vector<U16> mIndices;
+
+   /// Set by the worker when the geometry is built.
+   volatile U32 mFinished;
+
+   DecalClipItem( DecalInstance *decal )
+      :  mDecal( decal ),
+         mFinished( 0 )
+   {
+   }
+
+   bool isFinished()
+   {
+      return dAtomicRead( mFinished ) != 0;
+   }
+
+protected:
+
+   /// Feeds the gathered polys to the clipper as the
+   /// scene objects would have.
+   void _clipPolys()
+   {
+      DecalManager::_setupClipper( mParams, &mClipper );
+
+      // The gathered points are already in world space.
+      for ( U32 i = 0; i < mPolys.mVertexList.size(); i++ )
+         mClipper.addPointAndNormal( mPolys.mVertexList[i], mPolys.mNormalList[i] );
+
+      for ( U32 i = 0; i < mPolys.mPolyList.size(); i++ )
+      {
+         const ConcretePolyList::Poly &poly = mPolys.mPolyList[i];
+
+         mClipper.setObject( poly.object );
+         mClipper.begin( poly.material, poly.surfaceKey );
+
+         // Only shadows turn off ClippedPolyList::allowClipping,
+         // so don't read it from here.
+         mClipper.mPolyList.last().polyFlags = CLIPPEDPOLYLIST_FLAG_ALLOWCLIPPING;
+
+         mClipper.plane( poly.plane );
+         for ( U32 j = 0; j < poly.vertexCount; j++ )
+            mClipper.vertex( mPolys.mIndexList[ poly.vertexStart + j ] );
+         mClipper.end();
+      }
+   }
+
+   virtual void execute()
+   {
+      _clipPolys();
+
+      if ( DecalManager::_triangulateClipPolys( &mClipper, mParams ) )
+      {
+         mVerts.setSize( mClipper.mVertexList.size() );
+         mIndices.setSize( mClipper.mIndexList.size() );
+         DecalManager::_fillClipGeometry( mClipper, mParams, mVerts.address(), mIndices.address() );
+      }
+
+      dTestAndSet( mFinished );
+   }
+};
+
+typedef ThreadSafeRef<DecalClipItem> DecalClipItemRef;
+
+void DecalManager::_getClipParams( DecalInstance *decal, const Point2F *clipDepth, DecalClipParams *outParams )
+{
    F32 halfSize = decal->mSize * 0.5f;
    
    // Ugly hack for ProjectedShadow!
@@ -335,34 +500,75 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
    VectorF objUp( 0, 0, 1.0f );
 
    // See above re: decalHalfSizeZ hack.
-   mClipper.clear();
-   mClipper.mPlaneList.setSize(6);
-   mClipper.mPlaneList[0].set( ( decalPos + ( -newRight * halfSize ) ), -newRight );
-   mClipper.mPlaneList[1].set( ( decalPos + ( -newFwd * halfSize ) ), -newFwd );
-   mClipper.mPlaneList[2].set( ( decalPos + ( -crossVec * decalHalfSizeZ ) ), -crossVec );
-   mClipper.mPlaneList[3].set( ( decalPos + ( newRight * halfSize ) ), newRight );
-   mClipper.mPlaneList[4].set( ( decalPos + ( newFwd * halfSize ) ), newFwd );
-   mClipper.mPlaneList[5].set( ( decalPos + ( crossVec * negHalfSize ) ), crossVec );
+   PlaneF *planes = outParams->planes;
+   planes[0].set( ( decalPos + ( -newRight * halfSize ) ), -newRight );
+   planes[1].set( ( decalPos + ( -newFwd * halfSize ) ), -newFwd );
+   planes[2].set( ( decalPos + ( -crossVec * decalHalfSizeZ ) ), -crossVec );
+   planes[3].set( ( decalPos + ( newRight * halfSize ) ), newRight );
+   planes[4].set( ( decalPos + ( newFwd * halfSize ) ), newFwd );
+   planes[5].set( ( decalPos + ( crossVec * negHalfSize ) ), crossVec );
 
-   mClipper.mNormal = decal->mNormal;
+#ifdef DECALMANAGER_DEBUG
+   mDebugPlanes.setSize( 6 );
+   for ( U32 i = 0; i < 6; i++ )
+      mDebugPlanes[i] = planes[i];
+#endif
+
+   outParams->normal = decal->mNormal;
 
    const DecalData *decalData = decal->mDataBlock;
 
-   mClipper.mNormalTolCosineRadians = mCos( mDegToRad( decalData->clippingAngle ) );
+   outParams->normalTolCosineRadians = mCos( mDegToRad( decalData->clippingAngle ) );
 
-   Box3F box( -decalHalfSizeZ, decalHalfSizeZ );
+   outParams->box.set( -decalHalfSizeZ, decalHalfSizeZ );
+   projMat.mul( outParams->box );
+   outParams->clippingMasks = decalData->clippingMasks;
 
-   projMat.mul( box );
+   Vector<Point3F> tmpPoints;
 
-   PROFILE_START( DecalManager_clipDecal_buildPolyList );
-   getContainer()->buildPolyList( PLC_Decal, box, decalData->clippingMasks, &mClipper );   
-   PROFILE_END();
+   tmpPoints.push_back(( objFwd * decalHalfSize ) + ( objRight * decalHalfSize ));
+   tmpPoints.push_back(( objFwd * decalHalfSize ) + ( -objRight * decalHalfSize ));
+   tmpPoints.push_back(( -objFwd * decalHalfSize ) + ( -objRight * decalHalfSize ));
+   
+   Point3F lowerLeft(( -objFwd * decalHalfSize ) + ( objRight * decalHalfSize ));
+
+   _generateWindingOrder( lowerLeft, &tmpPoints );
+
+   outParams->quad[0].set( lowerLeft.x, lowerLeft.y );
+   for ( U32 i = 0; i < 3; i++ )
+      outParams->quad[i + 1].set( tmpPoints[i].x, tmpPoints[i].y );
+
+   projMat.inverse();
+   outParams->worldToDecal = projMat;
+   outParams->halfSize = decalHalfSize;
+   outParams->texRect = decalData->texRect[decal->mTextureRectIdx];
+   outParams->generateNormals = !decalData->skipVertexNormals;
+}
+
+void DecalManager::_gatherClipPolys( const DecalClipParams &params, AbstractPolyList *polyList )
+{
+   PROFILE_SCOPE( DecalManager_clipDecal_buildPolyList );
+   getContainer()->buildPolyList( PLC_Decal, params.box, params.clippingMasks, polyList );
+}
+
+void DecalManager::_setupClipper( const DecalClipParams &params, ClippedPolyList *clipper )
+{
+   clipper->clear();
+   clipper->mPlaneList.setSize( 6 );
+   for ( U32 i = 0; i < 6; i++ )
+      clipper->mPlaneList[i] = params.planes[i];
 
-   mClipper.cullUnusedVerts();
-   mClipper.triangulate();
+   clipper->mNormal = params.normal;
+   clipper->mNormalTolCosineRadians = params.normalTolCosineRadians;
+}
+
+bool DecalManager::_triangulateClipPolys( ClippedPolyList *clipper, const DecalClipParams &params )
+{
+   clipper->cullUnusedVerts();
+   clipper->triangulate();
    
-   const U32 numVerts = mClipper.mVertexList.size();
-   const U32 numIndices = mClipper.mIndexList.size();
+   const U32 numVerts = clipper->mVertexList.size();
+   const U32 numIndices = clipper->mIndexList.size();
 
    if ( !numVerts || !numIndices )
       return false;
@@ -373,55 +579,32 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
         numIndices > smMaxIndices )
       return false;
 
-   if ( !decalData->skipVertexNormals )
-      mClipper.generateNormals();
-   
-#ifdef DECALMANAGER_DEBUG
-   mDebugPlanes.clear();
-   mDebugPlanes.merge( mClipper.mPlaneList );
-#endif
-
-   decal->mVertCount = numVerts;
-   decal->mIndxCount = numIndices;
-   
-   Vector<Point3F> tmpPoints;
-
-   tmpPoints.push_back(( objFwd * decalHalfSize ) + ( objRight * decalHalfSize ));
-   tmpPoints.push_back(( objFwd * decalHalfSize ) + ( -objRight * decalHalfSize ));
-   tmpPoints.push_back(( -objFwd * decalHalfSize ) + ( -objRight * decalHalfSize ));
-   
-   Point3F lowerLeft(( -objFwd * decalHalfSize ) + ( objRight * decalHalfSize ));
+   if ( params.generateNormals )
+      clipper->generateNormals();
 
-   projMat.inverse();
+   return true;
+}
 
-   _generateWindingOrder( lowerLeft, &tmpPoints );
+void DecalManager::_fillClipGeometry( const ClippedPolyList &clipper, const DecalClipParams &params, DecalVertex *outVerts, U16 *outIndices )
+{
+   BiQuadToSqr quadToSquare( params.quad[0], params.quad[1], params.quad[2], params.quad[3] );
 
-   BiQuadToSqr quadToSquare( Point2F( lowerLeft.x, lowerLeft.y ),
-                             Point2F( tmpPoints[0].x, tmpPoints[0].y ), 
-                             Point2F( tmpPoints[1].x, tmpPoints[1].y ), 
-                             Point2F( tmpPoints[2].x, tmpPoints[2].y ) );  
+   const Point3F &decalHalfSize = params.halfSize;
+   const RectF &rect = params.texRect;
 
    Point2F uv( 0, 0 );
    Point3F vecX(0.0f, 0.0f, 0.0f);
-
-   // Allocate memory for vert and index arrays
-   _allocBuffers( decal );  
-
-   // Mark this so that the color will be assigned on these verts the next
-   // time it renders, since we just threw away the previous verts.
-   decal->mLastAlpha = -1;
-   
    Point3F vertPoint( 0, 0, 0 );
 
-   for ( U32 i = 0; i < mClipper.mVertexList.size(); i++ )
+   for ( U32 i = 0; i < clipper.mVertexList.size(); i++ )
    {
-      const ClippedPolyList::Vertex &vert = mClipper.mVertexList[i];
+      const ClippedPolyList::Vertex &vert = clipper.mVertexList[i];
       vertPoint = vert.point;
 
       // Transform this point to
       // object space to look up the
       // UV coordinate for this vertex.
-      projMat.mulP( vertPoint );
+      params.worldToDecal.mulP( vertPoint );
 
       // Clamp the point to be within the quad.
       vertPoint.x = mClampF( vertPoint.x, -decalHalfSize.x, decalHalfSize.x );
@@ -430,51 +613,82 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
       // Get our UV.
       uv = quadToSquare.transform( Point2F( vertPoint.x, vertPoint.y ) );
 
-      const RectF &rect = decal->mDataBlock->texRect[decal->mTextureRectIdx];
-
       uv *= rect.extent;
       uv += rect.point;      
 
       // Set the world space vertex position.
-      decal->mVerts[i].point = vert.point;
+      outVerts[i].point = vert.point;
       
-      decal->mVerts[i].texCoord.set( uv.x, uv.y );
+      outVerts[i].texCoord.set( uv.x, uv.y );
       
-      if ( mClipper.mNormalList.empty() )
+      if ( clipper.mNormalList.empty() )
          continue;
 
-      decal->mVerts[i].normal = mClipper.mNormalList[i];
-      decal->mVerts[i].normal.normalize();
+      outVerts[i].normal = clipper.mNormalList[i];
+      outVerts[i].normal.normalize();
 
-      if( mFabs( decal->mVerts[i].normal.z ) > 0.8f ) 
-         mCross( decal->mVerts[i].normal, Point3F( 1.0f, 0.0f, 0.0f ), &vecX );
-      else if ( mFabs( decal->mVerts[i].normal.x ) > 0.8f )
-         mCross( decal->mVerts[i].normal, Point3F( 0.0f, 1.0f, 0.0f ), &vecX );
-      else if ( mFabs( decal->mVerts[i].normal.y ) > 0.8f )
-         mCross( decal->mVerts[i].normal, Point3F( 0.0f, 0.0f, 1.0f ), &vecX );
+      if( mFabs( outVerts[i].normal.z ) > 0.8f ) 
+         mCross( outVerts[i].normal, Point3F( 1.0f, 0.0f, 0.0f ), &vecX );
+      else if ( mFabs( outVerts[i].normal.x ) > 0.8f )
+         mCross( outVerts[i].normal, Point3F( 0.0f, 1.0f, 0.0f ), &vecX );
+      else if ( mFabs( outVerts[i].normal.y ) > 0.8f )
+         mCross( outVerts[i].normal, Point3F( 0.0f, 0.0f, 1.0f ), &vecX );
    
-      decal->mVerts[i].tangent = mCross( decal->mVerts[i].normal, vecX );
+      outVerts[i].tangent = mCross( outVerts[i].normal, vecX );
    }
 
    U32 curIdx = 0;
-   for ( U32 j = 0; j < mClipper.mPolyList.size(); j++ )
+   for ( U32 j = 0; j < clipper.mPolyList.size(); j++ )
    {
       // Write indices for each Poly
-      ClippedPolyList::Poly *poly = &mClipper.mPolyList[j];                  
+      const ClippedPolyList::Poly *poly = &clipper.mPolyList[j];                  
 
       AssertFatal( poly->vertexCount == 3, "Got non-triangle poly!" );
 
-      decal->mIndices[curIdx] = mClipper.mIndexList[poly->vertexStart];         
+      outIndices[curIdx] = clipper.mIndexList[poly->vertexStart];         
       curIdx++;
-      decal->mIndices[curIdx] = mClipper.mIndexList[poly->vertexStart + 1];            
+      outIndices[curIdx] = clipper.mIndexList[poly->vertexStart + 1];            
       curIdx++;
-      decal->mIndices[curIdx] = mClipper.mIndexList[poly->vertexStart + 2];                
+      outIndices[curIdx] = clipper.mIndexList[poly->vertexStart + 2];                
       curIdx++;
    } 
+}
+
+bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts, const Point2F *clipDepth )
+{
+   PROFILE_SCOPE( DecalManager_clipDecal );
+
+   // A queued job would replace what we clip here.
+   _cancelClipJob( decal );
+
+   // Free old verts and indices.
+   _freeBuffers( decal );
+
+   DecalClipParams params;
+   _getClipParams( decal, clipDepth, &params );
+   _setupClipper( params, &mClipper );
+   _gatherClipPolys( params, &mClipper );
+
+   if ( !_triangulateClipPolys( &mClipper, params ) )
+      return false;
+
+   decal->mVertCount = mClipper.mVertexList.size();
+   decal->mIndxCount = mClipper.mIndexList.size();
+
+   // Allocate memory for vert and index arrays
+   _allocBuffers( decal );  
+
+   // Mark this so that the color will be assigned on these verts the next
+   // time it renders, since we just threw away the previous verts.
+   decal->mLastAlpha = -1;
+
+   _fillClipGeometry( mClipper, params, decal->mVerts, decal->mIndices );
 
    if ( !edgeVerts )
       return true;
 
+   MatrixF projMat = params.worldToDecal;
+
    Point3F tmpHullPt( 0, 0, 0 );
    Vector<Point3F> tmpHullPts;
 
@@ -497,6 +711,78 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
    return true;
 }
 
+void DecalManager::_queueClipJob( DecalInstance *decal )
+{
+   PROFILE_SCOPE( DecalManager_queueClipJob );
+
+   _cancelClipJob( decal );
+
+   // The scene container isn't thread safe, so the polys are
+   // gathered here unclipped and the clipping work is queued.
+   DecalClipItemRef item( new DecalClipItem( decal ) );
+   _getClipParams( decal, NULL, &item->mParams );
+   _gatherClipPolys( item->mParams, &item->mPolys );
+
+   mClipJobs.push_back( item );
+   ThreadPool::GLOBAL().queueWorkItem( item );
+}
+
+void DecalManager::_cancelClipJob( DecalInstance *decal )
+{
+   for ( U32 i = 0; i < mClipJobs.size(); i++ )
+   {
+      if ( mClipJobs[i]->mDecal == decal )
+         mClipJobs[i]->mDecal = NULL;
+   }
+}
+
+void DecalManager::_finishClipJobs()
+{
+   PROFILE_SCOPE( DecalManager_finishClipJobs );
+
+   for ( U32 i = 0; i < mClipJobs.size(); )
+   {
+      DecalClipItemRef item = mClipJobs[i];
+      if ( !item->isFinished() )
+      {
+         i++;
+         continue;
+      }
+
+      mClipJobs.erase( i );
+
+      DecalInstance *decal = item->mDecal;
+      if ( !decal )
+         continue;
+
+      _freeBuffers( decal );
+
+      if ( item->mVerts.empty() )
+      {
+         // Clipping failed to get any geometry...
+
+         // If the decal is one placed at run-time (not the editor)
+         // then we should permanently delete the decal instance.
+         // Editor placed decals are flagged to attempt clipping
+         // again the next time they are modified.
+         if ( !( decal->mFlags & SaveDecal ) )
+            removeDecal( decal );
+
+         continue;
+      }
+
+      decal->mVertCount = item->mVerts.size();
+      decal->mIndxCount = item->mIndices.size();
+      _allocBuffers( decal );
+
+      dMemcpy( decal->mVerts, item->mVerts.address(), sizeof( DecalVertex ) * decal->mVertCount );
+      dMemcpy( decal->mIndices, item->mIndices.address(), sizeof( U16 ) * decal->mIndxCount );
+
+      // Assign the color the next time it renders.
+      decal->mLastAlpha = -1;
+   }
+}
+
 DecalInstance* DecalManager::addDecal( const Point3F &pos,
                                        const Point3F &normal,
                                        F32 rotAroundNormal,
@@ -551,6 +837,7 @@ void DecalManager::removeDecal( DecalInstance *inst )
    
    // Release its geometry (if it has any).
 
+   _cancelClipJob( inst );
    _freeBuffers( inst );
    
    // Remove it from the decal file.
@@ -923,6 +1210,8 @@ void DecalManager::_allocBuffers( DecalInstance *inst )
    inst->mVerts = reinterpret_cast< DecalVertex* >( data );
    data = (U8*)data + sizeof( DecalVertex ) * inst->mVertCount;
    inst->mIndices = reinterpret_cast< U16* >( data );
+
+   inst->mGeometryVersion = ++gDecalGeometryVersion;
 }
 
 void DecalManager::_freeBuffers( DecalInstance *inst )
@@ -988,6 +1277,290 @@ S32 DecalManager::_getSizeClass( DecalInstance *inst ) const
    return -1;
 }
 
+void DecalManager::_fillDynamicBuffers( const DecalBatch &batch, GFXVertexBufferHandle<DecalVertex> **outVB, GFXPrimitiveBufferHandle **outPB )
+{
+   // System memory array of verts and indices so we can fill them incrementally
+   // and then memcpy to the graphics device buffers in one call.
+   static DecalVertex vertData[smMaxVerts];
+   static U16 indexData[smMaxIndices];
+
+   // Copy data into the system memory arrays, from all decals in this batch...
+
+   DecalVertex *vpPtr = vertData;
+   U16 *pbPtr = indexData;            
+
+   U32 lastDecal = batch.startDecal + batch.decalCount;
+
+   U32 voffset = 0;
+   U32 ioffset = 0;
+
+   for ( U32 j = batch.startDecal; j < lastDecal; j++ )
+   {
+      DecalInstance *dinst = mDecalQueue[j];
+
+      for ( U32 k = 0; k < dinst->mIndxCount; k++ )
+      {
+         *( pbPtr + ioffset + k ) = dinst->mIndices[k] + voffset;            
+      }
+
+      ioffset += dinst->mIndxCount;
+
+      dMemcpy( vpPtr + voffset, dinst->mVerts, sizeof( DecalVertex ) * dinst->mVertCount );
+      voffset += dinst->mVertCount;
+   }
+
+   AssertFatal( ioffset == batch.iCount, "bad" );
+   AssertFatal( voffset == batch.vCount, "bad" );
+     
+   // Get handles to video memory buffers we will be filling...
+
+   GFXVertexBufferHandle<DecalVertex> *vb = NULL;
+   
+   if ( mVBPool.empty() )
+   {
+      // If the Pool is empty allocate a new one.
+      vb = new GFXVertexBufferHandle<DecalVertex>;
+      vb->set( GFX, smMaxVerts, GFXBufferTypeDynamic );                  
+   }      
+   else 
+   {
+      // Otherwise grab from the pool.
+      vb = mVBPool.last();
+      mVBPool.pop_back();
+   }
+
+   // Push into our vector of 'in use' buffers.
+   mVBs.push_back( vb );
+   
+   // Ready to start filling.
+   vpPtr = vb->lock();
+
+   // Same deal as above...      
+   GFXPrimitiveBufferHandle *pb = NULL;
+   if ( mPBPool.empty() )
+   {
+      pb = new GFXPrimitiveBufferHandle;
+      pb->set( GFX, smMaxIndices, 0, GFXBufferTypeDynamic );   
+   }
+   else
+   {
+      pb = mPBPool.last();
+      mPBPool.pop_back();
+   }
+   mPBs.push_back( pb );
+   
+   pb->lock( &pbPtr );
+
+   // Memcpy from system to video memory.
+   dMemcpy( vpPtr, vertData, sizeof( DecalVertex ) * batch.vCount );
+   dMemcpy( pbPtr, indexData, sizeof( U16 ) * batch.iCount );
+
+   pb->unlock();
+   vb->unlock();
+
+   *outVB = vb;
+   *outPB = pb;
+}
+
+void DecalManager::_fillCachedBuffers( const DecalBatch &batch, GFXVertexBufferHandle<DecalVertex> **outVB, GFXPrimitiveBufferHandle **outPB )
+{
+   PROFILE_SCOPE( DecalManager_fillCachedBuffers );
+
+   DecalInstance **decals = mDecalQueue.address() + batch.startDecal;
+   const U32 decalCount = batch.decalCount;
+
+   // Batches are sorted by creation time, so the buffers this batch
+   // used last frame begin with the same decal unless that one is gone.
+   BatchBuffers *buffers = NULL;
+   for ( U32 i = 0; i < mBatchBuffers.size(); i++ )
+   {
+      BatchBuffers *cached = mBatchBuffers[i];
+      if (  cached->lastPrep != mPrepCount &&
+            cached->decals[0] == decals[0] &&
+            cached->vb->mNumVerts >= batch.vCount &&
+            cached->pb->mIndexCount >= batch.iCount )
+      {
+         buffers = cached;
+         break;
+      }
+   }
+
+   // A fading decal changes its alpha every frame, which would upload
+   // the static buffers every frame.  The batch is copied into the
+   // dynamic buffers instead and its static buffers are kept until
+   // the fade ends.
+   if ( batch.fading )
+   {
+      if ( buffers )
+      {
+         buffers->lastPrep = mPrepCount;
+         buffers->drawn = true;
+      }
+
+      _fillDynamicBuffers( batch, outVB, outPB );
+      return;
+   }
+
+   // Find the first decal whose verts and the first decal whose
+   // indices have to be uploaded, along with their offsets.
+   U32 firstVert = 0;
+   U32 vStart = 0;
+   U32 iStart = 0;
+
+   if ( buffers )
+   {
+      const U32 count = getMin( (U32)buffers->decals.size(), decalCount );
+      while ( firstVert < count )
+      {
+         const DecalInstance *dinst = decals[firstVert];
+         if (  buffers->decals[firstVert] != dinst ||
+               buffers->geometryVersions[firstVert] != dinst->mGeometryVersion ||
+               buffers->alphas[firstVert] != dinst->mLastAlpha )
+            break;
+
+         vStart += dinst->mVertCount;
+         iStart += dinst->mIndxCount;
+         firstVert++;
+      }
+   }
+   else
+      buffers = _allocBatchBuffers( batch.vCount, batch.iCount );
+
+   buffers->lastPrep = mPrepCount;
+   buffers->drawn = true;
+
+   *outVB = &buffers->vb;
+   *outPB = &buffers->pb;
+
+   if ( firstVert == decalCount )
+   {
+      // Nothing changed, at most some decals at the end went away.
+      buffers->decals.setSize( decalCount );
+      buffers->geometryVersions.setSize( decalCount );
+      buffers->alphas.setSize( decalCount );
+      return;
+   }
+
+   // Decals which only faded keep their indices.
+   U32 firstIndex = firstVert;
+   U32 iFirstStart = iStart;
+   const U32 count = getMin( (U32)buffers->decals.size(), decalCount );
+   while (  firstIndex < count &&
+            buffers->decals[firstIndex] == decals[firstIndex] &&
+            buffers->geometryVersions[firstIndex] == decals[firstIndex]->mGeometryVersion )
+   {
+      iFirstStart += decals[firstIndex]->mIndxCount;
+      firstIndex++;
+   }
+
+   buffers->decals.setSize( decalCount );
+   buffers->geometryVersions.setSize( decalCount );
+   buffers->alphas.setSize( decalCount );
+
+   // Static buffers only upload the locked range, so the range
+   // is rewritten in full.
+   DecalVertex *vpPtr = buffers->vb.lock( vStart, batch.vCount );
+
+   U16 *pbPtr = NULL;
+   if ( firstIndex < decalCount )
+      buffers->pb.lock( &pbPtr, NULL, iFirstStart, batch.iCount );
+
+   U32 voffset = vStart;
+   U32 ioffset = iStart;
+
+   for ( U32 j = firstVert; j < decalCount; j++ )
+   {
+      DecalInstance *dinst = decals[j];
+
+      dMemcpy( vpPtr + voffset - vStart, dinst->mVerts, sizeof( DecalVertex ) * dinst->mVertCount );
+
+      if ( j >= firstIndex )
+      {
+         U16 *idx = pbPtr + ioffset - iFirstStart;
+         for ( U32 k = 0; k < dinst->mIndxCount; k++ )
+            idx[k] = dinst->mIndices[k] + voffset;
+      }
+
+      voffset += dinst->mVertCount;
+      ioffset += dinst->mIndxCount;
+
+      buffers->decals[j] = dinst;
+      buffers->geometryVersions[j] = dinst->mGeometryVersion;
+      buffers->alphas[j] = dinst->mLastAlpha;
+   }
+
+   AssertFatal( ioffset == batch.iCount, "DecalManager::_fillCachedBuffers - Bad index count!" );
+   AssertFatal( voffset == batch.vCount, "DecalManager::_fillCachedBuffers - Bad vertex count!" );
+
+   if ( pbPtr )
+      buffers->pb.unlock();
+   buffers->vb.unlock();
+}
+
+DecalManager::BatchBuffers* DecalManager::_allocBatchBuffers( U32 vCount, U32 iCount )
+{
+   BatchBuffers *buffers = NULL;
+   for ( U32 i = 0; i < mFreeBatchBuffers.size(); i++ )
+   {
+      BatchBuffers *freeBuffers = mFreeBatchBuffers[i];
+      if (  freeBuffers->vb->mNumVerts >= vCount &&
+            freeBuffers->pb->mIndexCount >= iCount )
+      {
+         buffers = freeBuffers;
+         mFreeBatchBuffers.erase_fast( i );
+         break;
+      }
+   }
+
+   if ( !buffers )
+   {
+      // Leave some room for the batch to grow.
+      buffers = new BatchBuffers;
+      buffers->vb.set( GFX, getMin( ( vCount + 1023 ) & ~1023, smMaxVerts ), GFXBufferTypeStatic );
+      buffers->pb.set( GFX, getMin( ( iCount + 1023 ) & ~1023, smMaxIndices ), 0, GFXBufferTypeStatic );
+   }
+
+   buffers->decals.clear();
+   buffers->geometryVersions.clear();
+   buffers->alphas.clear();
+
+   mBatchBuffers.push_back( buffers );
+   return buffers;
+}
+
+void DecalManager::_recycleBatchBuffers()
+{
+   // Buffers which weren't used for a whole frame are released
+   // and the ones not used this frame can be reused next frame.
+   for ( U32 i = 0; i < mFreeBatchBuffers.size(); i++ )
+      delete mFreeBatchBuffers[i];
+   mFreeBatchBuffers.clear();
+
+   for ( S32 i = mBatchBuffers.size() - 1; i >= 0; i-- )
+   {
+      BatchBuffers *buffers = mBatchBuffers[i];
+      if ( buffers->drawn )
+      {
+         buffers->drawn = false;
+         continue;
+      }
+
+      mFreeBatchBuffers.push_back( buffers );
+      mBatchBuffers.erase_fast( i );
+   }
+}
+
+void DecalManager::_freeBatchBuffers()
+{
+   for ( U32 i = 0; i < mBatchBuffers.size(); i++ )
+      delete mBatchBuffers[i];
+   mBatchBuffers.clear();
+
+   for ( U32 i = 0; i < mFreeBatchBuffers.size(); i++ )
+      delete mFreeBatchBuffers[i];
+   mFreeBatchBuffers.clear();
+}
+
 void DecalManager::prepRenderImage( SceneRenderState* state )
 {
    PROFILE_SCOPE( DecalManager_RenderDecals );
@@ -1002,6 +1575,11 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
    if ( !state->isDiffusePass() )
       return;
 
+   mPrepCount++;
+
+   // Pick up the geometry of decals clipped since the last frame.
+   _finishClipJobs();
+
    PROFILE_START( DecalManager_RenderDecals_SphereTreeCull );
 
    const Frustum& rootFrustum = state->getCameraFrustum();
@@ -1109,7 +1687,12 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
          // if it fails.
          dinst->mFlags = dinst->mFlags & ~ClipDecal;
 
-         if ( !(dinst->mFlags & CustomDecal) && !clipDecal( dinst ) )
+         if ( smAsyncClipping )
+         {
+            // The decal is skipped below until its job is done.
+            _queueClipJob( dinst );
+         }
+         else if ( !(dinst->mFlags & CustomDecal) && !clipDecal( dinst ) )
          {
             // Clipping failed to get any geometry...
 
@@ -1132,8 +1715,9 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
       }
 
       // If we get here and the decal still does not have any geometry
-      // skip rendering it. It must be an editor placed decal that failed
-      // to clip any geometry but has not yet been flagged to try again.
+      // skip rendering it. It is either still being clipped or it must be
+      // an editor placed decal that failed to clip any geometry but has
+      // not yet been flagged to try again.
       if ( !dinst->mVerts || dinst->mVertCount == 0 || dinst->mIndxCount == 0 )
       {
          mDecalQueue.erase_fast( i );
@@ -1159,6 +1743,9 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
             alpha *= dinst->mVisibility;
          }
             
+         // New geometry gets its alpha assigned, it doesn't fade.
+         dinst->mFading = alpha != dinst->mLastAlpha && dinst->mLastAlpha >= 0.0f;
+
          // If the alpha value has not changed since last render avoid
          // looping through all the verts!
          if ( alpha != dinst->mLastAlpha )
@@ -1241,6 +1828,7 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
          currentBatch->matInst = decal->mDataBlock->getMaterialInstance();
          currentBatch->priority = decal->getRenderPriority();         
          currentBatch->dynamic = !(decal->mFlags & SaveDecal);
+         currentBatch->fading = decal->mFading;
 
          continue;
       }
@@ -1262,111 +1850,32 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
       currentBatch->decalCount++;
       currentBatch->iCount += decal->mIndxCount;
       currentBatch->vCount += decal->mVertCount;
+      currentBatch->fading |= decal->mFading;
    }
    
-   // Make sure our primitive and vertex buffer handle storage is
-   // big enough to take all batches.  Doing this now avoids reallocation
-   // later on which would invalidate all the pointers we already had
-   // passed into render instances.
-   
-   //mPBs.reserve( batches.size() );
-   //mVBs.reserve( batches.size() );
-
-   // System memory array of verts and indices so we can fill them incrementally
-   // and then memcpy to the graphics device buffers in one call.
-   static DecalVertex vertData[smMaxVerts];
-   static U16 indexData[smMaxIndices];
-
-   // Loop through batches allocating buffers and submitting render instances.
+   // Loop through batches filling buffers and submitting render instances.
    for ( U32 i = 0; i < batches.size(); i++ )
    {
       DecalBatch &currentBatch = batches[i];      
 
-      // Copy data into the system memory arrays, from all decals in this batch...
-
-      DecalVertex *vpPtr = vertData;
-      U16 *pbPtr = indexData;            
-
-      U32 lastDecal = currentBatch.startDecal + currentBatch.decalCount;
-
-      U32 voffset = 0;
-      U32 ioffset = 0;
-
       // This is an ugly hack for ProjectedShadow!
       GFXTextureObject *customTex = NULL;
 
+      const U32 lastDecal = currentBatch.startDecal + currentBatch.decalCount;
       for ( U32 j = currentBatch.startDecal; j < lastDecal; j++ )
       {
          DecalInstance *dinst = mDecalQueue[j];
-
-         for ( U32 k = 0; k < dinst->mIndxCount; k++ )
-         {
-            *( pbPtr + ioffset + k ) = dinst->mIndices[k] + voffset;            
-         }
-
-         ioffset += dinst->mIndxCount;
-
-         dMemcpy( vpPtr + voffset, dinst->mVerts, sizeof( DecalVertex ) * dinst->mVertCount );
-         voffset += dinst->mVertCount;
-
-         // Ugly hack for ProjectedShadow!
          if ( (dinst->mFlags & CustomDecal) && dinst->mCustomTex != NULL )
             customTex = *dinst->mCustomTex;
       }
 
-      AssertFatal( ioffset == currentBatch.iCount, "bad" );
-      AssertFatal( voffset == currentBatch.vCount, "bad" );
-        
-      // Get handles to video memory buffers we will be filling...
-
       GFXVertexBufferHandle<DecalVertex> *vb = NULL;
-      
-      if ( mVBPool.empty() )
-      {
-         // If the Pool is empty allocate a new one.
-         vb = new GFXVertexBufferHandle<DecalVertex>;
-         vb->set( GFX, smMaxVerts, GFXBufferTypeDynamic );                  
-      }      
-      else 
-      {
-         // Otherwise grab from the pool.
-         vb = mVBPool.last();
-         mVBPool.pop_back();
-      }
-
-      // Push into our vector of 'in use' buffers.
-      mVBs.push_back( vb );
-      
-      // Ready to start filling.
-      vpPtr = vb->lock();
-
-      // Same deal as above...      
       GFXPrimitiveBufferHandle *pb = NULL;
-      if ( mPBPool.empty() )
-      {
-         pb = new GFXPrimitiveBufferHandle;
-         pb->set( GFX, smMaxIndices, 0, GFXBufferTypeDynamic );   
-      }
-      else
-      {
-         pb = mPBPool.last();
-         mPBPool.pop_back();
-      }
-      mPBs.push_back( pb );
-      
-      pb->lock( &pbPtr );
 
-      // Memcpy from system to video memory.
-      dMemcpy( vpPtr, vertData, sizeof( DecalVertex ) * currentBatch.vCount );
-      dMemcpy( pbPtr, indexData, sizeof( U16 ) * currentBatch.iCount );
-
-      pb->unlock();
-      vb->unlock();
-
-      // DecalManager must hold handles to these buffers so they remain valid,
-      // we don't actually use them elsewhere.
-      //mPBs.push_back( pb );
-      //mVBs.push_back( vb );
+      if ( smCacheBuffers )
+         _fillCachedBuffers( currentBatch, &vb, &pb );
+      else
+         _fillDynamicBuffers( currentBatch, &vb, &pb );
 
       // Get the best lights for the current camera position
       // if the materail is forward lit and we haven't got them yet.
@@ -1411,7 +1920,8 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
 
 #ifdef TORQUE_GATHER_METRICS
    Con::setIntVariable( "$Decal::Batches", batches.size() );
-   Con::setIntVariable( "$Decal::Buffers", mPBs.size() + mPBPool.size() );
+   Con::setIntVariable( "$Decal::Buffers", mPBs.size() + mPBPool.size() + mBatchBuffers.size() );
+   Con::setIntVariable( "$Decal::ClipJobs", mClipJobs.size() );
    Con::setIntVariable( "$Decal::DecalsRendered", mDecalQueue.size() );
 #endif
 
@@ -1530,6 +2040,12 @@ bool DecalManager::loadDecals( const UTF8 *fileName )
 void DecalManager::clearData()
 {
    mClearDataSignal.trigger();
+
+   // Drop the results of any queued clipping jobs.
+
+   for ( U32 i = 0; i < mClipJobs.size(); i++ )
+      mClipJobs[i]->mDecal = NULL;
+   mClipJobs.clear();
    
    // Free all geometry buffers.
    
@@ -1548,6 +2064,7 @@ void DecalManager::clearData()
 	mDecalInstanceVec.clear();
 
    _freePools();   
+   _freeBatchBuffers();
 }
 
 bool DecalManager::onSceneAdd()
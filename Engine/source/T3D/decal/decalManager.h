@@ -63,12 +63,18 @@
 #include "core/dataChunker.h"
 #endif
 
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
+
 
 //#define DECALMANAGER_DEBUG
 
 
 struct ObjectRenderInst;
 class Material;
+struct DecalClipItem;
+struct DecalClipParams;
 
 
 enum DecalFlags 
@@ -84,6 +90,9 @@ enum DecalFlags
 /// Manage decals in the scene.
 class DecalManager : public SceneObject
 {
+   friend struct DecalClipItem;
+   friend class DecalManagerFixture;
+
    public:
       
       typedef SceneObject Parent;
@@ -99,6 +108,10 @@ class DecalManager : public SceneObject
 
       Vector<DecalInstance*> mDecalQueue;
 
+      /// Decals being clipped on the ThreadPool.  The decals are
+      /// not rendered until prepRenderImage() picks up their geometry.
+      Vector< ThreadSafeRef<DecalClipItem> > mClipJobs;
+
       StringTableEntry mDataFileName;
       Resource<DecalDataFile> mData;
       
@@ -112,6 +125,37 @@ class DecalManager : public SceneObject
 
       FreeListChunkerUntyped *mChunkers[3];
 
+      /// Static buffers filled for a batch of decals in an earlier frame.
+      /// They are kept while the batch is drawn so that only the decals
+      /// whose geometry or alpha changed are uploaded again.
+      struct BatchBuffers
+      {
+         /// The decals in the buffers and what was uploaded for them.
+         Vector<DecalInstance*> decals;
+         Vector<U32> geometryVersions;
+         Vector<F32> alphas;
+
+         GFXVertexBufferHandle<DecalVertex> vb;
+         GFXPrimitiveBufferHandle pb;
+
+         /// The prepRenderImage() call which last used the buffers.
+         U32 lastPrep;
+
+         /// Whether the buffers were used since the end of the last frame.
+         bool drawn;
+      };
+
+      /// The batch buffers used in this or the last frame.
+      Vector<BatchBuffers*> mBatchBuffers;
+
+      /// Batch buffers not used in the last frame, which are reused for
+      /// new batches or released at the end of this frame.
+      Vector<BatchBuffers*> mFreeBatchBuffers;
+
+      /// Counts the prepRenderImage() calls so a batch doesn't take buffers
+      /// another batch of the same view already filled.
+      U32 mPrepCount;
+
       #ifdef DECALMANAGER_DEBUG
       Vector<PlaneF> mDebugPlanes;
       #endif
@@ -128,6 +172,9 @@ class DecalManager : public SceneObject
          Material *mat;
          BaseMatInstance *matInst;
          bool dynamic;
+
+         /// Whether any decal in the batch is fading.
+         bool fading;
       };
 
       /// Whether to render visualizations for debugging in the editor.
@@ -136,6 +183,8 @@ class DecalManager : public SceneObject
       static bool smDecalsOn;
       static F32 smDecalLifeTimeScale;   
       static bool smPoolBuffers;
+      static bool smCacheBuffers;
+      static bool smAsyncClipping;
       static const U32 smMaxVerts;
       static const U32 smMaxIndices;
 
@@ -167,6 +216,61 @@ class DecalManager : public SceneObject
       void _freeBuffers( DecalInstance *inst );
       void _freePools();
 
+      /// @name Clipping
+      /// @{
+
+      /// Fills in the clipping planes for the decal and what's
+      /// needed to build its geometry.
+      void _getClipParams( DecalInstance *decal, const Point2F *clipDepth, DecalClipParams *outParams );
+
+      /// Gathers the scene polys around the decal.  The scene container
+      /// isn't thread safe so this only runs on the main thread.
+      void _gatherClipPolys( const DecalClipParams &params, AbstractPolyList *polyList );
+
+      /// Readies the clipper for the polys of the decal.  Thread safe.
+      static void _setupClipper( const DecalClipParams &params, ClippedPolyList *clipper );
+
+      /// Triangulates the gathered polys.  Returns false if there is no
+      /// geometry or it is too big for the decal buffers.  Thread safe.
+      static bool _triangulateClipPolys( ClippedPolyList *clipper, const DecalClipParams &params );
+
+      /// Fills in decal vertices and indices from the triangulated polys.
+      /// Thread safe.
+      static void _fillClipGeometry( const ClippedPolyList &clipper, const DecalClipParams &params, DecalVertex *outVerts, U16 *outIndices );
+
+      /// Gathers the polys for the decal and queues the rest of the
+      /// clipping on the ThreadPool.
+      void _queueClipJob( DecalInstance *decal );
+
+      /// Drops the result of a queued clipping job for the decal.
+      void _cancelClipJob( DecalInstance *decal );
+
+      /// Gives the decals of finished clipping jobs their geometry.
+      void _finishClipJobs();
+
+      /// @}
+
+      /// @name Batch Buffers
+      /// @{
+
+      /// Copies the batch into a pair of the pooled dynamic buffers.
+      void _fillDynamicBuffers( const DecalBatch &batch, GFXVertexBufferHandle<DecalVertex> **outVB, GFXPrimitiveBufferHandle **outPB );
+
+      /// Finds the buffers the batch used before and uploads the decals
+      /// which changed, or fills new buffers.  Batches with fading decals
+      /// use the dynamic buffers until the fade ends.
+      void _fillCachedBuffers( const DecalBatch &batch, GFXVertexBufferHandle<DecalVertex> **outVB, GFXPrimitiveBufferHandle **outPB );
+
+      /// Returns free batch buffers with room for the counts.
+      BatchBuffers* _allocBatchBuffers( U32 vCount, U32 iCount );
+
+      /// Moves batch buffers not drawn this frame to the free list.
+      void _recycleBatchBuffers();
+
+      void _freeBatchBuffers();
+
+      /// @}
+
       /// Returns index used to index into the correct sized FreeListChunker for
       /// allocating vertex and index arrays.
       S32 _getSizeClass( DecalInstance *inst ) const;
@@ -0,0 +1,240 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "math/mathIO.h"
+#include "core/stream/memStream.h"
+#include "T3D/decal/decalDataFile.h"
+#include "T3D/decal/decalManager.h"
+#include "T3D/decal/decalData.h"
+
+/// Decal files saved to memory in the flat format or
+/// written by hand in the old stream format.
+FIXTURE(DecalDataFile)
+{
+public:
+   MRandomLCG rand;
+   Vector<DecalData*> datablocks;
+   U32 savedInstances;
+
+   void SetUp()
+   {
+      rand.setSeed( 1357 );
+      datablocks.clear();
+
+      // Loading registers the decals with the manager, which
+      // we undo as the files free them with the test.
+      ASSERT_TRUE( gDecalManager != NULL );
+      savedInstances = gDecalManager->mDecalInstanceVec.size();
+
+      for ( U32 i = 0; i < 2; i++ )
+      {
+         const String name = String::ToString( "DecalDataFileTestData%d", i );
+         DecalData *data = new DecalData;
+         data->lookupName = name;
+         data->size = 2.0f + i;
+         ASSERT_TRUE( data->registerObject( name ) );
+         datablocks.push_back( data );
+      }
+   }
+
+   void TearDown()
+   {
+      if ( gDecalManager )
+         gDecalManager->mDecalInstanceVec.setSize( savedInstances );
+
+      for ( U32 i = 0; i < datablocks.size(); i++ )
+         datablocks[i]->deleteObject();
+      datablocks.clear();
+   }
+
+   /// Decals in a few clusters so that there are several spheres.
+   void addDecals( DecalDataFile &file, U32 count )
+   {
+      for ( U32 i = 0; i < count; i++ )
+      {
+         const Point3F cluster( ( i % 5 ) * 500.0f, ( i % 3 ) * 700.0f, 0.0f );
+         const Point3F pos = cluster + Point3F( rand.randF( -20.0f, 20.0f ), rand.randF( -20.0f, 20.0f ), rand.randF( 0.0f, 5.0f ) );
+         const U8 flags = i % 10 == 0 ? PermanentDecal : PermanentDecal | SaveDecal;
+         DecalInstance *inst = file.addDecal( pos, Point3F( 0, 0, 1 ), Point3F( 1, 0, 0 ), datablocks[ i % datablocks.size() ], rand.randF( 0.5f, 2.0f ), 0, flags );
+         inst->mRenderPriority = rand.randI( 0, 10 );
+      }
+   }
+
+   void getDecals( const DecalDataFile &file, Vector<const DecalInstance*> &outDecals, bool savedOnly )
+   {
+      outDecals.clear();
+      const Vector<DecalSphere*> &spheres = file.getSphereList();
+      for ( U32 i = 0; i < spheres.size(); i++ )
+      {
+         for ( U32 j = 0; j < spheres[i]->mItems.size(); j++ )
+         {
+            const DecalInstance *inst = spheres[i]->mItems[j];
+            if ( !savedOnly || ( inst->mFlags & SaveDecal ) )
+               outDecals.push_back( inst );
+         }
+      }
+   }
+
+   static S32 QSORT_CALLBACK cmpDecalPos( const void *a, const void *b )
+   {
+      const Point3F &pa = (*(const DecalInstance**)a)->mPosition;
+      const Point3F &pb = (*(const DecalInstance**)b)->mPosition;
+      if ( pa.x != pb.x )
+         return pa.x < pb.x ? -1 : 1;
+      if ( pa.y != pb.y )
+         return pa.y < pb.y ? -1 : 1;
+      return 0;
+   }
+
+   /// Compares the saved decals of two files.
+   void expectSameDecals( const DecalDataFile &source, const DecalDataFile &loaded )
+   {
+      Vector<const DecalInstance*> a, b;
+      getDecals( source, a, true );
+      getDecals( loaded, b, false );
+      ASSERT_EQ( a.size(), b.size() );
+
+      dQsort( a.address(), a.size(), sizeof( DecalInstance* ), cmpDecalPos );
+      dQsort( b.address(), b.size(), sizeof( DecalInstance* ), cmpDecalPos );
+
+      for ( U32 i = 0; i < a.size(); i++ )
+      {
+         ASSERT_TRUE( a[i]->mDataBlock == b[i]->mDataBlock ) << "Decal " << i;
+         ASSERT_TRUE( a[i]->mPosition == b[i]->mPosition ) << "Decal " << i;
+         ASSERT_TRUE( a[i]->mNormal == b[i]->mNormal ) << "Decal " << i;
+         ASSERT_TRUE( a[i]->mTangent == b[i]->mTangent ) << "Decal " << i;
+         ASSERT_EQ( a[i]->mSize, b[i]->mSize ) << "Decal " << i;
+         ASSERT_EQ( a[i]->mTextureRectIdx, b[i]->mTextureRectIdx ) << "Decal " << i;
+         ASSERT_EQ( a[i]->mRenderPriority, b[i]->mRenderPriority ) << "Decal " << i;
+         ASSERT_EQ( PermanentDecal | SaveDecal | ClipDecal, b[i]->mFlags ) << "Decal " << i;
+      }
+   }
+
+   /// Every loaded decal has to be within its sphere or it
+   /// would be culled while it is still on screen.
+   void expectInSpheres( const DecalDataFile &file )
+   {
+      const Vector<DecalSphere*> &spheres = file.getSphereList();
+      for ( U32 i = 0; i < spheres.size(); i++ )
+      {
+         const SphereF &sphere = spheres[i]->mWorldSphere;
+         for ( U32 j = 0; j < spheres[i]->mItems.size(); j++ )
+         {
+            const DecalInstance *inst = spheres[i]->mItems[j];
+            EXPECT_LE( ( inst->mPosition - sphere.center ).len(), sphere.radius + 0.001f ) << "Sphere " << i << " decal " << j;
+         }
+      }
+   }
+
+   void save( DecalDataFile &file, Vector<U8> &outData )
+   {
+      outData.setSize( 1024 * 1024 );
+      MemStream stream( outData.size(), outData.address(), false, true );
+      ASSERT_TRUE( file.write( stream ) );
+      outData.setSize( stream.getPosition() );
+   }
+
+   /// Writes the decals like version 5 files were written.
+   void writeStreamVersion( const DecalDataFile &file, Vector<U8> &outData )
+   {
+      Vector<const DecalInstance*> decals;
+      getDecals( file, decals, true );
+
+      outData.setSize( 1024 + decals.size() * 64 );
+      MemStream stream( outData.size(), outData.address(), false, true );
+
+      stream.write( 4, "TDDF" );
+      stream.write( (U8)5 );
+
+      stream.write( (U32)datablocks.size() );
+      for ( U32 i = 0; i < datablocks.size(); i++ )
+         stream.write( datablocks[i]->lookupName );
+
+      stream.write( (U32)decals.size() );
+      for ( U32 i = 0; i < decals.size(); i++ )
+      {
+         const DecalInstance *inst = decals[i];
+         const U8 dataIndex = find( datablocks.begin(), datablocks.end(), inst->mDataBlock ) - datablocks.begin();
+         stream.write( dataIndex );
+         mathWrite( stream, inst->mPosition );
+         mathWrite( stream, inst->mNormal );
+         mathWrite( stream, inst->mTangent );
+         stream.write( inst->mTextureRectIdx );
+         stream.write( inst->mSize );
+         stream.write( inst->mRenderPriority );
+      }
+
+      outData.setSize( stream.getPosition() );
+   }
+};
+
+TEST_FIX(DecalDataFile, FlatRoundTrip)
+{
+   DecalDataFile source;
+   addDecals( source, 3000 );
+
+   Vector<U8> data;
+   save( source, data );
+   ASSERT_EQ( 6, data[4] ) << "Not saved as a version 6 file.";
+
+   DecalDataFile loaded;
+   ASSERT_TRUE( loaded.read( data.address(), data.size() ) );
+   EXPECT_FALSE( loaded.isDirty() );
+   expectSameDecals( source, loaded );
+   expectInSpheres( loaded );
+
+   // The spheres are stored rather than rebuilt.
+   U32 savedSpheres = 0;
+   for ( U32 i = 0; i < source.getSphereList().size(); i++ )
+   {
+      const Vector<DecalInstance*> &items = source.getSphereList()[i]->mItems;
+      for ( U32 j = 0; j < items.size(); j++ )
+      {
+         if ( items[j]->mFlags & SaveDecal )
+         {
+            savedSpheres++;
+            break;
+         }
+      }
+   }
+   EXPECT_EQ( savedSpheres, loaded.getSphereList().size() );
+
+   // Saving what was loaded round trips again.
+   Vector<U8> data2;
+   save( loaded, data2 );
+   DecalDataFile reloaded;
+   ASSERT_TRUE( reloaded.read( data2.address(), data2.size() ) );
+   expectSameDecals( source, reloaded );
+}
+
+TEST_FIX(DecalDataFile, ReadsStreamVersion)
+{
+   DecalDataFile source;
+   addDecals( source, 1000 );
+
+   Vector<U8> data;
+   writeStreamVersion( source, data );
+   ASSERT_EQ( 5, data[4] );
+
+   DecalDataFile loaded;
+   ASSERT_TRUE( loaded.read( data.address(), data.size() ) );
+   expectSameDecals( source, loaded );
+   expectInSpheres( loaded );
+}
+
+TEST_FIX(DecalDataFile, RejectsTruncatedFlatFile)
+{
+   DecalDataFile source;
+   addDecals( source, 200 );
+
+   Vector<U8> data;
+   save( source, data );
+
+   DecalDataFile loaded;
+   EXPECT_FALSE( loaded.read( data.address(), data.size() / 2 ) );
+   EXPECT_FALSE( loaded.read( data.address(), 8 ) );
+}
+
+#endif
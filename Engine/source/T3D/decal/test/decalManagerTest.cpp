@@ -0,0 +1,380 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "T3D/decal/decalManager.h"
+#include "T3D/decal/decalData.h"
+#include "T3D/objectTypes.h"
+#include "scene/sceneManager.h"
+#include "collision/abstractPolyList.h"
+
+/// A bumpy patch of ground with a wall standing on it, which gives
+/// the decals its polys with vertex normals like a TSMesh does.
+class DecalManagerTestGround : public SceneObject
+{
+   typedef SceneObject Parent;
+
+public:
+
+   /// Where the wall stands, in object space.
+   static const F32 WallX;
+
+   DecalManagerTestGround()
+   {
+      mTypeMask |= StaticShapeObjectType;
+      mObjBox.set( Point3F( -12.0f, -12.0f, -6.0f ), Point3F( 12.0f, 12.0f, 6.0f ) );
+   }
+
+   static F32 getHeight( F32 x, F32 y )
+   {
+      return mSin( x * 0.7f ) * mCos( y * 0.5f );
+   }
+
+   static VectorF getNormal( F32 x, F32 y )
+   {
+      const F32 dx = 0.7f * mCos( x * 0.7f ) * mCos( y * 0.5f );
+      const F32 dy = -0.5f * mSin( x * 0.7f ) * mSin( y * 0.5f );
+      VectorF normal( -dx, -dy, 1.0f );
+      normal.normalize();
+      return normal;
+   }
+
+   void addPoly( AbstractPolyList *polyList, const Point3F *points, const VectorF *normals, U32 count, U32 surfaceKey )
+   {
+      const U32 base = polyList->addPointAndNormal( points[0], normals[0] );
+      for ( U32 i = 1; i < count; i++ )
+         polyList->addPointAndNormal( points[i], normals[i] );
+
+      VectorF faceNormal = mCross( points[1] - points[0], points[2] - points[0] );
+      faceNormal.normalize();
+
+      polyList->begin( NULL, surfaceKey );
+      for ( U32 i = 0; i < count; i++ )
+         polyList->vertex( base + i );
+      polyList->plane( PlaneF( points[0], faceNormal ) );
+      polyList->end();
+   }
+
+   // SceneObject
+   virtual bool buildPolyList( PolyListContext, AbstractPolyList *polyList, const Box3F&, const SphereF& )
+   {
+      polyList->setObject( this );
+      polyList->setTransform( &getTransform(), getScale() );
+
+      U32 surfaceKey = 0;
+      for ( S32 y = -12; y < 12; y++ )
+      {
+         for ( S32 x = -12; x < 12; x++ )
+         {
+            const Point3F corners[4] =
+            {
+               Point3F( x, y, getHeight( x, y ) ),
+               Point3F( x + 1, y, getHeight( x + 1, y ) ),
+               Point3F( x + 1, y + 1, getHeight( x + 1, y + 1 ) ),
+               Point3F( x, y + 1, getHeight( x, y + 1 ) ),
+            };
+            const VectorF normals[4] =
+            {
+               getNormal( x, y ),
+               getNormal( x + 1, y ),
+               getNormal( x + 1, y + 1 ),
+               getNormal( x, y + 1 ),
+            };
+
+            const Point3F tri0[3] = { corners[0], corners[1], corners[2] };
+            const VectorF norm0[3] = { normals[0], normals[1], normals[2] };
+            addPoly( polyList, tri0, norm0, 3, surfaceKey++ );
+
+            const Point3F tri1[3] = { corners[0], corners[2], corners[3] };
+            const VectorF norm1[3] = { normals[0], normals[2], normals[3] };
+            addPoly( polyList, tri1, norm1, 3, surfaceKey++ );
+         }
+      }
+
+      // The wall faces sideways, so the decals reject it.
+      const Point3F wall[4] =
+      {
+         Point3F( WallX, -12.0f, -5.0f ),
+         Point3F( WallX, -12.0f, 5.0f ),
+         Point3F( WallX, 12.0f, 5.0f ),
+         Point3F( WallX, 12.0f, -5.0f ),
+      };
+      const VectorF wallNormals[4] = { VectorF( -1, 0, 0 ), VectorF( -1, 0, 0 ), VectorF( -1, 0, 0 ), VectorF( -1, 0, 0 ) };
+      addPoly( polyList, wall, wallNormals, 4, surfaceKey );
+
+      return true;
+   }
+};
+
+const F32 DecalManagerTestGround::WallX = 2.0f;
+
+/// Decals placed on the test ground far away from anything
+/// else in the client scene.
+FIXTURE(DecalManager)
+{
+public:
+   DecalManagerTestGround *ground;
+   DecalData *data;
+   Vector<DecalInstance*> decals;
+   Point3F origin;
+
+   void SetUp()
+   {
+      ASSERT_TRUE( gDecalManager != NULL );
+      ASSERT_TRUE( gClientSceneGraph != NULL );
+
+      origin.set( 5000.0f, -5000.0f, 100.0f );
+
+      ground = new DecalManagerTestGround;
+      MatrixF xfm( true );
+      xfm.setPosition( origin );
+      ground->setTransform( xfm );
+      gClientSceneGraph->addObjectToScene( ground );
+
+      data = new DecalData;
+      data->size = 4.0f;
+   }
+
+   void TearDown()
+   {
+      for ( U32 i = 0; i < decals.size(); i++ )
+      {
+         gDecalManager->_cancelClipJob( decals[i] );
+         gDecalManager->_freeBuffers( decals[i] );
+         delete decals[i];
+      }
+      decals.clear();
+
+      gClientSceneGraph->removeObjectFromScene( ground );
+      delete ground;
+      delete data;
+   }
+
+   /// Returns a decal on the ground at the object space position.
+   DecalInstance* addDecal( F32 x, F32 y )
+   {
+      DecalInstance *decal = new DecalInstance;
+      decal->mDataBlock = data;
+      decal->mPosition = origin + Point3F( x, y, DecalManagerTestGround::getHeight( x, y ) );
+      decal->mNormal.set( 0, 0, 1 );
+      decal->mTangent.set( 1, 0, 0 );
+      decal->mRotAroundNormal = 0.0f;
+      decal->mSize = data->size;
+      decal->mCreateTime = 0;
+      decal->mVisibility = 1.0f;
+      decal->mLastAlpha = -1.0f;
+      decal->mTextureRectIdx = 0;
+      decal->mVerts = NULL;
+      decal->mIndices = NULL;
+      decal->mVertCount = 0;
+      decal->mIndxCount = 0;
+      decal->mFlags = PermanentDecal | SaveDecal | ClipDecal;
+      decal->mRenderPriority = 0;
+      decal->mCustomTex = NULL;
+      decals.push_back( decal );
+      return decal;
+   }
+
+   void queueClipJob( DecalInstance *decal ) { gDecalManager->_queueClipJob( decal ); }
+
+   /// Waits for the queued clipping jobs and hands out their geometry.
+   bool finishClipJobs()
+   {
+      const U32 endTime = Platform::getRealMilliseconds() + 10000;
+      gDecalManager->_finishClipJobs();
+      while ( !gDecalManager->mClipJobs.empty() && Platform::getRealMilliseconds() < endTime )
+      {
+         Platform::sleep( 1 );
+         gDecalManager->_finishClipJobs();
+      }
+
+      return gDecalManager->mClipJobs.empty();
+   }
+
+   static void copyGeometry( const DecalInstance *decal, Vector<DecalVertex> &outVerts, Vector<U16> &outIndices )
+   {
+      outVerts.setSize( decal->mVertCount );
+      dMemcpy( outVerts.address(), decal->mVerts, sizeof( DecalVertex ) * decal->mVertCount );
+      outIndices.setSize( decal->mIndxCount );
+      dMemcpy( outIndices.address(), decal->mIndices, sizeof( U16 ) * decal->mIndxCount );
+   }
+
+   static void expectSameGeometry( const DecalInstance *decal, const Vector<DecalVertex> &verts, const Vector<U16> &indices )
+   {
+      ASSERT_EQ( (U32)verts.size(), decal->mVertCount );
+      ASSERT_EQ( (U32)indices.size(), decal->mIndxCount );
+
+      for ( U32 i = 0; i < verts.size(); i++ )
+      {
+         EXPECT_TRUE( decal->mVerts[i].point.equal( verts[i].point, 0.0001f ) ) << "Vertex " << i;
+         EXPECT_TRUE( decal->mVerts[i].normal.equal( verts[i].normal, 0.0001f ) ) << "Vertex " << i;
+         EXPECT_TRUE( decal->mVerts[i].tangent.equal( verts[i].tangent, 0.0001f ) ) << "Vertex " << i;
+         EXPECT_NEAR( verts[i].texCoord.x, decal->mVerts[i].texCoord.x, 0.0001f ) << "Vertex " << i;
+         EXPECT_NEAR( verts[i].texCoord.y, decal->mVerts[i].texCoord.y, 0.0001f ) << "Vertex " << i;
+      }
+
+      for ( U32 i = 0; i < indices.size(); i++ )
+         EXPECT_EQ( indices[i], decal->mIndices[i] ) << "Index " << i;
+   }
+
+   /// Sets up one batch of all the decals.
+   DecalManager::DecalBatch makeBatch()
+   {
+      gDecalManager->mDecalQueue = decals;
+
+      DecalManager::DecalBatch batch;
+      dMemset( &batch, 0, sizeof( batch ) );
+      batch.decalCount = decals.size();
+      for ( U32 i = 0; i < decals.size(); i++ )
+      {
+         batch.vCount += decals[i]->mVertCount;
+         batch.iCount += decals[i]->mIndxCount;
+         batch.fading |= decals[i]->mFading;
+      }
+
+      return batch;
+   }
+
+   /// Fills the buffers for the batch as a new prepRenderImage() would.
+   GFXVertexBufferHandle<DecalVertex>* fillBuffers( const DecalManager::DecalBatch &batch )
+   {
+      GFXVertexBufferHandle<DecalVertex> *vb = NULL;
+      GFXPrimitiveBufferHandle *pb = NULL;
+      gDecalManager->mPrepCount++;
+      gDecalManager->_fillCachedBuffers( batch, &vb, &pb );
+      return vb;
+   }
+
+   /// Returns the alphas uploaded to the static buffers, or
+   /// NULL if the vertex buffer isn't one of them.
+   const Vector<F32>* getUploadedAlphas( GFXVertexBufferHandle<DecalVertex> *vb )
+   {
+      for ( U32 i = 0; i < gDecalManager->mBatchBuffers.size(); i++ )
+      {
+         if ( &gDecalManager->mBatchBuffers[i]->vb == vb )
+            return &gDecalManager->mBatchBuffers[i]->alphas;
+      }
+      return NULL;
+   }
+
+   bool isDynamicBuffer( GFXVertexBufferHandle<DecalVertex> *vb )
+   {
+      return find( gDecalManager->mVBs.begin(), gDecalManager->mVBs.end(), vb ) != gDecalManager->mVBs.end();
+   }
+
+   void freeBatchBuffers()
+   {
+      gDecalManager->mDecalQueue.clear();
+      gDecalManager->_freeBatchBuffers();
+   }
+};
+
+TEST_FIX(DecalManager, ThreadedClipBuildsSameGeometry)
+{
+   // Across the bumps, and next to the wall the clipper rejects.
+   const Point2F positions[] =
+   {
+      Point2F( 0.0f, 0.0f ), Point2F( -5.3f, 2.1f ), Point2F( 6.6f, -7.2f ),
+      Point2F( 1.0f, 3.5f ), Point2F( 2.5f, -1.0f ), Point2F( -8.0f, -8.0f ),
+   };
+   const U32 count = sizeof( positions ) / sizeof( positions[0] );
+
+   Vector<DecalVertex> syncVerts[count];
+   Vector<U16> syncIndices[count];
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      DecalInstance *decal = addDecal( positions[i].x, positions[i].y );
+      ASSERT_TRUE( gDecalManager->clipDecal( decal ) ) << "Decal " << i;
+      copyGeometry( decal, syncVerts[i], syncIndices[i] );
+   }
+
+   for ( U32 i = 0; i < count; i++ )
+      queueClipJob( decals[i] );
+
+   ASSERT_TRUE( finishClipJobs() );
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      SCOPED_TRACE( i );
+      expectSameGeometry( decals[i], syncVerts[i], syncIndices[i] );
+   }
+}
+
+TEST_FIX(DecalManager, ThreadedClipStaysOnTheGround)
+{
+   // Half of the decal hangs over the wall.
+   DecalInstance *decal = addDecal( DecalManagerTestGround::WallX - 0.5f, 0.0f );
+   queueClipJob( decal );
+   ASSERT_TRUE( finishClipJobs() );
+   ASSERT_GT( decal->mVertCount, 0u );
+
+   const F32 halfSize = decal->mSize * 0.5f;
+   for ( U32 i = 0; i < decal->mVertCount; i++ )
+   {
+      const DecalVertex &vert = decal->mVerts[i];
+      const Point3F local = vert.point - decal->mPosition;
+      EXPECT_LE( mFabs( local.x ), halfSize + 0.001f ) << "Vertex " << i;
+      EXPECT_LE( mFabs( local.y ), halfSize + 0.001f ) << "Vertex " << i;
+
+      // The ground normals came through, not the wall's.
+      EXPECT_GT( vert.normal.z, 0.5f ) << "Vertex " << i;
+   }
+}
+
+TEST_FIX(DecalManager, SyncClipDropsQueuedJob)
+{
+   DecalInstance *decal = addDecal( -3.0f, 4.0f );
+   queueClipJob( decal );
+
+   ASSERT_TRUE( gDecalManager->clipDecal( decal ) );
+   const U32 version = decal->mGeometryVersion;
+   Vector<DecalVertex> verts;
+   Vector<U16> indices;
+   copyGeometry( decal, verts, indices );
+
+   // The job finishes but the decal keeps what was clipped last.
+   ASSERT_TRUE( finishClipJobs() );
+   EXPECT_EQ( version, decal->mGeometryVersion );
+   expectSameGeometry( decal, verts, indices );
+}
+
+TEST_FIX(DecalManager, FadingBatchKeepsStaticBuffers)
+{
+   ASSERT_TRUE( GFXDevice::get() != NULL ) << "The batch buffers need a GFX device.";
+
+   for ( U32 i = 0; i < 3; i++ )
+   {
+      DecalInstance *decal = addDecal( i * 3.0f - 6.0f, 0.0f );
+      ASSERT_TRUE( gDecalManager->clipDecal( decal ) );
+      decal->mLastAlpha = 1.0f;
+      decal->mFading = false;
+   }
+
+   // Uploaded once to static buffers.
+   GFXVertexBufferHandle<DecalVertex> *staticVB = fillBuffers( makeBatch() );
+   const Vector<F32> *alphas = getUploadedAlphas( staticVB );
+   ASSERT_TRUE( alphas != NULL );
+   EXPECT_FLOAT_EQ( 1.0f, (*alphas)[1] );
+
+   // While a decal fades the batch goes to the dynamic buffers
+   // and the static ones are left alone.
+   for ( U32 frame = 0; frame < 3; frame++ )
+   {
+      decals[1]->mLastAlpha = 0.8f - frame * 0.2f;
+      decals[1]->mFading = true;
+
+      GFXVertexBufferHandle<DecalVertex> *vb = fillBuffers( makeBatch() );
+      EXPECT_TRUE( isDynamicBuffer( vb ) ) << "Frame " << frame;
+      ASSERT_TRUE( getUploadedAlphas( staticVB ) == alphas ) << "Frame " << frame;
+      EXPECT_FLOAT_EQ( 1.0f, (*alphas)[1] ) << "Frame " << frame;
+   }
+
+   // Once the fade ends the static buffers get the last alpha.
+   decals[1]->mFading = false;
+   EXPECT_EQ( staticVB, fillBuffers( makeBatch() ) );
+   EXPECT_FLOAT_EQ( decals[1]->mLastAlpha, (*alphas)[1] );
+
+   freeBatchBuffers();
+}
+
+#endif
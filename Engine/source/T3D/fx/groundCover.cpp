@@ -1021,6 +1021,17 @@ void GroundCover::_initialize( U32 cellCount, U32 cellPlacementCount )
    }
 }
 
+/// A random placement waiting for its terrain query.
+struct GroundCoverCandidate
+{
+   TerrainBlock *terrain;
+   Point2F point;
+   Point2F terrainPoint;
+   F32 size;
+   F32 rotation;
+   F32 flip;
+};
+
 GroundCoverCell* GroundCover::_generateCell( const Point2I& index, 
                                              const Box3F& bounds, 
                                              U32 placementCount,
@@ -1082,6 +1093,14 @@ GroundCoverCell* GroundCover::_generateCell( const Point2I& index,
    // The RNG that we'll use in generation.
    MRandom rand( 0 );
 
+   // Scratch space for the batched terrain queries.
+   static Vector<GroundCoverCandidate> candidates;
+   static Vector<Point2F> queryPoints;
+   static Vector<F32> queryHeights;
+   static Vector<Point3F> queryNormals;
+   static Vector<U8> queryLayers;
+   static Vector<bool> queryHits;
+
    // We process one type at a time.
    for ( U32 type=0; type < MAX_COVERTYPES; type++ )
    {
@@ -1152,7 +1171,9 @@ GroundCoverCell* GroundCover::_generateCell( const Point2I& index,
       p.windAmplitude = typeWindScale;
       p.lmColor.set(1.0f,1.0f,1.0f);
 
-      // Generate all the cover elements for this type.
+      // Generate all the random placements for this type first, so
+      // that the terrain can be queried for all of them at once.
+      candidates.clear();
       for ( S32 i=0; i < typeCount; i++ )
       {
          // Do all the other random things here first as to not 
@@ -1206,31 +1227,82 @@ GroundCoverCell* GroundCover::_generateCell( const Point2I& index,
          if ( !terrainBlock )
             continue;
 
-         terrainLM = terrainBlock->getLightMap();
-         pos = terrainBlock->getPosition();
-
-         terrainSquareSize = (F32)terrainBlock->getSquareSize();
-         oneOverTerrainLength = 1.0f / terrainBlock->getWorldBlockSize();
-         oneOverTerrainSquareSize = 1.0f / terrainSquareSize;
+         candidates.increment();
+         GroundCoverCandidate &candidate = candidates.last();
+         candidate.terrain = terrainBlock;
+         candidate.point = cp;
 
          // The size is calculated using an exponent to control 
          // the frequency between min and max sizes.
          sizeExponent = mClampF( mPow( rand.randF(), mSizeExponent[type] ), 0.0f, 1.0f );
-         size = mSizeMin[type] + ( typeSizeRange * sizeExponent );
+         candidate.size = mSizeMin[type] + ( typeSizeRange * sizeExponent );
 
          // Generate a random z rotation.
-         rotation = rand.randF() * M_2PI_F;
+         candidate.rotation = rand.randF() * M_2PI_F;
 
          // Flip the billboard now for the next generation.
          flipBB *= -1.0f;
+         candidate.flip = flipBB;
 
-         PROFILE_START( GroundCover_TerrainRayCast );
          // Transform billboard point into terrain's frame of reference.
          Point3F pp = Point3F(cp.x, cp.y, 0);
          terrainBlock->getWorldTransform().mulP(pp);
-         hit = terrainBlock->getNormalHeightMaterial( Point2F ( pp.x, pp.y ),
-                                                      &normal, &h, matName );
-         PROFILE_END(); // GroundCover_TerrainRayCast
+         candidate.terrainPoint.set( pp.x, pp.y );
+      }
+
+      // Get the height, normal, and material of all the placements
+      // with one batched query for each terrain they landed on.
+      PROFILE_START( GroundCover_TerrainRayCast );
+      queryPoints.setSize( candidates.size() );
+      queryHeights.setSize( candidates.size() );
+      queryNormals.setSize( candidates.size() );
+      queryLayers.setSize( candidates.size() );
+      queryHits.setSize( candidates.size() );
+      for ( U32 i=0; i < candidates.size(); )
+      {
+         // Placements on the same terrain come in runs.
+         TerrainBlock *terrain = candidates[i].terrain;
+         U32 count = 0;
+         while ( i + count < candidates.size() && candidates[i + count].terrain == terrain )
+         {
+            queryPoints[i + count] = candidates[i + count].terrainPoint;
+            count++;
+         }
+
+         terrain->getHeights( queryPoints.address() + i, count,
+                              queryHeights.address() + i,
+                              queryNormals.address() + i,
+                              queryLayers.address() + i,
+                              queryHits.address() + i );
+         i += count;
+      }
+      PROFILE_END(); // GroundCover_TerrainRayCast
+
+      for ( U32 i=0; i < candidates.size(); i++ )
+      {
+         const GroundCoverCandidate &candidate = candidates[i];
+         terrainBlock = candidate.terrain;
+         cp = candidate.point;
+         size = candidate.size;
+         rotation = candidate.rotation;
+         flipBB = candidate.flip;
+
+         terrainLM = terrainBlock->getLightMap();
+         pos = terrainBlock->getPosition();
+
+         terrainSquareSize = (F32)terrainBlock->getSquareSize();
+         oneOverTerrainLength = 1.0f / terrainBlock->getWorldBlockSize();
+         oneOverTerrainSquareSize = 1.0f / terrainSquareSize;
+
+         hit = queryHits[i];
+         h = queryHeights[i];
+         normal = queryNormals[i];
+         if ( hit )
+         {
+            matName = terrainBlock->getMaterialName( queryLayers[i] );
+            if ( !matName )
+               matName = StringTable->EmptyString();
+         }
          
          // TODO: When did we loose the world space elevation when
          // getting the terrain height?
@@ -1316,7 +1388,7 @@ GroundCoverCell* GroundCover::_generateCell( const Point2I& index,
             renderBounds.extend( p.worldBox.maxExtents );
          }
 
-      } // for ( S32 i=0; i < typeCount; i++ )
+      } // for ( U32 i=0; i < candidates.size(); i++ )
 
    } // for ( U32 type=0; type < NumCoverTypes; type++ )
       
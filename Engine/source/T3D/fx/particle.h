@@ -122,7 +122,6 @@ struct Particle
    F32              size;
 
    F32              spinSpeed;
-   Particle *       next;
 };
 
 
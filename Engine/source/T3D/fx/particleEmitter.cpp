@@ -37,6 +37,7 @@
 #include "T3D/gameBase/gameProcess.h"
 #include "lighting/lightInfo.h"
 #include "console/engineAPI.h"
+#include "platform/threads/threadPoolTaskSet.h"
 
 #if defined(TORQUE_OS_XENON)
 #  include "gfx/D3D9/360/gfx360MemVertexBuffer.h"
@@ -44,6 +45,15 @@
 
 Point3F ParticleEmitter::mWindVelocity( 0.0, 0.0, 0.0 );
 const F32 ParticleEmitter::AgedSpinToRadians = (1.0f/1000.0f) * (1.0f/360.0f) * M_PI_F * 2.0f;
+bool ParticleEmitter::smThreadedParticles = true;
+
+/// Number of emitters updated by one job.
+static const U32 sEmittersPerUpdateJob = 4;
+
+/// Emitters with a queued simulation step or vertex build.
+static Vector<ParticleEmitter*> sUpdateQueue;
+
+static bool sVertexBatch = false;
 
 IMPLEMENT_CO_DATABLOCK_V1(ParticleEmitterData);
 IMPLEMENT_CONOBJECT(ParticleEmitter);
@@ -732,11 +742,12 @@ ParticleEmitter::ParticleEmitter()
    mLifetimeMS = 0;
    mElapsedTimeMS = 0;
 
-   part_store = 0;
-   part_freelist = NULL;
-   part_list_head.next = NULL;
    n_part_capacity = 0;
-   n_parts = 0;
+
+   mPendingUpdateMS = 0;
+   mUpdateQueued = false;
+   mVertsQueued = false;
+   mVertsReady = false;
 
    mCurBuffSize = 0;
 
@@ -752,10 +763,19 @@ ParticleEmitter::ParticleEmitter()
 //-----------------------------------------------------------------------------
 ParticleEmitter::~ParticleEmitter()
 {
-   for( S32 i = 0; i < part_store.size(); i++ )
-   {
-      delete [] part_store[i];
-   }
+}
+
+//-----------------------------------------------------------------------------
+// consoleInit
+//-----------------------------------------------------------------------------
+void ParticleEmitter::consoleInit()
+{
+   Con::addVariable( "$pref::Particles::threaded", TypeBool, &smThreadedParticles,
+      "@brief Simulates particles and builds the vertices of visible emitters on the thread pool.\n"
+      "The default value is true.\n"
+      "@ingroup FX\n" );
+
+   SceneRenderState::getAnimationBatchSignal().notify( &ParticleEmitter::_onAnimationBatch );
 }
 
 //-----------------------------------------------------------------------------
@@ -789,6 +809,13 @@ bool ParticleEmitter::onAdd()
 //-----------------------------------------------------------------------------
 void ParticleEmitter::onRemove()
 {
+   syncUpdate();
+   if( mUpdateQueued )
+   {
+      sUpdateQueue.remove( this );
+      mUpdateQueued = false;
+   }
+
    removeFromScene();
    Parent::onRemove();
 }
@@ -809,30 +836,15 @@ bool ParticleEmitter::onNewDataBlock( GameBaseData *dptr, bool reload )
       mLifetimeMS += S32( gRandGen.randI() % (2 * mDataBlock->lifetimeVarianceMS + 1)) - S32(mDataBlock->lifetimeVarianceMS );
    }
 
-   //   Allocate particle structures and init the freelist. Member part_store
-   //   is a Vector so that we can allocate more particles if partListInitSize
+   //   Reserve the particle pool. The pool grows if partListInitSize
    //   turns out to be too small. 
    //
    if (mDataBlock->partListInitSize > 0)
    {
-      for( S32 i = 0; i < part_store.size(); i++ )
-      {
-         delete [] part_store[i];
-      }
-      part_store.clear();
+      syncUpdate();
+      mParticles.clear();
       n_part_capacity = mDataBlock->partListInitSize;
-      Particle* store_block = new Particle[n_part_capacity];
-      part_store.push_back(store_block);
-      part_freelist = store_block;
-      Particle* last_part = part_freelist;
-      Particle* part = last_part+1;
-      for( S32 i = 1; i < n_part_capacity; i++, part++, last_part++ )
-      {
-         last_part->next = part;
-      }
-      store_block[n_part_capacity-1].next = NULL;
-      part_list_head.next = NULL;
-      n_parts = 0;
+      mParticles.reserve(n_part_capacity);
    }
 
    scriptOnNewDataBlock();
@@ -847,10 +859,12 @@ ColorF ParticleEmitter::getCollectiveColor()
 	U32 count = 0;
 	ColorF color = ColorF(0.0f, 0.0f, 0.0f);
 
-   count = n_parts;
-   for( Particle* part = part_list_head.next; part != NULL; part = part->next )
+   syncUpdate();
+
+   count = mParticles.size();
+   for( U32 i = 0; i < count; i++ )
    {
-      color += part->color;
+      color += mParticles.getColor( i );
    }
 
 	if(count > 0)
@@ -868,8 +882,38 @@ ColorF ParticleEmitter::getCollectiveColor()
 //-----------------------------------------------------------------------------
 // prepRenderImage
 //-----------------------------------------------------------------------------
+void ParticleEmitter::prepAnimation(SceneRenderState* state)
+{
+   if( !sVertexBatch || mDead )
+      return;
+
+   if( state->isReflectPass() && !getDataBlock()->renderReflection )
+      return;
+
+   // Never render into shadows.
+   if (state->isShadowPass())
+      return;
+
+   // Build the vertices for this pass in the batch.
+   mVertsQueued = true;
+   mVertsReady = false;
+   mVertsCamPos = state->getCameraPosition();
+   mVertsAmbient = state->getAmbientLightColor();
+   mVertsWorldMat = GFX->getWorldMatrix();
+
+   if( !mUpdateQueued )
+   {
+      mUpdateQueued = true;
+      sUpdateQueue.push_back( this );
+   }
+}
+
 void ParticleEmitter::prepRenderImage(SceneRenderState* state)
 {
+   // Vertices built by the batch are only good for this pass.
+   const bool vertsReady = mVertsReady;
+   mVertsReady = false;
+
    if( state->isReflectPass() && !getDataBlock()->renderReflection )
       return;
 
@@ -879,14 +923,18 @@ void ParticleEmitter::prepRenderImage(SceneRenderState* state)
 
    PROFILE_SCOPE(ParticleEmitter_prepRenderImage);
 
+   syncUpdate();
+
    if (  mDead ||
-         n_parts == 0 || 
-         part_list_head.next == NULL )
+         mParticles.empty() )
       return;
 
    RenderPassManager *renderManager = state->getRenderPass();
    const Point3F &camPos = state->getCameraPosition();
-   copyToVB( camPos, state->getAmbientLightColor() );
+   if( vertsReady )
+      uploadVerts();
+   else
+      copyToVB( camPos, state->getAmbientLightColor() );
 
    if (!mVertBuff.isValid())
       return;
@@ -911,17 +959,17 @@ void ParticleEmitter::prepRenderImage(SceneRenderState* state)
 
    ri->bbModelViewProj = renderManager->allocUniqueXform( *ri->modelViewProj * mBBObjToWorld );
 
-   ri->count = n_parts;
+   ri->count = mParticles.size();
 
    ri->blendStyle = mDataBlock->blendStyle;
 
    ri->glow = mDataBlock->glow;
 
-   // use first particle's texture unless there is an emitter texture to override it
+   // use newest particle's texture unless there is an emitter texture to override it
    if (mDataBlock->textureHandle)
      ri->diffuseTex = &*(mDataBlock->textureHandle);
    else
-     ri->diffuseTex = &*(part_list_head.next->dataBlock->textureHandle);
+     ri->diffuseTex = &*(mParticles.getDataBlock( mParticles.size() - 1 )->textureHandle);
 
    ri->softnessDistance = mDataBlock->softnessDistance; 
 
@@ -972,7 +1020,8 @@ void ParticleEmitter::deleteWhenEmpty()
    if (okToDelete)
    {
       mDeleteWhenEmpty = true;
-      if( !n_parts )
+      syncUpdate();
+      if( mParticles.empty() )
       {
          // We're already empty, so delete us now.
 
@@ -1027,6 +1076,8 @@ void ParticleEmitter::emitParticles(const Point3F& start,
    if( mDataBlock->particleDataBlocks.empty() )
       return;
 
+   syncUpdate();
+
    // lifetime over - no more particles
    if( mLifetimeMS > 0 && mElapsedTimeMS > mLifetimeMS )
    {
@@ -1104,36 +1155,26 @@ void ParticleEmitter::emitParticles(const Point3F& start,
       //   This override-advance code is restored in order to correctly adjust
       //   animated parameters of particles allocated within the same frame
       //   update. Note that ordering is important and this code correctly 
-      //   adds particles in the same newest-to-oldest ordering of the link-list.
+      //   adds particles in the same oldest-to-newest ordering of the pool.
       //
-      // NOTE: We are assuming that the just added particle is at the head of our
-      //  list.  If that changes, so must this...
+      // NOTE: We are assuming that the just added particle is at the end of our
+      //  pool.  If that changes, so must this...
       U32 advanceMS = numMilliseconds - currTime;
       if (mDataBlock->overrideAdvance == false && advanceMS != 0) 
       {
-         Particle* last_part = part_list_head.next;
-         if (advanceMS > last_part->totalLifetime) 
+         const U32 last_part = mParticles.size() - 1;
+         if (advanceMS > mParticles.getLifetimes()[last_part]) 
          {
-           part_list_head.next = last_part->next;
-           n_parts--;
-           last_part->next = part_freelist;
-           part_freelist = last_part;
+           mParticles.removeLast();
          } 
          else 
          {
             if (advanceMS != 0)
             {
-              F32 t = F32(advanceMS) / 1000.0;
-
-              Point3F a = last_part->acc;
-              a -= last_part->vel * last_part->dataBlock->dragCoefficient;
-              a -= mWindVelocity * last_part->dataBlock->windCoefficient;
-              a += Point3F(0.0f, 0.0f, -9.81f) * last_part->dataBlock->gravityCoefficient;
-
-              last_part->vel += a * t;
-              last_part->pos += last_part->vel * t;
-
-              updateKeyData( last_part );
+              mParticles.integrate( last_part, 1, advanceMS, mWindVelocity );
+              mParticles.updateKeyData( last_part, 1,
+                                        mDataBlock->useEmitterColors ? colors : NULL,
+                                        mDataBlock->useEmitterSizes ? sizes : NULL );
             }
          }
       }
@@ -1144,7 +1185,7 @@ void ParticleEmitter::emitParticles(const Point3F& start,
       updateBBox();
 
 
-   if( n_parts > 0 && getSceneManager() == NULL )
+   if( !mParticles.empty() && getSceneManager() == NULL )
    {
       gClientSceneGraph->addObjectToScene(this);
       ClientProcessList::get()->addObject(this);
@@ -1165,6 +1206,8 @@ void ParticleEmitter::emitParticles(const Point3F& rCenter,
 {
    if( mDead ) return;
 
+   syncUpdate();
+
    // lifetime over - no more particles
    if( mLifetimeMS > 0 && mElapsedTimeMS > mLifetimeMS )
    {
@@ -1214,7 +1257,7 @@ void ParticleEmitter::emitParticles(const Point3F& rCenter,
    resetWorldBox();
 
    // Make sure we're part of the world
-   if( n_parts > 0 && getSceneManager() == NULL )
+   if( !mParticles.empty() && getSceneManager() == NULL )
    {
       gClientSceneGraph->addObjectToScene(this);
       ClientProcessList::get()->addObject(this);
@@ -1231,11 +1274,16 @@ void ParticleEmitter::updateBBox()
    Point3F minPt(1e10,   1e10,  1e10);
    Point3F maxPt(-1e10, -1e10, -1e10);
 
-   for (Particle* part = part_list_head.next; part != NULL; part = part->next)
+   const F32 *posX = mParticles.getFloats( ParticlePool::PosX );
+   const F32 *posY = mParticles.getFloats( ParticlePool::PosY );
+   const F32 *posZ = mParticles.getFloats( ParticlePool::PosZ );
+   const F32 *size = mParticles.getFloats( ParticlePool::Size );
+   for (U32 i = 0; i < mParticles.size(); i++)
    {
-      Point3F particleSize(part->size * 0.5f, 0.0f, part->size * 0.5f);
-      minPt.setMin( part->pos - particleSize );
-      maxPt.setMax( part->pos + particleSize );
+      Point3F pos(posX[i], posY[i], posZ[i]);
+      Point3F particleSize(size[i] * 0.5f, 0.0f, size[i] * 0.5f);
+      minPt.setMin( pos - particleSize );
+      maxPt.setMax( pos + particleSize );
    }
    
    mObjBox = Box3F(minPt, maxPt);
@@ -1258,25 +1306,16 @@ void ParticleEmitter::addParticle(const Point3F& pos,
                                   const Point3F& vel,
                                   const Point3F& axisx)
 {
-   n_parts++;
+   S32 n_parts = mParticles.size() + 1;
    if (n_parts > n_part_capacity || n_parts > mDataBlock->partListInitSize)
    {
       // In an emergency we allocate additional particles in blocks of 16.
       // This should happen rarely.
-      Particle* store_block = new Particle[16];
-      part_store.push_back(store_block);
       n_part_capacity += 16;
-      for (S32 i = 0; i < 16; i++)
-      {
-        store_block[i].next = part_freelist;
-        part_freelist = &store_block[i];
-      }
       mDataBlock->allocPrimBuffer(n_part_capacity); // allocate larger primitive buffer or will crash 
    }
-   Particle* pNew = part_freelist;
-   part_freelist = pNew->next;
-   pNew->next = part_list_head.next;
-   part_list_head.next = pNew;
+   Particle newPart;
+   Particle* pNew = &newPart;
 
    Point3F ejectionAxis = axis;
    F32 theta = (mDataBlock->thetaMax - mDataBlock->thetaMin) * gRandGen.randF() +
@@ -1308,7 +1347,11 @@ void ParticleEmitter::addParticle(const Point3F& pos,
    // Choose a new particle datablack randomly from the list
    U32 dBlockIndex = gRandGen.randI() % mDataBlock->particleDataBlocks.size();
    mDataBlock->particleDataBlocks[dBlockIndex]->initializeParticle(pNew, vel);
-   updateKeyData( pNew );
+
+   const U32 index = mParticles.add( newPart );
+   mParticles.updateKeyData( index, 1,
+                             mDataBlock->useEmitterColors ? colors : NULL,
+                             mDataBlock->useEmitterSizes ? sizes : NULL );
 
 }
 
@@ -1318,6 +1361,8 @@ void ParticleEmitter::addParticle(const Point3F& pos,
 //-----------------------------------------------------------------------------
 void ParticleEmitter::processTick(const Move*)
 {
+   syncUpdate();
+
    if( mDeleteOnTick == true )
    {
       mDead = true;
@@ -1344,87 +1389,122 @@ void ParticleEmitter::advanceTime(F32 dt)
    U32 numMSToUpdate = (U32)(dt * 1000.0f);
    if( numMSToUpdate == 0 ) return;
 
-   // TODO: Prefetch
+   // Updates are not merged, two steps don't give the same result as one.
+   syncUpdate();
 
-   // remove dead particles
-   Particle* last_part = &part_list_head;
-   for (Particle* part = part_list_head.next; part != NULL; part = part->next)
+   if( smThreadedParticles )
    {
-     part->currentAge += numMSToUpdate;
-     if (part->currentAge > part->totalLifetime)
-     {
-       n_parts--;
-       last_part->next = part->next;
-       part->next = part_freelist;
-       part_freelist = part;
-       part = last_part;
-     }
-     else
-     {
-       last_part = part;
-     }
+      mPendingUpdateMS = numMSToUpdate;
+      if( !mUpdateQueued )
+      {
+         mUpdateQueued = true;
+         sUpdateQueue.push_back( this );
+      }
+      return;
    }
 
-   AssertFatal( n_parts >= 0, "ParticleEmitter: negative part count!" );
+   advanceParticles( numMSToUpdate );
+}
+
+//-----------------------------------------------------------------------------
+// advanceParticles
+//-----------------------------------------------------------------------------
+void ParticleEmitter::advanceParticles( U32 ms )
+{
+   // remove dead particles
+   mParticles.age( ms );
 
-   if (n_parts < 1 && mDeleteWhenEmpty)
+   if (mParticles.empty() && mDeleteWhenEmpty)
    {
       mDeleteOnTick = true;
       return;
    }
 
-   if( numMSToUpdate != 0 && n_parts > 0 )
+   if( !mParticles.empty() )
    {
-      update( numMSToUpdate );
+      update( ms );
    }
 }
 
+void ParticleEmitter::syncUpdate()
+{
+   if( mPendingUpdateMS == 0 )
+      return;
+
+   const U32 ms = mPendingUpdateMS;
+   mPendingUpdateMS = 0;
+   advanceParticles( ms );
+}
+
 //-----------------------------------------------------------------------------
-// Update key related particle data
+// Threaded update
 //-----------------------------------------------------------------------------
-void ParticleEmitter::updateKeyData( Particle *part )
+
+/// Updates the queued emitters in chunks of sEmittersPerUpdateJob.
+struct ParticleEmitter::UpdateJob : public ThreadPoolTaskSet
 {
-	//Ensure that our lifetime is never below 0
-	if( part->totalLifetime < 1 )
-		part->totalLifetime = 1;
+   ParticleEmitter * const *mEmitters;
+   U32 mCount;
 
-   F32 t = F32(part->currentAge) / F32(part->totalLifetime);
-   AssertFatal(t <= 1.0f, "Out out bounds filter function for particle.");
+   UpdateJob( ParticleEmitter * const *emitters, U32 count )
+      : ThreadPoolTaskSet( ( count + sEmittersPerUpdateJob - 1 ) / sEmittersPerUpdateJob ),
+        mEmitters( emitters ),
+        mCount( count )
+   {
+   }
 
-   for( U32 i = 1; i < ParticleData::PDC_NUM_KEYS; i++ )
+protected:
+   virtual void runTask( U32 index )
    {
-      if( part->dataBlock->times[i] >= t )
-      {
-         F32 firstPart = t - part->dataBlock->times[i-1];
-         F32 total     = part->dataBlock->times[i] -
-                         part->dataBlock->times[i-1];
+      const U32 first = index * sEmittersPerUpdateJob;
+      const U32 last = getMin( first + sEmittersPerUpdateJob, mCount );
+      for ( U32 i = first; i < last; i++ )
+         mEmitters[i]->updateBatched();
+   }
+};
 
-         firstPart /= total;
+void ParticleEmitter::beginBatch()
+{
+   AssertFatal( !sVertexBatch, "ParticleEmitter::beginBatch - already batching" );
+   sVertexBatch = smThreadedParticles;
+}
 
-         if( mDataBlock->useEmitterColors )
-         {
-            part->color.interpolate(colors[i-1], colors[i], firstPart);
-         }
-         else
-         {
-            part->color.interpolate(part->dataBlock->colors[i-1],
-                                    part->dataBlock->colors[i],
-                                    firstPart);
-         }
+void ParticleEmitter::endBatch()
+{
+   PROFILE_SCOPE( ParticleEmitter_endBatch );
 
-         if( mDataBlock->useEmitterSizes )
-         {
-            part->size = (sizes[i-1] * (1.0 - firstPart)) +
-                         (sizes[i]   * firstPart);
-         }
-         else
-         {
-            part->size = (part->dataBlock->sizes[i-1] * (1.0 - firstPart)) +
-                         (part->dataBlock->sizes[i]   * firstPart);
-         }
-         break;
+   sVertexBatch = false;
+   if ( sUpdateQueue.empty() )
+      return;
 
-      }
+   ThreadSafeRef< UpdateJob > job( new UpdateJob( sUpdateQueue.address(), sUpdateQueue.size() ) );
+   job->run();
+
+   for ( U32 i = 0; i < sUpdateQueue.size(); i++ )
+      sUpdateQueue[i]->mUpdateQueued = false;
+   sUpdateQueue.clear();
+}
+
+void ParticleEmitter::_onAnimationBatch( bool begin, bool &outPrepAnimations )
+{
+   if ( begin )
+   {
+      beginBatch();
+      outPrepAnimations |= smThreadedParticles;
+   }
+   else
+      endBatch();
+}
+
+void ParticleEmitter::updateBatched()
+{
+   syncUpdate();
+
+   if ( mVertsQueued )
+   {
+      fillVerts( mVertsCamPos, mVertsAmbient, mVertsWorldMat );
+      mVertsQueued = false;
+      mVertsReady = true;
    }
 }
 
@@ -1433,40 +1513,24 @@ void ParticleEmitter::updateKeyData( Particle *part )
 //-----------------------------------------------------------------------------
 void ParticleEmitter::update( U32 ms )
 {
-   // TODO: Prefetch
-
-   for (Particle* part = part_list_head.next; part != NULL; part = part->next)
-   {
-      F32 t = F32(ms) / 1000.0;
+   PROFILE_SCOPE(ParticleEmitter_update);
 
-      Point3F a = part->acc;
-      a -= part->vel        * part->dataBlock->dragCoefficient;
-      a -= mWindVelocity * part->dataBlock->windCoefficient;
-      a += Point3F(0.0f, 0.0f, -9.81f) * part->dataBlock->gravityCoefficient;
-
-      part->vel += a * t;
-      part->pos += part->vel * t;
-
-      updateKeyData( part );
-   }
+   const U32 count = mParticles.size();
+   mParticles.integrate( 0, count, ms, mWindVelocity );
+   mParticles.updateKeyData( 0, count,
+                             mDataBlock->useEmitterColors ? colors : NULL,
+                             mDataBlock->useEmitterSizes ? sizes : NULL );
 }
 
 //-----------------------------------------------------------------------------
 // Copy particles to vertex buffer
 //-----------------------------------------------------------------------------
 
-// structure used for particle sorting.
-struct SortParticle
-{
-   Particle* p;
-   F32       k;
-};
-
 // qsort callback function for particle sorting
 S32 QSORT_CALLBACK cmpSortParticles(const void* p1, const void* p2)
 {
-   const SortParticle* sp1 = (const SortParticle*)p1;
-   const SortParticle* sp2 = (const SortParticle*)p2;
+   const ParticleEmitter::SortParticle* sp1 = (const ParticleEmitter::SortParticle*)p1;
+   const ParticleEmitter::SortParticle* sp2 = (const ParticleEmitter::SortParticle*)p2;
 
    if (sp2->k > sp1->k)
       return 1;
@@ -1478,133 +1542,85 @@ S32 QSORT_CALLBACK cmpSortParticles(const void* p1, const void* p2)
 
 void ParticleEmitter::copyToVB( const Point3F &camPos, const ColorF &ambientColor )
 {
-   static Vector<SortParticle> orderedVector(__FILE__, __LINE__);
+   PROFILE_SCOPE(ParticleEmitter_copyToVB);
+
+   fillVerts( camPos, ambientColor, GFX->getWorldMatrix() );
+   uploadVerts();
+}
+
+void ParticleEmitter::fillVerts( const Point3F &camPos, const ColorF &ambientColor, const MatrixF &worldMat )
+{
+   // This runs on the ThreadPool when batched, so it
+   // must not touch the GFX device or any shared state.
+   PROFILE_START(ParticleEmitter_fillVerts);
 
-   PROFILE_START(ParticleEmitter_copyToVB);
+   const S32 n_parts = mParticles.size();
 
-   PROFILE_START(ParticleEmitter_copyToVB_Sort);
-   // build sorted list of particles (far to near)
+   PROFILE_START(ParticleEmitter_fillVerts_Sort);
+   // build sorted list of particles (far to near), otherwise
+   // draw them newest first
+   mSortParticles.setSize( n_parts );
    if (mDataBlock->sortParticles)
    {
-     orderedVector.clear();
-
-     MatrixF modelview = GFX->getWorldMatrix();
-     Point3F viewvec; modelview.getRow(1, &viewvec);
+     Point3F viewvec; worldMat.getRow(1, &viewvec);
 
-     // add each particle and a distance based sort key to orderedVector
-     for (Particle* pp = part_list_head.next; pp != NULL; pp = pp->next)
+     // add each particle and a distance based sort key to mSortParticles
+     for (S32 i = 0; i < n_parts; i++)
      {
-       orderedVector.increment();
-       orderedVector.last().p = pp;
-       orderedVector.last().k = mDot(pp->pos, viewvec);
+       mSortParticles[i].index = n_parts - 1 - i;
+       mSortParticles[i].k = mDot(mParticles.getPos(n_parts - 1 - i), viewvec);
      }
 
      // qsort the list into far to near ordering
-     dQsort(orderedVector.address(), orderedVector.size(), sizeof(SortParticle), cmpSortParticles);
+     dQsort(mSortParticles.address(), mSortParticles.size(), sizeof(SortParticle), cmpSortParticles);
+   }
+   else
+   {
+     for (S32 i = 0; i < n_parts; i++)
+       mSortParticles[i].index = n_parts - 1 - i;
    }
    PROFILE_END();
 
-#if defined(TORQUE_OS_XENON)
-   // Allocate writecombined since we don't read back from this buffer (yay!)
-   if(mVertBuff.isNull())
-      mVertBuff = new GFX360MemVertexBuffer(GFX, 1, getGFXVertexFormat<ParticleVertexType>(), sizeof(ParticleVertexType), GFXBufferTypeDynamic, PAGE_WRITECOMBINE);
-   if( n_parts > mCurBuffSize )
+   mStagingVerts.setSize( n_parts * 4 );
+   ParticleVertexType *buffPtr = mStagingVerts.address(); // use direct pointer (faster)
+
+   S32 buffStep = 4;
+   if (mDataBlock->reverseOrder)
    {
-      mCurBuffSize = n_parts;
-      mVertBuff.resize(n_parts * 4);
+      buffPtr += 4*(n_parts-1);
+      buffStep = -4;
    }
 
-   ParticleVertexType *buffPtr = mVertBuff.lock();
-#else
-   static Vector<ParticleVertexType> tempBuff(2048);
-   tempBuff.reserve( n_parts*4 + 64); // make sure tempBuff is big enough
-   ParticleVertexType *buffPtr = tempBuff.address(); // use direct pointer (faster)
-#endif
-   
+   Particle part;
+   const SortParticle* partPtr = mSortParticles.address();
+
    if (mDataBlock->orientParticles)
    {
-      PROFILE_START(ParticleEmitter_copyToVB_Orient);
+      PROFILE_START(ParticleEmitter_fillVerts_Orient);
 
-      if (mDataBlock->reverseOrder)
+      for (S32 i = 0; i < n_parts; i++, partPtr++, buffPtr += buffStep)
       {
-        buffPtr += 4*(n_parts-1);
-        // do sorted-oriented particles
-        if (mDataBlock->sortParticles)
-        {
-          SortParticle* partPtr = orderedVector.address();
-          for (U32 i = 0; i < n_parts; i++, partPtr++, buffPtr-=4 )
-             setupOriented(partPtr->p, camPos, ambientColor, buffPtr);
-        }
-        // do unsorted-oriented particles
-        else
-        {
-          for (Particle* partPtr = part_list_head.next; partPtr != NULL; partPtr = partPtr->next, buffPtr-=4)
-             setupOriented(partPtr, camPos, ambientColor, buffPtr);
-        }
-      }
-      else
-      {
-        // do sorted-oriented particles
-        if (mDataBlock->sortParticles)
-        {
-          SortParticle* partPtr = orderedVector.address();
-          for (U32 i = 0; i < n_parts; i++, partPtr++, buffPtr+=4 )
-             setupOriented(partPtr->p, camPos, ambientColor, buffPtr);
-        }
-        // do unsorted-oriented particles
-        else
-        {
-          for (Particle* partPtr = part_list_head.next; partPtr != NULL; partPtr = partPtr->next, buffPtr+=4)
-             setupOriented(partPtr, camPos, ambientColor, buffPtr);
-        }
+         mParticles.get(partPtr->index, part);
+         setupOriented(&part, camPos, ambientColor, buffPtr);
       }
+
 	  PROFILE_END();
    }
    else if (mDataBlock->alignParticles)
    {
-      PROFILE_START(ParticleEmitter_copyToVB_Aligned);
+      PROFILE_START(ParticleEmitter_fillVerts_Aligned);
 
-      if (mDataBlock->reverseOrder)
+      for (S32 i = 0; i < n_parts; i++, partPtr++, buffPtr += buffStep)
       {
-         buffPtr += 4*(n_parts-1);
-
-         // do sorted-oriented particles
-         if (mDataBlock->sortParticles)
-         {
-            SortParticle* partPtr = orderedVector.address();
-            for (U32 i = 0; i < n_parts; i++, partPtr++, buffPtr-=4 )
-               setupAligned(partPtr->p, ambientColor, buffPtr);
-         }
-         // do unsorted-oriented particles
-         else
-         {
-            Particle *partPtr = part_list_head.next;
-            for (; partPtr != NULL; partPtr = partPtr->next, buffPtr-=4)
-               setupAligned(partPtr, ambientColor, buffPtr);
-         }
-      }
-      else
-      {
-         // do sorted-oriented particles
-         if (mDataBlock->sortParticles)
-         {
-            SortParticle* partPtr = orderedVector.address();
-            for (U32 i = 0; i < n_parts; i++, partPtr++, buffPtr+=4 )
-               setupAligned(partPtr->p, ambientColor, buffPtr);
-         }
-         // do unsorted-oriented particles
-         else
-         {
-            Particle *partPtr = part_list_head.next;
-            for (; partPtr != NULL; partPtr = partPtr->next, buffPtr+=4)
-               setupAligned(partPtr, ambientColor, buffPtr);
-         }
+         mParticles.get(partPtr->index, part);
+         setupAligned(&part, ambientColor, buffPtr);
       }
+
 	  PROFILE_END();
    }
    else
    {
-      PROFILE_START(ParticleEmitter_copyToVB_NonOriented);
+      PROFILE_START(ParticleEmitter_fillVerts_NonOriented);
       // somewhat odd ordering so that texture coordinates match the oriented
       // particles
       Point3F basePoints[4];
@@ -1613,64 +1629,49 @@ void ParticleEmitter::copyToVB( const Point3F &camPos, const ColorF &ambientColo
       basePoints[2] = Point3F( 1.0, 0.0, -1.0);
       basePoints[3] = Point3F( 1.0, 0.0,  1.0);
 
-      MatrixF camView = GFX->getWorldMatrix();
+      MatrixF camView = worldMat;
       camView.transpose();  // inverse - this gets the particles facing camera
 
-      if (mDataBlock->reverseOrder)
+      for (S32 i = 0; i < n_parts; i++, partPtr++, buffPtr += buffStep)
       {
-        buffPtr += 4*(n_parts-1);
-        // do sorted-billboard particles
-        if (mDataBlock->sortParticles)
-        {
-          SortParticle *partPtr = orderedVector.address();
-          for( U32 i=0; i<n_parts; i++, partPtr++, buffPtr-=4 )
-             setupBillboard( partPtr->p, basePoints, camView, ambientColor, buffPtr );
-        }
-        // do unsorted-billboard particles
-        else
-        {
-          for (Particle* partPtr = part_list_head.next; partPtr != NULL; partPtr = partPtr->next, buffPtr-=4)
-             setupBillboard( partPtr, basePoints, camView, ambientColor, buffPtr );
-        }
-      }
-      else
-      {
-        // do sorted-billboard particles
-        if (mDataBlock->sortParticles)
-        {
-          SortParticle *partPtr = orderedVector.address();
-          for( U32 i=0; i<n_parts; i++, partPtr++, buffPtr+=4 )
-             setupBillboard( partPtr->p, basePoints, camView, ambientColor, buffPtr );
-        }
-        // do unsorted-billboard particles
-        else
-        {
-          for (Particle* partPtr = part_list_head.next; partPtr != NULL; partPtr = partPtr->next, buffPtr+=4)
-             setupBillboard( partPtr, basePoints, camView, ambientColor, buffPtr );
-        }
+         mParticles.get(partPtr->index, part);
+         setupBillboard(&part, basePoints, camView, ambientColor, buffPtr);
       }
 
       PROFILE_END();
    }
 
+   PROFILE_END();
+}
+
+void ParticleEmitter::uploadVerts()
+{
+   PROFILE_SCOPE(ParticleEmitter_uploadVerts);
+
+   const S32 n_parts = mStagingVerts.size() / 4;
+
 #if defined(TORQUE_OS_XENON)
-   mVertBuff.unlock();
+   // Allocate writecombined since we don't read back from this buffer (yay!)
+   if(mVertBuff.isNull())
+      mVertBuff = new GFX360MemVertexBuffer(GFX, 1, getGFXVertexFormat<ParticleVertexType>(), sizeof(ParticleVertexType), GFXBufferTypeDynamic, PAGE_WRITECOMBINE);
+   if( n_parts > mCurBuffSize )
+   {
+      mCurBuffSize = n_parts;
+      mVertBuff.resize(n_parts * 4);
+   }
 #else
-   PROFILE_START(ParticleEmitter_copyToVB_LockCopy);
    // create new VB if emitter size grows
    if( !mVertBuff || n_parts > mCurBuffSize )
    {
       mCurBuffSize = n_parts;
       mVertBuff.set( GFX, n_parts * 4, GFXBufferTypeDynamic );
    }
-   // lock and copy tempBuff to video RAM
-   ParticleVertexType *verts = mVertBuff.lock();
-   dMemcpy( verts, tempBuff.address(), n_parts * 4 * sizeof(ParticleVertexType) );
-   mVertBuff.unlock();
-   PROFILE_END();
 #endif
 
-   PROFILE_END();
+   // lock and copy the staging verts to video RAM
+   ParticleVertexType *verts = mVertBuff.lock();
+   dMemcpy( verts, mStagingVerts.address(), n_parts * 4 * sizeof(ParticleVertexType) );
+   mVertBuff.unlock();
 }
 
 //-----------------------------------------------------------------------------
@@ -38,6 +38,9 @@
 #ifndef _PARTICLE_H_
 #include "T3D/fx/particle.h"
 #endif
+#ifndef _PARTICLEPOOL_H_
+#include "T3D/fx/particlePool.h"
+#endif
 
 #if defined(TORQUE_OS_XENON)
 #include "gfx/D3D9/360/gfx360MemVertexBuffer.h"
@@ -134,13 +137,41 @@ class ParticleEmitter : public GameBase
      typedef GFXVertexPCT ParticleVertexType;
 #endif
 
+   /// Particle index and distance based sort key.
+   struct SortParticle
+   {
+      U32 index;
+      F32 k;
+   };
+
    ParticleEmitter();
    ~ParticleEmitter();
 
    DECLARE_CONOBJECT(ParticleEmitter);
+   static void consoleInit();
 
    static Point3F mWindVelocity;
    static void setWindVelocity( const Point3F &vel ){ mWindVelocity = vel; }
+
+   /// @name Threaded Update
+   /// When enabled, advanceTime() only queues the particle simulation and
+   /// the emitters are simulated together on the ThreadPool by the next
+   /// endBatch().  Visible emitters also build their vertices there, see
+   /// prepAnimation().  Anything else touching the particles of a queued
+   /// emitter finishes its update on the main thread first.
+   /// @{
+
+   static bool smThreadedParticles;
+
+   static void beginBatch();
+   static void endBatch();
+
+   /// Opens and closes the batch around the prepAnimation() pass of
+   /// SceneRenderState::renderObjects().  This also finishes the particle
+   /// simulation queued since the last batch.
+   static void _onAnimationBatch( bool begin, bool &outPrepAnimations );
+
+   /// @}
    
    ColorF getCollectiveColor();
 
@@ -229,14 +260,30 @@ class ParticleEmitter : public GameBase
 
    // Rendering
   protected:
+   void prepAnimation( SceneRenderState *state );
    void prepRenderImage( SceneRenderState *state );
    void copyToVB( const Point3F &camPos, const ColorF &ambientColor );
 
+   /// Fill mStagingVerts for the current particles.
+   void fillVerts( const Point3F &camPos, const ColorF &ambientColor, const MatrixF &worldMat );
+
+   /// Upload mStagingVerts to mVertBuff.
+   void uploadVerts();
+
    // PEngine interface
   private:
 
+   struct UpdateJob;
+
+   /// Age, remove and simulate the particles.
+   void advanceParticles( U32 ms );
    void update( U32 ms );
-   inline void updateKeyData( Particle *part );
+
+   /// Finish the queued particle update, if any, on this thread.
+   void syncUpdate();
+
+   /// Run the queued work of this emitter from a batch job.
+   void updateBatched();
  
 
   private:
@@ -270,16 +317,25 @@ class ParticleEmitter : public GameBase
    GFXVertexBufferHandle<ParticleVertexType> mVertBuff;
 #endif
 
-   //   These members are for implementing a link-list of the active emitter 
-   //   particles. Member part_store contains blocks of particles that can be
-   //   chained in a link-list. Usually the first part_store block is large
-   //   enough to contain all the particles but it can be expanded in emergency
-   //   circumstances.
-   Vector <Particle*> part_store;
-   Particle*  part_freelist;
-   Particle   part_list_head;
+   //   The active emitter particles, oldest first.  Usually the pool reserved
+   //   in onNewDataBlock is large enough to contain all the particles but it
+   //   can be expanded in emergency circumstances.
+   ParticlePool mParticles;
    S32        n_part_capacity;
-   S32        n_parts;
+
+   /// Milliseconds of simulation queued by advanceTime().
+   U32       mPendingUpdateMS;
+   bool      mUpdateQueued;
+
+   /// Vertex generation queued by prepAnimation() and its view.
+   bool      mVertsQueued;
+   bool      mVertsReady;
+   Point3F   mVertsCamPos;
+   ColorF    mVertsAmbient;
+   MatrixF   mVertsWorldMat;
+
+   Vector<SortParticle> mSortParticles;
+   Vector<ParticleVertexType> mStagingVerts;
    S32       mCurBuffSize;
 
 };
@@ -0,0 +1,487 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "T3D/fx/particlePool.h"
+
+#if defined(TORQUE_CPU_X64) || defined(__SSE2__) || (defined(TORQUE_CPU_X86) && defined(_MSC_VER))
+#  define PARTICLEPOOL_SSE
+#  include <emmintrin.h>
+#endif
+
+bool ParticlePool::smUseSIMD = true;
+
+static const F32 sGravity = -9.81f;
+
+//-----------------------------------------------------------------------------
+// constructor
+//-----------------------------------------------------------------------------
+ParticlePool::ParticlePool()
+ : mMem( NULL ),
+   mCapacity( 0 ),
+   mFirst( 0 ),
+   mSize( 0 )
+{
+   dMemset( mArrays, 0, sizeof( mArrays ) );
+}
+
+//-----------------------------------------------------------------------------
+// destructor
+//-----------------------------------------------------------------------------
+ParticlePool::~ParticlePool()
+{
+   if( mMem )
+      dFree_aligned( mMem );
+}
+
+U32 ParticlePool::_getElementSize( U32 array )
+{
+   if( array < NumFloatArrays )
+      return sizeof( F32 );
+   if( array == DataBlock )
+      return sizeof( ParticleData* );
+   return sizeof( U32 );
+}
+
+//-----------------------------------------------------------------------------
+// reserve
+//-----------------------------------------------------------------------------
+void ParticlePool::reserve( U32 count )
+{
+   if( count <= mCapacity )
+      return;
+
+   // Keep the arrays 16 byte aligned.
+   const U32 capacity = ( count + 3 ) & ~3;
+
+   U32 bytes = 0;
+   for( U32 a = 0; a < NumArrays; a++ )
+      bytes += capacity * _getElementSize( a );
+
+   U8 *mem = reinterpret_cast<U8*>( dMalloc_aligned( bytes, 16 ) );
+   AssertFatal( mem, "ParticlePool::reserve - Aligned malloc failed!" );
+
+   // Copy the live particles to the start of the new arrays.
+   for( U32 a = 0; a < NumArrays; a++ )
+   {
+      const U32 elemSize = _getElementSize( a );
+      if( mSize )
+         dMemcpy( mem, mArrays[a] + mFirst * elemSize, mSize * elemSize );
+      mArrays[a] = mem;
+      mem += capacity * elemSize;
+   }
+
+   if( mMem )
+      dFree_aligned( mMem );
+   mMem = mArrays[0];
+   mCapacity = capacity;
+   mFirst = 0;
+}
+
+void ParticlePool::_move( U32 dst, U32 src, U32 count )
+{
+   for( U32 a = 0; a < NumArrays; a++ )
+   {
+      const U32 elemSize = _getElementSize( a );
+      dMemmove( mArrays[a] + dst * elemSize, mArrays[a] + src * elemSize, count * elemSize );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// add
+//-----------------------------------------------------------------------------
+U32 ParticlePool::add( const Particle &part )
+{
+   if( mFirst + mSize == mCapacity )
+   {
+      // Slide the particles back to the start if that frees
+      // up enough room, otherwise grow.
+      if( mFirst > mCapacity / 2 )
+      {
+         _move( 0, mFirst, mSize );
+         mFirst = 0;
+      }
+      else
+         reserve( getMax( mCapacity * 2, 16U ) );
+   }
+
+   const U32 i = mSize++;
+
+   getFloats( PosX )[i] = part.pos.x;
+   getFloats( PosY )[i] = part.pos.y;
+   getFloats( PosZ )[i] = part.pos.z;
+   getFloats( VelX )[i] = part.vel.x;
+   getFloats( VelY )[i] = part.vel.y;
+   getFloats( VelZ )[i] = part.vel.z;
+   getFloats( AccX )[i] = part.acc.x;
+   getFloats( AccY )[i] = part.acc.y;
+   getFloats( AccZ )[i] = part.acc.z;
+   getFloats( OrientX )[i] = part.orientDir.x;
+   getFloats( OrientY )[i] = part.orientDir.y;
+   getFloats( OrientZ )[i] = part.orientDir.z;
+   getFloats( ColorR )[i] = part.color.red;
+   getFloats( ColorG )[i] = part.color.green;
+   getFloats( ColorB )[i] = part.color.blue;
+   getFloats( ColorA )[i] = part.color.alpha;
+   getFloats( Size )[i] = part.size;
+   getFloats( SpinSpeed )[i] = part.spinSpeed;
+   getAges()[i] = part.currentAge;
+   getLifetimes()[i] = part.totalLifetime;
+   getDataBlocks()[i] = part.dataBlock;
+
+   return i;
+}
+
+void ParticlePool::removeLast()
+{
+   AssertFatal( mSize > 0, "ParticlePool::removeLast - No particles!" );
+   if( --mSize == 0 )
+      mFirst = 0;
+}
+
+//-----------------------------------------------------------------------------
+// get
+//-----------------------------------------------------------------------------
+void ParticlePool::get( U32 i, Particle &part ) const
+{
+   part.pos = getPos( i );
+   part.vel.set( getFloats( VelX )[i], getFloats( VelY )[i], getFloats( VelZ )[i] );
+   part.acc.set( getFloats( AccX )[i], getFloats( AccY )[i], getFloats( AccZ )[i] );
+   part.orientDir.set( getFloats( OrientX )[i], getFloats( OrientY )[i], getFloats( OrientZ )[i] );
+   part.totalLifetime = getLifetimes()[i];
+   part.dataBlock = getDataBlocks()[i];
+   part.currentAge = getAges()[i];
+   part.color = getColor( i );
+   part.size = getSize( i );
+   part.spinSpeed = getFloats( SpinSpeed )[i];
+}
+
+Point3F ParticlePool::getPos( U32 i ) const
+{
+   return Point3F( getFloats( PosX )[i], getFloats( PosY )[i], getFloats( PosZ )[i] );
+}
+
+ColorF ParticlePool::getColor( U32 i ) const
+{
+   return ColorF( getFloats( ColorR )[i], getFloats( ColorG )[i], getFloats( ColorB )[i], getFloats( ColorA )[i] );
+}
+
+//-----------------------------------------------------------------------------
+// age
+//-----------------------------------------------------------------------------
+void ParticlePool::age( U32 ms )
+{
+   U32 *ages = getAges();
+   const U32 *lifetimes = getLifetimes();
+   for( U32 i = 0; i < mSize; i++ )
+      ages[i] += ms;
+
+   // The oldest particles are at the front, skip over them.
+   U32 numDead = 0;
+   while( numDead < mSize && ages[numDead] > lifetimes[numDead] )
+      numDead++;
+   mFirst += numDead;
+   mSize -= numDead;
+
+   // Move the runs of live particles down over the dead ones.
+   ages = getAges();
+   lifetimes = getLifetimes();
+   U32 dst = 0;
+   U32 src = 0;
+   while( src < mSize )
+   {
+      if( ages[src] > lifetimes[src] )
+      {
+         src++;
+         continue;
+      }
+
+      U32 end = src + 1;
+      while( end < mSize && ages[end] <= lifetimes[end] )
+         end++;
+
+      if( dst != src )
+         _move( mFirst + dst, mFirst + src, end - src );
+      dst += end - src;
+      src = end;
+   }
+   mSize = dst;
+
+   if( mSize == 0 )
+      mFirst = 0;
+}
+
+//-----------------------------------------------------------------------------
+// integrate
+//-----------------------------------------------------------------------------
+void ParticlePool::integrate( U32 first, U32 count, U32 ms, const Point3F &windVelocity )
+{
+   AssertFatal( first + count <= mSize, "ParticlePool::integrate - Out of range!" );
+
+   const F32 t = F32(ms) / 1000.0;
+
+#ifdef PARTICLEPOOL_SSE
+   const bool useSSE = smUseSIMD && ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE2 );
+#endif
+
+   // Emitters mostly use a single datablock, so this is
+   // usually one run covering all the particles.
+   ParticleData **dataBlocks = getDataBlocks();
+   const U32 end = first + count;
+   while( first < end )
+   {
+      const ParticleData *dataBlock = dataBlocks[first];
+      U32 runEnd = first + 1;
+      while( runEnd < end && dataBlocks[runEnd] == dataBlock )
+         runEnd++;
+
+#ifdef PARTICLEPOOL_SSE
+      if( useSSE )
+         _integrateSSE( first, runEnd - first, t, windVelocity, *dataBlock );
+      else
+#endif
+         _integrateC( first, runEnd - first, t, windVelocity, *dataBlock );
+
+      first = runEnd;
+   }
+}
+
+void ParticlePool::_integrateC( U32 first, U32 count, F32 t, const Point3F &windVelocity, const ParticleData &data )
+{
+   F32 *posX = getFloats( PosX ), *posY = getFloats( PosY ), *posZ = getFloats( PosZ );
+   F32 *velX = getFloats( VelX ), *velY = getFloats( VelY ), *velZ = getFloats( VelZ );
+   const F32 *accX = getFloats( AccX ), *accY = getFloats( AccY ), *accZ = getFloats( AccZ );
+
+   const F32 drag = data.dragCoefficient;
+   const Point3F wind = windVelocity * data.windCoefficient;
+   const F32 gravity = sGravity * data.gravityCoefficient;
+
+   const U32 end = first + count;
+   for( U32 i = first; i < end; i++ )
+   {
+      const F32 ax = accX[i] - velX[i] * drag - wind.x;
+      const F32 ay = accY[i] - velY[i] * drag - wind.y;
+      const F32 az = accZ[i] - velZ[i] * drag - wind.z + gravity;
+
+      velX[i] += ax * t;
+      velY[i] += ay * t;
+      velZ[i] += az * t;
+
+      posX[i] += velX[i] * t;
+      posY[i] += velY[i] * t;
+      posZ[i] += velZ[i] * t;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// updateKeyData
+//-----------------------------------------------------------------------------
+void ParticlePool::updateKeyData( U32 first, U32 count, const ColorF *colors, const F32 *sizes )
+{
+   AssertFatal( first + count <= mSize, "ParticlePool::updateKeyData - Out of range!" );
+
+#ifdef PARTICLEPOOL_SSE
+   if( smUseSIMD && ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE2 ) )
+   {
+      _updateKeyDataSSE( first, count, colors, sizes );
+      return;
+   }
+#endif
+
+   for( U32 i = first; i < first + count; i++ )
+      _updateKeyData( i, colors, sizes );
+}
+
+void ParticlePool::_updateKeyData( U32 i, const ColorF *colors, const F32 *sizes )
+{
+   U32 *lifetimes = getLifetimes();
+   const ParticleData *dataBlock = getDataBlock( i );
+
+   //Ensure that our lifetime is never below 0
+   if( lifetimes[i] < 1 )
+      lifetimes[i] = 1;
+
+   F32 t = F32(getAges()[i]) / F32(lifetimes[i]);
+   AssertFatal(t <= 1.0f, "Out out bounds filter function for particle.");
+
+   if( !colors )
+      colors = dataBlock->colors;
+   if( !sizes )
+      sizes = dataBlock->sizes;
+
+   for( U32 k = 1; k < ParticleData::PDC_NUM_KEYS; k++ )
+   {
+      if( dataBlock->times[k] >= t )
+      {
+         F32 firstPart = t - dataBlock->times[k-1];
+         F32 total     = dataBlock->times[k] -
+                         dataBlock->times[k-1];
+
+         firstPart /= total;
+
+         ColorF color;
+         color.interpolate( colors[k-1], colors[k], firstPart );
+         getFloats( ColorR )[i] = color.red;
+         getFloats( ColorG )[i] = color.green;
+         getFloats( ColorB )[i] = color.blue;
+         getFloats( ColorA )[i] = color.alpha;
+
+         getFloats( Size )[i] = (sizes[k-1] * (1.0 - firstPart)) +
+                                (sizes[k]   * firstPart);
+         break;
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+// SSE versions
+//-----------------------------------------------------------------------------
+#ifdef PARTICLEPOOL_SSE
+
+void ParticlePool::_integrateSSE( U32 first, U32 count, F32 t, const Point3F &windVelocity, const ParticleData &data )
+{
+   F32 *posX = getFloats( PosX ), *posY = getFloats( PosY ), *posZ = getFloats( PosZ );
+   F32 *velX = getFloats( VelX ), *velY = getFloats( VelY ), *velZ = getFloats( VelZ );
+   const F32 *accX = getFloats( AccX ), *accY = getFloats( AccY ), *accZ = getFloats( AccZ );
+
+   const Point3F wind = windVelocity * data.windCoefficient;
+
+   const __m128 vt = _mm_set1_ps( t );
+   const __m128 d = _mm_set1_ps( data.dragCoefficient );
+   const __m128 windX = _mm_set1_ps( wind.x );
+   const __m128 windY = _mm_set1_ps( wind.y );
+   const __m128 windZ = _mm_set1_ps( wind.z );
+   const __m128 grav = _mm_set1_ps( sGravity * data.gravityCoefficient );
+
+   // Same operations in the same order as _integrateC().
+   U32 i = first;
+   const U32 end = first + count;
+   for( ; i + 4 <= end; i += 4 )
+   {
+      __m128 vx = _mm_loadu_ps( velX + i );
+      __m128 vy = _mm_loadu_ps( velY + i );
+      __m128 vz = _mm_loadu_ps( velZ + i );
+
+      __m128 ax = _mm_sub_ps( _mm_sub_ps( _mm_loadu_ps( accX + i ), _mm_mul_ps( vx, d ) ), windX );
+      __m128 ay = _mm_sub_ps( _mm_sub_ps( _mm_loadu_ps( accY + i ), _mm_mul_ps( vy, d ) ), windY );
+      __m128 az = _mm_sub_ps( _mm_sub_ps( _mm_loadu_ps( accZ + i ), _mm_mul_ps( vz, d ) ), windZ );
+      az = _mm_add_ps( az, grav );
+
+      vx = _mm_add_ps( vx, _mm_mul_ps( ax, vt ) );
+      vy = _mm_add_ps( vy, _mm_mul_ps( ay, vt ) );
+      vz = _mm_add_ps( vz, _mm_mul_ps( az, vt ) );
+      _mm_storeu_ps( velX + i, vx );
+      _mm_storeu_ps( velY + i, vy );
+      _mm_storeu_ps( velZ + i, vz );
+
+      _mm_storeu_ps( posX + i, _mm_add_ps( _mm_loadu_ps( posX + i ), _mm_mul_ps( vx, vt ) ) );
+      _mm_storeu_ps( posY + i, _mm_add_ps( _mm_loadu_ps( posY + i ), _mm_mul_ps( vy, vt ) ) );
+      _mm_storeu_ps( posZ + i, _mm_add_ps( _mm_loadu_ps( posZ + i ), _mm_mul_ps( vz, vt ) ) );
+   }
+
+   if( i < end )
+      _integrateC( i, end - i, t, windVelocity, data );
+}
+
+static inline __m128 _blend( const __m128 &mask, const __m128 &a, const __m128 &b )
+{
+   return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+void ParticlePool::_updateKeyDataSSE( U32 first, U32 count, const ColorF *colors, const F32 *sizes )
+{
+   U32 *ages = getAges();
+   U32 *lifetimes = getLifetimes();
+   ParticleData **dataBlocks = getDataBlocks();
+   F32 *out[5] = { getFloats( ColorR ), getFloats( ColorG ), getFloats( ColorB ), getFloats( ColorA ), getFloats( Size ) };
+
+   const __m128 one = _mm_set1_ps( 1.0f );
+
+   U32 i = first;
+   const U32 end = first + count;
+   while( i < end )
+   {
+      // Four particles of the same datablock share their keys,
+      // anything else takes the scalar path.
+      const ParticleData *dataBlock = dataBlocks[i];
+      if( i + 4 > end || dataBlocks[i + 1] != dataBlock || dataBlocks[i + 2] != dataBlock || dataBlocks[i + 3] != dataBlock )
+      {
+         _updateKeyData( i, colors, sizes );
+         i++;
+         continue;
+      }
+
+      const ColorF *keyColors = colors ? colors : dataBlock->colors;
+      const F32 *keySizes = sizes ? sizes : dataBlock->sizes;
+      const F32 *times = dataBlock->times;
+
+      for( U32 l = 0; l < 4; l++ )
+      {
+         if( lifetimes[i + l] < 1 )
+            lifetimes[i + l] = 1;
+      }
+
+      const __m128 t = _mm_div_ps( _mm_cvtepi32_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( ages + i ) ) ),
+                                   _mm_cvtepi32_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( lifetimes + i ) ) ) );
+
+      __m128 values[5];
+      for( U32 v = 0; v < 5; v++ )
+         values[v] = _mm_loadu_ps( out[v] + i );
+
+      // Each lane takes the first key interval that ends at or after t.
+      __m128 found = _mm_setzero_ps();
+      for( U32 k = 1; k < ParticleData::PDC_NUM_KEYS; k++ )
+      {
+         const __m128 mask = _mm_andnot_ps( found, _mm_cmpge_ps( _mm_set1_ps( times[k] ), t ) );
+         if( !_mm_movemask_ps( mask ) )
+            continue;
+
+         const __m128 firstPart = _mm_div_ps( _mm_sub_ps( t, _mm_set1_ps( times[k-1] ) ),
+                                              _mm_set1_ps( times[k] - times[k-1] ) );
+         const __m128 secondPart = _mm_sub_ps( one, firstPart );
+
+         const F32 *from = keyColors[k-1];
+         const F32 *to = keyColors[k];
+         for( U32 v = 0; v < 4; v++ )
+         {
+            const __m128 value = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( from[v] ), secondPart ),
+                                             _mm_mul_ps( _mm_set1_ps( to[v] ), firstPart ) );
+            values[v] = _blend( mask, value, values[v] );
+         }
+
+         const __m128 size = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( keySizes[k-1] ), secondPart ),
+                                         _mm_mul_ps( _mm_set1_ps( keySizes[k] ), firstPart ) );
+         values[4] = _blend( mask, size, values[4] );
+
+         found = _mm_or_ps( found, mask );
+         if( _mm_movemask_ps( found ) == 0xF )
+            break;
+      }
+
+      for( U32 v = 0; v < 5; v++ )
+         _mm_storeu_ps( out[v] + i, values[v] );
+
+      i += 4;
+   }
+}
+
+#endif // PARTICLEPOOL_SSE
@@ -0,0 +1,134 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _PARTICLEPOOL_H_
+#define _PARTICLEPOOL_H_
+
+#ifndef _PARTICLE_H_
+#include "T3D/fx/particle.h"
+#endif
+
+
+//*****************************************************************************
+// Particle Pool
+//
+// Structure-of-arrays storage for the particles of one ParticleEmitter.
+// The particles are kept in emission order, oldest first, so the update
+// loops walk memory linearly and the SIMD versions handle four particles
+// at a time.  Particles mostly die oldest first, so the live range starts
+// at mFirst and dead particles at the front are dropped without copying.
+//*****************************************************************************
+class ParticlePool
+{
+  public:
+
+   enum Array
+   {
+      PosX, PosY, PosZ,
+      VelX, VelY, VelZ,
+      AccX, AccY, AccZ,
+      OrientX, OrientY, OrientZ,
+      ColorR, ColorG, ColorB, ColorA,
+      Size,
+      SpinSpeed,
+
+      NumFloatArrays,
+
+      Age = NumFloatArrays,
+      Lifetime,
+      DataBlock,
+
+      NumArrays
+   };
+
+   ParticlePool();
+   ~ParticlePool();
+
+   U32 size() const { return mSize; }
+   bool empty() const { return mSize == 0; }
+
+   void reserve( U32 count );
+   void clear() { mFirst = mSize = 0; }
+
+   /// Append a particle, returns its index.
+   U32 add( const Particle &part );
+
+   /// Remove the particle added last.
+   void removeLast();
+
+   /// Copy particle @a i into @a part.
+   void get( U32 i, Particle &part ) const;
+
+   /// Add @a ms to the age of every particle and remove the ones
+   /// past their lifetime, keeping the others in order.
+   void age( U32 ms );
+
+   /// Apply drag, wind, gravity and constant acceleration to
+   /// @a count particles starting at @a first over @a ms.  The
+   /// coefficients are read from the datablocks on every call so
+   /// that edits to them apply to live particles.
+   void integrate( U32 first, U32 count, U32 ms, const Point3F &windVelocity );
+
+   /// Interpolate the color and size keys of @a count particles starting
+   /// at @a first.  @a colors and @a sizes override the datablock keys if set.
+   void updateKeyData( U32 first, U32 count, const ColorF *colors, const F32 *sizes );
+
+   /// @name Particle Arrays
+   /// Indexed from 0 to size() - 1.
+   /// @{
+   F32* getFloats( Array a ) const { return reinterpret_cast<F32*>( mArrays[a] ) + mFirst; }
+   U32* getAges() const { return reinterpret_cast<U32*>( mArrays[Age] ) + mFirst; }
+   U32* getLifetimes() const { return reinterpret_cast<U32*>( mArrays[Lifetime] ) + mFirst; }
+   ParticleData** getDataBlocks() const { return reinterpret_cast<ParticleData**>( mArrays[DataBlock] ) + mFirst; }
+
+   Point3F getPos( U32 i ) const;
+   F32 getSize( U32 i ) const { return getFloats( Size )[i]; }
+   ColorF getColor( U32 i ) const;
+   ParticleData* getDataBlock( U32 i ) const { return getDataBlocks()[i]; }
+   /// @}
+
+   /// Use the SSE update loops when the CPU has SSE2.
+   static bool smUseSIMD;
+
+  protected:
+
+   static U32 _getElementSize( U32 array );
+
+   /// Move @a count particles from @a src to @a dst, both
+   /// relative to the start of the arrays.
+   void _move( U32 dst, U32 src, U32 count );
+
+   void _updateKeyData( U32 i, const ColorF *colors, const F32 *sizes );
+
+   /// Integrate a run of particles sharing the datablock @a data.
+   void _integrateC( U32 first, U32 count, F32 t, const Point3F &windVelocity, const ParticleData &data );
+   void _integrateSSE( U32 first, U32 count, F32 t, const Point3F &windVelocity, const ParticleData &data );
+   void _updateKeyDataSSE( U32 first, U32 count, const ColorF *colors, const F32 *sizes );
+
+   U8 *mArrays[NumArrays];
+   void *mMem;
+   U32 mCapacity;
+   U32 mFirst;
+   U32 mSize;
+};
+
+#endif // _PARTICLEPOOL_H_
@@ -0,0 +1,251 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "T3D/fx/particlePool.h"
+
+/// Particle pools filled with particles of a few datablocks, updated
+/// like ParticleEmitter does it but without a scene.
+FIXTURE(ParticlePool)
+{
+public:
+   MRandomLCG rand;
+   Vector<ParticleData*> dataBlocks;
+   Point3F wind;
+   bool savedUseSIMD;
+
+   void SetUp()
+   {
+      savedUseSIMD = ParticlePool::smUseSIMD;
+      rand.setSeed( 1234 );
+      wind.set( 2.0f, -1.0f, 0.5f );
+
+      for ( U32 i = 0; i < 3; i++ )
+      {
+         ParticleData *data = new ParticleData;
+         data->dragCoefficient = rand.randF( 0.0f, 2.0f );
+         data->windCoefficient = rand.randF( 0.0f, 1.0f );
+         data->gravityCoefficient = rand.randF( -1.0f, 1.0f );
+         data->lifetimeMS = 500 + i * 750;
+         data->lifetimeVarianceMS = 250;
+         for ( U32 k = 0; k < ParticleData::PDC_NUM_KEYS; k++ )
+         {
+            data->colors[k].set( rand.randF(), rand.randF(), rand.randF(), rand.randF() );
+            data->sizes[k] = rand.randF( 0.1f, 4.0f );
+         }
+         data->times[1] = rand.randF( 0.1f, 0.5f );
+         data->times[2] = rand.randF( 0.5f, 0.9f );
+         dataBlocks.push_back( data );
+      }
+   }
+
+   void TearDown()
+   {
+      for ( U32 i = 0; i < dataBlocks.size(); i++ )
+         delete dataBlocks[i];
+      dataBlocks.clear();
+      ParticlePool::smUseSIMD = savedUseSIMD;
+   }
+
+   /// Emit @a count particles, switching datablocks every @a run particles.
+   void emit( ParticlePool &pool, U32 count, U32 run )
+   {
+      for ( U32 i = 0; i < count; i++ )
+      {
+         Particle part;
+         part.pos.set( rand.randF( -1.0f, 1.0f ), rand.randF( -1.0f, 1.0f ), rand.randF( -1.0f, 1.0f ) );
+         part.vel.set( rand.randF( -5.0f, 5.0f ), rand.randF( -5.0f, 5.0f ), rand.randF( 0.0f, 10.0f ) );
+         part.orientDir = part.vel;
+         part.currentAge = 0;
+         part.color.set( 0, 0, 0, 0 );
+         part.size = 0;
+         dataBlocks[( i / run ) % dataBlocks.size()]->initializeParticle( &part, Point3F::Zero );
+
+         const U32 index = pool.add( part );
+         pool.updateKeyData( index, 1, NULL, NULL );
+      }
+   }
+
+   void advance( ParticlePool &pool, U32 ms )
+   {
+      pool.age( ms );
+      pool.integrate( 0, pool.size(), ms, wind );
+      pool.updateKeyData( 0, pool.size(), NULL, NULL );
+   }
+};
+
+TEST_FIX(ParticlePool, AgeKeepsOrder)
+{
+   ParticlePool pool;
+   emit( pool, 100, 1 );
+
+   Vector<ParticleData*> expected;
+   for ( U32 t = 0; t < 40; t++ )
+   {
+      // Predict the survivors before aging them.
+      expected.clear();
+      for ( U32 i = 0; i < pool.size(); i++ )
+      {
+         if ( pool.getAges()[i] + 50 <= pool.getLifetimes()[i] )
+            expected.push_back( pool.getDataBlock( i ) );
+      }
+
+      pool.age( 50 );
+      emit( pool, 5, 1 );
+
+      ASSERT_EQ( expected.size() + 5, pool.size() );
+      for ( U32 i = 0; i < expected.size(); i++ )
+         EXPECT_EQ( expected[i], pool.getDataBlock( i ) ) << "Particle " << i << " moved";
+      for ( U32 i = 0; i < pool.size(); i++ )
+         EXPECT_LE( pool.getAges()[i], pool.getLifetimes()[i] );
+   }
+
+   pool.removeLast();
+   EXPECT_EQ( expected.size() + 4, pool.size() );
+}
+
+/// The particle loop ParticleEmitter::update() ran before the pool.
+static void integrateParticle( Particle &part, U32 ms, const Point3F &windVelocity )
+{
+   F32 t = F32(ms) / 1000.0;
+
+   Point3F a = part.acc;
+   a -= part.vel * part.dataBlock->dragCoefficient;
+   a -= windVelocity * part.dataBlock->windCoefficient;
+   a += Point3F(0.0f, 0.0f, -9.81f) * part.dataBlock->gravityCoefficient;
+
+   part.vel += a * t;
+   part.pos += part.vel * t;
+}
+
+TEST_FIX(ParticlePool, DataBlockEditsApplyToLiveParticles)
+{
+   for ( U32 p = 0; p < 2; p++ )
+   {
+      ParticlePool::smUseSIMD = ( p != 0 );
+
+      ParticlePool pool;
+      emit( pool, 50, 7 );
+
+      Vector<Particle> expected;
+      expected.setSize( pool.size() );
+      for ( U32 i = 0; i < pool.size(); i++ )
+         pool.get( i, expected[i] );
+
+      for ( U32 t = 0; t < 10; t++ )
+      {
+         // Like tweaking the datablock in the particle editor
+         // while the emitter is running.
+         if ( t == 5 )
+         {
+            dataBlocks[0]->dragCoefficient = 3.0f;
+            dataBlocks[1]->windCoefficient = 2.0f;
+            dataBlocks[2]->gravityCoefficient = -4.0f;
+         }
+
+         pool.integrate( 0, pool.size(), 32, wind );
+         for ( U32 i = 0; i < expected.size(); i++ )
+            integrateParticle( expected[i], 32, wind );
+      }
+
+      for ( U32 i = 0; i < pool.size(); i++ )
+      {
+         Particle part;
+         pool.get( i, part );
+         EXPECT_TRUE( part.pos.equal( expected[i].pos, 1e-4f ) ) << ( p ? "SSE" : "C" ) << " position " << i;
+         EXPECT_TRUE( part.vel.equal( expected[i].vel, 1e-4f ) ) << ( p ? "SSE" : "C" ) << " velocity " << i;
+      }
+   }
+}
+
+TEST_FIX(ParticlePool, SSEHandlesMixedDataBlockRuns)
+{
+   // Runs of six particles per datablock, so the integration and the
+   // grouped key update both have runs that don't fill a vector.
+   ParticlePool pools[2];
+   const U32 seed = rand.getSeed();
+   for ( U32 p = 0; p < 2; p++ )
+   {
+      rand.setSeed( seed );
+      ParticlePool::smUseSIMD = ( p != 0 );
+      for ( U32 t = 0; t < 60; t++ )
+      {
+         emit( pools[p], 37, 6 );
+         advance( pools[p], 32 );
+      }
+   }
+
+   ASSERT_EQ( pools[0].size(), pools[1].size() );
+   for ( U32 i = 0; i < pools[0].size(); i++ )
+   {
+      EXPECT_EQ( pools[0].getDataBlock( i ), pools[1].getDataBlock( i ) );
+      EXPECT_TRUE( pools[0].getPos( i ).equal( pools[1].getPos( i ), 1e-3f ) ) << "Position " << i;
+      EXPECT_NEAR( pools[0].getSize( i ), pools[1].getSize( i ), 1e-4f ) << "Size " << i;
+
+      const ColorF a = pools[0].getColor( i );
+      const ColorF b = pools[1].getColor( i );
+      EXPECT_NEAR( a.red, b.red, 1e-4f ) << "Color " << i;
+      EXPECT_NEAR( a.green, b.green, 1e-4f ) << "Color " << i;
+      EXPECT_NEAR( a.blue, b.blue, 1e-4f ) << "Color " << i;
+      EXPECT_NEAR( a.alpha, b.alpha, 1e-4f ) << "Color " << i;
+   }
+}
+
+/// Headless benchmark: N emitters with a steady stream
+/// of particles for M seconds.
+TEST_FIX(ParticlePool, EmittersOverTime)
+{
+   const U32 numEmitters = 200;
+   const U32 numSeconds = 10;
+   const U32 tickMS = 16;
+   const U32 perTick = 4;
+
+   // A pool can't hold more than the longest lived particles
+   // emitted over their lifetime.
+   U32 maxLifetime = 0;
+   for ( U32 i = 0; i < dataBlocks.size(); i++ )
+      maxLifetime = getMax( maxLifetime, U32( dataBlocks[i]->lifetimeMS + dataBlocks[i]->lifetimeVarianceMS ) );
+   const U32 maxPoolSize = perTick * ( maxLifetime / tickMS + 2 );
+
+   U32 updates[2];
+   for ( U32 p = 0; p < 2; p++ )
+   {
+      ParticlePool::smUseSIMD = ( p != 0 );
+      rand.setSeed( 1234 );
+
+      Vector<ParticlePool*> pools;
+      for ( U32 i = 0; i < numEmitters; i++ )
+      {
+         pools.push_back( new ParticlePool );
+         pools.last()->reserve( 256 );
+      }
+
+      updates[p] = 0;
+      const U32 start = Platform::getRealMilliseconds();
+      for ( U32 t = 0; t < numSeconds * 1000; t += tickMS )
+      {
+         for ( U32 i = 0; i < numEmitters; i++ )
+         {
+            emit( *pools[i], perTick, 64 );
+            advance( *pools[i], tickMS );
+            updates[p] += pools[i]->size();
+         }
+      }
+      const U32 time = Platform::getRealMilliseconds() - start;
+
+      Con::printf( "ParticlePool %u emitters for %us: %s %ums (%u particle updates)",
+         numEmitters, numSeconds, p ? "SIMD" : "C", time, updates[p] );
+
+      for ( U32 i = 0; i < numEmitters; i++ )
+      {
+         EXPECT_LE( pools[i]->size(), maxPoolSize ) << "Emitter " << i << " is leaking dead particles";
+         delete pools[i];
+      }
+   }
+
+   // Aging doesn't depend on the update loops.
+   EXPECT_EQ( updates[0], updates[1] );
+}
+
+#endif
@@ -313,6 +313,7 @@ IMPLEMENT_CALLBACK( Item, onLeaveLiquid, void, ( const char* objID, const char*
 Item::Item()
 {
    mTypeMask |= ItemObjectType | DynamicShapeObjectType;
+   mNetFlags.set(SharedPackUpdate);
    mDataBlock = 0;
    mStatic = false;
    mRotate = false;
@@ -1079,6 +1080,16 @@ U32 Item::packUpdate(NetConnection *connection, U32 mask, BitStream *stream)
    return retMask;
 }
 
+bool Item::getPackUpdateKey(NetConnection *connection, U32 mask, U32 &key)
+{
+   if (!Parent::getPackUpdateKey(connection, mask, key))
+      return false;
+
+   if (mask & ThrowSrcMask && mCollisionObject)
+      key = (key << (NetConnection::GhostIdBitSize + 1)) | U32(connection->getGhostIndex(mCollisionObject) + 1);
+   return true;
+}
+
 void Item::unpackUpdate(NetConnection *connection, BitStream *stream)
 {
    Parent::unpackUpdate(connection,stream);
@@ -186,6 +186,7 @@ class Item: public ShapeBase
 
    U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   bool getPackUpdateKey(NetConnection *conn, U32 mask, U32 &key);
 };
 
 typedef Item::LightType ItemLightType;
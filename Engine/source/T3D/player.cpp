@@ -1567,6 +1567,7 @@ F32 Player::mGravity = -20;
 Player::Player()
 {
    mTypeMask |= PlayerObjectType | DynamicShapeObjectType;
+   mNetFlags.set(SharedPackUpdate);
 
    delta.pos = mAnchorPoint = Point3F(0,0,100);
    delta.rot = delta.head = Point3F(0,0,0);
@@ -6165,6 +6166,21 @@ U32 Player::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
    return retMask;
 }
 
+bool Player::getPackUpdateKey(NetConnection *con, U32 mask, U32 &key)
+{
+   if (!Parent::getPackUpdateKey(con, mask, key))
+      return false;
+
+   bool controlUpdate = getControllingClient() == con && !(mask & InitialUpdateMask);
+
+   // The position is written relative to the connection's compression point.
+   if (!controlUpdate && (mask & MoveMask))
+      return false;
+
+   key = (key << 1) | controlUpdate;
+   return true;
+}
+
 void Player::unpackUpdate(NetConnection *con, BitStream *stream)
 {
    Parent::unpackUpdate(con,stream);
@@ -760,6 +760,7 @@ public:
    void readPacketData (GameConnection *conn, BitStream *stream);
    U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   bool getPackUpdateKey(NetConnection *conn, U32 mask, U32 &key);
 
    virtual void prepRenderImage( SceneRenderState* state );
    virtual void renderConvex( ObjectRenderInst *ri, SceneRenderState *state, BaseMatInstance *overrideMat );   
@@ -566,7 +566,7 @@ Projectile::Projectile()
    mFadeValue( 1.0f )
 {
    // Todo: ScopeAlways?
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | ConcurrentPackUpdate);
    mTypeMask |= ProjectileObjectType | LightObjectType | DynamicShapeObjectType;
 
    mLight = LightManager::createLightInfo();
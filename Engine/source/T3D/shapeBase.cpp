@@ -2373,11 +2373,58 @@ TSShape const* ShapeBase::getShape()
    return mShapeInstance? mShapeInstance->getShape(): 0;
 }
 
+void ShapeBase::prepAnimation( SceneRenderState *state )
+{
+   if ( !mShapeInstance )
+      return;
+
+   if( ( getDamageState() == Destroyed ) && ( !mDataBlock->renderWhenDestroyed ) )
+      return;
+
+   if ( mMeshHidden.getSize() > 0 && mMeshHidden.testAll() )   
+      return;
+
+   if ( mCubeReflector.isRendering() )
+      return;
+
+   // Select the detail the same way _prepRenderImage() does.
+   if ( _isHighestDetailForced() )
+      mShapeInstance->setCurrentDetail( 0 );
+   else
+      mShapeInstance->setDetailFromDistance( state, _getDetailDistance( state ) );
+
+   mShapeInstance->queueAnimate();
+}
+
 void ShapeBase::prepRenderImage( SceneRenderState *state )
 {
    _prepRenderImage( state, true, true );
 }
 
+bool ShapeBase::_isHighestDetailForced() const
+{
+   GameConnection *con = GameConnection::getConnectionToServer();
+   ShapeBase *co = NULL;
+   if(con && ( (co = dynamic_cast<ShapeBase*>(con->getControlObject())) != NULL) )
+   {
+      if(co == this || co->getObjectMount() == this)
+         return true;
+   }
+   return false;
+}
+
+F32 ShapeBase::_getDetailDistance( const SceneRenderState *state ) const
+{
+   Point3F cameraOffset = getWorldBox().getClosestPoint( state->getDiffuseCameraPosition() ) - state->getDiffuseCameraPosition();
+   F32 dist = cameraOffset.len();
+   if (dist < 0.01f)
+      dist = 0.01f;
+
+   F32 invScale = (1.0f/getMax(getMax(mObjScale.x,mObjScale.y),mObjScale.z));
+
+   return dist * invScale;
+}
+
 void ShapeBase::_prepRenderImage(   SceneRenderState *state, 
                                     bool renderSelf, 
                                     bool renderMountedImages )
@@ -2406,34 +2453,21 @@ void ShapeBase::_prepRenderImage(   SceneRenderState *state,
 
    // We force all the shapes to use the highest detail
    // if we're the control object or mounted.
-   bool forceHighestDetail = false;
-   {
-      GameConnection *con = GameConnection::getConnectionToServer();
-      ShapeBase *co = NULL;
-      if(con && ( (co = dynamic_cast<ShapeBase*>(con->getControlObject())) != NULL) )
-      {
-         if(co == this || co->getObjectMount() == this)
-            forceHighestDetail = true;
-      }
-   }
+   const bool forceHighestDetail = _isHighestDetailForced();
 
    mLastRenderFrame = sLastRenderFrame;
 
    // get shape detail...we might not even need to be drawn
-   Point3F cameraOffset = getWorldBox().getClosestPoint( state->getDiffuseCameraPosition() ) - state->getDiffuseCameraPosition();
-   F32 dist = cameraOffset.len();
-   if (dist < 0.01f)
-      dist = 0.01f;
-
-   F32 invScale = (1.0f/getMax(getMax(mObjScale.x,mObjScale.y),mObjScale.z));
+   const F32 detailDistance = _getDetailDistance( state );
 
    if (mShapeInstance)
    {
       if ( forceHighestDetail )         
          mShapeInstance->setCurrentDetail( 0 );
       else
-         mShapeInstance->setDetailFromDistance( state, dist * invScale );
+         mShapeInstance->setDetailFromDistance( state, detailDistance );
                               
+      // This does nothing if prepAnimation() already animated the shape.
       mShapeInstance->animate();
    }
    
@@ -2457,7 +2491,7 @@ void ShapeBase::_prepRenderImage(   SceneRenderState *state,
             if ( forceHighestDetail )
                image.shapeInstance[imageShapeIndex]->setCurrentDetail( 0 );
             else
-               image.shapeInstance[imageShapeIndex]->setDetailFromDistance( state, dist * invScale );
+               image.shapeInstance[imageShapeIndex]->setDetailFromDistance( state, detailDistance );
 
             if (!mIsZero( (1.0f - mCloakLevel) * mFadeVal))
             {
@@ -3001,6 +3035,30 @@ U32 ShapeBase::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
    return retMask;
 }
 
+bool ShapeBase::getPackUpdateKey(NetConnection *con, U32 mask, U32 &key)
+{
+   if (!Parent::getPackUpdateKey(con, mask, key))
+      return false;
+
+   // Packing a net string registers it with the connection, so those
+   // updates can't be copied.
+   if ((mask & NameMask) && mShapeNameHandle.isValidString())
+      return false;
+   if ((mask & SkinMask) && mSkinNameHandle.isValidString())
+      return false;
+
+   if (mask & ImageMask) {
+      for (S32 i = 0; i < MaxMountedImages; i++) {
+         const MountedImage& image = mMountedImageList[i];
+         if ((mask & (ImageMaskN << i)) &&
+               (image.skinNameHandle.isValidString() || image.scriptAnimPrefix.isValidString()))
+            return false;
+      }
+      key = (key << 1) | (getControllingClient() == con);
+   }
+   return true;
+}
+
 void ShapeBase::unpackUpdate(NetConnection *con, BitStream *stream)
 {
    Parent::unpackUpdate(con, stream);
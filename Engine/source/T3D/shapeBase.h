@@ -1114,6 +1114,14 @@ protected:
                            bool renderSelf, 
                            bool renderMountedImages );
 
+   /// Returns true if the shapes should use their highest
+   /// detail, which is the case for the control object and
+   /// anything mounted to it.
+   bool _isHighestDetailForced() const;
+
+   /// Returns the camera distance used to select shape detail levels.
+   F32 _getDetailDistance( const SceneRenderState *state ) const;
+
    /// Renders the shape bounds as well as the 
    /// bounds of all mounted shape images.
    void _renderBoundingBox( ObjectRenderInst *ri, SceneRenderState *state, BaseMatInstance* );
@@ -1752,6 +1760,9 @@ public:
    /// Returns the renderable shape of this object
    TSShape const* getShape();
 
+   /// @see SceneObject
+   virtual void prepAnimation( SceneRenderState* state );
+
    /// @see SceneObject
    virtual void prepRenderImage( SceneRenderState* state );
 
@@ -1831,6 +1842,7 @@ public:
    F32 getUpdatePriority(CameraScopeQuery *focusObject, U32 updateMask, S32 updateSkips);
    U32  packUpdate(NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn, BitStream *stream);
+   bool getPackUpdateKey(NetConnection *conn, U32 mask, U32 &key);
    void writePacketData(GameConnection *conn, BitStream *stream);
    void readPacketData(GameConnection *conn, BitStream *stream);
 
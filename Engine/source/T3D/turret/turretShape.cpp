@@ -1109,6 +1109,15 @@ U32 TurretShape::packUpdate(NetConnection *connection, U32 mask, BitStream *stre
    return retMask;
 }
 
+bool TurretShape::getPackUpdateKey(NetConnection *connection, U32 mask, U32 &key)
+{
+   if (!Parent::getPackUpdateKey(connection, mask & (~Item::RotationMask), key))
+      return false;
+
+   key = (key << 1) | ((NetConnection*)getControllingClient() == connection && !(mask & InitialUpdateMask));
+   return true;
+}
+
 void TurretShape::unpackUpdate(NetConnection *connection, BitStream *stream)
 {
    Parent::unpackUpdate(connection,stream);
@@ -207,6 +207,7 @@ public:
    virtual void readPacketData( GameConnection* conn, BitStream* stream );
    virtual U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    virtual void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   virtual bool getPackUpdateKey(NetConnection *conn, U32 mask, U32 &key);
 
    virtual void getWeaponMountTransform( S32 index, const MatrixF &xfm, MatrixF *outMat );
    virtual void getRenderWeaponMountTransform( F32 delta, S32 index, const MatrixF &xfm, MatrixF *outMat );
@@ -703,6 +703,11 @@ U32 VarNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    // OP_SETCURVAR_ARRAY
    // OP_LOADVAR (type)
    
+   // else if it is a function local
+   // OP_LOADLOCAL (type)
+   // slot
+   // varName
+   
    // else
    // OP_SETCURVAR
    // varName
@@ -713,6 +718,30 @@ U32 VarNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    
    precompileIdent(varName);
 
+   S32 slot = arrayIndex ? -1 : getLocalSlot(varName);
+   if(slot != -1)
+   {
+      switch(type)
+      {
+      case TypeReqUInt:
+         codeStream.emit(OP_LOADLOCAL_UINT);
+         break;
+      case TypeReqFloat:
+         codeStream.emit(OP_LOADLOCAL_FLT);
+         break;
+      case TypeReqString:
+         codeStream.emit(OP_LOADLOCAL_STR);
+         break;
+      case TypeReqVar:
+      default:
+         codeStream.emit(OP_LOADLOCAL_VAR);
+         break;
+      }
+      codeStream.emit(slot);
+      codeStream.emitSTE(varName);
+      return codeStream.tell();
+   }
+
    codeStream.emit(arrayIndex ? OP_LOADIMMED_IDENT : OP_SETCURVAR);
    codeStream.emitSTE(varName);
    
@@ -948,6 +977,12 @@ U32 AssignExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    // OP_TERMINATE_REWIND_STR
    // OP_SAVEVAR
    
+   //else if it is a function local
+   // eval expr
+   // OP_SAVELOCAL
+   // slot
+   // varName
+   
    //else
    // eval expr
    // OP_SETCURVAR_CREATE
@@ -958,7 +993,35 @@ U32 AssignExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    
    ip = expr->compile(codeStream, ip, subType);
 
-   if(arrayIndex)
+   S32 slot = arrayIndex ? -1 : getLocalSlot(varName);
+   if(slot != -1 && subType != TypeReqNone)
+   {
+      switch(subType)
+      {
+      case TypeReqString:
+         codeStream.emit(OP_SAVELOCAL_STR);
+         break;
+      case TypeReqUInt:
+         codeStream.emit(OP_SAVELOCAL_UINT);
+         break;
+      case TypeReqFloat:
+         codeStream.emit(OP_SAVELOCAL_FLT);
+         break;
+      case TypeReqVar:
+      default:
+         codeStream.emit(OP_SAVELOCAL_VAR);
+         break;
+      }
+      codeStream.emit(slot);
+      codeStream.emitSTE(varName);
+   }
+   else if(slot != -1)
+   {
+      codeStream.emit(OP_SETCURVAR_LOCAL_CREATE);
+      codeStream.emit(slot);
+      codeStream.emitSTE(varName);
+   }
+   else if(arrayIndex)
    {
       if(subType == TypeReqString)
          codeStream.emit(OP_ADVANCE_STR);
@@ -978,22 +1041,25 @@ U32 AssignExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
       codeStream.emit(OP_SETCURVAR_CREATE);
       codeStream.emitSTE(varName);
    }
-   switch(subType)
+   if(slot == -1)
    {
-   case TypeReqString:
-      codeStream.emit(OP_SAVEVAR_STR);
-      break;
-   case TypeReqUInt:
-      codeStream.emit(OP_SAVEVAR_UINT);
-      break;
-   case TypeReqFloat:
-      codeStream.emit(OP_SAVEVAR_FLT);
-      break;
-   case TypeReqVar:
-      codeStream.emit(OP_SAVEVAR_VAR);
-      break;
-   case TypeReqNone:
-      break;
+      switch(subType)
+      {
+      case TypeReqString:
+         codeStream.emit(OP_SAVEVAR_STR);
+         break;
+      case TypeReqUInt:
+         codeStream.emit(OP_SAVEVAR_UINT);
+         break;
+      case TypeReqFloat:
+         codeStream.emit(OP_SAVEVAR_FLT);
+         break;
+      case TypeReqVar:
+         codeStream.emit(OP_SAVEVAR_VAR);
+         break;
+      case TypeReqNone:
+         break;
+      }
    }
    if(type != subType)
       codeStream.emit(conversionOp(subType, type));
@@ -1068,6 +1134,11 @@ U32 AssignOpExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    // OP_REWIND_STR
    // OP_SETCURVAR_ARRAY_CREATE
    
+   // else if it is a function local
+   // OP_SETCURVAR_LOCAL_CREATE
+   // slot
+   // varName
+   
    // else
    // OP_SETCURVAR_CREATE
    // varName
@@ -1081,7 +1152,14 @@ U32 AssignOpExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    precompileIdent(varName);
    
    ip = expr->compile(codeStream, ip, subType);
-   if(!arrayIndex)
+   S32 slot = arrayIndex ? -1 : getLocalSlot(varName);
+   if(slot != -1)
+   {
+      codeStream.emit(OP_SETCURVAR_LOCAL_CREATE);
+      codeStream.emit(slot);
+      codeStream.emitSTE(varName);
+   }
+   else if(!arrayIndex)
    {
       codeStream.emit(OP_SETCURVAR_CREATE);
       codeStream.emitSTE(varName);
@@ -1153,6 +1231,7 @@ U32 FuncCallExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    // function
    // namespace
    // isDot
+   // inline cache
    
    precompileIdent(funcName);
    precompileIdent(nameSpace);
@@ -1185,6 +1264,7 @@ U32 FuncCallExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    codeStream.emitSTE(nameSpace);
    
    codeStream.emit(callType);
+   codeStream.emit(allocInlineCache());
    if(type != TypeReqString)
       codeStream.emit(conversionOp(TypeReqString, type));
    return codeStream.tell();
@@ -1245,6 +1325,7 @@ U32 SlotAccessNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    codeStream.emit(OP_SETCURFIELD);
    
    codeStream.emitSTE(slotName);
+   codeStream.emit(allocInlineCache());
 
    if(arrayExpr)
    {
@@ -1348,6 +1429,7 @@ U32 SlotAssignNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
       codeStream.emit(OP_SETCUROBJECT_NEW);
    codeStream.emit(OP_SETCURFIELD);
    codeStream.emitSTE(slotName);
+   codeStream.emit(allocInlineCache());
 
    if(arrayExpr)
    {
@@ -1414,6 +1496,7 @@ U32 SlotAssignOpNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    codeStream.emit(OP_SETCUROBJECT);
    codeStream.emit(OP_SETCURFIELD);
    codeStream.emitSTE(slotName);
+   codeStream.emit(allocInlineCache());
    
    if(arrayExpr)
    {
@@ -1545,6 +1628,7 @@ U32 FunctionDeclStmtNode::compileStmt(CodeStream &codeStream, U32 ip)
    // func end ip
    // argc
    // ident array[argc]
+   // local slot count
    // code
    // OP_RETURN_VOID
    setCurrentStringTable(&getFunctionStringTable());
@@ -1579,7 +1663,9 @@ U32 FunctionDeclStmtNode::compileStmt(CodeStream &codeStream, U32 ip)
    {
       codeStream.emitSTE(walk->varName);
    }
+   const U32 localCountIp = codeStream.emit(0);
    CodeBlock::smInFunction = true;
+   resetLocalSlots();
    ip = compileBlock(stmts, codeStream, ip);
 
    // Add break so breakpoint can be set at closing brace or
@@ -1590,6 +1676,8 @@ U32 FunctionDeclStmtNode::compileStmt(CodeStream &codeStream, U32 ip)
    codeStream.emit(OP_RETURN_VOID);
    
    codeStream.patch(endIp, codeStream.tell());
+   codeStream.patch(localCountIp, getLocalSlotCount());
+   resetLocalSlots();
    
    setCurrentStringTable(&getGlobalStringTable());
    setCurrentFloatTable(&getGlobalFloatTable());
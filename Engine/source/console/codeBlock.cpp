@@ -51,6 +51,9 @@ CodeBlock::CodeBlock()
    breakList = NULL;
    breakListSize = 0;
 
+   inlineCacheCount = 0;
+   inlineCaches = NULL;
+
    refCount = 0;
    code = NULL;
    name = NULL;
@@ -75,6 +78,7 @@ CodeBlock::~CodeBlock()
    delete[] functionFloats;
    delete[] code;
    delete[] breakList;
+   delete[] inlineCaches;
 }
 
 //-------------------------------------------------------------------------
@@ -279,6 +283,19 @@ void CodeBlock::removeFromCodeList()
       TelDebugger->clearCodeBlockPointers( this );
 }
 
+void CodeBlock::allocInlineCaches(U32 count)
+{
+   delete[] inlineCaches;
+   inlineCaches = NULL;
+   inlineCacheCount = count;
+
+   if(count)
+   {
+      inlineCaches = new InlineCache[count];
+      dMemset(inlineCaches, 0, sizeof(InlineCache) * count);
+   }
+}
+
 void CodeBlock::calcBreakList()
 {
    U32 size = 0;
@@ -446,6 +463,10 @@ bool CodeBlock::read(StringTableEntry fileName, Stream &st)
       }
    }
 
+   U32 cacheCount;
+   st.read(&cacheCount);
+   allocInlineCaches(cacheCount);
+
    if(lineBreakPairCount)
       calcBreakList();
 
@@ -562,6 +583,8 @@ bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, con
 
    getIdentTable().write(st);
 
+   st.write(getInlineCacheCount());
+
    consoleAllocReset();
    st.close();
 
@@ -655,6 +678,8 @@ ConsoleValueRef CodeBlock::compileExec(StringTableEntry fileName, const char *in
 
    globalFloats    = getGlobalFloatTable().build();
    functionFloats  = getFunctionFloatTable().build();
+
+   allocInlineCaches(getInlineCacheCount());
    
    codeStream.emit(OP_RETURN);
    codeStream.emitCodeStream(&codeSize, &code, &lineBreakPairs);
@@ -738,14 +763,15 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn )
             bool hasBody = bool(code[ip+6]);
             U32 newIp = code[ ip + 7 ];
             U32 argc = code[ ip + 8 ];
+            U32 localCount = code[ ip + 9 + (argc * 2) ];
             endFuncIp = newIp;
             
-            Con::printf( "%i: OP_FUNC_DECL name=%s nspace=%s package=%s hasbody=%i newip=%i argc=%i",
-               ip - 1, fnName, fnNamespace, fnPackage, hasBody, newIp, argc );
+            Con::printf( "%i: OP_FUNC_DECL name=%s nspace=%s package=%s hasbody=%i newip=%i argc=%i locals=%i",
+               ip - 1, fnName, fnNamespace, fnPackage, hasBody, newIp, argc, localCount );
                
-            // Skip args.
+            // Skip args and local count.
                            
-            ip += 9 + (argc * 2);
+            ip += 10 + (argc * 2);
             smInFunction = true;
             break;
          }
@@ -1085,6 +1111,38 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn )
             break;
          }
 
+         case OP_SETCURVAR_LOCAL_CREATE:
+         {
+            U32 slot = code[ip];
+            StringTableEntry var = CodeToSTE(code, ip + 1);
+            
+            Con::printf( "%i: OP_SETCURVAR_LOCAL_CREATE slot=%i var=%s", ip - 1, slot, var );
+            ip += 3;
+            break;
+         }
+
+         case OP_LOADLOCAL_UINT:
+         case OP_LOADLOCAL_FLT:
+         case OP_LOADLOCAL_STR:
+         case OP_LOADLOCAL_VAR:
+         case OP_SAVELOCAL_UINT:
+         case OP_SAVELOCAL_FLT:
+         case OP_SAVELOCAL_STR:
+         case OP_SAVELOCAL_VAR:
+         {
+            static const char* sLocalOpNames[] =
+            {
+               "OP_LOADLOCAL_UINT", "OP_LOADLOCAL_FLT", "OP_LOADLOCAL_STR", "OP_LOADLOCAL_VAR",
+               "OP_SAVELOCAL_UINT", "OP_SAVELOCAL_FLT", "OP_SAVELOCAL_STR", "OP_SAVELOCAL_VAR"
+            };
+            U32 slot = code[ip];
+            StringTableEntry var = CodeToSTE(code, ip + 1);
+            
+            Con::printf( "%i: %s slot=%i var=%s", ip - 1, sLocalOpNames[ code[ ip - 1 ] - OP_LOADLOCAL_UINT ], slot, var );
+            ip += 3;
+            break;
+         }
+
          case OP_SETCUROBJECT:
          {
             Con::printf( "%i: OP_SETCUROBJECT", ip - 1 );
@@ -1107,8 +1165,8 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn )
          case OP_SETCURFIELD:
          {
             StringTableEntry curField = CodeToSTE(code, ip);
-            Con::printf( "%i: OP_SETCURFIELD field=%s", ip - 1, curField );
-            ip += 2;
+            Con::printf( "%i: OP_SETCURFIELD field=%s cache=%i", ip - 1, curField, S32(code[ip+2]) );
+            ip += 3;
             break;
          }
          
@@ -1274,13 +1332,13 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn )
          {
             StringTableEntry fnNamespace = CodeToSTE(code, ip+2);
             StringTableEntry fnName      = CodeToSTE(code, ip);
-            U32 callType = code[ip+2];
+            U32 callType = code[ip+4];
 
-            Con::printf( "%i: OP_CALLFUNC_RESOLVE name=%s nspace=%s callType=%s", ip - 1, fnName, fnNamespace,
+            Con::printf( "%i: OP_CALLFUNC_RESOLVE name=%s nspace=%s callType=%s cache=%i", ip - 1, fnName, fnNamespace,
                callType == FuncCallExprNode::FunctionCall ? "FunctionCall"
-                  : callType == FuncCallExprNode::MethodCall ? "MethodCall" : "ParentCall" );
+                  : callType == FuncCallExprNode::MethodCall ? "MethodCall" : "ParentCall", S32(code[ip+5]) );
             
-            ip += 5;
+            ip += 6;
             break;
          }
          
@@ -1290,11 +1348,11 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn )
             StringTableEntry fnName      = CodeToSTE(code, ip);
             U32 callType = code[ip+4];
 
-            Con::printf( "%i: OP_CALLFUNC name=%s nspace=%s callType=%s", ip - 1, fnName, fnNamespace,
+            Con::printf( "%i: OP_CALLFUNC name=%s nspace=%s callType=%s cache=%i", ip - 1, fnName, fnNamespace,
                callType == FuncCallExprNode::FunctionCall ? "FunctionCall"
-                  : callType == FuncCallExprNode::MethodCall ? "MethodCall" : "ParentCall" );
+                  : callType == FuncCallExprNode::MethodCall ? "MethodCall" : "ParentCall", S32(code[ip+5]) );
             
-            ip += 5;
+            ip += 6;
             break;
          }
 
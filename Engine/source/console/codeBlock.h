@@ -77,6 +77,20 @@ public:
    U32 codeSize;
    U32 *code;
 
+   /// Result of the last lookup made from a method call or field access
+   /// site.  For call sites @a key is the Namespace the method was looked up
+   /// in and @a value the resulting Namespace::Entry; for field sites they
+   /// are the AbstractClassRep of the object and its AbstractClassRep::Field.
+   struct InlineCache
+   {
+      const void *key;
+      const void *value;
+      U32 sequence;  ///< Namespace::mCacheSequence when a call site was filled.
+   };
+
+   U32 inlineCacheCount;
+   InlineCache *inlineCaches;
+
    U32 refCount;
    U32 lineBreakPairCount;
    U32 *lineBreakPairs;
@@ -87,6 +101,7 @@ public:
    void addToCodeList();
    void removeFromCodeList();
    void calcBreakList();
+   void allocInlineCaches(U32 count);
    void clearAllBreaks();
    void setAllBreaks();
    void dumpInstructions( U32 startIp = 0, bool upToReturn = false );
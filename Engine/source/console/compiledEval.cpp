@@ -251,6 +251,78 @@ inline void ExprEvalState::setCurVarNameCreate(StringTableEntry name)
    }
 }
 
+/// Make the function local in @a slot the current variable.  The entry is
+/// looked up by name on first use and cached in @a slots for the rest of
+/// the call; locals are only removed when the frame is popped.
+static inline void setCurLocalVar(Dictionary::Entry **slots, U32 slot, StringTableEntry name, bool create)
+{
+   Dictionary::Entry *entry = slots[slot];
+   if(entry)
+   {
+      gEvalState.currentVariable = entry;
+      return;
+   }
+
+   if(create)
+      gEvalState.setCurVarNameCreate(name);
+   else
+      gEvalState.setCurVarName(name);
+   slots[slot] = gEvalState.currentVariable;
+}
+
+/// Returns the inline cache for the site whose cache operand is @a index,
+/// or NULL if the site was compiled without one.
+static inline CodeBlock::InlineCache* getInlineCache(CodeBlock *block, U32 index)
+{
+   return index != Compiler::NoInlineCache ? &block->inlineCaches[index] : NULL;
+}
+
+/// Look up the method @a name in @a ns through the cache of a call site.
+/// The cached entry is valid as long as the receiver's namespace is the same
+/// and no namespace has changed since, see Namespace::trashCache().
+static inline Namespace::Entry* lookupCachedMethod(CodeBlock::InlineCache *cache, Namespace *ns, StringTableEntry name)
+{
+   if(!cache)
+      return ns->lookup(name);
+
+   if(cache->key != ns || cache->sequence != Namespace::mCacheSequence)
+   {
+      cache->value = ns->lookup(name);
+      cache->key = ns;
+      cache->sequence = Namespace::mCacheSequence;
+   }
+   return (Namespace::Entry*)cache->value;
+}
+
+/// Look up the static field @a name of @a object through the cache of a
+/// field access site.  Class field lists don't change once the engine is
+/// initialized, so the class of the object is the only key.
+static inline const AbstractClassRep::Field* lookupCachedField(CodeBlock::InlineCache *cache, SimObject *object, StringTableEntry name)
+{
+   AbstractClassRep *classRep = object->getClassRep();
+   if(cache->key != classRep)
+   {
+      cache->value = classRep ? classRep->findField(name) : NULL;
+      cache->key = classRep;
+   }
+   return (const AbstractClassRep::Field*)cache->value;
+}
+
+static inline const char* getCachedDataField(CodeBlock::InlineCache *cache, SimObject *object, StringTableEntry name, const char *array)
+{
+   if(!cache)
+      return object->getDataField(name, array);
+   return object->getDataField(name, array, lookupCachedField(cache, object, name));
+}
+
+static inline void setCachedDataField(CodeBlock::InlineCache *cache, SimObject *object, StringTableEntry name, const char *array, const char *value)
+{
+   if(!cache)
+      object->setDataField(name, array, value);
+   else
+      object->setDataField(name, array, value, lookupCachedField(cache, object, name));
+}
+
 //------------------------------------------------------------
 
 inline S32 ExprEvalState::getIntVariable()
@@ -454,6 +526,12 @@ ConsoleValueRef CodeBlock::exec(U32 ip, const char *functionName, Namespace *thi
    STR.clearFunctionOffset(); // ensures arg buffer offset is back to 0
    StringTableEntry thisFunctionName = NULL;
    bool popFrame = false;
+
+   // Dictionary entries of the function's local variable slots.
+   U32 localCount = argv ? code[ip + (2 + 6 + 1) + (code[ip + 2 + 6] * 2)] : 0;
+   FrameTemp< Dictionary::Entry* > localSlots(getMax(localCount, U32(1)));
+   dMemset(~localSlots, 0, localCount * sizeof(Dictionary::Entry*));
+
    if(argv)
    {
       // assume this points into a function decl:
@@ -518,7 +596,7 @@ ConsoleValueRef CodeBlock::exec(U32 ip, const char *functionName, Namespace *thi
          }
       }
 
-      ip = ip + (fnArgc * 2) + (2 + 6 + 1);
+      ip = ip + (fnArgc * 2) + (2 + 6 + 1) + 1;
       curFloatTable = functionFloats;
       curStringTable = functionStrings;
       curStringTableLen = functionStringsMaxLen;
@@ -575,6 +653,7 @@ ConsoleValueRef CodeBlock::exec(U32 ip, const char *functionName, Namespace *thi
    U32 failJump = 0;
    StringTableEntry prevField = NULL;
    StringTableEntry curField = NULL;
+   CodeBlock::InlineCache *curFieldCache = NULL;
    SimObject *prevObject = NULL;
    SimObject *curObject = NULL;
    SimObject *saveObject=NULL;
@@ -1428,6 +1507,142 @@ breakContinue:
             gEvalState.setCopyVariable();
             break;
 
+         case OP_SETCURVAR_LOCAL_CREATE:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, true);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+            break;
+
+         case OP_LOADLOCAL_UINT:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, false);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            intStack[_UINT+1] = gEvalState.getIntVariable();
+            _UINT++;
+            break;
+
+         case OP_LOADLOCAL_FLT:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, false);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            floatStack[_FLT+1] = gEvalState.getFloatVariable();
+            _FLT++;
+            break;
+
+         case OP_LOADLOCAL_STR:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, false);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            val = gEvalState.getStringVariable();
+            STR.setStringValue(val);
+            break;
+
+         case OP_LOADLOCAL_VAR:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, false);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.copyVariable = gEvalState.currentVariable;
+            break;
+
+         case OP_SAVELOCAL_UINT:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, true);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setIntVariable(intStack[_UINT]);
+            break;
+
+         case OP_SAVELOCAL_FLT:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, true);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setFloatVariable(floatStack[_FLT]);
+            break;
+
+         case OP_SAVELOCAL_STR:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, true);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setStringVariable(STR.getStringValue());
+            break;
+
+         case OP_SAVELOCAL_VAR:
+            var = CodeToSTE(code, ip + 1);
+            setCurLocalVar(~localSlots, code[ip], var, true);
+            ip += 3;
+
+            // See OP_SETCURVAR
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setCopyVariable();
+            break;
+
          case OP_SETCUROBJECT:
             // Save the previous object for parsing vector fields.
             prevObject = curObject;
@@ -1477,8 +1692,9 @@ breakContinue:
             prevField = curField;
             dStrcpy( prevFieldArray, curFieldArray );
             curField = CodeToSTE(code, ip);
+            curFieldCache = getInlineCache(this, code[ip+2]);
             curFieldArray[0] = 0;
-            ip += 2;
+            ip += 3;
             break;
 
          case OP_SETCURFIELD_ARRAY:
@@ -1493,7 +1709,7 @@ breakContinue:
 
          case OP_LOADFIELD_UINT:
             if(curObject)
-               intStack[_UINT+1] = U32(dAtoi(curObject->getDataField(curField, curFieldArray)));
+               intStack[_UINT+1] = U32(dAtoi(getCachedDataField(curFieldCache, curObject, curField, curFieldArray)));
             else
             {
                // The field is not being retrieved from an object. Maybe it's
@@ -1506,7 +1722,7 @@ breakContinue:
 
          case OP_LOADFIELD_FLT:
             if(curObject)
-               floatStack[_FLT+1] = dAtof(curObject->getDataField(curField, curFieldArray));
+               floatStack[_FLT+1] = dAtof(getCachedDataField(curFieldCache, curObject, curField, curFieldArray));
             else
             {
                // The field is not being retrieved from an object. Maybe it's
@@ -1520,7 +1736,7 @@ breakContinue:
          case OP_LOADFIELD_STR:
             if(curObject)
             {
-               val = curObject->getDataField(curField, curFieldArray);
+               val = getCachedDataField(curFieldCache, curObject, curField, curFieldArray);
                STR.setStringValue( val );
             }
             else
@@ -1535,7 +1751,7 @@ breakContinue:
          case OP_SAVEFIELD_UINT:
             STR.setIntValue(intStack[_UINT]);
             if(curObject)
-               curObject->setDataField(curField, curFieldArray, STR.getStringValue());
+               setCachedDataField(curFieldCache, curObject, curField, curFieldArray, STR.getStringValue());
             else
             {
                // The field is not being set on an object. Maybe it's
@@ -1548,7 +1764,7 @@ breakContinue:
          case OP_SAVEFIELD_FLT:
             STR.setFloatValue(floatStack[_FLT]);
             if(curObject)
-               curObject->setDataField(curField, curFieldArray, STR.getStringValue());
+               setCachedDataField(curFieldCache, curObject, curField, curFieldArray, STR.getStringValue());
             else
             {
                // The field is not being set on an object. Maybe it's
@@ -1560,7 +1776,7 @@ breakContinue:
 
          case OP_SAVEFIELD_STR:
             if(curObject)
-               curObject->setDataField(curField, curFieldArray, STR.getStringValue());
+               setCachedDataField(curFieldCache, curObject, curField, curFieldArray, STR.getStringValue());
             else
             {
                // The field is not being set on an object. Maybe it's
@@ -1683,15 +1899,19 @@ breakContinue:
             fnNamespace = CodeToSTE(code, ip+2);
             fnName      = CodeToSTE(code, ip);
 
-            // Try to look it up.
-            ns = Namespace::find(fnNamespace);
-            nsEntry = ns->lookup(fnName);
+            // Try to look it up.  Namespaces are never freed, so a site
+            // that has been run before already knows its namespace.
+            {
+               CodeBlock::InlineCache *cache = getInlineCache(this, code[ip+5]);
+               ns = cache && cache->key ? (Namespace*)cache->key : Namespace::find(fnNamespace);
+               nsEntry = lookupCachedMethod(cache, ns, fnName);
+            }
             if(!nsEntry)
             {
-               ip+= 5;
+               ip+= 6;
                Con::warnf(ConsoleLogEntry::General,
                   "%s: Unable to find function %s%s%s",
-                  getFileLine(ip-7), fnNamespace ? fnNamespace : "",
+                  getFileLine(ip-8), fnNamespace ? fnNamespace : "",
                   fnNamespace ? "::" : "", fnName);
                STR.popFrame();
                CSTK.popFrame();
@@ -1728,8 +1948,9 @@ breakContinue:
             }
 
             U32 callType = code[ip+4];
+            CodeBlock::InlineCache *callCache = getInlineCache(this, code[ip+5]);
 
-            ip += 5;
+            ip += 6;
             CSTK.getArgcArgv(fnName, &callArgc, &callArgv);
 
             const char *componentReturnValue = "";
@@ -1740,9 +1961,9 @@ breakContinue:
                {
 #ifdef COMPILER_OPTIMIZE_FUNCTION_CALLS
 #ifdef TORQUE_CPU_X64
-                  nsEntry = ((Namespace::Entry *) *((U64*)(code+ip-3)));
+                  nsEntry = ((Namespace::Entry *) *((U64*)(code+ip-4)));
 #else
-                  nsEntry = ((Namespace::Entry *) *(code+ip-3));
+                  nsEntry = ((Namespace::Entry *) *(code+ip-4));
 #endif
 #else
                   nsEntry = Namespace::global()->lookup( fnName );
@@ -1777,7 +1998,7 @@ breakContinue:
                
                ns = gEvalState.thisObject->getNamespace();
                if(ns)
-                  nsEntry = ns->lookup(fnName);
+                  nsEntry = lookupCachedMethod(callCache, ns, fnName);
                else
                   nsEntry = NULL;
             }
@@ -1787,7 +2008,7 @@ breakContinue:
                {
                   ns = thisNamespace->mParent;
                   if(ns)
-                     nsEntry = ns->lookup(fnName);
+                     nsEntry = lookupCachedMethod(callCache, ns, fnName);
                   else
                      nsEntry = NULL;
                }
@@ -108,8 +108,56 @@ namespace Compiler
          gGlobalStringTable.add(ident);
    }
 
+   //------------------------------------------------------------
+
+   bool gUseLocalSlots = true;
+   Vector< StringTableEntry > gLocalSlots;
+
+   void resetLocalSlots()
+   {
+      gLocalSlots.clear();
+   }
+
+   S32 getLocalSlot(StringTableEntry varName)
+   {
+      if(!gUseLocalSlots || !CodeBlock::smInFunction || !varName || varName[0] != '%')
+         return -1;
+
+      for(S32 i = 0; i < gLocalSlots.size(); i++)
+         if(gLocalSlots[i] == varName)
+            return i;
+
+      gLocalSlots.push_back(varName);
+      return gLocalSlots.size() - 1;
+   }
+
+   U32 getLocalSlotCount()
+   {
+      return gLocalSlots.size();
+   }
+
+   //------------------------------------------------------------
+
+   bool gUseInlineCaches = true;
+   U32 gInlineCacheCount = 0;
+
+   U32 allocInlineCache()
+   {
+      if(!gUseInlineCaches)
+         return NoInlineCache;
+      return gInlineCacheCount++;
+   }
+
+   U32 getInlineCacheCount()
+   {
+      return gInlineCacheCount;
+   }
+
+   //------------------------------------------------------------
+
    void resetTables()
    {
+      gInlineCacheCount = 0;
       setCurrentStringTable(&gGlobalStringTable);
       setCurrentFloatTable(&gGlobalFloatTable);
       getGlobalFloatTable().reset();
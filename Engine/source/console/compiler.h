@@ -165,7 +165,17 @@ namespace Compiler
       OP_ITER,             ///< Enter foreach loop.
       OP_ITER_END,         ///< End foreach loop.
 
-      OP_INVALID   // 90
+      OP_SETCURVAR_LOCAL_CREATE, ///< OP_SETCURVAR_CREATE for a function local slot.
+      OP_LOADLOCAL_UINT,   ///< OP_SETCURVAR + OP_LOADVAR_UINT for a function local slot.
+      OP_LOADLOCAL_FLT,    ///< OP_SETCURVAR + OP_LOADVAR_FLT for a function local slot.
+      OP_LOADLOCAL_STR,    ///< OP_SETCURVAR + OP_LOADVAR_STR for a function local slot.
+      OP_LOADLOCAL_VAR,    ///< OP_SETCURVAR + OP_LOADVAR_VAR for a function local slot.
+      OP_SAVELOCAL_UINT,   ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_UINT for a function local slot.
+      OP_SAVELOCAL_FLT,    ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_FLT for a function local slot.
+      OP_SAVELOCAL_STR,    ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_STR for a function local slot.
+      OP_SAVELOCAL_VAR,    ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_VAR for a function local slot.
+
+      OP_INVALID   // 99
    };
 
    //------------------------------------------------------------
@@ -266,6 +276,50 @@ namespace Compiler
 
    void precompileIdent(StringTableEntry ident);
 
+   /// @name Local Variable Slots
+   ///
+   /// Local variables of a function body are numbered at compile time.  The
+   /// interpreter caches the dictionary entry of each slot on first use, so
+   /// later accesses skip the name lookup.
+   /// @{
+
+   /// If false, locals are compiled to the by-name variable opcodes.
+   extern bool gUseLocalSlots;
+
+   /// Start numbering the locals of a new function.
+   void resetLocalSlots();
+
+   /// Returns the slot of @a varName, or -1 if it isn't a local of the
+   /// function being compiled.
+   S32 getLocalSlot(StringTableEntry varName);
+
+   /// Number of slots used by the function being compiled.
+   U32 getLocalSlotCount();
+
+   /// @}
+
+   /// @name Inline Caches
+   ///
+   /// Method call and field access sites are numbered per code block.  The
+   /// interpreter remembers the result of the last lookup made from each site
+   /// in CodeBlock::inlineCaches and reuses it while the receiver's namespace
+   /// or class stays the same.
+   /// @{
+
+   /// Operand emitted for sites that have no cache.
+   const U32 NoInlineCache = 0xFFFFFFFF;
+
+   /// If false, sites are compiled with NoInlineCache.
+   extern bool gUseInlineCaches;
+
+   /// Returns the cache index for a new site in the code block being compiled.
+   U32 allocInlineCache();
+
+   /// Number of caches used by the code block being compiled.
+   U32 getInlineCacheCount();
+
+   /// @}
+
    /// Helper function to reset the float, string, and ident tables to a base
    /// starting state.
    void resetTables();
@@ -372,7 +372,9 @@ namespace Con
       /// 01/13/09 - TMS - 45->46 Added script assert
       /// 09/07/14 - jamesu - 46->47 64bit support
       /// 10/14/14 - jamesu - 47->48 Added opcodes to reduce reliance on strings in function calls
-      DSOVersion = 48,
+      /// 10/17/26 - agent - 48->49 Compiled function locals to slots, fused load/save opcodes
+      /// 10/17/26 - agent - 49->50 Inline cache opcodes for method calls and field access
+      DSOVersion = 50,
 
       MaxLineLength = 512,  ///< Maximum length of a line of console input.
       MaxDataTypes = 256    ///< Maximum number of registered data types.
@@ -0,0 +1,205 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/simEventQueue.h"
+
+#include "platform/profiler.h"
+
+
+SimEventQueue::SimEventQueue()
+{
+   VECTOR_SET_ASSOCIATION( mHeap );
+}
+
+SimEventQueue::~SimEventQueue()
+{
+   clear();
+}
+
+void SimEventQueue::push( SimEvent *event )
+{
+   AssertFatal( find( event->sequenceCount ) == NULL, "SimEventQueue::push() - Duplicate event sequence id!" );
+
+   mEvents.insertUnique( event->sequenceCount, event );
+   _addObjectEvent( event->destObject );
+
+   mHeap.increment();
+   _set( mHeap.size() - 1, event );
+   _siftUp( mHeap.size() - 1 );
+}
+
+SimEvent* SimEventQueue::popDue( SimTime time )
+{
+   if ( mHeap.empty() || mHeap.first()->time > time )
+      return NULL;
+
+   SimEvent *event = mHeap.first();
+   _removeAt( 0 );
+   return event;
+}
+
+SimEvent* SimEventQueue::find( U32 sequenceCount ) const
+{
+   HashTable<U32,SimEvent*>::ConstIterator iter = mEvents.find( sequenceCount );
+   return iter != mEvents.end() ? iter->value : NULL;
+}
+
+SimEvent* SimEventQueue::remove( U32 sequenceCount )
+{
+   SimEvent *event = find( sequenceCount );
+   if ( event )
+      _removeAt( event->queueIndex );
+
+   return event;
+}
+
+void SimEventQueue::deleteEvents( SimObject *obj )
+{
+   if ( mObjectEvents.find( obj ) == mObjectEvents.end() )
+      return;
+
+   PROFILE_SCOPE( SimEventQueue_deleteEvents );
+
+   // Compact the heap without the events of the 
+   // object and then restore the heap order.
+   U32 count = 0;
+   for ( U32 i=0; i < mHeap.size(); i++ )
+   {
+      SimEvent *event = mHeap[i];
+      if ( event->destObject == obj )
+      {
+         mEvents.erase( event->sequenceCount );
+         delete event;
+      }
+      else
+         _set( count++, event );
+   }
+
+   mHeap.setSize( count );
+   mObjectEvents.erase( obj );
+
+   if ( count > 1 )
+   {
+      for ( S32 i = ( count - 2 ) / Arity; i >= 0; i-- )
+         _siftDown( i );
+   }
+}
+
+void SimEventQueue::clear()
+{
+   for ( U32 i=0; i < mHeap.size(); i++ )
+      delete mHeap[i];
+
+   mHeap.clear();
+   mEvents.clear();
+   mObjectEvents.clear();
+}
+
+void SimEventQueue::_siftUp( U32 index )
+{
+   SimEvent *event = mHeap[ index ];
+
+   while ( index > 0 )
+   {
+      const U32 parent = ( index - 1 ) / Arity;
+      if ( !_isBefore( event, mHeap[ parent ] ) )
+         break;
+
+      _set( index, mHeap[ parent ] );
+      index = parent;
+   }
+
+   _set( index, event );
+}
+
+void SimEventQueue::_siftDown( U32 index )
+{
+   SimEvent *event = mHeap[ index ];
+   const U32 count = mHeap.size();
+
+   while ( true )
+   {
+      // Find the earliest child.
+      const U32 first = index * Arity + 1;
+      if ( first >= count )
+         break;
+
+      const U32 last = getMin( first + Arity, count );
+      U32 best = first;
+      for ( U32 i = first + 1; i < last; i++ )
+      {
+         if ( _isBefore( mHeap[i], mHeap[ best ] ) )
+            best = i;
+      }
+
+      if ( !_isBefore( mHeap[ best ], event ) )
+         break;
+
+      _set( index, mHeap[ best ] );
+      index = best;
+   }
+
+   _set( index, event );
+}
+
+void SimEventQueue::_removeAt( U32 index )
+{
+   SimEvent *event = mHeap[ index ];
+   AssertFatal( event->queueIndex == index, "SimEventQueue::_removeAt() - The event index is out of sync!" );
+
+   mEvents.erase( event->sequenceCount );
+   _removeObjectEvent( event->destObject );
+
+   // Move the last event into the hole and
+   // let it find its place in the heap.
+   SimEvent *lastEvent = mHeap.last();
+   mHeap.pop_back();
+
+   if ( index < mHeap.size() )
+   {
+      _set( index, lastEvent );
+
+      if ( index > 0 && _isBefore( lastEvent, mHeap[ ( index - 1 ) / Arity ] ) )
+         _siftUp( index );
+      else
+         _siftDown( index );
+   }
+}
+
+void SimEventQueue::_addObjectEvent( SimObject *obj )
+{
+   HashTable<SimObject*,U32>::Iterator iter = mObjectEvents.find( obj );
+   if ( iter != mObjectEvents.end() )
+      iter->value++;
+   else
+      mObjectEvents.insertUnique( obj, 1 );
+}
+
+void SimEventQueue::_removeObjectEvent( SimObject *obj )
+{
+   HashTable<SimObject*,U32>::Iterator iter = mObjectEvents.find( obj );
+   AssertFatal( iter != mObjectEvents.end(), "SimEventQueue::_removeObjectEvent() - Object has no events!" );
+
+   if ( --iter->value == 0 )
+      mObjectEvents.erase( iter );
+}
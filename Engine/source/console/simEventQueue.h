@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _SIMEVENTQUEUE_H_
+#define _SIMEVENTQUEUE_H_
+
+#ifndef _SIMEVENTS_H_
+#include "console/simEvents.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+
+
+/// The queue of pending SimEvents ordered by time.
+///
+/// This is a 4-ary min heap with an index from the event sequence
+/// ids to the events, so posting, cancelling and dispatching events
+/// are all O(log n) and looking up an event is O(1).
+///
+/// Events with the same time are ordered by their sequence ids, so
+/// they're dispatched in the order they were posted.  This is needed
+/// to ensure Con::threadSafeExecute() executes script code in the
+/// correct order.
+///
+/// The queue does no locking of its own, Sim guards it with the
+/// event queue mutex.
+class SimEventQueue
+{
+public:
+
+   SimEventQueue();
+
+   /// Deletes all the pending events.
+   ~SimEventQueue();
+
+   /// Returns the number of pending events.
+   U32 size() const { return mHeap.size(); }
+
+   bool isEmpty() const { return mHeap.empty(); }
+
+   /// Returns the earliest event without removing it or NULL.
+   SimEvent* getNext() const { return mHeap.empty() ? NULL : mHeap.first(); }
+
+   /// Adds the event to the queue.  The time, sequence id and
+   /// destination object of the event must already be set.
+   void push( SimEvent *event );
+
+   /// Removes and returns the earliest event if it
+   /// is due at the time or returns NULL.
+   SimEvent* popDue( SimTime time );
+
+   /// Returns the pending event with the sequence id or NULL.
+   SimEvent* find( U32 sequenceCount ) const;
+
+   /// Removes the event with the sequence id from the queue and 
+   /// returns it without deleting it.  Returns NULL if the event
+   /// isn't pending.
+   SimEvent* remove( U32 sequenceCount );
+
+   /// Deletes all the pending events for the object.
+   void deleteEvents( SimObject *obj );
+
+   /// Deletes all the pending events.
+   void clear();
+
+protected:
+
+   enum { Arity = 4 };
+
+   /// The events ordered as a heap.
+   Vector<SimEvent*> mHeap;
+
+   /// The sequence id to event index.
+   HashTable<U32,SimEvent*> mEvents;
+
+   /// The number of pending events of each destination object, so 
+   /// we can skip searching the heap when an object has none.
+   HashTable<SimObject*,U32> mObjectEvents;
+
+   /// Returns true if the event @a a should be dispatched before @a b.
+   static bool _isBefore( const SimEvent *a, const SimEvent *b )
+   {
+      if ( a->time != b->time )
+         return a->time < b->time;
+
+      // This compare works across the wrap of the sequence ids.
+      return (S32)( a->sequenceCount - b->sequenceCount ) < 0;
+   }
+
+   void _set( U32 index, SimEvent *event )
+   {
+      mHeap[ index ] = event;
+      event->queueIndex = index;
+   }
+
+   void _siftUp( U32 index );
+   void _siftDown( U32 index );
+
+   /// Removes the event at the heap index and updates the indices.
+   void _removeAt( U32 index );
+
+   void _addObjectEvent( SimObject *obj );
+   void _removeObjectEvent( SimObject *obj );
+};
+
+#endif // _SIMEVENTQUEUE_H_
@@ -24,6 +24,7 @@
 #include "platform/threads/mutex.h"
 #include "console/simBase.h"
 #include "console/simPersistID.h"
+#include "console/simEventQueue.h"
 #include "core/stringTable.h"
 #include "console/console.h"
 #include "core/stream/fileStream.h"
@@ -58,7 +59,7 @@ SimTime gCurrentTime;
 SimTime gTargetTime;
 
 void *gEventQueueMutex;
-SimEvent *gEventQueue;
+SimEventQueue *gEventQueue;
 U32 gEventSequence;
 
 //---------------------------------------------------------------------------
@@ -69,7 +70,7 @@ static void initEventQueue()
    gCurrentTime = 0;
    gTargetTime = 0;
    gEventSequence = 1;
-   gEventQueue = NULL;
+   gEventQueue = new SimEventQueue;
    gEventQueueMutex = Mutex::createMutex();
 }
 
@@ -77,13 +78,7 @@ static void shutdownEventQueue()
 {
    // Delete all pending events
    Mutex::lockMutex(gEventQueueMutex);
-   SimEvent *walk = gEventQueue;
-   while(walk)
-   {
-      SimEvent *temp = walk->nextEvent;
-      delete walk;
-      walk = temp;
-   }
+   SAFE_DELETE(gEventQueue);
    Mutex::unlockMutex(gEventQueueMutex);
    Mutex::destroyMutex(gEventQueueMutex);
 }
@@ -115,19 +110,10 @@ U32 postEvent(SimObject *destObject, SimEvent* event,U32 time)
       return InvalidEventId;
    }
    event->sequenceCount = gEventSequence++;
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL && (current->time < event->time))
-      walk = &(current->nextEvent);
-   
-   // [tom, 6/24/2005] This ensures that SimEvents are dispatched in the same order that they are posted.
-   // This is needed to ensure Con::threadSafeExecute() executes script code in the correct order.
-   while((current = *walk) != NULL && (current->time == event->time))
-      walk = &(current->nextEvent);
-   
-   event->nextEvent = current;
-   *walk = event;
+
+   // The queue orders events with the same time by their sequence
+   // count, so they are dispatched in the order they were posted.
+   gEventQueue->push(event);
 
    U32 seqCount = event->sequenceCount;
 
@@ -143,21 +129,7 @@ void cancelEvent(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL)
-   {
-      if(current->sequenceCount == eventSequence)
-      {
-         *walk = current->nextEvent;
-         delete current;
-         Mutex::unlockMutex(gEventQueueMutex);
-         return;
-      }
-      else
-         walk = &(current->nextEvent);
-   }
+   delete gEventQueue->remove(eventSequence);
 
    Mutex::unlockMutex(gEventQueueMutex);
 }
@@ -166,19 +138,8 @@ void cancelPendingEvents(SimObject *obj)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL)
-   {
-      if(current->destObject == obj)
-      {
-         *walk = current->nextEvent;
-         delete current;
-      }
-      else
-         walk = &(current->nextEvent);
-   }
+   gEventQueue->deleteEvents(obj);
+
    Mutex::unlockMutex(gEventQueueMutex);
 }
 
@@ -189,47 +150,49 @@ bool isEventPending(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-      {
-         Mutex::unlockMutex(gEventQueueMutex);
-         return true;
-      }
+   const bool pending = gEventQueue->find(eventSequence) != NULL;
+
    Mutex::unlockMutex(gEventQueueMutex);
-   return false;
+   return pending;
 }
 
 U32 getEventTimeLeft(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-      {
-         SimTime t = walk->time - getCurrentTime();
-         Mutex::unlockMutex(gEventQueueMutex);
-         return t;
-      }
+   SimTime t = 0;
+   if(SimEvent *event = gEventQueue->find(eventSequence))
+      t = event->time - getCurrentTime();
 
    Mutex::unlockMutex(gEventQueueMutex);
 
-   return 0;   
+   return t;   
 }
 
 U32 getScheduleDuration(U32 eventSequence)
 {
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-         return (walk->time-walk->startTime);
-   return 0;
+   Mutex::lockMutex(gEventQueueMutex);
+
+   SimTime t = 0;
+   if(SimEvent *event = gEventQueue->find(eventSequence))
+      t = event->time - event->startTime;
+
+   Mutex::unlockMutex(gEventQueueMutex);
+
+   return t;
 }
 
 U32 getTimeSinceStart(U32 eventSequence)
 {
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-         return (getCurrentTime()-walk->startTime);
-   return 0;
+   Mutex::lockMutex(gEventQueueMutex);
+
+   SimTime t = 0;
+   if(SimEvent *event = gEventQueue->find(eventSequence))
+      t = getCurrentTime() - event->startTime;
+
+   Mutex::unlockMutex(gEventQueueMutex);
+
+   return t;
 }
 
 //---------------------------------------------------------------------------
@@ -243,10 +206,8 @@ void advanceToTime(SimTime targetTime)
    Mutex::lockMutex(gEventQueueMutex);
 
    gTargetTime = targetTime;
-   while(gEventQueue && gEventQueue->time <= targetTime)
+   while(SimEvent *event = gEventQueue->popDue(targetTime))
    {
-      SimEvent *event = gEventQueue;
-      gEventQueue = gEventQueue->nextEvent;
       AssertFatal(event->time >= gCurrentTime,
          "Sim::advanceToTime() - Event time is less than current time.");
       gCurrentTime = event->time;
@@ -811,11 +811,17 @@ void SimObject::assignFieldsFrom(SimObject *parent)
 //-----------------------------------------------------------------------------
 
 void SimObject::setDataField(StringTableEntry slotName, const char *array, const char *value)
+{
+   setDataField(slotName, array, value, mFlags.test(ModStaticFields) ? findField(slotName) : NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+void SimObject::setDataField(StringTableEntry slotName, const char *array, const char *value, const AbstractClassRep::Field *fld)
 {
    // first search the static fields if enabled
    if(mFlags.test(ModStaticFields))
    {
-      const AbstractClassRep::Field *fld = findField(slotName);
       if(fld)
       {
          // Skip the special field types as they are not data.
@@ -886,14 +892,20 @@ void SimObject::setDataField(StringTableEntry slotName, const char *array, const
 //-----------------------------------------------------------------------------
 
 const char *SimObject::getDataField(StringTableEntry slotName, const char *array)
+{
+   return getDataField(slotName, array, mFlags.test(ModStaticFields) ? findField(slotName) : NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+const char *SimObject::getDataField(StringTableEntry slotName, const char *array, const AbstractClassRep::Field *fld)
 {
    if(mFlags.test(ModStaticFields))
    {
-      S32 array1 = array ? dAtoi(array) : -1;
-      const AbstractClassRep::Field *fld = findField(slotName);
-
       if(fld)
       {
+         S32 array1 = array ? dAtoi(array) : -1;
+
          if(array1 == -1 && fld->elementCount == 1)
             return (*fld->getDataFn)( this, Con::getData(fld->type, (void *) (((const char *)this) + fld->offset), 0, fld->table, fld->flag) );
          if(array1 >= 0 && array1 < fld->elementCount)
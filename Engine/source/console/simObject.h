@@ -451,6 +451,12 @@ class SimObject: public ConsoleObject
       ///                      (if field is an array); if NULL, it is ignored.
       const char *getDataField(StringTableEntry slotName, const char *array);
 
+      /// Version of getDataField() for callers that already looked up the
+      /// static field, e.g. the script interpreter's field caches.
+      ///
+      /// @param   field       Result of findField( slotName ); may be NULL.
+      const char *getDataField(StringTableEntry slotName, const char *array, const AbstractClassRep::Field *field);
+
       /// Set the value of a field on the object.
       ///
       /// See @ref simobject_console "here" for a detailed discussion of what this
@@ -461,6 +467,12 @@ class SimObject: public ConsoleObject
       /// @param   value       Value to store.
       void setDataField(StringTableEntry slotName, const char *array, const char *value);
 
+      /// Version of setDataField() for callers that already looked up the
+      /// static field.
+      ///
+      /// @param   field       Result of findField( slotName ); may be NULL.
+      void setDataField(StringTableEntry slotName, const char *array, const char *value, const AbstractClassRep::Field *field);
+
       /// Get the type of a field on the object.
       ///
       /// @param   slotName    Field to access.
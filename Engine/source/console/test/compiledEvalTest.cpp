@@ -0,0 +1,294 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "console/engineAPI.h"
+#include "console/compiler.h"
+#include "console/simBase.h"
+
+TEST(CompiledEval, LoopLocalsKeepSlots)
+{
+   Con::evaluate(
+      "function testLocalSlotsLoop(%n) { %sum = 0; for(%i = 0; %i < %n; %i++) %sum += %i; return %sum; }\n"
+      "function testLocalSlotsCopy(%a) { %b = %a; %c = %b @ \"x\"; return %c; }\n",
+      false, "testLocalSlots");
+
+   const char* returnValue = NULL;
+
+   returnValue = Con::executef("testLocalSlotsLoop", "100");
+   EXPECT_EQ(4950, dAtoi(returnValue))
+      << "Loop locals should accumulate";
+
+   returnValue = Con::executef("testLocalSlotsCopy", "abc");
+   EXPECT_STREQ("abcx", returnValue)
+      << "Variable to variable copies should work on locals";
+}
+
+TEST(CompiledEval, RecursionGetsItsOwnSlots)
+{
+   Con::evaluate(
+      "function testLocalSlotsFib(%n) { if(%n < 2) return %n; %a = testLocalSlotsFib(%n - 1); %b = testLocalSlotsFib(%n - 2); return %a + %b; }\n",
+      false, "testLocalSlots");
+
+   const char* returnValue = Con::executef("testLocalSlotsFib", "10");
+   EXPECT_EQ(55, dAtoi(returnValue))
+      << "Recursive calls must not share local slots";
+}
+
+TEST(CompiledEval, EvalSharesSlotLocals)
+{
+   // eval() code is compiled on its own and finds the
+   // locals by name in the frame the slots point into.
+   Con::evaluate(
+      "function testLocalSlotsEvalWrite() { %a = %b; eval(\"%b = 3;\"); return %a @ \"-\" @ %b; }\n"
+      "function testLocalSlotsEvalRead(%x) { %y = %x * 2; return eval(\"return %y + 1;\"); }\n",
+      false, "testLocalSlots");
+
+   const char* returnValue = NULL;
+
+   returnValue = Con::executef("testLocalSlotsEvalWrite");
+   EXPECT_STREQ("-3", returnValue)
+      << "Locals created by eval() should be visible to the function";
+
+   returnValue = Con::executef("testLocalSlotsEvalRead", "20");
+   EXPECT_EQ(41, dAtoi(returnValue))
+      << "eval() should see the values stored through slots";
+}
+
+TEST(CompiledEval, ArrayLocalsStayByName)
+{
+   Con::evaluate(
+      "function testLocalSlotsArray() { %i = 2; %arr[%i] = \"two\"; %arr2 = \"also\"; return %arr[2] SPC %arr2; }\n"
+      "function testLocalSlotsUnset(%a, %b) { return %a @ \"|\" @ %b; }\n",
+      false, "testLocalSlots");
+
+   const char* returnValue = NULL;
+
+   returnValue = Con::executef("testLocalSlotsArray");
+   EXPECT_STREQ("two also", returnValue)
+      << "%arr[2] and %arr2 are the same variable";
+
+   returnValue = Con::executef("testLocalSlotsUnset", "x");
+   EXPECT_STREQ("x|", returnValue)
+      << "Missing arguments should read as empty";
+}
+
+TEST(CompiledEval, NamedOpcodesStillRun)
+{
+   // Code compiled with Compiler::gUseLocalSlots off
+   // runs alongside code using the slot opcodes.
+   const bool useSlots = Compiler::gUseLocalSlots;
+   Compiler::gUseLocalSlots = false;
+   Con::evaluate(
+      "function testNamedLocals(%n) { %s = \"\"; for(%i = 0; %i < %n; %i++) %s = %s @ %i; return %s; }\n",
+      false, "testNamedLocals");
+   Compiler::gUseLocalSlots = true;
+   Con::evaluate(
+      "function testSlotLocals(%n) { %s = \"\"; for(%i = 0; %i < %n; %i++) %s = %s @ testNamedLocals(1) @ %i; return %s; }\n",
+      false, "testSlotLocals");
+   Compiler::gUseLocalSlots = useSlots;
+
+   const char* returnValue = NULL;
+
+   returnValue = Con::executef("testNamedLocals", "5");
+   EXPECT_STREQ("01234", returnValue);
+
+   returnValue = Con::executef("testSlotLocals", "3");
+   EXPECT_STREQ("000102", returnValue)
+      << "Calls between slot and by-name code must keep their own locals";
+}
+
+/// Times the same script compiled with and without local slots.
+TEST(CompiledEval, LocalSlotScriptTimes)
+{
+   const char* script =
+      "function PREFIXLoop(%n) { %sum = 0; for(%i = 0; %i < %n; %i++) { %t = %i * 2; %sum += %t - %i; } return %sum; }\n"
+      "function PREFIXAdd(%a, %b) { %r = %a + %b; return %r; }\n"
+      "function PREFIXCalls(%n) { %v = 0; for(%i = 0; %i < %n; %i++) %v = PREFIXAdd(%v, %i); return %v; }\n"
+      "function PREFIXStrings(%n) { %s = \"\"; for(%i = 0; %i < %n; %i++) { %w = \"w\" @ %i; %s = getWord(%w SPC %s, 0); } return %s; }\n";
+
+   const char* prefixes[] = { "timeNamedVars", "timeSlotVars" };
+   const bool useSlots = Compiler::gUseLocalSlots;
+   for (U32 i = 0; i < 2; i++)
+   {
+      String code(script);
+      code.replace("PREFIX", prefixes[i]);
+
+      Compiler::gUseLocalSlots = (i != 0);
+      Con::evaluate(code.c_str(), false, prefixes[i]);
+   }
+   Compiler::gUseLocalSlots = useSlots;
+
+   const char* benchmarks[] = { "Loop", "Calls", "Strings" };
+   // Small enough that the sums stay exact as F32 variables.
+   const char* expected[] = { "499500", "499500", "w999" };
+   for (U32 b = 0; b < 3; b++)
+   {
+      U32 times[2];
+      for (U32 i = 0; i < 2; i++)
+      {
+         const String fn = String(prefixes[i]) + benchmarks[b];
+         const U32 start = Platform::getRealMilliseconds();
+         for (U32 n = 0; n < 200; n++)
+         {
+            const char* returnValue = Con::executef(fn.c_str(), "1000");
+            EXPECT_STREQ(expected[b], returnValue) << fn.c_str();
+         }
+         times[i] = Platform::getRealMilliseconds() - start;
+      }
+
+      Con::printf("CompiledEval %s: named variables %ums, local slots %ums", benchmarks[b], times[0], times[1]);
+   }
+}
+
+TEST(CompiledEval, MethodSiteFollowsReceiver)
+{
+   Con::evaluate(
+      "function MethodSiteA::getValue(%this) { return \"A\"; }\n"
+      "function MethodSiteB::getValue(%this) { return \"B\"; }\n"
+      "function testMethodSite(%obj) { return %obj.getValue(); }\n"
+      "new ScriptObject(MethodSiteObjA) { class = MethodSiteA; };\n"
+      "new ScriptObject(MethodSiteObjB) { class = MethodSiteB; };\n",
+      false, "testMethodSite");
+
+   // The one call site sees a new class on every call.
+   const char* expected[] = { "A", "B", "A", "A", "B" };
+   const char* objects[] = { "MethodSiteObjA", "MethodSiteObjB", "MethodSiteObjA", "MethodSiteObjA", "MethodSiteObjB" };
+   for (U32 i = 0; i < 5; i++)
+   {
+      const char* returnValue = Con::executef("testMethodSite", objects[i]);
+      EXPECT_STREQ(expected[i], returnValue) << "Call " << i;
+   }
+
+   Con::evaluate("MethodSiteObjA.delete(); MethodSiteObjB.delete();", false, "testMethodSite");
+}
+
+TEST(CompiledEval, PackagesInvalidateMethodSites)
+{
+   Con::evaluate(
+      "function PackageSiteClass::getValue(%this) { return \"plain\"; }\n"
+      "function testPackageSite(%obj) { return %obj.getValue(); }\n"
+      "package PackageSitePackage { function PackageSiteClass::getValue(%this) { return \"packaged\"; } };\n"
+      "new ScriptObject(PackageSiteObj) { class = PackageSiteClass; };\n",
+      false, "testPackageSite");
+
+   const char* returnValue = Con::executef("testPackageSite", "PackageSiteObj");
+   EXPECT_STREQ("plain", returnValue);
+
+   Con::evaluate("activatePackage(PackageSitePackage);", false, "testPackageSite");
+   returnValue = Con::executef("testPackageSite", "PackageSiteObj");
+   EXPECT_STREQ("packaged", returnValue);
+
+   Con::evaluate("deactivatePackage(PackageSitePackage);", false, "testPackageSite");
+   returnValue = Con::executef("testPackageSite", "PackageSiteObj");
+   EXPECT_STREQ("plain", returnValue);
+
+   Con::evaluate("PackageSiteObj.delete();", false, "testPackageSite");
+}
+
+TEST(CompiledEval, ParentCallFromCachedMethod)
+{
+   Con::evaluate(
+      "function ParentSiteBase::getValue(%this) { return \"Base\"; }\n"
+      "function ParentSiteClass::getValue(%this) { return \"Class\"; }\n"
+      "function ParentSiteClass::getParentValue(%this) { return Parent::getValue(%this); }\n"
+      "function testParentSite(%obj) { return %obj.getValue() @ \"|\" @ %obj.getParentValue(); }\n"
+      "new ScriptObject(ParentSiteObj) { class = ParentSiteClass; superClass = ParentSiteBase; };\n",
+      false, "testParentSite");
+
+   for (U32 i = 0; i < 2; i++)
+   {
+      const char* returnValue = Con::executef("testParentSite", "ParentSiteObj");
+      EXPECT_STREQ("Class|Base", returnValue);
+   }
+
+   Con::evaluate("ParentSiteObj.delete();", false, "testParentSite");
+}
+
+TEST(CompiledEval, RedefiningInvalidatesCallSites)
+{
+   Con::evaluate(
+      "function testRedefineCaller() { return testRedefineTarget(); }\n"
+      "function testRedefineTarget() { return \"old\"; }\n",
+      false, "testRedefine");
+
+   const char* returnValue = Con::executef("testRedefineCaller");
+   EXPECT_STREQ("old", returnValue);
+
+   Con::evaluate("function testRedefineTarget() { return \"new\"; }", false, "testRedefine");
+   returnValue = Con::executef("testRedefineCaller");
+   EXPECT_STREQ("new", returnValue);
+}
+
+TEST(CompiledEval, FieldSiteFollowsReceiverClass)
+{
+   // internalName is a console field on both classes, but at a
+   // different AbstractClassRep, and dynField is dynamic on both.
+   Con::evaluate(
+      "function testFieldSiteGet(%obj) { return %obj.internalName @ \"|\" @ %obj.dynField; }\n"
+      "function testFieldSiteSet(%obj, %value) { %obj.internalName = %value; %obj.dynField = %value; }\n"
+      "new ScriptObject(FieldSiteObj);\n"
+      "new SimGroup(FieldSiteGroup);\n",
+      false, "testFieldSite");
+
+   Con::executef("testFieldSiteSet", "FieldSiteObj", "first");
+   Con::executef("testFieldSiteSet", "FieldSiteGroup", "second");
+
+   const char* returnValue = Con::executef("testFieldSiteGet", "FieldSiteObj");
+   EXPECT_STREQ("first|first", returnValue);
+   returnValue = Con::executef("testFieldSiteGet", "FieldSiteGroup");
+   EXPECT_STREQ("second|second", returnValue);
+   EXPECT_STREQ("first", Sim::findObject("FieldSiteObj")->getInternalName());
+
+   Con::evaluate("FieldSiteObj.delete(); FieldSiteGroup.delete();", false, "testFieldSite");
+}
+
+TEST(CompiledEval, InlineCacheDispatchTimes)
+{
+   const char* script =
+      "function PREFIXClass::get(%this, %i) { return %i; }\n"
+      "function PREFIXMethods(%obj, %n) { %v = 0; for(%i = 0; %i < %n; %i++) %v += %obj.get(%i); return %v; }\n"
+      "function PREFIXFields(%obj, %n) { for(%i = 0; %i < %n; %i++) { %obj.internalName = %i; %obj.dyn = %obj.internalName; } return %obj.dyn; }\n"
+      "new ScriptObject(PREFIXObj) { class = PREFIXClass; };\n";
+
+   const char* prefixes[] = { "timeUncachedDispatch", "timeCachedDispatch" };
+   const bool useCaches = Compiler::gUseInlineCaches;
+   for (U32 i = 0; i < 2; i++)
+   {
+      String code(script);
+      code.replace("PREFIX", prefixes[i]);
+
+      Compiler::gUseInlineCaches = (i != 0);
+      Con::evaluate(code.c_str(), false, prefixes[i]);
+   }
+   Compiler::gUseInlineCaches = useCaches;
+
+   const char* benchmarks[] = { "Methods", "Fields" };
+   const char* expected[] = { "499500", "999" };
+   for (U32 b = 0; b < 2; b++)
+   {
+      U32 times[2];
+      for (U32 i = 0; i < 2; i++)
+      {
+         const String fn = String(prefixes[i]) + benchmarks[b];
+         const String obj = String(prefixes[i]) + "Obj";
+         const U32 start = Platform::getRealMilliseconds();
+         for (U32 n = 0; n < 200; n++)
+         {
+            const char* returnValue = Con::executef(fn.c_str(), obj.c_str(), "1000");
+            EXPECT_STREQ(expected[b], returnValue) << fn.c_str();
+         }
+         times[i] = Platform::getRealMilliseconds() - start;
+      }
+
+      Con::printf("CompiledEval %s: uncached %ums, inline caches %ums", benchmarks[b], times[0], times[1]);
+   }
+
+   for (U32 i = 0; i < 2; i++)
+   {
+      const String code = String(prefixes[i]) + "Obj.delete();";
+      Con::evaluate(code.c_str(), false, prefixes[i]);
+   }
+}
+
+#endif
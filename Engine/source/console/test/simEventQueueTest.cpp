@@ -0,0 +1,253 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "console/simEventQueue.h"
+#include "math/mRandom.h"
+
+/// Events which count how many of them were deleted.  The queue never
+/// touches the destination objects, so fake pointers stand in for them.
+FIXTURE(SimEventQueue)
+{
+public:
+
+   struct TestEvent : public SimEvent
+   {
+      static U32 smDeleted;
+
+      ~TestEvent() { smDeleted++; }
+      void process( SimObject* ) {}
+   };
+
+   MRandomLCG rand;
+   U32 nextSequence;
+
+   void SetUp()
+   {
+      rand.setSeed( 5678 );
+      nextSequence = 1;
+      TestEvent::smDeleted = 0;
+   }
+
+   static SimObject* fakeObject( U32 i ) { return reinterpret_cast<SimObject*>( (uintptr_t)( i + 1 ) * 16 ); }
+
+   /// Post an event like Sim::postEvent() does.
+   SimEvent* post( SimEventQueue &queue, SimTime time, SimObject *obj )
+   {
+      TestEvent *event = new TestEvent;
+      event->time = time;
+      event->startTime = 0;
+      event->destObject = obj;
+      event->sequenceCount = nextSequence++;
+      queue.push( event );
+      return event;
+   }
+
+   /// Pop all the events and make sure they come out in time
+   /// order and in posting order for the same time.
+   U32 popAndCheck( SimEventQueue &queue )
+   {
+      U32 count = 0;
+      SimTime lastTime = 0;
+      U32 lastSequence = 0;
+
+      while ( SimEvent *event = queue.popDue( U32_MAX ) )
+      {
+         EXPECT_GE( event->time, lastTime ) << "Event " << event->sequenceCount << " is out of order.";
+         if ( event->time == lastTime )
+         {
+            EXPECT_GT( event->sequenceCount, lastSequence ) << "Events with the same time must be FIFO.";
+         }
+
+         lastTime = event->time;
+         lastSequence = event->sequenceCount;
+         delete event;
+         count++;
+      }
+
+      return count;
+   }
+};
+
+U32 SimEventQueueFixture::TestEvent::smDeleted = 0;
+
+TEST_FIX(SimEventQueue, SameTimeFIFO)
+{
+   SimEventQueue queue;
+
+   // Few distinct times so there are lots of ties.
+   for ( U32 i = 0; i < 1000; i++ )
+      post( queue, rand.randI( 0, 9 ) * 32, fakeObject( 0 ) );
+
+   EXPECT_EQ( 1000, queue.size() );
+   EXPECT_EQ( 1000, popAndCheck( queue ) );
+   EXPECT_TRUE( queue.isEmpty() );
+}
+
+TEST_FIX(SimEventQueue, PopDue)
+{
+   SimEventQueue queue;
+   post( queue, 100, fakeObject( 0 ) );
+   post( queue, 50, fakeObject( 0 ) );
+   post( queue, 200, fakeObject( 0 ) );
+
+   EXPECT_TRUE( queue.popDue( 49 ) == NULL );
+
+   SimEvent *event = queue.popDue( 150 );
+   ASSERT_TRUE( event != NULL );
+   EXPECT_EQ( 50, event->time );
+   delete event;
+
+   event = queue.popDue( 150 );
+   ASSERT_TRUE( event != NULL );
+   EXPECT_EQ( 100, event->time );
+   delete event;
+
+   EXPECT_TRUE( queue.popDue( 150 ) == NULL );
+   EXPECT_EQ( 1, queue.size() );
+}
+
+TEST_FIX(SimEventQueue, Cancel)
+{
+   SimEventQueue queue;
+
+   Vector<U32> ids;
+   for ( U32 i = 0; i < 2000; i++ )
+      ids.push_back( post( queue, rand.randI( 0, 500 ), fakeObject( 0 ) )->sequenceCount );
+
+   // Cancel every third event.
+   U32 removed = 0;
+   for ( U32 i = 0; i < ids.size(); i += 3 )
+   {
+      SimEvent *event = queue.remove( ids[i] );
+      ASSERT_TRUE( event != NULL );
+      EXPECT_EQ( ids[i], event->sequenceCount );
+      delete event;
+      removed++;
+
+      EXPECT_TRUE( queue.find( ids[i] ) == NULL );
+      EXPECT_TRUE( queue.remove( ids[i] ) == NULL ) << "Cancelling twice should do nothing.";
+   }
+
+   for ( U32 i = 1; i < ids.size(); i += 3 )
+      EXPECT_TRUE( queue.find( ids[i] ) != NULL );
+
+   EXPECT_EQ( ids.size() - removed, queue.size() );
+   EXPECT_EQ( ids.size() - removed, popAndCheck( queue ) );
+}
+
+TEST_FIX(SimEventQueue, DeleteObjectEvents)
+{
+   U32 countA = 0;
+
+   {
+      SimEventQueue queue;
+      for ( U32 i = 0; i < 500; i++ )
+      {
+         const bool isA = rand.randI( 0, 3 ) == 0;
+         countA += isA ? 1 : 0;
+         post( queue, rand.randI( 0, 100 ), fakeObject( isA ? 0 : 1 ) );
+      }
+
+      queue.deleteEvents( fakeObject( 0 ) );
+      EXPECT_EQ( countA, TestEvent::smDeleted );
+      EXPECT_EQ( 500 - countA, queue.size() );
+
+      // An object without events is a no-op.
+      queue.deleteEvents( fakeObject( 2 ) );
+      EXPECT_EQ( 500 - countA, queue.size() );
+
+      SimTime lastTime = 0;
+      while ( SimEvent *event = queue.popDue( U32_MAX ) )
+      {
+         EXPECT_TRUE( event->destObject == fakeObject( 1 ) );
+         EXPECT_GE( event->time, lastTime );
+         lastTime = event->time;
+         delete event;
+      }
+
+      for ( U32 i = 0; i < 10; i++ )
+         post( queue, i, fakeObject( 0 ) );
+   }
+
+   // The queue deletes its pending events.
+   EXPECT_EQ( 510, TestEvent::smDeleted );
+}
+
+TEST_FIX(SimEventQueue, InterleavedPostCancelDispatch)
+{
+   // Schedules being posted, cancelled and dispatched every
+   // tick, checked against the time each one was posted for.
+   const U32 numTicks = 200;
+   const U32 tickMS = 32;
+
+   SimEventQueue queue;
+
+   // Indexed by sequence count.
+   Vector<SimTime> times;
+   Vector<bool> pending;
+   times.push_back( 0 );
+   pending.push_back( false );
+
+   Vector<U32> ids;
+   for ( U32 i = 0; i < 2000; i++ )
+   {
+      const SimTime time = rand.randI( 0, 3000 );
+      ids.push_back( post( queue, time, fakeObject( i % 10 ) )->sequenceCount );
+      times.push_back( time );
+      pending.push_back( true );
+   }
+
+   U32 numPending = ids.size();
+   for ( U32 t = 0; t < numTicks; t++ )
+   {
+      const SimTime now = t * tickMS;
+
+      for ( U32 i = 0; i < 10; i++ )
+      {
+         const SimTime time = now + rand.randI( 0, 3000 );
+         ids.push_back( post( queue, time, fakeObject( i ) )->sequenceCount );
+         times.push_back( time );
+         pending.push_back( true );
+         numPending++;
+
+         const U32 id = ids[ rand.randI( 0, ids.size() - 1 ) ];
+         SimEvent *event = queue.remove( id );
+         ASSERT_EQ( pending[id], event != NULL ) << "Cancelling event " << id;
+         if ( event )
+         {
+            pending[id] = false;
+            numPending--;
+            delete event;
+         }
+      }
+
+      SimTime lastTime = 0;
+      while ( SimEvent *event = queue.popDue( now ) )
+      {
+         const U32 id = event->sequenceCount;
+         ASSERT_TRUE( pending[id] ) << "Event " << id << " was already dispatched or cancelled.";
+         EXPECT_EQ( times[id], event->time );
+         EXPECT_LE( event->time, now );
+         EXPECT_GE( event->time, lastTime );
+         lastTime = event->time;
+
+         pending[id] = false;
+         numPending--;
+         delete event;
+      }
+
+      // Nothing due is left behind.
+      for ( U32 id = 1; id < pending.size(); id++ )
+      {
+         if ( pending[id] )
+         {
+            ASSERT_GT( times[id], now ) << "Event " << id << " missed its dispatch.";
+         }
+      }
+
+      ASSERT_EQ( numPending, queue.size() );
+   }
+}
+
+#endif
@@ -235,11 +235,33 @@ void BitStream::writeBits(S32 bitCount, const void *bitPtr)
       return;
    }
 
-   // [tom, 8/17/2006] This is probably a lot lamer then it needs to be. However,
-   // at least it doesnt clobber data or overrun the buffer like the old code did.
    const U8 *ptr = (U8 *)bitPtr;
 
-   for(S32 srcBitNum = 0;srcBitNum < bitCount;srcBitNum++)
+   // Copy whole source bytes at once.  Bits past the end of the write are
+   // left untouched, just like the per bit copy below.
+   S32 byteCount = bitCount >> 3;
+   if(byteCount)
+   {
+      U8 *dstPtr = dataPtr + (bitNum >> 3);
+      S32 upShift = bitNum & 0x7;
+      if(!upShift)
+         dMemcpy(dstPtr, ptr, byteCount);
+      else
+      {
+         S32 downShift = 8 - upShift;
+         U8 lowMask = U8((1 << upShift) - 1);
+         for(S32 i = 0; i < byteCount; i++)
+         {
+            dstPtr[i] = U8((dstPtr[i] & lowMask) | (ptr[i] << upShift));
+            dstPtr[i + 1] = U8((dstPtr[i + 1] & ~lowMask) | (ptr[i] >> downShift));
+         }
+      }
+      bitNum += byteCount << 3;
+   }
+
+   // [tom, 8/17/2006] This is probably a lot lamer then it needs to be. However,
+   // at least it doesnt clobber data or overrun the buffer like the old code did.
+   for(S32 srcBitNum = byteCount << 3;srcBitNum < bitCount;srcBitNum++)
    {
       if((*(ptr + (srcBitNum >> 3)) & (1 << (srcBitNum & 0x7))) != 0)
          *(dataPtr + (bitNum >> 3)) |= (1 << (bitNum & 0x7));
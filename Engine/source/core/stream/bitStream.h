@@ -64,6 +64,7 @@ public:
 
    void setBuffer(void *bufPtr, S32 bufSize, S32 maxSize = 0);
    U8*  getBuffer() { return dataPtr; }
+   S32  getBufferSize() const { return bufSize; }
    U8*  getBytePtr();
 
    U32 getReadByteSize();
@@ -169,6 +170,7 @@ public:
 
    void clearCompressionPoint();
    void setCompressionPoint(const Point3F& p);
+   const Point3F& getCompressionPoint() const { return mCompressPoint; }
 
    // Matching calls to these compression methods must, of course,
    // have matching scale values.
@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2014 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "core/stream/bitStream.h"
+
+TEST(BitStream, WriteBitsAtAnyOffset)
+{
+   U8 src[32];
+   for(U32 i = 0; i < sizeof(src); i++)
+      src[i] = U8(i * 37 + 11);
+
+   for(U32 offset = 0; offset < 16; offset++)
+   {
+      for(U32 bitCount = 0; bitCount <= 8 * 20; bitCount += 3)
+      {
+         // Fill the buffer with ones so clobbered bits show up.
+         U8 buffer[64];
+         dMemset(buffer, 0xFF, sizeof(buffer));
+
+         BitStream stream(buffer, sizeof(buffer));
+         stream.setCurPos(offset);
+         stream.writeBits(bitCount, src);
+         EXPECT_EQ(offset + bitCount, stream.getCurPos());
+
+         for(U32 bit = 0; bit < sizeof(buffer) * 8; bit++)
+         {
+            bool expected = true;
+            if(bit >= offset && bit < offset + bitCount)
+               expected = (src[(bit - offset) >> 3] & (1 << ((bit - offset) & 0x7))) != 0;
+            EXPECT_EQ(expected, stream.testBit(bit))
+               << "offset " << offset << ", " << bitCount << " bits, bit " << bit;
+         }
+
+         // And the bits read back the same.
+         U8 dst[32];
+         stream.setCurPos(offset);
+         stream.readBits(bitCount, dst);
+         for(U32 i = 0; i < (bitCount >> 3); i++)
+            EXPECT_EQ(src[i], dst[i]);
+      }
+   }
+}
+
+#endif
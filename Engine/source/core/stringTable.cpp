@@ -23,9 +23,12 @@
 #include "core/strings/stringFunctions.h"
 #include "core/stringTable.h"
 #include "platform/profiler.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/threads/mutex.h"
+#include "core/util/tVector.h"
 
 _StringTable *_gStringTable = NULL;
-const U32 _StringTable::csm_stInitSize = 29;
+const U32 _StringTable::csm_stInitSize = 64;
 
 //---------------------------------------------------------------
 //
@@ -35,66 +38,85 @@ const U32 _StringTable::csm_stInitSize = 29;
 
 namespace {
 bool sgInitTable = true;
-U8   sgHashTable[256];
+U8   sgTolowerTable[256];
 
 void initTolowerTable()
 {
-   for (U32 i = 0; i < 256; i++) {
-      U8 c = dTolower(i);
-      sgHashTable[i] = c * c;
-   }
+   for (U32 i = 0; i < 256; i++)
+      sgTolowerTable[i] = dTolower(i);
 
    sgInitTable = false;
 }
 
-} // namespace {}
-
-U32 _StringTable::hashString(const char* str)
+/// Case-insensitive FNV-1a over at most maxLen characters, stopping at the
+/// terminator.  The length actually hashed is returned in outLen.
+U32 hashChars(const char *str, S32 maxLen, U32 &outLen)
 {
    if (sgInitTable)
       initTolowerTable();
 
-   if(!str) return -1;
-
-   U32 ret = 0;
+   U32 ret = 2166136261u;
+   const char *walk = str;
    char c;
-   while((c = *str++) != 0) {
-      ret <<= 1;
-      ret ^= sgHashTable[static_cast<U8>(c)];
+   while(maxLen-- > 0 && (c = *walk) != 0)
+   {
+      ret ^= sgTolowerTable[static_cast<U8>(c)];
+      ret *= 16777619u;
+      walk++;
    }
+   outLen = walk - str;
+
+   // FNV leaves the high bits poorly mixed, and those select the shard.
+   ret ^= ret >> 16;
+   ret *= 0x85ebca6b;
+   ret ^= ret >> 13;
+   ret *= 0xc2b2ae35;
+   ret ^= ret >> 16;
    return ret;
 }
 
-U32 _StringTable::hashStringn(const char* str, S32 len)
+/// Allocate pointer aligned memory from the pool.  Everything in a shard's
+/// pool goes through here so node links are always safe to swap atomically.
+inline void* allocAligned(DataChunker &pool, U32 size)
 {
-   if (sgInitTable)
-      initTolowerTable();
+   const U32 align = sizeof(void*);
+   return pool.alloc((size + align - 1) & ~(align - 1));
+}
 
-   U32 ret = 0;
-   char c;
-   while((c = *str++) != 0 && len--) {
-      ret <<= 1;
-      ret ^= sgHashTable[static_cast<U8>(c)];
-   }
-   return ret;
+} // namespace {}
+
+U32 _StringTable::hashString(const char* str)
+{
+   if(!str) return -1;
+
+   U32 len;
+   return hashChars(str, S32_MAX, len);
+}
+
+U32 _StringTable::hashStringn(const char* str, S32 len)
+{
+   U32 hashedLen;
+   return hashChars(str, len, hashedLen);
 }
 
 //--------------------------------------
 _StringTable::_StringTable()
 {
-   buckets = (Node **) dMalloc(csm_stInitSize * sizeof(Node *));
-   for(U32 i = 0; i < csm_stInitSize; i++) {
-      buckets[i] = 0;
+   for(U32 i = 0; i < NumShards; i++)
+   {
+      Shard &shard = mShards[i];
+      shard.table = NULL;
+      shard.itemCount = 0;
+      shard.mutex = Mutex::createMutex();
+      _resizeShard(shard, csm_stInitSize);
    }
-
-   numBuckets = csm_stInitSize;
-   itemCount = 0;
 }
 
 //--------------------------------------
 _StringTable::~_StringTable()
 {
-   dFree(buckets);
+   for(U32 i = 0; i < NumShards; i++)
+      Mutex::destroyMutex(mShards[i].mutex);
 }
 
 
@@ -118,6 +140,129 @@ void _StringTable::destroy()
    _gStringTable = NULL;
 }
 
+//--------------------------------------
+const _StringTable::Node* _StringTable::_find(const Table *table, const char *val, U32 len, U32 hash, bool caseSens)
+{
+   // Nodes are only ever appended to the end of a chain, so this walk
+   // is safe while another thread adds to the shard.
+   for(const Node *walk = table->buckets[hash & table->mask]; walk != NULL; walk = walk->next)
+   {
+      if(walk->hash != hash || walk->len != len)
+         continue;
+
+      if(caseSens ? !dStrncmp(walk->val, val, len) : !dStrnicmp(walk->val, val, len))
+         return walk;
+   }
+   return NULL;
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::_add(Shard &shard, const char *val, U32 len, U32 hash, bool caseSens)
+{
+   // Another thread may have added the string since the unlocked lookup,
+   // so search the current table again before appending.
+   Table *table = shard.table;
+   Node *volatile *link = &table->buckets[hash & table->mask];
+   for(Node *walk = *link; walk != NULL; walk = *link)
+   {
+      if(walk->hash == hash && walk->len == len &&
+         (caseSens ? !dStrncmp(walk->val, val, len) : !dStrnicmp(walk->val, val, len)))
+         return walk->val;
+      link = &walk->next;
+   }
+
+   char *str = (char *) allocAligned(shard.mempool, len + 1);
+   dMemcpy(str, val, len);
+   str[len] = 0;
+
+   Node *node = (Node *) allocAligned(shard.mempool, sizeof(Node));
+   node->val = str;
+   node->hash = hash;
+   node->len = len;
+   node->next = NULL;
+
+   // The swap is a full barrier, so readers never see a partly filled node.
+   bool linked = dCompareAndSwap(*link, (Node *) NULL, node);
+   AssertFatal(linked, "_StringTable::_add - chain changed while the shard was locked!");
+   TORQUE_UNUSED(linked);
+
+   shard.itemCount++;
+   if(shard.itemCount > 2 * (table->mask + 1))
+      _resizeShard(shard, 4 * (table->mask + 1));
+
+   return str;
+}
+
+//--------------------------------------
+void _StringTable::_resizeShard(Shard &shard, U32 numBuckets)
+{
+   U32 size = 1;
+   while(size < numBuckets)
+      size <<= 1;
+
+   Table *oldTable = shard.table;
+   if(oldTable && size <= oldTable->mask + 1)
+      return;
+
+   Table *table = (Table *) allocAligned(shard.mempool, sizeof(Table));
+   table->mask = size - 1;
+   table->buckets = (Node *volatile *) allocAligned(shard.mempool, size * sizeof(Node *));
+   dMemset((void *) table->buckets, 0, size * sizeof(Node *));
+
+   if(oldTable)
+   {
+      // Readers may still be walking the old chains, so copy the nodes
+      // rather than relinking them.  Chain order is kept so the first
+      // inserted case variant of a string is still the one found by
+      // case insensitive lookups.
+      Vector<Node *volatile *> tails;
+      tails.setSize(size);
+      for(U32 i = 0; i < size; i++)
+         tails[i] = &table->buckets[i];
+
+      for(U32 i = 0; i <= oldTable->mask; i++)
+      {
+         for(const Node *walk = oldTable->buckets[i]; walk != NULL; walk = walk->next)
+         {
+            Node *node = (Node *) allocAligned(shard.mempool, sizeof(Node));
+            *node = *walk;
+            node->next = NULL;
+
+            const U32 index = walk->hash & table->mask;
+            *tails[index] = node;
+            tails[index] = &node->next;
+         }
+      }
+   }
+
+   // The old table stays in the pool for any thread still reading it.
+   dCompareAndSwap(shard.table, oldTable, table);
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::_insert(const char *val, S32 maxLen, bool caseSens)
+{
+   U32 len;
+   const U32 hash = hashChars(val, maxLen, len);
+   Shard &shard = _getShard(hash);
+
+   const Node *node = _find(shard.table, val, len, hash, caseSens);
+   if(node)
+      return node->val;
+
+   MutexHandle lock;
+   lock.lock(shard.mutex, true);
+   return _add(shard, val, len, hash, caseSens);
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::_lookup(const char *val, S32 maxLen, bool caseSens)
+{
+   U32 len;
+   const U32 hash = hashChars(val, maxLen, len);
+   const Node *node = _find(_getShard(hash).table, val, len, hash, caseSens);
+   return node ? node->val : NULL;
+}
 
 //--------------------------------------
 StringTableEntry _StringTable::insert(const char* _val, const bool caseSens)
@@ -130,39 +275,15 @@ StringTableEntry _StringTable::insert(const char* _val, const bool caseSens)
       val = "";
    //-
 
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL)   {
-      if(caseSens && !dStrcmp(temp->val, val))
-         return temp->val;
-      else if(!caseSens && !dStricmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
-   }
-   char *ret = 0;
-   if(!*walk) {
-      *walk = (Node *) mempool.alloc(sizeof(Node));
-      (*walk)->next = 0;
-      (*walk)->val = (char *) mempool.alloc(dStrlen(val) + 1);
-      dStrcpy((*walk)->val, val);
-      ret = (*walk)->val;
-      itemCount ++;
-   }
-   if(itemCount > 2 * numBuckets) {
-      resize(4 * numBuckets - 1);
-   }
-   return ret;
+   return _insert(val, S32_MAX, caseSens);
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::insertn(const char* src, S32 len, const bool  caseSens)
 {
-   char val[256];
-   AssertFatal(len < 255, "Invalid string to insertn");
-   dStrncpy(val, src, len);
-   val[len] = 0;
-   return insert(val, caseSens);
+   PROFILE_SCOPE(StringTableInsertN);
+
+   return _insert(src, len, caseSens);
 }
 
 //--------------------------------------
@@ -170,17 +291,7 @@ StringTableEntry _StringTable::lookup(const char* val, const bool  caseSens)
 {
    PROFILE_SCOPE(StringTableLookup);
 
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL)   {
-      if(caseSens && !dStrcmp(temp->val, val))
-            return temp->val;
-      else if(!caseSens && !dStricmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return NULL;
+   return _lookup(val, S32_MAX, caseSens);
 }
 
 //--------------------------------------
@@ -188,56 +299,19 @@ StringTableEntry _StringTable::lookupn(const char* val, S32 len, const bool  cas
 {
    PROFILE_SCOPE(StringTableLookupN);
 
-   Node **walk, *temp;
-   U32 key = hashStringn(val, len);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL) {
-      if(caseSens && !dStrncmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      else if(!caseSens && !dStrnicmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return NULL;
+   return _lookup(val, len, caseSens);
 }
 
 //--------------------------------------
-void _StringTable::resize(const U32 _newSize)
+void _StringTable::resize(const U32 newSize)
 {
-   /// avoid a possible 0 division
-   const U32 newSize = _newSize ? _newSize : 1;
+   // Spread the requested bucket count over the shards.
+   const U32 perShard = (newSize + NumShards - 1) / NumShards;
 
-   Node *head = NULL, *walk, *temp;
-   U32 i;
-   // reverse individual bucket lists
-   // we do this because new strings are added at the end of bucket
-   // lists so that case sens strings are always after their
-   // corresponding case insens strings
-
-   for(i = 0; i < numBuckets; i++) {
-      walk = buckets[i];
-      while(walk)
-      {
-         temp = walk->next;
-         walk->next = head;
-         head = walk;
-         walk = temp;
-      }
-   }
-   buckets = (Node **) dRealloc(buckets, newSize * sizeof(Node));
-   for(i = 0; i < newSize; i++) {
-      buckets[i] = 0;
-   }
-   numBuckets = newSize;
-   walk = head;
-   while(walk) {
-      U32 key;
-      Node *temp = walk;
-
-      walk = walk->next;
-      key = hashString(temp->val);
-      temp->next = buckets[key % newSize];
-      buckets[key % newSize] = temp;
+   for(U32 i = 0; i < NumShards; i++)
+   {
+      MutexHandle lock;
+      lock.lock(mShards[i].mutex, true);
+      _resizeShard(mShards[i], perShard);
    }
 }
-
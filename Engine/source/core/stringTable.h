@@ -70,6 +70,11 @@
 ///  The scripting engine and the resource manager are the primary users of the
 ///  StringTable.
 ///
+/// The table may be used from any thread.  It is split into shards selected by the
+/// string hash; lookups never take a lock, and inserting a new string only locks the
+/// shard it lands in.  Returned entries stay valid for the life of the table, even
+/// across resizes.
+///
 /// @note Be aware that the StringTable NEVER DEALLOCATES memory, so be careful when you
 ///       add strings to it. If you carelessly add many strings, you will end up wasting
 ///       space.
@@ -82,18 +87,55 @@ private:
    /// This is internal to the _StringTable class.
    struct Node
    {
-      char *val;
-      Node *next;
+      const char     *val;
+      U32            hash;
+      U32            len;
+      Node *volatile next;
+   };
+
+   /// A bucket array.  Tables are never modified in place once published;
+   /// a resize builds a new table and the old one stays alive for readers
+   /// still walking it.
+   struct Table
+   {
+      U32            mask;
+      Node *volatile *buckets;
    };
 
-   Node**      buckets;
-   U32         numBuckets;
-   U32         itemCount;
-   DataChunker mempool;
+   struct Shard
+   {
+      Table *volatile   table;
+      U32               itemCount;
+      void              *mutex;     ///< Held only while adding strings.
+      DataChunker       mempool;    ///< Strings, nodes and tables of this shard.
+   };
+
+   enum
+   {
+      ShardBits = 5,
+      NumShards = 1 << ShardBits,
+   };
+
+   Shard mShards[NumShards];
 
    StringTableEntry _EmptyString;
 
+   Shard& _getShard(U32 hash) { return mShards[hash >> (32 - ShardBits)]; }
+
+   /// Find a string in the shard without locking.
+   static const Node* _find(const Table *table, const char *val, U32 len, U32 hash, bool caseSens);
+
+   /// Add a string to the shard, which must be locked.
+   StringTableEntry _add(Shard &shard, const char *val, U32 len, U32 hash, bool caseSens);
+
+   /// Rebuild the shard's buckets with the given count; the shard must be locked.
+   static void _resizeShard(Shard &shard, U32 numBuckets);
+
+   StringTableEntry _insert(const char *val, S32 maxLen, bool caseSens);
+   StringTableEntry _lookup(const char *val, S32 maxLen, bool caseSens);
+
   protected:
+   /// Initial number of buckets in each shard.
    static const U32 csm_stInitSize;
 
    _StringTable();
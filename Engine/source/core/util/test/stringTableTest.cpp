@@ -0,0 +1,292 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2014 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "core/stringTable.h"
+#include "core/strings/stringFunctions.h"
+#include "core/util/tVector.h"
+#include "platform/threads/thread.h"
+#include "console/console.h"
+
+FIXTURE(StringInterning)
+{
+public:
+   /// A private table so the tests don't fill up the global one.
+   class TestTable : public _StringTable
+   {
+   public:
+      TestTable() {}
+      ~TestTable() {}
+   };
+
+   static void makeName( char *buffer, U32 i )
+   {
+      dSprintf( buffer, 32, "stringTableTest_%u", i );
+   }
+
+   /// Interns a range of names, starting at a different point in
+   /// each thread so they race on inserting the same strings.
+   struct InsertThread : public Thread
+   {
+      _StringTable *mTable;
+      U32 mCount;
+      U32 mStart;
+      U32 mRepeat;
+      Vector<StringTableEntry> mEntries;
+
+      InsertThread( _StringTable *table, U32 count, U32 start, U32 repeat = 1 )
+         : mTable( table ), mCount( count ), mStart( start ), mRepeat( repeat )
+      {
+         mEntries.setSize( count );
+      }
+
+      virtual void run( void* )
+      {
+         char name[32];
+         for ( U32 r = 0; r < mRepeat; r++ )
+         {
+            for ( U32 i = 0; i < mCount; i++ )
+            {
+               const U32 index = ( mStart + i ) % mCount;
+               makeName( name, index );
+
+               // Mostly lookups of strings that are already interned,
+               // the way scripts and datablocks hit the table.
+               if ( r > 0 && mTable->lookup( name ) != mEntries[index] )
+                  mEntries[index] = NULL;
+               else
+                  mEntries[index] = mTable->insert( name );
+            }
+         }
+      }
+   };
+};
+
+TEST_FIX(StringInterning, CaseInsensitiveKeepsFirstSpelling)
+{
+   TestTable table;
+
+   StringTableEntry a = table.insert( "Hello" );
+   EXPECT_EQ( a, table.insert( "Hello" ) );
+   EXPECT_EQ( a, table.insert( "hello" ) ) << "Case insensitive inserts must return the first variant.";
+   EXPECT_EQ( a, table.lookup( "HELLO" ) );
+   EXPECT_STREQ( "Hello", a );
+
+   // A case sensitive insert of another spelling gets its own entry.
+   StringTableEntry b = table.insert( "hello", true );
+   EXPECT_NE( a, b );
+   EXPECT_STREQ( "hello", b );
+   EXPECT_EQ( b, table.lookup( "hello", true ) );
+   EXPECT_EQ( a, table.lookup( "hello" ) );
+   EXPECT_TRUE( table.lookup( "hELLO", true ) == NULL );
+   EXPECT_TRUE( table.lookup( "Goodbye" ) == NULL );
+
+   EXPECT_EQ( _StringTable::hashString( "Hello" ), _StringTable::hashString( "hELLO" ) );
+}
+
+TEST_FIX(StringInterning, LengthLimitedCallsStopAtLength)
+{
+   TestTable table;
+
+   StringTableEntry a = table.insertn( "Hello, World", 5 );
+   EXPECT_STREQ( "Hello", a );
+   EXPECT_EQ( a, table.insert( "Hello" ) );
+   EXPECT_EQ( a, table.lookupn( "HELLO there", 5 ) );
+   EXPECT_TRUE( table.lookupn( "Hello, World", 6 ) == NULL );
+   EXPECT_STREQ( "", table.insert( NULL ) );
+
+   EXPECT_EQ( _StringTable::hashString( "Hello" ), _StringTable::hashStringn( "Hello, World", 5 ) );
+}
+
+TEST_FIX(StringInterning, HashSpreadsNumberedNames)
+{
+   // Names which only differ in a number at the end are
+   // the common case, and they pick the shard by the top
+   // bits of the hash, so those have to vary as well.
+   const U32 numBins = 32;
+   const U32 count = numBins * 1000;
+   U32 bins[numBins] = { 0 };
+
+   char name[32];
+   for ( U32 i = 0; i < count; i++ )
+   {
+      makeName( name, i );
+      bins[_StringTable::hashString( name ) >> 27]++;
+   }
+
+   for ( U32 i = 0; i < numBins; i++ )
+   {
+      EXPECT_GT( bins[i], 500u ) << "Top bits " << i;
+      EXPECT_LT( bins[i], 1500u ) << "Top bits " << i;
+   }
+}
+
+TEST_FIX(StringInterning, EntriesSurviveGrowth)
+{
+   TestTable table;
+   const U32 count = 100000;
+   char name[32];
+
+   // Far past the initial bucket counts, so every shard grows a few times.
+   Vector<StringTableEntry> entries;
+   entries.setSize( count );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      makeName( name, i );
+      entries[i] = table.insert( name );
+   }
+
+   table.resize( count * 2 );
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      makeName( name, i );
+      ASSERT_EQ( entries[i], table.insert( name ) ) << "Entry for " << name << " moved.";
+      ASSERT_EQ( entries[i], table.lookup( name ) );
+      ASSERT_STREQ( name, entries[i] );
+   }
+}
+
+TEST_FIX(StringInterning, RacingInsertsShareOneEntry)
+{
+   TestTable table;
+   const U32 numThreads = 4;
+   const U32 count = 50000;
+
+   InsertThread *threads[numThreads];
+   for ( U32 i = 0; i < numThreads; i++ )
+   {
+      threads[i] = new InsertThread( &table, count, i * count / numThreads );
+      threads[i]->start();
+   }
+   for ( U32 i = 0; i < numThreads; i++ )
+      threads[i]->join();
+
+   // Every thread must have got the same entry for each string.
+   char name[32];
+   for ( U32 i = 0; i < count; i++ )
+   {
+      makeName( name, i );
+      StringTableEntry entry = table.lookup( name );
+      ASSERT_TRUE( entry != NULL );
+      ASSERT_STREQ( name, entry );
+      for ( U32 t = 0; t < numThreads; t++ )
+         ASSERT_EQ( entry, threads[t]->mEntries[i] ) << "Thread " << t << " got a different entry for " << name;
+   }
+
+   for ( U32 i = 0; i < numThreads; i++ )
+      delete threads[i];
+}
+
+TEST_FIX(StringInterning, LookupsSeeEntriesWhileShardsGrow)
+{
+   TestTable table;
+   const U32 count = 20000;
+
+   // The first half is in the table before the threads start.
+   char name[32];
+   Vector<StringTableEntry> entries;
+   entries.setSize( count );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      makeName( name, i );
+      entries[i] = table.insert( name );
+   }
+
+   // A writer adds new strings, growing the shards, while a reader
+   // keeps finding the old ones without taking a lock.
+   struct Reader : public Thread
+   {
+      _StringTable *mTable;
+      const Vector<StringTableEntry> *mEntries;
+      U32 mMisses;
+
+      virtual void run( void* )
+      {
+         char name[32];
+         for ( U32 r = 0; r < 10; r++ )
+         {
+            for ( U32 i = 0; i < mEntries->size(); i++ )
+            {
+               makeName( name, i );
+               if ( mTable->lookup( name ) != (*mEntries)[i] )
+                  mMisses++;
+            }
+         }
+      }
+   };
+
+   Reader reader;
+   reader.mTable = &table;
+   reader.mEntries = &entries;
+   reader.mMisses = 0;
+
+   InsertThread writer( &table, count * 10, count );
+   reader.start();
+   writer.start();
+   reader.join();
+   writer.join();
+
+   EXPECT_EQ( 0u, reader.mMisses );
+}
+
+/// Times the threads interning and looking up the same strings.
+TEST_FIX(StringInterning, ThreadedInternTime)
+{
+   const U32 count = 100000;
+   const U32 repeat = 10;
+
+   for ( U32 numThreads = 1; numThreads <= 8; numThreads *= 2 )
+   {
+      TestTable table;
+      InsertThread *threads[8];
+
+      const U32 start = Platform::getRealMilliseconds();
+      for ( U32 i = 0; i < numThreads; i++ )
+      {
+         threads[i] = new InsertThread( &table, count, i * count / numThreads, repeat );
+         threads[i]->start();
+      }
+      for ( U32 i = 0; i < numThreads; i++ )
+         threads[i]->join();
+      const U32 elapsed = Platform::getRealMilliseconds() - start;
+
+      Con::printf( "StringTable %u threads, %u strings, %u inserts/lookups each in %ums",
+         numThreads, count, count * repeat, elapsed );
+
+      // A NULL entry is a lookup which didn't find what was inserted.
+      for ( U32 i = 0; i < numThreads; i++ )
+      {
+         for ( U32 j = 0; j < count; j += 7 )
+         {
+            ASSERT_TRUE( threads[i]->mEntries[j] != NULL ) << "Thread " << i << " string " << j;
+            ASSERT_EQ( threads[0]->mEntries[j], threads[i]->mEntries[j] ) << "Thread " << i << " string " << j;
+         }
+      }
+
+      for ( U32 i = 0; i < numThreads; i++ )
+         delete threads[i];
+   }
+}
+
+#endif
@@ -974,6 +974,62 @@ bool ReadFile(const Path &inPath, void *&outData, U32 &outSize, bool inNullTermi
    return true;
 }
 
+MappedFile::MappedFile()
+   : mData( NULL ),
+     mSize( 0 ),
+     mBuffer( NULL )
+{
+}
+
+MappedFile::~MappedFile()
+{
+   close();
+}
+
+bool MappedFile::open(const Path &inPath)
+{
+   close();
+
+   FileRef fileR = OpenFile( inPath, File::Read );
+   if ( fileR == NULL )
+      return false;
+
+   // Try mapping the file first.
+   U32 size = 0;
+   const void *data = fileR->map( &size );
+   if ( data )
+   {
+      mFile = fileR;
+      mData = static_cast<const U8*>( data );
+      mSize = size;
+      return true;
+   }
+
+   // This file system can't map files, so
+   // fall back to reading it all in.
+   fileR = NULL;
+   if ( !ReadFile( inPath, mBuffer, mSize ) )
+      return false;
+
+   mData = static_cast<const U8*>( mBuffer );
+   return true;
+}
+
+void MappedFile::close()
+{
+   if ( mFile != NULL )
+   {
+      mFile->unmap();
+      mFile->close();
+      mFile = NULL;
+   }
+
+   delete [] static_cast<char*>( mBuffer );
+   mBuffer = NULL;
+   mData = NULL;
+   mSize = 0;
+}
+
 DirectoryRef OpenDirectory(const Path &path)
 {
    return sgMountSystem.openDirectory(path);
@@ -180,6 +180,16 @@ public:
 
    virtual U32 read(void* dst, U32 size) = 0;
    virtual U32 write(const void* src, U32 size) = 0;
+
+   /// Map the entire file into memory for reading.
+   /// The file must be open for reading and the memory stays valid
+   /// until unmap() or close() is called.
+   ///@param outSize  receives the size of the mapped data
+   ///@return Null if the file system doesn't support mapping files
+   virtual const void* map(U32*) { return NULL; }
+
+   /// Release the memory returned from map().
+   virtual void unmap() {}
 };
 
 typedef WeakRefPtr<File> FilePtr;
@@ -525,6 +535,38 @@ FileRef OpenFile(const Path &file, File::AccessMode mode);
 ///@return successful read?  If not, outData will be NULL and outSize will be 0
 bool  ReadFile(const Path &inPath, void *&outData, U32 &outSize, bool inNullTerminate = false );
 
+/// Read only access to the entire contents of a file.
+/// The file is mapped into memory when the file system supports
+/// it and read into a buffer otherwise, so the contents can be
+/// consumed in place either way.
+///@ingroup VolumeSystem
+class MappedFile
+{
+public:
+   MappedFile();
+   ~MappedFile();
+
+   /// Map or read the file, releasing any previously opened file.
+   bool open(const Path &inPath);
+   void close();
+
+   const U8* getData() const { return mData; }
+   U32 getSize() const { return mSize; }
+
+   /// Returns true if the data is mapped from the file rather than
+   /// read into a buffer.
+   bool isMapped() const { return mFile != NULL; }
+
+private:
+   MappedFile(const MappedFile&);
+   MappedFile& operator=(const MappedFile&);
+
+   FileRef  mFile;
+   const U8 *mData;
+   U32      mSize;
+   void     *mBuffer;
+};
+
 /// Open a directory.
 /// If the directory exists a directory object will be returned even if the
 /// open operation fails.
@@ -134,6 +134,9 @@ void Forest::consoleInit()
    Con::addVariable("$Forest::drawBounds", TypeBool, &Forest::smDrawBounds,
       "A debugging aid which renders the forest bounds.\n"
       "@ingroup Forest\n" );
+   Con::addVariable("$Forest::SIMDCulling", TypeBool, &Forest::smSIMDCulling,
+      "Use SSE to cull the forest cells four at a time when supported by the CPU.\n"
+      "@ingroup Forest\n" );
 
    // The canvas signal lets us know to clear the rendering stats.
    GuiCanvas::getGuiCanvasFrameSignal().notify( &Forest::_clearStats );
@@ -142,6 +142,17 @@ protected:
    static ForestCreatedSignal smDestroyedSignal;
 
 public:
+
+   /// Enables the SSE path of cullCellQuad() when the CPU supports it.
+   static bool smSIMDCulling;
+
+   /// Tests the four cells of a quad against the frustum planes and bounds
+   /// exactly like Frustum::testPlanes() and Box3F::isOverlapped() would.
+   ///
+   /// @param outPartial Receives the bits of the visible cells which 
+   ///                   intersect at least one of the planes.
+   /// @return The bitmask of the visible cells.
+   static U32 cullCellQuad( const ForestCellQuad &quad, const Frustum &culler, U32 *outPartial );
    
    static ForestCreatedSignal& getCreatedSignal() { return smCreatedSignal; }
    static ForestCreatedSignal& getDestroyedSignal() { return smDestroyedSignal; }
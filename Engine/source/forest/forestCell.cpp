@@ -151,6 +151,27 @@ S32 ForestCell::render( TSRenderState *rdata, const Frustum *culler )
    return itemsRendered;
 }
 
+U32 ForestCell::getRenderItems( const Frustum *culler, Vector<const ForestItem*> *outItems ) const
+{
+   PROFILE_SCOPE( ForestCell_getRenderItems );
+
+   AssertFatal( isLeaf(), "ForestCell::getRenderItems() - This shouldn't be called on non-leaf cells!" );
+
+   const U32 start = outItems->size();
+
+   Vector<ForestItem>::const_iterator item = mItems.begin();
+   for ( ; item != mItems.end(); item++ )
+   {
+      // Do we need to cull individual items?
+      if ( culler && culler->isCulled( item->getWorldBox() ) )
+         continue;
+
+      outItems->push_back( item );
+   }
+
+   return outItems->size() - start;
+}
+
 void ForestCell::_updateBounds()
 {   
    mIsDirty = false;
@@ -344,6 +365,72 @@ const ForestItem& ForestCell::insertItem( ForestItemKey key,
    return item;
 }
 
+void ForestCell::insertItems( ForestItem *items, U32 count )
+{
+   PROFILE_SCOPE( ForestCell_insertItems );
+
+   AssertFatal( isEmpty(), "ForestCell::insertItems() - The cell must be empty!" );
+
+   // Make sure we update the bounds later.
+   mIsDirty = true;
+
+   // insertItem() only splits a leaf once it holds more
+   // than MaxItems, so a leaf can end up with one extra.
+   if ( count <= MaxItems + 1 )
+   {
+      mItems.setSize( count );
+      for ( U32 i=0; i < count; i++ )
+         mItems[i] = items[i];
+
+      return;
+   }
+
+   // Add the children.
+   for ( U32 i=0; i < 4; i++ )
+      mSubCells[i] = new ForestCell( _makeChildRect( i ) );
+
+   // Do a stable partition of the items by child, so
+   // that each run stays sorted by key.
+   static Vector<U8> subCells;
+   subCells.setSize( count );
+
+   U32 starts[4] = { 0 };
+   for ( U32 i=0; i < count; i++ )
+   {
+      const Point3F pos = items[i].getPosition();
+      subCells[i] = _getSubCell( pos.x, pos.y );
+      starts[ subCells[i] ]++;
+   }
+
+   U32 counts[4];
+   for ( U32 i=0, start=0; i < 4; i++ )
+   {
+      counts[i] = starts[i];
+      starts[i] = start;
+      start += counts[i];
+   }
+
+   U32 offsets[4] = { starts[0], starts[1], starts[2], starts[3] };
+
+   Vector<ForestItem> sorted;
+   sorted.setSize( count );
+   for ( U32 i=0; i < count; i++ )
+      sorted[ offsets[ subCells[i] ]++ ] = items[i];
+
+   for ( U32 i=0; i < count; i++ )
+      items[i] = sorted[i];
+
+   sorted.clear();
+   sorted.compact();
+
+   // Now push the runs down to the children.
+   for ( U32 i=0; i < 4; i++ )
+   {
+      if ( counts[i] > 0 )
+         mSubCells[i]->insertItems( items + starts[i], counts[i] );
+   }
+}
+
 bool ForestCell::removeItem( ForestItemKey key, const Point3F &keyPos, bool deleteIfEmpty )
 {
    PROFILE_SCOPE( ForestCell_removeItem );
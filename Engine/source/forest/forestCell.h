@@ -165,6 +165,12 @@ public:
 
    S32 render( TSRenderState *rdata, const Frustum *culler );
 
+   /// Adds the items of this leaf cell which aren't culled to
+   /// the list, so they can be rendered grouped by type.
+   ///
+   /// @return The number of items added.
+   U32 getRenderItems( const Frustum *culler, Vector<const ForestItem*> *outItems ) const;
+
 
    /// The find function does a binary search thru the sorted
    /// item list.  If the key is found then the index is the 
@@ -187,6 +193,14 @@ public:
                                  const MatrixF &xfm,
                                  F32 scale );
 
+   /// Fills an empty cell with many items at once, splitting it up
+   /// front instead of pushing the items down as it fills up.  The
+   /// result is the same tree insertItem() would build.
+   ///
+   /// The items must be sorted by key and have their datablocks
+   /// preloaded.  They are reordered in the process.
+   void insertItems( ForestItem *items, U32 count );
+
    bool removeItem( ForestItemKey key, const Point3F &keyPos, bool deleteIfEmpty = false );
 
    /// Returns the child cell at the position.  The position is
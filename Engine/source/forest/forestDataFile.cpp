@@ -27,6 +27,8 @@
 #include "forest/forestCell.h"
 #include "T3D/physics/physicsBody.h"
 #include "core/stream/fileStream.h"
+#include "core/stream/memStream.h"
+#include "core/util/endian.h"
 #include "core/resource.h"
 #include "math/mathIO.h"
 #include "math/mPoint2.h"
@@ -41,13 +43,13 @@ template<> ResourceBase::Signature Resource<ForestData>::signature()
 template<>
 void* Resource<ForestData>::create( const Torque::Path &path )
 {
-   FileStream stream;
-   stream.open( path.getFullPath(), Torque::FS::File::Read );
-   if ( stream.getStatus() != Stream::Ok )
+   // Map the file so that flat files can be loaded in place.
+   Torque::FS::MappedFile mappedFile;
+   if ( !mappedFile.open( path ) )
       return NULL;
 
    ForestData *file = new ForestData();
-   if ( !file->read( stream ) )
+   if ( !file->read( mappedFile.getData(), mappedFile.getSize() ) )
    {
       delete file;
       return NULL;
@@ -60,7 +62,9 @@ void* Resource<ForestData>::create( const Torque::Path &path )
 U32 ForestData::smNextItemId = 1;
 
 ForestData::ForestData()
-   :  mIsDirty( false )
+   :  mIsDirty( false ),
+      mNumTopCellQuads( 0 ),
+      mCellQuadsDirty( true )
 {
    ForestItemData::getReloadSignal().notify( this, &ForestData::_onItemReload );
 }
@@ -81,6 +85,7 @@ void ForestData::clear()
    mBuckets.clear();
 
    mIsDirty = true;
+   mCellQuadsDirty = true;
 }
 
 bool ForestData::read( Stream &stream )
@@ -107,6 +112,21 @@ bool ForestData::read( Stream &stream )
       return false;
    }
 
+   // Flat files are read in one go and loaded from memory.
+   if ( version >= (U8)FILE_VERSION_FLAT )
+   {
+      const U32 size = stream.getStreamSize();
+      Vector<U8> buffer;
+      buffer.setSize( size );
+      if ( !stream.setPosition( 0 ) || !stream.read( size, buffer.address() ) )
+      {
+         Con::errorf( "ForestDataFile::read() - Failed reading the file!" );
+         return false;
+      }
+
+      return _readFlat( buffer.address(), size );
+   }
+
    // Read in the names of the ForestItemData datablocks
    // and recover the datablock.
    Vector<ForestItemData*> allDatablocks;
@@ -170,6 +190,193 @@ bool ForestData::read( Stream &stream )
    return true;
 }
 
+bool ForestData::read( const U8 *data, U32 size )
+{
+   if ( size < 5 )
+   {
+      Con::errorf( "ForestDataFile::read() - This is not a Forest planting file!" );
+      return false;
+   }
+
+   if (  size >= sizeof( FlatHeader ) &&
+         dMemcmp( data, "FKDF", 4 ) == 0 &&
+         data[4] >= (U8)FILE_VERSION_FLAT &&
+         data[4] <= (U8)FILE_VERSION )
+      return _readFlat( data, size );
+
+   // Older files are read thru a stream on the memory.
+   MemStream stream( size, const_cast<U8*>( data ), true, false );
+   return read( stream );
+}
+
+namespace {
+
+struct ItemBucket
+{
+   Point2I bucket;
+   U32 index;
+};
+
+S32 QSORT_CALLBACK cmpItemBucket( const void *p1, const void *p2 )
+{
+   const ItemBucket *b1 = (const ItemBucket*)p1;
+   const ItemBucket *b2 = (const ItemBucket*)p2;
+
+   if ( b1->bucket.x != b2->bucket.x )
+      return b1->bucket.x < b2->bucket.x ? -1 : 1;
+   if ( b1->bucket.y != b2->bucket.y )
+      return b1->bucket.y < b2->bucket.y ? -1 : 1;
+
+   // Keep the file order within a bucket.
+   return (S32)b1->index - (S32)b2->index;
+}
+
+} // namespace {}
+
+bool ForestData::_readFlat( const U8 *buffer, U32 size )
+{
+   PROFILE_SCOPE( ForestData_readFlat );
+
+   const FlatHeader *header = (const FlatHeader*)buffer;
+   if ( size < sizeof( FlatHeader ) || dMemcmp( header->id, "FKDF", 4 ) != 0 )
+   {
+      Con::errorf( "ForestDataFile::read() - This is not a Forest planting file!" );
+      return false;
+   }
+
+   const U32 itemCount = convertLEndianToHost( header->itemCount );
+   const U32 itemsOffset = convertLEndianToHost( header->itemsOffset );
+   const U32 datablockCount = convertLEndianToHost( header->datablockCount );
+   const U32 namesOffset = convertLEndianToHost( header->datablockNamesOffset );
+
+   // Validate the layout before we touch any of it.
+   if (  itemsOffset > size ||
+         ( itemsOffset & 3 ) != 0 ||
+         itemCount > ( size - itemsOffset ) / sizeof( FlatItem ) ||
+         namesOffset > size )
+   {
+      Con::errorf( "ForestDataFile::read() - The file is truncated or corrupt!" );
+      return false;
+   }
+
+   // Empty ourselves before we really begin reading.
+   clear();
+
+   // Recover the datablocks from their null terminated names.
+   Vector<ForestItemData*> allDatablocks;
+   allDatablocks.setSize( datablockCount );
+
+   const char *name = (const char*)( buffer + namesOffset );
+   const char *end = (const char*)( buffer + size );
+   for ( U32 i=0; i < datablockCount; i++ )
+   {
+      const char *nameEnd = name;
+      while ( nameEnd < end && *nameEnd )
+         nameEnd++;
+
+      if ( nameEnd == end )
+      {
+         Con::errorf( "ForestDataFile::read() - The file is truncated or corrupt!" );
+         return false;
+      }
+
+      ForestItemData* data = ForestItemData::find( name );
+      if ( data == NULL )
+      {
+         Con::warnf( "ForestData::read - ForestItemData named %s was not found.", name );
+         Con::warnf( "Note this can occur if you have deleted or renamed datablocks prior to loading this forest and is not an 'error' in this scenario." );
+      }
+      else
+      {
+         // The world boxes of the items need the shape.
+         data->preload();
+      }
+
+      allDatablocks[i] = data;
+      name = nameEnd + 1;
+   }
+
+   const FlatItem *flatItems = (const FlatItem*)( buffer + itemsOffset );
+
+   // Order the items by bucket so that each bucket
+   // can be filled with all its items at once.
+   Vector<ItemBucket> buckets;
+   buckets.reserve( itemCount );
+
+   U32 skippedItems = 0;
+
+   for ( U32 i=0; i < itemCount; i++ )
+   {
+      const FlatItem &flat = flatItems[i];
+
+      const U32 dataIndex = convertLEndianToHost( flat.dataIndex );
+      if ( dataIndex >= datablockCount || !allDatablocks[ dataIndex ] )
+      {
+         skippedItems++;
+         continue;
+      }
+
+      const Point3F pos(   convertLEndianToHost( flat.pos[0] ),
+                           convertLEndianToHost( flat.pos[1] ),
+                           convertLEndianToHost( flat.pos[2] ) );
+
+      buckets.increment();
+      buckets.last().bucket = _getBucketKey( pos );
+      buckets.last().index = i;
+   }
+
+   dQsort( buckets.address(), buckets.size(), sizeof( ItemBucket ), cmpItemBucket );
+
+   // Now create the items in bucket order.
+   Vector<ForestItem> items;
+   items.setSize( buckets.size() );
+
+   MatrixF xfm;
+
+   for ( U32 i=0; i < buckets.size(); i++ )
+   {
+      const FlatItem &flat = flatItems[ buckets[i].index ];
+
+      const Point3F pos(   convertLEndianToHost( flat.pos[0] ),
+                           convertLEndianToHost( flat.pos[1] ),
+                           convertLEndianToHost( flat.pos[2] ) );
+
+      const QuatF rot(  convertLEndianToHost( flat.rot[0] ),
+                        convertLEndianToHost( flat.rot[1] ),
+                        convertLEndianToHost( flat.rot[2] ),
+                        convertLEndianToHost( flat.rot[3] ) );
+
+      rot.setMatrix( &xfm );
+      xfm.setPosition( pos );
+
+      ForestItem &item = items[i];
+      item.setKey( smNextItemId++ );
+      item.setData( allDatablocks[ convertLEndianToHost( flat.dataIndex ) ] );
+      item.setTransform( xfm, convertLEndianToHost( flat.scale ) );
+   }
+
+   // Fill the buckets.
+   for ( U32 i=0; i < buckets.size(); )
+   {
+      U32 end = i + 1;
+      while ( end < buckets.size() && buckets[end].bucket == buckets[i].bucket )
+         end++;
+
+      ForestCell *bucket = _findOrCreateBucket( items[i].getPosition() );
+      bucket->insertItems( items.address() + i, end - i );
+
+      i = end;
+   }
+
+   if ( skippedItems > 0 )
+      Con::warnf( "ForestData::read - %i items were skipped because their datablocks were not found.", skippedItems );
+
+   // Clear the dirty flag.
+   mIsDirty = false;
+
+   return true;
+}
+
 bool ForestData::write( const char *path )
 {
    // Open the stream.
@@ -184,36 +391,36 @@ bool ForestData::write( const char *path )
    // idea if we're reading pure garbage.
    stream.write( 4, "FKDF" );
 
-   // Now the version number.
+   // Now the version number and the padding
+   // which aligns the rest of the header.
    stream.write( (U8)FILE_VERSION );
+   const U8 pad[3] = { 0 };
+   stream.write( 3, pad );
 
    // First gather all the ForestItemData datablocks
    // used by the items in the forest.
    Vector<ForestItemData*> allDatablocks;
    getDatablocks( &allDatablocks );
 
-   // Write out the datablock list.
-   U32 count = allDatablocks.size();
-   stream.write( count );
-   for ( U32 i=0; i < count; i++ )
-   {
-      StringTableEntry localName = allDatablocks[i]->getInternalName();
-      AssertFatal( localName != NULL && localName[0] != '\0', "ForestData::write - ForestItemData had no internal name set!" );
-      stream.writeString( allDatablocks[i]->getInternalName() );
-   }
-
    // Get a copy of all the items.
    Vector<ForestItem> items;
    getItems( &items );
 
-   // Save the item count.
+   // The items follow the header and the datablock names
+   // come last, so the items are aligned in memory.
+   const U32 itemsOffset = sizeof( FlatHeader );
+   const U32 namesOffset = itemsOffset + items.size() * sizeof( FlatItem );
+
    stream.write( (U32)items.size() );
+   stream.write( itemsOffset );
+   stream.write( (U32)allDatablocks.size() );
+   stream.write( namesOffset );
 
    // Save the items.
    Vector<ForestItem>::const_iterator iter = items.begin();
    for ( ; iter != items.end(); iter++ )
    {
-      U8 dataIndex = find( allDatablocks.begin(), allDatablocks.end(), iter->getData() ) - allDatablocks.begin();
+      U32 dataIndex = find( allDatablocks.begin(), allDatablocks.end(), iter->getData() ) - allDatablocks.begin();
 
       stream.write( dataIndex );
 
@@ -226,6 +433,14 @@ bool ForestData::write( const char *path )
       stream.write( iter->getScale() );
    }
 
+   // Write out the datablock names.
+   for ( U32 i=0; i < allDatablocks.size(); i++ )
+   {
+      StringTableEntry localName = allDatablocks[i]->getInternalName();
+      AssertFatal( localName != NULL && localName[0] != '\0', "ForestData::write - ForestItemData had no internal name set!" );
+      stream.write( dStrlen( localName ) + 1, localName );
+   }
+
    // Clear the dirty flag.
    mIsDirty = false;
 
@@ -300,6 +515,8 @@ void ForestData::_onItemReload()
 
       pCell->getChildren( &stack );
    }
+
+   mCellQuadsDirty = true;
 }
 
 const ForestItem& ForestData::addItem( ForestItemData *data,
@@ -324,6 +541,7 @@ const ForestItem& ForestData::addItem( ForestItemKey key,
    ForestCell *bucket = _findOrCreateBucket( xfm.getPosition() );
    
    mIsDirty = true;
+   mCellQuadsDirty = true;
 
    return bucket->insertItem( key, data, xfm, scale );
 }
@@ -341,6 +559,8 @@ const ForestItem& ForestData::updateItem( ForestItemKey key,
    if ( !bucket || !bucket->removeItem( key, keyPosition, true ) )
       return ForestItem::Invalid;
 
+   mCellQuadsDirty = true;
+
    if ( bucket->isEmpty() )
    {
       delete bucket;
@@ -375,6 +595,7 @@ bool ForestData::removeItem( ForestItemKey key, const Point3F &keyPosition )
    }      
 
    mIsDirty = true;
+   mCellQuadsDirty = true;
 
    return true;
 }
@@ -740,6 +961,75 @@ void ForestData::getCells( Vector<ForestCell*> *outCells ) const
       outCells->push_back( iter->value );
 }
 
+/// Fills the quad with up to four cells, leaving
+/// empty cells out of it.
+static void _fillCellQuad( ForestCellQuad &quad, ForestCell *const *cells, U32 count )
+{
+   for ( U32 i = 0; i < 4; i++ )
+   {
+      ForestCell *cell = i < count ? cells[i] : NULL;
+      if ( cell && cell->isEmpty() )
+         cell = NULL;
+
+      quad.cells[i] = cell;
+      quad.children[i] = -1;
+
+      // Empty slots get an inverted box which never overlaps.
+      const Box3F &bounds = cell ? cell->getBounds() : Box3F::Invalid;
+      quad.minX[i] = bounds.minExtents.x;
+      quad.minY[i] = bounds.minExtents.y;
+      quad.minZ[i] = bounds.minExtents.z;
+      quad.maxX[i] = bounds.maxExtents.x;
+      quad.maxY[i] = bounds.maxExtents.y;
+      quad.maxZ[i] = bounds.maxExtents.z;
+   }
+}
+
+void ForestData::_buildCellQuads()
+{
+   PROFILE_SCOPE( ForestData_buildCellQuads );
+
+   mCellQuadsDirty = false;
+   mCellQuads.clear();
+
+   Vector<ForestCell*> cells;
+   getCells( &cells );
+
+   mNumTopCellQuads = ( cells.size() + 3 ) / 4;
+   mCellQuads.setSize( mNumTopCellQuads );
+   for ( U32 i = 0; i < mNumTopCellQuads; i++ )
+      _fillCellQuad( mCellQuads[i], cells.address() + i * 4, cells.size() - i * 4 );
+
+   // Append the children of each branch, which makes
+   // the quads of each level of the tree contiguous.
+   for ( U32 q = 0; q < mCellQuads.size(); q++ )
+   {
+      for ( U32 i = 0; i < 4; i++ )
+      {
+         const ForestCell *cell = mCellQuads[q].cells[i];
+         if ( !cell || cell->isLeaf() )
+            continue;
+
+         cells.clear();
+         cell->getChildren( &cells );
+
+         const U32 childQuad = mCellQuads.size();
+         mCellQuads.increment();
+         _fillCellQuad( mCellQuads.last(), cells.address(), cells.size() );
+         mCellQuads[q].children[i] = childQuad;
+      }
+   }
+}
+
+const Vector<ForestCellQuad>& ForestData::getCellQuads( U32 *outNumTop )
+{
+   if ( mCellQuadsDirty )
+      _buildCellQuads();
+
+   *outNumTop = mNumTopCellQuads;
+   return mCellQuads;
+}
+
 U32 ForestData::getDatablocks( Vector<ForestItemData*> *outVector ) const
 {
    Vector<const ForestCell*> stack;
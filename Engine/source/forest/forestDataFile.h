@@ -35,12 +35,67 @@ class Forest;
 class Frustum;
 
 
+/// Four sibling cells with their bounds stored as arrays so
+/// that all four can be tested against a frustum at once.
+struct ForestCellQuad
+{
+   F32 minX[4];
+   F32 minY[4];
+   F32 minZ[4];
+   F32 maxX[4];
+   F32 maxY[4];
+   F32 maxZ[4];
+
+   /// The cells or NULL for empty slots.
+   ForestCell *cells[4];
+
+   /// The index of the quad holding the children
+   /// of each cell or -1 if it is a leaf.
+   S32 children[4];
+};
+
+
 /// This is the data file for Forests.
 class ForestData
 {
    protected:
 
-      enum { FILE_VERSION = 1 };
+      /// Version 1 files are read item by item from a stream.  Version 2
+      /// files store the items in a flat array which is read in place
+      /// from a memory mapped file.
+      enum 
+      {
+         FILE_VERSION_STREAM = 1,
+         FILE_VERSION_FLAT = 2,
+         FILE_VERSION = FILE_VERSION_FLAT
+      };
+
+      /// The header of the flat file format.  All values
+      /// are little endian and the items are 4 byte aligned.
+      struct FlatHeader
+      {
+         char id[4];
+         U8 version;
+         U8 pad[3];
+
+         U32 itemCount;
+         U32 itemsOffset;
+
+         U32 datablockCount;
+         U32 datablockNamesOffset;
+      };
+
+      /// An item of the flat file format.
+      struct FlatItem
+      {
+         U32 dataIndex;
+         F32 pos[3];
+         F32 rot[4];
+         F32 scale;
+      };
+
+      /// Loads a flat file from memory.
+      bool _readFlat( const U8 *data, U32 size );
 
       /// Set the bucket dimensions to 2km x 2km.
       static const U32 BUCKET_DIM = 2000;
@@ -59,6 +114,18 @@ class ForestData
       /// The next free item id.
       static U32 smNextItemId;
 
+      /// The cells flattened into quads of siblings for culling.
+      /// The top level cells are in the first mNumTopCellQuads.
+      Vector<ForestCellQuad> mCellQuads;
+
+      U32 mNumTopCellQuads;
+
+      /// Set when cells or items change so the
+      /// cell quads are rebuilt on the next request.
+      bool mCellQuadsDirty;
+
+      void _buildCellQuads();
+
       /// Converts a ForestItem's Point3F 'KeyPosition' to a Point2I
       /// key we index into BucketTable with.
       static Point2I _getBucketKey( const Point3F &pos );
@@ -91,9 +158,13 @@ class ForestData
       /// Helper for debugging cell generation.
       void regenCells();
 
-      ///
+      /// Reads either file version from the stream.
       bool read( Stream &stream );
 
+      /// Reads either file version from memory.  Flat files
+      /// are consumed in place without any stream reads.
+      bool read( const U8 *data, U32 size );
+
       ///
       bool write( const char *path );
 
@@ -186,6 +257,13 @@ class ForestData
 
       /// Returns all top level cells.
       void getCells( Vector<ForestCell*> *outCells ) const;
+
+      /// Returns the non-empty cells flattened into quads of siblings, the
+      /// quads of top level cells first, breadth first after that.
+      ///
+      /// @param outNumTop The number of quads of top level cells.
+      ///
+      const Vector<ForestCellQuad>& getCellQuads( U32 *outNumTop );
       
       /// Gathers all the datablocks used and returns the count.
       U32 getDatablocks( Vector<ForestItemData*> *outVector ) const;
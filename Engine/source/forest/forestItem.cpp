@@ -209,6 +209,18 @@ void ForestItemData::unpackData(BitStream* stream)
    stream->read( &mWindDetailFreq );
 }
 
+U32 ForestItemData::renderItems( TSRenderState *rdata, const ForestItem *const *items, U32 count ) const
+{
+   U32 itemsRendered = 0;
+   for ( U32 i = 0; i < count; i++ )
+   {
+      if ( render( rdata, *items[i] ) )
+         ++itemsRendered;
+   }
+
+   return itemsRendered;
+}
+
 const ForestItem ForestItem::Invalid;
 
 ForestItem::ForestItem()
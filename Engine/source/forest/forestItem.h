@@ -130,6 +130,12 @@ public:
 
    virtual bool render( TSRenderState *rdata, const ForestItem &item ) const { return false; }
 
+   /// Renders a group of visible items of this type.  The default
+   /// renders them one at a time.
+   ///
+   /// @return The number of items rendered.
+   virtual U32 renderItems( TSRenderState *rdata, const ForestItem *const *items, U32 count ) const;
+
    virtual bool canBillboard( const SceneRenderState *state, const ForestItem &item, F32 distToCamera ) const { return false; }
 
    virtual ForestCellBatch* allocateBatch() const { return NULL; }
@@ -39,6 +39,11 @@
 #include "gfx/gfxDrawUtil.h"
 #include "math/mathUtils.h"
 
+#if defined(TORQUE_CPU_X64) || defined(__SSE2__) || (defined(TORQUE_CPU_X86) && defined(_MSC_VER))
+#  define FOREST_SSE
+#  include <emmintrin.h>
+#endif
+
 
 U32   Forest::smTotalCells = 0;
 U32   Forest::smCellsRendered = 0;
@@ -46,6 +51,7 @@ U32   Forest::smCellItemsRendered = 0;
 U32   Forest::smCellsBatched = 0;
 U32   Forest::smCellItemsBatched = 0;
 F32   Forest::smAverageItemsPerCell = 0.0f;
+bool  Forest::smSIMDCulling = true;
 
 void Forest::_clearStats(bool beginFrame)
 {
@@ -61,6 +67,125 @@ void Forest::_clearStats(bool beginFrame)
    }
 }
 
+static U32 _cullCellQuadC( const ForestCellQuad &quad, const Frustum &culler, U32 *outPartial )
+{
+   const Box3F &cullerBounds = culler.getBounds();
+
+   U32 visible = 0;
+   U32 partial = 0;
+
+   for ( U32 i = 0; i < 4; i++ )
+   {
+      if ( !quad.cells[i] )
+         continue;
+
+      const Box3F bounds(  quad.minX[i], quad.minY[i], quad.minZ[i],
+                           quad.maxX[i], quad.maxY[i], quad.maxZ[i] );
+
+      if ( !cullerBounds.isOverlapped( bounds ) )
+         continue;
+
+      const U32 clipMask = culler.testPlanes( bounds, Frustum::PlaneMaskAll );
+      if ( clipMask == -1 )
+         continue;
+
+      visible |= 1 << i;
+      if ( clipMask != 0 )
+         partial |= 1 << i;
+   }
+
+   *outPartial = partial;
+   return visible;
+}
+
+#ifdef FOREST_SSE
+
+static U32 _cullCellQuadSSE( const ForestCellQuad &quad, const Frustum &culler, U32 *outPartial )
+{
+   const __m128 minX = _mm_loadu_ps( quad.minX );
+   const __m128 minY = _mm_loadu_ps( quad.minY );
+   const __m128 minZ = _mm_loadu_ps( quad.minZ );
+   const __m128 maxX = _mm_loadu_ps( quad.maxX );
+   const __m128 maxY = _mm_loadu_ps( quad.maxY );
+   const __m128 maxZ = _mm_loadu_ps( quad.maxZ );
+
+   // The cells outside of the frustum bounds.
+   const Box3F &cullerBounds = culler.getBounds();
+   __m128 outside = _mm_or_ps(   _mm_cmpgt_ps( minX, _mm_set1_ps( cullerBounds.maxExtents.x ) ),
+                                 _mm_cmplt_ps( maxX, _mm_set1_ps( cullerBounds.minExtents.x ) ) );
+   outside = _mm_or_ps( outside, _mm_cmpgt_ps( minY, _mm_set1_ps( cullerBounds.maxExtents.y ) ) );
+   outside = _mm_or_ps( outside, _mm_cmplt_ps( maxY, _mm_set1_ps( cullerBounds.minExtents.y ) ) );
+   outside = _mm_or_ps( outside, _mm_cmpgt_ps( minZ, _mm_set1_ps( cullerBounds.maxExtents.z ) ) );
+   outside = _mm_or_ps( outside, _mm_cmplt_ps( maxZ, _mm_set1_ps( cullerBounds.minExtents.z ) ) );
+
+   // Same math as PlaneSet::testPlanes() with the nearest and 
+   // farthest corners picked by the sign of the plane normal.
+   const __m128 zero = _mm_setzero_ps();
+   __m128 partial = zero;
+
+   const PlaneF *planes = culler.getPlanes();
+   for ( U32 i = 0; i < Frustum::PlaneCount; i++ )
+   {
+      const PlaneF &plane = planes[i];
+
+      const __m128 px = _mm_set1_ps( plane.x );
+      const __m128 py = _mm_set1_ps( plane.y );
+      const __m128 pz = _mm_set1_ps( plane.z );
+
+      const __m128 maxPx = plane.x > 0 ? maxX : minX;
+      const __m128 minPx = plane.x > 0 ? minX : maxX;
+      const __m128 maxPy = plane.y > 0 ? maxY : minY;
+      const __m128 minPy = plane.y > 0 ? minY : maxY;
+      const __m128 maxPz = plane.z > 0 ? maxZ : minZ;
+      const __m128 minPz = plane.z > 0 ? minZ : maxZ;
+
+      const __m128 maxDot = _mm_add_ps(   _mm_add_ps( _mm_mul_ps( maxPx, px ), _mm_mul_ps( maxPy, py ) ),
+                                          _mm_mul_ps( maxPz, pz ) );
+      outside = _mm_or_ps( outside, _mm_cmple_ps( maxDot, _mm_set1_ps( -plane.d ) ) );
+
+      const __m128 minDot = _mm_add_ps(   _mm_add_ps( _mm_mul_ps( minPx, px ), _mm_mul_ps( minPy, py ) ),
+                                          _mm_mul_ps( minPz, pz ) );
+      partial = _mm_or_ps( partial, _mm_cmplt_ps( _mm_add_ps( minDot, _mm_set1_ps( plane.d ) ), zero ) );
+   }
+
+   U32 visible = ~_mm_movemask_ps( outside ) & 0xF;
+   for ( U32 i = 0; i < 4; i++ )
+   {
+      if ( !quad.cells[i] )
+         visible &= ~( 1 << i );
+   }
+
+   *outPartial = _mm_movemask_ps( partial ) & visible;
+   return visible;
+}
+
+#endif // FOREST_SSE
+
+U32 Forest::cullCellQuad( const ForestCellQuad &quad, const Frustum &culler, U32 *outPartial )
+{
+#ifdef FOREST_SSE
+   if ( smSIMDCulling && ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE2 ) )
+      return _cullCellQuadSSE( quad, culler, outPartial );
+#endif
+
+   return _cullCellQuadC( quad, culler, outPartial );
+}
+
+namespace {
+
+S32 QSORT_CALLBACK cmpItemData( const void *p1, const void *p2 )
+{
+   const ForestItemData *d1 = (*(const ForestItem**)p1)->getData();
+   const ForestItemData *d2 = (*(const ForestItem**)p2)->getData();
+
+   if ( d1 == d2 )
+      return 0;
+
+   return d1 < d2 ? -1 : 1;
+}
+
+} // namespace {}
+
 void Forest::prepRenderImage( SceneRenderState *state )
 {
    PROFILE_SCOPE(Forest_RenderCells);
@@ -126,121 +251,143 @@ void Forest::prepRenderImage( SceneRenderState *state )
    drawer->clearBitmapModulation();
 
    // Go thru the visible cells.
-   const Box3F &cullerBounds = culler.getBounds();
    const Point3F &camPos = state->getDiffuseCameraPosition();
    
-   U32 clipMask;
    smAverageItemsPerCell = 0.0f;
    U32 cellsProcessed = 0;
-   ForestCell *cell;
-   
-   // First get all the top level cells which 
-   // intersect the frustum.
-   Vector<ForestCell*> cellStack;
-   mData->getCells( culler, &cellStack );
+
+   // The cells are flattened into quads of siblings which
+   // we can test against the frustum four at a time.
+   U32 numTopQuads;
+   const Vector<ForestCellQuad> &quads = mData->getCellQuads( &numTopQuads );
+
+   // Start with the quads of the top level cells.
+   static Vector<S32> quadStack;
+   quadStack.setSize( numTopQuads );
+   for ( U32 i=0; i < numTopQuads; i++ )
+      quadStack[i] = numTopQuads - 1 - i;
+
+   // The visible items of a leaf cell.
+   static Vector<const ForestItem*> renderItems;
 
    // Get the culling zone state.
    const BitVector &zoneState = state->getCullingState().getZoneVisibilityFlags();
 
    // Now loop till we run out of cells.
-   while ( !cellStack.empty() )
+   while ( !quadStack.empty() )
    {
-      // Pop off the next cell.
-      cell = cellStack.last();
-      cellStack.pop_back();
-
-      const Box3F &cellBounds = cell->getBounds();
-
-      // If the cell is empty or its bounds is outside the frustum
-      // bounds then we have nothing nothing more to do.
-      if ( cell->isEmpty() || !cullerBounds.isOverlapped( cellBounds ) )
+      // Pop off the next quad.
+      const ForestCellQuad &quad = quads[ quadStack.last() ];
+      quadStack.pop_back();
+
+      // Cull all four cells at once.
+      U32 partialMask;
+      const U32 visibleMask = cullCellQuad( quad, culler, &partialMask );
+      if ( visibleMask == 0 )
          continue;
 
-      // Can we cull this cell entirely?
-      clipMask = culler.testPlanes( cellBounds, Frustum::PlaneMaskAll );
-      if ( clipMask == -1 )
-         continue;
+      for ( U32 q=0; q < 4; q++ )
+      {
+         if ( !( visibleMask & ( 1 << q ) ) )
+            continue;
 
-      // Test cell visibility for interior zones.      
-      const bool visibleInside = !cell->getZoneOverlap().empty() ? zoneState.testAny( cell->getZoneOverlap() ) : false;
+         ForestCell *cell = quad.cells[q];
+         const Box3F &cellBounds = cell->getBounds();
+         const bool isPartial = ( partialMask & ( 1 << q ) ) != 0;
 
-      // Test cell visibility for outdoor zone, but only
-      // if we need to.
-      bool visibleOutside = false;
-      if( !cell->mIsInteriorOnly && !visibleInside )
-      {         
-         U32 outdoorZone = SceneZoneSpaceManager::RootZoneId;
-         visibleOutside = !state->getCullingState().isCulled( cellBounds, &outdoorZone, 1 );
-      }
+         // Test cell visibility for interior zones.      
+         const bool visibleInside = !cell->getZoneOverlap().empty() ? zoneState.testAny( cell->getZoneOverlap() ) : false;
 
-      // Skip cell if neither visible indoors nor outdoors.
-      if( !visibleInside && !visibleOutside )
-         continue;
+         // Test cell visibility for outdoor zone, but only
+         // if we need to.
+         bool visibleOutside = false;
+         if( !cell->mIsInteriorOnly && !visibleInside )
+         {         
+            U32 outdoorZone = SceneZoneSpaceManager::RootZoneId;
+            visibleOutside = !state->getCullingState().isCulled( cellBounds, &outdoorZone, 1 );
+         }
 
-      // Update the stats.
-      smAverageItemsPerCell += cell->getItems().size();
-      ++cellsProcessed;
-      //if ( cell->isLeaf() )
-         //++leafCellsProcessed;
-
-      // Get the distance from the camera to the cell bounds.
-      F32 dist = cellBounds.getDistanceToPoint( camPos );
-
-      // If the largest item in the cell can be billboarded
-      // at the cell distance to the camera... then the whole
-      // cell can be billboarded.
-      //
-      if (  smForceImposters || 
-            ( dist > 0.0f && cell->getLargestItem().canBillboard( state, dist ) ) )
-      {
-         // If imposters are disabled then skip out.
-         if ( smDisableImposters )
+         // Skip cell if neither visible indoors nor outdoors.
+         if( !visibleInside && !visibleOutside )
             continue;
 
-         PROFILE_SCOPE(Forest_RenderBatches);
+         // Update the stats.
+         smAverageItemsPerCell += cell->getItems().size();
+         ++cellsProcessed;
 
-         // Keep track of how many cells were batched.
-         ++smCellsBatched;
+         // Get the distance from the camera to the cell bounds.
+         F32 dist = cellBounds.getDistanceToPoint( camPos );
 
-         // Ok... everything in this cell should be batched.  First
-         // create the batches if we don't have any.
-         if ( !cell->hasBatches() )
-            cell->buildBatches();
+         // If the largest item in the cell can be billboarded
+         // at the cell distance to the camera... then the whole
+         // cell can be billboarded.
+         //
+         if (  smForceImposters || 
+               ( dist > 0.0f && cell->getLargestItem().canBillboard( state, dist ) ) )
+         {
+            // If imposters are disabled then skip out.
+            if ( smDisableImposters )
+               continue;
 
-         //if ( drawCells )
-            //mCellRenderFlag[ cellIter - theCells.begin() ] = 1;
+            PROFILE_SCOPE(Forest_RenderBatches);
 
-         // TODO: Light queries for batches?
+            // Keep track of how many cells were batched.
+            ++smCellsBatched;
 
-         // Now render the batches... we pass the culler if the
-         // cell wasn't fully visible so that each batch can be culled.
-         smCellItemsBatched += cell->renderBatches( state, clipMask != 0 ? &culler : NULL );
-         continue;
-      }
+            // Ok... everything in this cell should be batched.  First
+            // create the batches if we don't have any.
+            if ( !cell->hasBatches() )
+               cell->buildBatches();
 
-      // If this isn't a leaf then recurse.
-      if ( !cell->isLeaf() )
-      {
-         cell->getChildren( &cellStack );
-         continue;
-      }
+            // TODO: Light queries for batches?
 
-      // This cell has mixed billboards and mesh based items.
-      ++smCellsRendered;
+            // Now render the batches... we pass the culler if the
+            // cell wasn't fully visible so that each batch can be culled.
+            smCellItemsBatched += cell->renderBatches( state, isPartial ? &culler : NULL );
+            continue;
+         }
 
-      PROFILE_SCOPE(Forest_RenderItems);
+         // If this isn't a leaf then recurse.
+         if ( !cell->isLeaf() )
+         {
+            quadStack.push_back( quad.children[q] );
+            continue;
+         }
+
+         // This cell has mixed billboards and mesh based items.
+         ++smCellsRendered;
+
+         // This cell is visible... gather its items.
+         renderItems.clear();
+         if ( !cell->getRenderItems( isPartial ? &culler : NULL, &renderItems ) )
+            continue;
 
-      //if ( drawCells )
-         //mCellRenderFlag[ cellIter - theCells.begin() ] = 2;
+         PROFILE_SCOPE(Forest_RenderItems);
 
-      // Use the cell bounds as the light query volume.
-      //
-      // This means all forward lit items in this cell will 
-      // get the same lights, but it performs much better.
-      lightQuery.init( cellBounds );
+         // Use the cell bounds as the light query volume.
+         //
+         // This means all forward lit items in the cell will
+         // get the same lights, but it performs much better.
+         lightQuery.init( cellBounds );
 
-      // This cell is visible... have it render its items.
-      smCellItemsRendered += cell->render( &rdata, clipMask != 0 ? &culler : NULL );
+         // Render the items grouped by type, which lets the
+         // datablock select the details and animate the shape
+         // once per detail level and keeps identical meshes
+         // together for instancing.
+         dQsort( renderItems.address(), renderItems.size(), sizeof( const ForestItem* ), cmpItemData );
+
+         for ( U32 i=0; i < renderItems.size(); )
+         {
+            ForestItemData *data = renderItems[i]->getData();
+
+            U32 end = i + 1;
+            while ( end < renderItems.size() && renderItems[end]->getData() == data )
+               end++;
+
+            smCellItemsRendered += data->renderItems( &rdata, renderItems.address() + i, end - i );
+            i = end;
+         }
+      }
    }
 
    // Keep track of the average items per cell.
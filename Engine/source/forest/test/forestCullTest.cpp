@@ -0,0 +1,202 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "forest/forest.h"
+
+/// Random cell quads and frustums for comparing the culling
+/// paths of Forest::cullCellQuad() to Frustum::testPlanes().
+FIXTURE(ForestCull)
+{
+public:
+   MRandomLCG rand;
+   bool savedSIMDCulling;
+
+   void SetUp()
+   {
+      savedSIMDCulling = Forest::smSIMDCulling;
+      rand.setSeed( 4321 );
+   }
+
+   void TearDown()
+   {
+      Forest::smSIMDCulling = savedSIMDCulling;
+   }
+
+   /// The culling only tests the cell pointers against NULL, so
+   /// any non-NULL value will do as a stand-in for a cell.
+   static ForestCell* fakeCell( U32 i ) { return reinterpret_cast<ForestCell*>( (uintptr_t)( i + 1 ) * 16 ); }
+
+   void randomQuad( ForestCellQuad &quad )
+   {
+      for ( U32 i = 0; i < 4; i++ )
+      {
+         const Point3F center( rand.randF( -500.0f, 500.0f ), rand.randF( -500.0f, 500.0f ), rand.randF( -50.0f, 50.0f ) );
+         const Point3F half( rand.randF( 1.0f, 64.0f ), rand.randF( 1.0f, 64.0f ), rand.randF( 1.0f, 32.0f ) );
+
+         quad.minX[i] = center.x - half.x;
+         quad.minY[i] = center.y - half.y;
+         quad.minZ[i] = center.z - half.z;
+         quad.maxX[i] = center.x + half.x;
+         quad.maxY[i] = center.y + half.y;
+         quad.maxZ[i] = center.z + half.z;
+
+         quad.cells[i] = rand.randI( 0, 7 ) == 0 ? NULL : fakeCell( i );
+         quad.children[i] = -1;
+      }
+   }
+
+   void randomFrustum( Frustum &frustum )
+   {
+      const EulerF rot( rand.randF( -0.5f, 0.5f ), 0.0f, rand.randF( -M_PI_F, M_PI_F ) );
+      const Point3F pos( rand.randF( -400.0f, 400.0f ), rand.randF( -400.0f, 400.0f ), rand.randF( 0.0f, 20.0f ) );
+      frustum.set( false, rand.randF( 0.5f, 1.5f ), rand.randF( 1.0f, 2.0f ), 0.1f, rand.randF( 100.0f, 1000.0f ), MatrixF( rot, pos ) );
+   }
+
+   /// The result of culling each cell on its own like the forest used to.
+   static U32 cullReference( const ForestCellQuad &quad, const Frustum &culler, U32 *outPartial )
+   {
+      U32 visible = 0;
+      *outPartial = 0;
+
+      for ( U32 i = 0; i < 4; i++ )
+      {
+         if ( !quad.cells[i] )
+            continue;
+
+         const Box3F bounds( quad.minX[i], quad.minY[i], quad.minZ[i], quad.maxX[i], quad.maxY[i], quad.maxZ[i] );
+         if ( !culler.getBounds().isOverlapped( bounds ) )
+            continue;
+
+         const U32 clipMask = culler.testPlanes( bounds, Frustum::PlaneMaskAll );
+         if ( clipMask == -1 )
+            continue;
+
+         visible |= 1 << i;
+         if ( clipMask != 0 )
+            *outPartial |= 1 << i;
+      }
+
+      return visible;
+   }
+
+   static void setCell( ForestCellQuad &quad, U32 i, const Box3F &box, bool hasCell )
+   {
+      quad.minX[i] = box.minExtents.x;
+      quad.minY[i] = box.minExtents.y;
+      quad.minZ[i] = box.minExtents.z;
+      quad.maxX[i] = box.maxExtents.x;
+      quad.maxY[i] = box.maxExtents.y;
+      quad.maxZ[i] = box.maxExtents.z;
+      quad.cells[i] = hasCell ? fakeCell( i ) : NULL;
+      quad.children[i] = -1;
+   }
+};
+
+TEST_FIX(ForestCull, FlagsInsideStraddlingAndOutsideCells)
+{
+   // A 90 degree frustum looking down +Y from the origin.
+   Frustum frustum;
+   frustum.set( false, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 100.0f );
+
+   ForestCellQuad quad;
+   setCell( quad, 0, Box3F( -5.0f, 45.0f, -5.0f, 5.0f, 55.0f, 5.0f ), true );
+   setCell( quad, 1, Box3F( 40.0f, 48.0f, -1.0f, 60.0f, 52.0f, 1.0f ), true );
+   setCell( quad, 2, Box3F( -5.0f, -20.0f, -5.0f, 5.0f, -10.0f, 5.0f ), true );
+
+   // An empty slot of a quad is never visible, wherever its bounds are.
+   setCell( quad, 3, Box3F( -5.0f, 45.0f, -5.0f, 5.0f, 55.0f, 5.0f ), false );
+
+   for ( U32 p = 0; p < 2; p++ )
+   {
+      Forest::smSIMDCulling = ( p != 0 );
+
+      U32 partial;
+      EXPECT_EQ( 0x3, Forest::cullCellQuad( quad, frustum, &partial ) ) << ( p ? "SIMD" : "C" );
+
+      // Only the straddling cell needs its items culled.
+      EXPECT_EQ( 0x2, partial ) << ( p ? "SIMD" : "C" );
+   }
+}
+
+TEST_FIX(ForestCull, RandomQuadsCullLikeSingleCells)
+{
+   U32 numVisible = 0;
+   U32 numPartial = 0;
+
+   for ( U32 f = 0; f < 50; f++ )
+   {
+      Frustum frustum;
+      randomFrustum( frustum );
+
+      for ( U32 q = 0; q < 500; q++ )
+      {
+         ForestCellQuad quad;
+         randomQuad( quad );
+
+         U32 refPartial;
+         const U32 refVisible = cullReference( quad, frustum, &refPartial );
+
+         for ( U32 p = 0; p < 2; p++ )
+         {
+            Forest::smSIMDCulling = ( p != 0 );
+
+            U32 partial;
+            const U32 visible = Forest::cullCellQuad( quad, frustum, &partial );
+            EXPECT_EQ( refVisible, visible ) << ( p ? "SIMD" : "C" ) << " frustum " << f << " quad " << q;
+            EXPECT_EQ( refPartial, partial ) << ( p ? "SIMD" : "C" ) << " frustum " << f << " quad " << q;
+         }
+
+         numVisible += refVisible ? 1 : 0;
+         numPartial += refPartial ? 1 : 0;
+      }
+   }
+
+   // Make sure the random test cases weren't all trivially culled.
+   EXPECT_GT( numVisible, 0 );
+   EXPECT_GT( numPartial, 0 );
+}
+
+/// Times culling the cells of a 500k tree forest, about four
+/// trees to a cell, from a hundred camera positions.
+TEST_FIX(ForestCull, LargeForestCullTime)
+{
+   const U32 numQuads = 32 * 1024;
+   const U32 numFrustums = 100;
+
+   Vector<ForestCellQuad> quads;
+   quads.setSize( numQuads );
+   for ( U32 i = 0; i < numQuads; i++ )
+      randomQuad( quads[i] );
+
+   Vector<Frustum> frustums;
+   frustums.setSize( numFrustums );
+   for ( U32 i = 0; i < numFrustums; i++ )
+      randomFrustum( frustums[i] );
+
+   U32 numVisible[2];
+   for ( U32 p = 0; p < 2; p++ )
+   {
+      Forest::smSIMDCulling = ( p != 0 );
+
+      numVisible[p] = 0;
+      const U32 start = Platform::getRealMilliseconds();
+      for ( U32 f = 0; f < numFrustums; f++ )
+      {
+         for ( U32 i = 0; i < numQuads; i++ )
+         {
+            U32 partial;
+            numVisible[p] += Forest::cullCellQuad( quads[i], frustums[f], &partial ) ? 1 : 0;
+         }
+      }
+      const U32 time = Platform::getRealMilliseconds() - start;
+
+      Con::printf( "ForestCull %u cells x %u frustums: %s %ums (%u visible quads)",
+         numQuads * 4, numFrustums, p ? "SIMD" : "C", time, numVisible[p] );
+   }
+
+   EXPECT_EQ( numVisible[0], numVisible[1] );
+}
+
+#endif
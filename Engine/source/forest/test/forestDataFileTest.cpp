@@ -0,0 +1,232 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "math/mathIO.h"
+#include "core/volume.h"
+#include "core/stream/memStream.h"
+#include "forest/forestDataFile.h"
+#include "forest/ts/tsForestItemData.h"
+
+/// Forests spread over several 2km buckets, saved in the flat
+/// format or written by hand in the old stream format.
+FIXTURE(ForestDataFile)
+{
+public:
+   MRandomLCG rand;
+   Vector<ForestItemData*> datablocks;
+   String path;
+
+   void SetUp()
+   {
+      rand.setSeed( 2468 );
+      path = "forestDataFileTest.forest";
+
+      // The items don't need a shape to be saved and loaded.
+      for ( U32 i = 0; i < 3; i++ )
+      {
+         const String name = String::ToString( "ForestDataFileTestItem%d", i );
+         ForestItemData *data = new TSForestItemData;
+         data->setInternalName( name );
+         ASSERT_TRUE( data->registerObject( name ) );
+         datablocks.push_back( data );
+      }
+   }
+
+   void TearDown()
+   {
+      for ( U32 i = 0; i < datablocks.size(); i++ )
+         datablocks[i]->deleteObject();
+      datablocks.clear();
+      dFileDelete( path );
+   }
+
+   void addItems( ForestData &forest, U32 count )
+   {
+      for ( U32 i = 0; i < count; i++ )
+      {
+         const Point3F pos( rand.randF( -5000.0f, 5000.0f ), rand.randF( -5000.0f, 5000.0f ), rand.randF( 0.0f, 100.0f ) );
+         forest.addItem( datablocks[ rand.randI( 0, datablocks.size() - 1 ) ], pos, rand.randF( 0.0f, M_2PI_F ), rand.randF( 0.5f, 2.0f ) );
+      }
+   }
+
+   /// Writes the items like version 1 files were written.
+   void writeStreamVersion( const ForestData &forest, Vector<U8> &outData )
+   {
+      Vector<ForestItem> items;
+      forest.getItems( &items );
+
+      outData.setSize( 64 + items.size() * 64 );
+      MemStream stream( outData.size(), outData.address(), false, true );
+
+      stream.write( 4, "FKDF" );
+      stream.write( (U8)1 );
+
+      stream.write( (U32)datablocks.size() );
+      for ( U32 i = 0; i < datablocks.size(); i++ )
+         stream.writeString( datablocks[i]->getInternalName() );
+
+      stream.write( (U32)items.size() );
+      for ( U32 i = 0; i < items.size(); i++ )
+      {
+         const U8 dataIndex = find( datablocks.begin(), datablocks.end(), items[i].getData() ) - datablocks.begin();
+         stream.write( dataIndex );
+         mathWrite( stream, items[i].getPosition() );
+
+         QuatF quat;
+         quat.set( items[i].getTransform() );
+         mathWrite( stream, quat );
+
+         stream.write( items[i].getScale() );
+      }
+
+      outData.setSize( stream.getPosition() );
+   }
+
+   static S32 QSORT_CALLBACK cmpItemPos( const void *a, const void *b )
+   {
+      const Point3F pa = ((const ForestItem*)a)->getPosition();
+      const Point3F pb = ((const ForestItem*)b)->getPosition();
+      if ( pa.x != pb.x )
+         return pa.x < pb.x ? -1 : 1;
+      if ( pa.y != pb.y )
+         return pa.y < pb.y ? -1 : 1;
+      return 0;
+   }
+
+   /// The keys are reassigned on load, so the items
+   /// are matched up by their positions.
+   void expectSameItems( const ForestData &a, const ForestData &b )
+   {
+      Vector<ForestItem> itemsA, itemsB;
+      a.getItems( &itemsA );
+      b.getItems( &itemsB );
+      ASSERT_EQ( itemsA.size(), itemsB.size() );
+
+      dQsort( itemsA.address(), itemsA.size(), sizeof( ForestItem ), cmpItemPos );
+      dQsort( itemsB.address(), itemsB.size(), sizeof( ForestItem ), cmpItemPos );
+
+      for ( U32 i = 0; i < itemsA.size(); i++ )
+      {
+         ASSERT_TRUE( itemsA[i].getData() == itemsB[i].getData() ) << "Item " << i;
+         ASSERT_TRUE( itemsA[i].getPosition() == itemsB[i].getPosition() ) << "Item " << i;
+         ASSERT_FLOAT_EQ( itemsA[i].getScale(), itemsB[i].getScale() ) << "Item " << i;
+
+         const MatrixF &xfmA = itemsA[i].getTransform();
+         const MatrixF &xfmB = itemsB[i].getTransform();
+         for ( U32 j = 0; j < 16; j++ )
+            ASSERT_NEAR( xfmA[j], xfmB[j], 0.0001f ) << "Item " << i << " transform";
+      }
+   }
+
+   /// Returns the number of items found in a box around
+   /// each item, which walks the cells built on load.
+   U32 countFound( const ForestData &forest )
+   {
+      Vector<ForestItem> items;
+      forest.getItems( &items );
+
+      U32 found = 0;
+      for ( U32 i = 0; i < items.size(); i++ )
+      {
+         const Point3F pos = items[i].getPosition();
+         found += forest.getItems( Box3F( pos - Point3F::One, pos + Point3F::One ), NULL );
+      }
+
+      return found;
+   }
+};
+
+TEST_FIX(ForestDataFile, FlatRoundTrip)
+{
+   ForestData source;
+   addItems( source, 5000 );
+   ASSERT_TRUE( source.write( path ) );
+
+   // Loaded in place from the mapped file.
+   Torque::FS::MappedFile file;
+   ASSERT_TRUE( file.open( path ) );
+   EXPECT_EQ( 2, file.getData()[4] ) << "Not saved as a version 2 file.";
+
+   ForestData loaded;
+   ASSERT_TRUE( loaded.read( file.getData(), file.getSize() ) );
+   EXPECT_FALSE( loaded.isDirty() );
+   expectSameItems( source, loaded );
+
+   // The cells built in bulk find every item.
+   EXPECT_EQ( 5000, countFound( loaded ) );
+
+   // What was loaded saves and loads again.
+   const String path2 = "forestDataFileTest2.forest";
+   ASSERT_TRUE( loaded.write( path2 ) );
+   ForestData reloaded;
+   Torque::FS::MappedFile file2;
+   ASSERT_TRUE( file2.open( path2 ) );
+   ASSERT_TRUE( reloaded.read( file2.getData(), file2.getSize() ) );
+   file2.close();
+   dFileDelete( path2 );
+   expectSameItems( source, reloaded );
+}
+
+TEST_FIX(ForestDataFile, ReadsStreamVersion)
+{
+   ForestData source;
+   addItems( source, 2000 );
+
+   Vector<U8> data;
+   writeStreamVersion( source, data );
+   ASSERT_EQ( 1, data[4] );
+
+   ForestData loaded;
+   ASSERT_TRUE( loaded.read( data.address(), data.size() ) );
+   expectSameItems( source, loaded );
+   EXPECT_EQ( 2000, countFound( loaded ) );
+}
+
+TEST_FIX(ForestDataFile, RejectsTruncatedFlatFile)
+{
+   ForestData source;
+   addItems( source, 100 );
+   ASSERT_TRUE( source.write( path ) );
+
+   Torque::FS::MappedFile file;
+   ASSERT_TRUE( file.open( path ) );
+
+   ForestData loaded;
+   EXPECT_FALSE( loaded.read( file.getData(), file.getSize() / 2 ) );
+   EXPECT_FALSE( loaded.read( file.getData(), 8 ) );
+}
+
+/// Times the forest part of a mission load for both file versions.
+TEST_FIX(ForestDataFile, MissionLoadTime)
+{
+   ForestData source;
+   addItems( source, 200000 );
+   ASSERT_TRUE( source.write( path ) );
+
+   Vector<U8> streamData;
+   writeStreamVersion( source, streamData );
+
+   U32 start = Platform::getRealMilliseconds();
+   ForestData *streamLoaded = new ForestData;
+   ASSERT_TRUE( streamLoaded->read( streamData.address(), streamData.size() ) );
+   const U32 streamTime = Platform::getRealMilliseconds() - start;
+
+   start = Platform::getRealMilliseconds();
+   Torque::FS::MappedFile file;
+   ASSERT_TRUE( file.open( path ) );
+   ForestData *flatLoaded = new ForestData;
+   ASSERT_TRUE( flatLoaded->read( file.getData(), file.getSize() ) );
+   const bool mapped = file.isMapped();
+   file.close();
+   const U32 flatTime = Platform::getRealMilliseconds() - start;
+
+   Con::printf( "ForestData load of 200000 items: version 1 %ums, version 2 %ums (%s)",
+      streamTime, flatTime, mapped ? "mapped" : "read" );
+
+   delete streamLoaded;
+   delete flatLoaded;
+}
+
+#endif
@@ -250,4 +250,84 @@ bool TSForestItemData::render( TSRenderState *rdata, const ForestItem &item ) co
    shapeInst->animate();
    shapeInst->render( *rdata );
    return true;
+}
+
+namespace {
+
+struct ItemDetail
+{
+   const ForestItem *item;
+   S32 detail;
+   F32 intraDetail;
+};
+
+S32 QSORT_CALLBACK cmpItemDetail( const void *p1, const void *p2 )
+{
+   const ItemDetail *d1 = (const ItemDetail*)p1;
+   const ItemDetail *d2 = (const ItemDetail*)p2;
+
+   return d1->detail - d2->detail;
+}
+
+} // namespace {}
+
+U32 TSForestItemData::renderItems( TSRenderState *rdata, const ForestItem *const *items, U32 count ) const
+{
+   PROFILE_SCOPE( TSForestItemData_renderItems );
+
+   TSShapeInstance *shapeInst = _getShapeInstance();
+   if ( !shapeInst )
+      return 0;
+
+   const SceneRenderState *state = rdata->getSceneState();
+   const Point3F &camPos = state->getDiffuseCameraPosition();
+
+   // Select the detail level of all the items first.
+   static Vector<ItemDetail> details;
+   details.clear();
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const ForestItem &item = *items[i];
+      const F32 dist = ( item.getPosition() - camPos ).len();
+      const S32 dl = shapeInst->setDetailFromDistance( state, dist / item.getScale() );
+      if ( dl < 0 )
+         continue;
+
+      details.increment();
+      ItemDetail &detail = details.last();
+      detail.item = &item;
+      detail.detail = dl;
+      detail.intraDetail = shapeInst->getCurrentIntraDetail();
+   }
+
+   // Then render them a detail level at a time.  The shape is only
+   // animated once per detail and the meshes of each detail level are
+   // submitted back to back, which lets the mesh bin instance them.
+   dQsort( details.address(), details.size(), sizeof( ItemDetail ), cmpItemDetail );
+
+   S32 lastDetail = -1;
+   for ( U32 i = 0; i < details.size(); i++ )
+   {
+      const ItemDetail &detail = details[i];
+      const ForestItem &item = *detail.item;
+
+      shapeInst->setCurrentDetail( detail.detail, detail.intraDetail );
+      if ( detail.detail != lastDetail )
+      {
+         shapeInst->animate();
+         lastDetail = detail.detail;
+      }
+
+      // TSShapeInstance::render() uses the 
+      // world matrix for the RenderInst.
+      MatrixF worldMat = item.getTransform();
+      worldMat.scale( item.getScale() );
+      GFX->setWorldMatrix( worldMat );
+      rdata->setMaterialHint( (void*)&item );
+
+      shapeInst->render( *rdata );
+   }
+
+   return details.size();
 }
\ No newline at end of file
@@ -90,6 +90,7 @@ public:
    // ForestItemData
    const Box3F& getObjBox() const { return mShape ? mShape->bounds : Box3F::Zero; }
    bool render( TSRenderState *rdata, const ForestItem& item ) const;
+   U32 renderItems( TSRenderState *rdata, const ForestItem *const *items, U32 count ) const;
    ForestCellBatch* allocateBatch() const;
    bool canBillboard( const SceneRenderState *state, const ForestItem &item, F32 distToCamera ) const;
    bool buildPolyList( const ForestItem& item, AbstractPolyList *polyList, const Box3F *box ) const { return false; }
@@ -649,7 +649,11 @@ void GFXD3D9Device::drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U
 
    mDeviceStatistics.mDrawCalls++;
    if ( mVertexBufferFrequency[0] > 1 )
+   {
       mDeviceStatistics.mPolyCount += primitiveCount * mVertexBufferFrequency[0];
+      mDeviceStatistics.mInstancedDrawCalls++;
+      mDeviceStatistics.mInstances += mVertexBufferFrequency[0];
+   }
    else
       mDeviceStatistics.mPolyCount += primitiveCount;
 }
@@ -683,7 +687,11 @@ void GFXD3D9Device::drawIndexedPrimitive( GFXPrimitiveType primType,
 
    mDeviceStatistics.mDrawCalls++;
    if ( mVertexBufferFrequency[0] > 1 )
+   {
       mDeviceStatistics.mPolyCount += primitiveCount * mVertexBufferFrequency[0];
+      mDeviceStatistics.mInstancedDrawCalls++;
+      mDeviceStatistics.mInstances += mVertexBufferFrequency[0];
+   }
    else
       mDeviceStatistics.mPolyCount += primitiveCount;
 }
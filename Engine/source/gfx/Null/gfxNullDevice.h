@@ -152,13 +152,13 @@ public:
    virtual bool beginSceneInternal() { return true; };
    virtual void endSceneInternal() { };
 
-   virtual void drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount ) { };
+   virtual void drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount ) { _countDraw( primitiveCount ); };
    virtual void drawIndexedPrimitive(  GFXPrimitiveType primType, 
                                        U32 startVertex, 
                                        U32 minIndex, 
                                        U32 numVerts, 
                                        U32 startIndex, 
-                                       U32 primitiveCount ) { };
+                                       U32 primitiveCount ) { _countDraw( primitiveCount ); };
 
    virtual void setClipRect( const RectI &rect ) { };
    virtual const RectI &getClipRect() const { return clip; };
@@ -180,6 +180,21 @@ public:
 private:
    typedef GFXDevice Parent;
    RectI clip;
+
+   /// Nothing is drawn, but the statistics are kept so
+   /// draw call counts can be checked without a card.
+   void _countDraw( U32 primitiveCount )
+   {
+      mDeviceStatistics.mDrawCalls++;
+      if ( mVertexBufferFrequency[0] > 1 )
+      {
+         mDeviceStatistics.mPolyCount += primitiveCount * mVertexBufferFrequency[0];
+         mDeviceStatistics.mInstancedDrawCalls++;
+         mDeviceStatistics.mInstances += mVertexBufferFrequency[0];
+      }
+      else
+         mDeviceStatistics.mPolyCount += primitiveCount;
+   }
 };
 
 #endif
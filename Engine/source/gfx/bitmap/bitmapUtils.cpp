@@ -23,6 +23,12 @@
 #include "gfx/bitmap/bitmapUtils.h"
 
 #include "platform/platform.h"
+#include "core/module.h"
+#include "math/mMathFn.h"
+
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+#include <emmintrin.h>
+#endif
 
 
 void bitmapExtrude5551_c(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
@@ -174,6 +180,127 @@ void bitmapExtrudeRGBA_c(const void *srcMip, void *mip, U32 srcHeight, U32 srcWi
    }
 }
 
+//--------------------------------------------------------------------------
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+
+// Computes the same rounded 2x2 average as bitmapExtrudeRGBA_c two
+// destination pixels at a time, so the results are identical.
+void bitmapExtrudeRGBA_SSE2(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   // The single row and column cases are rare and tiny.
+   if (srcWidth < 4 || srcHeight == 1)
+   {
+      bitmapExtrudeRGBA_c(srcMip, mip, srcHeight, srcWidth);
+      return;
+   }
+
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+   const U32 stride = srcWidth * 4;
+   const U32 width  = srcWidth  >> 1;
+   const U32 height = srcHeight >> 1;
+
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i round = _mm_set1_epi16(2);
+
+   for(U32 y = 0; y < height; y++)
+   {
+      const U8 *row0 = src + y * 2 * stride;
+      const U8 *row1 = row0 + stride;
+
+      U32 x = 0;
+      for(; x + 2 <= width; x += 2)
+      {
+         const __m128i a = _mm_loadu_si128((const __m128i *)(row0 + x * 8));
+         const __m128i b = _mm_loadu_si128((const __m128i *)(row1 + x * 8));
+
+         // Sum the rows as 16 bit, then the neighbouring pixels.
+         const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+         const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+         __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+
+         sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+         _mm_storel_epi64((__m128i *)(dst + x * 4), _mm_packus_epi16(sum, sum));
+      }
+
+      for(; x < width; x++)
+      {
+         const U8 *s = row0 + x * 8;
+         for(U32 c = 0; c < 4; c++)
+            dst[x * 4 + c] = (U32(s[c]) + U32(s[c + 4]) + U32(s[stride + c]) + U32(s[stride + c + 4]) + 2) >> 2;
+      }
+
+      dst += width * 4;
+   }
+}
+
+#endif
+
+//--------------------------------------------------------------------------
+
+// sRGB to linear for each byte value, and the linear values
+// half way between neighbouring bytes for the way back.
+static F32 sSRGBToLinear[256];
+static F32 sLinearToSRGBEdge[255];
+
+static void initSRGBTables()
+{
+   for(U32 i = 0; i < 256; i++)
+   {
+      const F32 c = i / 255.0f;
+      sSRGBToLinear[i] = c <= 0.04045f ? c / 12.92f : mPow((c + 0.055f) / 1.055f, 2.4f);
+   }
+
+   for(U32 i = 0; i < 255; i++)
+      sLinearToSRGBEdge[i] = (sSRGBToLinear[i] + sSRGBToLinear[i + 1]) * 0.5f;
+}
+
+static inline U8 linearToSRGB(F32 linear)
+{
+   // Binary search for the byte whose linear value is closest.
+   U32 lo = 0, hi = 255;
+   while(lo < hi)
+   {
+      const U32 mid = (lo + hi) >> 1;
+      if(linear > sLinearToSRGBEdge[mid])
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return U8(lo);
+}
+
+void bitmapExtrudeRGBA_sRGB(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+   const U32 stride = srcHeight != 1 ? srcWidth * 4 : 0;
+   const U32 step = srcWidth != 1 ? 4 : 0;
+
+   U32 width  = srcWidth  >> 1;
+   U32 height = srcHeight >> 1;
+   if (width  == 0) width  = 1;
+   if (height == 0) height = 1;
+
+   for(U32 y = 0; y < height; y++)
+   {
+      const U8 *row = src + y * 2 * stride;
+      for(U32 x = 0; x < width; x++)
+      {
+         const U8 *s = row + x * 2 * step;
+         for(U32 c = 0; c < 3; c++)
+         {
+            const F32 sum = sSRGBToLinear[s[c]] + sSRGBToLinear[s[step + c]] + 
+                            sSRGBToLinear[s[stride + c]] + sSRGBToLinear[s[stride + step + c]];
+            *dst++ = linearToSRGB(sum * 0.25f);
+         }
+         *dst++ = (U32(s[3]) + U32(s[step + 3]) + U32(s[stride + 3]) + U32(s[stride + step + 3]) + 2) >> 2;
+      }
+   }
+}
+
+//--------------------------------------------------------------------------
+
 void (*bitmapExtrude5551)(const void *srcMip, void *mip, U32 height, U32 width) = bitmapExtrude5551_c;
 void (*bitmapExtrudeRGB)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudeRGB_c;
 void (*bitmapExtrudeRGBA)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudeRGBA_c;
@@ -282,3 +409,19 @@ void bitmapConvertA8_to_RGBA_c( U8 **src, U32 pixels )
 }
 
 void (*bitmapConvertA8_to_RGBA)( U8 **src, U32 pixels ) = bitmapConvertA8_to_RGBA_c;
+
+//------------------------------------------------------------------------------
+
+MODULE_BEGIN( BitmapUtils )
+
+   MODULE_INIT
+   {
+      initSRGBTables();
+
+   #if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+      if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+         bitmapExtrudeRGBA = bitmapExtrudeRGBA_SSE2;
+   #endif
+   }
+
+MODULE_END;
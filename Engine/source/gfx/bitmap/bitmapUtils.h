@@ -37,5 +37,11 @@ extern void (*bitmapConvertRGBX_to_RGB)( U8 **src, U32 pixels );
 extern void (*bitmapConvertA8_to_RGBA)( U8 **src, U32 pixels );
 
 void bitmapExtrudeRGB_c(const void *srcMip, void *mip, U32 height, U32 width);
+void bitmapExtrudeRGBA_c(const void *srcMip, void *mip, U32 height, U32 width);
+
+/// Box filters an RGBA mip like bitmapExtrudeRGBA, but converts the color
+/// channels from sRGB to linear before averaging and back afterwards so
+/// that the mips don't darken.  Alpha is averaged as is.
+void bitmapExtrudeRGBA_sRGB(const void *srcMip, void *mip, U32 height, U32 width);
 
 #endif //_BITMAPUTILS_H_
@@ -23,11 +23,83 @@
 #include "squish/squish.h"
 #include "gfx/bitmap/ddsFile.h"
 #include "gfx/bitmap/ddsUtils.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "platform/threads/threadPoolTaskSet.h"
+#include "core/stream/fileStream.h"
+#include "core/volume.h"
+#include "console/engineAPI.h"
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+/// The minimum number of blocks in a surface before we bother the pool.
+static const U32 sMinThreadedBlocks = 4096;
+
+/// The rough number of blocks compressed in one go by a thread.
+static const U32 sBlocksPerBand = 512;
+
+/// The compression of all the mips of a DDS split into bands of block rows.
+/// Each band is one task of the set.
+struct SquishJob : public ThreadPoolTaskSet
+{
+   struct Band
+   {
+      const U8 *src;
+      U8 *dst;
+      U32 width;
+      U32 height;
+   };
+
+   U32 flags;
+
+   Vector< Band > bands;
+
+   SquishJob( U32 squishFlags )
+      : flags( squishFlags )
+   {
+   }
+
+   /// Splits the mip into bands.  The blocks in each band start out at
+   /// the same offset in the output as they would for the whole mip.
+   void addMip( const U8 *src, U8 *dst, U32 width, U32 height, U32 bytesPerBlock )
+   {
+      const U32 blocksPerRow = ( width + 3 ) / 4;
+      const U32 blockRows = ( height + 3 ) / 4;
+      const U32 rowsPerBand = getMax( sBlocksPerBand / blocksPerRow, U32( 1 ) );
+
+      for ( U32 row = 0; row < blockRows; row += rowsPerBand )
+      {
+         bands.increment();
+         Band &band = bands.last();
+         band.src = src + row * 4 * width * 4;
+         band.dst = dst + row * blocksPerRow * bytesPerBlock;
+         band.width = width;
+         band.height = getMin( rowsPerBand * 4, height - row * 4 );
+      }
+   }
+
+   void run( bool threaded )
+   {
+      setNumTasks( bands.size() );
+      ThreadPoolTaskSet::run( threaded );
+   }
+
+protected:
+
+   virtual void runTask( U32 index )
+   {
+      const Band &band = bands[ index ];
+      squish::CompressImage( band.src, band.width, band.height, band.dst, flags );
+   }
+};
+
+}
 
 //------------------------------------------------------------------------------
 
 // If false is returned, from this method, the source DDS is not modified
-bool DDSUtil::squishDDS( DDSFile *srcDDS, const GFXFormat dxtFormat )
+bool DDSUtil::squishDDS( DDSFile *srcDDS, const GFXFormat dxtFormat, bool threaded )
 {
    // Sanity check
    if( srcDDS->mBytesPerPixel != 4 )
@@ -77,22 +149,27 @@ bool DDSUtil::squishDDS( DDSFile *srcDDS, const GFXFormat dxtFormat )
    // are done, we can discard the old surface, and replace it with this one.
    DDSFile::SurfaceData *newSurface = new DDSFile::SurfaceData();
 
+   PROFILE_START(SQUISH_DXT_COMPRESS);
+
+   const U32 bytesPerBlock = ( squishFlags & squish::kDxt1 ) ? 8 : 16;
+   U32 numBlocks = 0;
+
+   ThreadSafeRef< SquishJob > job( new SquishJob( squishFlags ) );
+
    for( S32 i = 0; i < srcDDS->mMipMapCount; i++ )
    {
-      const U8 *srcBits = srcSurface->mMips[i];
-
       const U32 mipSz = srcDDS->getSurfaceSize(i);
       U8 *dstBits = new U8[mipSz];
       newSurface->mMips.push_back( dstBits );
 
-      PROFILE_START(SQUISH_DXT_COMPRESS);
+      job->addMip( srcSurface->mMips[i], dstBits, srcDDS->getWidth(i), srcDDS->getHeight(i), bytesPerBlock );
+      numBlocks += ( ( srcDDS->getWidth(i) + 3 ) / 4 ) * ( ( srcDDS->getHeight(i) + 3 ) / 4 );
+   }
 
-      // Compress with Squish
-      squish::CompressImage( srcBits, srcDDS->getWidth(i), srcDDS->getHeight(i), 
-         dstBits, squishFlags );
+   // Let the pool help out and compress bands ourselves in the meantime.
+   job->run( threaded && numBlocks >= sMinThreadedBlocks );
 
-      PROFILE_END();
-   }
+   PROFILE_END();
 
    // Now delete the source surface, and return.
    srcDDS->mSurfaces.pop_back();
@@ -110,4 +187,94 @@ void DDSUtil::swizzleDDS( DDSFile *srcDDS, const Swizzle<U8, 4> &swizzle )
    {
       swizzle.InPlace( srcDDS->mSurfaces.last()->mMips[i], srcDDS->getSurfaceSize( i ) );
    }
-}
\ No newline at end of file
+}
+//------------------------------------------------------------------------------
+
+DefineEngineFunction( convertTexturesToDDS, S32, ( const char *path, const char *format, bool recursive, bool gammaCorrectMips ), ( "DXT5", true, false ),
+   "@brief Converts the bitmaps in a directory to DXT compressed DDS files.\n\n"
+   "Each bitmap is written next to the original with a .dds extension.  Bitmaps "
+   "whose DDS file is newer than they are are skipped.  Power of two bitmaps "
+   "get a full mip chain.\n\n"
+   "@param path The directory to search for bitmaps.\n"
+   "@param format The DXT format to compress to: DXT1, DXT3 or DXT5.\n"
+   "@param recursive If true the sub directories are converted as well.\n"
+   "@param gammaCorrectMips If true the mips are filtered in linear space.\n"
+   "@return The number of files converted.\n"
+   "@ingroup Rendering\n" )
+{
+   GFXFormat dxtFormat;
+   if ( dStricmp( format, "DXT1" ) == 0 )
+      dxtFormat = GFXFormatDXT1;
+   else if ( dStricmp( format, "DXT3" ) == 0 )
+      dxtFormat = GFXFormatDXT3;
+   else if ( dStricmp( format, "DXT5" ) == 0 )
+      dxtFormat = GFXFormatDXT5;
+   else
+   {
+      Con::errorf( "convertTexturesToDDS - unknown format '%s'", format );
+      return 0;
+   }
+
+   Vector<String> files;
+   for ( U32 i = 0; i < GBitmap::sRegistrations.size(); i++ )
+   {
+      const Vector<String> &extensions = GBitmap::sRegistrations[i].extensions;
+      for ( U32 j = 0; j < extensions.size(); j++ )
+         Torque::FS::FindByPattern( Torque::Path( path ), "*." + extensions[j], recursive, files );
+   }
+
+   const U32 startTime = Platform::getRealMilliseconds();
+   S32 numConverted = 0;
+
+   for ( U32 i = 0; i < files.size(); i++ )
+   {
+      const Torque::Path srcPath( files[i] );
+      Torque::Path ddsPath( srcPath );
+      ddsPath.setExtension( "dds" );
+
+      // Skip the bitmaps which are already up to date.
+      Torque::FS::FileNode::Attributes srcAttr, ddsAttr;
+      if (  Torque::FS::GetFileAttributes( srcPath, &srcAttr ) &&
+            Torque::FS::GetFileAttributes( ddsPath, &ddsAttr ) &&
+            srcAttr.mtime < ddsAttr.mtime )
+         continue;
+
+      FileStream stream;
+      if ( !stream.open( srcPath, Torque::FS::File::Read ) )
+         continue;
+
+      GBitmap bmp;
+      if ( !bmp.readBitmap( srcPath.getExtension(), stream ) )
+      {
+         Con::errorf( "convertTexturesToDDS - failed to read '%s'", srcPath.getFullPath().c_str() );
+         continue;
+      }
+      stream.close();
+
+      if (  bmp.getFormat() != GFXFormatR8G8B8 &&
+            bmp.getFormat() != GFXFormatR8G8B8A8 &&
+            bmp.getFormat() != GFXFormatR8G8B8X8 &&
+            !bmp.setFormat( GFXFormatR8G8B8A8 ) )
+      {
+         Con::errorf( "convertTexturesToDDS - unsupported format in '%s'", srcPath.getFullPath().c_str() );
+         continue;
+      }
+
+      if ( isPow2( bmp.getWidth() ) && isPow2( bmp.getHeight() ) )
+         bmp.extrudeMipLevels( false, gammaCorrectMips );
+
+      DDSFile *dds = DDSFile::createDDSFileFromGBitmap( &bmp );
+      if ( !dds || !DDSUtil::squishDDS( dds, dxtFormat ) || 
+           !stream.open( ddsPath, Torque::FS::File::Write ) || !dds->write( stream ) )
+         Con::errorf( "convertTexturesToDDS - failed to write '%s'", ddsPath.getFullPath().c_str() );
+      else
+         numConverted++;
+
+      delete dds;
+   }
+
+   Con::printf( "convertTexturesToDDS - converted %d of %d bitmaps in %dms", 
+      numConverted, files.size(), Platform::getRealMilliseconds() - startTime );
+
+   return numConverted;
+}
@@ -27,7 +27,14 @@ struct DDSFile;
 
 namespace DDSUtil
 {
-   bool squishDDS( DDSFile *srcDDS, const GFXFormat dxtFormat );
+   /// Compresses all the mips of the DDS to the DXT format.
+   ///
+   /// Large surfaces are split into bands of blocks which are compressed on
+   /// the ThreadPool as well as on the calling thread.  The output doesn't
+   /// depend on how the work is split.
+   ///
+   /// @param threaded If false everything is compressed on the calling thread.
+   bool squishDDS( DDSFile *srcDDS, const GFXFormat dxtFormat, bool threaded = true );
    void swizzleDDS( DDSFile *srcDDS, const Swizzle<U8, 4> &swizzle );
 };
 
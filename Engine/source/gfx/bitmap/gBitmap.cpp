@@ -344,7 +344,7 @@ void GBitmap::allocateBitmap(const U32 in_width, const U32 in_height, const bool
 }
 
 //--------------------------------------------------------------------------
-void GBitmap::extrudeMipLevels(bool clearBorders)
+void GBitmap::extrudeMipLevels(bool clearBorders, bool gammaCorrect)
 {
    if(mNumMipLevels == 1)
       allocateBitmap(getWidth(), getHeight(), true, getFormat());
@@ -368,8 +368,15 @@ void GBitmap::extrudeMipLevels(bool clearBorders)
       case GFXFormatR8G8B8A8:
       case GFXFormatR8G8B8X8:
       {
+         PROFILE_SCOPE(GBitmap_extrudeMipLevels_RGBA);
+
          for(U32 i = 1; i < mNumMipLevels; i++)
-            bitmapExtrudeRGBA(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+         {
+            if (gammaCorrect)
+               bitmapExtrudeRGBA_sRGB(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+            else
+               bitmapExtrudeRGBA(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+         }
          break;
       }
       
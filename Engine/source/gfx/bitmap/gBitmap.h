@@ -148,7 +148,11 @@ public:
                        const bool in_extrudeMipLevels = false,
                        const GFXFormat in_format = GFXFormatR8G8B8 );
 
-   void extrudeMipLevels(bool clearBorders = false);
+   /// Generates the mip chain with a 2x2 box filter.
+   ///
+   /// @param gammaCorrect Filter the color of 32 bit bitmaps in linear
+   ///                     space, treating the bits as sRGB.
+   void extrudeMipLevels(bool clearBorders = false, bool gammaCorrect = false);
    void extrudeMipLevelsDetail();
 
    U32   getNumMipLevels() const { return mNumMipLevels; }
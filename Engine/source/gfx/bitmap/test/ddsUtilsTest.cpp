@@ -0,0 +1,251 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "console/engineAPI.h"
+#include "math/mRandom.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "gfx/bitmap/ddsFile.h"
+#include "gfx/bitmap/ddsUtils.h"
+#include "gfx/bitmap/bitmapUtils.h"
+#include "core/stream/fileStream.h"
+
+/// Noisy gradients, so that squish has some work to do on every block.
+FIXTURE(DDSUtil)
+{
+public:
+   MRandomLCG rand;
+
+   void SetUp()
+   {
+      rand.setSeed( 1234 );
+   }
+
+   GBitmap* createBitmap( U32 width, U32 height, bool mips )
+   {
+      GBitmap *bmp = new GBitmap( width, height, false, GFXFormatR8G8B8A8 );
+      U8 *bits = bmp->getWritableBits();
+      for ( U32 y = 0; y < height; y++ )
+      {
+         for ( U32 x = 0; x < width; x++ )
+         {
+            U8 *p = bits + ( y * width + x ) * 4;
+            p[0] = U8( x * 255 / width );
+            p[1] = U8( y * 255 / height );
+            p[2] = U8( rand.randI( 0, 255 ) );
+            p[3] = U8( ( x ^ y ) & 0xFF );
+         }
+      }
+
+      if ( mips )
+         bmp->extrudeMipLevels();
+
+      return bmp;
+   }
+
+   DDSFile* squish( const GBitmap *bmp, GFXFormat format, bool threaded )
+   {
+      DDSFile *dds = DDSFile::createDDSFileFromGBitmap( bmp );
+      EXPECT_TRUE( DDSUtil::squishDDS( dds, format, threaded ) );
+      return dds;
+   }
+};
+
+TEST_FIX(DDSUtil, ThreadedSquishIsByteIdentical)
+{
+   const GFXFormat formats[] = { GFXFormatDXT1, GFXFormatDXT3, GFXFormatDXT5 };
+
+   // Include a size which isn't a multiple of the band height.
+   GBitmap *bitmaps[] = { createBitmap( 512, 512, true ), createBitmap( 256, 1024, true ), createBitmap( 1000, 300, false ) };
+
+   for ( U32 b = 0; b < 3; b++ )
+   {
+      for ( U32 f = 0; f < 3; f++ )
+      {
+         DDSFile *serial = squish( bitmaps[b], formats[f], false );
+         DDSFile *threaded = squish( bitmaps[b], formats[f], true );
+
+         ASSERT_EQ( serial->mMipMapCount, threaded->mMipMapCount );
+         for ( U32 i = 0; i < serial->mMipMapCount; i++ )
+         {
+            EXPECT_EQ( 0, dMemcmp( serial->mSurfaces.last()->mMips[i], threaded->mSurfaces.last()->mMips[i], serial->getSurfaceSize( i ) ) )
+               << "Mip " << i << " differs for bitmap " << b << " format " << f;
+         }
+
+         delete serial;
+         delete threaded;
+      }
+
+      delete bitmaps[b];
+   }
+}
+
+TEST_FIX(DDSUtil, ExtrudeRoundsBoxAverage)
+{
+   // Every channel rounds the 2x2 sum up from .5, the
+   // same as the mips have always been built.
+   const U8 src[] =
+   {
+      0, 1, 255, 10,    1, 1, 255, 20,
+      0, 1, 255, 30,    1, 2, 254, 41,
+   };
+   U8 dst[4];
+   bitmapExtrudeRGBA( src, dst, 2, 2 );
+   EXPECT_EQ( 1, dst[0] );
+   EXPECT_EQ( 1, dst[1] );
+   EXPECT_EQ( 255, dst[2] );
+   EXPECT_EQ( 25, dst[3] );
+}
+
+TEST_FIX(DDSUtil, WideExtrudeEqualsScalar)
+{
+   // The SIMD kernel works on pairs of destination pixels and
+   // leaves narrow surfaces to the C version, so cover both.
+   const U32 sizes[][2] = { { 2, 2 }, { 4, 4 }, { 8, 2 }, { 2, 8 }, { 12, 6 }, { 64, 64 }, { 256, 32 } };
+
+   for ( U32 s = 0; s < sizeof( sizes ) / sizeof( sizes[0] ); s++ )
+   {
+      const U32 width = sizes[s][0];
+      const U32 height = sizes[s][1];
+
+      Vector<U8> src;
+      src.setSize( width * height * 4 );
+      for ( U32 i = 0; i < src.size(); i++ )
+         src[i] = U8( rand.randI( 0, 255 ) );
+
+      const U32 dstSize = getMax( width / 2, 1U ) * getMax( height / 2, 1U ) * 4;
+      Vector<U8> expected, actual;
+      expected.setSize( dstSize );
+      actual.setSize( dstSize );
+
+      bitmapExtrudeRGBA_c( src.address(), expected.address(), height, width );
+      bitmapExtrudeRGBA( src.address(), actual.address(), height, width );
+
+      EXPECT_EQ( 0, dMemcmp( expected.address(), actual.address(), dstSize ) )
+         << "Mismatch for " << width << "x" << height;
+   }
+}
+
+TEST_FIX(DDSUtil, GammaCorrectMipsKeepHalfTheLight)
+{
+   // A black and white checker averages to half the
+   // light, which is a lot brighter than 128 in sRGB.
+   GBitmap bmp( 2, 2, false, GFXFormatR8G8B8A8 );
+   bmp.setColor( 0, 0, ColorI( 0, 0, 0, 0 ) );
+   bmp.setColor( 1, 0, ColorI( 255, 255, 255, 255 ) );
+   bmp.setColor( 0, 1, ColorI( 255, 255, 255, 255 ) );
+   bmp.setColor( 1, 1, ColorI( 0, 0, 0, 0 ) );
+   bmp.extrudeMipLevels( false, true );
+
+   // Alpha isn't a color, so it is still a plain average.
+   const U8 *mip = bmp.getBits( 1 );
+   EXPECT_EQ( 188, mip[0] );
+   EXPECT_EQ( 188, mip[1] );
+   EXPECT_EQ( 188, mip[2] );
+   EXPECT_EQ( 128, mip[3] );
+
+   // Flat colors stay the same.
+   GBitmap flat( 4, 4, false, GFXFormatR8G8B8A8 );
+   flat.fill( ColorI( 17, 100, 230, 40 ) );
+   flat.extrudeMipLevels( false, true );
+   for ( U32 i = 1; i < flat.getNumMipLevels(); i++ )
+   {
+      const U8 *bits = flat.getBits( i );
+      EXPECT_EQ( 17, bits[0] );
+      EXPECT_EQ( 100, bits[1] );
+      EXPECT_EQ( 230, bits[2] );
+      EXPECT_EQ( 40, bits[3] );
+   }
+}
+
+TEST_FIX(DDSUtil, DefaultMipsStayInSRGB)
+{
+   // Without the flag the checker averages its stored values.
+   GBitmap bmp( 2, 2, false, GFXFormatR8G8B8A8 );
+   bmp.setColor( 0, 0, ColorI( 0, 0, 0, 0 ) );
+   bmp.setColor( 1, 0, ColorI( 255, 255, 255, 255 ) );
+   bmp.setColor( 0, 1, ColorI( 255, 255, 255, 255 ) );
+   bmp.setColor( 1, 1, ColorI( 0, 0, 0, 0 ) );
+   bmp.extrudeMipLevels();
+
+   const U8 *mip = bmp.getBits( 1 );
+   for ( U32 i = 0; i < 4; i++ )
+      EXPECT_EQ( 128, mip[i] );
+}
+
+TEST_FIX(DDSUtil, ConvertTexturesToDDS)
+{
+   const char *dir = "ddsUtilTest/";
+   const char *names[] = { "ddsUtilTest/a", "ddsUtilTest/b" };
+   Platform::createPath( dir );
+
+   GBitmap *bitmaps[2];
+   for ( U32 i = 0; i < 2; i++ )
+   {
+      bitmaps[i] = createBitmap( 64, 32, false );
+
+      FileStream stream;
+      ASSERT_TRUE( stream.open( String( names[i] ) + ".png", Torque::FS::File::Write ) );
+      ASSERT_TRUE( bitmaps[i]->writeBitmap( "png", stream ) );
+   }
+
+   EXPECT_EQ( 0, dAtoi( Con::executef( "convertTexturesToDDS", dir, "DXT2" ) ) )
+      << "Unknown formats convert nothing";
+   EXPECT_EQ( 2, dAtoi( Con::executef( "convertTexturesToDDS", dir, "DXT1" ) ) );
+
+   // The files hold what squishDDS makes of the same bitmap.
+   for ( U32 i = 0; i < 2; i++ )
+   {
+      const String ddsPath = String( names[i] ) + ".dds";
+
+      FileStream stream;
+      ASSERT_TRUE( stream.open( ddsPath, Torque::FS::File::Read ) );
+      DDSFile written;
+      ASSERT_TRUE( written.read( stream, 0 ) );
+      stream.close();
+
+      bitmaps[i]->extrudeMipLevels();
+      DDSFile *expected = squish( bitmaps[i], GFXFormatDXT1, false );
+
+      EXPECT_EQ( GFXFormatDXT1, written.getFormat() );
+      ASSERT_EQ( expected->mMipMapCount, written.mMipMapCount );
+      for ( U32 m = 0; m < expected->mMipMapCount; m++ )
+      {
+         EXPECT_EQ( 0, dMemcmp( expected->mSurfaces.last()->mMips[m], written.mSurfaces.last()->mMips[m], expected->getSurfaceSize( m ) ) )
+            << "Mip " << m << " of " << ddsPath.c_str();
+      }
+
+      delete expected;
+      delete bitmaps[i];
+
+      dFileDelete( ddsPath );
+      dFileDelete( String( names[i] ) + ".png" );
+   }
+}
+
+TEST_FIX(DDSUtil, LargeTextureConvertTime)
+{
+   GBitmap *bmp = createBitmap( 2048, 2048, false );
+
+   U32 start = Platform::getRealMilliseconds();
+   bmp->extrudeMipLevels();
+   Con::printf( "DDSUtil 2048x2048 mips: %ums", Platform::getRealMilliseconds() - start );
+
+   start = Platform::getRealMilliseconds();
+   DDSFile *serial = squish( bmp, GFXFormatDXT5, false );
+   Con::printf( "DDSUtil 2048x2048 DXT5 serial: %ums", Platform::getRealMilliseconds() - start );
+
+   start = Platform::getRealMilliseconds();
+   DDSFile *threaded = squish( bmp, GFXFormatDXT5, true );
+   Con::printf( "DDSUtil 2048x2048 DXT5 threaded: %ums", Platform::getRealMilliseconds() - start );
+
+   ASSERT_EQ( serial->mMipMapCount, threaded->mMipMapCount );
+   for ( U32 i = 0; i < serial->mMipMapCount; i++ )
+      EXPECT_EQ( 0, dMemcmp( serial->mSurfaces.last()->mMips[i], threaded->mSurfaces.last()->mMips[i], serial->getSurfaceSize( i ) ) );
+
+   delete serial;
+   delete threaded;
+   delete bmp;
+}
+
+#endif
@@ -51,6 +51,7 @@ bool GFXDevice::smDisableVSync = true;
 F32 GFXDevice::smForcedPixVersion = -1.0f;
 bool GFXDevice::smDisableOcclusionQuery = false;
 bool gDisassembleAllShaders = false;
+bool gCacheShaderBinaries = true;
 
 
 void GFXDevice::initConsole()
@@ -66,6 +67,11 @@ void GFXDevice::initConsole()
       "procedural shader folder.\n"
       "@ingroup GFX\n" );
 
+   Con::addVariable( "$gfx::cacheShaderBinaries", TypeBool, &gCacheShaderBinaries,
+      "On supported devices compiled shader programs are saved to the "
+      "procedural shader folder and reused instead of compiling them again.\n"
+      "@ingroup GFX\n" );
+
    Con::addVariable( "$gfx::disableOcclusionQuery", TypeBool, &smDisableOcclusionQuery,
       "Debug helper that disables all hardware occlusion queries causing "
       "them to return only the visibile state.\n"
@@ -805,6 +811,9 @@ inline bool GFXDevice::beginScene()
 
    mDeviceStatistics.clear();
 
+   // Upload the textures which finished loading in the background.
+   mTextureManager->processAsyncLoads();
+
    // Send the start of frame signal.
    getDeviceEventSignal().trigger( GFXDevice::deStartOfFrame );
    mFrameTime->reset();
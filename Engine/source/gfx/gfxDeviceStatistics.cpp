@@ -36,6 +36,8 @@ void GFXDeviceStatistics::setPrefix(const String& prefix)
    vnPolyCount = prefix + "polyCount";
    vnDrawCalls = prefix + "drawCalls";
    vnRenderTargetChanges = prefix + "renderTargetChanges";
+   vnInstancedDrawCalls = prefix + "instancedDrawCalls";
+   vnInstances = prefix + "instances";
 }
 
 /// Clear stats
@@ -44,6 +46,8 @@ void GFXDeviceStatistics::clear()
    mPolyCount = 0;
    mDrawCalls = 0;
    mRenderTargetChanges = 0;
+   mInstancedDrawCalls = 0;
+   mInstances = 0;
 }
 
 /// Copy from source (should just be a memcpy, but that may change later) used in 
@@ -54,6 +58,8 @@ void GFXDeviceStatistics::start(GFXDeviceStatistics * source)
    mPolyCount = source->mPolyCount;
    mDrawCalls = source->mDrawCalls;
    mRenderTargetChanges = source->mRenderTargetChanges;
+   mInstancedDrawCalls = source->mInstancedDrawCalls;
+   mInstances = source->mInstances;
 }
 
 /// Used with start to get a subset of stats on a device.  Basically will do
@@ -63,6 +69,8 @@ void GFXDeviceStatistics::end(GFXDeviceStatistics * source)
    mPolyCount = source->mPolyCount - mPolyCount;
    mDrawCalls = source->mDrawCalls - mDrawCalls;
    mRenderTargetChanges = source->mRenderTargetChanges - mRenderTargetChanges;   
+   mInstancedDrawCalls = source->mInstancedDrawCalls - mInstancedDrawCalls;
+   mInstances = source->mInstances - mInstances;
 }
 
 /// Exports the stats to the console
@@ -71,4 +79,6 @@ void GFXDeviceStatistics::exportToConsole()
    Con::setIntVariable(vnPolyCount, mPolyCount);
    Con::setIntVariable(vnDrawCalls, mDrawCalls);
    Con::setIntVariable(vnRenderTargetChanges, mRenderTargetChanges);
+   Con::setIntVariable(vnInstancedDrawCalls, mInstancedDrawCalls);
+   Con::setIntVariable(vnInstances, mInstances);
 }
\ No newline at end of file
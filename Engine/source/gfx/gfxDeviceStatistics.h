@@ -35,6 +35,13 @@ public:
    S32 mDrawCalls;
    S32 mRenderTargetChanges;
 
+   /// The draws which rendered more than one instance, these are
+   /// also counted in mDrawCalls.
+   S32 mInstancedDrawCalls;
+
+   /// The total instances drawn by the instanced draws.
+   S32 mInstances;
+
    GFXDeviceStatistics();
 
    void setPrefix(const String& prefix);
@@ -57,6 +64,8 @@ private:
    String vnPolyCount;
    String vnDrawCalls;
    String vnRenderTargetChanges;
+   String vnInstancedDrawCalls;
+   String vnInstances;
 };
 
 #endif
\ No newline at end of file
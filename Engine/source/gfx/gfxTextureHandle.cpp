@@ -70,6 +70,21 @@ bool GFXTexHandle::set( const String &texName, GFXTextureProfile *profile, const
    return isValid();
 }
 
+bool GFXTexHandle::setAsync( const String &texName, GFXTextureProfile *profile, const String &desc )
+{
+   free();
+
+   AssertFatal( texName.isNotEmpty(), "Texture name is empty" );
+   StrongObjectRef::set( TEXMGR->createTextureAsync( texName, profile ) );
+
+   #ifdef TORQUE_DEBUG
+      if ( getPointer() )
+         getPointer()->mDebugDescription = desc;
+   #endif
+
+   return isValid();
+}
+
 GFXTexHandle::GFXTexHandle( GBitmap *bmp, GFXTextureProfile *profile, bool deleteBmp, const String &desc )
 {
    set( bmp, profile, deleteBmp, desc );
@@ -46,6 +46,9 @@ public:
    GFXTexHandle( const String &texName, GFXTextureProfile *profile, const String &desc );
    bool set( const String &texName, GFXTextureProfile *profile, const String &desc );
 
+   // load texture without waiting, see GFXTextureManager::createTextureAsync()
+   bool setAsync( const String &texName, GFXTextureProfile *profile, const String &desc );
+
    // register texture
    GFXTexHandle( GBitmap *bmp, GFXTextureProfile *profile, bool deleteBmp, const String &desc );
    bool set( GBitmap *bmp, GFXTextureProfile *profile, bool deleteBmp, const String &desc );
@@ -30,10 +30,12 @@
 #include "core/strings/stringFunctions.h"
 #include "core/util/safeDelete.h"
 #include "core/resourceManager.h"
+#include "core/stream/fileStream.h"
 #include "core/volume.h"
 #include "core/util/dxt5nmSwizzle.h"
 #include "console/consoleTypes.h"
 #include "console/engineAPI.h"
+#include "platform/threads/threadPoolTaskSet.h"
 
 using namespace Torque;
 
@@ -46,6 +48,9 @@ String GFXTextureManager::smMissingTexturePath("core/art/missingTexture");
 String GFXTextureManager::smUnavailableTexturePath("core/art/unavailable");
 String GFXTextureManager::smWarningTexturePath("core/art/warnmat");
 
+bool GFXTextureManager::smAsyncLoading = true;
+S32 GFXTextureManager::smAsyncUploadBudgetMS = 4;
+
 GFXTextureManager::EventSignal GFXTextureManager::smEventSignal;
 
 static const String  sDDSExt( "dds" );
@@ -70,6 +75,16 @@ void GFXTextureManager::init()
    Con::addVariable( "$pref::Video::warningTexturePath", TypeRealString, &smWarningTexturePath,
       "The file path of the texture used to warn the developer.\n"
       "@ingroup GFX\n" );
+
+   Con::addVariable( "$pref::Video::asyncTextureLoading", TypeBool, &smAsyncLoading,
+      "If true textures requested with createTextureAsync() are read and decoded "
+      "on worker threads while a placeholder is displayed.\n"
+      "@ingroup GFX\n" );
+
+   Con::addVariable( "$pref::Video::textureUploadBudget", TypeS32, &smAsyncUploadBudgetMS,
+      "The time in milliseconds spent each frame uploading textures which "
+      "finished loading on worker threads.\n"
+      "@ingroup GFX\n" );
 }
 
 GFXTextureManager::GFXTextureManager()
@@ -117,6 +132,10 @@ void GFXTextureManager::kill()
 {
    AssertFatal( mTextureManagerState != GFXTextureManager::Dead, "Texture Manager already killed!" );
 
+   // Drop the pending loads first so that their
+   // textures get released by the cache cleanup.
+   _cancelAsyncLoads();
+
    // Release everything in the cache we can
    // so we don't leak any textures.
    cleanupCache();
@@ -616,20 +635,14 @@ GFXTextureObject *GFXTextureManager::_createTexture(  DDSFile *dds,
    return ret;
 }
 
-GFXTextureObject *GFXTextureManager::createTexture( const Torque::Path &path, GFXTextureProfile *profile )
+/// Fixes up texture paths which have had part of the file name
+/// parsed out as an extension and returns the path without
+/// extension which textures are cached under.
+static void _getTexturePaths( const Torque::Path &path, Torque::Path &outCorrectPath, String &outPathNoExt )
 {
-   PROFILE_SCOPE( GFXTextureManager_createTexture );
-   
-   // Resource handles used for loading.  Hold on to them
-   // throughout this function so that change notifications
-   // don't get added, then removed, and then re-added.
-   
-   Resource< DDSFile > dds;
-   Resource< GBitmap > bitmap;
-   
    // We need to handle path's that have had "incorrect"
    // extensions parsed out of the file name
-   Torque::Path correctPath = path;
+   outCorrectPath = path;
 
    bool textureExt = false;
 
@@ -670,17 +683,41 @@ GFXTextureObject *GFXTextureManager::createTexture( const Torque::Path &path, GF
    // the texture name so add it back
    if (!textureExt)
    {
-      correctPath.setFileName( Torque::Path::Join( path.getFileName(), '.', path.getExtension() ) );
-      correctPath.setExtension( String::EmptyString );
+      outCorrectPath.setFileName( Torque::Path::Join( path.getFileName(), '.', path.getExtension() ) );
+      outCorrectPath.setExtension( String::EmptyString );
    }
 
-   // Check the cache first...
-   String pathNoExt = Torque::Path::Join( correctPath.getRoot(), ':', correctPath.getPath() );
-   pathNoExt = Torque::Path::Join( pathNoExt, '/', correctPath.getFileName() );
+   outPathNoExt = Torque::Path::Join( outCorrectPath.getRoot(), ':', outCorrectPath.getPath() );
+   outPathNoExt = Torque::Path::Join( outPathNoExt, '/', outCorrectPath.getFileName() );
+}
 
+GFXTextureObject *GFXTextureManager::createTexture( const Torque::Path &path, GFXTextureProfile *profile )
+{
+   PROFILE_SCOPE( GFXTextureManager_createTexture );
+   
+   // Resource handles used for loading.  Hold on to them
+   // throughout this function so that change notifications
+   // don't get added, then removed, and then re-added.
+   
+   Resource< DDSFile > dds;
+   Resource< GBitmap > bitmap;
+   
+   Torque::Path correctPath;
+   String pathNoExt;
+   _getTexturePaths( path, correctPath, pathNoExt );
+
+   // Check the cache first...
    GFXTextureObject *retTexObj = _lookupTexture( pathNoExt, profile );
    if( retTexObj )
+   {
+      // The caller expects the real texture, so
+      // don't hand out an async placeholder.
+      const S32 asyncIndex = _findAsyncLoad( retTexObj );
+      if ( asyncIndex != -1 )
+         _finishAsyncLoad( asyncIndex );
+
       return retTexObj;
+   }
 
    const U32 scalePower = getTextureDownscalePower( profile );
 
@@ -763,6 +800,287 @@ GFXTextureObject *GFXTextureManager::createTexture( const Torque::Path &path, GF
    return retTexObj;
 }
 
+//-----------------------------------------------------------------------------
+// Async Loading
+//-----------------------------------------------------------------------------
+
+/// Reads a DDS file without going through the ResourceManager,
+/// which isn't safe to use off the main thread.
+static DDSFile* _readDDSFile( const Torque::Path &path, const String &cacheString, U32 dropMipCount )
+{
+   FileStream stream;
+   stream.open( path.getFullPath(), Torque::FS::File::Read );
+   if ( stream.getStatus() != Stream::Ok )
+      return NULL;
+
+   DDSFile *dds = new DDSFile;
+   if ( !dds->read( stream, dropMipCount ) )
+   {
+      delete dds;
+      return NULL;
+   }
+
+   dds->mSourcePath = path;
+   dds->mCacheString = cacheString;
+   return dds;
+}
+
+/// Reads a bitmap without going through the ResourceManager.
+static GBitmap* _readBitmapFile( const Torque::Path &path )
+{
+   FileStream stream;
+   stream.open( path.getFullPath(), Torque::FS::File::Read );
+   if ( stream.getStatus() != Stream::Ok )
+      return NULL;
+
+   GBitmap *bmp = new GBitmap;
+   if ( !bmp->readBitmap( path.getExtension(), stream ) )
+   {
+      delete bmp;
+      return NULL;
+   }
+
+   return bmp;
+}
+
+/// Finds the texture file the same way createTexture() does minus
+/// the search of the parent directories.  This is safe to call from
+/// any thread.
+static bool _findTextureFile( const Torque::Path &correctPath, const String &pathNoExt, Torque::Path &outRealPath )
+{
+   if ( Torque::FS::IsFile( correctPath ) )
+   {
+      outRealPath = correctPath;
+      return true;
+   }
+
+   Torque::Path tryDDSPath = pathNoExt;
+   if ( tryDDSPath.getExtension().isNotEmpty() )
+      tryDDSPath.setFileName( tryDDSPath.getFullFileName() );
+   tryDDSPath.setExtension( sDDSExt );
+
+   if ( Torque::FS::IsFile( tryDDSPath ) )
+   {
+      outRealPath = tryDDSPath;
+      return true;
+   }
+
+   return GBitmap::sFindFile( correctPath, &outRealPath );
+}
+
+/// Reads a texture file found by _findTextureFile().  This is
+/// safe to call from any thread.
+static void _readTextureFile( const Torque::Path &realPath, 
+                              const String &pathNoExt, 
+                              U32 scalePower,
+                              GBitmap *&outBitmap,
+                              DDSFile *&outDDS )
+{
+   PROFILE_SCOPE( GFXTextureManager_ReadTextureFile );
+
+   outBitmap = NULL;
+   outDDS = NULL;
+
+   if ( sDDSExt.equal( realPath.getExtension(), String::NoCase ) )
+      outDDS = _readDDSFile( realPath, pathNoExt, scalePower );
+   else
+      outBitmap = _readBitmapFile( realPath );
+}
+
+/// A task set of one task, so that the texture manager
+/// can wait on just this load.
+struct GFXTextureManager::AsyncLoadItem : public ThreadPoolTaskSet
+{
+   typedef ThreadPoolTaskSet Parent;
+
+   /// The load input, which doesn't change once started.
+   Torque::Path mPath;
+   Torque::Path mRealPath;
+   String mPathNoExt;
+   U32 mScalePower;
+
+   /// The load result which belongs to the
+   /// worker until the task is done.
+   GBitmap *mBitmap;
+   DDSFile *mDDS;
+
+   AsyncLoadItem( const Torque::Path &path, const Torque::Path &realPath, const String &pathNoExt, U32 scalePower )
+      :  Parent( 1 ),
+         mPath( path ),
+         mRealPath( realPath ),
+         mPathNoExt( pathNoExt ),
+         mScalePower( scalePower ),
+         mBitmap( NULL ),
+         mDDS( NULL )
+   {
+   }
+
+   ~AsyncLoadItem()
+   {
+      // Only still set if nobody took ownership of the data.
+      delete mBitmap;
+      delete mDDS;
+   }
+
+protected:
+   virtual void runTask( U32 index )
+   {
+      _readTextureFile( mRealPath, mPathNoExt, mScalePower, mBitmap, mDDS );
+   }
+};
+
+GFXTextureObject *GFXTextureManager::createTextureAsync( const Torque::Path &path, GFXTextureProfile *profile )
+{
+   PROFILE_SCOPE( GFXTextureManager_createTextureAsync );
+
+   if ( !smAsyncLoading )
+      return createTexture( path, profile );
+
+   Torque::Path correctPath;
+   String pathNoExt;
+   _getTexturePaths( path, correctPath, pathNoExt );
+
+   // If the texture is already loaded or loading
+   // then everyone shares the one texture object.
+   GFXTextureObject *retTexObj = _lookupTexture( pathNoExt, profile );
+   if ( retTexObj )
+      return retTexObj;
+
+   // Look for the file now so that a missing texture is NULL like
+   // it is from createTexture() instead of a placeholder forever.
+   Torque::Path realPath;
+   if ( !_findTextureFile( correctPath, pathNoExt, realPath ) )
+      return createTexture( path, profile );
+
+   // Create the placeholder under the name of the texture
+   // so that it lives in the cache while it loads.
+   GBitmap placeholder( 4, 4, false, GFXFormatR8G8B8A8 );
+   if ( profile->getType() == GFXTextureProfile::NormalMap )
+      placeholder.fill( ColorI( 128, 128, 255 ) );
+   else
+      placeholder.fill( ColorI( 128, 128, 128 ) );
+
+   retTexObj = _createTexture( &placeholder, pathNoExt, profile, false, NULL );
+   if ( !retTexObj )
+      return createTexture( path, profile );
+
+   AsyncLoad load;
+   load.item = new AsyncLoadItem( correctPath, realPath, pathNoExt, getTextureDownscalePower( profile ) );
+   load.texture = retTexObj;
+   mAsyncLoads.push_back( load );
+
+   load.item->start();
+
+   return retTexObj;
+}
+
+void GFXTextureManager::processAsyncLoads( bool wait )
+{
+   if ( mAsyncLoads.empty() || mTextureManagerState != GFXTextureManager::Living )
+      return;
+
+   PROFILE_SCOPE( GFXTextureManager_ProcessAsyncLoads );
+
+   if ( wait )
+   {
+      while ( !mAsyncLoads.empty() )
+         _finishAsyncLoad( 0 );
+
+      return;
+   }
+
+   // Upload the finished loads in the order they were requested
+   // until we run out of time.  We always do at least one so that
+   // the queue keeps moving when the budget is tiny.
+   const U32 startTime = Platform::getRealMilliseconds();
+   for ( U32 i = 0; i < mAsyncLoads.size(); )
+   {
+      if ( !mAsyncLoads[i].item->isDone() )
+      {
+         i++;
+         continue;
+      }
+
+      _finishAsyncLoad( i );
+
+      if ( S32( Platform::getRealMilliseconds() - startTime ) >= smAsyncUploadBudgetMS )
+         break;
+   }
+}
+
+S32 GFXTextureManager::_findAsyncLoad( const GFXTextureObject *texture ) const
+{
+   for ( U32 i = 0; i < mAsyncLoads.size(); i++ )
+   {
+      if ( mAsyncLoads[i].texture == texture )
+         return i;
+   }
+
+   return -1;
+}
+
+void GFXTextureManager::_finishAsyncLoad( U32 index )
+{
+   PROFILE_SCOPE( GFXTextureManager_FinishAsyncLoad );
+
+   AsyncLoadItemRef item = mAsyncLoads[index].item;
+   StrongRefPtr<GFXTextureObject> texture = mAsyncLoads[index].texture;
+   mAsyncLoads.erase( index );
+
+   // Reads the file on this thread if no worker has
+   // picked it up yet, else waits for the worker.
+   item->wait();
+
+   // The worker is done with the result so we can take it.
+   GBitmap *bitmap = item->mBitmap;
+   DDSFile *dds = item->mDDS;
+   Torque::Path realPath = item->mRealPath;
+   item->mBitmap = NULL;
+   item->mDDS = NULL;
+
+   GFXTextureObject *retTexObj = NULL;
+   GFXTextureProfile *profile = texture->mProfile;
+
+   if ( dds )
+      retTexObj = _createTexture( dds, profile, false, texture );
+   else if ( bitmap )
+      retTexObj = _createTexture( bitmap, item->mPathNoExt, profile, false, texture );
+   else
+   {
+      // The file didn't read off the main thread, so let GBitmap
+      // do its full search of the parent directories.
+      Resource<GBitmap> bmp = GBitmap::load( item->mPath );
+      if ( bmp != NULL )
+      {
+         realPath = bmp.getPath();
+         retTexObj = _createTexture( bmp, item->mPathNoExt, profile, false, texture );
+      }
+   }
+
+   delete bitmap;
+   delete dds;
+
+   if ( !retTexObj )
+   {
+      Con::errorf( "GFXTextureManager - failed to load texture '%s'", item->mPath.getFullPath().c_str() );
+      return;
+   }
+
+   // Store the path for later use.
+   retTexObj->mPath = realPath;
+
+   // Register the texture file for change notifications.
+   FS::AddChangeNotification( retTexObj->getPath(), this, &GFXTextureManager::_onFileChanged );
+}
+
+void GFXTextureManager::_cancelAsyncLoads()
+{
+   for ( U32 i = 0; i < mAsyncLoads.size(); i++ )
+      mAsyncLoads[i].item->cancel();
+
+   mAsyncLoads.clear();
+}
+
 GFXTextureObject *GFXTextureManager::createTexture(  U32 width, U32 height, void *pixels, GFXFormat format, GFXTextureProfile *profile )
 {
    // For now, stuff everything into a GBitmap and pass it off... This may need to be revisited -- BJG
@@ -41,6 +41,9 @@
 #ifndef _TSIGNAL_H_
 #include "core/util/tSignal.h"
 #endif
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
 
 
 namespace Torque
@@ -105,6 +108,35 @@ public:
    virtual GFXTextureObject *createTexture(  const Torque::Path &path,
       GFXTextureProfile *profile );
 
+   /// Returns the texture for the file without waiting for it to load.
+   ///
+   /// A texture that is not already in the cache is returned holding a
+   /// small placeholder image.  The file is read and decoded on the
+   /// ThreadPool and the result is uploaded into the same texture object
+   /// by processAsyncLoads().  Requests for a texture which is still
+   /// loading return the pending texture object.  Like createTexture()
+   /// it returns NULL if the file can't be found.
+   ///
+   /// Falls back to createTexture() when $pref::Video::asyncTextureLoading
+   /// is disabled.
+   virtual GFXTextureObject *createTextureAsync(   const Torque::Path &path,
+      GFXTextureProfile *profile );
+
+   /// Uploads textures which have finished loading on the ThreadPool.
+   ///
+   /// This is called at the start of every frame and spends at most
+   /// $pref::Video::textureUploadBudget milliseconds on uploads.
+   ///
+   /// @param wait If true all of this manager's pending loads are
+   /// finished before returning.
+   void processAsyncLoads( bool wait = false );
+
+   /// Returns true if any textures are waiting on an async load.
+   bool hasAsyncLoads() const { return !mAsyncLoads.empty(); }
+
+   /// Returns true if the texture is still showing its placeholder.
+   bool isAsyncLoadPending( GFXTextureObject *texture ) const { return _findAsyncLoad( texture ) != -1; }
+
    virtual GFXTextureObject *createTexture(  U32 width,
       U32 height,
       void *pixels,
@@ -196,6 +228,17 @@ protected:
    /// File path to the warning texture
    static String smWarningTexturePath;
 
+   /// If false createTextureAsync() loads textures synchronously.
+   ///
+   /// Exposed to script via $pref::Video::asyncTextureLoading.
+   static bool smAsyncLoading;
+
+   /// The time in milliseconds processAsyncLoads() may spend
+   /// uploading textures each frame.
+   ///
+   /// Exposed to script via $pref::Video::textureUploadBudget.
+   static S32 smAsyncUploadBudgetMS;
+
    GFXTextureObject *mListHead;
    GFXTextureObject *mListTail;
 
@@ -213,6 +256,22 @@ protected:
    /// The textures waiting to be deleted.
    Vector<GFXTextureObject*> mToDelete;
 
+   /// Reads and decodes a texture file as a single ThreadPoolTaskSet task.
+   struct AsyncLoadItem;
+   typedef ThreadSafeRef<AsyncLoadItem> AsyncLoadItemRef;
+
+   /// A texture waiting on an AsyncLoadItem.
+   struct AsyncLoad
+   {
+      AsyncLoadItemRef item;
+
+      /// Holds the placeholder texture alive until the load is done.
+      StrongRefPtr<GFXTextureObject> texture;
+   };
+
+   /// The async loads in the order they were requested.
+   Vector<AsyncLoad> mAsyncLoads;
+
    enum TextureManagerState
    {
       Living,
@@ -336,6 +395,16 @@ protected:
 
    void _onFileChanged( const Torque::Path &path );
 
+   /// Returns the index of the async load for the texture or -1.
+   S32 _findAsyncLoad( const GFXTextureObject *texture ) const;
+
+   /// Removes the async load from the list and uploads its
+   /// result, loading the file now if the worker hasn't yet.
+   void _finishAsyncLoad( U32 index );
+
+   /// Drops all the async loads without uploading them.
+   void _cancelAsyncLoads();
+
    /// The texture event signal type.
    typedef Signal<void(GFXTexCallbackCode code)> EventSignal;
 
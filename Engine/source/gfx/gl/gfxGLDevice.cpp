@@ -551,7 +551,14 @@ inline void GFXGLDevice::preDrawPrimitive()
 inline void GFXGLDevice::postDrawPrimitive(U32 primitiveCount)
 {
    mDeviceStatistics.mDrawCalls++;
-   mDeviceStatistics.mPolyCount += primitiveCount;
+   if ( mDrawInstancesCount )
+   {
+      mDeviceStatistics.mPolyCount += primitiveCount * mDrawInstancesCount;
+      mDeviceStatistics.mInstancedDrawCalls++;
+      mDeviceStatistics.mInstances += mDrawInstancesCount;
+   }
+   else
+      mDeviceStatistics.mPolyCount += primitiveCount;
 }
 
 void GFXGLDevice::drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount ) 
@@ -30,7 +30,9 @@
 #include "math/mPoint2.h"
 #include "gfx/gfxStructs.h"
 #include "console/console.h"
+#include "core/util/hashFunction.h"
 
+extern bool gCacheShaderBinaries;
 
 class GFXGLShaderConstHandle : public GFXShaderConstHandle
 {
@@ -417,80 +419,138 @@ bool GFXGLShader::_init()
    macros.last().name = "TORQUE_VERTEX_SHADER";
    macros.last().value = "";   
 
-   // Default to true so we're "successful" if a vertex/pixel shader wasn't specified.
-   bool compiledVertexShader = true;
-   bool compiledPixelShader = true;
-   
-   // Compile the vertex and pixel shaders if specified.
+   // Read in the full source of both shaders first.
+   Vector<char*> vertSource;
+   Vector<char*> pixSource;
+   bool loaded = true;
    if(!mVertexFile.isEmpty())
-      compiledVertexShader = initShader(mVertexFile, true, macros);
+      loaded = _loadShaderSource(mVertexFile, macros, vertSource);
 
    macros.last().name = "TORQUE_PIXEL_SHADER";
-   if(!mPixelFile.isEmpty())
-      compiledPixelShader = initShader(mPixelFile, false, macros);
+   if(loaded && !mPixelFile.isEmpty())
+      loaded = _loadShaderSource(mPixelFile, macros, pixSource);
+
+   // Program binaries are cached by a hash of everything that went into
+   // them, so a change to an include or a macro is a new program.  The
+   // hash and the source size are saved with the binary and checked on
+   // load, so a file left by a different program is never used.
+   String binaryFile;
+   U64 binaryKey = 0;
+   U32 binarySourceSize = 0;
+   bool linked = false;
+   if ( loaded && gCacheShaderBinaries && gglHasExtension(ARB_get_program_binary) )
+   {
+      const char *renderer = (const char*)glGetString( GL_RENDERER );
+      const char *version = (const char*)glGetString( GL_VERSION );
+      binaryKey = Torque::hash64( (const U8*)renderer, dStrlen( renderer ), 0 );
+      binaryKey = Torque::hash64( (const U8*)version, dStrlen( version ), binaryKey );
+      for ( U32 i = 0; i < vertSource.size(); i++ )
+      {
+         const U32 size = dStrlen( vertSource[i] );
+         binaryKey = Torque::hash64( (const U8*)vertSource[i], size, binaryKey );
+         binarySourceSize += size;
+      }
+      binaryKey = Torque::hash64( (const U8*)"|", 1, binaryKey );
+      for ( U32 i = 0; i < pixSource.size(); i++ )
+      {
+         const U32 size = dStrlen( pixSource[i] );
+         binaryKey = Torque::hash64( (const U8*)pixSource[i], size, binaryKey );
+         binarySourceSize += size;
+      }
+
+      binaryFile = String::ToString( "shadergen:/%08x%08x.glbin", (U32)( binaryKey >> 32 ), (U32)binaryKey );
+      linked = _loadProgramBinary( binaryFile, binaryKey, binarySourceSize );
+   }
+
+   // Default to the load result so we're "successful" if a vertex/pixel shader wasn't specified.
+   bool compiledVertexShader = loaded;
+   bool compiledPixelShader = loaded;
+   
+   // Compile the vertex and pixel shaders if specified.
+   if(loaded && !linked && !mVertexFile.isEmpty())
+      compiledVertexShader = initShader(mVertexFile, true, vertSource);
+
+   if(loaded && !linked && !mPixelFile.isEmpty())
+      compiledPixelShader = initShader(mPixelFile, false, pixSource);
+
+   // Cleanup the shader source buffers.
+   for ( U32 i=0; i < vertSource.size(); i++ )
+      dFree( vertSource[i] );
+   for ( U32 i=0; i < pixSource.size(); i++ )
+      dFree( pixSource[i] );
       
    // If either shader was present and failed to compile, bail.
    if(!compiledVertexShader || !compiledPixelShader)
       return false;
 
-   //bind vertex attributes
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Position,    "vPosition");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Normal,      "vNormal");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Color,       "vColor");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Tangent,     "vTangent");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TangentW,    "vTangentW");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Binormal,    "vBinormal");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord0,   "vTexCoord0");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord1,   "vTexCoord1");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord2,   "vTexCoord2");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord3,   "vTexCoord3");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord4,   "vTexCoord4");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord5,   "vTexCoord5");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord6,   "vTexCoord6");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord7,   "vTexCoord7");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord8,   "vTexCoord8");
-   glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord9,   "vTexCoord9");
-
-   //bind fragment out color
-   glBindFragDataLocation(mProgram, 0, "OUT_col");
-   glBindFragDataLocation(mProgram, 1, "OUT_col1");
-   glBindFragDataLocation(mProgram, 2, "OUT_col2");
-   glBindFragDataLocation(mProgram, 3, "OUT_col3");
-
-   // Link it!
-   glLinkProgram( mProgram );
-
-   GLint linkStatus;
-   glGetProgramiv( mProgram, GL_LINK_STATUS, &linkStatus );
-   
-   // Dump the info log to the console
-   U32 logLength = 0;
-   glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, (GLint*)&logLength);
-   if ( logLength )
+   if ( !linked )
    {
-      FrameAllocatorMarker fam;
-      char* log = (char*)fam.alloc( logLength );
-      glGetProgramInfoLog( mProgram, logLength, NULL, log );
-
-      if ( linkStatus == GL_FALSE )
+      //bind vertex attributes
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Position,    "vPosition");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Normal,      "vNormal");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Color,       "vColor");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Tangent,     "vTangent");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TangentW,    "vTangentW");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_Binormal,    "vBinormal");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord0,   "vTexCoord0");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord1,   "vTexCoord1");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord2,   "vTexCoord2");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord3,   "vTexCoord3");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord4,   "vTexCoord4");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord5,   "vTexCoord5");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord6,   "vTexCoord6");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord7,   "vTexCoord7");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord8,   "vTexCoord8");
+      glBindAttribLocation(mProgram, Torque::GL_VertexAttrib_TexCoord9,   "vTexCoord9");
+
+      //bind fragment out color
+      glBindFragDataLocation(mProgram, 0, "OUT_col");
+      glBindFragDataLocation(mProgram, 1, "OUT_col1");
+      glBindFragDataLocation(mProgram, 2, "OUT_col2");
+      glBindFragDataLocation(mProgram, 3, "OUT_col3");
+
+      // Ask for a binary we can save before linking.
+      if ( binaryFile.isNotEmpty() )
+         glProgramParameteri( mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+
+      // Link it!
+      glLinkProgram( mProgram );
+
+      GLint linkStatus;
+      glGetProgramiv( mProgram, GL_LINK_STATUS, &linkStatus );
+   
+      // Dump the info log to the console
+      U32 logLength = 0;
+      glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, (GLint*)&logLength);
+      if ( logLength )
       {
-         if ( smLogErrors )
+         FrameAllocatorMarker fam;
+         char* log = (char*)fam.alloc( logLength );
+         glGetProgramInfoLog( mProgram, logLength, NULL, log );
+
+         if ( linkStatus == GL_FALSE )
+         {
+            if ( smLogErrors )
+            {
+               Con::errorf( "GFXGLShader::init - Error linking shader!" );
+               Con::errorf( "Program %s / %s: %s", 
+                   mVertexFile.getFullPath().c_str(), mPixelFile.getFullPath().c_str(), log);
+            }
+         }
+         else if ( smLogWarnings )
          {
-            Con::errorf( "GFXGLShader::init - Error linking shader!" );
-            Con::errorf( "Program %s / %s: %s", 
+            Con::warnf( "Program %s / %s: %s", 
                 mVertexFile.getFullPath().c_str(), mPixelFile.getFullPath().c_str(), log);
          }
       }
-      else if ( smLogWarnings )
-      {
-         Con::warnf( "Program %s / %s: %s", 
-             mVertexFile.getFullPath().c_str(), mPixelFile.getFullPath().c_str(), log);
-      }
-   }
 
-   // If we failed to link, bail.
-   if ( linkStatus == GL_FALSE )
-      return false;
+      // If we failed to link, bail.
+      if ( linkStatus == GL_FALSE )
+         return false;
+
+      if ( binaryFile.isNotEmpty() )
+         _saveProgramBinary( binaryFile, binaryKey, binarySourceSize );
+   }
 
    initConstantDescs();   
    initHandles();
@@ -505,6 +565,70 @@ bool GFXGLShader::_init()
    return true;
 }
 
+bool GFXGLShader::_loadProgramBinary( const String &cacheFile, U64 key, U32 sourceSize )
+{
+   PROFILE_SCOPE( GFXGLShader_LoadProgramBinary );
+
+   FileStream stream;
+   if ( !Torque::FS::IsFile( cacheFile ) || !stream.open( cacheFile, Torque::FS::File::Read ) )
+      return false;
+
+   U64 savedKey = 0;
+   U32 savedSourceSize = 0;
+   stream.read( &savedKey );
+   stream.read( &savedSourceSize );
+   if ( savedKey != key || savedSourceSize != sourceSize )
+      return false;
+
+   U32 format = 0;
+   U32 length = 0;
+   stream.read( &format );
+   stream.read( &length );
+   if ( stream.getStatus() != Stream::Ok || length == 0 || length > stream.getStreamSize() )
+      return false;
+
+   U8 *data = (U8*)dMalloc( length );
+   const bool read = stream.read( length, data );
+   if ( read )
+      glProgramBinary( mProgram, format, data, length );
+   dFree( data );
+
+   if ( !read )
+      return false;
+
+   // The driver rejects binaries saved by another driver
+   // version, in which case we just compile it again.
+   GLint linkStatus = GL_FALSE;
+   glGetProgramiv( mProgram, GL_LINK_STATUS, &linkStatus );
+   return linkStatus != GL_FALSE;
+}
+
+void GFXGLShader::_saveProgramBinary( const String &cacheFile, U64 key, U32 sourceSize )
+{
+   PROFILE_SCOPE( GFXGLShader_SaveProgramBinary );
+
+   GLint length = 0;
+   glGetProgramiv( mProgram, GL_PROGRAM_BINARY_LENGTH, &length );
+   if ( length <= 0 )
+      return;
+
+   U8 *data = (U8*)dMalloc( length );
+   GLenum format = 0;
+   glGetProgramBinary( mProgram, length, NULL, &format, data );
+
+   FileStream stream;
+   if ( stream.open( cacheFile, Torque::FS::File::Write ) )
+   {
+      stream.write( key );
+      stream.write( sourceSize );
+      stream.write( (U32)format );
+      stream.write( (U32)length );
+      stream.write( length, data );
+   }
+
+   dFree( data );
+}
+
 void GFXGLShader::initConstantDescs()
 {
    mConstants.clear();
@@ -939,12 +1063,22 @@ char* GFXGLShader::_handleIncludes( const Torque::Path& path, FileStream *s )
    return buffer;
 }
 
-bool GFXGLShader::_loadShaderFromStream(  GLuint shader, 
-                                          const Torque::Path &path, 
-                                          FileStream *s, 
-                                          const Vector<GFXShaderMacro> &macros )
+bool GFXGLShader::_loadShaderSource(  const Torque::Path &path, 
+                                       const Vector<GFXShaderMacro> &macros,
+                                       Vector<char*> &buffers )
 {
-   Vector<char*> buffers;
+   FileStream stream;
+   if ( !stream.open( path, Torque::FS::File::Read ) )
+   {
+      AssertISV(false, avar("GFXGLShader::initShader - failed to open shader '%s'.", path.getFullPath().c_str()));
+
+      if ( smLogErrors )
+         Con::errorf( "GFXGLShader::initShader - Failed to open shader file '%s'.", 
+            path.getFullPath().c_str() );
+
+      return false;
+   }
+
    Vector<U32> lengths;
    
    // The GLSL version declaration must go first!
@@ -982,39 +1116,36 @@ bool GFXGLShader::_loadShaderFromStream(  GLuint shader,
    }
    
    // Now finally add the shader source.
-   U32 shaderLen = s->getStreamSize();
-   char *buffer = _handleIncludes(path, s);
+   U32 shaderLen = stream.getStreamSize();
+   char *buffer = _handleIncludes(path, &stream);
    if ( !buffer )
+   {
+      for ( U32 i=0; i < buffers.size(); i++ )
+         dFree( buffers[i] );
+      buffers.clear();
       return false;
+   }
    
    buffers.push_back(buffer);
    lengths.push_back(shaderLen);
-   
-   glShaderSource(shader, buffers.size(), (const GLchar**)const_cast<const char**>(buffers.address()), NULL);
 
 #if defined(TORQUE_DEBUG) && defined(TORQUE_DEBUG_GFX)
-   FileStream stream;
-   if ( !stream.open( path.getFullPath()+"_DEBUG", Torque::FS::File::Write ) )
+   FileStream debugStream;
+   if ( !debugStream.open( path.getFullPath()+"_DEBUG", Torque::FS::File::Write ) )
    {
       AssertISV(false, avar("GFXGLShader::initShader - failed to write debug shader '%s'.", path.getFullPath().c_str()));
    }
 
    for(int i = 0; i < buffers.size(); ++i)
-         stream.writeText(buffers[i]);
+         debugStream.writeText(buffers[i]);
 #endif
 
-   // Cleanup the shader source buffer.
-   for ( U32 i=0; i < buffers.size(); i++ )
-      dFree( buffers[i] );
-
-   glCompileShader(shader);
-
    return true;
 }
 
 bool GFXGLShader::initShader( const Torque::Path &file, 
                               bool isVertex, 
-                              const Vector<GFXShaderMacro> &macros )
+                              const Vector<char*> &source )
 {
    GLuint activeShader = glCreateShader(isVertex ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER);
    if(isVertex)
@@ -1023,22 +1154,8 @@ bool GFXGLShader::initShader( const Torque::Path &file,
       mPixelShader = activeShader;
    glAttachShader(mProgram, activeShader);
    
-   
-   // Ok it's not in the shader gen manager, so ask Torque for it
-   FileStream stream;
-   if ( !stream.open( file, Torque::FS::File::Read ) )
-   {
-      AssertISV(false, avar("GFXGLShader::initShader - failed to open shader '%s'.", file.getFullPath().c_str()));
-
-      if ( smLogErrors )
-         Con::errorf( "GFXGLShader::initShader - Failed to open shader file '%s'.", 
-            file.getFullPath().c_str() );
-
-      return false;
-   }
-   
-   if ( !_loadShaderFromStream( activeShader, file, &stream, macros ) )
-      return false;
+   glShaderSource(activeShader, source.size(), (const GLchar**)const_cast<char**>(source.address()), NULL);
+   glCompileShader(activeShader);
    
    GLint compile;
    glGetShaderiv(activeShader, GL_COMPILE_STATUS, &compile);
@@ -74,7 +74,14 @@ protected:
 
    bool initShader(  const Torque::Path &file, 
                      bool isVertex, 
-                     const Vector<GFXShaderMacro> &macros );
+                     const Vector<char*> &source );
+
+   /// Loads a program binary saved by an earlier run of the same source.
+   /// Fails if the key and source size saved with it don't match.
+   bool _loadProgramBinary( const String &cacheFile, U64 key, U32 sourceSize );
+
+   /// Saves the linked program so the next run can skip compiling it.
+   void _saveProgramBinary( const String &cacheFile, U64 key, U32 sourceSize );
 
    void clearShaders();
    void initConstantDescs();
@@ -83,10 +90,11 @@ protected:
    
    static char* _handleIncludes( const Torque::Path &path, FileStream *s );
 
-   static bool _loadShaderFromStream(  GLuint shader, 
-                                       const Torque::Path& path, 
-                                       FileStream* s, 
-                                       const Vector<GFXShaderMacro>& macros );
+   /// Reads the shader with its includes and macros into the source
+   /// buffers that are handed to the compiler.
+   static bool _loadShaderSource(   const Torque::Path& path, 
+                                    const Vector<GFXShaderMacro>& macros,
+                                    Vector<char*> &outSource );
 
    /// @name Internal GL handles
    /// @{
@@ -0,0 +1,145 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/gfxTextureManager.h"
+#include "gfx/gfxTextureHandle.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "core/stream/fileStream.h"
+
+/// Loads a 16x8 png through the texture manager of the Null
+/// device, which keeps the sizes of the textures it creates.
+FIXTURE(GFXTextureManagerAsync)
+{
+public:
+   bool hasNullDevice;
+   bool savedAsyncLoading;
+   Vector<String> paths;
+
+   void SetUp()
+   {
+      hasNullDevice = GFXDevice::get() && GFX->getAdapterType() == NullDevice;
+      if ( !hasNullDevice )
+         return;
+
+      savedAsyncLoading = Con::getBoolVariable( "$pref::Video::asyncTextureLoading" );
+      Con::setBoolVariable( "$pref::Video::asyncTextureLoading", true );
+   }
+
+   void TearDown()
+   {
+      if ( !hasNullDevice )
+         return;
+
+      TEXMGR->processAsyncLoads( true );
+      Con::setBoolVariable( "$pref::Video::asyncTextureLoading", savedAsyncLoading );
+
+      for ( U32 i = 0; i < paths.size(); i++ )
+         dFileDelete( paths[i] );
+   }
+
+   /// Writes a texture file under a name of its own, so that
+   /// no test finds a texture cached by another.
+   String writeTexture( const char *name )
+   {
+      const String path = String::ToString( "gfxTextureManagerTest_%s.png", name );
+
+      GBitmap bitmap( 16, 8, false, GFXFormatR8G8B8A8 );
+      bitmap.fill( ColorI( 255, 0, 0 ) );
+
+      FileStream stream;
+      EXPECT_TRUE( stream.open( path, Torque::FS::File::Write ) );
+      EXPECT_TRUE( bitmap.writeBitmap( "png", stream ) );
+      stream.close();
+
+      paths.push_back( path );
+      return path;
+   }
+};
+
+TEST_FIX(GFXTextureManagerAsync, PlaceholderThenUpload)
+{
+   if ( !hasNullDevice )
+      return;
+
+   const String path = writeTexture( "upload" );
+
+   GFXTexHandle tex;
+   ASSERT_TRUE( tex.setAsync( path, &GFXDefaultStaticDiffuseProfile, "PlaceholderThenUpload" ) );
+
+   // Nothing is uploaded until the main thread processes the loads.
+   EXPECT_TRUE( TEXMGR->isAsyncLoadPending( tex ) );
+   EXPECT_EQ( 4u, tex->getBitmapWidth() );
+   EXPECT_EQ( 4u, tex->getBitmapHeight() );
+
+   TEXMGR->processAsyncLoads( true );
+   EXPECT_FALSE( TEXMGR->isAsyncLoadPending( tex ) );
+   EXPECT_EQ( 16u, tex->getBitmapWidth() );
+   EXPECT_EQ( 8u, tex->getBitmapHeight() );
+}
+
+TEST_FIX(GFXTextureManagerAsync, RequestsShareOneLoad)
+{
+   if ( !hasNullDevice )
+      return;
+
+   const String path = writeTexture( "shared" );
+
+   GFXTexHandle first, second;
+   first.setAsync( path, &GFXDefaultStaticDiffuseProfile, "RequestsShareOneLoad" );
+   second.setAsync( path, &GFXDefaultStaticDiffuseProfile, "RequestsShareOneLoad" );
+   ASSERT_TRUE( first.isValid() );
+   EXPECT_TRUE( first.getPointer() == second.getPointer() );
+
+   // Uploading the one load finishes both.
+   TEXMGR->processAsyncLoads( true );
+   EXPECT_FALSE( TEXMGR->hasAsyncLoads() );
+   EXPECT_EQ( 16u, second->getBitmapWidth() );
+}
+
+TEST_FIX(GFXTextureManagerAsync, SyncCreateFinishesLoad)
+{
+   if ( !hasNullDevice )
+      return;
+
+   const String path = writeTexture( "sync" );
+
+   GFXTexHandle pending;
+   pending.setAsync( path, &GFXDefaultStaticDiffuseProfile, "SyncCreateFinishesLoad" );
+   ASSERT_TRUE( TEXMGR->isAsyncLoadPending( pending ) );
+
+   // The synchronous caller gets the same object, loaded.
+   GFXTexHandle loaded( path, &GFXDefaultStaticDiffuseProfile, "SyncCreateFinishesLoad" );
+   EXPECT_TRUE( loaded.getPointer() == pending.getPointer() );
+   EXPECT_FALSE( TEXMGR->isAsyncLoadPending( pending ) );
+   EXPECT_EQ( 16u, pending->getBitmapWidth() );
+   EXPECT_EQ( 8u, pending->getBitmapHeight() );
+}
+
+TEST_FIX(GFXTextureManagerAsync, MissingFileIsNull)
+{
+   if ( !hasNullDevice )
+      return;
+
+   GFXTexHandle tex;
+   EXPECT_FALSE( tex.setAsync( "gfxTextureManagerTest_missing.png", &GFXDefaultStaticDiffuseProfile, "MissingFileIsNull" ) );
+   EXPECT_FALSE( TEXMGR->hasAsyncLoads() );
+}
+
+TEST_FIX(GFXTextureManagerAsync, DisabledLoadsRightAway)
+{
+   if ( !hasNullDevice )
+      return;
+
+   Con::setBoolVariable( "$pref::Video::asyncTextureLoading", false );
+
+   const String path = writeTexture( "disabled" );
+
+   GFXTexHandle tex;
+   ASSERT_TRUE( tex.setAsync( path, &GFXDefaultStaticDiffuseProfile, "DisabledLoadsRightAway" ) );
+   EXPECT_FALSE( TEXMGR->isAsyncLoadPending( tex ) );
+   EXPECT_EQ( 16u, tex->getBitmapWidth() );
+}
+
+#endif
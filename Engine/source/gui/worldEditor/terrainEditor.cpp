@@ -1982,6 +1982,10 @@ bool checkTerrainBlock(TerrainEditor * object, const char * funcName)
 
 void TerrainEditor::attachTerrain(TerrainBlock *terrBlock)
 {
+   // Editing needs the whole file and not just
+   // the streamed tiles around the camera.
+   terrBlock->getFile()->makeResident();
+
    mActiveTerrain = terrBlock;
    mTerrainBlocks.push_back_unique(terrBlock);
 }
@@ -186,6 +186,10 @@ public:
    // BTRTODO: This stuff below should probably not be in BaseMatInstance
    virtual bool hasGlow() = 0;
    virtual bool hasAccumulation() = 0;
+
+   /// Returns true if the material is rendering with fallback
+   /// shaders and should be reinitialized once ShaderGen is done.
+   virtual bool hasPendingShaders() const = 0;
    
    virtual U32 getCurPass() = 0;
 
@@ -503,6 +503,14 @@ bool MatInstance::hasGlow()
       return false;
 }
 
+bool MatInstance::hasPendingShaders() const
+{
+   if( mProcessedMaterial )
+      return mProcessedMaterial->hasPendingShaders();
+   else
+      return false;
+}
+
 bool MatInstance::hasAccumulation() 
 { 
    if( mProcessedMaterial )
@@ -76,6 +76,7 @@ public:
    virtual Material *getMaterial() { return mMaterial; }
    virtual bool hasGlow();
    virtual bool hasAccumulation();
+   virtual bool hasPendingShaders() const;
    virtual U32 getCurPass() { return getMax( mCurPass, 0 ); }
    virtual U32 getCurStageNum();
    virtual RenderPassData *getPass(U32 pass);   
@@ -327,6 +327,38 @@ void MaterialManager::flushAndReInitInstances()
       (*iter)->reInit();
 }
 
+void MaterialManager::_reInitPendingInstances()
+{
+   PROFILE_SCOPE( MaterialManager_ReInitPendingInstances );
+
+   // Delete the hooks first as they are material instances
+   // themselves, the same as flushAndReInitInstances() does.
+   Vector<BaseMatInstance*>::iterator iter = mMatInstanceList.begin();
+   while ( iter != mMatInstanceList.end() )
+   {
+      if ( (*iter)->hasPendingShaders() && (*iter)->deleteAllHooks() != 0 )
+      {
+         // Restart the loop.
+         iter = mMatInstanceList.begin();
+         continue;
+      }
+
+      iter++;
+   }
+
+   Vector<BaseMatInstance*> pending;
+   for ( iter = mMatInstanceList.begin(); iter != mMatInstanceList.end(); iter++ )
+   {
+      if ( (*iter)->hasPendingShaders() )
+         pending.push_back( *iter );
+   }
+
+   // Their shaders are ready now so this swaps
+   // out the fallbacks for the real thing.
+   for ( U32 i = 0; i < pending.size(); i++ )
+      pending[i]->reInit();
+}
+
 // Used in the materialEditor. This flushes the material preview object so it can be reloaded easily.
 void MaterialManager::flushInstance( BaseMaterialDefinition *target )
 {
@@ -445,6 +477,8 @@ bool MaterialManager::_handleGFXEvent( GFXDevice::GFXDeviceEventType event_ )
       case GFXDevice::deStartOfFrame:
          if ( mFlushAndReInit )
             flushAndReInitInstances();
+         else if ( SHADERGEN->processDeferredShaders() > 0 && !SHADERGEN->hasDeferredShaders() )
+            _reInitPendingInstances();
          break;
 
       default:
@@ -132,6 +132,10 @@ protected:
 
    bool _handleGFXEvent(GFXDevice::GFXDeviceEventType event);
 
+   /// Reinitializes the instances rendering with fallback
+   /// shaders once ShaderGen has finished the queued ones.
+   void _reInitPendingInstances();
+
    SimSet* mMaterialSet;
    Vector<BaseMatInstance*> mMatInstanceList;
 
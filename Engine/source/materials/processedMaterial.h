@@ -200,6 +200,10 @@ public:
    /// Returns true if any pass accumulates
    bool hasAccumulation() const { return mHasAccumulation; }
 
+   /// Returns true if any pass renders with a fallback
+   /// shader while its real one is being generated.
+   bool hasPendingShaders() const { return mHasPendingShaders; }
+
    /// Gets the stage number for a pass
    U32 getStageFromPass(U32 pass) const
    {
@@ -250,6 +254,9 @@ protected:
    /// If we have accumulation.
    bool mHasAccumulation;
 
+   /// If a pass is waiting on ShaderGen.
+   bool mHasPendingShaders;
+
    /// Number of stages (not to be confused with number of passes)
    U32 mMaxStages;
 
@@ -283,6 +290,10 @@ protected:
    /// Loads the texture located at _getTexturePath(filename) and gives it the specified profile
    GFXTexHandle _createTexture( const char *filename, GFXTextureProfile *profile );
 
+   /// Like _createTexture(), but the texture may hold a placeholder until it is
+   /// loaded.  Not for textures whose format or contents pick shader features.
+   GFXTexHandle _createTextureAsync( const char *filename, GFXTextureProfile *profile );
+
    /// @name State blocks
    ///
    /// @{
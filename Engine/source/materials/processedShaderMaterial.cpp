@@ -652,7 +652,30 @@ bool ProcessedShaderMaterial::_addPass( ShaderRenderPassData &rpd,
 
    // Generate shader
    GFXShader::setLogging( true, true );
-   rpd.shader = SHADERGEN->getShader( rpd.mFeatureData, mVertexFormat, &mUserMacros, samplers );
+   bool pending = false;
+   rpd.shader = SHADERGEN->getShader( rpd.mFeatureData, mVertexFormat, &mUserMacros, samplers, &pending );
+   if ( pending )
+   {
+      // While ShaderGen works on the real shader we render without the
+      // features the quality prefs are allowed to turn off.  Unused
+      // constants and samplers just get invalid handles.
+      MaterialFeatureData fallbackData( rpd.mFeatureData );
+      fallbackData.features.removeFeature( MFT_NormalMap );
+      fallbackData.features.removeFeature( MFT_SpecularMap );
+      fallbackData.features.removeFeature( MFT_PixSpecular );
+      fallbackData.features.removeFeature( MFT_CubeMap );
+      fallbackData.features.removeFeature( MFT_Parallax );
+
+      // The fallback is only worth it if it's ready, otherwise
+      // wait for the real shader as before.
+      if ( fallbackData.features != rpd.mFeatureData.features )
+         rpd.shader = SHADERGEN->getCachedShader( fallbackData, mVertexFormat, &mUserMacros, samplers );
+
+      if ( rpd.shader )
+         mHasPendingShaders = true;
+      else
+         rpd.shader = SHADERGEN->getShader( rpd.mFeatureData, mVertexFormat, &mUserMacros, samplers );
+   }
    if( !rpd.shader )
       return false;
    rpd.shaderHandles.init( rpd.shader );   
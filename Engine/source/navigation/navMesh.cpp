@@ -47,6 +47,8 @@ IMPLEMENT_CO_NETOBJECT_V1(NavMesh);
 
 const U32 NavMesh::mMaxVertsPerPoly = 3;
 
+S32 NavMesh::smMaxTileBuilds = 32;
+
 SimObjectPtr<SimSet> NavMesh::smServerSet = NULL;
 
 ImplementEnumType(NavMeshWaterMethod,
@@ -168,6 +170,7 @@ NavMesh::NavMesh()
    mMergeRegionArea = 20;
    mTileSize = 10.0f;
    mMaxPolysPerTile = 128;
+   mThreadedBuild = false;
 
    mSmallCharacters = false;
    mRegularCharacters = true;
@@ -305,12 +308,21 @@ void NavMesh::initPersistFields()
       "Any regions with a span count smaller than this value will, if possible, be merged with larger regions.");
    addFieldV("maxPolysPerTile", TypeS32, Offset(mMaxPolysPerTile, NavMesh), &NaturalNumber,
       "The maximum number of polygons allowed in a tile.");
+   addField("threadedBuild", TypeBool, Offset(mThreadedBuild, NavMesh),
+      "Build dirty tiles concurrently on worker threads instead of one tile per tick.");
 
    endGroup("NavMesh Advanced Options");
 
    Parent::initPersistFields();
 }
 
+void NavMesh::consoleInit()
+{
+   Con::addVariable("$NavMesh::maxTileBuilds", TypeS32, &smMaxTileBuilds,
+      "Maximum number of tiles a NavMesh with threadedBuild set will build concurrently.\n"
+      "Limits the amount of geometry gathered ahead of the worker threads.");
+}
+
 bool NavMesh::onAdd()
 {
    if(!Parent::onAdd())
@@ -345,6 +357,8 @@ bool NavMesh::onAdd()
 
 void NavMesh::onRemove()
 {
+   cancelTileBuilds();
+
    if(getEventManager())
       getEventManager()->postEvent("NavMeshRemoved", getIdString());
 
@@ -622,8 +636,13 @@ bool NavMesh::build(bool background, bool saveIntermediates)
 
    if(!background)
    {
-      while(!mDirtyTiles.empty())
-         buildNextTile();
+      if(mThreadedBuild)
+         buildTilesThreaded(true);
+      else
+      {
+         while(!mDirtyTiles.empty())
+            buildNextTile();
+      }
    }
 
    return true;
@@ -638,6 +657,7 @@ DefineEngineMethod(NavMesh, build, bool, (bool background, bool save), (true, fa
 void NavMesh::cancelBuild()
 {
    while(!mDirtyTiles.empty()) mDirtyTiles.pop();
+   cancelTileBuilds();
    ctx->stopTimer(RC_TIMER_TOTAL);
    mBuilding = false;
 }
@@ -751,7 +771,10 @@ void NavMesh::updateTiles(bool dirty)
 
 void NavMesh::processTick(const Move *move)
 {
-   buildNextTile();
+   if(mThreadedBuild)
+      buildTilesThreaded(false);
+   else
+      buildNextTile();
 }
 
 void NavMesh::buildNextTile()
@@ -769,45 +792,180 @@ void NavMesh::buildNextTile()
       U32 dataSize = 0;
       unsigned char* data = buildTileData(tile, tdata, dataSize);
       if(data)
-      {
-         // Remove any previous data.
-         nm->removeTile(nm->getTileRefAt(tile.x, tile.y, 0), 0, 0);
-         // Add new data (navmesh owns and deletes the data).
-         dtStatus status = nm->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, 0);
-         int success = 1;
-         if(dtStatusFailed(status))
-         {
-            success = 0;
-            dtFree(data);
-         }
-         if(getEventManager())
-         {
-            String str = String::ToString("%d %d %d (%d, %d) %d %.3f %s",
-               getId(),
-               i, mTiles.size(),
-               tile.x, tile.y,
-               success,
-               ctx->getAccumulatedTime(RC_TIMER_TOTAL) / 1000.0f,
-               castConsoleTypeToString(tile.box));
-            getEventManager()->postEvent("NavMeshTileUpdate", str.c_str());
-            setMaskBits(LoadFlag);
-         }
-      }
+         addTileData(i, data, dataSize);
       // Did we just build the last tile?
       if(mDirtyTiles.empty())
+         finishBuild();
+   }
+}
+
+//-----------------------------------------------------------------------------
+// NavMesh::TileBuildItem
+//-----------------------------------------------------------------------------
+
+/// Builds the navmesh data for a single tile on a ThreadPool worker. All the
+/// input is captured on the main thread before the item is started, and the
+/// result is handed to the dtNavMesh once the main thread collects it.
+///
+/// Being a task set of its own lets a NavMesh wait for just its own tiles,
+/// running any that no worker has picked up yet on the main thread.
+struct NavMesh::TileBuildItem : public ThreadPoolTaskSet
+{
+   typedef ThreadPoolTaskSet Parent;
+
+   /// Index of the tile in NavMesh::mTiles.
+   U32 mIndex;
+
+   /// Build input.
+   TileBuildParams mParams;
+
+   /// Input geometry and intermediate data.
+   TileData mData;
+
+   /// Generated navmesh data, or NULL if the build failed.
+   unsigned char *mNavData;
+   U32 mNavDataSize;
+
+   /// Reason the build failed, if it did.
+   String mError;
+
+   TileBuildItem(U32 index)
+      : Parent(1),
+        mIndex(index),
+        mNavData(NULL),
+        mNavDataSize(0)
+   {
+   }
+
+   ~TileBuildItem()
+   {
+      // Only still set if nobody took ownership of the data.
+      dtFree(mNavData);
+   }
+
+protected:
+   virtual void runTask(U32)
+   {
+      // Recast contexts are not thread-safe, so each build gets its own
+      // with logging and timers disabled.
+      rcContext ctx(false);
+      mNavData = buildTileMesh(mParams, mData, mNavDataSize, &ctx, mError);
+   }
+};
+
+void NavMesh::buildTilesThreaded(bool wait)
+{
+   if(mDirtyTiles.empty() && mTileBuilds.empty())
+      return;
+
+   // Hand finished tiles to the navmesh.
+   for(U32 i = 0; i < mTileBuilds.size();)
+   {
+      TileBuildItemRef item = mTileBuilds[i];
+      if(!item->isDone())
+      {
+         i++;
+         continue;
+      }
+      mTileBuilds.erase(i);
+
+      if(item->mError.isNotEmpty())
+         Con::errorf("%s for NavMesh %s", item->mError.c_str(), getIdString());
+      if(item->mNavData)
       {
-         ctx->stopTimer(RC_TIMER_TOTAL);
-         if(getEventManager())
+         // The navmesh takes ownership of the data.
+         addTileData(item->mIndex, item->mNavData, item->mNavDataSize);
+         item->mNavData = NULL;
+      }
+      if(mSaveIntermediates && item->mIndex < mTileData.size())
+         mTileData[item->mIndex].swap(item->mData);
+   }
+
+   // Issue builds for dirty tiles. Geometry is gathered here, on the main
+   // thread, so workers never touch live SceneObjects.
+   while(!mDirtyTiles.empty() && (wait || mTileBuilds.size() < smMaxTileBuilds))
+   {
+      U32 i = mDirtyTiles.front();
+      mDirtyTiles.pop();
+
+      // A tile that is dirtied again while being built must not have the
+      // old result applied over the new one.
+      for(U32 j = 0; j < mTileBuilds.size(); j++)
+      {
+         if(mTileBuilds[j]->mIndex == i)
          {
-            String str = String::ToString("%d %.3f", getId(), ctx->getAccumulatedTime(RC_TIMER_TOTAL) / 1000.0f);
-            getEventManager()->postEvent("NavMeshUpdate", str.c_str());
-            setMaskBits(LoadFlag);
+            mTileBuilds[j]->cancel();
+            mTileBuilds.erase(j);
+            break;
          }
-         mBuilding = false;
       }
+
+      TileBuildItemRef item(new TileBuildItem(i));
+      prepareTileBuild(mTiles[i], item->mParams, item->mData);
+      mTileBuilds.push_back(item);
+      item->start();
+   }
+
+   if(wait && mTileBuilds.size())
+   {
+      // Only our own builds; other users of the pool keep running.
+      for(U32 i = 0; i < mTileBuilds.size(); i++)
+         mTileBuilds[i]->wait();
+      buildTilesThreaded(false);
+      return;
+   }
+
+   // Did we just build the last tile?
+   if(mDirtyTiles.empty() && mTileBuilds.empty())
+      finishBuild();
+}
+
+void NavMesh::cancelTileBuilds()
+{
+   for(U32 i = 0; i < mTileBuilds.size(); i++)
+      mTileBuilds[i]->cancel();
+   mTileBuilds.clear();
+}
+
+void NavMesh::addTileData(U32 index, unsigned char *data, U32 dataSize)
+{
+   const Tile &tile = mTiles[index];
+   // Remove any previous data.
+   nm->removeTile(nm->getTileRefAt(tile.x, tile.y, 0), 0, 0);
+   // Add new data (navmesh owns and deletes the data).
+   dtStatus status = nm->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, 0);
+   int success = 1;
+   if(dtStatusFailed(status))
+   {
+      success = 0;
+      dtFree(data);
+   }
+   if(getEventManager())
+   {
+      String str = String::ToString("%d %d %d (%d, %d) %d %.3f %s",
+         getId(),
+         index, mTiles.size(),
+         tile.x, tile.y,
+         success,
+         ctx->getAccumulatedTime(RC_TIMER_TOTAL) / 1000.0f,
+         castConsoleTypeToString(tile.box));
+      getEventManager()->postEvent("NavMeshTileUpdate", str.c_str());
+      setMaskBits(LoadFlag);
    }
 }
 
+void NavMesh::finishBuild()
+{
+   ctx->stopTimer(RC_TIMER_TOTAL);
+   if(getEventManager())
+   {
+      String str = String::ToString("%d %.3f", getId(), ctx->getAccumulatedTime(RC_TIMER_TOTAL) / 1000.0f);
+      getEventManager()->postEvent("NavMeshUpdate", str.c_str());
+      setMaskBits(LoadFlag);
+   }
+   mBuilding = false;
+}
+
 static void buildCallback(SceneObject* object,void *key)
 {
    SceneContainer::CallbackInfo* info = reinterpret_cast<SceneContainer::CallbackInfo*>(key);
@@ -816,6 +974,32 @@ static void buildCallback(SceneObject* object,void *key)
 
 unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dataSize)
 {
+   TileBuildParams params;
+   prepareTileBuild(tile, params, data);
+
+   String error;
+   unsigned char *navData = buildTileMesh(params, data, dataSize, ctx, error);
+   if(error.isNotEmpty())
+      Con::errorf("%s for NavMesh %s", error.c_str(), getIdString());
+   return navData;
+}
+
+void NavMesh::prepareTileBuild(const Tile &tile, TileBuildParams &params, TileData &data)
+{
+   params.tile = tile;
+   params.cfg = cfg;
+   params.waterMethod = mWaterMethod;
+   params.walkableHeight = mWalkableHeight;
+   params.walkableRadius = mWalkableRadius;
+   params.walkableClimb = mWalkableClimb;
+
+   params.linkVerts = mLinkVerts;
+   params.linkRads = mLinkRads;
+   params.linkDirs = mLinkDirs;
+   params.linkAreas = mLinkAreas;
+   params.linkFlags = mLinkFlags;
+   params.linkIDs = mLinkIDs;
+
    // Push out tile boundaries a bit.
    F32 tileBmin[3], tileBmax[3];
    rcVcopy(tileBmin, tile.bmin);
@@ -835,16 +1019,32 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    getContainer()->findObjects(box, StaticShapeObjectType | TerrainObjectType, buildCallback, &info);
 
    // Parse water objects into the same list, but remember how much geometry was /not/ water.
-   U32 nonWaterVertCount = data.geom.getVertCount();
-   U32 nonWaterTriCount = data.geom.getTriCount();
+   params.nonWaterVertCount = data.geom.getVertCount();
+   params.nonWaterTriCount = data.geom.getTriCount();
    if(mWaterMethod != Ignore)
    {
       getContainer()->findObjects(box, WaterObjectType, buildCallback, &info);
    }
+}
+
+unsigned char *NavMesh::buildTileMesh(const TileBuildParams &params, TileData &data,
+   U32 &dataSize, rcContext *ctx, String &error)
+{
+   const Tile &tile = params.tile;
+   const rcConfig &cfg = params.cfg;
 
    // Check for no geometry.
    if(!data.geom.getVertCount())
-      return false;
+      return NULL;
+
+   // Push out tile boundaries a bit.
+   F32 tileBmin[3], tileBmax[3];
+   rcVcopy(tileBmin, tile.bmin);
+   rcVcopy(tileBmax, tile.bmax);
+   tileBmin[0] -= cfg.borderSize * cfg.cs;
+   tileBmin[2] -= cfg.borderSize * cfg.cs;
+   tileBmax[0] += cfg.borderSize * cfg.cs;
+   tileBmax[2] += cfg.borderSize * cfg.cs;
 
    // Figure out voxel dimensions of this tile.
    U32 width = 0, height = 0;
@@ -855,25 +1055,25 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    data.hf = rcAllocHeightfield();
    if(!data.hf)
    {
-      Con::errorf("Out of memory (rcHeightField) for NavMesh %s", getIdString());
+      error = "Out of memory (rcHeightField)";
       return NULL;
    }
    if(!rcCreateHeightfield(ctx, *data.hf, width, height, tileBmin, tileBmax, cfg.cs, cfg.ch))
    {
-      Con::errorf("Could not generate rcHeightField for NavMesh %s", getIdString());
+      error = "Could not generate rcHeightField";
       return NULL;
    }
 
    unsigned char *areas = new unsigned char[data.geom.getTriCount()];
    if(!areas)
    {
-      Con::errorf("Out of memory (area flags) for NavMesh %s", getIdString());
+      error = "Out of memory (area flags)";
       return NULL;
    }
    dMemset(areas, 0, data.geom.getTriCount() * sizeof(unsigned char));
 
    // Mark walkable triangles with the appropriate area flags, and rasterize.
-   if(mWaterMethod == Solid)
+   if(params.waterMethod == Solid)
    {
       // Treat water as solid: i.e. mark areas as walkable based on angle.
       rcMarkWalkableTriangles(ctx, cfg.walkableSlopeAngle,
@@ -884,8 +1084,8 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    {
       // Treat water as impassable: leave all area flags 0.
       rcMarkWalkableTriangles(ctx, cfg.walkableSlopeAngle,
-         data.geom.getVerts(), nonWaterVertCount,
-         data.geom.getTris(), nonWaterTriCount, areas);
+         data.geom.getVerts(), params.nonWaterVertCount,
+         data.geom.getTris(), params.nonWaterTriCount, areas);
    }
    rcRasterizeTriangles(ctx,
       data.geom.getVerts(), data.geom.getVertCount(),
@@ -902,17 +1102,17 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    data.chf = rcAllocCompactHeightfield();
    if(!data.chf)
    {
-      Con::errorf("Out of memory (rcCompactHeightField) for NavMesh %s", getIdString());
+      error = "Out of memory (rcCompactHeightField)";
       return NULL;
    }
    if(!rcBuildCompactHeightfield(ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf, *data.chf))
    {
-      Con::errorf("Could not generate rcCompactHeightField for NavMesh %s", getIdString());
+      error = "Could not generate rcCompactHeightField";
       return NULL;
    }
    if(!rcErodeWalkableArea(ctx, cfg.walkableRadius, *data.chf))
    {
-      Con::errorf("Could not erode walkable area for NavMesh %s", getIdString());
+      error = "Could not erode walkable area";
       return NULL;
    }
 
@@ -927,7 +1127,7 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    {
       if(!rcBuildRegionsMonotone(ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
       {
-         Con::errorf("Could not build regions for NavMesh %s", getIdString());
+         error = "Could not build regions";
          return NULL;
       }
    }
@@ -935,12 +1135,12 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    {
       if(!rcBuildDistanceField(ctx, *data.chf))
       {
-         Con::errorf("Could not build distance field for NavMesh %s", getIdString());
+         error = "Could not build distance field";
          return NULL;
       }
       if(!rcBuildRegions(ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
       {
-         Con::errorf("Could not build regions for NavMesh %s", getIdString());
+         error = "Could not build regions";
          return NULL;
       }
    }
@@ -948,47 +1148,47 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    data.cs = rcAllocContourSet();
    if(!data.cs)
    {
-      Con::errorf("Out of memory (rcContourSet) for NavMesh %s", getIdString());
+      error = "Out of memory (rcContourSet)";
       return NULL;
    }
    if(!rcBuildContours(ctx, *data.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *data.cs))
    {
-      Con::errorf("Could not construct rcContourSet for NavMesh %s", getIdString());
+      error = "Could not construct rcContourSet";
       return NULL;
    }
    if(data.cs->nconts <= 0)
    {
-      Con::errorf("No contours in rcContourSet for NavMesh %s", getIdString());
+      error = "No contours in rcContourSet";
       return NULL;
    }
 
    data.pm = rcAllocPolyMesh();
    if(!data.pm)
    {
-      Con::errorf("Out of memory (rcPolyMesh) for NavMesh %s", getIdString());
+      error = "Out of memory (rcPolyMesh)";
       return NULL;
    }
    if(!rcBuildPolyMesh(ctx, *data.cs, cfg.maxVertsPerPoly, *data.pm))
    {
-      Con::errorf("Could not construct rcPolyMesh for NavMesh %s", getIdString());
+      error = "Could not construct rcPolyMesh";
       return NULL;
    }
 
    data.pmd = rcAllocPolyMeshDetail();
    if(!data.pmd)
    {
-      Con::errorf("Out of memory (rcPolyMeshDetail) for NavMesh %s", getIdString());
+      error = "Out of memory (rcPolyMeshDetail)";
       return NULL;
    }
    if(!rcBuildPolyMeshDetail(ctx, *data.pm, *data.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *data.pmd))
    {
-      Con::errorf("Could not construct rcPolyMeshDetail for NavMesh %s", getIdString());
+      error = "Could not construct rcPolyMeshDetail";
       return NULL;
    }
 
    if(data.pm->nverts >= 0xffff)
    {
-      Con::errorf("Too many vertices in rcPolyMesh for NavMesh %s", getIdString());
+      error = "Too many vertices in rcPolyMesh";
       return NULL;
    }
    for(U32 i = 0; i < data.pm->npolys; i++)
@@ -1005,47 +1205,47 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    unsigned char* navData = 0;
    int navDataSize = 0;
 
-   dtNavMeshCreateParams params;
-   dMemset(&params, 0, sizeof(params));
-
-   params.verts = data.pm->verts;
-   params.vertCount = data.pm->nverts;
-   params.polys = data.pm->polys;
-   params.polyAreas = data.pm->areas;
-   params.polyFlags = data.pm->flags;
-   params.polyCount = data.pm->npolys;
-   params.nvp = data.pm->nvp;
-
-   params.detailMeshes = data.pmd->meshes;
-   params.detailVerts = data.pmd->verts;
-   params.detailVertsCount = data.pmd->nverts;
-   params.detailTris = data.pmd->tris;
-   params.detailTriCount = data.pmd->ntris;
-
-   params.offMeshConVerts = mLinkVerts.address();
-   params.offMeshConRad = mLinkRads.address();
-   params.offMeshConDir = mLinkDirs.address();
-   params.offMeshConAreas = mLinkAreas.address();
-   params.offMeshConFlags = mLinkFlags.address();
-   params.offMeshConUserID = mLinkIDs.address();
-   params.offMeshConCount = mLinkIDs.size();
-
-   params.walkableHeight = mWalkableHeight;
-   params.walkableRadius = mWalkableRadius;
-   params.walkableClimb = mWalkableClimb;
-   params.tileX = tile.x;
-   params.tileY = tile.y;
-   params.tileLayer = 0;
-   rcVcopy(params.bmin, data.pm->bmin);
-   rcVcopy(params.bmax, data.pm->bmax);
-   params.cs = cfg.cs;
-   params.ch = cfg.ch;
-   params.buildBvTree = true;
-
-   if(!dtCreateNavMeshData(&params, &navData, &navDataSize))
-   {
-      Con::errorf("Could not create dtNavMeshData for tile (%d, %d) of NavMesh %s",
-         tile.x, tile.y, getIdString());
+   dtNavMeshCreateParams createParams;
+   dMemset(&createParams, 0, sizeof(createParams));
+
+   createParams.verts = data.pm->verts;
+   createParams.vertCount = data.pm->nverts;
+   createParams.polys = data.pm->polys;
+   createParams.polyAreas = data.pm->areas;
+   createParams.polyFlags = data.pm->flags;
+   createParams.polyCount = data.pm->npolys;
+   createParams.nvp = data.pm->nvp;
+
+   createParams.detailMeshes = data.pmd->meshes;
+   createParams.detailVerts = data.pmd->verts;
+   createParams.detailVertsCount = data.pmd->nverts;
+   createParams.detailTris = data.pmd->tris;
+   createParams.detailTriCount = data.pmd->ntris;
+
+   createParams.offMeshConVerts = params.linkVerts.address();
+   createParams.offMeshConRad = params.linkRads.address();
+   createParams.offMeshConDir = params.linkDirs.address();
+   createParams.offMeshConAreas = params.linkAreas.address();
+   createParams.offMeshConFlags = params.linkFlags.address();
+   createParams.offMeshConUserID = params.linkIDs.address();
+   createParams.offMeshConCount = params.linkIDs.size();
+
+   createParams.walkableHeight = params.walkableHeight;
+   createParams.walkableRadius = params.walkableRadius;
+   createParams.walkableClimb = params.walkableClimb;
+   createParams.tileX = tile.x;
+   createParams.tileY = tile.y;
+   createParams.tileLayer = 0;
+   rcVcopy(createParams.bmin, data.pm->bmin);
+   rcVcopy(createParams.bmax, data.pm->bmax);
+   createParams.cs = cfg.cs;
+   createParams.ch = cfg.ch;
+   createParams.buildBvTree = true;
+
+   if(!dtCreateNavMeshData(&createParams, &navData, &navDataSize))
+   {
+      error = String::ToString("Could not create dtNavMeshData for tile (%d, %d)",
+         tile.x, tile.y);
       return NULL;
    }
 
@@ -1247,25 +1447,43 @@ bool NavMesh::testEdgeCover(const Point3F &pos, const VectorF &dir, CoverPointDa
    // Get the edge normal.
    Point3F norm;
    mCross(dir, Point3F(0, 0, 1), &norm);
-   RayInfo ray;
-   U32 hits = 0;
+
+   // Cast all the rays for every height in one batch: the cover ray, then
+   // the two rays testing each peek direction.
+   enum { CoverRay, LeftRays, RightRays = LeftRays + 2, OverRays = RightRays + 2, RaysPerSize = OverRays + 2 };
+   Point3F starts[CoverPoint::NumSizes * RaysPerSize];
+   Point3F ends[CoverPoint::NumSizes * RaysPerSize];
+   RayInfo rays[CoverPoint::NumSizes * RaysPerSize];
    for(U32 j = 0; j < CoverPoint::NumSizes; j++)
    {
       Point3F test = pos + Point3F(0.0f, 0.0f, mWalkableHeight * j / CoverPoint::NumSizes);
-      if(getContainer()->castRay(test, test + norm * mCoverDist, StaticObjectType, &ray))
-      {
-         // Test peeking.
-         Point3F left = test + dir * mPeekDist;
-         data.peek[0] = !getContainer()->castRay(test, left, StaticObjectType, &ray)
-            && !getContainer()->castRay(left, left + norm * mCoverDist, StaticObjectType, &ray);
+      Point3F *s = starts + j * RaysPerSize;
+      Point3F *e = ends + j * RaysPerSize;
 
-         Point3F right = test - dir * mPeekDist;
-         data.peek[1] = !getContainer()->castRay(test, right, StaticObjectType, &ray)
-            && !getContainer()->castRay(right, right + norm * mCoverDist, StaticObjectType, &ray);
+      s[CoverRay] = test;
+      e[CoverRay] = test + norm * mCoverDist;
 
-         Point3F over = test + Point3F(0, 0, 1) * 0.2f;
-         data.peek[2] = !getContainer()->castRay(test, over, StaticObjectType, &ray)
-            && !getContainer()->castRay(over, over + norm * mCoverDist, StaticObjectType, &ray);
+      const Point3F peeks[3] = { test + dir * mPeekDist, test - dir * mPeekDist, test + Point3F(0, 0, 1) * 0.2f };
+      for(U32 p = 0; p < 3; p++)
+      {
+         s[LeftRays + p * 2] = test;
+         e[LeftRays + p * 2] = peeks[p];
+         s[LeftRays + p * 2 + 1] = peeks[p];
+         e[LeftRays + p * 2 + 1] = peeks[p] + norm * mCoverDist;
+      }
+   }
+   getContainer()->castRays(CoverPoint::NumSizes * RaysPerSize, starts, ends, StaticObjectType, rays);
+
+   U32 hits = 0;
+   for(U32 j = 0; j < CoverPoint::NumSizes; j++)
+   {
+      const RayInfo *r = rays + j * RaysPerSize;
+      if(r[CoverRay].object)
+      {
+         // Test peeking.
+         data.peek[0] = !r[LeftRays].object && !r[LeftRays + 1].object;
+         data.peek[1] = !r[RightRays].object && !r[RightRays + 1].object;
+         data.peek[2] = !r[OverRays].object && !r[OverRays + 1].object;
 
          if(mInnerCover || data.peek[0] || data.peek[1] || data.peek[2])
             hits++;
@@ -29,6 +29,8 @@
 #include "collision/concretePolyList.h"
 #include "recastPolyList.h"
 #include "util/messaging/eventManager.h"
+#include "platform/threads/threadPoolTaskSet.h"
+#include "core/tAlgorithm.h"
 
 #include "torqueRecast.h"
 #include "duDebugDrawTorque.h"
@@ -102,6 +104,8 @@ public:
    U32 mMergeRegionArea;
    F32 mTileSize;
    U32 mMaxPolysPerTile;
+   /// Build dirty tiles concurrently on the ThreadPool instead of one per tick.
+   bool mThreadedBuild;
    /// @}
 
    /// @name Water
@@ -199,6 +203,7 @@ public:
    /// @{
 
    static void initPersistFields();
+   static void consoleInit();
 
    bool onAdd();
    void onRemove();
@@ -260,6 +265,9 @@ private:
    /// Builds the next tile in the dirty list.
    void buildNextTile();
 
+   /// Builds all dirty tiles using the ThreadPool.
+   void buildTilesThreaded(bool wait);
+
    /// Save imtermediate navmesh creation data?
    bool mSaveIntermediates;
 
@@ -312,12 +320,51 @@ private:
          rcFreePolyMesh(pm);
          rcFreePolyMeshDetail(pmd);
       }
+      void swap(TileData &other)
+      {
+         geom.swap(other.geom);
+         ::swap(hf, other.hf);
+         ::swap(chf, other.chf);
+         ::swap(cs, other.cs);
+         ::swap(pm, other.pm);
+         ::swap(pmd, other.pmd);
+      }
       ~TileData()
       {
          freeAll();
       }
    };
 
+   /// Everything a tile build needs apart from its input geometry, copied
+   /// out of the NavMesh so the build never has to touch the scene.
+   struct TileBuildParams {
+      Tile tile;
+      rcConfig cfg;
+      WaterMethod waterMethod;
+      F32 walkableHeight, walkableRadius, walkableClimb;
+      /// Amount of geometry at the start of the poly list that is not water.
+      U32 nonWaterVertCount, nonWaterTriCount;
+      /// @name Off-mesh links
+      /// @{
+      Vector<F32> linkVerts;
+      Vector<F32> linkRads;
+      Vector<U8> linkDirs;
+      Vector<U8> linkAreas;
+      Vector<U16> linkFlags;
+      Vector<U32> linkIDs;
+      /// @}
+   };
+
+   /// A tile build running on the ThreadPool as a single task.
+   struct TileBuildItem;
+   typedef ThreadSafeRef<TileBuildItem> TileBuildItemRef;
+
+   /// Tile builds that have been issued to the ThreadPool.
+   Vector<TileBuildItemRef> mTileBuilds;
+
+   /// Maximum number of tile builds a NavMesh may have in flight at once.
+   static S32 smMaxTileBuilds;
+
    /// List of tiles.
    Vector<Tile> mTiles;
 
@@ -333,6 +380,24 @@ private:
    /// Generates navmesh data for a single tile.
    unsigned char *buildTileData(const Tile &tile, TileData &data, U32 &dataSize);
 
+   /// Snapshot build parameters and scene geometry for a tile. Must be called
+   /// on the main thread.
+   void prepareTileBuild(const Tile &tile, TileBuildParams &params, TileData &data);
+
+   /// Generates navmesh data for a single tile from prepared input. Does not
+   /// access the NavMesh or the scene, so can be run on a worker thread.
+   static unsigned char *buildTileMesh(const TileBuildParams &params, TileData &data,
+      U32 &dataSize, rcContext *ctx, String &error);
+
+   /// Replace a tile in the dtNavMesh with new data and notify listeners.
+   void addTileData(U32 index, unsigned char *data, U32 dataSize);
+
+   /// Called when the last dirty tile has been built.
+   void finishBuild();
+
+   /// Abandon all tile builds in flight on the ThreadPool.
+   void cancelTileBuilds();
+
    /// @}
 
    /// @name Off-mesh links
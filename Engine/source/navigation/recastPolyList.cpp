@@ -22,6 +22,7 @@
 
 #include "recastPolyList.h"
 #include "platform/platform.h"
+#include "core/tAlgorithm.h"
 
 #include "gfx/gfxDevice.h"
 #include "gfx/primBuilder.h"
@@ -57,6 +58,18 @@ void RecastPolyList::clear()
    tricap = 0;
 }
 
+void RecastPolyList::swap(RecastPolyList &other)
+{
+   ::swap(nverts, other.nverts);
+   ::swap(verts, other.verts);
+   ::swap(vertcap, other.vertcap);
+
+   ::swap(ntris, other.ntris);
+   ::swap(tris, other.tris);
+   ::swap(tricap, other.tricap);
+   ::swap(vidx, other.vidx);
+}
+
 bool RecastPolyList::isEmpty() const
 {
    return getTriCount() == 0;
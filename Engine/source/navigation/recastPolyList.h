@@ -61,6 +61,9 @@ public:
    const S32 *getTris() const;
 
    void clear();
+
+   /// Exchange vertex and triangle data with another list.
+   void swap(RecastPolyList &other);
    /// @}
 
    void renderWire() const;
@@ -123,6 +123,7 @@ enum ProcessorProperties
    CPU_PROP_LE        = (1<<12), ///< This processor is LITTLE ENDIAN.  
    CPU_PROP_64bit     = (1<<13), ///< This processor is 64-bit capable
    CPU_PROP_ALTIVEC   = (1<<14),  ///< Supports AltiVec instruction set extension (PPC only).
+   CPU_PROP_AVX       = (1<<15),  ///< Supports AVX instruction set extension, with OS support.
 };
 
 /// Processor info manager. 
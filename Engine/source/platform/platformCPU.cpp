@@ -42,8 +42,35 @@ enum CPUFlags
    BIT_SSE3xt  = BIT(9),
    BIT_SSE4_1  = BIT(19),
    BIT_SSE4_2  = BIT(20),
+   BIT_OSXSAVE = BIT(27),
+   BIT_AVX     = BIT(28),
 };
 
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#endif
+
+// AVX is only usable if the OS saves the YMM registers, which XCR0 tells.
+static bool detectAVX(U32 properties2)
+{
+   if ((properties2 & (BIT_OSXSAVE | BIT_AVX)) != (BIT_OSXSAVE | BIT_AVX))
+      return false;
+
+#if defined(_MSC_VER) && (_MSC_FULL_VER >= 160040219)
+   const U64 xcr0 = _xgetbv(0);
+#elif defined(__GNUC__)
+   U32 eax, edx;
+   __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+   const U64 xcr0 = eax | (U64(edx) << 32);
+#else
+   const U64 xcr0 = 0;
+#endif
+
+   return (xcr0 & 0x6) == 0x6;
+}
+#endif
+
 // fill the specified structure with information obtained from asm code
 void SetProcessorInfo(Platform::SystemInfo_struct::Processor& pInfo,
    char* vendor, U32 processor, U32 properties, U32 properties2)
@@ -279,6 +306,10 @@ void SetProcessorInfo(Platform::SystemInfo_struct::Processor& pInfo,
             }
          }
 
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+   pInfo.properties |= detectAVX(properties2) ? CPU_PROP_AVX : 0;
+#endif
+
    // Get multithreading caps.
 
    CPUInfo::EConfig config = CPUInfo::CPUCount( pInfo.numLogicalProcessors, pInfo.numAvailableCores, pInfo.numPhysicalProcessors );
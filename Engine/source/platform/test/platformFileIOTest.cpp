@@ -24,6 +24,8 @@
 #include "testing/unitTesting.h"
 #include "platform/platform.h"
 #include "core/fileio.h"
+#include "core/volume.h"
+#include "core/stream/fileStream.h"
 #include "core/util/tVector.h"
 #include "console/console.h"
 
@@ -97,6 +99,36 @@ TEST(File, TouchAndTime)
       << "Somehow failed to delete our test file.";
 };
 
+TEST(File, MappedFile)
+{
+   // Write out a file with a known pattern.
+   Vector<U8> data;
+   data.setSize(100 * 1024 + 3);
+   for (U32 i = 0; i < data.size(); i++)
+      data[i] = (U8)(i * 7 + i / 256);
+
+   {
+      FileStream stream;
+      ASSERT_TRUE(stream.open("testMapped.file", Torque::FS::File::Write));
+      stream.write(data.size(), data.address());
+   }
+
+   // The contents should match whether the file
+   // system mapped the file or read it in.
+   Torque::FS::MappedFile file;
+   ASSERT_TRUE(file.open("testMapped.file"))
+      << "Failed to map the file we just wrote.";
+   ASSERT_EQ(data.size(), file.getSize());
+   EXPECT_EQ(0, dMemcmp(data.address(), file.getData(), data.size()))
+      << "Mapped contents don't match what was written.";
+
+   file.close();
+   EXPECT_TRUE(file.getData() == NULL);
+   EXPECT_EQ(0, file.getSize());
+
+   dFileDelete("testMapped.file");
+};
+
 // Mac/Linux have no implementations for these functions, so we 'def it out for now.
 #ifdef WIN32
 TEST(Platform, Volumes)
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2014 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/threads/threadPoolTaskSet.h"
+#include "platform/threads/thread.h"
+#include "platform/platformIntrinsics.h"
+#include "core/util/tVector.h"
+
+FIXTURE(ThreadPoolTaskSet)
+{
+public:
+   // Records which thread ran each task and how often it was run.
+   struct TestTaskSet : public ThreadPoolTaskSet
+   {
+      Vector<U32> mRunCount;
+      Vector<U32> mThreadIds;
+      U32 mSleepMS;
+
+      TestTaskSet(U32 numTasks, U32 sleepMS = 0)
+         : ThreadPoolTaskSet(numTasks), mSleepMS(sleepMS)
+      {
+         mRunCount.setSize(numTasks);
+         mThreadIds.setSize(numTasks);
+         for (U32 i = 0; i < numTasks; i++)
+            mRunCount[i] = mThreadIds[i] = 0;
+      }
+
+   protected:
+      virtual void runTask(U32 index)
+      {
+         if (mSleepMS)
+            Platform::sleep(mSleepMS);
+         mThreadIds[index] = ThreadManager::getCurrentThreadId();
+         dFetchAndAdd(mRunCount[index], 1);
+      }
+   };
+};
+
+TEST_FIX(ThreadPoolTaskSet, RunsEveryTaskExactlyOnce)
+{
+   ThreadSafeRef<TestTaskSet> tasks(new TestTaskSet(1000));
+   tasks->run();
+
+   EXPECT_TRUE(tasks->isDone());
+   for (U32 i = 0; i < 1000; i++)
+      EXPECT_EQ(tasks->mRunCount[i], 1) << "task " << i << " was not run exactly once";
+}
+
+TEST_FIX(ThreadPoolTaskSet, UnthreadedRunStaysOnCallingThread)
+{
+   ThreadSafeRef<TestTaskSet> tasks(new TestTaskSet(16));
+   tasks->run(false);
+
+   const U32 mainThread = ThreadManager::getCurrentThreadId();
+   for (U32 i = 0; i < 16; i++)
+      EXPECT_EQ(tasks->mThreadIds[i], mainThread) << "task " << i << " ran on a worker thread";
+}
+
+TEST_FIX(ThreadPoolTaskSet, WaitJoinsTasksStartedByWorkers)
+{
+   // The tasks sleep so that the workers are still busy when wait() runs
+   // out of tasks to claim and has to block.
+   ThreadSafeRef<TestTaskSet> tasks(new TestTaskSet(8, 20));
+   tasks->start();
+   tasks->wait();
+
+   EXPECT_TRUE(tasks->isDone());
+   for (U32 i = 0; i < 8; i++)
+      EXPECT_EQ(tasks->mRunCount[i], 1) << "task " << i << " had not finished when wait() returned";
+
+   // A second wait on a finished set must not block.
+   tasks->wait();
+}
+
+TEST_FIX(ThreadPoolTaskSet, CancelSkipsUnclaimedTasks)
+{
+   ThreadSafeRef<TestTaskSet> tasks(new TestTaskSet(64));
+   tasks->cancel();
+   tasks->start();
+   tasks->wait();
+
+   EXPECT_TRUE(tasks->isDone());
+   EXPECT_TRUE(tasks->isCancelled());
+   for (U32 i = 0; i < 64; i++)
+      EXPECT_EQ(tasks->mRunCount[i], 0) << "cancelled task " << i << " was run";
+}
+
+TEST_FIX(ThreadPoolTaskSet, EmptySetIsDone)
+{
+   ThreadSafeRef<TestTaskSet> tasks(new TestTaskSet(0));
+   EXPECT_TRUE(tasks->isDone());
+   tasks->run();
+}
+
+#endif
@@ -0,0 +1,166 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "platform/threads/threadPoolTaskSet.h"
+#include "platform/platformIntrinsics.h"
+
+
+//=============================================================================
+//    ThreadPoolTaskSet::WorkItem.
+//=============================================================================
+
+/// Pool item that keeps claiming tasks from its set until none are left.
+struct ThreadPoolTaskSet::WorkItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   ThreadSafeRef< ThreadPoolTaskSet > mTaskSet;
+
+   WorkItem( ThreadPoolTaskSet* taskSet )
+      : Parent( taskSet->mContext ),
+        mTaskSet( taskSet ) {}
+
+   virtual void execute()
+   {
+      while( mTaskSet->_runNextTask() );
+   }
+};
+
+//=============================================================================
+//    ThreadPoolTaskSet.
+//=============================================================================
+
+ThreadPoolTaskSet::ThreadPoolTaskSet( U32 numTasks, ThreadPool::Context* context )
+   : mContext( context ),
+     mNumTasks( numTasks ),
+     mNextTask( 0 ),
+     mNumTasksDone( 0 ),
+     mCancelled( 0 ),
+     mStarted( false ),
+     mDoneSemaphore( 0 )
+{
+}
+
+//--------------------------------------------------------------------------
+
+void ThreadPoolTaskSet::setNumTasks( U32 numTasks )
+{
+   AssertFatal( !mStarted && !dAtomicRead( mNextTask ), "ThreadPoolTaskSet::setNumTasks - task set already started" );
+   mNumTasks = numTasks;
+}
+
+//--------------------------------------------------------------------------
+
+bool ThreadPoolTaskSet::isDone()
+{
+   return ( dAtomicRead( mNumTasksDone ) >= mNumTasks );
+}
+
+//--------------------------------------------------------------------------
+
+bool ThreadPoolTaskSet::isCancelled()
+{
+   return ( dAtomicRead( mCancelled ) != 0 );
+}
+
+//--------------------------------------------------------------------------
+
+bool ThreadPoolTaskSet::_runNextTask()
+{
+   U32 index;
+   do
+   {
+      index = dAtomicRead( mNextTask );
+      if( index >= mNumTasks )
+         return false;
+   }
+   while( !dCompareAndSwap( mNextTask, index, index + 1 ) );
+
+   if( !isCancelled() )
+      runTask( index );
+
+   // dFetchAndAdd doesn't hand back the old value on all platforms so
+   // count with a CAS loop; whoever brings the count up to mNumTasks
+   // wakes up the waiting thread.
+
+   U32 numDone;
+   do
+      numDone = dAtomicRead( mNumTasksDone );
+   while( !dCompareAndSwap( mNumTasksDone, numDone, numDone + 1 ) );
+
+   if( numDone + 1 == mNumTasks )
+      mDoneSemaphore.release();
+
+   return true;
+}
+
+//--------------------------------------------------------------------------
+
+void ThreadPoolTaskSet::_queueWorkItems( U32 maxItems )
+{
+   mStarted = true;
+
+   const U32 numItems = getMin( maxItems, getMax( Platform::SystemInfo.processor.numLogicalProcessors, U32( 1 ) ) );
+   for( U32 i = 0; i < numItems; ++ i )
+      ThreadPool::GLOBAL().queueWorkItem( new WorkItem( this ) );
+}
+
+//--------------------------------------------------------------------------
+
+void ThreadPoolTaskSet::start()
+{
+   if( !mStarted )
+      _queueWorkItems( mNumTasks );
+}
+
+//--------------------------------------------------------------------------
+
+void ThreadPoolTaskSet::wait()
+{
+   while( _runNextTask() );
+
+   if( !mNumTasks || isDone() )
+      return;
+
+   // Pass the semaphore on so that later calls to wait() return as well.
+
+   mDoneSemaphore.acquire();
+   mDoneSemaphore.release();
+}
+
+//--------------------------------------------------------------------------
+
+void ThreadPoolTaskSet::run( bool threaded )
+{
+   if( threaded && !mStarted && mNumTasks > 1 )
+      _queueWorkItems( mNumTasks - 1 );
+
+   wait();
+}
+
+//--------------------------------------------------------------------------
+
+void ThreadPoolTaskSet::cancel()
+{
+   dCompareAndSwap( mCancelled, 0, 1 );
+}
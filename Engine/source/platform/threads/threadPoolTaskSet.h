@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _THREADPOOLTASKSET_H_
+#define _THREADPOOLTASKSET_H_
+
+#ifndef _THREADPOOL_H_
+   #include "platform/threads/threadPool.h"
+#endif
+
+
+/// @file
+/// Fork/join helper for splitting work over the global ThreadPool.
+
+
+/// A fixed number of independent tasks that are worked on by the calling
+/// thread and by ThreadPool worker threads at the same time.
+///
+/// Subclasses implement runTask() and hand out the task count.  Tasks are
+/// claimed one at a time, so whichever thread gets to a task first runs it;
+/// wait() makes the calling thread pick up any task that no worker has
+/// claimed yet and then blocks on a semaphore until the last task running on
+/// a worker has finished.  This makes waiting safe on a single core machine
+/// and keeps the join point from depending on when the pool gets around to
+/// the queued items.
+///
+/// Task sets are concurrently reference-counted since queued work items keep
+/// references to them.  Hold them through a ThreadSafeRef.
+///
+/// @note Like all submissions to the global pool, task sets should only be
+///   started from the main thread.
+class ThreadPoolTaskSet : public ThreadSafeRefCount< ThreadPoolTaskSet >
+{
+   public:
+
+      typedef ThreadSafeRefCount< ThreadPoolTaskSet > Parent;
+
+   protected:
+
+      struct WorkItem;
+
+      /// Work context for the queued items.
+      ThreadPool::Context* mContext;
+
+      /// Number of tasks in the set.
+      U32 mNumTasks;
+
+      /// Index of the next task to claim.
+      volatile U32 mNextTask;
+
+      /// Number of tasks that have been run or skipped.
+      volatile U32 mNumTasksDone;
+
+      /// Non-zero once cancel() has been called.
+      volatile U32 mCancelled;
+
+      /// True once start() has queued the work items.
+      bool mStarted;
+
+      /// Released by whichever thread finishes the last task.
+      Semaphore mDoneSemaphore;
+
+      /// Run the task with the given index.  Called on the calling thread or
+      /// on a worker thread.
+      virtual void runTask( U32 index ) = 0;
+
+      /// Set the number of tasks.  Must happen before the set is started.
+      void setNumTasks( U32 numTasks );
+
+      /// Claim the next task and run it.
+      /// @return false if there were no tasks left to claim.
+      bool _runNextTask();
+
+      /// Queue up to @a maxItems work items on the global pool.
+      void _queueWorkItems( U32 maxItems );
+
+   public:
+
+      ThreadPoolTaskSet( U32 numTasks = 0, ThreadPool::Context* context = NULL );
+      virtual ~ThreadPoolTaskSet() {}
+
+      /// Return the number of tasks in the set.
+      U32 getNumTasks() const { return mNumTasks; }
+
+      /// Return true if every task has been run or skipped.
+      bool isDone();
+
+      /// Return true if cancel() has been called.
+      bool isCancelled();
+
+      /// Queue work items for the tasks on the global pool and return
+      /// right away.  Call wait() or isDone() to find out when they are done.
+      void start();
+
+      /// Run all tasks not claimed by a worker yet on the calling thread and
+      /// then block until the remaining ones have finished.
+      void wait();
+
+      /// Run the tasks to completion with the calling thread being one of the
+      /// workers.  If @a threaded is false, the tasks all run on the calling
+      /// thread.
+      void run( bool threaded = true );
+
+      /// Skip all tasks that have not been claimed yet.  Tasks that are
+      /// already running are not interrupted; use wait() to join them.
+      void cancel();
+};
+
+typedef ThreadSafeRef< ThreadPoolTaskSet > ThreadPoolTaskSetRef;
+
+#endif // _THREADPOOLTASKSET_H_
@@ -22,6 +22,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <sys/mman.h>
 
 #include "core/crc.h"
 #include "core/frameAllocator.h"
@@ -238,6 +239,8 @@ PosixFile::PosixFile(const Path& path,String name)
    _name = name;
    _status = Closed;
    _handle = 0;
+   _mapping = 0;
+   _mappingSize = 0;
 }
 
 PosixFile::~PosixFile()
@@ -343,6 +346,8 @@ bool PosixFile::open(AccessMode mode)
 
 bool PosixFile::close()
 {
+   unmap();
+
    if (_handle)
    {
       #ifdef DEBUG_SPEW
@@ -422,6 +427,46 @@ U32 PosixFile::write(const void* src, U32 size)
    return bytesWritten;
 }
 
+const void* PosixFile::map(U32 *outSize)
+{
+   if (_mapping)
+   {
+      *outSize = _mappingSize;
+      return _mapping;
+   }
+
+   if (_status != Open && _status != EndOfFile)
+      return 0;
+
+   struct stat info;
+   if (fstat(fileno(_handle),&info) < 0 || info.st_size <= 0 || info.st_size > U32_MAX)
+      return 0;
+
+   void* mapping = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fileno(_handle), 0);
+   if (mapping == MAP_FAILED)
+      return 0;
+
+   #ifdef DEBUG_SPEW
+   Platform::outputDebugString( "[PosixFile] mapped '%s'", _name.c_str() );
+   #endif
+
+   _mapping = mapping;
+   _mappingSize = info.st_size;
+
+   *outSize = _mappingSize;
+   return _mapping;
+}
+
+void PosixFile::unmap()
+{
+   if (!_mapping)
+      return;
+
+   munmap(_mapping, _mappingSize);
+   _mapping = 0;
+   _mappingSize = 0;
+}
+
 void PosixFile::_updateStatus()
 {
    switch (errno)
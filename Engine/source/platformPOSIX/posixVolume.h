@@ -90,8 +90,14 @@ public:
    U32 read(void* dst, U32 size);
    U32 write(const void* src, U32 size);
 
+   const void* map(U32 *outSize);
+   void unmap();
+
 private:
    U32 calculateChecksum();
+
+   void* _mapping;
+   U32 _mappingSize;
 };
 
 
@@ -320,6 +320,9 @@ Win32File::Win32File(const Path& path,String name)
    mName = name;
    mStatus = Closed;
    mHandle = 0;
+   mMapHandle = 0;
+   mMapping = 0;
+   mMappingSize = 0;
 }
 
 Win32File::~Win32File()
@@ -438,6 +441,8 @@ bool Win32File::open(AccessMode mode)
 
 bool Win32File::close()
 {
+   unmap();
+
    if (mHandle)
    {
       ::CloseHandle((HANDLE)mHandle);
@@ -448,6 +453,55 @@ bool Win32File::close()
    return true;
 }
 
+const void* Win32File::map(U32 *outSize)
+{
+   if (mMapping)
+   {
+      *outSize = mMappingSize;
+      return mMapping;
+   }
+
+   if (mStatus != Open && mStatus != EndOfFile)
+      return 0;
+
+   LARGE_INTEGER size;
+   if ( !GetFileSizeEx((HANDLE)mHandle, &size) || size.QuadPart <= 0 || size.QuadPart > U32_MAX )
+      return 0;
+
+   mMapHandle = (void*)::CreateFileMappingW((HANDLE)mHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+   if ( mMapHandle == NULL )
+      return 0;
+
+   mMapping = ::MapViewOfFile((HANDLE)mMapHandle, FILE_MAP_READ, 0, 0, 0);
+   if ( mMapping == NULL )
+   {
+      ::CloseHandle((HANDLE)mMapHandle);
+      mMapHandle = 0;
+      return 0;
+   }
+
+   mMappingSize = (U32)size.QuadPart;
+
+   *outSize = mMappingSize;
+   return mMapping;
+}
+
+void Win32File::unmap()
+{
+   if (mMapping)
+   {
+      ::UnmapViewOfFile(mMapping);
+      mMapping = 0;
+      mMappingSize = 0;
+   }
+
+   if (mMapHandle)
+   {
+      ::CloseHandle((HANDLE)mMapHandle);
+      mMapHandle = 0;
+   }
+}
+
 U32 Win32File::getPosition()
 {
    if (mStatus == Open || mStatus == EndOfFile)
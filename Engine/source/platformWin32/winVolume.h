@@ -78,6 +78,9 @@ public:
    U32 read(void* dst, U32 size);
    U32 write(const void* src, U32 size);
 
+   const void* map(U32 *outSize);
+   void unmap();
+
 private:
    friend class Win32FileSystem;
 
@@ -88,6 +91,10 @@ private:
    void     *mHandle;
    NodeStatus   mStatus;
 
+   void     *mMapHandle;
+   void     *mMapping;
+   U32      mMappingSize;
+
    Win32File(const Path &path, String name);
 
    bool _updateInfo();
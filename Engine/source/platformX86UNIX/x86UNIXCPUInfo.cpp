@@ -30,9 +30,34 @@
 #include "platform/platformCPUCount.h"
 #include <unistd.h>
 
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+#include <cpuid.h>
+#endif
+
 Platform::SystemInfo_struct Platform::SystemInfo;
 
-void Processor::init() {}
+extern void SetProcessorInfo(Platform::SystemInfo_struct::Processor& pInfo,
+   char* vendor, U32 processor, U32 properties, U32 properties2);
+
+void Processor::init()
+{
+   Platform::SystemInfo.processor.properties = CPU_PROP_C | CPU_PROP_LE;
+
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+   U32 eax, ebx, ecx, edx;
+   if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+      return;
+
+   char vendor[13];
+   dMemcpy(vendor, &ebx, 4);
+   dMemcpy(vendor + 4, &edx, 4);
+   dMemcpy(vendor + 8, &ecx, 4);
+   vendor[12] = 0;
+
+   __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+   SetProcessorInfo(Platform::SystemInfo.processor, vendor, eax & 0x0fff3fff, edx, ecx);
+#endif
+}
 
 // TODO LINUX CPUInfo::CPUCount better support
 namespace CPUInfo
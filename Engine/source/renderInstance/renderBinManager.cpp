@@ -31,6 +31,9 @@
 
 IMPLEMENT_CONOBJECT(RenderBinManager);
 
+bool RenderBinManager::smRadixSort = true;
+bool RenderBinManager::smCoherentSort = false;
+
 
 RenderBinManager::RenderBinManager( const RenderInstType& ritype, F32 renderOrder, F32 processAddOrder ) :
    mRenderInstType( ritype ),
@@ -39,6 +42,10 @@ RenderBinManager::RenderBinManager( const RenderInstType& ritype, F32 renderOrde
    mRenderPass( NULL )
 {
    VECTOR_SET_ASSOCIATION( mElementList );
+   VECTOR_SET_ASSOCIATION( mElementOrder );
+   VECTOR_SET_ASSOCIATION( mSortKeys );
+   VECTOR_SET_ASSOCIATION( mSortTemp );
+   VECTOR_SET_ASSOCIATION( mSortElements );
    mElementList.reserve( 2048 );
 }
 
@@ -63,6 +70,18 @@ void RenderBinManager::initPersistFields()
    Parent::initPersistFields();
 }
 
+void RenderBinManager::consoleInit()
+{
+   Con::addVariable( "$RenderBinManager::radixSort", TypeBool, &smRadixSort,
+      "Sort the render bins with a radix sort instead of a comparison sort.\n"
+      "@ingroup RenderBin\n" );
+
+   Con::addVariable( "$RenderBinManager::coherentSort", TypeBool, &smCoherentSort,
+      "Start sorting each render bin from the order of the previous frame.  Helps when "
+      "the bins hold the same instances from frame to frame.\n"
+      "@ingroup RenderBin\n" );
+}
+
 void RenderBinManager::onRemove()
 {
    // Tell the render pass to remove us when 
@@ -134,7 +153,148 @@ void RenderBinManager::clear()
 
 void RenderBinManager::sort()
 {
-   dQsort( mElementList.address(), mElementList.size(), sizeof(MainSortElem), cmpKeyFunc);
+   sortElements( mElementList, mElementOrder );
+}
+
+void RenderBinManager::sortElements( Vector<MainSortElem> &elements, Vector<U32> &prevOrder )
+{
+   PROFILE_SCOPE( RenderBinManager_sortElements );
+
+   const U32 count = elements.size();
+   if ( !smRadixSort )
+   {
+      dQsort( elements.address(), count, sizeof(MainSortElem), cmpKeyFunc );
+      prevOrder.clear();
+      return;
+   }
+
+   if ( count < 2 )
+   {
+      prevOrder.clear();
+      return;
+   }
+
+   mSortKeys.setSize( count );
+   mSortTemp.setSize( count );
+
+   SortKey *keys = mSortKeys.address();
+   for ( U32 i = 0; i < count; i++ )
+   {
+      keys[i].key = elements[i].getSortKey();
+      keys[i].index = i;
+   }
+
+   // Instances are added in the same order from frame to frame, so last
+   // frame's order applied to this frame's list is close to sorted if
+   // the bin holds the same things.  Give up if it's not.
+   SortKey *sorted = NULL;
+   if ( smCoherentSort && prevOrder.size() == count )
+   {
+      SortKey *temp = mSortTemp.address();
+      for ( U32 i = 0; i < count; i++ )
+         temp[i] = keys[ prevOrder[i] ];
+
+      if ( insertionSort( temp, count, count ) )
+         sorted = temp;
+   }
+
+   if ( !sorted )
+      sorted = radixSort( keys, mSortTemp.address(), count );
+
+   // Put the elements in order.
+   mSortElements.setSize( count );
+   prevOrder.setSize( count );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      mSortElements[i] = elements[ sorted[i].index ];
+      prevOrder[i] = sorted[i].index;
+   }
+   dMemcpy( elements.address(), mSortElements.address(), count * sizeof(MainSortElem) );
+}
+
+RenderBinManager::SortKey* RenderBinManager::radixSort( SortKey *keys, SortKey *temp, U32 count )
+{
+   // A comparison sort wins on short lists.
+   if ( count <= 64 )
+   {
+      insertionSort( keys, count, U32_MAX );
+      return keys;
+   }
+
+   // Six passes of 11 bits cover the 64 bit key.
+   enum
+   {
+      RadixBits = 11,
+      RadixSize = 1 << RadixBits,
+      RadixMask = RadixSize - 1,
+      NumPasses = ( 64 + RadixBits - 1 ) / RadixBits
+   };
+
+   // Count all the digits in one go.
+   static U32 histograms[NumPasses][RadixSize];
+   dMemset( histograms, 0, sizeof( histograms ) );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const U64 key = keys[i].key;
+      for ( U32 p = 0; p < NumPasses; p++ )
+         histograms[p][ ( key >> ( p * RadixBits ) ) & RadixMask ]++;
+   }
+
+   SortKey *src = keys;
+   SortKey *dst = temp;
+   for ( U32 p = 0; p < NumPasses; p++ )
+   {
+      U32 *histogram = histograms[p];
+      const U32 shift = p * RadixBits;
+
+      // Most of the key bits are the same for all elements,
+      // skip the passes which would not move anything.
+      if ( histogram[ ( src[0].key >> shift ) & RadixMask ] == count )
+         continue;
+
+      // Turn the counts into offsets.
+      U32 offset = 0;
+      for ( U32 d = 0; d < RadixSize; d++ )
+      {
+         const U32 num = histogram[d];
+         histogram[d] = offset;
+         offset += num;
+      }
+
+      for ( U32 i = 0; i < count; i++ )
+         dst[ histogram[ ( src[i].key >> shift ) & RadixMask ]++ ] = src[i];
+
+      SortKey *swap = src;
+      src = dst;
+      dst = swap;
+   }
+
+   return src;
+}
+
+bool RenderBinManager::insertionSort( SortKey *keys, U32 count, U32 maxMoves )
+{
+   U32 moves = 0;
+   for ( U32 i = 1; i < count; i++ )
+   {
+      if ( keys[i - 1].key <= keys[i].key )
+         continue;
+
+      const SortKey key = keys[i];
+      U32 j = i;
+      do
+      {
+         keys[j] = keys[j - 1];
+         j--;
+
+         if ( ++moves > maxMoves )
+            return false;
+      }
+      while ( j > 0 && keys[j - 1].key > key.key );
+      keys[j] = key;
+   }
+
+   return true;
 }
 
 S32 FN_CDECL RenderBinManager::cmpKeyFunc(const void* p1, const void* p2)
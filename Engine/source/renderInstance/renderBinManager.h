@@ -81,8 +81,17 @@ public:
    /// QSort callback function
    static S32 FN_CDECL cmpKeyFunc(const void* p1, const void* p2);
 
+   /// Sort with a radix sort over the packed element keys
+   /// instead of dQsort() and cmpKeyFunc().
+   static bool smRadixSort;
+
+   /// Start each sort from the order of the previous frame, which
+   /// is nearly sorted already when the view changes little.
+   static bool smCoherentSort;
+
    DECLARE_CONOBJECT(RenderBinManager);
    static void initPersistFields();
+   static void consoleInit();
 
    MaterialOverrideDelegate& getMatOverrideDelegate() { return mMatOverrideDelegate; }
 
@@ -93,8 +102,31 @@ protected:
       RenderInst *inst;
       U32 key;
       U32 key2;
+
+      /// Returns the key and key2 packed into one key which sorts
+      /// ascending in the same order cmpKeyFunc() sorts elements.
+      U64 getSortKey() const { return ( U64( ~key ) << 32 ) | key2; }
+   };
+
+   /// The packed key of an element and its index in the unsorted list.
+   struct SortKey
+   {
+      U64 key;
+      U32 index;
    };
 
+   /// Sorts @a elements in cmpKeyFunc() order.  @a prevOrder keeps the
+   /// order of the last sort of this list for the coherent sort.
+   void sortElements( Vector<MainSortElem> &elements, Vector<U32> &prevOrder );
+
+   /// Stable radix sort of @a count keys, using @a temp as scratch space.
+   /// Returns the array which holds the result.
+   static SortKey* radixSort( SortKey *keys, SortKey *temp, U32 count );
+
+   /// Insertion sort of @a count keys which gives up after @a maxMoves
+   /// moves.  Returns false if it did.
+   static bool insertionSort( SortKey *keys, U32 count, U32 maxMoves );
+
    void setRenderPass( RenderPassManager *rpm );
 
    /// Called from derived bins to add additional
@@ -102,6 +134,12 @@ protected:
    void notifyType( const RenderInstType &type );
 
    Vector< MainSortElem > mElementList; // List of our instances
+   Vector< U32 > mElementOrder;         // Order of the last mElementList sort
+
+   /// Scratch space for sortElements().
+   Vector< SortKey > mSortKeys;
+   Vector< SortKey > mSortTemp;
+   Vector< MainSortElem > mSortElements;
    F32 mProcessAddOrder;   // Where in the list do we process RenderInstance additions?
    F32 mRenderOrder;       // Where in the list do we render?
 
@@ -32,6 +32,7 @@
 #include "scene/sceneRenderState.h"
 #include "gfx/gfxDebugEvent.h"
 #include "math/util/matrixSet.h"
+#include "ts/instancingMatHook.h"
 
 
 IMPLEMENT_CONOBJECT(RenderMeshMgr);
@@ -45,6 +46,9 @@ ConsoleDocClass( RenderMeshMgr,
    "@ingroup RenderBin\n" );
 
 
+bool RenderMeshMgr::smAutoInstancing = true;
+S32 RenderMeshMgr::smMinAutoInstances = 4;
+
 RenderMeshMgr::RenderMeshMgr()
 : RenderBinManager(RenderPassManager::RIT_Mesh, 1.0f, 1.0f)
 {
@@ -75,6 +79,18 @@ void RenderMeshMgr::initPersistFields()
    Parent::initPersistFields();
 }
 
+void RenderMeshMgr::consoleInit()
+{
+   Con::addVariable( "$RenderMeshMgr::autoInstancing", TypeBool, &smAutoInstancing,
+      "Draw runs of identical meshes with a single hardware instanced draw.\n"
+      "@ingroup RenderBin\n" );
+
+   Con::addVariable( "$RenderMeshMgr::minAutoInstances", TypeS32, &smMinAutoInstances,
+      "The shortest run of identical meshes which is drawn instanced when "
+      "$RenderMeshMgr::autoInstancing is enabled.\n"
+      "@ingroup RenderBin\n" );
+}
+
 //-----------------------------------------------------------------------------
 // add element
 //-----------------------------------------------------------------------------
@@ -89,6 +105,34 @@ void RenderMeshMgr::addElement( RenderInst *inst )
    internalAddElement(inst);
 }
 
+U32 RenderMeshMgr::_findInstanceRun( U32 start, U32 end ) const
+{
+   MeshRenderInst *ri = static_cast<MeshRenderInst*>(mElementList[start].inst);
+
+   U32 a;
+   for ( a = start + 1; a < end; a++ )
+   {
+      MeshRenderInst *passRI = static_cast<MeshRenderInst*>(mElementList[a].inst);
+
+      // The instanced draw only streams the transforms and
+      // visibility, so everything else has to match.  The hint
+      // and the back buffer and fog textures are per-instance
+      // scene data the shader can't vary within one draw.
+      if (  newPassNeeded( ri, passRI ) ||
+            ri->materialHint != passRI->materialHint ||
+            ri->backBuffTex != passRI->backBuffTex ||
+            ri->fogTex != passRI->fogTex ||
+            ri->miscTex != passRI->miscTex ||
+            ri->lightmap != passRI->lightmap ||
+            ri->cubemap != passRI->cubemap ||
+            ri->reflectTex != passRI->reflectTex ||
+            ri->accuTex != passRI->accuTex )
+         break;
+   }
+
+   return a;
+}
+
 //-----------------------------------------------------------------------------
 // render
 //-----------------------------------------------------------------------------
@@ -129,6 +173,26 @@ void RenderMeshMgr::render(SceneRenderState * state)
       setupSGData( ri, sgData );
       BaseMatInstance *mat = ri->matInst;
 
+      // The elements are sorted by material and vertex buffer, so
+      // identical meshes are next to each other.  Swap in the instancing
+      // version of the material to draw them all at once.
+      U32 batchEnd = binSize;
+#ifndef TORQUE_OS_MAC
+      if ( smAutoInstancing && mat && !mat->isInstanced() )
+      {
+         const U32 runEnd = _findInstanceRun( j, binSize );
+         if ( runEnd - j >= (U32)getMax( smMinAutoInstances, 2 ) )
+         {
+            BaseMatInstance *instMat = InstancingMaterialHook::getInstancingMat( mat );
+            if ( instMat && instMat->isValid() && instMat->isInstanced() )
+            {
+               mat = instMat;
+               batchEnd = runEnd;
+            }
+         }
+      }
+#endif
+
       // If we have an override delegate then give it a 
       // chance to swap the material with another.
       if ( mMatOverrideDelegate )
@@ -151,7 +215,7 @@ void RenderMeshMgr::render(SceneRenderState * state)
 
       while( mat && mat->setupPass(state, sgData ) )
       {
-         for( a=j; a<binSize; a++ )
+         for( a=j; a<batchEnd; a++ )
          {
             MeshRenderInst *passRI = static_cast<MeshRenderInst*>(mElementList[a].inst);
 
@@ -43,12 +43,26 @@ public:
 
    // ConsoleObject interface
    static void initPersistFields();
+   static void consoleInit();
    DECLARE_CONOBJECT(RenderMeshMgr);
+
+   /// If true runs of identical meshes are drawn with one
+   /// instanced draw even if their material isn't instanced.
+   static bool smAutoInstancing;
+
+   /// The shortest run of identical meshes which gets instanced.
+   static S32 smMinAutoInstances;
+
 protected:
    GFXStateBlockRef mNormalSB;
    GFXStateBlockRef mReflectSB;
 
    void construct();
+
+   /// Returns the end of the run of elements starting at @a start
+   /// which can be drawn as instances of the first one: same material,
+   /// material hint, buffers, lights and textures.
+   U32 _findInstanceRun( U32 start, U32 end ) const;
 };
 
 #endif // _RENDERMESHMGR_H_
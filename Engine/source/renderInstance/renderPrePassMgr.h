@@ -81,9 +81,11 @@ protected:
 
    /// The terrain render instance elements.
    Vector< MainSortElem > mTerrainElementList;
+   Vector< U32 > mTerrainElementOrder;
 
    /// The object render instance elements.
    Vector< MainSortElem > mObjectElementList;
+   Vector< U32 > mObjectElementOrder;
 
    PrePassMatInstance *mPrePassMatInstance;
 
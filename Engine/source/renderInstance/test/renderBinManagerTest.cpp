@@ -0,0 +1,188 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "renderInstance/renderBinManager.h"
+
+/// A render bin filled with made up elements, like a mesh bin keyed
+/// by material and vertex buffer or a translucent bin keyed by distance.
+class SortTestBin : public RenderBinManager
+{
+public:
+   typedef RenderBinManager::MainSortElem Element;
+
+   MRandomLCG rand;
+
+   SortTestBin() { rand.setSeed( 1234 ); }
+
+   void fillMaterials( U32 count, U32 numMaterials )
+   {
+      mElementList.setSize( count );
+      for ( U32 i = 0; i < count; i++ )
+      {
+         mElementList[i].inst = reinterpret_cast<RenderInst*>( uintptr_t( i + 1 ) );
+         mElementList[i].key = 0x1000 + rand.randI( 0, numMaterials - 1 ) * 0x40;
+         mElementList[i].key2 = 0x100000 + rand.randI( 0, count / 4 ) * 0x20;
+      }
+   }
+
+   void fillDistances( U32 count )
+   {
+      mElementList.setSize( count );
+      for ( U32 i = 0; i < count; i++ )
+      {
+         const F32 distSq = rand.randF( 0.0f, 1000000.0f );
+         mElementList[i].inst = reinterpret_cast<RenderInst*>( uintptr_t( i + 1 ) );
+         mElementList[i].key = *((U32*)&distSq);
+         mElementList[i].key2 = rand.randI( 1, 500 ) * 0x40;
+      }
+   }
+
+   /// Move a few elements around, like a camera moving a little.
+   void jitter( U32 numSwaps )
+   {
+      for ( U32 i = 0; i < numSwaps; i++ )
+      {
+         const U32 a = rand.randI( 0, mElementList.size() - 1 );
+         const U32 b = getMin( a + 1, (U32)mElementList.size() - 1 );
+         const U32 key = mElementList[a].key;
+         mElementList[a].key = mElementList[b].key;
+         mElementList[b].key = key;
+      }
+   }
+
+   void sortWith( bool radix, bool coherent )
+   {
+      const bool savedRadix = smRadixSort;
+      const bool savedCoherent = smCoherentSort;
+      smRadixSort = radix;
+      smCoherentSort = coherent;
+      sort();
+      smRadixSort = savedRadix;
+      smCoherentSort = savedCoherent;
+   }
+
+   bool isSorted()
+   {
+      for ( U32 i = 1; i < mElementList.size(); i++ )
+      {
+         if ( cmpKeyFunc( &mElementList[i - 1], &mElementList[i] ) > 0 )
+            return false;
+      }
+      return true;
+   }
+
+   Vector< Element >& getElements() { return mElementList; }
+};
+
+TEST(RenderBinManager, RadixSortIsStable)
+{
+   const U32 counts[] = { 0, 1, 7, 64, 65, 1000, 20000 };
+   for ( U32 c = 0; c < sizeof( counts ) / sizeof( counts[0] ); c++ )
+   {
+      for ( U32 type = 0; type < 2; type++ )
+      {
+         SortTestBin bin, qsortBin;
+         if ( type == 0 )
+         {
+            bin.fillMaterials( counts[c], 50 );
+            qsortBin.fillMaterials( counts[c], 50 );
+         }
+         else
+         {
+            bin.fillDistances( counts[c] );
+            qsortBin.fillDistances( counts[c] );
+         }
+
+         bin.sortWith( true, false );
+         qsortBin.sortWith( false, false );
+         EXPECT_TRUE( bin.isSorted() ) << counts[c] << " elements out of order";
+
+         // The packed keys must give the same key order as the
+         // comparison callback the old sort used.
+         const Vector< SortTestBin::Element > &elements = bin.getElements();
+         const Vector< SortTestBin::Element > &expected = qsortBin.getElements();
+         ASSERT_EQ( expected.size(), elements.size() );
+         for ( U32 i = 0; i < elements.size(); i++ )
+         {
+            ASSERT_EQ( expected[i].key, elements[i].key ) << "Element " << i << " of " << counts[c];
+            ASSERT_EQ( expected[i].key2, elements[i].key2 ) << "Element " << i << " of " << counts[c];
+         }
+
+         // The radix sort is stable so elements with equal keys stay
+         // in the order they were added.
+         for ( U32 i = 1; i < elements.size(); i++ )
+         {
+            if ( elements[i - 1].key == elements[i].key && elements[i - 1].key2 == elements[i].key2 )
+            {
+               EXPECT_LT( uintptr_t( elements[i - 1].inst ), uintptr_t( elements[i].inst ) );
+            }
+         }
+      }
+   }
+}
+
+TEST(RenderBinManager, CoherentSort)
+{
+   SortTestBin bin;
+   for ( U32 frame = 0; frame < 10; frame++ )
+   {
+      bin.rand.setSeed( 5678 );
+      bin.fillDistances( 5000 );
+      bin.jitter( frame * 20 );
+
+      bin.sortWith( true, true );
+      EXPECT_TRUE( bin.isSorted() ) << "Frame " << frame << " out of order";
+   }
+
+   // A different list must not reuse the old order.
+   bin.fillMaterials( 5000, 20 );
+   bin.sortWith( true, true );
+   EXPECT_TRUE( bin.isSorted() );
+}
+
+/// The sort benchmark asked for with the radix sort, which
+/// prints the frame sort times for each instance count.
+TEST(RenderBinManager, SortTimeByInstanceCount)
+{
+   const U32 counts[] = { 1000, 5000, 20000, 50000 };
+   const U32 numFrames = 50;
+   const char *modes[] = { "qsort", "radix", "coherent" };
+
+   for ( U32 c = 0; c < sizeof( counts ) / sizeof( counts[0] ); c++ )
+   {
+      for ( U32 type = 0; type < 2; type++ )
+      {
+         U32 times[3];
+         for ( U32 m = 0; m < 3; m++ )
+         {
+            SortTestBin bin;
+            U32 time = 0;
+            for ( U32 frame = 0; frame < numFrames; frame++ )
+            {
+               // Same instances each frame, moving a little.
+               bin.rand.setSeed( 1234 );
+               if ( type == 0 )
+                  bin.fillMaterials( counts[c], 200 );
+               else
+                  bin.fillDistances( counts[c] );
+               bin.jitter( frame );
+
+               const U32 start = Platform::getRealMilliseconds();
+               bin.sortWith( m != 0, m == 2 );
+               time += Platform::getRealMilliseconds() - start;
+
+               ASSERT_TRUE( bin.isSorted() ) << modes[m] << " frame " << frame << " out of order";
+            }
+            times[m] = time;
+         }
+
+         Con::printf( "RenderBinManager sort %u %s elements x %u: %s %ums, %s %ums, %s %ums",
+            counts[c], type ? "distance" : "material", numFrames,
+            modes[0], times[0], modes[1], times[1], modes[2], times[2] );
+      }
+   }
+}
+
+#endif
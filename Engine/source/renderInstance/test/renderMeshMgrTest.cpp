@@ -0,0 +1,254 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "renderInstance/renderMeshMgr.h"
+#include "renderInstance/renderPassManager.h"
+#include "materials/baseMatInstance.h"
+#include "ts/instancingMatHook.h"
+#include "scene/sceneManager.h"
+#include "scene/sceneRenderState.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/gfxVertexBuffer.h"
+#include "gfx/gfxPrimitiveBuffer.h"
+#include "gfx/gfxVertexTypes.h"
+#include "gfx/gfxTextureHandle.h"
+
+/// A material which sets the buffers like ProcessedShaderMaterial
+/// does, streaming the instance count as the vertex buffer frequency
+/// when it is instanced, and does nothing else.
+class RenderMeshMgrTestMat : public BaseMatInstance
+{
+public:
+   bool instanced;
+   bool inPass;
+   U32 numInstances;
+   MatStateHint hint;
+   FeatureSet features;
+   GFXStateBlockDesc userStateBlock;
+
+   RenderMeshMgrTestMat( const String &name, bool isInstanced )
+      :  instanced( isInstanced ),
+         inPass( false ),
+         numInstances( 0 ),
+         hint( name )
+   {
+      mIsValid = true;
+      mHasNormalMaps = false;
+   }
+
+   virtual bool init( const FeatureSet&, const GFXVertexFormat* ) { return true; }
+   virtual bool reInit() { return true; }
+   virtual void addStateBlockDesc( const GFXStateBlockDesc& ) {}
+   virtual void updateStateBlocks() {}
+   virtual void addShaderMacro( const String&, const String& ) {}
+   virtual MaterialParameters* allocMaterialParameters() { return NULL; }
+   virtual void setMaterialParameters( MaterialParameters* ) {}
+   virtual MaterialParameters* getMaterialParameters() { return NULL; }
+   virtual MaterialParameterHandle* getMaterialParameterHandle( const String& ) { return NULL; }
+
+   /// A single pass.
+   virtual bool setupPass( SceneRenderState*, const SceneData& )
+   {
+      inPass = !inPass;
+      return inPass;
+   }
+
+   virtual void setTransforms( const MatrixSet&, SceneRenderState* ) {}
+   virtual void setSceneInfo( SceneRenderState*, const SceneData& ) {}
+   virtual void setTextureStages( SceneRenderState*, const SceneData& ) {}
+
+   virtual void setBuffers( GFXVertexBufferHandleBase *vertBuffer, GFXPrimitiveBufferHandle *primBuffer )
+   {
+      GFX->setPrimitiveBuffer( *primBuffer );
+      GFX->setVertexBuffer( *vertBuffer, 0, numInstances );
+      numInstances = 0;
+   }
+
+   virtual bool isInstanced() const { return instanced; }
+   virtual bool stepInstance() { numInstances++; return true; }
+   virtual bool isForwardLit() const { return false; }
+   virtual void setUserObject( SimObject* ) {}
+   virtual SimObject* getUserObject() const { return NULL; }
+   virtual BaseMaterialDefinition* getMaterial() { return NULL; }
+   virtual bool hasGlow() { return false; }
+   virtual bool hasAccumulation() { return false; }
+   virtual bool hasPendingShaders() const { return false; }
+   virtual U32 getCurPass() { return 0; }
+   virtual U32 getCurStageNum() { return 0; }
+   virtual RenderPassData* getPass( U32 ) { return NULL; }
+   virtual const MatStateHint& getStateHint() const { return hint; }
+   virtual const FeatureSet& getFeatures() const { return features; }
+   virtual const FeatureSet& getRequestedFeatures() const { return features; }
+   virtual const GFXVertexFormat* getVertexFormat() const { return getGFXVertexFormat<GFXVertexP>(); }
+   virtual void dumpShaderInfo() const {}
+   virtual bool isCustomMaterial() const { return false; }
+   virtual const GFXStateBlockDesc& getUserStateBlock() const { return userStateBlock; }
+};
+
+/// Hands out a prebuilt instancing material, as the hook would
+/// after generating the instancing shaders.
+class RenderMeshMgrTestHook : public InstancingMaterialHook
+{
+public:
+   RenderMeshMgrTestHook( BaseMatInstance *instMat ) { mMatInst = instMat; }
+};
+
+/// Renders one mesh many times through a mesh bin on the Null
+/// device, which counts the draws instead of making them.
+FIXTURE(RenderMeshMgrInstancing)
+{
+public:
+   bool hasNullDevice;
+   RenderPassManager *pass;
+   RenderMeshMgrTestMat *mat;
+   GFXVertexBufferHandle<GFXVertexP> vb;
+   GFXPrimitiveBufferHandle pb;
+   GFXPrimitive prim;
+   bool savedAutoInstancing;
+   S32 savedMinInstances;
+
+   void SetUp()
+   {
+      hasNullDevice = GFXDevice::get() && GFX->getAdapterType() == NullDevice && gClientSceneGraph;
+      if ( !hasNullDevice )
+         return;
+
+      savedAutoInstancing = RenderMeshMgr::smAutoInstancing;
+      savedMinInstances = RenderMeshMgr::smMinAutoInstances;
+      RenderMeshMgr::smAutoInstancing = true;
+      RenderMeshMgr::smMinAutoInstances = 4;
+
+      pass = new RenderPassManager;
+      pass->registerObject();
+      pass->addManager( new RenderMeshMgr );
+
+      mat = new RenderMeshMgrTestMat( "RenderMeshMgrTestMat", false );
+      mat->addHook( new RenderMeshMgrTestHook( new RenderMeshMgrTestMat( "RenderMeshMgrTestMatInstanced", true ) ) );
+
+      vb.set( GFX, 3, GFXBufferTypeStatic );
+      pb.set( GFX, 3, 1, GFXBufferTypeStatic );
+
+      prim.type = GFXTriangleList;
+      prim.numVertices = 3;
+      prim.numPrimitives = 1;
+   }
+
+   void TearDown()
+   {
+      if ( !hasNullDevice )
+         return;
+
+      pass->deleteObject();
+      delete mat;
+      vb = NULL;
+      pb = NULL;
+
+      RenderMeshMgr::smAutoInstancing = savedAutoInstancing;
+      RenderMeshMgr::smMinAutoInstances = savedMinInstances;
+   }
+
+   MeshRenderInst* addMesh( void *materialHint = NULL, GFXTextureObject *backBuffTex = NULL )
+   {
+      MeshRenderInst *ri = pass->allocInst<MeshRenderInst>();
+      ri->type = RenderPassManager::RIT_Mesh;
+      ri->matInst = mat;
+      ri->vertBuff = &vb;
+      ri->primBuff = &pb;
+      ri->prim = &prim;
+      ri->objectToWorld = pass->allocUniqueXform( MatrixF::Identity );
+      ri->worldToCamera = ri->objectToWorld;
+      ri->projection = ri->objectToWorld;
+      ri->materialHint = materialHint;
+      ri->backBuffTex = backBuffTex;
+      ri->defaultKey = mat->getStateHint();
+
+      // Keeps the meshes with the same scene data
+      // together whichever sort the bin uses.
+      ri->defaultKey2 = uintptr_t( materialHint ) + uintptr_t( backBuffTex );
+
+      pass->addInst( ri );
+      return ri;
+   }
+
+   /// Renders what was added and returns the draws it made.
+   void render( GFXDeviceStatistics &outStats )
+   {
+      outStats.start( GFX->getDeviceStatistics() );
+
+      SceneRenderState state( gClientSceneGraph, SPT_Diffuse, SceneCameraState::fromGFX(), pass );
+      pass->renderPass( &state );
+
+      outStats.end( GFX->getDeviceStatistics() );
+   }
+};
+
+TEST_FIX(RenderMeshMgrInstancing, IdenticalMeshesDrawOnce)
+{
+   if ( !hasNullDevice )
+      return;
+
+   for ( U32 i = 0; i < 50; i++ )
+      addMesh();
+
+   GFXDeviceStatistics stats;
+   render( stats );
+   EXPECT_EQ( 1, stats.mDrawCalls );
+   EXPECT_EQ( 1, stats.mInstancedDrawCalls );
+   EXPECT_EQ( 50, stats.mInstances );
+}
+
+TEST_FIX(RenderMeshMgrInstancing, DisabledDrawsEachMesh)
+{
+   if ( !hasNullDevice )
+      return;
+
+   RenderMeshMgr::smAutoInstancing = false;
+
+   for ( U32 i = 0; i < 50; i++ )
+      addMesh();
+
+   GFXDeviceStatistics stats;
+   render( stats );
+   EXPECT_EQ( 50, stats.mDrawCalls );
+   EXPECT_EQ( 0, stats.mInstancedDrawCalls );
+}
+
+TEST_FIX(RenderMeshMgrInstancing, ShortRunsDrawEachMesh)
+{
+   if ( !hasNullDevice )
+      return;
+
+   for ( U32 i = 0; i < 3; i++ )
+      addMesh();
+
+   GFXDeviceStatistics stats;
+   render( stats );
+   EXPECT_EQ( 3, stats.mDrawCalls );
+   EXPECT_EQ( 0, stats.mInstancedDrawCalls );
+}
+
+TEST_FIX(RenderMeshMgrInstancing, SceneDataSplitsRuns)
+{
+   if ( !hasNullDevice )
+      return;
+
+   // Same material and buffers, but a different material
+   // hint or back buffer can't share one instanced draw.
+   GFXTexHandle backBuffTex( 4, 4, GFXFormatR8G8B8A8, &GFXDefaultStaticDiffuseProfile, "RenderMeshMgrInstancing backBuffTex" );
+   U32 materialHint = 0;
+
+   for ( U32 i = 0; i < 10; i++ )
+      addMesh();
+   for ( U32 i = 0; i < 20; i++ )
+      addMesh( NULL, backBuffTex );
+   for ( U32 i = 0; i < 30; i++ )
+      addMesh( &materialHint );
+
+   GFXDeviceStatistics stats;
+   render( stats );
+   EXPECT_EQ( 3, stats.mDrawCalls );
+   EXPECT_EQ( 3, stats.mInstancedDrawCalls );
+   EXPECT_EQ( 60, stats.mInstances );
+}
+
+#endif
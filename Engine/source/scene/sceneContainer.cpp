@@ -29,6 +29,10 @@
 #include "platform/profiler.h"
 #include "console/engineAPI.h"
 #include "math/util/frustum.h"
+#include "core/util/tDictionary.h"
+#include "core/dataChunker.h"
+#include "core/util/safeDelete.h"
+#include "platform/threads/threadPoolTaskSet.h"
 
 
 // [rene, 02-Mar-11]
@@ -46,6 +50,12 @@ const F32 SceneContainer::csmBinSize = 64;
 const F32 SceneContainer::csmTotalBinSize = SceneContainer::csmBinSize * SceneContainer::csmNumBins;
 const U32 SceneContainer::csmRefPoolBlockSize = 4096;
 
+const U32 SceneContainer::csmLooseNumLevels = 11;
+const F32 SceneContainer::csmLooseCellSize = 16;
+const S32 SceneContainer::csmLooseMaxCell = 32767;
+
+bool SceneContainer::smUseLooseGrid = false;
+
 // Statics used by buildPolyList methods
 static AbstractPolyList* sPolyList;
 static SphereF sBoundingSphere;
@@ -82,6 +92,159 @@ void SceneContainer::Link::linkAfter(SceneContainer::Link* ptr)
    prev->next = this;
 }
 
+//=============================================================================
+//    SceneContainer::LooseGrid.
+//=============================================================================
+
+struct SceneContainer::LooseGrid
+{
+   struct Cell
+   {
+      /// Head of the chain of objects in this cell.
+      SceneObjectRef head;
+
+      /// Cell coordinates on its level.
+      S32 x;
+      S32 y;
+   };
+
+   struct Level
+   {
+      /// Size of a cell's (tight) bounds on this level.
+      F32 cellSize;
+
+      /// Cells on this level by packed coordinates.
+      HashTable< U32, Cell* > cellMap;
+
+      /// All cells ever created on this level.
+      Vector< Cell* > cells;
+
+      Level()
+      {
+         VECTOR_SET_ASSOCIATION( cells );
+      }
+
+      static U32 getKey( S32 x, S32 y )
+      {
+         return ( U32( x ) & 0xFFFF ) | ( U32( y ) << 16 );
+      }
+
+      Cell* findCell( S32 x, S32 y )
+      {
+         HashTable< U32, Cell* >::Iterator iter = cellMap.find( getKey( x, y ) );
+         return iter != cellMap.end() ? iter->value : NULL;
+      }
+
+      /// Return the range of cells whose loose bounds may overlap [min, max].
+      void getCellRange( F32 min, F32 max, S32& minCell, S32& maxCell ) const
+      {
+         const F32 margin = cellSize * 0.5f;
+         minCell = S32( mClampF( mFloor( ( min - margin ) / cellSize ), -csmLooseMaxCell, csmLooseMaxCell ) );
+         maxCell = S32( mClampF( mFloor( ( max + margin ) / cellSize ), -csmLooseMaxCell, csmLooseMaxCell ) );
+      }
+
+      /// Return the loose bounds of a cell, with the given vertical extents.
+      Box3F getCellBox( const Cell* cell, F32 minZ, F32 maxZ ) const
+      {
+         const F32 margin = cellSize * 0.5f;
+         return Box3F( cell->x * cellSize - margin, cell->y * cellSize - margin, minZ,
+                       ( cell->x + 1 ) * cellSize + margin, ( cell->y + 1 ) * cellSize + margin, maxZ );
+      }
+   };
+
+   Level levels[ csmLooseNumLevels ];
+
+   Chunker< Cell > cellChunker;
+
+   LooseGrid()
+   {
+      F32 cellSize = csmLooseCellSize;
+      for ( U32 i = 0; i < csmLooseNumLevels; i++ )
+      {
+         levels[ i ].cellSize = cellSize;
+         cellSize *= 2.0f;
+      }
+   }
+
+   Cell* findOrCreateCell( U32 level, S32 x, S32 y )
+   {
+      Level& l = levels[ level ];
+      Cell* cell = l.findCell( x, y );
+      if ( !cell )
+      {
+         cell = cellChunker.alloc();
+         cell->head.object = NULL;
+         cell->head.nextInBin = NULL;
+         cell->head.prevInBin = NULL;
+         cell->head.nextInObj = NULL;
+         cell->x = x;
+         cell->y = y;
+
+         l.cellMap.insertUnique( Level::getKey( x, y ), cell );
+         l.cells.push_back( cell );
+      }
+      return cell;
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Run a query callback on the matching objects in a loose grid cell or the overflow bin.
+static void _findInLooseChain( SceneObjectRef* chain, const Box3F& box, U32 mask, const Frustum* frustum,
+                               SceneContainer::FindCallback callback, void* key )
+{
+   while ( chain )
+   {
+      SceneObject* object = chain->object;
+      chain = chain->nextInBin;
+
+      if ( ( object->getTypeMask() & mask ) == 0 || !object->isCollisionEnabled() )
+         continue;
+
+      const Box3F& worldBox = object->getWorldBox();
+      if ( !object->isGlobalBounds() && !worldBox.isOverlapped( box ) )
+         continue;
+
+      if ( frustum && frustum->isCulled( worldBox ) )
+         continue;
+
+      ( *callback )( object, key );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+static void _pushBackCallback( SceneObject* object, void* key )
+{
+   reinterpret_cast< Vector< SceneObject* >* >( key )->push_back( object );
+}
+
+//-----------------------------------------------------------------------------
+
+/// Bump the normal of a ray hit into world space.
+static bool _finishCastRay( F32 currentT, RayInfo* info )
+{
+   if(currentT != 2)
+   {
+      PlaneF fakePlane;
+      fakePlane.x = info->normal.x;
+      fakePlane.y = info->normal.y;
+      fakePlane.z = info->normal.z;
+      fakePlane.d = 0;
+
+      PlaneF result;
+      mTransformPlane(info->object->getTransform(), info->object->getScale(), fakePlane, &result);
+      info->normal = result;
+
+      return true;
+   }
+   else
+   {
+      // Do nothing and exit...
+      return false;
+   }
+}
+
 //=============================================================================
 //    SceneContainer.
 //=============================================================================
@@ -121,6 +284,8 @@ SceneContainer::SceneContainer()
    mFreeRefPool = NULL;
    addRefPoolBlock();
 
+   mLooseGrid = smUseLooseGrid ? new LooseGrid : NULL;
+
    cleanupSearchVectors();
 }
 
@@ -129,6 +294,7 @@ SceneContainer::SceneContainer()
 SceneContainer::~SceneContainer()
 {
    delete[] mBinArray;
+   SAFE_DELETE( mLooseGrid );
 
    for (U32 i = 0; i < mRefPoolBlocks.size(); i++)
    {
@@ -228,6 +394,15 @@ void SceneContainer::insertIntoBins(SceneObject* obj)
    AssertFatal(obj != NULL, "No object?");
    AssertFatal(obj->mBinRefHead == NULL, "Error, already have a bin chain!");
 
+   if ( mLooseGrid )
+   {
+      U32 level;
+      S32 x, y;
+      _getLooseCell( obj, level, x, y );
+      _insertIntoLooseGrid( obj, level, x, y );
+      return;
+   }
+
    // The first thing we do is find which bins are covered in x and y...
    const Box3F* pWBox = &obj->getWorldBox();
 
@@ -393,6 +568,21 @@ void SceneContainer::checkBins(SceneObject* obj)
 
    // Otherwise, the object is already in the bins.  Let's see if it has strayed out of
    //  the bins that it's currently in...
+   if ( mLooseGrid )
+   {
+      U32 level;
+      S32 x, y;
+      _getLooseCell( obj, level, x, y );
+
+      if ( obj->mBinMaxX != level || obj->mBinMinX != U32( x ) || obj->mBinMinY != U32( y ) )
+      {
+         removeFromBins( obj );
+         _insertIntoLooseGrid( obj, level, x, y );
+      }
+      PROFILE_END();
+      return;
+   }
+
    const Box3F* pWBox = &obj->getWorldBox();
 
    U32 minX, maxX, minY, maxY;
@@ -411,6 +601,156 @@ void SceneContainer::checkBins(SceneObject* obj)
 
 //-----------------------------------------------------------------------------
 
+void SceneContainer::setLooseGrid( bool enable )
+{
+   if ( enable == isLooseGrid() )
+      return;
+
+   AssertFatal( !mSearchInProgress, "SceneContainer::setLooseGrid - Cannot switch during a query" );
+
+   // Pull everything out of the current structure.
+   for ( Link* itr = mStart.next; itr != &mEnd; itr = itr->next )
+   {
+      SceneObject* object = static_cast< SceneObject* >( itr );
+      if ( object->mBinRefHead )
+         removeFromBins( object );
+   }
+
+   if ( enable )
+      mLooseGrid = new LooseGrid;
+   else
+      SAFE_DELETE( mLooseGrid );
+
+   for ( Link* itr = mStart.next; itr != &mEnd; itr = itr->next )
+      insertIntoBins( static_cast< SceneObject* >( itr ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneContainer::updateLooseGridPref()
+{
+   gServerContainer.setLooseGrid( smUseLooseGrid );
+   gClientContainer.setLooseGrid( smUseLooseGrid );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneContainer::_getLooseCell( SceneObject* object, U32& level, S32& x, S32& y ) const
+{
+   level = csmLooseNumLevels;
+   x = y = 0;
+
+   if ( object->isGlobalBounds() )
+      return;
+
+   const Box3F& worldBox = object->getWorldBox();
+   const F32 size = getMax( worldBox.len_x(), worldBox.len_y() );
+   const Point3F center = worldBox.getCenter();
+
+   for ( U32 i = 0; i < csmLooseNumLevels; i++ )
+   {
+      const F32 cellSize = mLooseGrid->levels[ i ].cellSize;
+      if ( !( size <= cellSize ) )
+         continue;
+
+      // Written so that NaNs also end up in the overflow bin.
+      const F32 cx = mFloor( center.x / cellSize );
+      const F32 cy = mFloor( center.y / cellSize );
+      if ( !( mFabs( cx ) <= csmLooseMaxCell ) || !( mFabs( cy ) <= csmLooseMaxCell ) )
+         return;
+
+      level = i;
+      x = S32( cx );
+      y = S32( cy );
+      return;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneContainer::_insertIntoLooseGrid( SceneObject* obj, U32 level, S32 x, S32 y )
+{
+   PROFILE_SCOPE( SceneContainer_InsertIntoLooseGrid );
+
+   obj->mBinMinX = U32( x );
+   obj->mBinMaxX = level;
+   obj->mBinMinY = U32( y );
+   obj->mBinMaxY = U32( y );
+
+   SceneObjectRef* head = &mOverflowBin;
+   if ( level < csmLooseNumLevels )
+      head = &mLooseGrid->findOrCreateCell( level, x, y )->head;
+
+   SceneObjectRef* ref = allocateObjectRef();
+
+   ref->object    = obj;
+   ref->nextInBin = head->nextInBin;
+   ref->prevInBin = head;
+   ref->nextInObj = NULL;
+
+   if ( head->nextInBin )
+      head->nextInBin->prevInBin = ref;
+   head->nextInBin = ref;
+
+   obj->mBinRefHead = ref;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneContainer::_findLooseObjects( const Box3F& box, U32 mask, FindCallback callback, void* key, const Frustum* frustum )
+{
+   PROFILE_SCOPE( SceneContainer_FindLooseObjects );
+
+   for ( U32 i = 0; i < csmLooseNumLevels; i++ )
+   {
+      LooseGrid::Level& level = mLooseGrid->levels[ i ];
+      if ( level.cells.empty() )
+         continue;
+
+      S32 minX, maxX, minY, maxY;
+      level.getCellRange( box.minExtents.x, box.maxExtents.x, minX, maxX );
+      level.getCellRange( box.minExtents.y, box.maxExtents.y, minY, maxY );
+
+      // Large query boxes on fine levels cover far more cells than are in use,
+      // so walk the existing cells instead of probing the map.
+      const U64 numCells = U64( maxX - minX + 1 ) * U64( maxY - minY + 1 );
+      if ( numCells > level.cells.size() )
+      {
+         for ( U32 j = 0; j < level.cells.size(); j++ )
+         {
+            LooseGrid::Cell* cell = level.cells[ j ];
+            if ( !cell->head.nextInBin ||
+                 cell->x < minX || cell->x > maxX || cell->y < minY || cell->y > maxY )
+               continue;
+
+            if ( frustum && frustum->isCulled( level.getCellBox( cell, box.minExtents.z, box.maxExtents.z ) ) )
+               continue;
+
+            _findInLooseChain( cell->head.nextInBin, box, mask, frustum, callback, key );
+         }
+      }
+      else
+      {
+         for ( S32 y = minY; y <= maxY; y++ )
+            for ( S32 x = minX; x <= maxX; x++ )
+            {
+               LooseGrid::Cell* cell = level.findCell( x, y );
+               if ( !cell || !cell->head.nextInBin )
+                  continue;
+
+               if ( frustum && frustum->isCulled( level.getCellBox( cell, box.minExtents.z, box.maxExtents.z ) ) )
+                  continue;
+
+               _findInLooseChain( cell->head.nextInBin, box, mask, frustum, callback, key );
+            }
+      }
+   }
+
+   _findInLooseChain( mOverflowBin.nextInBin, box, mask, frustum, callback, key );
+}
+
+//-----------------------------------------------------------------------------
+
 void SceneContainer::findObjects(const Box3F& box, U32 mask, FindCallback callback, void *key)
 {
    PROFILE_SCOPE(ContainerFindObjects_Box);
@@ -433,6 +773,13 @@ void SceneContainer::findObjects(const Box3F& box, U32 mask, FindCallback callba
    AssertFatal( !mSearchInProgress, "SceneContainer::findObjects - Container queries are not re-entrant" );
    mSearchInProgress = true;
 
+   if ( mLooseGrid )
+   {
+      _findLooseObjects( box, mask, callback, key );
+      mSearchInProgress = false;
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(box.minExtents.x, box.maxExtents.x, minX, maxX);
    getBinRange(box.minExtents.y, box.maxExtents.y, minY, maxY);
@@ -511,6 +858,13 @@ void SceneContainer::findObjects( const Frustum &frustum, U32 mask, FindCallback
    AssertFatal( !mSearchInProgress, "SceneContainer::findObjects - Container queries are not re-entrant" );
    mSearchInProgress = true;
 
+   if ( mLooseGrid )
+   {
+      _findLooseObjects( searchBox, mask, callback, key, &frustum );
+      mSearchInProgress = false;
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(searchBox.minExtents.x, searchBox.maxExtents.x, minX, maxX);
    getBinRange(searchBox.minExtents.y, searchBox.maxExtents.y, minY, maxY);
@@ -608,6 +962,13 @@ void SceneContainer::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mas
    AssertFatal( !mSearchInProgress, "SceneContainer::polyhedronFindObjects - Container queries are not re-entrant" );
    mSearchInProgress = true;
 
+   if ( mLooseGrid )
+   {
+      _findLooseObjects( box, mask, callback, key );
+      mSearchInProgress = false;
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(box.minExtents.x, box.maxExtents.x, minX, maxX);
    getBinRange(box.minExtents.y, box.maxExtents.y, minY, maxY);
@@ -673,6 +1034,13 @@ void SceneContainer::findObjectList( const Box3F& searchBox, U32 mask, Vector<Sc
 
    // TODO: Optimize for water and zones?
 
+   if ( mLooseGrid )
+   {
+      _findLooseObjects( searchBox, mask, _pushBackCallback, outFound );
+      mSearchInProgress = false;
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(searchBox.minExtents.x, searchBox.maxExtents.x, minX, maxX);
    getBinRange(searchBox.minExtents.y, searchBox.maxExtents.y, minY, maxY);
@@ -853,6 +1221,9 @@ bool SceneContainer::castRayRendered( const Point3F& start, const Point3F& end,
 
 bool SceneContainer::_castRay( U32 type, const Point3F& start, const Point3F& end, U32 mask, RayInfo* info, CastRayCallback callback )
 {
+   if ( mLooseGrid )
+      return _castRayLoose( type, start, end, mask, info, callback );
+
    AssertFatal( !mSearchInProgress, "SceneContainer::_castRay - Container queries are not re-entrant" );
    mSearchInProgress = true;
 
@@ -1104,25 +1475,392 @@ bool SceneContainer::_castRay( U32 type, const Point3F& start, const Point3F& en
    mSearchInProgress = false;
 
    // Bump the normal into worldspace if appropriate.
-   if(currentT != 2)
+   return _finishCastRay( currentT, info );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneContainer::_castRayObject( U32 type, SceneObject* ptr, const Point3F& start, const Point3F& end, RayInfo* info, F32& currentT, CastRayCallback callback )
+{
+   Point3F xformedStart, xformedEnd;
+   ptr->mWorldToObj.mulP(start, &xformedStart);
+   ptr->mWorldToObj.mulP(end,   &xformedEnd);
+   xformedStart.convolveInverse(ptr->mObjScale);
+   xformedEnd.convolveInverse(ptr->mObjScale);
+
+   RayInfo ri;
+   ri.generateTexCoord  = info->generateTexCoord;
+   bool result = false;
+   if (type == CollisionGeometry)
+      result = ptr->castRay(xformedStart, xformedEnd, &ri);
+   else if (type == RenderedGeometry)
+      result = ptr->castRayRendered(xformedStart, xformedEnd, &ri);
+   if (result)
    {
-      PlaneF fakePlane;
-      fakePlane.x = info->normal.x;
-      fakePlane.y = info->normal.y;
-      fakePlane.z = info->normal.z;
-      fakePlane.d = 0;
+      if( ri.t < currentT && ( !callback || callback( &ri ) ) )
+      {
+         *info = ri;
+         info->point.interpolate(start, end, info->t);
+         currentT = ri.t;
+         info->distance = (start - info->point).len();
+      }
+   }
+}
 
-      PlaneF result;
-      mTransformPlane(info->object->getTransform(), info->object->getScale(), fakePlane, &result);
-      info->normal = result;
+//-----------------------------------------------------------------------------
 
-      return true;
+bool SceneContainer::_castRayLoose( U32 type, const Point3F& start, const Point3F& end, U32 mask, RayInfo* info, CastRayCallback callback )
+{
+   AssertFatal( !mSearchInProgress, "SceneContainer::_castRayLoose - Container queries are not re-entrant" );
+   mSearchInProgress = true;
+
+   F32 currentT = 2.0;
+
+   for ( SceneObjectRef* chain = mOverflowBin.nextInBin; chain; chain = chain->nextInBin )
+   {
+      // As with the bin grid, overflow objects are not box tested.
+      SceneObject* ptr = chain->object;
+      if ( ( ptr->getTypeMask() & mask ) != 0 && ptr->isCollisionEnabled() )
+         _castRayObject( type, ptr, start, end, info, currentT, callback );
    }
-   else
+
+   const Point3F delta = end - start;
+   const F32 minZ = getMin( start.z, end.z ) - 1.0f;
+   const F32 maxZ = getMax( start.z, end.z ) + 1.0f;
+
+   for ( U32 i = 0; i < csmLooseNumLevels; i++ )
    {
-      // Do nothing and exit...
-      return false;
+      LooseGrid::Level& level = mLooseGrid->levels[ i ];
+      if ( level.cells.empty() )
+         continue;
+
+      const F32 cellSize = level.cellSize;
+      const F32 margin = cellSize * 0.5f;
+
+      S32 minX, maxX, minY, maxY;
+      level.getCellRange( getMin( start.x, end.x ), getMax( start.x, end.x ), minX, maxX );
+      level.getCellRange( getMin( start.y, end.y ), getMax( start.y, end.y ), minY, maxY );
+
+      // Gather the cells the line passes through.  A line touches about twice as
+      // many loose cells as it crosses tight ones; if that is more than the cells on
+      // the level, just test them all.
+      mLooseCellList.clear();
+      if ( 2 * ( ( maxX - minX + 1 ) + ( maxY - minY + 1 ) ) > level.cells.size() )
+      {
+         for ( U32 j = 0; j < level.cells.size(); j++ )
+         {
+            LooseGrid::Cell* cell = level.cells[ j ];
+            if ( cell->head.nextInBin &&
+                 level.getCellBox( cell, minZ, maxZ ).collideLine( start, end ) )
+               mLooseCellList.push_back( &cell->head );
+         }
+      }
+      else
+      {
+         // Scan the columns crossed by the line, finding the rows covered in each.
+         for ( S32 x = minX; x <= maxX; x++ )
+         {
+            F32 t0 = 0.0f;
+            F32 t1 = 1.0f;
+            if ( delta.x != 0.0f )
+            {
+               F32 ta = ( x * cellSize - margin - start.x ) / delta.x;
+               F32 tb = ( ( x + 1 ) * cellSize + margin - start.x ) / delta.x;
+               if ( ta > tb )
+                  ::swap( ta, tb );
+               t0 = getMax( t0, ta );
+               t1 = getMin( t1, tb );
+               if ( t0 > t1 )
+                  continue;
+            }
+
+            const F32 y0 = start.y + delta.y * t0;
+            const F32 y1 = start.y + delta.y * t1;
+
+            S32 rowMin, rowMax;
+            level.getCellRange( getMin( y0, y1 ), getMax( y0, y1 ), rowMin, rowMax );
+            for ( S32 y = rowMin; y <= rowMax; y++ )
+            {
+               LooseGrid::Cell* cell = level.findCell( x, y );
+               if ( cell && cell->head.nextInBin )
+                  mLooseCellList.push_back( &cell->head );
+            }
+         }
+      }
+
+      for ( U32 j = 0; j < mLooseCellList.size(); j++ )
+      {
+         for ( SceneObjectRef* chain = mLooseCellList[ j ]->nextInBin; chain; chain = chain->nextInBin )
+         {
+            SceneObject* ptr = chain->object;
+            if ( ( ptr->getTypeMask() & mask ) != 0 && ptr->isCollisionEnabled() &&
+                 ptr->getWorldBox().collideLine( start, end ) )
+               _castRayObject( type, ptr, start, end, info, currentT, callback );
+         }
+      }
+   }
+
+   mSearchInProgress = false;
+
+   return _finishCastRay( currentT, info );
+}
+
+//-----------------------------------------------------------------------------
+
+/// Maximum number of rays tested together in castRays().
+static const U32 sMaxRaysPerPacket = 64;
+
+/// Size of the cells used to group castRays() rays into packets.
+static const F32 sRayPacketCellSize = 256.0f;
+
+struct RaySortKey
+{
+   U32 key;
+   U32 ray;
+};
+
+static S32 QSORT_CALLBACK _compareRaySortKeys( const void* a, const void* b )
+{
+   const RaySortKey* keyA = reinterpret_cast< const RaySortKey* >( a );
+   const RaySortKey* keyB = reinterpret_cast< const RaySortKey* >( b );
+   if ( keyA->key != keyB->key )
+      return keyA->key < keyB->key ? -1 : 1;
+   return S32( keyA->ray ) - S32( keyB->ray );
+}
+
+/// State shared by _findRayPacketObjects and the loose grid query callback.
+struct RayPacketGather
+{
+   U32 seqKey;
+   Vector< SceneObject* >* objects;
+};
+
+void SceneContainer::_gatherRayPacketObject( SceneObject* object, void* key )
+{
+   RayPacketGather* gather = reinterpret_cast< RayPacketGather* >( key );
+   if ( object->getContainerSeqKey() != gather->seqKey )
+   {
+      object->setContainerSeqKey( gather->seqKey );
+      gather->objects->push_back( object );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+/// A castRays() call.  Each packet is one task of the set.
+struct SceneContainer::RayBatch : public ThreadPoolTaskSet
+{
+   struct Packet
+   {
+      /// Index of the first ray of the packet in #rays.
+      U32 firstRay;
+      U32 numRays;
+
+      /// Objects potentially hit by the packet's rays.
+      Vector< SceneObject* > objects;
+   };
+
+   U32 type;
+   CastRayCallback callback;
+   const Point3F* starts;
+   const Point3F* ends;
+   RayInfo* infos;
+
+   /// Ray indices ordered by packet.
+   Vector< U32 > rays;
+
+   Vector< Packet > packets;
+
+   void processPacket( Packet& packet )
+   {
+      const U32* packetRays = rays.address() + packet.firstRay;
+
+      // Each ray starts out without a hit.
+      F32 currentT[ sMaxRaysPerPacket ];
+      for ( U32 i = 0; i < packet.numRays; i++ )
+      {
+         currentT[ i ] = 2.0f;
+         infos[ packetRays[ i ] ].object = NULL;
+      }
+
+      for ( U32 j = 0; j < packet.objects.size(); j++ )
+      {
+         SceneObject* ptr = packet.objects[ j ];
+         const Box3F& worldBox = ptr->getWorldBox();
+         const bool isGlobal = ptr->isGlobalBounds();
+
+         for ( U32 i = 0; i < packet.numRays; i++ )
+         {
+            const U32 ray = packetRays[ i ];
+            if ( isGlobal || worldBox.collideLine( starts[ ray ], ends[ ray ] ) )
+               _castRayObject( type, ptr, starts[ ray ], ends[ ray ], &infos[ ray ], currentT[ i ], callback );
+         }
+      }
+
+      for ( U32 i = 0; i < packet.numRays; i++ )
+         _finishCastRay( currentT[ i ], &infos[ packetRays[ i ] ] );
+   }
+
+   void run( bool threaded )
+   {
+      setNumTasks( packets.size() );
+      ThreadPoolTaskSet::run( threaded );
+   }
+
+protected:
+
+   virtual void runTask( U32 index )
+   {
+      processPacket( packets[ index ] );
    }
+};
+
+//-----------------------------------------------------------------------------
+
+void SceneContainer::_findRayPacketObjects( const Point3F* starts, const Point3F* ends, const U32* rays, U32 numRays, U32 mask, Vector< SceneObject* >& outObjects )
+{
+   mCurrSeqKey++;
+
+   RayPacketGather gather;
+   gather.seqKey = mCurrSeqKey;
+   gather.objects = &outObjects;
+
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      const Point3F& start = starts[ rays[ i ] ];
+      const Point3F& end = ends[ rays[ i ] ];
+
+      // Walk the ray in steps of about a bin so that long rays only
+      // touch the bins along the line instead of their whole bounds.
+      const F32 length = getMax( mFabs( end.x - start.x ), mFabs( end.y - start.y ) );
+      const U32 numSteps = getMax( U32( 1 ), U32( mCeil( length / csmBinSize ) ) );
+
+      Point3F segStart = start;
+      for ( U32 step = 1; step <= numSteps; step++ )
+      {
+         Point3F segEnd;
+         segEnd.interpolate( start, end, F32( step ) / F32( numSteps ) );
+
+         Box3F box( segStart, segStart );
+         box.extend( segEnd );
+         segStart = segEnd;
+
+         if ( mLooseGrid )
+         {
+            _findLooseObjects( box, mask, _gatherRayPacketObject, &gather );
+            continue;
+         }
+
+         U32 minX, maxX, minY, maxY;
+         getBinRange( box.minExtents.x, box.maxExtents.x, minX, maxX );
+         getBinRange( box.minExtents.y, box.maxExtents.y, minY, maxY );
+
+         for ( U32 y = minY; y <= maxY; y++ )
+         {
+            U32 base = ( y % csmNumBins ) * csmNumBins;
+            for ( U32 x = minX; x <= maxX; x++ )
+            {
+               for ( SceneObjectRef* chain = mBinArray[ base + ( x % csmNumBins ) ].nextInBin; chain; chain = chain->nextInBin )
+               {
+                  SceneObject* ptr = chain->object;
+                  if ( ptr->getContainerSeqKey() != mCurrSeqKey &&
+                       ( ptr->getTypeMask() & mask ) != 0 && ptr->isCollisionEnabled() &&
+                       ptr->getWorldBox().isOverlapped( box ) )
+                  {
+                     ptr->setContainerSeqKey( mCurrSeqKey );
+                     outObjects.push_back( ptr );
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   // The loose grid query has already covered the overflow bin.
+   if ( !mLooseGrid )
+   {
+      for ( SceneObjectRef* chain = mOverflowBin.nextInBin; chain; chain = chain->nextInBin )
+      {
+         SceneObject* ptr = chain->object;
+         if ( ptr->getContainerSeqKey() != mCurrSeqKey &&
+              ( ptr->getTypeMask() & mask ) != 0 && ptr->isCollisionEnabled() )
+         {
+            ptr->setContainerSeqKey( mCurrSeqKey );
+            outObjects.push_back( ptr );
+         }
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneContainer::castRays( U32 numRays, const Point3F* starts, const Point3F* ends, U32 mask, RayInfo* outInfos, CastRayCallback callback, bool threaded )
+{
+   PROFILE_SCOPE( SceneContainer_CastRays );
+
+   if ( !numRays )
+      return 0;
+
+   AssertFatal( !mSearchInProgress, "SceneContainer::castRays - Container queries are not re-entrant" );
+   mSearchInProgress = true;
+
+   ThreadSafeRef< RayBatch > batch = new RayBatch;
+   batch->type = CollisionGeometry;
+   batch->callback = callback;
+   batch->starts = starts;
+   batch->ends = ends;
+   batch->infos = outInfos;
+
+   // Sort the rays by the cell their midpoint is in so that rays
+   // close to each other end up in the same packet.
+   Vector< RaySortKey > keys;
+   keys.setSize( numRays );
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      AssertFatal( outInfos[ i ].userData == NULL, "SceneContainer::castRays - RayInfo->userData cannot be used here!" );
+
+      Point3F mid = ( starts[ i ] + ends[ i ] ) * 0.5f;
+      S32 x = S32( mClampF( mFloor( mid.x / sRayPacketCellSize ), -32768.0f, 32767.0f ) );
+      S32 y = S32( mClampF( mFloor( mid.y / sRayPacketCellSize ), -32768.0f, 32767.0f ) );
+
+      keys[ i ].key = ( U32( x ) & 0xFFFF ) | ( U32( y ) << 16 );
+      keys[ i ].ray = i;
+   }
+   dQsort( keys.address(), keys.size(), sizeof( RaySortKey ), _compareRaySortKeys );
+
+   batch->rays.setSize( numRays );
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      batch->rays[ i ] = keys[ i ].ray;
+
+      if ( i == 0 || keys[ i ].key != keys[ i - 1 ].key || batch->packets.last().numRays == sMaxRaysPerPacket )
+      {
+         batch->packets.increment();
+         batch->packets.last().firstRay = i;
+         batch->packets.last().numRays = 0;
+      }
+      batch->packets.last().numRays++;
+   }
+
+   // Collect the candidate objects on this thread as the bins are not safe
+   // to walk concurrently.
+   for ( U32 i = 0; i < batch->packets.size(); i++ )
+   {
+      RayBatch::Packet& packet = batch->packets[ i ];
+      _findRayPacketObjects( starts, ends, batch->rays.address() + packet.firstRay, packet.numRays, mask, packet.objects );
+   }
+
+   mSearchInProgress = false;
+
+   // Let the pool help out and work on packets ourselves in the meantime.
+   batch->run( threaded );
+
+   U32 numHits = 0;
+   for ( U32 i = 0; i < numRays; i++ )
+      if ( outInfos[ i ].object )
+         numHits++;
+
+   return numHits;
 }
 
 //-----------------------------------------------------------------------------
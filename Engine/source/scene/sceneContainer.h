@@ -134,6 +134,10 @@ class SimpleQueryList
 /// Database for SceneObjects.
 ///
 /// ScenceContainer implements a grid-based spatial subdivision for the contents of a scene.
+///
+/// By default objects are hashed into a fixed, wrapping grid of bins.  Alternatively,
+/// the container can use a loose grid hierarchy (see setLooseGrid) which does not
+/// wrap and sorts objects into levels by size, which scales better to large worlds.
 class SceneContainer
 {
       enum CastRayType
@@ -192,8 +196,42 @@ class SceneContainer
       static const F32 csmTotalBinSize;
       static const U32 csmRefPoolBlockSize;
 
+      /// @name Loose grid
+      ///
+      /// The loose grid is a hierarchy of unbounded grids whose cell size doubles
+      /// with each level.  An object is stored in exactly one cell: the one holding
+      /// its center on the finest level whose cells are at least as large as the
+      /// object.  Cell contents may thus extend up to half a cell past the cell's
+      /// bounds, which queries account for.  Objects too large for the coarsest
+      /// level go to the overflow bin.
+      ///
+      /// While the loose grid is active, SceneObject::mBinMinX/mBinMinY hold the
+      /// object's cell coordinates and mBinMaxX its level.
+      /// @{
+
+      struct LooseGrid;
+
+      /// The loose grid, or NULL if the bin grid is used.
+      LooseGrid* mLooseGrid;
+
+      /// Scratch list of cells hit by a ray.
+      Vector< SceneObjectRef* > mLooseCellList;
+
+      static const U32 csmLooseNumLevels;
+      static const F32 csmLooseCellSize;
+      static const S32 csmLooseMaxCell;
+
+      /// @}
+
    public:
 
+      /// Whether the containers should use the loose grid rather than the bin grid.
+      /// @see setLooseGrid
+      static bool smUseLooseGrid;
+
+      /// Apply #smUseLooseGrid to the client and server containers.
+      static void updateLooseGridPref();
+
       SceneContainer();
       ~SceneContainer();
 
@@ -247,6 +285,22 @@ class SceneContainer
 
       bool collideBox(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
 
+      /// Test a batch of rays against collision geometry.
+      ///
+      /// Rays are grouped into spatially coherent packets.  The container is walked
+      /// once per packet and each object found is tested against all rays of the
+      /// packet, which is considerably cheaper than casting the rays one by one.
+      ///
+      /// @param numRays Number of rays in @a starts, @a ends and @a outInfos.
+      /// @param outInfos Receives the closest hit of each ray.  The object of
+      ///   rays that did not hit anything is set to NULL.
+      /// @param threaded If true, packets are tested on the global ThreadPool.
+      ///   Only use this if the castRay() implementations of all objects matching
+      ///   @a mask as well as @a callback are safe to call concurrently.
+      /// @return The number of rays that hit something.
+      U32 castRays( U32 numRays, const Point3F* starts, const Point3F* ends, U32 mask, RayInfo* outInfos,
+                    CastRayCallback callback = NULL, bool threaded = false );
+
       /// @}
 
       /// @name Poly list
@@ -280,6 +334,13 @@ class SceneContainer
       void checkBins( SceneObject* object );
       void insertIntoBins(SceneObject*, U32, U32, U32, U32);
 
+      /// Switch between the loose grid and the bin grid.  Any objects already
+      /// in the container are moved over to the new structure.
+      void setLooseGrid( bool enable );
+
+      /// Return true if the container uses the loose grid.
+      bool isLooseGrid() const { return mLooseGrid != NULL; }
+
       void initRadiusSearch(const Point3F& searchPoint,
          const F32      searchRadius,
          const U32      searchMask);
@@ -300,10 +361,39 @@ class SceneContainer
       /// Base cast ray code
       bool _castRay( U32 type, const Point3F &start, const Point3F &end, U32 mask, RayInfo* info, CastRayCallback callback );
 
+      struct RayBatch;
+
+      /// Gather the objects that may be hit by the rays of a castRays() packet.
+      void _findRayPacketObjects( const Point3F* starts, const Point3F* ends, const U32* rays, U32 numRays, U32 mask, Vector< SceneObject* >& outObjects );
+
+      /// Loose grid query callback used by _findRayPacketObjects.
+      static void _gatherRayPacketObject( SceneObject* object, void* key );
+
       void _findSpecialObjects( const Vector< SceneObject* >& vector, U32 mask, FindCallback, void *key = NULL );
       void _findSpecialObjects( const Vector< SceneObject* >& vector, const Box3F &box, U32 mask, FindCallback callback, void *key = NULL );   
 
       static void getBinRange( const F32 min, const F32 max, U32& minBin, U32& maxBin );
+
+      /// @name Loose grid
+      /// @{
+
+      /// Find the loose grid level and cell for an object.  A level of
+      /// csmLooseNumLevels means the object belongs in the overflow bin.
+      void _getLooseCell( SceneObject* object, U32& level, S32& x, S32& y ) const;
+
+      void _insertIntoLooseGrid( SceneObject* object, U32 level, S32 x, S32 y );
+
+      /// Shared query over the loose grid.  If @a frustum is given, objects are
+      /// also culled against it.
+      void _findLooseObjects( const Box3F& box, U32 mask, FindCallback callback, void* key, const Frustum* frustum = NULL );
+
+      bool _castRayLoose( U32 type, const Point3F &start, const Point3F &end, U32 mask, RayInfo* info, CastRayCallback callback );
+
+      /// Test a ray against a single object, updating @a info if it is hit
+      /// closer than @a currentT.
+      static void _castRayObject( U32 type, SceneObject* object, const Point3F &start, const Point3F &end, RayInfo* info, F32& currentT, CastRayCallback callback );
+
+      /// @}
 };
 
 //-----------------------------------------------------------------------------
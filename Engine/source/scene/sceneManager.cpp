@@ -83,6 +83,13 @@ MODULE_BEGIN( Scene )
       Con::addVariable( "$Scene::occluderMinHeightPercentage", TypeF32, &SceneCullingState::smOccluderMinHeightPercentage,
          "TODO\n\n"
          "@ingroup Rendering" );
+
+      Con::addVariable( "$Scene::useLooseGridContainer", TypeBool, &SceneContainer::smUseLooseGrid,
+         "If true, the client and server containers index objects in a hierarchical loose grid instead of "
+         "the wrapping bin grid.  This scales better to very large worlds and dense object counts.\n\n"
+         "@ingroup Rendering" );
+      Con::NotifyDelegate looseGridCallback( &SceneContainer::updateLooseGridPref );
+      Con::addVariableNotify( "$Scene::useLooseGridContainer", looseGridCallback );
    }
    
    MODULE_SHUTDOWN
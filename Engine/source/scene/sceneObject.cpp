@@ -814,6 +814,20 @@ U32 SceneObject::packUpdate( NetConnection* conn, U32 mask, BitStream* stream )
 
 //-----------------------------------------------------------------------------
 
+bool SceneObject::getPackUpdateKey( NetConnection* conn, U32 mask, U32& key )
+{
+   if ( !Parent::getPackUpdateKey( conn, mask, key ) )
+      return false;
+
+   // MountedMask writes the ghost index of the mount.
+   if ( ( mask & MountedMask ) && mMount.object )
+      key = ( key << ( NetConnection::GhostIdBitSize + 1 ) ) | U32( conn->getGhostIndex( mMount.object ) + 1 );
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
 void SceneObject::unpackUpdate( NetConnection* conn, BitStream* stream )
 {
    Parent::unpackUpdate( conn, stream );
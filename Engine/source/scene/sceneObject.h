@@ -692,6 +692,13 @@ class SceneObject : public NetObject, private SceneContainer::Link, public Proce
       /// @name Rendering
       /// @{
 
+      /// Called for all the objects about to be rendered before any of them
+      /// gets prepRenderImage().  Objects queue their animation here so it
+      /// can be done for all of them at once, see TSShapeInstance::queueAnimate()
+      /// and ParticleEmitter::prepAnimation().
+      /// @param state Rendering state.
+      virtual void prepAnimation( SceneRenderState* ) {}
+
       /// Called when the SceneManager is ready for the registration of render instances.
       /// @param state Rendering state.
       virtual void prepRenderImage( SceneRenderState* state ) {}
@@ -735,6 +742,7 @@ class SceneObject : public NetObject, private SceneContainer::Link, public Proce
       // NetObject.
       virtual U32 packUpdate( NetConnection* conn, U32 mask, BitStream* stream );
       virtual void unpackUpdate( NetConnection* conn, BitStream* stream );
+      virtual bool getPackUpdateKey( NetConnection* conn, U32 mask, U32& key );
       virtual void onCameraScopeQuery( NetConnection* connection, CameraScopeQuery* query );
 
       // SimObject.
@@ -96,6 +96,24 @@ const MatrixF& SceneRenderState::getProjectionMatrix() const
 
 void SceneRenderState::renderObjects( SceneObject** objects, U32 numObjects )
 {
+   // Let the objects queue their animation so whoever listens to the
+   // batch signal can update it all together.
+
+   AnimationBatchSignal& batchSignal = getAnimationBatchSignal();
+   if( !batchSignal.isEmpty() )
+   {
+      PROFILE_START( SceneRenderState_prepAnimations );
+      bool prepAnimations = false;
+      batchSignal.trigger( true, prepAnimations );
+      if( prepAnimations )
+      {
+         for( U32 i = 0; i < numObjects; ++ i )
+            objects[ i ]->prepAnimation( this );
+      }
+      batchSignal.trigger( false, prepAnimations );
+      PROFILE_END();
+   }
+
    // Let the objects batch their stuff.
 
    PROFILE_START( SceneRenderState_prepRenderImages );
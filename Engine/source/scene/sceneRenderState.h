@@ -169,6 +169,21 @@ class SceneRenderState
       /// @param numObjects Number of objects in @a objects.
       void renderObjects( SceneObject** objects, U32 numObjects );
 
+      /// Signal triggered by renderObjects() around the
+      /// SceneObject::prepAnimation() pass.
+      ///
+      /// The first argument is true before the pass and false after it.  On
+      /// the first trigger listeners open their batch and set the second
+      /// argument to true if they want the pass to run; on the second they
+      /// finish the work queued during the pass.
+      typedef Signal< void( bool, bool& ) > AnimationBatchSignal;
+
+      static AnimationBatchSignal& getAnimationBatchSignal()
+      {
+         static AnimationBatchSignal theSignal;
+         return theSignal;
+      }
+
       /// @}
 
       /// @name Lighting
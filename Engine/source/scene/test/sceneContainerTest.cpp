@@ -0,0 +1,453 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2014 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "scene/sceneContainer.h"
+#include "scene/sceneObject.h"
+#include "math/mRandom.h"
+#include "math/util/frustum.h"
+#include "collision/collision.h"
+#include "console/console.h"
+
+/// Axis-aligned box that lives directly in the container without a scene.
+class ContainerTestObject : public SceneObject
+{
+public:
+   ContainerTestObject()
+   {
+      mTypeMask |= StaticObjectType;
+   }
+
+   void setBox( const Box3F& box )
+   {
+      // Keep the object transform at identity so the object box is the world box.
+      mObjBox = box;
+      resetWorldBox();
+   }
+
+   virtual bool castRay( const Point3F& start, const Point3F& end, RayInfo* info )
+   {
+      F32 t;
+      Point3F normal;
+      if ( !mObjBox.collideLine( start, end, &t, &normal ) )
+         return false;
+
+      info->t = t;
+      info->normal = normal;
+      info->object = this;
+      return true;
+   }
+};
+
+static void findCallback( SceneObject* object, void* key )
+{
+   reinterpret_cast< Vector< SceneObject* >* >( key )->push_back( object );
+}
+
+static S32 QSORT_CALLBACK comparePointers( const void* a, const void* b )
+{
+   const SceneObject* objA = *reinterpret_cast< SceneObject* const* >( a );
+   const SceneObject* objB = *reinterpret_cast< SceneObject* const* >( b );
+   return objA < objB ? -1 : ( objA > objB ? 1 : 0 );
+}
+
+static void sortResults( Vector< SceneObject* >& results )
+{
+   if ( !results.empty() )
+      dQsort( results.address(), results.size(), sizeof( SceneObject* ), comparePointers );
+}
+
+/// Random box spread over a square world of the given size.  Mostly small
+/// objects with the odd large one, similar to a typical outdoor level.
+static Box3F randomBox( MRandomLCG& rand, F32 worldSize )
+{
+   const F32 halfWorld = worldSize * 0.5f;
+   const F32 size = rand.randF() < 0.95f ? rand.randF( 0.5f, 20.0f ) : rand.randF( 20.0f, 600.0f );
+
+   Point3F center( rand.randF( -halfWorld, halfWorld ), rand.randF( -halfWorld, halfWorld ), rand.randF( -50.0f, 150.0f ) );
+   Point3F extents( size * rand.randF( 0.25f, 0.5f ), size * rand.randF( 0.25f, 0.5f ), rand.randF( 0.5f, 10.0f ) );
+
+   return Box3F( center - extents, center + extents );
+}
+
+FIXTURE(SceneContainer)
+{
+protected:
+   SceneContainer container;
+   Vector< ContainerTestObject* > objects;
+   MRandomLCG rand;
+
+   virtual void SetUp()
+   {
+      rand.setSeed( 1234 );
+   }
+
+   virtual void TearDown()
+   {
+      for ( U32 i = 0; i < objects.size(); i++ )
+      {
+         container.removeObject( objects[ i ] );
+         delete objects[ i ];
+      }
+      objects.clear();
+   }
+
+   void addObjects( U32 count, F32 worldSize )
+   {
+      for ( U32 i = 0; i < count; i++ )
+      {
+         ContainerTestObject* object = new ContainerTestObject;
+         object->setBox( randomBox( rand, worldSize ) );
+         container.addObject( object );
+         objects.push_back( object );
+      }
+   }
+
+   void findBoth( const Box3F& box, Vector< SceneObject* >& binResults, Vector< SceneObject* >& looseResults )
+   {
+      binResults.clear();
+      looseResults.clear();
+
+      container.setLooseGrid( false );
+      container.findObjects( box, StaticObjectType, findCallback, &binResults );
+      container.setLooseGrid( true );
+      container.findObjects( box, StaticObjectType, findCallback, &looseResults );
+
+      sortResults( binResults );
+      sortResults( looseResults );
+   }
+};
+
+TEST_FIX(SceneContainer, LooseGridBoxQuery)
+{
+   addObjects( 2000, 4096.0f );
+
+   Vector< SceneObject* > binResults;
+   Vector< SceneObject* > looseResults;
+
+   for ( U32 i = 0; i < 200; i++ )
+   {
+      // Mix of small and large query boxes, some reaching past the world.
+      Box3F box = randomBox( rand, 5000.0f );
+      if ( i % 10 == 0 )
+         box.minExtents.x -= 2000.0f;
+
+      findBoth( box, binResults, looseResults );
+
+      ASSERT_EQ( binResults.size(), looseResults.size() )
+         << "Loose grid box query returned a different number of objects";
+      for ( U32 j = 0; j < binResults.size(); j++ )
+         EXPECT_EQ( binResults[ j ], looseResults[ j ] )
+            << "Loose grid box query returned a different object";
+   }
+}
+
+TEST_FIX(SceneContainer, LooseGridFrustumQuery)
+{
+   addObjects( 2000, 4096.0f );
+
+   Vector< SceneObject* > binResults;
+   Vector< SceneObject* > looseResults;
+
+   for ( U32 i = 0; i < 50; i++ )
+   {
+      MatrixF xfm( EulerF( 0.0f, 0.0f, rand.randF( 0.0f, M_2PI_F ) ) );
+      xfm.setPosition( Point3F( rand.randF( -2048.0f, 2048.0f ), rand.randF( -2048.0f, 2048.0f ), 10.0f ) );
+
+      Frustum frustum;
+      frustum.set( false, mDegToRad( 60.0f ), 1.0f, 0.1f, rand.randF( 50.0f, 1000.0f ), xfm );
+
+      binResults.clear();
+      looseResults.clear();
+
+      container.setLooseGrid( false );
+      container.findObjects( frustum, StaticObjectType, findCallback, &binResults );
+      container.setLooseGrid( true );
+      container.findObjects( frustum, StaticObjectType, findCallback, &looseResults );
+
+      sortResults( binResults );
+      sortResults( looseResults );
+
+      ASSERT_EQ( binResults.size(), looseResults.size() )
+         << "Loose grid frustum query returned a different number of objects";
+      for ( U32 j = 0; j < binResults.size(); j++ )
+         EXPECT_EQ( binResults[ j ], looseResults[ j ] )
+            << "Loose grid frustum query returned a different object";
+   }
+}
+
+TEST_FIX(SceneContainer, LooseGridCastRay)
+{
+   addObjects( 2000, 4096.0f );
+
+   for ( U32 i = 0; i < 500; i++ )
+   {
+      Point3F start( rand.randF( -2048.0f, 2048.0f ), rand.randF( -2048.0f, 2048.0f ), rand.randF( 0.0f, 100.0f ) );
+      Point3F end;
+
+      // Straight down rays, axis aligned rays and arbitrary ones.
+      switch ( i % 3 )
+      {
+         case 0: end = start + Point3F( 0.0f, 0.0f, -200.0f ); break;
+         case 1: end = start + Point3F( rand.randF( -3000.0f, 3000.0f ), 0.0f, 0.0f ); break;
+         default: end = start + Point3F( rand.randF( -1500.0f, 1500.0f ), rand.randF( -1500.0f, 1500.0f ), rand.randF( -100.0f, 100.0f ) ); break;
+      }
+
+      RayInfo binInfo;
+      container.setLooseGrid( false );
+      bool binHit = container.castRay( start, end, StaticObjectType, &binInfo );
+
+      RayInfo looseInfo;
+      container.setLooseGrid( true );
+      bool looseHit = container.castRay( start, end, StaticObjectType, &looseInfo );
+
+      ASSERT_EQ( binHit, looseHit )
+         << "Loose grid ray cast hit result differs";
+      if ( binHit )
+      {
+         EXPECT_FLOAT_EQ( binInfo.t, looseInfo.t )
+            << "Loose grid ray cast found a different closest hit";
+      }
+   }
+}
+
+TEST_FIX(SceneContainer, LooseGridMovingObjects)
+{
+   container.setLooseGrid( true );
+   addObjects( 500, 2048.0f );
+
+   // Move and resize everything, then check that queries still find all objects.
+   for ( U32 i = 0; i < objects.size(); i++ )
+   {
+      objects[ i ]->setBox( randomBox( rand, 2048.0f ) );
+      container.checkBins( objects[ i ] );
+   }
+
+   // One object without usable bounds has to end up in the overflow bin.
+   objects[ 0 ]->setGlobalBounds();
+   container.checkBins( objects[ 0 ] );
+
+   for ( U32 i = 0; i < objects.size(); i++ )
+   {
+      Vector< SceneObject* > results;
+      container.findObjects( objects[ i ]->getWorldBox(), StaticObjectType, findCallback, &results );
+
+      bool found = false;
+      for ( U32 j = 0; j < results.size(); j++ )
+         found |= ( results[ j ] == objects[ i ] );
+
+      EXPECT_TRUE( found )
+         << "Moved object not found in loose grid";
+   }
+
+   Vector< SceneObject* > binResults;
+   Vector< SceneObject* > looseResults;
+   findBoth( Box3F( -300.0f, -300.0f, -100.0f, 300.0f, 300.0f, 200.0f ), binResults, looseResults );
+   EXPECT_EQ( binResults.size(), looseResults.size() )
+      << "Loose grid and bin grid disagree after moving objects";
+}
+
+TEST_FIX(SceneContainer, CastRays)
+{
+   addObjects( 2000, 4096.0f );
+
+   const U32 numRays = 300;
+   Vector< Point3F > starts;
+   Vector< Point3F > ends;
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      // Groups of line of sight checks from a few spots plus random long rays.
+      Point3F start( rand.randF( -2048.0f, 2048.0f ), rand.randF( -2048.0f, 2048.0f ), rand.randF( 0.0f, 100.0f ) );
+      if ( i % 4 != 0 && i > 0 )
+         start = starts.last();
+
+      starts.push_back( start );
+      ends.push_back( start + Point3F( rand.randF( -1000.0f, 1000.0f ), rand.randF( -1000.0f, 1000.0f ), rand.randF( -50.0f, 50.0f ) ) );
+   }
+
+   for ( U32 mode = 0; mode < 4; mode++ )
+   {
+      const bool useLoose = ( mode & 1 ) != 0;
+      const bool threaded = ( mode & 2 ) != 0;
+      container.setLooseGrid( useLoose );
+
+      Vector< RayInfo > infos;
+      infos.setSize( numRays );
+      const U32 numHits = container.castRays( numRays, starts.address(), ends.address(), StaticObjectType, infos.address(), NULL, threaded );
+
+      U32 expectedHits = 0;
+      for ( U32 i = 0; i < numRays; i++ )
+      {
+         RayInfo info;
+         const bool hit = container.castRay( starts[ i ], ends[ i ], StaticObjectType, &info );
+         if ( hit )
+            expectedHits++;
+
+         ASSERT_EQ( hit, infos[ i ].object != NULL )
+            << "castRays hit result differs from castRay";
+         if ( hit )
+         {
+            EXPECT_EQ( info.object, infos[ i ].object )
+               << "castRays found a different object than castRay";
+            EXPECT_FLOAT_EQ( info.t, infos[ i ].t )
+               << "castRays found a different hit than castRay";
+         }
+      }
+
+      EXPECT_EQ( expectedHits, numHits )
+         << "castRays returned the wrong number of hits";
+   }
+}
+
+/// Times 256 line of sight checks cast one at a time against
+/// the batched and threaded castRays() over a large world.
+TEST_FIX(SceneContainer, CastRaysBatchCost)
+{
+   addObjects( 100000, 16384.0f );
+
+   // 256 line of sight checks from 16 AIs to targets around them.
+   const U32 numRays = 256;
+   const U32 numIterations = 100;
+   Point3F starts[ numRays ];
+   Point3F ends[ numRays ];
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      if ( i % 16 == 0 )
+         starts[ i ].set( rand.randF( -7000.0f, 7000.0f ), rand.randF( -7000.0f, 7000.0f ), 20.0f );
+      else
+         starts[ i ] = starts[ i - 1 ];
+      ends[ i ] = starts[ i ] + Point3F( rand.randF( -150.0f, 150.0f ), rand.randF( -150.0f, 150.0f ), rand.randF( -10.0f, 10.0f ) );
+   }
+
+   RayInfo singleInfos[ numRays ];
+   RayInfo infos[ numRays ];
+   for ( U32 useLoose = 0; useLoose < 2; useLoose++ )
+   {
+      container.setLooseGrid( useLoose != 0 );
+
+      U32 start = Platform::getRealMilliseconds();
+      for ( U32 n = 0; n < numIterations; n++ )
+         for ( U32 i = 0; i < numRays; i++ )
+         {
+            singleInfos[ i ].object = NULL;
+            container.castRay( starts[ i ], ends[ i ], StaticObjectType, &singleInfos[ i ] );
+         }
+      const U32 singleTime = Platform::getRealMilliseconds() - start;
+
+      start = Platform::getRealMilliseconds();
+      for ( U32 n = 0; n < numIterations; n++ )
+         container.castRays( numRays, starts, ends, StaticObjectType, infos );
+      const U32 batchTime = Platform::getRealMilliseconds() - start;
+
+      for ( U32 i = 0; i < numRays; i++ )
+         ASSERT_EQ( singleInfos[ i ].object, infos[ i ].object ) << "castRays found a different object for ray " << i;
+
+      start = Platform::getRealMilliseconds();
+      for ( U32 n = 0; n < numIterations; n++ )
+         container.castRays( numRays, starts, ends, StaticObjectType, infos, NULL, true );
+      const U32 threadedTime = Platform::getRealMilliseconds() - start;
+
+      for ( U32 i = 0; i < numRays; i++ )
+         ASSERT_EQ( singleInfos[ i ].object, infos[ i ].object ) << "Threaded castRays found a different object for ray " << i;
+
+      Con::printf( "SceneContainer %s, %d x %d rays: castRay %dms, castRays %dms, threaded castRays %dms",
+         useLoose ? "loose grid" : "bin grid", numIterations, numRays, singleTime, batchTime, threadedTime );
+   }
+}
+
+/// The benchmark asked for with the loose grid, comparing the query
+/// cost of both backends.  Both have to find the same objects.
+TEST_FIX(SceneContainer, LooseGridQueryCost)
+{
+   const U32 counts[] = { 10000, 100000, 500000 };
+   const F32 worldSize = 16384.0f;
+   const U32 numQueries = 2000;
+   const U32 numRays = 2000;
+
+   for ( U32 c = 0; c < sizeof( counts ) / sizeof( counts[ 0 ] ); c++ )
+   {
+      TearDown();
+      rand.setSeed( 1234 );
+      container.setLooseGrid( false );
+      addObjects( counts[ c ], worldSize );
+
+      U32 binFound = 0;
+      U32 binHits = 0;
+      for ( U32 useLoose = 0; useLoose < 2; useLoose++ )
+      {
+         U32 start = Platform::getRealMilliseconds();
+         container.setLooseGrid( useLoose != 0 );
+         const U32 rebuildTime = Platform::getRealMilliseconds() - start;
+
+         MRandomLCG queryRand( 5678 );
+         Vector< SceneObject* > results;
+         U32 numFound = 0;
+
+         start = Platform::getRealMilliseconds();
+         for ( U32 i = 0; i < numQueries; i++ )
+         {
+            // 100m - 400m boxes, about what a weapon or AI query covers.
+            const F32 size = queryRand.randF( 50.0f, 200.0f );
+            Point3F center( queryRand.randF( -worldSize * 0.5f, worldSize * 0.5f ),
+                            queryRand.randF( -worldSize * 0.5f, worldSize * 0.5f ), 50.0f );
+
+            results.clear();
+            container.findObjects( Box3F( center - Point3F( size, size, 200.0f ), center + Point3F( size, size, 200.0f ) ),
+                                   StaticObjectType, findCallback, &results );
+            numFound += results.size();
+         }
+         const U32 queryTime = Platform::getRealMilliseconds() - start;
+
+         U32 numHits = 0;
+         start = Platform::getRealMilliseconds();
+         for ( U32 i = 0; i < numRays; i++ )
+         {
+            Point3F rayStart( queryRand.randF( -worldSize * 0.5f, worldSize * 0.5f ),
+                              queryRand.randF( -worldSize * 0.5f, worldSize * 0.5f ), 50.0f );
+            Point3F rayEnd = rayStart + Point3F( queryRand.randF( -500.0f, 500.0f ), queryRand.randF( -500.0f, 500.0f ), 0.0f );
+
+            RayInfo info;
+            if ( container.castRay( rayStart, rayEnd, StaticObjectType, &info ) )
+               numHits++;
+         }
+         const U32 rayTime = Platform::getRealMilliseconds() - start;
+
+         Con::printf( "SceneContainer %s, %d objects: rebuild %dms, %d box queries %dms (%d found), %d rays %dms (%d hits)",
+            useLoose ? "loose grid" : "bin grid", counts[ c ], rebuildTime,
+            numQueries, queryTime, numFound, numRays, rayTime, numHits );
+
+         if ( !useLoose )
+         {
+            binFound = numFound;
+            binHits = numHits;
+         }
+         else
+         {
+            EXPECT_EQ( binFound, numFound ) << "The loose grid found different objects with " << counts[ c ] << " objects";
+            EXPECT_EQ( binHits, numHits ) << "The loose grid hit different objects with " << counts[ c ] << " objects";
+         }
+      }
+   }
+}
+
+#endif
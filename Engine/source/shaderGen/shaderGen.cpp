@@ -30,6 +30,8 @@
 #include "gfx/gfxDevice.h"
 #include "core/memVolume.h"
 #include "core/module.h"
+#include "console/consoleTypes.h"
+#include "shaderGen/featureType.h"
 
 
 MODULE_BEGIN( ShaderGen )
@@ -50,17 +52,55 @@ MODULE_BEGIN( ShaderGen )
 MODULE_END;
 
 
+const U32 ShaderGen::smCacheVersion = 1;
+bool ShaderGen::smUseDiskCache = true;
+bool ShaderGen::smWarmUpCache = true;
+bool ShaderGen::smAsyncGeneration = true;
+S32 ShaderGen::smAsyncBudgetMS = 4;
+
+namespace {
+
+/// Unsaved disk cache entries are written out at most this often.
+const U32 sgCacheSaveIntervalMS = 5000;
+
+const U32 sgCacheFileTag = 0x43475354; // 'TSGC'
+
+} // namespace {}
+
 ShaderGen::ShaderGen()
 {
    mInit = false;
    GFXDevice::getDeviceEventSignal().notify(this, &ShaderGen::_handleGFXEvent);
    mOutput = NULL;
+   mCacheSignature = 0;
+   mCacheValidated = false;
+   mCacheDirty = false;
+   mCacheSaveTime = 0;
+
+   Con::addVariable( "$ShaderGen::useDiskCache", TypeBool, &smUseDiskCache,
+      "@brief Reuse the shaders generated in $shaderGen::cachePath by previous runs.\n\n"
+      "The cache is dropped automatically when the registered shader features change.\n"
+      "@ingroup Materials" );
+   Con::addVariable( "$ShaderGen::warmUpCache", TypeBool, &smWarmUpCache,
+      "@brief Create every shader in the disk cache up front instead of when it is first used.\n\n"
+      "@ingroup Materials" );
+   Con::addVariable( "$ShaderGen::asyncGeneration", TypeBool, &smAsyncGeneration,
+      "@brief Generate new material shaders over several frames, rendering with a simpler "
+      "shader until they are ready.\n\n"
+      "@ingroup Materials" );
+   Con::addVariable( "$ShaderGen::asyncBudgetMS", TypeS32, &smAsyncBudgetMS,
+      "@brief Milliseconds per frame spent generating shaders when $ShaderGen::asyncGeneration is enabled.\n\n"
+      "@ingroup Materials" );
 }
 
 ShaderGen::~ShaderGen()
 {
    GFXDevice::getDeviceEventSignal().remove(this, &ShaderGen::_handleGFXEvent);
    _uninit();
+
+   for ( U32 i = 0; i < mDeferred.size(); i++ )
+      delete mDeferred[i];
+   _clearDiskCache();
 }
 
 void ShaderGen::registerInitDelegate(GFXAdapterType adapterType, ShaderGenInitDelegate& initDelegate)
@@ -77,6 +117,8 @@ bool ShaderGen::_handleGFXEvent(GFXDevice::GFXDeviceEventType event)
       break;
    case GFXDevice::deDestroy :
       {
+         if ( mCacheDirty )
+            _saveDiskCache();
          flushProceduralShaders();
       }
       break;
@@ -152,10 +194,7 @@ void ShaderGen::generateShader( const MaterialFeatureData &featureData,
    char vertShaderName[256];
    char pixShaderName[256];
 
-   // Note:  We use a postfix of _V/_P here so that it sorts the matching
-   // vert and pixel shaders together when listed alphabetically.   
-   dSprintf( vertShaderName, sizeof(vertShaderName), "shadergen:/%s_V.%s", cacheName, mFileEnding.c_str() );
-   dSprintf( pixShaderName, sizeof(pixShaderName), "shadergen:/%s_P.%s", cacheName, mFileEnding.c_str() );
+   _getShaderFileNames( cacheName, vertShaderName, pixShaderName );
    
    dStrcpy( vertFile, vertShaderName );
    dStrcpy( pixFile, pixShaderName );   
@@ -444,9 +483,19 @@ void ShaderGen::_printPixShader( Stream &stream )
    mPrinter->printPixelShaderCloser(stream);
 }
 
-GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, const Vector<String> &samplers )
+void ShaderGen::_getShaderFileNames( const String &cacheKey, char *vertFile, char *pixFile ) const
 {
-   PROFILE_SCOPE( ShaderGen_GetShader );
+   // Note:  We use a postfix of _V/_P here so that it sorts the matching
+   // vert and pixel shaders together when listed alphabetically.   
+   dSprintf( vertFile, 256, "shadergen:/%s_V.%s", cacheKey.c_str(), mFileEnding.c_str() );
+   dSprintf( pixFile, 256, "shadergen:/%s_P.%s", cacheKey.c_str(), mFileEnding.c_str() );
+}
+
+String ShaderGen::_getCacheKey( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros )
+{
+   // Make sure the signature reflects the currently
+   // registered features before we hash with it.
+   _validateDiskCache();
 
    const FeatureSet &features = featureData.codify();
 
@@ -465,20 +514,120 @@ GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const G
    // Don't get paranoid!  This has 1 in 18446744073709551616
    // chance for collision... it won't happen in this lifetime.
    //
-   U64 hash = Torque::hash64( (const U8*)shaderDescription.c_str(), shaderDescription.length(), 0 );
+   // The cache signature is mixed in so that shaders generated
+   // with different features registered don't share files.
+   //
+   U64 hash = Torque::hash64( (const U8*)shaderDescription.c_str(), shaderDescription.length(), mCacheSignature );
    hash = convertHostToLEndian(hash);
    U32 high = (U32)( hash >> 32 );
    U32 low = (U32)( hash & 0x00000000FFFFFFFF );
-   String cacheKey = String::ToString( "%x%x", high, low );
+   return String::ToString( "%x%x", high, low );
+}
+
+GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, const Vector<String> &samplers, bool *outPending )
+{
+   PROFILE_SCOPE( ShaderGen_GetShader );
+
+   if ( outPending )
+      *outPending = false;
+
+   const String cacheKey = _getCacheKey( featureData, vertexFormat, macros );
 
    // return shader if exists
-   GFXShader *match = mProcShaders[cacheKey];
-   if ( match )
-      return match;
+   ShaderMap::Iterator iter = mProcShaders.find( cacheKey );
+   if ( iter != mProcShaders.end() )
+   {
+      // A NULL entry is a deferred shader that failed to
+      // build, so don't queue it again every frame.
+      if ( iter->value || outPending )
+         return iter->value;
+   }
 
-   // if not, then create it
+   // Shaders already on disk are quick to load, everything
+   // else can wait if the caller has a fallback.
+   if ( outPending && smAsyncGeneration && !( _isDiskCacheEnabled() && mDiskCache.contains( cacheKey ) ) )
+   {
+      *outPending = true;
+
+      for ( U32 i = 0; i < mDeferred.size(); i++ )
+      {
+         if ( mDeferred[i]->cacheKey == cacheKey )
+            return NULL;
+      }
+
+      DeferredShader *request = new DeferredShader;
+      request->cacheKey = cacheKey;
+      request->featureData = featureData;
+      request->vertexFormat.copy( *vertexFormat );
+      if ( macros )
+         request->macros = *macros;
+      request->samplers = samplers;
+      mDeferred.push_back( request );
+
+      return NULL;
+   }
+
+   return _createShader( cacheKey, featureData, vertexFormat, macros, samplers );
+}
+
+GFXShader* ShaderGen::getCachedShader( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, const Vector<String> &samplers )
+{
+   PROFILE_SCOPE( ShaderGen_GetCachedShader );
+
+   const String cacheKey = _getCacheKey( featureData, vertexFormat, macros );
+
+   ShaderMap::Iterator iter = mProcShaders.find( cacheKey );
+   if ( iter != mProcShaders.end() )
+      return iter->value;
+
+   return _loadCachedShader( cacheKey, samplers );
+}
+
+GFXShader* ShaderGen::_loadCachedShader( const String &cacheKey, const Vector<String> &samplers )
+{
    char vertFile[256];
    char pixFile[256];
+   _getShaderFileNames( cacheKey, vertFile, pixFile );
+
+   CacheEntry *entry = NULL;
+   if (  !_isDiskCacheEnabled() ||
+         !mDiskCache.tryGetValue( cacheKey, entry ) ||
+         !Torque::FS::IsFile( vertFile ) ||
+         !Torque::FS::IsFile( pixFile ) )
+      return NULL;
+
+   GFXShader *shader = GFX->createShader();
+   if ( !shader )
+      return NULL;
+
+   shader->mInstancingFormat.copy( entry->instancingFormat );
+   if ( !shader->init( vertFile, pixFile, entry->pixVersion, entry->macros, samplers ) )
+   {
+      delete shader;
+      return NULL;
+   }
+
+   mProcShaders[cacheKey] = shader;
+   return shader;
+}
+
+GFXShader* ShaderGen::_createShader(   const String &cacheKey,
+                                       const MaterialFeatureData &featureData,
+                                       const GFXVertexFormat *vertexFormat,
+                                       const Vector<GFXShaderMacro> *macros,
+                                       const Vector<String> &samplers )
+{
+   // If we generated this shader in an earlier run we
+   // can skip running the features again.
+   GFXShader *cached = _loadCachedShader( cacheKey, samplers );
+   if ( cached )
+      return cached;
+
+   char vertFile[256];
+   char pixFile[256];
+   _getShaderFileNames( cacheKey, vertFile, pixFile );
+
+   // if not, then create it
    F32  pixVersion;
 
    Vector<GFXShaderMacro> shaderMacros;
@@ -497,12 +646,294 @@ GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const G
 
    mProcShaders[cacheKey] = shader;
 
+   // Remember how to load it next time.
+   if ( _isDiskCacheEnabled() && Con::getBoolVariable( "ShaderGen::GenNewShaders", true ) )
+   {
+      CacheEntry *entry = NULL;
+      if ( !mDiskCache.tryGetValue( cacheKey, entry ) )
+      {
+         entry = new CacheEntry;
+         mDiskCache.insert( cacheKey, entry );
+      }
+
+      entry->pixVersion = pixVersion;
+      entry->macros = shaderMacros;
+      entry->samplers = samplers;
+      entry->instancingFormat.copy( mInstancingFormat );
+      mCacheDirty = true;
+   }
+
    return shader;
 }
 
+U32 ShaderGen::processDeferredShaders()
+{
+   PROFILE_SCOPE( ShaderGen_ProcessDeferredShaders );
+
+   const U32 startTime = Platform::getRealMilliseconds();
+   U32 count = 0;
+
+   while ( !mDeferred.empty() )
+   {
+      DeferredShader *request = mDeferred.first();
+      mDeferred.pop_front();
+
+      // It may have been needed right away by a caller without a fallback.
+      if ( mProcShaders.contains( request->cacheKey ) )
+      {
+         delete request;
+         continue;
+      }
+
+      // Store failures as well so the callers see
+      // the shader is no longer pending.
+      GFXShader *shader = _createShader(  request->cacheKey,
+                                          request->featureData,
+                                          &request->vertexFormat,
+                                          &request->macros,
+                                          request->samplers );
+      if ( !shader )
+         mProcShaders[request->cacheKey] = NULL;
+
+      delete request;
+      count++;
+
+      if ( Platform::getRealMilliseconds() - startTime >= smAsyncBudgetMS )
+         break;
+   }
+
+   // Write out new cache entries once things settle down.
+   if (  mCacheDirty && 
+         mDeferred.empty() &&
+         Platform::getRealMilliseconds() - mCacheSaveTime > sgCacheSaveIntervalMS )
+      _saveDiskCache();
+
+   return count;
+}
+
 void ShaderGen::flushProceduralShaders()
 {
    // The shaders are reference counted, so we
    // just need to clear the map.
    mProcShaders.clear();  
+
+   // Anything still queued is requested again by the
+   // material instances when they are reinitialized.
+   for ( U32 i = 0; i < mDeferred.size(); i++ )
+      delete mDeferred[i];
+   mDeferred.clear();
+
+   // The features may have changed.
+   mCacheValidated = false;
+}
+
+//----------------------------------------------------------------------------
+// Disk cache
+//----------------------------------------------------------------------------
+
+U32 ShaderGen::_calcCacheSignature() const
+{
+   // Lighting managers register their own features for the same
+   // feature types, so include the feature names as well.
+   String desc = String::ToString( "%d %d %s %g", smCacheVersion, (S32)GFX->getAdapterType(), mFileEnding.c_str(), GFX->getPixelShaderVersion() );
+   for ( U32 i=0; i < FEATUREMGR->getFeatureCount(); i++ )
+   {
+      const FeatureInfo &info = FEATUREMGR->getAt( i );
+      desc += info.type->getName();
+      desc += info.feature->getName();
+   }
+
+   return Torque::hash( (const U8*)desc.c_str(), desc.length(), 0 );
+}
+
+void ShaderGen::_validateDiskCache()
+{
+   if ( mCacheValidated )
+      return;
+
+   mCacheValidated = true;
+
+   const U32 signature = _calcCacheSignature();
+   if ( signature == mCacheSignature )
+      return;
+
+   // Each feature configuration keeps its own cache file, so
+   // switching lighting managers doesn't throw away the other.
+   if ( mCacheDirty )
+      _saveDiskCache();
+
+   mCacheSignature = signature;
+   _loadDiskCache();
+
+   if ( smWarmUpCache )
+      _warmUpDiskCache();
+}
+
+void ShaderGen::_clearDiskCache()
+{
+   for ( CacheMap::Iterator iter = mDiskCache.begin(); iter != mDiskCache.end(); ++iter )
+      delete iter->value;
+   mDiskCache.clear();
+   mCacheDirty = false;
+}
+
+void ShaderGen::_loadDiskCache()
+{
+   _clearDiskCache();
+
+   if ( !_isDiskCacheEnabled() )
+      return;
+
+   FileStream stream;
+   if ( !stream.open( String::ToString( "shadergen:/shaderGenCache_%x.bin", mCacheSignature ), Torque::FS::File::Read ) )
+      return;
+
+   U32 tag = 0, version = 0, signature = 0, count = 0;
+   stream.read( &tag );
+   stream.read( &version );
+   stream.read( &signature );
+   stream.read( &count );
+   if ( tag != sgCacheFileTag || version != smCacheVersion || signature != mCacheSignature )
+      return;
+
+   for ( U32 i = 0; i < count && stream.getStatus() == Stream::Ok; i++ )
+   {
+      String cacheKey;
+      stream.read( &cacheKey );
+
+      CacheEntry *entry = new CacheEntry;
+      stream.read( &entry->pixVersion );
+
+      U32 numMacros = 0;
+      stream.read( &numMacros );
+      entry->macros.setSize( numMacros );
+      for ( U32 j = 0; j < numMacros; j++ )
+      {
+         stream.read( &entry->macros[j].name );
+         stream.read( &entry->macros[j].value );
+      }
+
+      U32 numSamplers = 0;
+      stream.read( &numSamplers );
+      entry->samplers.setSize( numSamplers );
+      for ( U32 j = 0; j < numSamplers; j++ )
+         stream.read( &entry->samplers[j] );
+
+      U32 numElements = 0;
+      stream.read( &numElements );
+      for ( U32 j = 0; j < numElements; j++ )
+      {
+         String semantic;
+         U32 type = 0, index = 0;
+         stream.read( &semantic );
+         stream.read( &type );
+         stream.read( &index );
+         entry->instancingFormat.addElement( semantic, (GFXDeclType)type, index );
+      }
+
+      mDiskCache.insert( cacheKey, entry );
+   }
+
+   // Don't trust any of it if the file was cut short.
+   if ( stream.getStatus() != Stream::Ok && stream.getStatus() != Stream::EOS )
+      _clearDiskCache();
+}
+
+void ShaderGen::_saveDiskCache()
+{
+   mCacheDirty = false;
+   mCacheSaveTime = Platform::getRealMilliseconds();
+
+   if ( !_isDiskCacheEnabled() )
+      return;
+
+   FileStream stream;
+   if ( !stream.open( String::ToString( "shadergen:/shaderGenCache_%x.bin", mCacheSignature ), Torque::FS::File::Write ) )
+      return;
+
+   stream.write( sgCacheFileTag );
+   stream.write( smCacheVersion );
+   stream.write( mCacheSignature );
+   stream.write( (U32)mDiskCache.size() );
+
+   for ( CacheMap::Iterator iter = mDiskCache.begin(); iter != mDiskCache.end(); ++iter )
+   {
+      const CacheEntry *entry = iter->value;
+
+      stream.write( iter->key );
+      stream.write( entry->pixVersion );
+
+      stream.write( (U32)entry->macros.size() );
+      for ( U32 j = 0; j < entry->macros.size(); j++ )
+      {
+         stream.write( entry->macros[j].name );
+         stream.write( entry->macros[j].value );
+      }
+
+      stream.write( (U32)entry->samplers.size() );
+      for ( U32 j = 0; j < entry->samplers.size(); j++ )
+         stream.write( entry->samplers[j] );
+
+      stream.write( entry->instancingFormat.getElementCount() );
+      for ( U32 j = 0; j < entry->instancingFormat.getElementCount(); j++ )
+      {
+         const GFXVertexElement &element = entry->instancingFormat.getElement( j );
+         stream.write( element.getSemantic() );
+         stream.write( (U32)element.getType() );
+         stream.write( element.getSemanticIndex() );
+      }
+   }
+}
+
+void ShaderGen::_warmUpDiskCache()
+{
+   PROFILE_SCOPE( ShaderGen_WarmUpDiskCache );
+
+   if ( mDiskCache.isEmpty() )
+      return;
+
+   const U32 startTime = Platform::getRealMilliseconds();
+
+   Vector<String> failed;
+   U32 count = 0;
+
+   for ( CacheMap::Iterator iter = mDiskCache.begin(); iter != mDiskCache.end(); ++iter )
+   {
+      if ( mProcShaders.contains( iter->key ) )
+         continue;
+
+      char vertFile[256];
+      char pixFile[256];
+      _getShaderFileNames( iter->key, vertFile, pixFile );
+
+      const CacheEntry *entry = iter->value;
+      GFXShader *shader = NULL;
+      if ( Torque::FS::IsFile( vertFile ) && Torque::FS::IsFile( pixFile ) )
+      {
+         shader = GFX->createShader();
+         shader->mInstancingFormat.copy( entry->instancingFormat );
+         if ( !shader->init( vertFile, pixFile, entry->pixVersion, entry->macros, entry->samplers ) )
+            SAFE_DELETE( shader );
+      }
+
+      if ( shader )
+      {
+         mProcShaders[iter->key] = shader;
+         count++;
+      }
+      else
+         failed.push_back( iter->key );
+   }
+
+   // Forget the ones that are gone or broken, they
+   // will be generated again when they are needed.
+   for ( U32 i = 0; i < failed.size(); i++ )
+   {
+      CacheMap::Iterator iter = mDiskCache.find( failed[i] );
+      delete iter->value;
+      mDiskCache.erase( iter );
+      mCacheDirty = true;
+   }
+
+   Con::printf( "ShaderGen: Warmed up %d cached shaders in %dms", count, Platform::getRealMilliseconds() - startTime );
 }
@@ -155,12 +155,44 @@ public:
                         Vector<GFXShaderMacro> &macros );
 
    // Returns a shader that implements the features listed by dat.
-   GFXShader* getShader( const MaterialFeatureData &dat, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, const Vector<String> &samplers );
+   //
+   // If outPending is passed and asynchronous generation is enabled a shader
+   // that isn't ready yet is queued for processDeferredShaders() instead, in
+   // which case NULL is returned and outPending is set to true.
+   GFXShader* getShader( const MaterialFeatureData &dat, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, const Vector<String> &samplers, bool *outPending = NULL );
+
+   /// Returns the shader only if it is already created or can be loaded
+   /// from the disk cache, without generating anything.
+   GFXShader* getCachedShader( const MaterialFeatureData &dat, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, const Vector<String> &samplers );
+
+   /// Generates and compiles queued shaders until the time budget is
+   /// used up, always finishing at least one.  Returns the number of
+   /// shaders that finished.
+   U32 processDeferredShaders();
+
+   /// Returns true if there are queued shaders left to generate.
+   bool hasDeferredShaders() const { return !mDeferred.empty(); }
 
    // This will delete all of the procedural shaders that we have.  Used to regenerate shaders when
    // the ShaderFeatures have changed (due to lighting system change, or new plugin)
    virtual void flushProceduralShaders();
 
+   /// Bump this when a change to shader generation must invalidate
+   /// the shaders cached on disk by previous builds.
+   static const U32 smCacheVersion;
+
+   /// Reuse generated shaders from previous runs.
+   static bool smUseDiskCache;
+
+   /// Create all the shaders from the disk cache the first time one is asked for.
+   static bool smWarmUpCache;
+
+   /// Let materials render with a fallback while their shaders are generated.
+   static bool smAsyncGeneration;
+
+   /// Milliseconds per frame spent generating queued shaders.
+   static S32 smAsyncBudgetMS;
+
    void setPrinter(ShaderGenPrinter* printer) { mPrinter = printer; }
    void setComponentFactory(ShaderGenComponentFactory* factory) { mComponentFactory = factory; }
    void setFileEnding(String ending) { mFileEnding = ending; }
@@ -195,6 +227,43 @@ protected:
    typedef Map<String, GFXShaderRef> ShaderMap;
    ShaderMap mProcShaders;
 
+   /// What is needed to create a previously generated
+   /// shader without running the features again.
+   struct CacheEntry
+   {
+      F32 pixVersion;
+      Vector<GFXShaderMacro> macros;
+      Vector<String> samplers;
+      GFXVertexFormat instancingFormat;
+   };
+
+   /// Map of cache string -> shaders generated on disk.
+   typedef Map<String, CacheEntry*> CacheMap;
+   CacheMap mDiskCache;
+
+   /// Hash of everything other than the features, vertex format and
+   /// macros which changes the generated code.
+   U32 mCacheSignature;
+
+   /// Set once the disk cache has been checked against the registered features.
+   bool mCacheValidated;
+
+   /// Set when the disk cache has entries that are not saved yet.
+   bool mCacheDirty;
+   U32 mCacheSaveTime;
+
+   /// A shader request waiting for processDeferredShaders().
+   struct DeferredShader
+   {
+      String cacheKey;
+      MaterialFeatureData featureData;
+      GFXVertexFormat vertexFormat;
+      Vector<GFXShaderMacro> macros;
+      Vector<String> samplers;
+   };
+
+   Vector<DeferredShader*> mDeferred;
+
    ShaderGen();
 
    bool _handleGFXEvent(GFXDevice::GFXDeviceEventType event);
@@ -202,6 +271,35 @@ protected:
    /// Causes the init delegate to be called.
    void initShaderGen();
 
+   /// Generates or loads the shader for a cache key and adds it to mProcShaders.
+   GFXShader* _createShader(  const String &cacheKey,
+                              const MaterialFeatureData &featureData,
+                              const GFXVertexFormat *vertexFormat,
+                              const Vector<GFXShaderMacro> *macros,
+                              const Vector<String> &samplers );
+
+   /// Loads the shader for a cache key from the disk cache and adds
+   /// it to mProcShaders.  Returns NULL if it isn't cached.
+   GFXShader* _loadCachedShader( const String &cacheKey, const Vector<String> &samplers );
+
+   /// Returns the key of the shader in mProcShaders and the disk cache.
+   String _getCacheKey( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros );
+
+   void _getShaderFileNames( const String &cacheKey, char *vertFile, char *pixFile ) const;
+
+   /// Returns true if generated shaders can be kept between runs.
+   bool _isDiskCacheEnabled() const { return smUseDiskCache && mMemFS.isNull(); }
+
+   /// Drops the disk cache if the features changed since it was
+   /// written and warms up the shaders left in it.
+   void _validateDiskCache();
+
+   U32 _calcCacheSignature() const;
+   void _loadDiskCache();
+   void _saveDiskCache();
+   void _clearDiskCache();
+   void _warmUpDiskCache();
+
    void _init();
    void _uninit();
 
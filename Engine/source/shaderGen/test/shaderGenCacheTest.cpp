@@ -0,0 +1,246 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "shaderGen/shaderGen.h"
+#include "materials/materialFeatureTypes.h"
+#include "gfx/gfxDevice.h"
+#include "core/memVolume.h"
+
+/// A ShaderGen of its own, so the tests can fill in and
+/// reload the disk cache without generating any shaders.
+class ShaderGenCacheTester : public ShaderGen
+{
+public:
+   ShaderGenCacheTester()
+   {
+      // Keeps _getCacheKey() from loading the real cache.
+      mCacheValidated = true;
+      mCacheSignature = 0x1234;
+   }
+
+   void addEntry( const String &cacheKey, F32 pixVersion, const String &sampler )
+   {
+      CacheEntry *entry = new CacheEntry;
+      entry->pixVersion = pixVersion;
+      entry->macros.push_back( GFXShaderMacro( "TORQUE_SHADERGEN" ) );
+      entry->macros.push_back( GFXShaderMacro( "CACHE_TEST", cacheKey ) );
+      entry->samplers.push_back( sampler );
+      entry->instancingFormat.addElement( "INST_TEST", GFXDeclType_Float4, 8 );
+      mDiskCache.insert( cacheKey, entry );
+   }
+
+   bool hasEntry( const String &cacheKey, F32 pixVersion, const String &sampler ) const
+   {
+      CacheMap::ConstIterator iter = mDiskCache.find( cacheKey );
+      if ( iter == mDiskCache.end() )
+         return false;
+
+      const CacheEntry *entry = iter->value;
+      return   entry->pixVersion == pixVersion &&
+               entry->macros.size() == 2 &&
+               entry->macros[0].name == String( "TORQUE_SHADERGEN" ) &&
+               entry->macros[1].name == String( "CACHE_TEST" ) &&
+               entry->macros[1].value == cacheKey &&
+               entry->samplers.size() == 1 &&
+               entry->samplers[0] == sampler &&
+               entry->instancingFormat.getElementCount() == 1 &&
+               entry->instancingFormat.getElement( 0 ).isSemantic( "INST_TEST" ) &&
+               entry->instancingFormat.getElement( 0 ).getType() == GFXDeclType_Float4 &&
+               entry->instancingFormat.getElement( 0 ).getSemanticIndex() == 8;
+   }
+
+   U32 getCacheSize() const { return mDiskCache.size(); }
+   U32 getDeferredCount() const { return mDeferred.size(); }
+
+   U32 getSignature() const { return mCacheSignature; }
+   void setSignature( U32 signature ) { mCacheSignature = signature; }
+   U32 calcSignature() const { return _calcCacheSignature(); }
+
+   void save() { _saveDiskCache(); }
+   void load() { _loadDiskCache(); }
+   void clear() { _clearDiskCache(); }
+
+   void validate()
+   {
+      mCacheValidated = false;
+      _validateDiskCache();
+   }
+
+   String getCacheKey( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat )
+   {
+      return _getCacheKey( featureData, vertexFormat, NULL );
+   }
+
+   /// Stands in for a shader which failed to build.
+   void addFailedShader( const String &cacheKey ) { mProcShaders[cacheKey] = NULL; }
+};
+
+/// Mounts shadergen: in memory for the cache files.
+FIXTURE(ShaderGenCache)
+{
+public:
+   bool hasDevice;
+   Torque::FS::FileSystemRef savedFS;
+   bool savedAsync;
+   bool savedWarmUp;
+   GFXVertexFormat vertexFormat;
+   MaterialFeatureData diffuseData;
+   MaterialFeatureData vertLitData;
+
+   void SetUp()
+   {
+      hasDevice = GFXDevice::get() != NULL;
+      if ( !hasDevice )
+         return;
+
+      savedFS = Torque::FS::Unmount( "shadergen" );
+      Torque::FS::Mount( "shadergen", new Torque::Mem::MemFileSystem( "shadergen:/" ) );
+
+      savedAsync = ShaderGen::smAsyncGeneration;
+      savedWarmUp = ShaderGen::smWarmUpCache;
+
+      vertexFormat.addElement( "POSITION", GFXDeclType_Float3 );
+      diffuseData.features.addFeature( MFT_DiffuseMap );
+      vertLitData.features.addFeature( MFT_VertLit );
+   }
+
+   void TearDown()
+   {
+      if ( !hasDevice )
+         return;
+
+      Torque::FS::Unmount( "shadergen" );
+      if ( savedFS )
+         Torque::FS::Mount( "shadergen", savedFS );
+
+      ShaderGen::smAsyncGeneration = savedAsync;
+      ShaderGen::smWarmUpCache = savedWarmUp;
+   }
+};
+
+TEST_FIX(ShaderGenCache, SaveAndLoadEntries)
+{
+   if ( !hasDevice )
+      return;
+
+   ShaderGenCacheTester shaderGen;
+   shaderGen.addEntry( "abc123", 3.0f, "diffuseMap" );
+   shaderGen.addEntry( "def456", 5.0f, "normalMap" );
+   shaderGen.save();
+
+   shaderGen.clear();
+   EXPECT_EQ( 0u, shaderGen.getCacheSize() );
+
+   shaderGen.load();
+   EXPECT_EQ( 2u, shaderGen.getCacheSize() );
+   EXPECT_TRUE( shaderGen.hasEntry( "abc123", 3.0f, "diffuseMap" ) );
+   EXPECT_TRUE( shaderGen.hasEntry( "def456", 5.0f, "normalMap" ) );
+
+   // Another ShaderGen with the same signature reads the same file.
+   ShaderGenCacheTester other;
+   other.load();
+   EXPECT_EQ( 2u, other.getCacheSize() );
+   EXPECT_TRUE( other.hasEntry( "def456", 5.0f, "normalMap" ) );
+}
+
+TEST_FIX(ShaderGenCache, SignatureChangeDropsEntries)
+{
+   if ( !hasDevice )
+      return;
+
+   ShaderGenCacheTester shaderGen;
+   shaderGen.addEntry( "abc123", 3.0f, "diffuseMap" );
+   shaderGen.save();
+
+   // Different features registered, so the old shaders don't apply.
+   shaderGen.setSignature( 0x5678 );
+   shaderGen.load();
+   EXPECT_EQ( 0u, shaderGen.getCacheSize() );
+
+   // Switching back finds its own file again.
+   shaderGen.setSignature( 0x1234 );
+   shaderGen.load();
+   EXPECT_TRUE( shaderGen.hasEntry( "abc123", 3.0f, "diffuseMap" ) );
+}
+
+TEST_FIX(ShaderGenCache, ValidateLoadsCurrentSignature)
+{
+   if ( !hasDevice )
+      return;
+
+   // The entries have no shader files, so warming
+   // up would throw them away again.
+   ShaderGen::smWarmUpCache = false;
+
+   ShaderGenCacheTester shaderGen;
+   shaderGen.setSignature( shaderGen.calcSignature() );
+   shaderGen.addEntry( "abc123", 3.0f, "diffuseMap" );
+   shaderGen.save();
+
+   // Anything left from another signature is replaced.
+   shaderGen.setSignature( 0x1234 );
+   shaderGen.clear();
+   shaderGen.addEntry( "stale", 2.0f, "diffuseMap" );
+
+   shaderGen.validate();
+   EXPECT_EQ( shaderGen.calcSignature(), shaderGen.getSignature() );
+   EXPECT_EQ( 1u, shaderGen.getCacheSize() );
+   EXPECT_TRUE( shaderGen.hasEntry( "abc123", 3.0f, "diffuseMap" ) );
+}
+
+TEST_FIX(ShaderGenCache, PendingShadersQueueOnce)
+{
+   if ( !hasDevice )
+      return;
+
+   ShaderGen::smAsyncGeneration = true;
+
+   ShaderGenCacheTester shaderGen;
+   Vector<String> samplers;
+   bool pending = false;
+
+   EXPECT_TRUE( shaderGen.getShader( diffuseData, &vertexFormat, NULL, samplers, &pending ) == NULL );
+   EXPECT_TRUE( pending );
+   EXPECT_TRUE( shaderGen.hasDeferredShaders() );
+
+   // Asking again while it waits doesn't queue it twice.
+   pending = false;
+   EXPECT_TRUE( shaderGen.getShader( diffuseData, &vertexFormat, NULL, samplers, &pending ) == NULL );
+   EXPECT_TRUE( pending );
+   EXPECT_EQ( 1u, shaderGen.getDeferredCount() );
+
+   EXPECT_TRUE( shaderGen.getShader( vertLitData, &vertexFormat, NULL, samplers, &pending ) == NULL );
+   EXPECT_EQ( 2u, shaderGen.getDeferredCount() );
+}
+
+TEST_FIX(ShaderGenCache, FinishedShadersLeaveQueue)
+{
+   if ( !hasDevice )
+      return;
+
+   ShaderGen::smAsyncGeneration = true;
+
+   ShaderGenCacheTester shaderGen;
+   Vector<String> samplers;
+   bool pending = false;
+
+   shaderGen.getShader( diffuseData, &vertexFormat, NULL, samplers, &pending );
+   shaderGen.getShader( vertLitData, &vertexFormat, NULL, samplers, &pending );
+   ASSERT_EQ( 2u, shaderGen.getDeferredCount() );
+
+   // Both were needed right away and failed, so there
+   // is nothing left to generate for them.
+   shaderGen.addFailedShader( shaderGen.getCacheKey( diffuseData, &vertexFormat ) );
+   shaderGen.addFailedShader( shaderGen.getCacheKey( vertLitData, &vertexFormat ) );
+
+   EXPECT_EQ( 0u, shaderGen.processDeferredShaders() );
+   EXPECT_FALSE( shaderGen.hasDeferredShaders() );
+
+   // A failed shader isn't pending or queued again.
+   pending = true;
+   EXPECT_TRUE( shaderGen.getShader( diffuseData, &vertexFormat, NULL, samplers, &pending ) == NULL );
+   EXPECT_FALSE( pending );
+   EXPECT_FALSE( shaderGen.hasDeferredShaders() );
+}
+
+#endif
@@ -278,6 +278,33 @@ void NetConnection::consoleInit()
 
       "@ingroup Networking");
 
+   Con::addVariable("$pref::Net::GhostPriorityMaxAge", TypeS32, &smGhostPriorityMaxAge,
+      "@brief Sets for how many packets the update priority of a ghost may be reused.\n\n"
+
+      "Computing the update priorities of all dirty ghosts on every packet is expensive with many "
+      "clients and ghosts.  Priorities are recomputed when they reach this age, when the ghost's "
+      "dirty state changes, after it was sent and when the scoping camera changes.  A value of 1 "
+      "recomputes all priorities on every packet.  The default value is 4.\n\n"
+
+      "@ingroup Networking");
+
+   Con::addVariable("$pref::Net::ThreadedGhostWrites", TypeBool, &smThreadedGhostWrites,
+      "@brief If true, the server writes ghost updates for its clients on the thread pool.\n\n"
+
+      "The packets sent to all clients in a tick are built together.  Objects flagged as safe "
+      "to pack concurrently are written on worker threads, the remaining updates follow on the "
+      "main thread.  The default value is false.\n\n"
+
+      "@ingroup Networking");
+
+   Con::addVariable("$pref::Net::SharedPackUpdates", TypeBool, &smSharedPackUpdates,
+      "@brief If true, the server packs object updates once per tick for all clients.\n\n"
+
+      "Objects that support it serialize an update once and the following connections that need "
+      "the same update copy the packed bits.  The default value is true.\n\n"
+
+      "@ingroup Networking");
+
    Con::addVariable("$Stats::netBitsSent", TypeS32, &gNetBitsSent,
       "@brief The number of bytes sent during the last packet send operation.\n\n"
 
@@ -412,6 +439,8 @@ NetConnection::NetConnection()
    mGhosting = false;
    mScoping = false;
    mGhostArray = NULL;
+   mGhostPriorityCameraId = 0;
+   mGhostWriteJob = NULL;
    mGhostRefs = NULL;
    mGhostLookupTable = NULL;
    mLocalGhosts = NULL;
@@ -847,6 +876,17 @@ void NetConnection::checkPacketSend(bool force)
    DEBUG_LOG(("PKLOG %d START", getId()) );
    writePacket(stream, note);
    DEBUG_LOG(("PKLOG %d END - %d", getId(), stream->getCurPos() - start) );
+
+   // The ghost updates are still being written; endGhostWriteBatch() sends
+   // the packet once they are done.
+   if(mGhostWriteJob)
+      return;
+
+   finishPacketSend(stream);
+}
+
+void NetConnection::finishPacketSend(BitStream *stream)
+{
    if(mSimulatedPacketLoss && Platform::getRandom() < mSimulatedPacketLoss)
    {
       //Con::printf("NET  %d: SENDDROP - %d", getId(), mLastSendSeq);
@@ -621,6 +621,9 @@ public:
 
    void checkPacketSend(bool force);
 
+   /// Apply simulated packet loss and latency and send a fully written packet.
+   void finishPacketSend(BitStream *stream);
+
    bool missionPathsSent() const          { return mMissionPathsSent; }
    void setMissionPathsSent(const bool s) { mMissionPathsSent = s; }
 
@@ -788,6 +791,57 @@ protected:
    GhostInfo *mGhostRefs;           ///< Allocated array of ghostInfos. Null if ghostFrom is false.
    GhostInfo **mGhostLookupTable;   ///< Table indexed by object id to GhostInfo. Null if ghostFrom is false.
 
+   /// Ghosts that may be written in the current packet, kept as a heap
+   /// ordered by priority so only the ghosts that fit in the packet need
+   /// to be ordered.
+   Vector<GhostInfo *> mGhostUpdateQueue;
+
+   /// Id of the camera the cached ghost priorities were computed for.
+   SimObjectId mGhostPriorityCameraId;
+
+#ifdef TORQUE_NET_STATS
+   /// The size of an update packed off the main thread.  The class stats
+   /// are shared, so these are added to them once the job is done.
+   struct GhostNetStat
+   {
+      AbstractClassRep *classRep;
+      U32 updateMask;
+      U32 bitCount;
+   };
+#endif
+
+   /// Progress of writing ghost updates into a packet.
+   struct GhostWriteState
+   {
+      S32 queueSize;             ///< Number of ghosts left in mGhostUpdateQueue.
+      S32 sendSize;              ///< Number of bits used for ghost indices.
+      GhostRef *updateList;      ///< Updates written so far.
+      U32 count;                 ///< Number of updates written so far.
+      CameraScopeQuery camInfo;  ///< Camera the priorities are relative to.
+      bool refreshPriorities;    ///< Recompute all cached priorities.
+
+      /// Ghosts a job popped off the queue because their packUpdate() must
+      /// run on the main thread, in priority order.
+      Vector< GhostInfo* > deferred;
+
+#ifdef TORQUE_NET_STATS
+      Vector< GhostNetStat > netStats;
+#endif
+   };
+
+   struct GhostWriteJob;
+   struct GhostWriteTaskSet;
+
+   /// Jobs queued since beginGhostWriteBatch(), in packet send order.
+   static Vector< GhostWriteJob* > smGhostWriteJobs;
+
+   /// Job writing the ghost updates of the packet currently being built, if
+   /// that packet is part of a batch.  @see beginGhostWriteBatch
+   GhostWriteJob *mGhostWriteJob;
+
+   /// Set while NetInterface is batching the packets sent to clients.
+   static bool smGhostWriteBatch;
+
    /// The object around which we are scoping this connection.
    ///
    /// This is usually the player object, or a related object, like a vehicle
@@ -802,6 +856,32 @@ protected:
 
    void ghostWritePacket(BitStream *bstream, PacketNotify *notify);
    void ghostReadPacket(BitStream *bstream);
+
+   /// Refresh the cached priorities of the queued ghosts and sort the
+   /// queue into a heap.
+   void ghostUpdatePriorities(GhostWriteState &state);
+
+   /// Write ghost updates in priority order until the packet is full.  If
+   /// @a concurrent is set, ghosts whose packUpdate() may not run off the
+   /// main thread are moved to GhostWriteState::deferred instead and, once
+   /// there are any, only half the packet is filled to leave room for them.
+   void ghostWriteUpdates(BitStream *bstream, GhostWriteState &state, bool concurrent);
+
+   /// Write the update of a single ghost.
+   void ghostWriteUpdate(BitStream *bstream, GhostWriteState &state, GhostInfo *walk, bool concurrent);
+
+   /// Hand the rest of the ghost updates for the current packet to a job.
+   void queueGhostWriteJob(BitStream *bstream, PacketNotify *notify, const GhostWriteState &state);
+
+   /// Write what the job left over and send the packet.
+   void finishGhostWriteJob(GhostWriteJob *job);
+
+   /// Pack an update of @a obj, copying the bits from the pack update cache
+   /// when another connection already packed the same update this tick.
+   U32 packGhostUpdate(NetObject *obj, U32 mask, BitStream *bstream, bool useCache);
+
+   /// Set between beginPackUpdateCache() and endPackUpdateCache().
+   static bool smPackUpdateCacheActive;
    void freeGhostInfo(GhostInfo *);
 
    void ghostWriteStartBlock(ResizeBitStream *stream);
@@ -928,6 +1008,40 @@ public:
    /// before performing an operation.
    static Signal<void()> smGhostAlwaysDone;
 
+   /// Maximum number of packets a ghost's update priority is reused for
+   /// before getUpdatePriority() is called again.  Priorities are always
+   /// recomputed when a ghost's update mask changes, after it was written
+   /// and when the scope camera changes.  1 recomputes on every packet.
+   static U32 smGhostPriorityMaxAge;
+
+public:
+
+   /// If true, the server writes the ghost updates of all client packets
+   /// sent in a tick on the ThreadPool.  Only objects with the
+   /// NetObject::ConcurrentPackUpdate flag are packed on worker threads;
+   /// the remaining updates are written on the main thread afterwards.
+   static bool smThreadedGhostWrites;
+
+   /// Start batching packet sends.  Ghost updates of packets built until
+   /// endGhostWriteBatch() are deferred to jobs and the packets are sent
+   /// once all of them are done.
+   static void beginGhostWriteBatch();
+
+   /// Run the jobs queued since beginGhostWriteBatch() and send the packets.
+   static void endGhostWriteBatch();
+
+   /// If true, updates of objects with the NetObject::SharedPackUpdate flag
+   /// are packed once per tick and copied into the packets of all
+   /// connections that need the same bits.
+   static bool smSharedPackUpdates;
+
+   /// Start caching packUpdate() results.  The objects must not change
+   /// until endPackUpdateCache() is called.
+   static void beginPackUpdateCache();
+
+   /// Drop all cached packUpdate() results.
+   static void endPackUpdateCache();
+
    /// @}
 public:
 //----------------------------------------------------------------
@@ -1057,6 +1171,9 @@ public:  // required for MSVC
    U32 flags;                             ///< Flags from GhostInfo::Flags
    F32 priority;                          ///< A float value indicating the priority of this object for
                                           ///  updates.
+   U32 priorityAge;                       ///< Number of packets #priority has been reused for.
+   U32 priorityMask;                      ///< Update mask #priority was computed for.  Zero forces
+                                          ///  the priority to be recomputed on the next packet.
 
    /// @name References
    ///
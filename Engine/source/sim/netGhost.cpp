@@ -26,6 +26,9 @@
 #include "sim/netConnection.h"
 #include "core/stream/bitStream.h"
 #include "sim/netObject.h"
+#include "platform/threads/threadPoolTaskSet.h"
+#include "platform/profiler.h"
+#include "core/util/tDictionary.h"
 //#include "core/resManager.h"
 #include "console/console.h"
 #include "console/consoleTypes.h"
@@ -301,22 +304,50 @@ void NetConnection::ghostPacketReceived(PacketNotify *notify)
    }
 }
 
-struct UpdateQueueEntry
-{
-   F32 priority;
-   GhostInfo *obj;
+U32 NetConnection::smGhostPriorityMaxAge = 4;
+bool NetConnection::smThreadedGhostWrites = false;
+bool NetConnection::smGhostWriteBatch = false;
+bool NetConnection::smSharedPackUpdates = true;
+bool NetConnection::smPackUpdateCacheActive = false;
 
-   UpdateQueueEntry(F32 in_priority, GhostInfo *in_obj)
-      { priority = in_priority; obj = in_obj; }
-};
+// The update queue is a binary max-heap on GhostInfo::priority.  Building it
+// is linear and every ghost written costs a log(n) pop, so the cost per packet
+// follows the number of ghosts that fit in it rather than the total dirty set.
 
-static S32 QSORT_CALLBACK UQECompare(const void *a,const void *b)
+static void ghostHeapSiftDown(GhostInfo **heap, S32 size, S32 i)
 {
-   GhostInfo *ga = *((GhostInfo **) a);
-   GhostInfo *gb = *((GhostInfo **) b);
+   GhostInfo *ghost = heap[i];
+   for(;;)
+   {
+      S32 child = i * 2 + 1;
+      if(child >= size)
+         break;
+      if(child + 1 < size && heap[child + 1]->priority > heap[child]->priority)
+         child++;
+      if(heap[child]->priority <= ghost->priority)
+         break;
+      heap[i] = heap[child];
+      i = child;
+   }
+   heap[i] = ghost;
+}
 
-   F32 ret = ga->priority - gb->priority;
-   return (ret < 0) ? -1 : ((ret > 0) ? 1 : 0);
+static void ghostHeapBuild(GhostInfo **heap, S32 size)
+{
+   for(S32 i = size / 2 - 1; i >= 0; i--)
+      ghostHeapSiftDown(heap, size, i);
+}
+
+static GhostInfo *ghostHeapPop(GhostInfo **heap, S32 &size)
+{
+   GhostInfo *top = heap[0];
+   size--;
+   if(size > 0)
+   {
+      heap[0] = heap[size];
+      ghostHeapSiftDown(heap, size, 0);
+   }
+   return top;
 }
 
 void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
@@ -344,7 +375,8 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
    // 3. call updates based on sorted priority until the packet is
    //    full.  set flags to zero for all updated objects
 
-   CameraScopeQuery camInfo;
+   GhostWriteState state;
+   CameraScopeQuery &camInfo = state.camInfo;
 
    camInfo.camera = NULL;
    camInfo.pos.set(0,0,0);
@@ -368,10 +400,18 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
          walk->flags &= ~GhostInfo::InScope;
    }
 
+   // Scoping stays on the main thread even when batching, as it walks the
+   // scene through the shared container and zone queries and can end up in
+   // script.
    if( mScopeObject )
       mScopeObject->onCameraScopeQuery( this, &camInfo );
    doneScopingScene();
 
+   // Cached priorities are relative to the camera, so drop them all if it changed.
+   SimObjectId cameraId = camInfo.camera ? camInfo.camera->getId() : 0;
+   state.refreshPriorities = cameraId != mGhostPriorityCameraId;
+   mGhostPriorityCameraId = cameraId;
+
    for(i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
    {
       // [rene, 07-Mar-11] Killing ghosts depending on the camera scope queries
@@ -384,6 +424,7 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
          detachObject(mGhostArray[i]);
    }
 
+   mGhostUpdateQueue.clear();
    for(i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
    {
       walk = mGhostArray[i];
@@ -402,18 +443,15 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
       {
          if(walk->flags & GhostInfo::KillGhost)
             walk->priority = 10000;
-         else
-            walk->priority = walk->obj->getUpdatePriority(&camInfo, walk->updateMask, walk->updateSkipCount);
+
+         mGhostUpdateQueue.push_back(walk);
       }
       else
          walk->priority = 0;
    }
-   GhostRef *updateList = NULL;
-   dQsort(mGhostArray, mGhostZeroUpdateIndex, sizeof(GhostInfo *), UQECompare);
-
-   // reset the array indices...
-   for(i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
-      mGhostArray[i]->arrayIndex = i;
+   state.queueSize = mGhostUpdateQueue.size();
+   state.updateList = NULL;
+   state.count = 0;
 
    S32 sendSize = 1;
    while(maxIndex >>= 1)
@@ -423,97 +461,338 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
       sendSize = 3;
 
    bstream->writeInt(sendSize - 3, GhostIndexBitSize);
+   state.sendSize = sendSize;
 
-   U32 count = 0;
-   //
-   for(i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
+   // While NetInterface batches packet sends, leave the priorities and
+   // updates to a job.
+   if(smGhostWriteBatch && state.queueSize > 0 && bstream->getBitPosition() < (bstream->getBufferSize() << 3))
    {
-      GhostInfo *walk = mGhostArray[i];
-		if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
-		   continue;
-		
-      bstream->writeFlag(true);
-
-      bstream->writeInt(walk->index, sendSize);
-      U32 updateMask = walk->updateMask;
-
-      GhostRef *upd = new GhostRef;
-
-      upd->nextRef = updateList;
-      updateList = upd;
-      upd->nextUpdateChain = walk->updateChain;
-      walk->updateChain = upd;
+      queueGhostWriteJob(bstream, notify, state);
+      return;
+   }
 
-      upd->ghost = walk;
-      upd->ghostInfoFlags = 0;
+   ghostUpdatePriorities(state);
+   ghostWriteUpdates(bstream, state, false);
+   // no more objects...
+   bstream->writeFlag(false);
+   notify->ghostList = state.updateList;
+}
 
+void NetConnection::ghostUpdatePriorities(GhostWriteState &state)
+{
+   for(S32 i = 0; i < state.queueSize; i++)
+   {
+      GhostInfo *walk = mGhostUpdateQueue[i];
       if(walk->flags & GhostInfo::KillGhost)
+         continue;
+
+      if(state.refreshPriorities || walk->priorityMask != walk->updateMask || walk->priorityAge >= smGhostPriorityMaxAge)
       {
-         walk->flags &= ~GhostInfo::KillGhost;
-         walk->flags |= GhostInfo::KillingGhost;
-         walk->updateMask = 0;
-         upd->mask = updateMask;
-         ghostPushToZero(walk);
-         upd->ghostInfoFlags = GhostInfo::KillingGhost;
-         bstream->writeFlag(true); // killing ghost
+         walk->priority = walk->obj->getUpdatePriority(&state.camInfo, walk->updateMask, walk->updateSkipCount);
+         walk->priorityMask = walk->updateMask;
+         walk->priorityAge = 1;
       }
       else
+         walk->priorityAge++;
+   }
+   ghostHeapBuild(mGhostUpdateQueue.address(), state.queueSize);
+}
+
+void NetConnection::ghostWriteUpdates(BitStream *bstream, GhostWriteState &state, bool concurrent)
+{
+   // Leave the other half of the packet to the ghosts that have to be
+   // written on the main thread or they'd never get in.
+   const U32 deferredReserve = (bstream->getBufferSize() << 3) / 2;
+
+   while(state.queueSize > 0 && !bstream->isFull())
+   {
+      GhostInfo *walk = mGhostUpdateQueue[0];
+
+      if(concurrent)
       {
-         bstream->writeFlag(false);
+         if(!(walk->flags & GhostInfo::KillGhost) && !walk->obj->mNetFlags.test(NetObject::ConcurrentPackUpdate))
+         {
+            ghostHeapPop(mGhostUpdateQueue.address(), state.queueSize);
+            state.deferred.push_back(walk);
+            continue;
+         }
+
+         if(state.deferred.size() && bstream->getBitPosition() >= deferredReserve)
+            return;
+      }
+
+      ghostHeapPop(mGhostUpdateQueue.address(), state.queueSize);
+      ghostWriteUpdate(bstream, state, walk, concurrent);
+   }
+}
+
+void NetConnection::ghostWriteUpdate(BitStream *bstream, GhostWriteState &state, GhostInfo *walk, bool concurrent)
+{
+   bstream->writeFlag(true);
+
+   bstream->writeInt(walk->index, state.sendSize);
+   U32 updateMask = walk->updateMask;
+
+   GhostRef *upd = new GhostRef;
+
+   upd->nextRef = state.updateList;
+   state.updateList = upd;
+   upd->nextUpdateChain = walk->updateChain;
+   walk->updateChain = upd;
+
+   upd->ghost = walk;
+   upd->ghostInfoFlags = 0;
+
+   if(walk->flags & GhostInfo::KillGhost)
+   {
+      walk->flags &= ~GhostInfo::KillGhost;
+      walk->flags |= GhostInfo::KillingGhost;
+      walk->updateMask = 0;
+      upd->mask = updateMask;
+      ghostPushToZero(walk);
+      upd->ghostInfoFlags = GhostInfo::KillingGhost;
+      bstream->writeFlag(true); // killing ghost
+   }
+   else
+   {
+      bstream->writeFlag(false);
 #ifdef TORQUE_DEBUG_NET
-         U32 startPos = bstream->getCurPos();
+      U32 startPos = bstream->getCurPos();
 #endif
-         if(walk->flags & GhostInfo::NotYetGhosted)
-         {
-            S32 classId = walk->obj->getClassId(getNetClassGroup());
-            bstream->writeClassId(classId, NetClassTypeObject, getNetClassGroup());
+      if(walk->flags & GhostInfo::NotYetGhosted)
+      {
+         S32 classId = walk->obj->getClassId(getNetClassGroup());
+         bstream->writeClassId(classId, NetClassTypeObject, getNetClassGroup());
 #ifdef TORQUE_DEBUG_NET
-            bstream->writeInt(classId ^ DebugChecksum, 32);
+         bstream->writeInt(classId ^ DebugChecksum, 32);
 #endif
 
-            walk->flags &= ~GhostInfo::NotYetGhosted;
-            walk->flags |= GhostInfo::Ghosting;
-            upd->ghostInfoFlags = GhostInfo::Ghosting;
-         }
+         walk->flags &= ~GhostInfo::NotYetGhosted;
+         walk->flags |= GhostInfo::Ghosting;
+         upd->ghostInfoFlags = GhostInfo::Ghosting;
+      }
 #ifdef TORQUE_DEBUG_NET
-         else {
-            S32 classId = walk->obj->getClassId(getNetClassGroup());
-            bstream->writeClassId(classId, NetClassTypeObject, getNetClassGroup());
-            bstream->writeInt(classId ^ DebugChecksum, 32);
-         }
+      else {
+         S32 classId = walk->obj->getClassId(getNetClassGroup());
+         bstream->writeClassId(classId, NetClassTypeObject, getNetClassGroup());
+         bstream->writeInt(classId ^ DebugChecksum, 32);
+      }
 #endif
-         // update the object
+      // update the object
 #ifdef TORQUE_NET_STATS
-         U32 beginSize = bstream->getBitPosition();
+      U32 beginSize = bstream->getBitPosition();
 #endif
-         U32 retMask = walk->obj->packUpdate(this, updateMask, bstream);
+      U32 retMask = packGhostUpdate(walk->obj, updateMask, bstream, !concurrent);
 #ifdef TORQUE_NET_STATS
+      if(concurrent)
+      {
+         state.netStats.increment();
+         GhostNetStat &stat = state.netStats.last();
+         stat.classRep = walk->obj->getClassRep();
+         stat.updateMask = updateMask;
+         stat.bitCount = bstream->getBitPosition() - beginSize;
+      }
+      else
          walk->obj->getClassRep()->updateNetStatPack(updateMask, bstream->getBitPosition() - beginSize);
 #endif
-         DEBUG_LOG(("PKLOG %d GHOST %d: %s", getId(), bstream->getBitPosition() - 16 - startPos, walk->obj->getClassName()));
+      DEBUG_LOG(("PKLOG %d GHOST %d: %s", getId(), bstream->getBitPosition() - 16 - startPos, walk->obj->getClassName()));
 
-         AssertFatal((retMask & (~updateMask)) == 0, "Cannot set new bits in packUpdate return");
+      AssertFatal((retMask & (~updateMask)) == 0, "Cannot set new bits in packUpdate return");
 
-         ghostWriteExtra(walk->obj,bstream);
+      ghostWriteExtra(walk->obj,bstream);
 
-         walk->updateMask = retMask;
-         if(!retMask)
-            ghostPushToZero(walk);
+      walk->updateMask = retMask;
+      if(!retMask)
+         ghostPushToZero(walk);
 
-         upd->mask = updateMask & ~retMask;
+      upd->mask = updateMask & ~retMask;
 
-         //PacketStream::getStats()->addBits(PacketStats::Send, bstream->getCurPos() - startPos, walk->obj->getPersistTag());
+      //PacketStream::getStats()->addBits(PacketStats::Send, bstream->getCurPos() - startPos, walk->obj->getPersistTag());
 #ifdef TORQUE_DEBUG_NET
-         bstream->writeInt(walk->index ^ DebugChecksum, 32);
+      bstream->writeInt(walk->index ^ DebugChecksum, 32);
 #endif
-      }
-      walk->updateSkipCount = 0;
-      count++;
    }
-   //Con::printf("Ghosts updated: %d (%d remain)", count, mGhostZeroUpdateIndex);
-   // no more objects...
+   walk->updateSkipCount = 0;
+   walk->priorityMask = 0;
+   state.count++;
+}
+
+//----------------------------------------------------------------------------
+
+/// A packUpdate() result stored in sPackUpdateBits.
+struct PackUpdateCacheEntry
+{
+   U32 retMask;
+   U32 offset;       ///< Byte offset of the bits in sPackUpdateBits.
+   U32 bitCount;
+};
+
+typedef CompoundKey3< NetObject*, U32, U32 > PackUpdateCacheKey;   ///< Object, mask and connection key.
+
+static HashTable< PackUpdateCacheKey, PackUpdateCacheEntry > sPackUpdateCache;
+static Vector< U8 > sPackUpdateBits;
+
+void NetConnection::beginPackUpdateCache()
+{
+   smPackUpdateCacheActive = smSharedPackUpdates;
+}
+
+void NetConnection::endPackUpdateCache()
+{
+   smPackUpdateCacheActive = false;
+   sPackUpdateCache.clear();
+   sPackUpdateBits.clear();
+}
+
+U32 NetConnection::packGhostUpdate(NetObject *obj, U32 mask, BitStream *bstream, bool useCache)
+{
+   U32 key = 0;
+   if(!useCache || !smPackUpdateCacheActive || !obj->mNetFlags.test(NetObject::SharedPackUpdate) ||
+      !obj->getPackUpdateKey(this, mask, key))
+      return obj->packUpdate(this, mask, bstream);
+
+   PackUpdateCacheKey cacheKey(obj, mask, key);
+   PackUpdateCacheEntry entry;
+   if(sPackUpdateCache.find(cacheKey, entry))
+   {
+      bstream->writeBits(entry.bitCount, sPackUpdateBits.address() + entry.offset);
+      return entry.retMask;
+   }
+
+   U32 startPos = bstream->getBitPosition();
+   U32 retMask = obj->packUpdate(this, mask, bstream);
+
+   // An overflowed packet gets its update written again next time, so
+   // don't keep bits that may not be in the buffer.
+   if(bstream->isFull())
+      return retMask;
+
+   entry.retMask = retMask;
+   entry.offset = sPackUpdateBits.size();
+   entry.bitCount = bstream->getBitPosition() - startPos;
+   if(entry.bitCount)
+   {
+      sPackUpdateBits.setSize(entry.offset + ((entry.bitCount + 7) >> 3));
+
+      BitStream reader(bstream->getBuffer(), bstream->getBufferSize());
+      reader.setCurPos(startPos);
+      reader.readBits(entry.bitCount, sPackUpdateBits.address() + entry.offset);
+   }
+
+   sPackUpdateCache.insertUnique(cacheKey, entry);
+   return retMask;
+}
+
+//----------------------------------------------------------------------------
+
+/// The ghost updates of one deferred packet, written into the job's own
+/// copy of the packet.
+struct NetConnection::GhostWriteJob
+{
+   NetConnection *mConnection;
+   PacketNotify *mNotify;
+   GhostWriteState mState;
+   U8 mBuffer[Net::MaxPacketDataSize];
+   BitStream mStream;
+
+   GhostWriteJob(NetConnection *connection, PacketNotify *notify, const GhostWriteState &state)
+      : mConnection(connection),
+        mNotify(notify),
+        mState(state),
+        mStream(NULL, 0)
+   {
+   }
+
+   void run()
+   {
+      mConnection->ghostUpdatePriorities(mState);
+      mConnection->ghostWriteUpdates(&mStream, mState, true);
+   }
+};
+
+Vector< NetConnection::GhostWriteJob* > NetConnection::smGhostWriteJobs;
+
+/// Runs each of the smGhostWriteJobs as one task.
+struct NetConnection::GhostWriteTaskSet : public ThreadPoolTaskSet
+{
+   GhostWriteTaskSet()
+      : ThreadPoolTaskSet(smGhostWriteJobs.size()) {}
+
+protected:
+   virtual void runTask(U32 index)
+   {
+      smGhostWriteJobs[index]->run();
+   }
+};
+
+void NetConnection::queueGhostWriteJob(BitStream *bstream, PacketNotify *notify, const GhostWriteState &state)
+{
+   AssertFatal(!mGhostWriteJob, "NetConnection::queueGhostWriteJob - packet already has a job");
+
+   // The packet stream is shared by all connections, so the job works on
+   // its own copy of what has been written so far.
+   GhostWriteJob *job = new GhostWriteJob(this, notify, state);
+   U32 bitPos = bstream->getBitPosition();
+   dMemcpy(job->mBuffer, bstream->getBuffer(), (bitPos + 7) >> 3);
+   job->mStream.setBuffer(job->mBuffer, bstream->getBufferSize(), Net::MaxPacketDataSize);
+   job->mStream.setCurPos(bitPos);
+   job->mStream.setCompressionPoint(bstream->getCompressionPoint());
+
+   mGhostWriteJob = job;
+   smGhostWriteJobs.push_back(job);
+}
+
+void NetConnection::finishGhostWriteJob(GhostWriteJob *job)
+{
+   BitStream *bstream = &job->mStream;
+   GhostWriteState &state = job->mState;
+
+#ifdef TORQUE_NET_STATS
+   for(U32 i = 0; i < state.netStats.size(); i++)
+   {
+      const GhostNetStat &stat = state.netStats[i];
+      stat.classRep->updateNetStatPack(stat.updateMask, stat.bitCount);
+   }
+#endif
+
+   // The ghosts the job couldn't pack come first, then whatever is left.
+   for(U32 i = 0; i < state.deferred.size() && !bstream->isFull(); i++)
+      ghostWriteUpdate(bstream, state, state.deferred[i], false);
+
+   ghostWriteUpdates(bstream, state, false);
    bstream->writeFlag(false);
-   notify->ghostList = updateList;
+   job->mNotify->ghostList = job->mState.updateList;
+   mGhostWriteJob = NULL;
+
+   finishPacketSend(bstream);
+}
+
+void NetConnection::beginGhostWriteBatch()
+{
+   AssertFatal(!smGhostWriteBatch, "NetConnection::beginGhostWriteBatch - already batching");
+   smGhostWriteBatch = true;
+}
+
+void NetConnection::endGhostWriteBatch()
+{
+   PROFILE_SCOPE(NetConnection_endGhostWriteBatch);
+
+   smGhostWriteBatch = false;
+   if(smGhostWriteJobs.empty())
+      return;
+
+   ThreadSafeRef< GhostWriteTaskSet > tasks(new GhostWriteTaskSet);
+   tasks->run();
+
+   // Objects that must be packed on the main thread are written only once
+   // no job is running anymore.
+   for(U32 i = 0; i < smGhostWriteJobs.size(); i++)
+   {
+      GhostWriteJob *job = smGhostWriteJobs[i];
+      job->mConnection->finishGhostWriteJob(job);
+      delete job;
+   }
+   smGhostWriteJobs.clear();
 }
 
 void NetConnection::ghostReadPacket(BitStream *bstream)
@@ -818,6 +1097,8 @@ void NetConnection::objectInScope(NetObject *obj)
    giptr->obj = obj;
    giptr->updateChain = NULL;
    giptr->updateSkipCount = 0;
+   giptr->priorityAge = 0;
+   giptr->priorityMask = 0;
 
    giptr->connection = this;
 
@@ -434,12 +434,25 @@ void NetInterface::processClient()
 void NetInterface::processServer()
 {
    NetObject::collapseDirtyList(); // collapse all the mask bits...
+   NetConnection::beginPackUpdateCache();
+
+   // Build all client packets first so their ghost updates can be written
+   // side by side.
+   const bool batch = NetConnection::smThreadedGhostWrites;
+   if(batch)
+      NetConnection::beginGhostWriteBatch();
+
    for(NetConnection *walk = NetConnection::getConnectionList();
       walk; walk = walk->getNext())
    {
       if(!walk->isConnectionToServer() && (walk->isLocalConnection() || walk->isNetworkConnection()))
          walk->checkPacketSend(false);
    }
+
+   if(batch)
+      NetConnection::endGhostWriteBatch();
+
+   NetConnection::endPackUpdateCache();
 }
 
 void NetInterface::startConnection(NetConnection *conn)
@@ -319,6 +319,11 @@ U32 NetObject::packUpdate(NetConnection* conn, U32 mask, BitStream* stream)
    return 0;
 }
 
+bool NetObject::getPackUpdateKey(NetConnection*, U32, U32&)
+{
+   return true;
+}
+
 void NetObject::unpackUpdate(NetConnection*, BitStream*)
 {
 }
@@ -269,6 +269,9 @@ protected:
       ScopeAlways       =  BIT(6),  ///< Object always ghosts to clients.
       ScopeLocal        =  BIT(7),  ///< Ghost only to local client.
       Ghostable         =  BIT(8),  ///< Set if this object CAN ghost.
+      ConcurrentPackUpdate = BIT(9), ///< packUpdate() only reads this object and the connection's ghost
+                                     ///  table, so it may run on a worker thread.  @see NetConnection::smThreadedGhostWrites
+      SharedPackUpdate  =  BIT(10), ///< Updates may be shared between connections.  @see getPackUpdateKey
 
       MaxNetFlagBit     =  15
    };
@@ -330,6 +333,9 @@ public:
    /// @param  updateMask     Current update mask.
    /// @param  updateSkips    Number of ticks we haven't been updated for.
    /// @returns A floating point value indicating priority. These are typically < 5.0.
+   ///
+   /// @note While NetInterface batches packet sends this is called on the
+   ///   ThreadPool, so it must only read the object and @a focusObject.
    virtual F32 getUpdatePriority(CameraScopeQuery *focusObject, U32 updateMask, S32 updateSkips);
 
    /// Instructs this object to pack its state for transfer over the network.
@@ -342,6 +348,22 @@ public:
    ///          system. Don't set bits you weren't passed.
    virtual U32  packUpdate(NetConnection * conn, U32 mask, BitStream *stream);
 
+   /// Describes how the output of packUpdate() depends on the connection.
+   ///
+   /// Only called for objects with the SharedPackUpdate flag.  Every class in the
+   /// packUpdate() chain of such an object must implement this by calling its Parent
+   /// and shifting the exact connection specific values it writes for @a mask into
+   /// @a key (no hashing).  Connections producing the same key get the same bits, so
+   /// the update is packed once per tick and copied for the others.
+   ///
+   /// @param   conn    Net connection being used
+   /// @param   mask    Mask indicating fields to transmit.
+   /// @param   key     Key to add the connection specific state to.
+   ///
+   /// @returns False if the update can't be shared, for example because it
+   ///          registers strings with the connection.
+   virtual bool getPackUpdateKey(NetConnection *conn, U32 mask, U32 &key);
+
    /// Instructs this object to read state data previously packed with packUpdate.
    ///
    /// @param   conn    Net connection being used
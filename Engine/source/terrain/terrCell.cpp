@@ -26,6 +26,7 @@
 #include "math/util/frustum.h"
 #include "terrain/terrData.h"
 #include "terrain/terrCellMaterial.h"
+#include "terrain/terrStreaming.h"
 #include "scene/sceneRenderState.h"
 #include "lighting/lightManager.h"
 #include "gfx/gfxDrawUtil.h"
@@ -53,7 +54,8 @@ TerrCell::TerrCell()
       mMaterial( NULL ),
       mIsInteriorOnly( false ),
       mTriCount( 0 ),
-      mHasEmpty( false )
+      mHasEmpty( false ),
+      mLastUsed( 0 )
 {
    dMemset( mChildren, 0, sizeof( mChildren ) );
 }
@@ -295,8 +297,22 @@ void TerrCell::_init( TerrainBlock *terrain,
    mLevel = level;
 
    // Generate a VB (and maybe a PB) for this cell, unless we are the Root cell.
-   if ( level > 0 )
+   // A streamed file only gets the first level here and the TerrainStreamer
+   // builds the rest as the camera gets close.
+   TerrainFile *file = mTerrain->getFile();
+   const bool streaming = file->isStreaming();
+   if ( level == 1 || ( level > 0 && !streaming ) )
    {
+      // On small terrains the first level can be finer
+      // than the coarse samples, so get the real ones.
+      if ( streaming && _needsTiles() )
+      {
+         Vector<U32> tiles;
+         _getTiles( 1, &tiles );
+         for ( U32 i=0; i < tiles.size(); i++ )
+            file->loadTile( tiles[i] );
+      }
+
       _updateVertexBuffer();
       _updatePrimitiveBuffer();
    }
@@ -357,12 +373,12 @@ void TerrCell::updateGrid( const RectI &gridRect, bool opacityOnly )
 {
    PROFILE_SCOPE( TerrCell_UpdateGrid );
 
-   // If we have a VB... then update it.
-   if ( mVertexBuffer.isValid() && !opacityOnly )            
-      _updateVertexBuffer();
-
-   // Update our PB, if any
-   _updatePrimitiveBuffer();
+   // If we have a VB... then update the vertices within
+   // the rect and our PB if the empty squares changed.
+   if (  mVertexBuffer.isValid() && 
+         !opacityOnly &&
+         _updateVertexBuffer( gridRect ) )
+      _updatePrimitiveBuffer();
 
    // If we don't have children... then we're
    // a leaf at the bottom of the cell quadtree
@@ -379,6 +395,8 @@ void TerrCell::updateGrid( const RectI &gridRect, bool opacityOnly )
    // Otherwise, we must call updateGrid on our children
    // and then update our bounds/materials AFTER to contain them.
 
+   const Box3F oldBounds = mBounds;
+   const U64 oldMaterials = mMaterials;
    mMaterials = 0;
 
    for ( U32 i = 0; i < 4; i++ )
@@ -405,15 +423,22 @@ void TerrCell::updateGrid( const RectI &gridRect, bool opacityOnly )
             mBounds = mChildren[i]->getBounds();
          else
             mBounds.intersect( mChildren[i]->getBounds() );
-
-         mRadius = mBounds.len() * 0.5f;
       }
 
       // Update the material flags.
       mMaterials |= mChildren[i]->getMaterials();
    }
 
-   if ( mMaterial )
+   // Only the cells whose bounds changed need a new OBB, but
+   // those have to get one else they cull with the old bounds.
+   if (  oldBounds.minExtents != mBounds.minExtents ||
+         oldBounds.maxExtents != mBounds.maxExtents )
+   {
+      mRadius = mBounds.len() * 0.5f;
+      _updateOBB();
+   }
+
+   if ( mMaterial && mMaterials != oldMaterials )
       mMaterial->init( mTerrain, mMaterials );
 }
 
@@ -421,57 +446,194 @@ void TerrCell::_updateVertexBuffer()
 {
    PROFILE_SCOPE( TerrCell_UpdateVertexBuffer );
 
-   // Start off with no empty squares
-   mHasEmpty = false;
-   mEmptyVertexList.clear();
-
    mVertexBuffer.set( GFX, smVBSize, GFXBufferTypeStatic );
 
-   const F32 squareSize = mTerrain->getSquareSize();
-   const U32 blockSize = mTerrain->getBlockSize();
-   const U32 stepSize = mSize / smMinCellSize;
+   TerrVertex *vert = mVertexBuffer.lock();
+   _fillVertices( mTerrain->getFile(), vert, &mHasEmpty, &mEmptyVertexList );
+   mVertexBuffer.unlock();
+}
 
-   U32 vbcounter = 0;
+/// Returns the first and last vertex whose sample falls between the 
+/// @a min and @a max offsets from the cell origin, or false if none do.
+static inline bool _getVertexRange( S32 min, S32 max, S32 stepSize, U32 maxVert, U32 *outFirst, U32 *outLast )
+{
+   if ( max < 0 )
+      return false;
 
-   TerrVertex *vert = mVertexBuffer.lock();
+   *outFirst = min <= 0 ? 0 : ( min + stepSize - 1 ) / stepSize;
+   *outLast = getMin( (U32)( max / stepSize ), maxVert );
+   return *outFirst <= *outLast;
+}
+
+bool TerrCell::_updateVertexBuffer( const RectI &gridRect )
+{
+   PROFILE_SCOPE( TerrCell_UpdateVertexBufferRect );
+
+   const S32 blockSize = mTerrain->getBlockSize();
+   const S32 stepSize = mSize / smMinCellSize;
+
+   // The normals and tangents read the neighboring samples, so the
+   // rect grows by one.  The heights wrap around the edges of the
+   // block, so a rect touching them just updates everything.
+   const S32 minX = gridRect.point.x - 1;
+   const S32 minY = gridRect.point.y - 1;
+   const S32 maxX = gridRect.point.x + gridRect.extent.x + 1;
+   const S32 maxY = gridRect.point.y + gridRect.extent.y + 1;
+   if ( minX <= 0 || minY <= 0 || maxX >= blockSize - 1 || maxY >= blockSize - 1 )
+   {
+      _updateVertexBuffer();
+      return true;
+   }
+
+   // Find the rows and columns of vertices on the samples
+   // within the rect.  A big cell often has none at all.
+   U32 x0, x1, y0, y1;
+   if (  !_getVertexRange( minX - mPoint.x, maxX - mPoint.x, stepSize, smMinCellSize, &x0, &x1 ) ||
+         !_getVertexRange( minY - mPoint.y, maxY - mPoint.y, stepSize, smMinCellSize, &y0, &y1 ) )
+      return false;
 
-   Point2I gridPt;
-   Point2F point;
-   F32 height;
-   Point3F normal;   
-   
    const TerrainFile *file = mTerrain->getFile();
 
-   for ( U32 y = 0; y < smVBStride; y++ )
+   // The locked range of a static buffer is uploaded as 
+   // a whole, so we rewrite the full rows of the rect.
+   const U32 start = y0 * smVBStride;
+   const U32 end = ( y1 + 1 ) * smVBStride;
+
+   Vector<U32> emptyList;
+   for ( U32 i = 0; i < mEmptyVertexList.size() && mEmptyVertexList[i] < start; i++ )
+      emptyList.push_back( mEmptyVertexList[i] );
+
+   TerrVertex *vert = mVertexBuffer.lock( start, end );
+   for ( U32 y = y0; y <= y1; y++ )
    {
       for ( U32 x = 0; x < smVBStride; x++ )
       {
-         // We clamp here to keep the geometry from reading across
-         // one side of the height map to the other causing walls
-         // around the edges of the terrain.
-         gridPt.x = mClamp( mPoint.x + x * stepSize, 0, blockSize - 1 );
-         gridPt.y = mClamp( mPoint.y + y * stepSize, 0, blockSize - 1 );
+         _fillVertex( file, x, y, vert );
+         ++vert;
 
-         // Setup this point.
-         point.x = (F32)gridPt.x * squareSize;
-         point.y = (F32)gridPt.y * squareSize;
-         height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
-         vert->point.x = point.x;
-         vert->point.y = point.y;
-         vert->point.z = height;
+         const Point2I gridPt = _getGridPoint( x, y );
+         if ( file->isEmptyAt( gridPt.x, gridPt.y ) )
+            emptyList.push_back( x + y * smVBStride );
+      }
+   }
+   mVertexBuffer.unlock();
+
+   for ( U32 i = 0; i < mEmptyVertexList.size(); i++ )
+   {
+      if ( mEmptyVertexList[i] >= end )
+         emptyList.push_back( mEmptyVertexList[i] );
+   }
+
+   // The skirts along the edges within the rect.
+   const bool skirtHit[4] = { y0 == 0, y1 == smMinCellSize, x0 == 0, x1 == smMinCellSize };
+   const U32 skirtFirst[4] = { x0, x0, y0, y0 };
+   const U32 skirtLast[4] = { x1, x1, y1, y1 };
+
+   for ( U32 edge = 0; edge < 4; edge++ )
+   {
+      if ( !skirtHit[edge] )
+         continue;
+
+      const U32 skirtStart = smVBStride * smVBStride + edge * smVBStride;
+      vert = mVertexBuffer.lock( skirtStart + skirtFirst[edge], skirtStart + skirtLast[edge] + 1 );
+      for ( U32 i = skirtFirst[edge]; i <= skirtLast[edge]; i++ )
+      {
+         _fillSkirtVertex( file, edge, i, vert );
+         ++vert;
+      }
+      mVertexBuffer.unlock();
+   }
+
+   // The PB only needs a rebuild if the empty squares changed.
+   const bool emptyChanged =  emptyList.size() != mEmptyVertexList.size() ||
+                              dMemcmp( emptyList.address(), mEmptyVertexList.address(), emptyList.size() * sizeof( U32 ) ) != 0;
+
+   mEmptyVertexList = emptyList;
+   mHasEmpty = !mEmptyVertexList.empty();
+
+   return emptyChanged;
+}
 
-         // Get the normal.
-         mTerrain->getSmoothNormal( point, &normal, true, false );
-         vert->normal = normal;
+Point2I TerrCell::_getGridPoint( U32 x, U32 y ) const
+{
+   // We clamp here to keep the geometry from reading across
+   // one side of the height map to the other causing walls
+   // around the edges of the terrain.
+   const U32 blockSize = mTerrain->getBlockSize();
+   const U32 stepSize = mSize / smMinCellSize;
+
+   return Point2I(   mClamp( mPoint.x + x * stepSize, 0, blockSize - 1 ),
+                     mClamp( mPoint.y + y * stepSize, 0, blockSize - 1 ) );
+}
+
+void TerrCell::_fillVertex( const TerrainFile *file, U32 x, U32 y, TerrVertex *vert ) const
+{
+   const F32 squareSize = mTerrain->getSquareSize();
+   const Point2I gridPt = _getGridPoint( x, y );
+
+   // Setup this point.
+   const Point2F point( (F32)gridPt.x * squareSize, (F32)gridPt.y * squareSize );
+   const F32 height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
+   vert->point.set( point.x, point.y, height );
+
+   // Get the normal.
+   Point3F normal( 0.0f, 0.0f, 1.0f );
+   mTerrain->getSmoothNormal( point, &normal, true, false );
+   vert->normal = normal;
 
-         // Get the tangent z.
-         vert->tangentZ = fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) ) - height;
+   // Get the tangent z.
+   vert->tangentZ = fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) ) - height;
+}
+
+void TerrCell::_fillSkirtVertex( const TerrainFile *file, U32 edge, U32 i, TerrVertex *vert ) const
+{
+   // The skirts hang beneath the edge vertices of the cell.
+   static const U32 last = smMinCellSize;
+   const U32 x = edge < 2 ? i : ( edge == 2 ? 0 : last );
+   const U32 y = edge >= 2 ? i : ( edge == 0 ? 0 : last );
+
+   const F32 squareSize = mTerrain->getSquareSize();
+   const F32 skirtDepth = mSize / smMinCellSize * squareSize;
+   const Point2I gridPt = _getGridPoint( x, y );
+
+   const Point2F point( (F32)gridPt.x * squareSize, (F32)gridPt.y * squareSize );
+   const F32 height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
+   vert->point.set( point.x, point.y, height - skirtDepth );
+
+   // Get the normal.
+   Point3F normal( 0.0f, 0.0f, 1.0f );
+   mTerrain->getNormal( point, &normal, true, false );
+   vert->normal = normal;
+
+   // Get the tangent.
+   vert->tangentZ = height - fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) );
+}
+
+void TerrCell::_fillVertices( const TerrainFile *file,
+                              TerrVertex *vert, 
+                              bool *outHasEmpty, 
+                              Vector<U32> *outEmptyList ) const
+{
+   PROFILE_SCOPE( TerrCell_FillVertices );
+
+   // Start off with no empty squares
+   *outHasEmpty = false;
+   outEmptyList->clear();
+
+   U32 vbcounter = 0;
+
+   for ( U32 y = 0; y < smVBStride; y++ )
+   {
+      for ( U32 x = 0; x < smVBStride; x++ )
+      {
+         _fillVertex( file, x, y, vert );
 
          // Test the empty state for this vert.
+         const Point2I gridPt = _getGridPoint( x, y );
          if ( file->isEmptyAt( gridPt.x, gridPt.y ) )
          {
-            mHasEmpty = true;
-            mEmptyVertexList.push_back( vbcounter );
+            *outHasEmpty = true;
+            outEmptyList->push_back( vbcounter );
          }
 
          vbcounter++;
@@ -480,108 +642,78 @@ void TerrCell::_updateVertexBuffer()
    }
 
    // Add verts for 'skirts' around/beneath the edge verts of this cell.
-   // This could probably be reduced to a loop...
-   
-   const F32 skirtDepth = mSize / smMinCellSize * mTerrain->getSquareSize();
+   for ( U32 edge = 0; edge < 4; edge++ )
+   {
+      for ( U32 i = 0; i < smVBStride; i++ )
+      {
+         _fillSkirtVertex( file, edge, i, vert );
 
-   // Top edge skirt
-   for ( U32 i = 0; i < smVBStride; i++ )
-   {      
-      gridPt.x = mClamp( mPoint.x + i * stepSize, 0, blockSize - 1 );
-      gridPt.y = mClamp( mPoint.y, 0, blockSize - 1 );
-      
-      point.x = (F32)gridPt.x * squareSize;
-      point.y = (F32)gridPt.y * squareSize;
-      height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
-      vert->point.x = point.x;
-      vert->point.y = point.y;
-      vert->point.z = height - skirtDepth;
-
-      // Get the normal.
-      mTerrain->getNormal( point, &normal, true, false );
-      vert->normal = normal;
-
-      // Get the tangent.
-      vert->tangentZ = height - fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) );
-
-      vbcounter++;
-      ++vert;      
+         vbcounter++;
+         ++vert;
+      }
    }
 
-   // Bottom edge skirt
-   for ( U32 i = 0; i < smVBStride; i++ )
-   {      
-      gridPt.x = mClamp( mPoint.x + i * stepSize, 0, blockSize - 1 );
-      gridPt.y = mClamp( mPoint.y + smMinCellSize * stepSize, 0, blockSize - 1 );
-
-      point.x = (F32)gridPt.x * squareSize;
-      point.y = (F32)gridPt.y * squareSize;
-      height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
-      vert->point.x = point.x;
-      vert->point.y = point.y;
-      vert->point.z = height - skirtDepth;
-
-      // Get the normal.
-      mTerrain->getNormal( point, &normal, true, false );
-      vert->normal = normal;
-
-      // Get the tangent.
-      vert->tangentZ = height - fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) );
-
-      vbcounter++;
-      ++vert;      
-   }
+   AssertFatal( vbcounter == smVBSize, "bad" );
+}
 
-   // Left edge skirt
-   for ( U32 i = 0; i < smVBStride; i++ )
-   {      
-      gridPt.x = mClamp( mPoint.x, 0, blockSize - 1 );
-      gridPt.y = mClamp( mPoint.y + i * stepSize, 0, blockSize - 1 );
+void TerrCell::setVertices( const TerrVertex *verts, bool hasEmpty, const Vector<U32> &emptyList )
+{
+   PROFILE_SCOPE( TerrCell_SetVertices );
 
-      point.x = (F32)gridPt.x * squareSize;
-      point.y = (F32)gridPt.y * squareSize;
-      height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
-      vert->point.x = point.x;
-      vert->point.y = point.y;
-      vert->point.z = height - skirtDepth;
+   mVertexBuffer.set( GFX, smVBSize, GFXBufferTypeStatic );
 
-      // Get the normal.
-      mTerrain->getNormal( point, &normal, true, false );
-      vert->normal = normal;
+   TerrVertex *vert = mVertexBuffer.lock();
+   dMemcpy( vert, verts, smVBSize * sizeof( TerrVertex ) );
+   mVertexBuffer.unlock();
 
-      // Get the tangent.
-      vert->tangentZ = height - fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) );
+   mHasEmpty = hasEmpty;
+   mEmptyVertexList = emptyList;
+   _updatePrimitiveBuffer();
 
-      vbcounter++;
-      ++vert;      
-   }
+   // The tiles are probably loaded by now, so
+   // we can shrink the bounds of the leaves.
+   if ( !mChildren[0] )
+      _updateBounds();
+}
 
-   // Right edge skirt
-   for ( U32 i = 0; i < smVBStride; i++ )
-   {      
-      gridPt.x = mClamp( mPoint.x + smMinCellSize * stepSize, 0, blockSize - 1 );
-      gridPt.y = mClamp( mPoint.y + i * stepSize, 0, blockSize - 1 );
+void TerrCell::releaseVertexBuffer()
+{
+   mVertexBuffer = NULL;
+   mPrimBuffer = NULL;
+   mHasEmpty = false;
+   mEmptyVertexList.clear();
+   mTriCount = 0;
+}
 
-      point.x = (F32)gridPt.x * squareSize;
-      point.y = (F32)gridPt.y * squareSize;
-      height = fixedToFloat( file->getHeight( gridPt.x, gridPt.y ) );
-      vert->point.x = point.x;
-      vert->point.y = point.y;
-      vert->point.z = height - skirtDepth;
+void TerrCell::_getTiles( S32 border, Vector<U32> *outTiles ) const
+{
+   outTiles->clear();
 
-      // Get the normal.
-      mTerrain->getNormal( point, &normal, true, false );
-      vert->normal = normal;
+   const TerrainFile *file = mTerrain->getFile();
+   const S32 tileSize = file->getTileSize();
+   const S32 tilesPerSide = file->getTilesPerSide();
 
-      // Get the tangent.
-      vert->tangentZ = height - fixedToFloat( file->getHeight( gridPt.x + 1, gridPt.y ) );
+   // The samples wrap around the edges like
+   // TerrainFile::getHeight() does.
+   const S32 x0 = (S32)mFloor( (F32)( mPoint.x - border ) / (F32)tileSize );
+   const S32 y0 = (S32)mFloor( (F32)( mPoint.y - border ) / (F32)tileSize );
+   const S32 x1 = ( mPoint.x + mSize + border ) / tileSize;
+   const S32 y1 = ( mPoint.y + mSize + border ) / tileSize;
 
-      vbcounter++;
-      ++vert;      
+   for ( S32 y = y0; y <= y1; y++ )
+   {
+      for ( S32 x = x0; x <= x1; x++ )
+      {
+         const U32 index = ( ( x + tilesPerSide ) % tilesPerSide ) + 
+                           ( ( y + tilesPerSide ) % tilesPerSide ) * tilesPerSide;
+         outTiles->push_back_unique( index );
+      }
    }
+}
 
-   AssertFatal( vbcounter == smVBSize, "bad" );
-   mVertexBuffer.unlock();
+bool TerrCell::_needsTiles() const
+{
+   return ( mSize / smMinCellSize ) < mTerrain->getFile()->getCoarseStep();
 }
 
 void TerrCell::_updatePrimitiveBuffer()
@@ -830,12 +962,27 @@ void TerrCell::_updateMaterials()
    // This should really only be called for cells of smMinCellSize,
    // in which case stepSize is always one.
    U32 stepSize = mSize / smMinCellSize;
+   const U64 oldMaterials = mMaterials;
    mMaterials = 0;
    U8 index;
    U32 x, y;
 
    const TerrainFile *file = mTerrain->getFile();
 
+   // A streamed file knows the materials of each tile
+   // without loading it, which is close enough.
+   if ( file->isStreaming() )
+   {
+      Vector<U32> tiles;
+      _getTiles( 0, &tiles );
+      for ( U32 i=0; i < tiles.size(); i++ )
+         mMaterials |= file->getTileMaterials( tiles[i] );
+
+      if ( mMaterial && mMaterials != oldMaterials )
+         mMaterial->init( mTerrain, mMaterials );
+      return;
+   }
+
    // Step thru the samples in the map then.
    for ( y = 0; y < smVBStride; y++ )
    {
@@ -853,7 +1000,9 @@ void TerrCell::_updateMaterials()
       }
    }
 
-   if ( mMaterial )
+   // Painting rarely changes the set of materials, so
+   // only rebuild the material when it does.
+   if ( mMaterial && mMaterials != oldMaterials )
       mMaterial->init( mTerrain, mMaterials );
 }
 
@@ -876,6 +1025,25 @@ void TerrCell::_updateBounds()
 
    const TerrainFile *file = mTerrain->getFile();
 
+   // The grid square of a streamed file bounds the
+   // samples without needing the tile loaded.
+   if ( file->isStreaming() )
+   {
+      const TerrainSquare *sq = file->findSquare( getBinLog2( mSize ), mPoint.x, mPoint.y );
+
+      mBounds.minExtents.set( (F32)mPoint.x * squareSize,
+                              (F32)mPoint.y * squareSize,
+                              fixedToFloat( sq->minHeight ) );
+      mBounds.maxExtents.set( (F32)( mPoint.x + mSize ) * squareSize,
+                              (F32)( mPoint.y + mSize ) * squareSize,
+                              fixedToFloat( sq->maxHeight ) );
+
+      mRadius = mBounds.len() * 0.5;
+
+      _updateOBB();
+      return;
+   }
+
    for ( U32 y = 0; y < smVBStride; y++ )
    {
       for ( U32 x = 0; x < smVBStride; x++ )
@@ -955,6 +1123,10 @@ void TerrCell::cullCells(  const SceneRenderState *state,
                            const Point3F &objLodPos,
                            Vector<TerrCell*> *outCells  )
 {
+   TerrainStreamer *streamer = mTerrain->getStreamer();
+   if ( streamer )
+      mLastUsed = streamer->getFrame();
+
    // If we have a VB and no children then just add 
    // ourselves to the results and return.
    if ( mVertexBuffer.isValid() && !mChildren[0]  )               
@@ -963,6 +1135,29 @@ void TerrCell::cullCells(  const SceneRenderState *state,
       return;
    }
 
+   // When streaming we can only split into our children
+   // once all of them have their vertices.  Until then we
+   // draw ourselves and ask for them.
+   if ( streamer && mLevel > 0 )
+   {
+      bool childrenReady = true;
+      for ( U32 i = 0; i < 4; i++ )
+      {
+         TerrCell *cell = mChildren[i];
+         if ( cell->mVertexBuffer.isValid() )
+            continue;
+
+         childrenReady = false;
+         streamer->requestCell( cell, cell->getDistanceTo( objLodPos ) );
+      }
+
+      if ( !childrenReady )
+      {
+         outCells->push_back( this );
+         return;
+      }
+   }
+
    const F32 screenError = mTerrain->getScreenError();
    const BitVector &zoneState = state->getCullingState().getZoneVisibilityFlags();
 
@@ -999,6 +1194,23 @@ void TerrCell::cullCells(  const SceneRenderState *state,
       {
          if ( cell->mVertexBuffer.isValid() )
             outCells->push_back( cell );       
+
+         if ( streamer )
+         {
+            cell->mLastUsed = streamer->getFrame();
+
+            // Get the next level ready before we get
+            // close enough to need it.
+            if ( cell->mChildren[0] && errorPixels * 2 >= screenError )
+            {
+               for ( U32 j = 0; j < 4; j++ )
+               {
+                  TerrCell *child = cell->mChildren[j];
+                  if ( !child->mVertexBuffer.isValid() )
+                     streamer->requestCell( child, child->getDistanceTo( objLodPos ) );
+               }
+            }
+         }
       }
       else      
          cell->cullCells( state, objLodPos, outCells );
@@ -1054,8 +1266,9 @@ void TerrCell::preloadMaterials()
 {
    PROFILE_SCOPE( TerrCell_PreloadMaterials );
 
-   // If we have a VB then we need a material.
-   if ( mVertexBuffer.isValid() )
+   // If we have a VB then we need a material... streamed
+   // cells will get one so load it now too.
+   if ( mLevel > 0 )
    {
       TerrainCellMaterial *material = getMaterial();
       material->getReflectMat();
@@ -40,6 +40,8 @@
 #endif
 
 class TerrainBlock;
+class TerrainFile;
+class TerrainStreamer;
 class TerrainCellMaterial;
 class Frustum;
 class SceneRenderState;
@@ -70,6 +72,8 @@ GFXDeclareVertexFormat( TerrVertex )
 /// The TerrCell is a single quadrant of the terrain geometry quadtree.
 class TerrCell
 {
+   friend class TerrainStreamer;
+
 protected:
 
    /// The handle to the static vertex buffer which holds the 
@@ -137,6 +141,10 @@ protected:
    /// @note The bit for the outdoor zone is never set.
    BitVector mZoneOverlap;
 
+   /// The TerrainStreamer frame this cell was last visited
+   /// while culling, used to evict unused vertex buffers.
+   U32 mLastUsed;
+
    ///
    void _updateBounds();
 
@@ -152,6 +160,36 @@ protected:
    // 
    void _updateVertexBuffer();
 
+   /// Rewrites only the vertices which depend on the samples within
+   /// @a gridRect and returns true if the empty squares changed.
+   bool _updateVertexBuffer( const RectI &gridRect );
+
+   /// Returns the grid sample of the vertex at @a x, @a y within
+   /// this cell clamped to the edges of the block.
+   Point2I _getGridPoint( U32 x, U32 y ) const;
+
+   /// Fills the vertex at @a x, @a y within this cell.
+   void _fillVertex( const TerrainFile *file, U32 x, U32 y, TerrVertex *vert ) const;
+
+   /// Fills the skirt vertex @a i along one of the four edges 
+   /// of the cell... top, bottom, left and right in that order.
+   void _fillSkirtVertex( const TerrainFile *file, U32 edge, U32 i, TerrVertex *vert ) const;
+
+   /// Fills the vertices for this cell without touching any GFX
+   /// resources, so it can be called from a worker thread.
+   void _fillVertices(  const TerrainFile *file,
+                        TerrVertex *vert, 
+                        bool *outHasEmpty, 
+                        Vector<U32> *outEmptyList ) const;
+
+   /// Returns the tiles of a streamed file which hold the samples 
+   /// of this cell grown by @a border samples on each side.
+   void _getTiles( S32 border, Vector<U32> *outTiles ) const;
+
+   /// Returns true if the vertices of this cell are finer than the
+   /// coarse samples of a streamed file and need the tiles loaded.
+   bool _needsTiles() const;
+
    //
    void _updatePrimitiveBuffer();
 
@@ -207,6 +245,9 @@ public:
    /// Return true if this is a leaf cell, i.e. a cell without children.
    bool isLeaf() const { return !mChildren[ 0 ]; }
 
+   /// Returns one of the four child cells or NULL for a leaf.
+   TerrCell* getChild( U32 index ) const { return mChildren[ index ]; }
+
    /// Deletes the materials for this cell 
    /// and all its children.  They will be
    /// recreate on the next request.
@@ -216,6 +257,27 @@ public:
 
    Point2I getPoint() const { return mPoint; }   
 
+   U32 getLevel() const { return mLevel; }
+
+   /// Vertex buffer streaming.
+   /// @{
+
+   bool hasVertexBuffer() const { return mVertexBuffer.isValid(); }
+
+   /// Creates the vertex buffer from vertices built by
+   /// _fillVertices() on another thread.
+   void setVertices( const TerrVertex *verts, bool hasEmpty, const Vector<U32> &emptyList );
+
+   /// Frees the vertex and primitive buffers.
+   void releaseVertexBuffer();
+
+   /// Returns the memory used by a vertex buffer.
+   static U32 getVertexBufferSize() { return smVBSize * sizeof( TerrVertex ); }
+
+   U32 getLastUsed() const { return mLastUsed; }
+
+   /// @}
+
    /// Initializes a primitive buffer for rendering any cell.
    static void createPrimBuffer( GFXPrimitiveBufferHandle *primBuffer );
 
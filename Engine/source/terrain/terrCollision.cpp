@@ -627,6 +627,13 @@ bool TerrainBlock::castRay(const Point3F &start, const Point3F &end, RayInfo *in
    if ( !castRayI(start, end, info, false) )
       return false;
       
+   _setRayContact( start, end, info );
+
+   return true;
+}
+
+void TerrainBlock::_setRayContact( const Point3F &start, const Point3F &end, RayInfo *info ) const
+{
    // Set intersection point.
    info->setContactPoint( start, end );
    getTransform().mulP( info->point );    // transform to world coordinates for getGridPos
@@ -635,8 +642,6 @@ bool TerrainBlock::castRay(const Point3F &start, const Point3F &end, RayInfo *in
    Point2I gridPos = getGridPos( info->point );
    U8 layer = mFile->getLayerIndex( gridPos.x, gridPos.y );
    info->material = mFile->getMaterialMapping( layer );
-
-   return true;
 }
 
 bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *info, bool collideEmpty)
@@ -758,6 +763,100 @@ bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *i
    return false;
 }
 
+bool TerrainBlock::_castRaySquare(  const Point3F &pStart, 
+                                    const Point3F &pEnd, 
+                                    const Point2I &blockPos, 
+                                    const TerrainSquare *sq, 
+                                    F32 startT, 
+                                    F32 endT, 
+                                    RayInfo *info ) const
+{
+   F32 invBlockSize = 1 / F32( mFile->mSize );
+
+   F32 xs = blockPos.x * invBlockSize;
+   F32 ys = blockPos.y * invBlockSize;
+
+   F32 zBottomLeft = fixedToFloat( mFile->getHeight(blockPos.x, blockPos.y) );
+   F32 zBottomRight= fixedToFloat( mFile->getHeight(blockPos.x + 1, blockPos.y) );
+   F32 zTopLeft =    fixedToFloat( mFile->getHeight(blockPos.x, blockPos.y + 1) );
+   F32 zTopRight =   fixedToFloat( mFile->getHeight(blockPos.x + 1, blockPos.y + 1) );
+
+   PlaneF p1, p2;
+   PlaneF divider;
+   Point3F planePoint;
+
+   if(sq->flags & TerrainSquare::Split45)
+   {
+      p1.set(zBottomLeft - zBottomRight, zBottomRight - zTopRight, invBlockSize);
+      p2.set(zTopLeft - zTopRight, zBottomLeft - zTopLeft, invBlockSize);
+      planePoint.set(xs, ys, zBottomLeft);
+      divider.x = 1;
+      divider.y = -1;
+      divider.z = 0;
+   }
+   else
+   {
+      p1.set(zTopLeft - zTopRight, zBottomRight - zTopRight, invBlockSize);
+      p2.set(zBottomLeft - zBottomRight, zBottomLeft - zTopLeft, invBlockSize);
+      planePoint.set(xs + invBlockSize, ys, zBottomRight);
+      divider.x = 1;
+      divider.y = 1;
+      divider.z = 0;
+   }
+   p1.setPoint(planePoint);
+   p2.setPoint(planePoint);
+   divider.setPoint(planePoint);
+
+   F32 t1 = p1.intersect(pStart, pEnd);
+   F32 t2 = p2.intersect(pStart, pEnd);
+   F32 td = divider.intersect(pStart, pEnd);
+
+   F32 dStart = divider.distToPlane(pStart);
+   F32 dEnd = divider.distToPlane(pEnd);
+
+   // see if the line crosses the divider
+   if((dStart >= 0 && dEnd < 0) || (dStart < 0 && dEnd >= 0))
+   {
+      if(dStart < 0)
+      {
+         F32 temp = t1;
+         t1 = t2;
+         t2 = temp;
+      }
+      if(t1 >= startT && t1 && t1 <= td && t1 <= endT)
+      {
+         info->t = t1;
+         info->normal = p1;
+         return true;
+      }
+      if(t2 >= td && t2 >= startT && t2 <= endT)
+      {
+         info->t = t2;
+         info->normal = p2;
+         return true;
+      }
+   }
+   else
+   {
+      F32 t;
+      if(dStart >= 0) {
+         t = t1;
+         info->normal = p1;
+      }
+      else {
+         t = t2;
+         info->normal = p2;
+      }
+      if(t >= startT && t <= endT)
+      {
+         info->t = t;
+         return true;
+      }
+   }
+
+   return false;
+}
+
 struct TerrLOSStackNode
 {
    F32 startT;
@@ -822,86 +921,8 @@ bool TerrainBlock::castRayBlock( const Point3F &pStart,
 
       if(level == 0)
       {
-         F32 xs = blockPos.x * invBlockSize;
-         F32 ys = blockPos.y * invBlockSize;
-
-         F32 zBottomLeft = fixedToFloat( mFile->getHeight(blockPos.x, blockPos.y) );
-         F32 zBottomRight= fixedToFloat( mFile->getHeight(blockPos.x + 1, blockPos.y) );
-         F32 zTopLeft =    fixedToFloat( mFile->getHeight(blockPos.x, blockPos.y + 1) );
-         F32 zTopRight =   fixedToFloat( mFile->getHeight(blockPos.x + 1, blockPos.y + 1) );
-
-         PlaneF p1, p2;
-         PlaneF divider;
-         Point3F planePoint;
-
-         if(sq->flags & TerrainSquare::Split45)
-         {
-            p1.set(zBottomLeft - zBottomRight, zBottomRight - zTopRight, invBlockSize);
-            p2.set(zTopLeft - zTopRight, zBottomLeft - zTopLeft, invBlockSize);
-            planePoint.set(xs, ys, zBottomLeft);
-            divider.x = 1;
-            divider.y = -1;
-            divider.z = 0;
-         }
-         else
-         {
-            p1.set(zTopLeft - zTopRight, zBottomRight - zTopRight, invBlockSize);
-            p2.set(zBottomLeft - zBottomRight, zBottomLeft - zTopLeft, invBlockSize);
-            planePoint.set(xs + invBlockSize, ys, zBottomRight);
-            divider.x = 1;
-            divider.y = 1;
-            divider.z = 0;
-         }
-         p1.setPoint(planePoint);
-         p2.setPoint(planePoint);
-         divider.setPoint(planePoint);
-
-         F32 t1 = p1.intersect(pStart, pEnd);
-         F32 t2 = p2.intersect(pStart, pEnd);
-         F32 td = divider.intersect(pStart, pEnd);
-
-         F32 dStart = divider.distToPlane(pStart);
-         F32 dEnd = divider.distToPlane(pEnd);
-
-         // see if the line crosses the divider
-         if((dStart >= 0 && dEnd < 0) || (dStart < 0 && dEnd >= 0))
-         {
-            if(dStart < 0)
-            {
-               F32 temp = t1;
-               t1 = t2;
-               t2 = temp;
-            }
-            if(t1 >= startT && t1 && t1 <= td && t1 <= endT)
-            {
-               info->t = t1;
-               info->normal = p1;
-               return true;
-            }
-            if(t2 >= td && t2 >= startT && t2 <= endT)
-            {
-               info->t = t2;
-               info->normal = p2;
-               return true;
-            }
-         }
-         else
-         {
-            F32 t;
-            if(dStart >= 0) {
-               t = t1;
-               info->normal = p1;
-            }
-            else {
-               t = t2;
-               info->normal = p2;
-            }
-            if(t >= startT && t <= endT)
-            {
-               info->t = t;
-               return true;
-            }
-         }
+         if ( _castRaySquare( pStart, pEnd, blockPos, sq, startT, endT, info ) )
+            return true;
          continue;
       }
       S32 subSqWidth = 1 << (level - 1);
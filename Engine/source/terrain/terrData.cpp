@@ -28,6 +28,7 @@
 #include "terrain/terrRender.h"
 #include "terrain/terrMaterial.h"
 #include "terrain/terrCellMaterial.h"
+#include "terrain/terrStreaming.h"
 #include "gui/worldEditor/terrainEditor.h"
 #include "math/mathIO.h"
 #include "core/stream/fileStream.h"
@@ -190,8 +191,10 @@ TerrainBlock::TerrainBlock()
    mMaxDetailDistance( 0.0f ),
    mCell( NULL ),
    mCRC( 0 ),
+   mLayerTexDirtyRect( 0, 0, 0, 0 ),
    mBaseTexSize( 1024 ),
    mBaseTexFormat( TerrainBlock::JPG ),
+   mStreamer( NULL ),
    mBaseMaterial( NULL ),
    mDefaultMatInst( NULL ),
    mBaseTexScaleConst( NULL ),
@@ -408,9 +411,13 @@ void TerrainBlock::updateGridMaterials( const Point2I &minPt, const Point2I &max
       mCell->updateGrid( gridRect, true );
    }
 
-   // We mark us as dirty... it will be updated
-   // before the next time we render the terrain.
-   mLayerTexDirty = true;
+   // We mark the painted samples as dirty... they will be
+   // updated before the next time we render the terrain.
+   const RectI dirtyRect( minPt, maxPt - minPt + Point2I( 1, 1 ) );
+   if ( mLayerTexDirtyRect.isValidRect() )
+      mLayerTexDirtyRect.unionRects( dirtyRect );
+   else
+      mLayerTexDirtyRect = dirtyRect;
 
    // Signal anyone that cares that the opacity was changed.
    smUpdateSignal.trigger( LayersUpdate, this, minPt, maxPt );
@@ -802,6 +809,7 @@ void TerrainBlock::removeMaterial( U32 index )
    if ( mFile->mMaterials.size() == 1 )
       return;
 
+   mFile->makeResident();
    mFile->mMaterials.erase( index );
    mFile->_initMaterialInstMapping();
 
@@ -929,7 +937,7 @@ bool TerrainBlock::onAdd()
       }
    }
 
-   if (terr->mFileVersion != TerrainFile::FILE_VERSION || terr->mNeedsResaving)
+   if (terr->mFileVersion < TerrainFile::FILE_VERSION || terr->mNeedsResaving)
    {
       Con::errorf(" *********************************************************");
       Con::errorf(" *********************************************************");
@@ -961,16 +969,21 @@ bool TerrainBlock::onAdd()
 
       // If the cached base texture is older that the terrain file or
       // it doesn't exist then generate and cache it.
+      // The generated texture is used until the cache 
+      // is written and loaded the next time.
       String baseCachePath = _getBaseTexCacheFileName();
       if ( Platform::compareModifiedTimes( baseCachePath, mTerrFileName ) < 0 )
          _updateBaseTexture( true );
-
-      // The base texture should have been cached by now... so load it.
-      mBaseTex.set( baseCachePath, &GFXDefaultStaticDiffuseProfile, "TerrainBlock::mBaseTex" );
+      else
+         mBaseTex.set( baseCachePath, &GFXDefaultStaticDiffuseProfile, "TerrainBlock::mBaseTex" );
 
       GFXTextureManager::addEventDelegate( this, &TerrainBlock::_onTextureEvent );
       MATMGR->getFlushSignal().notify( this, &TerrainBlock::_onFlushMaterials );
 
+      // A streamed file only loads the tiles around the camera.
+      if ( terr->isStreaming() )
+         mStreamer = new TerrainStreamer( this );
+
       // Build the terrain quadtree.
       _rebuildQuadtree();
 
@@ -981,8 +994,15 @@ bool TerrainBlock::onAdd()
       SceneZoneSpaceManager::getZoningChangedSignal().notify( this, &TerrainBlock::_onZoningChanged );
    }
    else
+   {
       mCRC = terr.getChecksum();
 
+      // A dedicated server has no camera to stream
+      // around, so it needs the whole file.
+      if ( Con::getBoolVariable( "Server::Dedicated" ) )
+         terr->makeResident();
+   }
+
    addToScene();
 
    _updatePhysics();
@@ -1000,6 +1020,10 @@ String TerrainBlock::_getBaseTexCacheFileName() const
 
 void TerrainBlock::_rebuildQuadtree()
 {
+   // Stop any work on the old cells.
+   if ( mStreamer )
+      mStreamer->reset();
+
    SAFE_DELETE( mCell );
 
    // Recursively build the cells.
@@ -1016,6 +1040,12 @@ void TerrainBlock::_updatePhysics()
 
    SAFE_DELETE( mPhysicsRep );
 
+   // Without a world there is nothing to collide with, so
+   // don't make a streamed file resident for nothing.
+   PhysicsWorld *world = PHYSICSMGR->getWorld( isServerObject() ? "server" : "client" );
+   if ( !world )
+      return;
+
    PhysicsCollision *colShape;
 
    // If we can steal the collision shape from the local server
@@ -1024,13 +1054,22 @@ void TerrainBlock::_updatePhysics()
    // TODO: We should move this sharing down into TerrFile where
    // it probably belongs.
    //
-   if ( getServerObject() )
-   {
-      TerrainBlock *serverTerrain = (TerrainBlock*)getServerObject();
+   TerrainBlock *serverTerrain = (TerrainBlock*)getServerObject();
+   if ( serverTerrain && serverTerrain->mPhysicsRep )
       colShape = serverTerrain->mPhysicsRep->getColShape();
-   }
    else
    {
+      // The physics plugins keep pointers into the height map
+      // for as long as the heightfield exists and only take it
+      // whole, so a streamed file has to stay resident for the
+      // life of the collider.  Say so, as it ends streaming.
+      if ( mFile->isStreaming() )
+      {
+         Con::warnf( "TerrainBlock::_updatePhysics - The physics plugin needs the whole heightfield, so streaming of '%s' is turned off.",
+            mTerrFileName.c_str() );
+         mFile->makeResident();
+      }
+
       // Get empty state of each vert
       bool *holes = new bool[ getBlockSize() * getBlockSize() ];
       for ( U32 row = 0; row < getBlockSize(); row++ )
@@ -1043,7 +1082,6 @@ void TerrainBlock::_updatePhysics()
       delete [] holes;
    }
 
-   PhysicsWorld *world = PHYSICSMGR->getWorld( isServerObject() ? "server" : "client" );
    mPhysicsRep = PHYSICSMGR->createBody();
    mPhysicsRep->init( colShape, 0, 0, this, world );
    mPhysicsRep->setTransform( getTransform() );
@@ -1062,6 +1100,7 @@ void TerrainBlock::onRemove()
       mLayerTex = NULL;
       SAFE_DELETE( mBaseMaterial );
       SAFE_DELETE( mDefaultMatInst );
+      SAFE_DELETE( mStreamer );
       SAFE_DELETE( mCell );
       mPrimBuffer = NULL;
       mBaseShader = NULL;
@@ -1161,6 +1200,19 @@ void TerrainBlock::initPersistFields()
 
    Con::addVariable( "$pref::Terrain::detailScale", TypeF32, &smDetailScale, "A global detail scale used to tweak the material detail distances.\n\n" 
 	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::streaming", TypeBool, &TerrainFile::smStreaming, "If true tiled terrain files are streamed around the camera instead of being fully loaded.  "
+      "A terrain with a physics plugin collider is always fully loaded.\n\n" 
+	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::tileBudget", TypeF32, &TerrainStreamer::smTileBudget, "The memory in megabytes for the loaded tiles of streamed terrain files.\n\n" 
+	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::cellBudget", TypeF32, &TerrainStreamer::smCellBudget, "The memory in megabytes for the streamed terrain cell vertex buffers.\n\n" 
+	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::tileRadius", TypeF32, &TerrainStreamer::smTileRadius, "The distance in meters around the camera to load the tiles of streamed terrain files.\n\n" 
+	   "@ingroup Terrain");
 }
 
 void TerrainBlock::inspectPostApply()
@@ -1297,6 +1349,25 @@ DefineEngineMethod( TerrainBlock, save, bool, ( const char* fileName),,
    return static_cast<TerrainBlock*>(object)->save(filename);
 }
 
+DefineEngineMethod( TerrainBlock, saveTiled, bool, ( const char* fileName, S32 tileSize ), ( 256 ),
+				   "@brief Saves the terrain block's terrain file in the tiled format which can be streamed.\n\n"
+
+				   "@param fileName Name and path of file to save terrain data to.\n"
+				   "@param tileSize The samples per side of each tile, a power of two of at least 64.\n\n"
+
+				   "@return True if file save was successful, false otherwise")
+{
+	char filename[256];
+	dStrcpy(filename,fileName);
+   char *ext = dStrrchr(filename, '.');
+   if (!ext || dStricmp(ext, ".ter") != 0)
+      dStrcat(filename, ".ter");
+
+   TerrainFile *file = object->getFile();
+   file->setTileSize( tileSize );
+   return object->save(filename);
+}
+
 //ConsoleMethod(TerrainBlock, save, bool, 3, 3, "(string fileName) - saves the terrain block's terrain file to the specified file name.")
 //{
 //   char filename[256];
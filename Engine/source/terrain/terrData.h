@@ -50,6 +50,7 @@
 class GBitmap;
 class TerrainBlock;
 class TerrCell;
+class TerrainStreamer;
 class PhysicsBody;
 class TerrainCellMaterial;
 
@@ -59,6 +60,7 @@ class TerrainBlock : public SceneObject
 
    friend class TerrainEditor;
    friend class TerrainCellMaterial;
+   friend class TerrainStreamer;
 
 protected:
 
@@ -133,6 +135,10 @@ protected:
    ///
    GFXStateBlockRef mBaseShaderSB;
 
+   /// Blends the first layer over the old texels when
+   /// only part of the base texture is updated.
+   GFXStateBlockRef mBaseShaderReplaceSB;
+
    ///
    GFXShaderConstBufferRef mBaseShaderConsts;
 
@@ -153,6 +159,10 @@ protected:
    ///
    bool mLayerTexDirty;
 
+   /// The part of the layer map painted since the last render
+   /// when the whole layer texture isn't #mLayerTexDirty.
+   RectI mLayerTexDirtyRect;
+
    /// The desired size for the base texture.
    U32 mBaseTexSize;
 
@@ -161,6 +171,10 @@ protected:
    ///
    TerrCell *mCell;
 
+   /// Loads the tiles and builds the cells of a
+   /// streamed file on the client, else NULL.
+   TerrainStreamer *mStreamer;
+
    /// The shared base material which is used to render
    /// cells that are outside the detail map range.
    TerrainCellMaterial *mBaseMaterial;
@@ -225,13 +239,46 @@ protected:
    ///
    void _updateMaterials();
 
-   /// 
+   /// Regenerates the base texture.  When @a writeToCache is set
+   /// it is read back and written to the cache file by a worker thread.
    void _updateBaseTexture( bool writeToCache );
 
+   /// Regenerates the part of the base texture over the 
+   /// layer map samples within @a layerRect.
+   void _updateBaseTexture( const RectI &layerRect );
+
+   /// Blends the base texture into @a blendTex, or just the part
+   /// over @a layerRect if it isn't NULL.
+   void _renderBaseTexture( GFXTextureObject *blendTex, const RectI *layerRect );
+
+   /// Returns the size of the base texture render target.
+   U32 _getBaseTexTargetSize() const;
+
+   /// Returns true if the base texture is a render target of
+   /// @a baseTexSize which can be blended into.
+   bool _isBaseTexTarget( U32 baseTexSize ) const;
+
    void _updateLayerTexture();
 
+   /// Updates part of the layer texture.
+   void _updateLayerTexture( const RectI &rect );
+
    void _updateBounds();
 
+   /// Tests a ray in the normalized block space of castRayBlock()
+   /// against the two triangles of the level zero square at @a blockPos.
+   bool _castRaySquare( const Point3F &pStart, 
+                        const Point3F &pEnd, 
+                        const Point2I &blockPos, 
+                        const TerrainSquare *sq, 
+                        F32 startT, 
+                        F32 endT, 
+                        RayInfo *info ) const;
+
+   /// Sets the world space contact point and material 
+   /// of a ray which hit the terrain.
+   void _setRayContact( const Point3F &start, const Point3F &end, RayInfo *info ) const;
+
    void _onZoningChanged( SceneZoneSpaceManager *zoneManager );
 
    void _updateZoning();
@@ -277,6 +324,8 @@ public:
 
    Resource<TerrainFile> getFile() const { return mFile; };
 
+   TerrainStreamer* getStreamer() const { return mStreamer; }
+
    bool onAdd();
    void onRemove();
 
@@ -301,9 +350,9 @@ public:
    /// Accessors and mutators for TerrainMaterialUndoAction.
    /// @{
    const Vector<TerrainMaterial*>& getMaterials() const { return mFile->mMaterials; }   
-   const Vector<U8>& getLayerMap() const { return mFile->mLayerMap; }
+   const Vector<U8>& getLayerMap() { mFile->makeResident(); return mFile->mLayerMap; }
    void setMaterials( const Vector<TerrainMaterial*> &materials ) { mFile->mMaterials = materials; }
-   void setLayerMap( const Vector<U8> &layers ) { mFile->mLayerMap = layers; }
+   void setLayerMap( const Vector<U8> &layers ) { mFile->makeResident(); mFile->mLayerMap = layers; }
    /// @}
 
    TerrainMaterial* getMaterial( U32 index ) const;
@@ -449,6 +498,44 @@ public:
                         RayInfo *info, 
                         bool collideEmpty );
 
+   /// @name Batched Queries
+   /// These answer many queries at once, which is a lot cheaper than
+   /// a call per point when placing foliage or snapping to the ground.
+   /// @{
+
+   /// Use the SSE versions of the batched queries when the CPU has SSE2.
+   static bool smSIMDQueries;
+
+   /// The batched version of getNormalHeightMaterial() for @a count 2d
+   /// positions in the terrains object space.  The normals are normalized
+   /// and the layers are indices for getMaterialName().  Either may be 
+   /// NULL if it isn't wanted.
+   ///
+   /// Positions within an empty block or outside of the terrain
+   /// area are flagged false in @a outHits.
+   ///
+   /// @return The number of positions which hit the terrain.
+   U32 getHeights(   const Point2F *pos, 
+                     U32 count, 
+                     F32 *outHeights, 
+                     Point3F *outNormals, 
+                     U8 *outLayers, 
+                     bool *outHits ) const;
+
+   /// Casts @a count rays in the terrains object space, walking the
+   /// min/max quadtree with packets of rays instead of one at a time.
+   /// The infos of the rays flagged in @a outHits are filled like
+   /// castRay() does it.
+   ///
+   /// @return The number of rays which hit the terrain.
+   U32 castRays(  const Point3F *starts, 
+                  const Point3F *ends, 
+                  U32 count, 
+                  RayInfo *outInfos, 
+                  bool *outHits );
+
+   /// @}
+
    const FileName& getTerrainFile() const { return mTerrFileName; }
 
    void postLight(Vector<TerrainBlock *> &terrBlocks) {};
@@ -31,6 +31,8 @@
 
 bool TerrainBlock::exportHeightMap( const UTF8 *filePath, const String &format ) const
 {
+   // We need all the samples of a streamed file.
+   const_cast<TerrainFile*>( (const TerrainFile*)mFile )->makeResident();
 
    GBitmap output(   mFile->mSize,
                      mFile->mSize,
@@ -92,6 +94,9 @@ bool TerrainBlock::exportHeightMap( const UTF8 *filePath, const String &format )
 
 bool TerrainBlock::exportLayerMaps( const UTF8 *filePrefix, const String &format ) const
 {
+   // We need all the samples of a streamed file.
+   const_cast<TerrainFile*>( (const TerrainFile*)mFile )->makeResident();
+
    for(S32 i = 0; i < mFile->mMaterials.size(); i++)
    {
       Vector<const U8>::iterator iBits = mFile->mLayerMap.begin();
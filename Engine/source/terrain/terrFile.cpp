@@ -29,6 +29,7 @@
 #include "gfx/gfxTextureHandle.h"
 #include "gfx/bitmap/gBitmap.h"
 #include "platform/profiler.h"
+#include "platform/platformIntrinsics.h"
 #include "math/mPlane.h"
 
 
@@ -44,10 +45,28 @@ template<> ResourceBase::Signature Resource<TerrainFile>::signature()
 }
 
 
+bool TerrainFile::smStreaming = true;
+
+/// The log2 of the coarse sample spacing in tiled files.
+static const U32 sCoarseShift = 3;
+
+
 TerrainFile::TerrainFile()
    : mNeedsResaving( false ),
      mFileVersion( FILE_VERSION ),
-     mSize( 256 )
+     mSize( 256 ),
+     mGridLevels( 0 ),
+     mTileSize( 0 ),
+     mTileShift( 0 ),
+     mTilesPerSide( 0 ),
+     mTileLevels( 0 ),
+     mResidentTiles( 0 ),
+     mTileDataStart( 0 ),
+     mCoarseShift( 0 ),
+     mCoarseSize( 0 ),
+     mStreamReaders( 0 ),
+     mStreamClosing( 0 ),
+     mStreamDrained( 0 )
 {
    mLayerMap.setSize( mSize * mSize );
    dMemset( mLayerMap.address(), 0, mLayerMap.memSize() );
@@ -58,6 +77,7 @@ TerrainFile::TerrainFile()
 
 TerrainFile::~TerrainFile()
 {
+   _clearTiles();
 }
 
 static U16 calcDev( const PlaneF &pl, const Point3F &pt )
@@ -89,6 +109,149 @@ inline U32 getMostSignificantBit( U32 v )
    return bit;
 }
 
+namespace {
+
+/// Samples a fully loaded file for building grid squares.
+struct FileGridSampler
+{
+   const TerrainFile *file;
+
+   FileGridSampler( const TerrainFile *inFile ) : file( inFile ) {}
+
+   U16 getHeight( S32 x, S32 y ) const { return file->getHeight( x, y ); }
+   bool isEmptyAt( S32 x, S32 y ) const { return file->isEmptyAt( x, y ); }
+};
+
+/// Samples one tile for building its grid squares.
+struct TileGridSampler
+{
+   const U16 *heights;
+   const U8 *layers;
+   S32 size;
+
+   TileGridSampler( const TerrainFile::TileData *data, S32 tileSize )
+      : heights( data->heights.address() ), layers( data->layers.address() ), size( tileSize ) {}
+
+   U16 getHeight( S32 x, S32 y ) const { return heights[ x + y * ( size + 1 ) ]; }
+   bool isEmptyAt( S32 x, S32 y ) const { return layers[ x + y * size ] == U8_MAX; }
+};
+
+/// Calculates the height range, empty state and split of one grid
+/// square from the samples at @a x0, @a y0.  The square's position
+/// in its level is used to pick the default split direction.
+template< class Sampler >
+void calcGridSquare( const Sampler &samples,
+                     S32 x0, S32 y0,
+                     S32 squareSize,
+                     S32 level,
+                     S32 squareX, S32 squareY,
+                     TerrainSquare *parent,
+                     bool updateParent,
+                     TerrainSquare *sq )
+{
+   U16 min = 0xFFFF;
+   U16 max = 0;
+   U16 mindev45 = 0;
+   U16 mindev135 = 0;
+
+   // determine max error for both possible splits.
+
+   const Point3F p1(0, 0, samples.getHeight(x0, y0));
+   const Point3F p2(0, (F32)squareSize, samples.getHeight(x0, y0 + squareSize));
+   const Point3F p3((F32)squareSize, (F32)squareSize, samples.getHeight(x0 + squareSize, y0 + squareSize));
+   const Point3F p4((F32)squareSize, 0, samples.getHeight(x0 + squareSize, y0));
+
+   // pl1, pl2 = split45, pl3, pl4 = split135
+   const PlaneF pl1(p1, p2, p3);
+   const PlaneF pl2(p1, p3, p4);
+   const PlaneF pl3(p1, p2, p4);
+   const PlaneF pl4(p2, p3, p4);
+
+   const bool parentSplit45 = parent && ( parent->flags & TerrainSquare::Split45 );
+
+   bool empty = true;
+   bool hasEmpty = false;
+
+   for ( S32 sizeX = 0; sizeX <= squareSize; sizeX++ )
+   {
+      for ( S32 sizeY = 0; sizeY <= squareSize; sizeY++ )
+      {
+         S32 x = x0 + sizeX;
+         S32 y = y0 + sizeY;
+
+         if(sizeX != squareSize && sizeY != squareSize)
+         {
+            if ( !samples.isEmptyAt( x, y ) )
+               empty = false;
+            else
+               hasEmpty = true;
+         }
+
+         U16 ht = samples.getHeight( x, y );
+         if ( ht < min )
+            min = ht;
+         if( ht > max )
+            max = ht;
+
+         Point3F pt( (F32)sizeX, (F32)sizeY, (F32)ht );
+         U16 dev;
+
+         if(sizeX < sizeY)
+            dev = calcDev(pl1, pt);
+         else if(sizeX > sizeY)
+            dev = calcDev(pl2, pt);
+         else
+            dev = Umax(calcDev(pl1, pt), calcDev(pl2, pt));
+
+         if(dev > mindev45)
+            mindev45 = dev;
+
+         if(sizeX + sizeY < squareSize)
+            dev = calcDev(pl3, pt);
+         else if(sizeX + sizeY > squareSize)
+            dev = calcDev(pl4, pt);
+         else
+            dev = Umax(calcDev(pl3, pt), calcDev(pl4, pt));
+
+         if(dev > mindev135)
+            mindev135 = dev;
+      }
+   }
+
+   sq->minHeight = min;
+   sq->maxHeight = max;
+
+   sq->flags = empty ? TerrainSquare::Empty : 0;
+   if ( hasEmpty )
+      sq->flags |= TerrainSquare::HasEmpty;
+
+   bool shouldSplit45 = ((squareX ^ squareY) & 1) == 0;
+   bool split45;
+
+   //split45 = shouldSplit45;
+   if ( level == 0 )
+      split45 = shouldSplit45;
+   else if( level < 4 && shouldSplit45 == parentSplit45 )
+      split45 = shouldSplit45;
+   else
+      split45 = mindev45 < mindev135;
+
+   //split45 = shouldSplit45;
+   if(split45)
+   {
+      sq->flags |= TerrainSquare::Split45;
+      sq->heightDeviance = mindev45;
+   }
+   else
+      sq->heightDeviance = mindev135;
+
+   if( parent && updateParent )
+      if (  parent->heightDeviance < sq->heightDeviance )
+            parent->heightDeviance = sq->heightDeviance;
+}
+
+} // namespace
+
 void TerrainFile::_buildGridMap()
 {
    // The grid level count is the same as the
@@ -126,112 +289,18 @@ void TerrainFile::_buildGridMap()
       {
          for ( S32 squareY = 0; squareY < squareCount; squareY++ )
          {
-            U16 min = 0xFFFF;
-            U16 max = 0;
-            U16 mindev45 = 0;
-            U16 mindev135 = 0;
-
-            // determine max error for both possible splits.
-
-            const Point3F p1(0, 0, getHeight(squareX * squareSize, squareY * squareSize));
-            const Point3F p2(0, (F32)squareSize, getHeight(squareX * squareSize, squareY * squareSize + squareSize));
-            const Point3F p3((F32)squareSize, (F32)squareSize, getHeight(squareX * squareSize + squareSize, squareY * squareSize + squareSize));
-            const Point3F p4((F32)squareSize, 0, getHeight(squareX * squareSize + squareSize, squareY * squareSize));
-
-            // pl1, pl2 = split45, pl3, pl4 = split135
-            const PlaneF pl1(p1, p2, p3);
-            const PlaneF pl2(p1, p3, p4);
-            const PlaneF pl3(p1, p2, p4);
-            const PlaneF pl4(p2, p3, p4);
-
-            bool parentSplit45 = false;
             TerrainSquare *parent = NULL;
             if ( i < mGridLevels )
-            {
                parent = findSquare( i+1, squareX * squareSize, squareY * squareSize );
-               parentSplit45 = parent->flags & TerrainSquare::Split45;
-            }
-
-            bool empty = true;
-            bool hasEmpty = false;
-
-            for ( S32 sizeX = 0; sizeX <= squareSize; sizeX++ )
-            {
-               for ( S32 sizeY = 0; sizeY <= squareSize; sizeY++ )
-               {
-                  S32 x = squareX * squareSize + sizeX;
-                  S32 y = squareY * squareSize + sizeY;
-
-                  if(sizeX != squareSize && sizeY != squareSize)
-                  {
-                     if ( !isEmptyAt( x, y ) )
-                        empty = false;
-                     else
-                        hasEmpty = true;
-                  }
-
-                  U16 ht = getHeight( x, y );
-                  if ( ht < min )
-                     min = ht;
-                  if( ht > max )
-                     max = ht;
-
-                  Point3F pt( (F32)sizeX, (F32)sizeY, (F32)ht );
-                  U16 dev;
-
-                  if(sizeX < sizeY)
-                     dev = calcDev(pl1, pt);
-                  else if(sizeX > sizeY)
-                     dev = calcDev(pl2, pt);
-                  else
-                     dev = Umax(calcDev(pl1, pt), calcDev(pl2, pt));
-
-                  if(dev > mindev45)
-                     mindev45 = dev;
-
-                  if(sizeX + sizeY < squareSize)
-                     dev = calcDev(pl3, pt);
-                  else if(sizeX + sizeY > squareSize)
-                     dev = calcDev(pl4, pt);
-                  else
-                     dev = Umax(calcDev(pl3, pt), calcDev(pl4, pt));
-
-                  if(dev > mindev135)
-                     mindev135 = dev;
-               }
-            }
 
             TerrainSquare *sq = findSquare( i, squareX * squareSize, squareY * squareSize );
-            sq->minHeight = min;
-            sq->maxHeight = max;
-
-            sq->flags = empty ? TerrainSquare::Empty : 0;
-            if ( hasEmpty )
-               sq->flags |= TerrainSquare::HasEmpty;
 
-            bool shouldSplit45 = ((squareX ^ squareY) & 1) == 0;
-            bool split45;
-
-            //split45 = shouldSplit45;
-            if ( i == 0 )
-               split45 = shouldSplit45;
-            else if( i < 4 && shouldSplit45 == parentSplit45 )
-               split45 = shouldSplit45;
-            else
-               split45 = mindev45 < mindev135;
-
-            //split45 = shouldSplit45;
-            if(split45)
-            {
-               sq->flags |= TerrainSquare::Split45;
-               sq->heightDeviance = mindev45;
-            }
-            else
-               sq->heightDeviance = mindev135;
-
-            if( parent )
-               if (  parent->heightDeviance < sq->heightDeviance )
-                     parent->heightDeviance = sq->heightDeviance;
+            calcGridSquare(   FileGridSampler( this ),
+                              squareX * squareSize, squareY * squareSize,
+                              squareSize, i,
+                              squareX, squareY,
+                              parent, true,
+                              sq );
          }
       }
    }
@@ -267,11 +336,17 @@ void TerrainFile::_initMaterialInstMapping()
 
 bool TerrainFile::save( const char *filename )
 {
+   // We need all the samples to save.
+   makeResident();
+
    FileStream stream;
    stream.open( filename, Torque::FS::File::Write );
    if ( stream.getStatus() != Stream::Ok )
       return false;
 
+   if ( mTileSize != 0 )
+      return _saveTiled( stream );
+
    stream.write( (U8)FILE_VERSION );
 
    stream.write( mSize );
@@ -305,9 +380,9 @@ TerrainFile* TerrainFile::load( const Torque::Path &path )
 
    U8 version;
    stream.read(&version);
-   if (version > TerrainFile::FILE_VERSION)
+   if (version > TerrainFile::TILED_FILE_VERSION)
    {
-      Con::errorf( "Resource<TerrainFile>::create - file version '%i' is newer than engine version '%i'", version, TerrainFile::FILE_VERSION );
+      Con::errorf( "Resource<TerrainFile>::create - file version '%i' is newer than engine version '%i'", version, TerrainFile::TILED_FILE_VERSION );
       return NULL;
    }
 
@@ -315,13 +390,17 @@ TerrainFile* TerrainFile::load( const Torque::Path &path )
    ret->mFileVersion = version;
    ret->mFilePath = path;
 
-   if ( version >= 7 )
+   if ( version >= TILED_FILE_VERSION )
+      ret->_loadTiled( stream );
+   else if ( version >= 7 )
       ret->_load( stream );
    else
       ret->_loadLegacy( stream );
 
-   // Update the collision structures.
-   ret->_buildGridMap();
+   // Update the collision structures... a streamed 
+   // file has loaded the upper grid levels already.
+   if ( ret->mTiles.empty() )
+      ret->_buildGridMap();
    
    // Do the material mapping.
    ret->_initMaterialInstMapping();
@@ -361,6 +440,509 @@ void TerrainFile::_load( FileStream &stream )
    _resolveMaterials( materials );
 }
 
+void TerrainFile::setTileSize( U32 tileSize )
+{
+   if ( tileSize == 0 )
+      mTileSize = 0;
+   else
+      mTileSize = getMax( getNextPow2( tileSize ), (U32)64 );
+}
+
+U32 TerrainFile::_getTileFileSize() const
+{
+   return ( mTileSize + 1 ) * ( mTileSize + 1 ) * sizeof( U16 ) + 
+            mTileSize * mTileSize * sizeof( U8 );
+}
+
+U32 TerrainFile::getTileMemSize() const
+{
+   const U32 gridSize = mTileGridOffsets.empty() ? 0 : mTileGridOffsets.last() * sizeof( TerrainSquare );
+   return _getTileFileSize() + gridSize + sizeof( TileData );
+}
+
+RectI TerrainFile::getTileRect( U32 index ) const
+{
+   const S32 x = ( index % mTilesPerSide ) << mTileShift;
+   const S32 y = ( index / mTilesPerSide ) << mTileShift;
+   return RectI( x, y, mTileSize, mTileSize );
+}
+
+bool TerrainFile::_saveTiled( FileStream &stream )
+{
+   PROFILE_SCOPE( TerrainFile_SaveTiled );
+
+   // The upper grid levels are saved so 
+   // make sure they are current.
+   _buildGridMap();
+
+   const U32 tileSize = getMin( mTileSize, mSize );
+   const U32 tileShift = getBinLog2( tileSize );
+   const U32 tilesPerSide = mSize / tileSize;
+   const U32 coarseShift = getMin( sCoarseShift, tileShift );
+   const U32 coarseSize = mSize >> coarseShift;
+
+   stream.write( (U8)TILED_FILE_VERSION );
+   stream.write( mSize );
+   stream.write( tileSize );
+   stream.write( coarseShift );
+
+   // Write out the material names.
+   stream.write( (U32)mMaterials.size() );
+   for ( U32 i=0; i < mMaterials.size(); i++ )
+      stream.write( String( mMaterials[i]->getInternalName() ) );
+
+   // The coarse samples are always loaded and
+   // stand in for the tiles which are not.
+   for ( U32 y=0; y < coarseSize; y++ )
+      for ( U32 x=0; x < coarseSize; x++ )
+         stream.write( getHeight( x << coarseShift, y << coarseShift ) );
+   for ( U32 y=0; y < coarseSize; y++ )
+      for ( U32 x=0; x < coarseSize; x++ )
+         stream.write( getLayerIndex( x << coarseShift, y << coarseShift ) );
+
+   // The grid levels above the tiles.
+   for ( S32 i = mGridLevels; i >= (S32)tileShift; i-- )
+   {
+      const U32 squareCount = 1 << ( 2 * ( mGridLevels - i ) );
+      const TerrainSquare *sq = mGridMap[i];
+      for ( U32 j=0; j < squareCount; j++, sq++ )
+      {
+         stream.write( sq->minHeight );
+         stream.write( sq->maxHeight );
+         stream.write( sq->heightDeviance );
+         stream.write( sq->flags );
+      }
+   }
+
+   // The materials used in each tile so that the cells
+   // know their materials without loading the tiles.
+   for ( U32 ty=0; ty < tilesPerSide; ty++ )
+   {
+      for ( U32 tx=0; tx < tilesPerSide; tx++ )
+      {
+         U64 materials = 0;
+         for ( U32 y=0; y < tileSize; y++ )
+         {
+            const U8 *layers = mLayerMap.address() + ( tx * tileSize ) + ( ty * tileSize + y ) * mSize;
+            for ( U32 x=0; x < tileSize; x++ )
+            {
+               if ( layers[x] < 64 )
+                  materials |= U64( 1 ) << layers[x];
+            }
+         }
+
+         stream.write( materials );
+      }
+   }
+
+   // And finally the tiles with a border of samples
+   // from the next tiles along the far edges.
+   for ( U32 ty=0; ty < tilesPerSide; ty++ )
+   {
+      for ( U32 tx=0; tx < tilesPerSide; tx++ )
+      {
+         const U32 x0 = tx * tileSize;
+         const U32 y0 = ty * tileSize;
+
+         for ( U32 y=0; y <= tileSize; y++ )
+            for ( U32 x=0; x <= tileSize; x++ )
+               stream.write( getHeight( x0 + x, y0 + y ) );
+
+         for ( U32 y=0; y < tileSize; y++ )
+            for ( U32 x=0; x < tileSize; x++ )
+               stream.write( getLayerIndex( x0 + x, y0 + y ) );
+      }
+   }
+
+   return stream.getStatus() == FileStream::Ok;
+}
+
+void TerrainFile::_loadTiled( FileStream &stream )
+{
+   PROFILE_SCOPE( TerrainFile_LoadTiled );
+
+   U32 tileSize, coarseShift;
+   stream.read( &mSize );
+   stream.read( &tileSize );
+   stream.read( &coarseShift );
+
+   // Get the material name count.
+   U32 materialCount;
+   stream.read( &materialCount );
+   Vector<String> materials;
+   materials.setSize( materialCount );
+
+   // Load the material names.
+   for ( U32 i=0; i < materialCount; i++ )
+      stream.read( &materials[i] );
+
+   // Resolve the TerrainMaterial objects from the names.
+   _resolveMaterials( materials );
+
+   // Remember the tile size so that we save
+   // the same format we loaded.
+   mTileSize = tileSize;
+   mTileShift = getBinLog2( mTileSize );
+   mTilesPerSide = mSize / mTileSize;
+   mGridLevels = getBinLog2( mSize );
+
+   const U32 tileCount = mTilesPerSide * mTilesPerSide;
+   const U32 coarseSize = mSize >> coarseShift;
+
+   // Figure out where everything is in the file.
+   const U32 coarseStart = stream.getPosition();
+   const U32 gridStart = coarseStart + coarseSize * coarseSize * ( sizeof( U16 ) + sizeof( U8 ) );
+   U32 gridSquares = 0;
+   for ( S32 i = mGridLevels; i >= (S32)mTileShift; i-- )
+      gridSquares += 1 << ( 2 * ( mGridLevels - i ) );
+   const U32 materialsStart = gridStart + gridSquares * 4 * sizeof( U16 );
+   mTileDataStart = materialsStart + tileCount * sizeof( U64 );
+
+   if ( !smStreaming || mTilesPerSide < 2 )
+   {
+      // Load all the tiles into the height and layer maps.
+      mHeightMap.setSize( mSize * mSize );
+      mLayerMap.setSize( mSize * mSize );
+
+      TileData data;
+      for ( U32 i=0; i < tileCount; i++ )
+      {
+         const RectI rect = getTileRect( i );
+         if ( !_readTile( stream, i, &data, false ) )
+         {
+            Con::errorf( "TerrainFile::_loadTiled - Failed to read tile %d of '%s'!", i, mFilePath.getFullPath().c_str() );
+            dMemset( data.heights.address(), 0, data.heights.memSize() );
+            dMemset( data.layers.address(), 0, data.layers.memSize() );
+         }
+
+         for ( U32 y=0; y < mTileSize; y++ )
+         {
+            const U32 offset = rect.point.x + ( rect.point.y + y ) * mSize;
+            dMemcpy( mHeightMap.address() + offset, data.heights.address() + y * ( mTileSize + 1 ), mTileSize * sizeof( U16 ) );
+            dMemcpy( mLayerMap.address() + offset, data.layers.address() + y * mTileSize, mTileSize );
+         }
+      }
+
+      return;
+   }
+
+   // Load the coarse samples.
+   mCoarseShift = coarseShift;
+   mCoarseSize = coarseSize;
+   mCoarseHeightMap.setSize( mCoarseSize * mCoarseSize );
+   for ( U32 i=0; i < mCoarseHeightMap.size(); i++ )
+      stream.read( &mCoarseHeightMap[i] );
+   mCoarseLayerMap.setSize( mCoarseSize * mCoarseSize );
+   stream.read( mCoarseLayerMap.size(), mCoarseLayerMap.address() );
+
+   // Load the upper grid levels.  The levels below
+   // the tile size are found in the tile data.
+   mTileLevels = mTileShift;
+   mGridMapPool.setSize( gridSquares );
+   mGridMapPool.compact();
+   mGridMap.setSize( mGridLevels + 1 );
+   mGridMap.compact();
+
+   TerrainSquare *sq = mGridMapPool.address();
+   for ( S32 i = mGridLevels; i >= 0; i-- )
+   {
+      if ( i < (S32)mTileLevels )
+      {
+         mGridMap[i] = NULL;
+         continue;
+      }
+
+      mGridMap[i] = sq;
+      const U32 squareCount = 1 << ( 2 * ( mGridLevels - i ) );
+      for ( U32 j=0; j < squareCount; j++, sq++ )
+      {
+         stream.read( &sq->minHeight );
+         stream.read( &sq->maxHeight );
+         stream.read( &sq->heightDeviance );
+         stream.read( &sq->flags );
+      }
+   }
+
+   mTileGridOffsets.setSize( mTileLevels + 1 );
+   mTileGridOffsets[0] = 0;
+   for ( U32 i=0; i < mTileLevels; i++ )
+      mTileGridOffsets[i+1] = mTileGridOffsets[i] + ( ( mTileSize >> i ) * ( mTileSize >> i ) );
+
+   mTiles.setSize( tileCount );
+   for ( U32 i=0; i < tileCount; i++ )
+   {
+      mTiles[i].data = NULL;
+      mTiles[i].pins = 0;
+      stream.read( &mTiles[i].materials );
+   }
+
+   // The maps are in the tiles now.
+   mHeightMap.clear();
+   mHeightMap.compact();
+   mLayerMap.clear();
+   mLayerMap.compact();
+}
+
+bool TerrainFile::_readTile( FileStream &stream, U32 index, TileData *data, bool buildGrid ) const
+{
+   const U32 heightCount = ( mTileSize + 1 ) * ( mTileSize + 1 );
+   data->heights.setSize( heightCount );
+   data->layers.setSize( mTileSize * mTileSize );
+
+   // The tiles are read in one chunk as we 
+   // load them while the game is running.
+   if (  !stream.setPosition( mTileDataStart + index * _getTileFileSize() ) ||
+         !stream.read( data->heights.memSize(), data->heights.address() ) ||
+         !stream.read( data->layers.memSize(), data->layers.address() ) )
+      return false;
+
+   #ifdef TORQUE_BIG_ENDIAN
+      U16 *heights = data->heights.address();
+      for ( U32 i=0; i < heightCount; i++ )
+         heights[i] = convertLEndianToHost( heights[i] );
+   #endif
+
+   if ( buildGrid )
+      _buildTileGrid( index, data );
+
+   return true;
+}
+
+void TerrainFile::_buildTileGrid( U32 index, TileData *data ) const
+{
+   PROFILE_SCOPE( TerrainFile_BuildTileGrid );
+
+   data->grid.setSize( mTileGridOffsets.last() );
+
+   const S32 tileX = ( index % mTilesPerSide ) << mTileShift;
+   const S32 tileY = ( index / mTilesPerSide ) << mTileShift;
+   const TileGridSampler samples( data, mTileSize );
+
+   // The tile's own square is loaded with the upper levels,
+   // it bounds the tile and is the parent of the top level.
+   TerrainSquare *tileSquare = mGridMap[mTileLevels] + 
+      ( tileX >> mTileLevels ) + ( ( tileY >> mTileLevels ) << ( mGridLevels - mTileLevels ) );
+
+   for ( S32 i = mTileLevels - 1; i >= 0; i-- )
+   {
+      const S32 squareCount = mTileSize >> i;
+      const S32 squareSize = 1 << i;
+      TerrainSquare *level = data->grid.address() + mTileGridOffsets[i];
+      TerrainSquare *parentLevel = data->grid.address() + mTileGridOffsets[i+1];
+
+      for ( S32 squareX = 0; squareX < squareCount; squareX++ )
+      {
+         for ( S32 squareY = 0; squareY < squareCount; squareY++ )
+         {
+            TerrainSquare *parent;
+            if ( i + 1 == (S32)mTileLevels )
+               parent = tileSquare;
+            else
+               parent = parentLevel + ( squareX >> 1 ) + ( squareY >> 1 ) * ( squareCount >> 1 );
+
+            // The split direction depends on the position in 
+            // the whole grid level and not just in the tile.
+            calcGridSquare(   samples,
+                              squareX * squareSize, squareY * squareSize,
+                              squareSize, i,
+                              ( tileX >> i ) + squareX, ( tileY >> i ) + squareY,
+                              parent, parent != tileSquare,
+                              level + squareX + squareY * squareCount );
+         }
+      }
+   }
+}
+
+U16 TerrainFile::_getCoarseHeight( U32 x, U32 y ) const
+{
+   const U32 step = 1 << mCoarseShift;
+   const U32 mask = mCoarseSize - 1;
+
+   const U32 x0 = x >> mCoarseShift;
+   const U32 y0 = y >> mCoarseShift;
+   const U32 x1 = ( x0 + 1 ) & mask;
+   const U32 y1 = ( y0 + 1 ) & mask;
+
+   const F32 fx = (F32)( x & ( step - 1 ) ) / (F32)step;
+   const F32 fy = (F32)( y & ( step - 1 ) ) / (F32)step;
+
+   const U16 *map = mCoarseHeightMap.address();
+   const F32 h0 = mLerp( (F32)map[ x0 + y0 * mCoarseSize ], (F32)map[ x1 + y0 * mCoarseSize ], fx );
+   const F32 h1 = mLerp( (F32)map[ x0 + y1 * mCoarseSize ], (F32)map[ x1 + y1 * mCoarseSize ], fx );
+
+   return (U16)mFloor( mLerp( h0, h1, fy ) + 0.5f );
+}
+
+TerrainFile::TileData* TerrainFile::readTile( U32 index ) const
+{
+   PROFILE_SCOPE( TerrainFile_ReadTile );
+
+   // The file was made resident.
+   if ( mTiles.empty() )
+      return NULL;
+
+   AssertFatal( index < mTiles.size(), "TerrainFile::readTile - Bad tile index!" );
+
+   // Each reader opens its own stream so that any 
+   // thread can read tiles.
+   FileStream stream;
+   stream.open( mFilePath.getFullPath(), Torque::FS::File::Read );
+   if ( stream.getStatus() != Stream::Ok )
+      return NULL;
+
+   TileData *data = new TileData;
+   if ( !_readTile( stream, index, data, true ) )
+   {
+      Con::errorf( "TerrainFile::readTile - Failed to read tile %d of '%s'!", index, mFilePath.getFullPath().c_str() );
+      delete data;
+      return NULL;
+   }
+
+   return data;
+}
+
+void TerrainFile::setTileData( U32 index, TileData *data )
+{
+   // The file may have been made resident while
+   // the tile was being read.
+   if ( index >= mTiles.size() || mTiles[index].data )
+   {
+      delete data;
+      return;
+   }
+
+   if ( data )
+   {
+      mTiles[index].data = data;
+      mResidentTiles++;
+   }
+}
+
+void TerrainFile::loadTile( U32 index )
+{
+   if ( index < mTiles.size() && !mTiles[index].data )
+      setTileData( index, readTile( index ) );
+}
+
+void TerrainFile::evictTile( U32 index )
+{
+   if ( index >= mTiles.size() || !mTiles[index].data )
+      return;
+
+   AssertFatal( mTiles[index].pins == 0, "TerrainFile::evictTile - The tile is pinned!" );
+
+   delete mTiles[index].data;
+   mTiles[index].data = NULL;
+   mResidentTiles--;
+}
+
+void TerrainFile::unpinTile( U32 index )
+{
+   if ( index < mTiles.size() && mTiles[index].pins > 0 )
+      mTiles[index].pins--;
+}
+
+bool TerrainFile::beginStreamRead()
+{
+   dFetchAndAdd( mStreamReaders, 1 );
+
+   if ( dAtomicRead( mStreamClosing ) != 0 )
+   {
+      endStreamRead();
+      return false;
+   }
+
+   return true;
+}
+
+void TerrainFile::endStreamRead()
+{
+   U32 readers;
+   do
+      readers = dAtomicRead( mStreamReaders );
+   while ( !dCompareAndSwap( mStreamReaders, readers, readers - 1 ) );
+
+   // The last reader out wakes up makeResident().
+   if ( readers == 1 && dAtomicRead( mStreamClosing ) != 0 )
+      mStreamDrained.release();
+}
+
+void TerrainFile::makeResident()
+{
+   if ( mTiles.empty() )
+      return;
+
+   PROFILE_SCOPE( TerrainFile_MakeResident );
+
+   // Keep new jobs, including the ones already queued,
+   // from reading the file.  This is never cleared as
+   // the file won't stream again.
+   dCompareAndSwap( mStreamClosing, 0, 1 );
+
+   // Let the streamers cancel their work and
+   // release the tiles they pinned.
+   mMakeResidentSignal.trigger();
+
+   // Wait for the reads which are still running.
+   while ( dAtomicRead( mStreamReaders ) != 0 )
+      mStreamDrained.acquire();
+
+   FileStream stream;
+   stream.open( mFilePath.getFullPath(), Torque::FS::File::Read );
+
+   mHeightMap.setSize( mSize * mSize );
+   mLayerMap.setSize( mSize * mSize );
+
+   TileData temp;
+   for ( U32 i=0; i < mTiles.size(); i++ )
+   {
+      const RectI rect = getTileRect( i );
+
+      const TileData *data = mTiles[i].data;
+      if ( !data && stream.getStatus() == Stream::Ok && _readTile( stream, i, &temp, false ) )
+         data = &temp;
+
+      for ( U32 y=0; y < mTileSize; y++ )
+      {
+         const U32 offset = rect.point.x + ( rect.point.y + y ) * mSize;
+         if ( data )
+         {
+            dMemcpy( mHeightMap.address() + offset, data->heights.address() + y * ( mTileSize + 1 ), mTileSize * sizeof( U16 ) );
+            dMemcpy( mLayerMap.address() + offset, data->layers.address() + y * mTileSize, mTileSize );
+            continue;
+         }
+
+         // We couldn't read the tile so the best
+         // we can do is the coarse samples.
+         for ( U32 x=0; x < mTileSize; x++ )
+         {
+            mHeightMap[ offset + x ] = _getTileHeight( rect.point.x + x, rect.point.y + y );
+            mLayerMap[ offset + x ] = _getTileLayerIndex( rect.point.x + x, rect.point.y + y );
+         }
+      }
+   }
+
+   _clearTiles();
+   _buildGridMap();
+}
+
+void TerrainFile::_clearTiles()
+{
+   for ( U32 i=0; i < mTiles.size(); i++ )
+      delete mTiles[i].data;
+
+   mTiles.clear();
+   mTiles.compact();
+   mTileGridOffsets.clear();
+   mTileLevels = 0;
+   mResidentTiles = 0;
+
+   mCoarseHeightMap.clear();
+   mCoarseHeightMap.compact();
+   mCoarseLayerMap.clear();
+   mCoarseLayerMap.compact();
+}
+
 void TerrainFile::_loadLegacy(  FileStream &stream )
 {
    // Some legacy constants.
@@ -574,6 +1156,8 @@ void TerrainFile::_resolveMaterials( const Vector<String> &materials )
 
 void TerrainFile::setSize( U32 newSize, bool clear )
 {
+   makeResident();
+
    // Make sure the resolution is a power of two.
    newSize = getNextPow2( newSize );
 
@@ -608,6 +1192,8 @@ void TerrainFile::setSize( U32 newSize, bool clear )
 
 void TerrainFile::smooth( F32 factor, U32 steps, bool updateCollision )
 {
+   makeResident();
+
    const U32 blockSize = mSize * mSize;
 
    // Grab some temp buffers for our smoothing results.
@@ -673,8 +1259,10 @@ void TerrainFile::smooth( F32 factor, U32 steps, bool updateCollision )
 
 void TerrainFile::setHeightMap( const Vector<U16> &heightmap, bool updateCollision )
 {
+   makeResident();
+
    AssertFatal( mHeightMap.size() == heightmap.size(), "TerrainFile::setHeightMap - Incorrect heightmap size!" );
-   dMemcpy( mHeightMap.address(), heightmap.address(), mHeightMap.size() ); 
+   dMemcpy( mHeightMap.address(), heightmap.address(), mHeightMap.memSize() ); 
 
    if ( updateCollision )
       _buildGridMap();
@@ -689,6 +1277,8 @@ void TerrainFile::import(  const GBitmap &heightMap,
    AssertFatal( heightMap.getWidth() == heightMap.getHeight(), "TerrainFile::import - Height map is not square!" );
    AssertFatal( isPow2( heightMap.getWidth() ), "TerrainFile::import - Height map is not power of two!" );
 
+   makeResident();
+
    const U32 newSize = heightMap.getWidth();
    if ( newSize != mSize )
    {
@@ -826,6 +1416,8 @@ void TerrainFile::updateGrid( const Point2I &minPt, const Point2I &maxPt )
 
    PROFILE_SCOPE( TerrainFile_UpdateGrid );
 
+   makeResident();
+
    for ( S32 y = minPt.y - 1; y < maxPt.y + 1; y++ )
    {
       for ( S32 x = minPt.x - 1; x < maxPt.x + 1; x++ )
@@ -35,6 +35,15 @@
 #ifndef _TERRMATERIAL_H_
 #include "terrain/terrMaterial.h"
 #endif
+#ifndef _MRECT_H_
+#include "math/mRect.h"
+#endif
+#ifndef _TSIGNAL_H_
+#include "core/util/tSignal.h"
+#endif
+#ifndef _PLATFORM_THREAD_SEMAPHORE_H_
+#include "platform/threads/semaphore.h"
+#endif
 
 class TerrainMaterial;
 class FileStream;
@@ -71,6 +80,23 @@ typedef U16 TerrainHeight;
 /// 
 class TerrainFile
 {
+public:
+
+   /// The samples and the lower grid levels of one tile of a
+   /// streamed terrain file.
+   struct TileData
+   {
+      /// The heights with a one sample border along the far
+      /// edges, so ( tileSize + 1 )^2 samples.
+      Vector<U16> heights;
+
+      /// The layer indices, tileSize^2 samples.
+      Vector<U8> layers;
+
+      /// The grid levels below TerrainFile::mTileLevels.
+      Vector<TerrainSquare> grid;
+   };
+
 protected:
 
    friend class TerrainBlock;
@@ -111,9 +137,106 @@ protected:
    /// The full path and name of the TerrainFile
    Torque::Path mFilePath;
 
+   /// One tile of a streamed file.
+   struct Tile
+   {
+      /// The tile samples or NULL if the tile isn't resident.
+      TileData *data;
+
+      /// The layers used in this tile as a bit per layer index.
+      U64 materials;
+
+      /// The number of jobs reading this tile.  Pinned
+      /// tiles cannot be evicted.
+      U32 pins;
+   };
+
+   /// The tile size used when saving or zero to save
+   /// the untiled format.
+   U32 mTileSize;
+
+   /// The log2 of mTileSize.
+   U32 mTileShift;
+
+   /// The tiles per side of the height map.
+   U32 mTilesPerSide;
+
+   /// The grid levels which are stored in the tiles, the
+   /// upper levels are always resident in mGridMap.  This
+   /// is zero if the file isn't streamed.
+   U32 mTileLevels;
+
+   /// The offset of each grid level in TileData::grid.
+   Vector<U32> mTileGridOffsets;
+
+   /// The tiles of a streamed file or empty if the
+   /// height and layer maps are fully loaded.
+   Vector<Tile> mTiles;
+
+   /// The number of tiles with data.
+   U32 mResidentTiles;
+
+   /// The file offset of the first tile.
+   U32 mTileDataStart;
+
+   /// The log2 of the spacing of the coarse samples.
+   U32 mCoarseShift;
+
+   /// The coarse samples per side.
+   U32 mCoarseSize;
+
+   /// The height and layer samples used where
+   /// the tiles aren't resident.
+   Vector<U16> mCoarseHeightMap;
+   Vector<U8> mCoarseLayerMap;
+
+   /// Counts the jobs reading a streamed file.
+   volatile U32 mStreamReaders;
+
+   /// Set once makeResident() starts, after which
+   /// no new stream reads are allowed.
+   volatile U32 mStreamClosing;
+
+   /// Released by the last reader out once the
+   /// stream is closing.
+   Semaphore mStreamDrained;
+
+   /// @see getMakeResidentSignal
+   Signal<void()> mMakeResidentSignal;
+
    /// The internal loading function.
    void _load( FileStream &stream );
 
+   /// Loads the tiled format, keeping only the coarse samples
+   /// and the upper grid levels if the file is to be streamed.
+   void _loadTiled( FileStream &stream );
+
+   /// Saves the tiled format.
+   bool _saveTiled( FileStream &stream );
+
+   /// Reads the samples of a tile and optionally builds its grid.
+   bool _readTile( FileStream &stream, U32 index, TileData *data, bool buildGrid ) const;
+
+   /// Builds the lower grid levels of a tile from its samples.
+   void _buildTileGrid( U32 index, TileData *data ) const;
+
+   /// Returns the size of a tile in the file.
+   U32 _getTileFileSize() const;
+
+   U32 _getTileIndex( U32 x, U32 y ) const;
+
+   U16 _getTileHeight( U32 x, U32 y ) const;
+
+   U8 _getTileLayerIndex( U32 x, U32 y ) const;
+
+   TerrainSquare* _findTileSquare( U32 level, U32 x, U32 y ) const;
+
+   /// Interpolates the coarse samples.
+   U16 _getCoarseHeight( U32 x, U32 y ) const;
+
+   /// Frees the tiles and the coarse samples.
+   void _clearTiles();
+
    /// The legacy file loading code.
    void _loadLegacy( FileStream &stream );
 
@@ -131,9 +254,16 @@ public:
 
    enum Constants
    {
-      FILE_VERSION = 7
+      FILE_VERSION = 7,
+
+      /// The version of the tiled format.
+      TILED_FILE_VERSION = 8,
    };
 
+   /// If true tiled files are streamed instead of
+   /// being fully loaded.
+   static bool smStreaming;
+
    TerrainFile();
 
    virtual ~TerrainFile();
@@ -148,6 +278,79 @@ public:
 
    bool save( const char *filename );
 
+   /// Sets the tile size used by save(), zero saves the untiled
+   /// format.  The size is rounded to a power of two of at least
+   /// 64 samples.
+   void setTileSize( U32 tileSize );
+
+   U32 getTileSize() const { return mTileSize; }
+
+   /// Tiled file streaming.
+   /// @{
+
+   /// Returns true if the tiles of this file are loaded on demand.
+   bool isStreaming() const { return !mTiles.empty(); }
+
+   /// Loads all the tiles and stops streaming.  Anything that
+   /// edits or needs the whole height map calls this first.
+   void makeResident();
+
+   /// Triggered by makeResident() before the tiles are freed
+   /// so that anything streaming them can stop its work.
+   Signal<void()>& getMakeResidentSignal() { return mMakeResidentSignal; }
+
+   U32 getTilesPerSide() const { return mTilesPerSide; }
+
+   U32 getTileCount() const { return mTiles.size(); }
+
+   /// Returns the spacing of the coarse samples which
+   /// are used where the tiles aren't loaded.
+   U32 getCoarseStep() const { return 1 << mCoarseShift; }
+
+   /// Returns the tile index for a sample.
+   U32 getTileIndex( U32 x, U32 y ) const { return _getTileIndex( x % mSize, y % mSize ); }
+
+   /// Returns the sample rect covered by a tile.
+   RectI getTileRect( U32 index ) const;
+
+   bool isTileResident( U32 index ) const { return mTiles[index].data != NULL; }
+
+   /// Returns the layers used in the tile as a bit per layer index.
+   U64 getTileMaterials( U32 index ) const { return mTiles[index].materials; }
+
+   /// Returns the memory used by a resident tile.
+   U32 getTileMemSize() const;
+
+   U32 getResidentTileCount() const { return mResidentTiles; }
+
+   /// Reads a tile from the file.  This can be called from any
+   /// thread between beginStreamRead() and endStreamRead().
+   TileData* readTile( U32 index ) const;
+
+   /// Hands the tile data read by readTile() to the file which
+   /// takes ownership of it.  Main thread only.
+   void setTileData( U32 index, TileData *data );
+
+   /// Reads and sets the tile data on this thread.
+   void loadTile( U32 index );
+
+   /// Frees the tile data of an unpinned tile.
+   void evictTile( U32 index );
+
+   /// Keeps a tile from being evicted.
+   void pinTile( U32 index ) { mTiles[index].pins++; }
+   void unpinTile( U32 index );
+
+   bool isTilePinned( U32 index ) const { return mTiles[index].pins != 0; }
+
+   /// Jobs reading the file on other threads wrap their
+   /// work in these.  Returns false if the job should be
+   /// skipped as the file is being or was made resident.
+   bool beginStreamRead();
+   void endStreamRead();
+
+   /// @}
+
    ///
    void import(   const GBitmap &heightMap, 
                   F32 heightScale,
@@ -183,8 +386,16 @@ public:
 
    U16 getMaxHeight() const { return mGridMap[mGridLevels]->maxHeight; }
 
+   /// Returns the samples per side of the height map.
+   U32 getSize() const { return mSize; }
+
    /// Returns the constant heightmap vector.
-   const Vector<U16>& getHeightMap() const { return mHeightMap; }
+   /// @note A streamed file must be made resident first.
+   const Vector<U16>& getHeightMap() const 
+   { 
+      AssertFatal( mTiles.empty(), "TerrainFile::getHeightMap - The file is being streamed!" );
+      return mHeightMap; 
+   }
 
    /// Sets a new heightmap state.
    void setHeightMap( const Vector<U16> &heightmap, bool updateCollision );
@@ -194,10 +405,53 @@ public:
 };
 
 
+inline U32 TerrainFile::_getTileIndex( U32 x, U32 y ) const
+{
+   return ( x >> mTileShift ) + ( y >> mTileShift ) * mTilesPerSide;
+}
+
+inline U16 TerrainFile::_getTileHeight( U32 x, U32 y ) const
+{
+   const TileData *data = mTiles[ _getTileIndex( x, y ) ].data;
+   if ( !data )
+      return _getCoarseHeight( x, y );
+
+   const U32 mask = mTileSize - 1;
+   return data->heights[ ( x & mask ) + ( y & mask ) * ( mTileSize + 1 ) ];
+}
+
+inline U8 TerrainFile::_getTileLayerIndex( U32 x, U32 y ) const
+{
+   const TileData *data = mTiles[ _getTileIndex( x, y ) ].data;
+   if ( !data )
+      return mCoarseLayerMap[ ( x >> mCoarseShift ) + ( y >> mCoarseShift ) * mCoarseSize ];
+
+   const U32 mask = mTileSize - 1;
+   return data->layers[ ( x & mask ) + ( y & mask ) * mTileSize ];
+}
+
+inline TerrainSquare* TerrainFile::_findTileSquare( U32 level, U32 x, U32 y ) const
+{
+   const Tile &tile = mTiles[ _getTileIndex( x, y ) ];
+
+   // Without the tile all the lower levels use the
+   // tile's square, which bounds all of them.
+   if ( !tile.data )
+      return mGridMap[mTileLevels] + ( x >> mTileLevels ) + ( ( y >> mTileLevels ) << ( mGridLevels - mTileLevels ) );
+
+   const U32 mask = mTileSize - 1;
+   return (TerrainSquare*)tile.data->grid.address() + mTileGridOffsets[level] + 
+      ( ( x & mask ) >> level ) + ( ( ( y & mask ) >> level ) << ( mTileShift - level ) );
+}
+
 inline TerrainSquare* TerrainFile::findSquare( U32 level, U32 x, U32 y ) const
 {
    x %= mSize;
    y %= mSize;
+
+   if ( level < mTileLevels )
+      return _findTileSquare( level, x, y );
+
    x >>= level;
    y >>= level;
 
@@ -206,6 +460,9 @@ inline TerrainSquare* TerrainFile::findSquare( U32 level, U32 x, U32 y ) const
 
 inline void TerrainFile::setHeight( U32 x, U32 y, U16 height )
 {
+   if ( !mTiles.empty() )
+      makeResident();
+
    x %= mSize;
    y %= mSize;
    mHeightMap[ x + ( y * mSize ) ] = height;
@@ -213,6 +470,7 @@ inline void TerrainFile::setHeight( U32 x, U32 y, U16 height )
 
 inline const U16* TerrainFile::getHeightAddress( U32 x, U32 y ) const
 {
+   AssertFatal( mTiles.empty(), "TerrainFile::getHeightAddress - The file is being streamed!" );
    x %= mSize;
    y %= mSize;
    return &mHeightMap[ x + ( y * mSize ) ];
@@ -222,6 +480,10 @@ inline U16 TerrainFile::getHeight( U32 x, U32 y ) const
 {
    x %= mSize;
    y %= mSize;
+
+   if ( !mTiles.empty() )
+      return _getTileHeight( x, y );
+
    return mHeightMap[ x + ( y * mSize ) ];
 }
 
@@ -229,11 +491,18 @@ inline U8 TerrainFile::getLayerIndex( U32 x, U32 y ) const
 {
    x %= mSize;
    y %= mSize;
+
+   if ( !mTiles.empty() )
+      return _getTileLayerIndex( x, y );
+
    return mLayerMap[ x + ( y * mSize ) ];
 }
 
 inline void TerrainFile::setLayerIndex( U32 x, U32 y, U8 index )
 {
+   if ( !mTiles.empty() )
+      makeResident();
+
    x %= mSize;
    y %= mSize;
    mLayerMap[ x + ( y * mSize ) ] = index;
@@ -249,9 +518,7 @@ inline BaseMatInstance* TerrainFile::getMaterialMapping( U32 index ) const
 
 inline StringTableEntry TerrainFile::getMaterialName( U32 x, U32 y) const
 {
-   x %= mSize;
-   y %= mSize;
-   const U8 &index = mLayerMap[ x + ( y * mSize ) ];
+   const U8 index = getLayerIndex( x, y );
 
    if ( index < mMaterials.size() )
       return mMaterials[ index ]->getInternalName();
@@ -0,0 +1,565 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "platform/platform.h"
+#include "terrain/terrData.h"
+
+#include "terrain/terrFile.h"
+#include "collision/collision.h"
+#include "platform/profiler.h"
+
+#if defined(TORQUE_CPU_X64) || defined(__SSE2__) || (defined(TORQUE_CPU_X86) && defined(_MSC_VER))
+#  define TERRAINQUERY_SSE
+#  include <emmintrin.h>
+#endif
+
+bool TerrainBlock::smSIMDQueries = true;
+
+
+namespace {
+
+/// The corner heights and results of four height queries.
+struct HeightPacket
+{
+   F32 fx[4];
+   F32 fy[4];
+   F32 bottomLeft[4];
+   F32 bottomRight[4];
+   F32 topLeft[4];
+   F32 topRight[4];
+
+   /// All bits set for squares split at 45 degrees.
+   U32 split[4];
+
+   F32 height[4];
+   F32 nx[4];
+   F32 ny[4];
+   F32 nz[4];
+};
+
+/// Up to four rays in the normalized block space 
+/// castRayBlock() works in.
+struct RayPacket
+{
+   Point3F start[4];
+   Point3F end[4];
+
+   /// The ray origins and inverse deltas laid out for the
+   /// box tests.  Zero deltas get a huge inverse instead.
+   F32 originX[4];
+   F32 originY[4];
+   F32 originZ[4];
+   F32 invX[4];
+   F32 invY[4];
+   F32 invZ[4];
+
+   /// The closest hit so far, which also 
+   /// limits the boxes we test.
+   F32 bestT[4];
+};
+
+struct RayPacketNode
+{
+   Point2I blockPos;
+   U32 level;
+};
+
+inline F32 _safeInverse( F32 delta )
+{
+   return delta != 0.0f ? 1.0f / delta : ( 1.0f / 1.0e-30f );
+}
+
+/// Interpolates the heights and normals of a packet 
+/// the same way getNormalHeightMaterial() does.
+void _interpolateHeightsC( HeightPacket &p, F32 squareSize )
+{
+   for ( U32 i = 0; i < 4; i++ )
+   {
+      const F32 xp = p.fx[i];
+      const F32 yp = p.fy[i];
+      const F32 zBottomLeft = p.bottomLeft[i];
+      const F32 zBottomRight = p.bottomRight[i];
+      const F32 zTopLeft = p.topLeft[i];
+      const F32 zTopRight = p.topRight[i];
+
+      Point3F normal;
+      if ( p.split[i] )
+      {
+         if (xp>yp)
+         {
+            // bottom half
+            normal.set(zBottomLeft-zBottomRight, zBottomRight-zTopRight, squareSize);
+            p.height[i] = zBottomLeft + xp * (zBottomRight-zBottomLeft) + yp * (zTopRight-zBottomRight);
+         }
+         else
+         {
+            // top half
+            normal.set(zTopLeft-zTopRight, zBottomLeft-zTopLeft, squareSize);
+            p.height[i] = zBottomLeft + xp * (zTopRight-zTopLeft) + yp * (zTopLeft-zBottomLeft);
+         }
+      }
+      else
+      {
+         if (1.0f-xp>yp)
+         {
+            // bottom half
+            normal.set(zBottomLeft-zBottomRight, zBottomLeft-zTopLeft, squareSize);
+            p.height[i] = zBottomRight + (1.0f-xp) * (zBottomLeft-zBottomRight) + yp * (zTopLeft-zBottomLeft);
+         }
+         else
+         {
+            // top half
+            normal.set(zTopLeft-zTopRight, zBottomRight-zTopRight, squareSize);
+            p.height[i] = zBottomRight + (1.0f-xp) * (zTopLeft-zTopRight) + yp * (zTopRight-zBottomRight);
+         }
+      }
+
+      normal.normalize();
+      p.nx[i] = normal.x;
+      p.ny[i] = normal.y;
+      p.nz[i] = normal.z;
+   }
+}
+
+/// Returns the lanes in @a mask whose ray overlaps the box 
+/// before its closest hit so far.
+U32 _hitBoxC( const RayPacket &p, U32 mask, const Point3F &boxMin, const Point3F &boxMax )
+{
+   U32 hitMask = 0;
+   for ( U32 i = 0; i < 4; i++ )
+   {
+      if ( !( mask & ( 1 << i ) ) )
+         continue;
+
+      const F32 x0 = ( boxMin.x - p.originX[i] ) * p.invX[i];
+      const F32 x1 = ( boxMax.x - p.originX[i] ) * p.invX[i];
+      const F32 y0 = ( boxMin.y - p.originY[i] ) * p.invY[i];
+      const F32 y1 = ( boxMax.y - p.originY[i] ) * p.invY[i];
+      const F32 z0 = ( boxMin.z - p.originZ[i] ) * p.invZ[i];
+      const F32 z1 = ( boxMax.z - p.originZ[i] ) * p.invZ[i];
+
+      const F32 tEnter = getMax( getMax( getMin( x0, x1 ), getMin( y0, y1 ) ), getMax( getMin( z0, z1 ), 0.0f ) );
+      const F32 tExit = getMin( getMin( getMax( x0, x1 ), getMax( y0, y1 ) ), getMin( getMax( z0, z1 ), p.bestT[i] ) );
+
+      if ( tEnter <= tExit )
+         hitMask |= 1 << i;
+   }
+
+   return hitMask;
+}
+
+#ifdef TERRAINQUERY_SSE
+
+inline __m128 _select( __m128 mask, __m128 a, __m128 b )
+{
+   return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+void _interpolateHeightsSSE( HeightPacket &p, F32 squareSize )
+{
+   const __m128 fx = _mm_loadu_ps( p.fx );
+   const __m128 fy = _mm_loadu_ps( p.fy );
+   const __m128 bl = _mm_loadu_ps( p.bottomLeft );
+   const __m128 br = _mm_loadu_ps( p.bottomRight );
+   const __m128 tl = _mm_loadu_ps( p.topLeft );
+   const __m128 tr = _mm_loadu_ps( p.topRight );
+   const __m128 split = _mm_castsi128_ps( _mm_loadu_si128( (const __m128i*)p.split ) );
+   const __m128 ifx = _mm_sub_ps( _mm_set1_ps( 1.0f ), fx );
+
+   // Evaluate all four triangles and pick the one 
+   // each position falls in.
+   const __m128 blMinusBr = _mm_sub_ps( bl, br );
+   const __m128 brMinusTr = _mm_sub_ps( br, tr );
+   const __m128 tlMinusTr = _mm_sub_ps( tl, tr );
+   const __m128 blMinusTl = _mm_sub_ps( bl, tl );
+   const __m128 tlMinusBl = _mm_sub_ps( tl, bl );
+   const __m128 trMinusBr = _mm_sub_ps( tr, br );
+
+   // Split at 45 degrees.
+   const __m128 splitBottom = _mm_cmpgt_ps( fx, fy );
+   const __m128 hSplitBottom = _mm_add_ps( _mm_add_ps( bl, _mm_mul_ps( fx, _mm_sub_ps( br, bl ) ) ), _mm_mul_ps( fy, trMinusBr ) );
+   const __m128 hSplitTop = _mm_add_ps( _mm_add_ps( bl, _mm_mul_ps( fx, _mm_sub_ps( tr, tl ) ) ), _mm_mul_ps( fy, tlMinusBl ) );
+   const __m128 hSplit = _select( splitBottom, hSplitBottom, hSplitTop );
+   const __m128 nxSplit = _select( splitBottom, blMinusBr, tlMinusTr );
+   const __m128 nySplit = _select( splitBottom, brMinusTr, blMinusTl );
+
+   // Split at -45 degrees.
+   const __m128 bottom = _mm_cmpgt_ps( ifx, fy );
+   const __m128 hBottom = _mm_add_ps( _mm_add_ps( br, _mm_mul_ps( ifx, blMinusBr ) ), _mm_mul_ps( fy, tlMinusBl ) );
+   const __m128 hTop = _mm_add_ps( _mm_add_ps( br, _mm_mul_ps( ifx, tlMinusTr ) ), _mm_mul_ps( fy, trMinusBr ) );
+   const __m128 h = _select( bottom, hBottom, hTop );
+   const __m128 nx = _select( bottom, blMinusBr, tlMinusTr );
+   const __m128 ny = _select( bottom, blMinusTl, brMinusTr );
+
+   _mm_storeu_ps( p.height, _select( split, hSplit, h ) );
+
+   const __m128 normalX = _select( split, nxSplit, nx );
+   const __m128 normalY = _select( split, nySplit, ny );
+   const __m128 normalZ = _mm_set1_ps( squareSize );
+
+   // The z is never zero so the length isn't either.
+   const __m128 squared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( normalX, normalX ), _mm_mul_ps( normalY, normalY ) ), _mm_mul_ps( normalZ, normalZ ) );
+   const __m128 factor = _mm_div_ps( _mm_set1_ps( 1.0f ), _mm_sqrt_ps( squared ) );
+
+   _mm_storeu_ps( p.nx, _mm_mul_ps( normalX, factor ) );
+   _mm_storeu_ps( p.ny, _mm_mul_ps( normalY, factor ) );
+   _mm_storeu_ps( p.nz, _mm_mul_ps( normalZ, factor ) );
+}
+
+U32 _hitBoxSSE( const RayPacket &p, U32 mask, const Point3F &boxMin, const Point3F &boxMax )
+{
+   const __m128 originX = _mm_loadu_ps( p.originX );
+   const __m128 originY = _mm_loadu_ps( p.originY );
+   const __m128 originZ = _mm_loadu_ps( p.originZ );
+   const __m128 invX = _mm_loadu_ps( p.invX );
+   const __m128 invY = _mm_loadu_ps( p.invY );
+   const __m128 invZ = _mm_loadu_ps( p.invZ );
+
+   const __m128 x0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( boxMin.x ), originX ), invX );
+   const __m128 x1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( boxMax.x ), originX ), invX );
+   const __m128 y0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( boxMin.y ), originY ), invY );
+   const __m128 y1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( boxMax.y ), originY ), invY );
+   const __m128 z0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( boxMin.z ), originZ ), invZ );
+   const __m128 z1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( boxMax.z ), originZ ), invZ );
+
+   const __m128 tEnter = _mm_max_ps( _mm_max_ps( _mm_min_ps( x0, x1 ), _mm_min_ps( y0, y1 ) ), 
+                                     _mm_max_ps( _mm_min_ps( z0, z1 ), _mm_setzero_ps() ) );
+   const __m128 tExit = _mm_min_ps( _mm_min_ps( _mm_max_ps( x0, x1 ), _mm_max_ps( y0, y1 ) ), 
+                                    _mm_min_ps( _mm_max_ps( z0, z1 ), _mm_loadu_ps( p.bestT ) ) );
+
+   return _mm_movemask_ps( _mm_cmple_ps( tEnter, tExit ) ) & mask;
+}
+
+#endif // TERRAINQUERY_SSE
+
+inline bool _useSSE()
+{
+#ifdef TERRAINQUERY_SSE
+   return TerrainBlock::smSIMDQueries && ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE2 );
+#else
+   return false;
+#endif
+}
+
+} // namespace
+
+
+U32 TerrainBlock::getHeights( const Point2F *pos, 
+                              U32 count, 
+                              F32 *outHeights, 
+                              Point3F *outNormals, 
+                              U8 *outLayers, 
+                              bool *outHits ) const
+{
+   PROFILE_SCOPE( TerrainBlock_getHeights );
+
+   const F32 invSquareSize = 1.0f / mSquareSize;
+   const U32 blockMask = mFile->mSize - 1;
+   const bool useSSE = _useSSE();
+
+   HeightPacket packet;
+   U32 hits = 0;
+
+   for ( U32 first = 0; first < count; first += 4 )
+   {
+      const U32 num = getMin( count - first, 4U );
+
+      // Gather the corners of the squares the positions are in.
+      bool valid[4];
+      for ( U32 i = 0; i < 4; i++ )
+      {
+         valid[i] = false;
+         packet.fx[i] = packet.fy[i] = 0.0f;
+         packet.bottomLeft[i] = packet.bottomRight[i] = 0.0f;
+         packet.topLeft[i] = packet.topRight[i] = 0.0f;
+         packet.split[i] = 0;
+
+         if ( i >= num )
+            continue;
+
+         F32 xp = pos[first + i].x * invSquareSize;
+         F32 yp = pos[first + i].y * invSquareSize;
+         S32 x = S32(xp);
+         S32 y = S32(yp);
+         S32 xm = S32(mFloor( xp + 0.5f ));   
+         S32 ym = S32(mFloor( yp + 0.5f ));   
+         xp -= (F32)x;
+         yp -= (F32)y;
+
+         if ( x & ~blockMask || y & ~blockMask )
+            continue;
+
+         const TerrainSquare *sq = mFile->findSquare( 0, x, y );
+         if ( sq->flags & TerrainSquare::Empty )
+            continue;
+
+         valid[i] = true;
+         packet.fx[i] = xp;
+         packet.fy[i] = yp;
+         packet.bottomLeft[i] = fixedToFloat( mFile->getHeight( x, y ) );
+         packet.bottomRight[i] = fixedToFloat( mFile->getHeight( x + 1, y ) );
+         packet.topLeft[i] = fixedToFloat( mFile->getHeight( x, y + 1 ) );
+         packet.topRight[i] = fixedToFloat( mFile->getHeight( x + 1, y + 1 ) );
+         packet.split[i] = ( sq->flags & TerrainSquare::Split45 ) ? U32_MAX : 0;
+
+         if ( outLayers )
+            outLayers[first + i] = mFile->getLayerIndex( xm, ym );
+      }
+
+#ifdef TERRAINQUERY_SSE
+      if ( useSSE )
+         _interpolateHeightsSSE( packet, mSquareSize );
+      else
+#endif
+         _interpolateHeightsC( packet, mSquareSize );
+
+      for ( U32 i = 0; i < num; i++ )
+      {
+         outHits[first + i] = valid[i];
+         if ( !valid[i] )
+            continue;
+
+         hits++;
+         outHeights[first + i] = packet.height[i];
+         if ( outNormals )
+            outNormals[first + i].set( packet.nx[i], packet.ny[i], packet.nz[i] );
+      }
+   }
+
+   return hits;
+}
+
+U32 TerrainBlock::castRays(   const Point3F *starts, 
+                              const Point3F *ends, 
+                              U32 count, 
+                              RayInfo *outInfos, 
+                              bool *outHits )
+{
+   PROFILE_SCOPE( TerrainBlock_castRays );
+
+   const U32 blockSize = mFile->mSize;
+   const U32 gridLevels = mFile->mGridLevels;
+   const F32 invBlockSize = 1.0f / F32( blockSize );
+   const F32 invBlockWorldSize = 1.0f / getWorldBlockSize();
+   const bool useSSE = _useSSE();
+
+   // Vertical rays are just height queries like in castRayI(), 
+   // so we batch those and walk the tree with the rest.
+   static Vector<U32> verticalRays;
+   static Vector<Point2F> verticalPos;
+   static Vector<F32> verticalHeights;
+   static Vector<Point3F> verticalNormals;
+   static Vector<bool> verticalHits;
+   static Vector<U32> packetRays;
+   verticalRays.clear();
+   verticalPos.clear();
+   packetRays.clear();
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      outHits[i] = false;
+
+      const Point3F &start = starts[i];
+      const Point3F &end = ends[i];
+      if ( start.x == end.x && start.y == end.y )
+      {
+         if ( end.z != start.z )
+         {
+            verticalRays.push_back( i );
+            verticalPos.push_back( Point2F( start.x, start.y ) );
+         }
+      }
+      else
+         packetRays.push_back( i );
+   }
+
+   U32 hits = 0;
+
+   if ( !verticalRays.empty() )
+   {
+      verticalHeights.setSize( verticalRays.size() );
+      verticalNormals.setSize( verticalRays.size() );
+      verticalHits.setSize( verticalRays.size() );
+
+      getHeights( verticalPos.address(), verticalRays.size(), verticalHeights.address(), verticalNormals.address(), NULL, verticalHits.address() );
+
+      for ( U32 i = 0; i < verticalRays.size(); i++ )
+      {
+         if ( !verticalHits[i] )
+            continue;
+
+         const U32 ray = verticalRays[i];
+         const Point3F &start = starts[ray];
+         const Point3F &end = ends[ray];
+
+         F32 t = ( verticalHeights[i] - start.z ) / ( end.z - start.z );
+         if ( t < 0 || t > 1 )
+            continue;
+
+         RayInfo *info = outInfos + ray;
+         info->object = this;
+         info->normal = verticalNormals[i];
+         info->t = t;
+         _setRayContact( start, end, info );
+
+         outHits[ray] = true;
+         hits++;
+      }
+   }
+
+   static Vector<RayPacketNode> stack;
+   stack.setSize( gridLevels * 3 + 1 );
+
+   RayPacket packet;
+   RayInfo infos[4];
+   RayInfo squareInfo;
+
+   for ( U32 first = 0; first < packetRays.size(); first += 4 )
+   {
+      const U32 num = getMin( packetRays.size() - first, 4U );
+      const U32 activeMask = ( 1 << num ) - 1;
+
+      for ( U32 i = 0; i < 4; i++ )
+      {
+         const U32 ray = packetRays[ first + getMin( i, num - 1 ) ];
+         packet.start[i].set( starts[ray].x * invBlockWorldSize, starts[ray].y * invBlockWorldSize, starts[ray].z );
+         packet.end[i].set( ends[ray].x * invBlockWorldSize, ends[ray].y * invBlockWorldSize, ends[ray].z );
+
+         packet.originX[i] = packet.start[i].x;
+         packet.originY[i] = packet.start[i].y;
+         packet.originZ[i] = packet.start[i].z;
+         packet.invX[i] = _safeInverse( packet.end[i].x - packet.start[i].x );
+         packet.invY[i] = _safeInverse( packet.end[i].y - packet.start[i].y );
+         packet.invZ[i] = _safeInverse( packet.end[i].z - packet.start[i].z );
+         packet.bestT[i] = 1.0f;
+      }
+
+      // Walk the quadtree with the whole packet, nearest 
+      // children first for the first ray in it.
+      const U32 nearX = packet.invX[0] < 0.0f ? 1 : 0;
+      const U32 nearY = packet.invY[0] < 0.0f ? 1 : 0;
+
+      U32 hitMask = 0;
+      U32 stackSize = 1;
+      stack[0].blockPos.set( 0, 0 );
+      stack[0].level = gridLevels;
+
+      while ( stackSize-- )
+      {
+         const RayPacketNode node = stack[stackSize];
+         const TerrainSquare *sq = mFile->findSquare( node.level, node.blockPos.x, node.blockPos.y );
+
+         if ( sq->flags & TerrainSquare::Empty )
+            continue;
+
+         const U32 width = 1 << node.level;
+         const Point3F boxMin( node.blockPos.x * invBlockSize, node.blockPos.y * invBlockSize, fixedToFloat( sq->minHeight ) );
+         const Point3F boxMax( ( node.blockPos.x + width ) * invBlockSize, ( node.blockPos.y + width ) * invBlockSize, fixedToFloat( sq->maxHeight ) );
+
+         U32 laneMask;
+#ifdef TERRAINQUERY_SSE
+         if ( useSSE )
+            laneMask = _hitBoxSSE( packet, activeMask, boxMin, boxMax );
+         else
+#endif
+            laneMask = _hitBoxC( packet, activeMask, boxMin, boxMax );
+
+         if ( !laneMask )
+            continue;
+
+         if ( node.level == 0 )
+         {
+            for ( U32 i = 0; i < num; i++ )
+            {
+               if ( !( laneMask & ( 1 << i ) ) )
+                  continue;
+
+               // The part of the ray over this square, which
+               // is what castRayBlock() tests the triangles with.
+               const Point3F &pStart = packet.start[i];
+               const Point3F &pEnd = packet.end[i];
+               F32 startT = 0.0f;
+               F32 endT = 1.0f;
+               if ( pEnd.x != pStart.x )
+               {
+                  const F32 invDeltaX = 1 / ( pEnd.x - pStart.x );
+                  const F32 t0 = ( boxMin.x - pStart.x ) * invDeltaX;
+                  const F32 t1 = ( boxMax.x - pStart.x ) * invDeltaX;
+                  startT = getMax( startT, getMin( t0, t1 ) );
+                  endT = getMin( endT, getMax( t0, t1 ) );
+               }
+               if ( pEnd.y != pStart.y )
+               {
+                  const F32 invDeltaY = 1 / ( pEnd.y - pStart.y );
+                  const F32 t0 = ( boxMin.y - pStart.y ) * invDeltaY;
+                  const F32 t1 = ( boxMax.y - pStart.y ) * invDeltaY;
+                  startT = getMax( startT, getMin( t0, t1 ) );
+                  endT = getMin( endT, getMax( t0, t1 ) );
+               }
+
+               if (  _castRaySquare( pStart, pEnd, node.blockPos, sq, startT, endT, &squareInfo ) &&
+                     squareInfo.t < packet.bestT[i] )
+               {
+                  packet.bestT[i] = squareInfo.t;
+                  infos[i] = squareInfo;
+                  hitMask |= 1 << i;
+               }
+            }
+
+            continue;
+         }
+
+         // Push the far child first so the near one pops first.
+         const U32 half = width >> 1;
+         const U32 nextLevel = node.level - 1;
+         for ( U32 j = 0; j < 4; j++ )
+         {
+            const U32 cx = ( j & 1 ) ? nearX : 1 - nearX;
+            const U32 cy = ( j & 2 ) ? nearY : 1 - nearY;
+            stack[stackSize].blockPos.set( node.blockPos.x + cx * half, node.blockPos.y + cy * half );
+            stack[stackSize].level = nextLevel;
+            stackSize++;
+         }
+      }
+
+      for ( U32 i = 0; i < num; i++ )
+      {
+         if ( !( hitMask & ( 1 << i ) ) )
+            continue;
+
+         const U32 ray = packetRays[first + i];
+         RayInfo *info = outInfos + ray;
+         info->object = this;
+         info->t = infos[i].t;
+         info->normal = infos[i].normal;
+         info->normal.z *= blockSize * mSquareSize;
+         info->normal.normalize();
+         _setRayContact( starts[ray], ends[ray], info );
+
+         outHits[ray] = true;
+         hits++;
+      }
+   }
+
+   return hits;
+}
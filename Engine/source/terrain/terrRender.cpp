@@ -27,6 +27,7 @@
 #include "terrain/terrCell.h"
 #include "terrain/terrMaterial.h"
 #include "terrain/terrCellMaterial.h"
+#include "terrain/terrStreaming.h"
 #include "materials/shaderData.h"
 
 #include "platform/profiler.h"
@@ -53,6 +54,8 @@
 #include "gfx/gfxDebugEvent.h"
 #include "gfx/gfxCardProfile.h"
 #include "core/stream/fileStream.h"
+#include "platform/threads/threadPoolTaskSet.h"
+#include "platform/platformIntrinsics.h"
 
 
 bool TerrainBlock::smDebugRender = false;
@@ -104,11 +107,15 @@ void TerrainBlock::_updateMaterials()
       mCell->deleteMaterials();
 }
 
+/// Returns a layer index by its position in the layer map.
+static inline U8 _getLayerIndex( const TerrainFile *file, const U8 *layerMap, U32 i, U32 layerSize )
+{
+   return layerMap ? layerMap[i] : file->getLayerIndex( i % layerSize, i / layerSize );
+}
+
 void TerrainBlock::_updateLayerTexture()
 {
    const U32 layerSize = mFile->mSize;
-   const Vector<U8> &layerMap = mFile->mLayerMap;
-   const U32 pixelCount = layerMap.size();
 
    if (  mLayerTex.isNull() ||
          mLayerTex.getWidth() != layerSize ||
@@ -120,32 +127,59 @@ void TerrainBlock::_updateLayerTexture()
       "TerrainBlock::_updateLayerTexture - The texture size doesn't match the requested size!" );
 
    // Update the layer texture.
-   GFXLockedRect *lock = mLayerTex.lock();
+   _updateLayerTexture( RectI( 0, 0, layerSize, layerSize ) );
+   //mLayerTex->dumpToDisk( "png", "./layerTex.png" );
+}
 
-   for ( U32 i=0; i < pixelCount; i++ )
-   {  
-      lock->bits[0] = layerMap[i];
+void TerrainBlock::_updateLayerTexture( const RectI &inRect )
+{
+   const U32 layerSize = mFile->mSize;
+   const U32 pixelCount = layerSize * layerSize;
 
-      if ( i + 1 >= pixelCount )
-         lock->bits[1] = lock->bits[0];
-      else
-         lock->bits[1] = layerMap[i+1];
+   // Each texel holds the layers of the next samples
+   // too, so the texels before the rect change also.
+   RectI rect( inRect.point.x - 1, inRect.point.y - 1, inRect.extent.x + 1, inRect.extent.y + 1 );
+   rect.intersect( RectI( 0, 0, layerSize, layerSize ) );
+   if ( mLayerTex.isNull() || !rect.isValidRect() )
+      return;
 
-      if ( i + layerSize >= pixelCount )
-         lock->bits[2] = lock->bits[0];
-      else
-         lock->bits[2] = layerMap[i + layerSize];
+   // A streamed file has no layer map, so we go thru
+   // the slower lookup which uses the loaded tiles.
+   const TerrainFile *file = mFile;
+   const U8 *layerMap = file->isStreaming() ? NULL : file->mLayerMap.address();
 
-      if ( i + layerSize + 1 >= pixelCount )
-         lock->bits[3] = lock->bits[0];
-      else
-         lock->bits[3] = layerMap[i + layerSize + 1];
+   GFXLockedRect *lock = mLayerTex.lock( 0, &rect );
+
+   for ( S32 y = rect.point.y; y < rect.point.y + rect.extent.y; y++ )
+   {
+      U8 *bits = lock->bits + ( y - rect.point.y ) * lock->pitch;
+
+      for ( S32 x = rect.point.x; x < rect.point.x + rect.extent.x; x++ )
+      {
+         const U32 i = x + y * layerSize;
+
+         bits[0] = _getLayerIndex( file, layerMap, i, layerSize );
+
+         if ( i + 1 >= pixelCount )
+            bits[1] = bits[0];
+         else
+            bits[1] = _getLayerIndex( file, layerMap, i + 1, layerSize );
+
+         if ( i + layerSize >= pixelCount )
+            bits[2] = bits[0];
+         else
+            bits[2] = _getLayerIndex( file, layerMap, i + layerSize, layerSize );
+
+         if ( i + layerSize + 1 >= pixelCount )
+            bits[3] = bits[0];
+         else
+            bits[3] = _getLayerIndex( file, layerMap, i + layerSize + 1, layerSize );
 
-      lock->bits += 4;
+         bits += 4;
+      }
    }
 
    mLayerTex.unlock();
-   //mLayerTex->dumpToDisk( "png", "./layerTex.png" );
 }
 
 bool TerrainBlock::_initBaseShader()
@@ -176,14 +210,175 @@ bool TerrainBlock::_initBaseShader()
    desc.colorWriteAlpha = false;
    mBaseShaderSB = GFX->createStateBlock( desc );
 
+   // Used for the first layer when only part of the
+   // base texture is blended and it can't be cleared.
+   desc.setBlend( true, GFXBlendSrcAlpha, GFXBlendZero );
+   mBaseShaderReplaceSB = GFX->createStateBlock( desc );
+
    return true;
 }
 
+/// Compresses a base texture read back from the GPU and writes
+/// it to the cache file on a worker thread.
+struct TerrainBaseTexCacheItem : public ThreadPoolTaskSet
+{
+   typedef ThreadPoolTaskSet Parent;
+
+   GBitmap *mBitmap;
+
+   /// A copy of the path the worker owns outright.
+   char *mPath;
+
+   TerrainBlock::BaseTexFormat mFormat;
+
+   TerrainBaseTexCacheItem( GBitmap *bitmap, const char *path, TerrainBlock::BaseTexFormat format )
+      :  Parent( 1 ),
+         mBitmap( bitmap ),
+         mPath( dStrdup( path ) ),
+         mFormat( format )
+   {
+   }
+
+   ~TerrainBaseTexCacheItem()
+   {
+      delete mBitmap;
+      dFree( mPath );
+   }
+
+protected:
+   virtual void runTask( U32 )
+   {
+      FileStream fs;
+      if ( fs.open( mPath, Torque::FS::File::Write ) )
+      {
+         if ( mFormat == TerrainBlock::DDS )
+         {
+            // DXT compress it and write it to disk.
+            mBitmap->extrudeMipLevels();
+
+            DDSFile *blendDDS = DDSFile::createDDSFileFromGBitmap( mBitmap );
+            // Only the main thread may queue work on the pool.
+            DDSUtil::squishDDS( blendDDS, GFXFormatDXT1, false );
+
+            // Write result to file stream
+            blendDDS->write( fs );
+
+            delete blendDDS;
+         }
+         else
+            mBitmap->writeBitmap( TerrainBlock::formatToExtension( mFormat ), fs );
+      }
+      fs.close();
+   }
+};
+
+typedef ThreadSafeRef<TerrainBaseTexCacheItem> TerrainBaseTexCacheItemRef;
+
+/// The base texture cache files still being written.
+static Vector<TerrainBaseTexCacheItemRef> smBaseTexCacheWrites;
+
+/// Queues the write of a base texture cache file once any earlier
+/// write of the same file is done.
+static void _queueBaseTexCacheWrite( GBitmap *bitmap, const String &path, TerrainBlock::BaseTexFormat format )
+{
+   for ( S32 i = smBaseTexCacheWrites.size() - 1; i >= 0; i-- )
+   {
+      TerrainBaseTexCacheItemRef &item = smBaseTexCacheWrites[i];
+      // If the earlier write hasn't started yet it is done right here.
+      if ( !item->isDone() && path.equal( item->mPath, String::NoCase ) )
+         item->wait();
+
+      if ( item->isDone() )
+         smBaseTexCacheWrites.erase_fast( i );
+   }
+
+   TerrainBaseTexCacheItemRef item( new TerrainBaseTexCacheItem( bitmap, path.c_str(), format ) );
+   smBaseTexCacheWrites.push_back( item );
+   item->start();
+}
+
+U32 TerrainBlock::_getBaseTexTargetSize() const
+{
+   const U32 maxTextureSize = GFX->getCardProfiler()->queryProfile( "maxTextureSize", 1024 );
+
+   U32 baseTexSize = getNextPow2( mBaseTexSize );
+   return getMin( maxTextureSize, baseTexSize );
+}
+
+bool TerrainBlock::_isBaseTexTarget( U32 baseTexSize ) const
+{
+   return   mBaseTex.isValid() && 
+            mBaseTex->isRenderTarget() &&
+            mBaseTex->getFormat() == GFXFormatR8G8B8A8 &&
+            mBaseTex->getWidth() == baseTexSize &&
+            mBaseTex->getHeight() == baseTexSize;
+}
+
 void TerrainBlock::_updateBaseTexture(bool writeToCache)
 {
    if ( !mBaseShader && !_initBaseShader() )
       return;
 
+   const U32 baseTexSize = _getBaseTexTargetSize();
+   Point2I destSize( baseTexSize, baseTexSize );
+
+   GFXTexHandle blendTex;
+
+   // If the base texture is already a valid render target then 
+   // use it to render to else we create one.
+   if ( _isBaseTexTarget( baseTexSize ) )
+      blendTex = mBaseTex;
+   else
+      blendTex.set( destSize.x, destSize.y, GFXFormatR8G8B8A8, &GFXDefaultRenderTargetProfile, "" );
+
+   _renderBaseTexture( blendTex, NULL );
+
+   // Set the base texture to the render target we updated.  This
+   // should be good for realtime painting cases and is used until
+   // the cached texture is loaded next time.
+   mBaseTex = blendTex;
+
+   /// Do we cache this sucker?
+   if (mBaseTexFormat == NONE || !writeToCache)
+      return;
+
+   PROFILE_SCOPE( TerrainBlock_ReadBackBaseTexture );
+
+   // Read back the render target here... the compression and
+   // writing of the file happens on a worker thread.
+   GBitmap *bitmap;
+   if ( mBaseTexFormat == DDS )
+   {
+      bitmap = new GBitmap( destSize.x, destSize.y, false, GFXFormatR8G8B8A8 );
+      blendTex.copyToBmp( bitmap );
+   }
+   else
+   {
+      bitmap = new GBitmap( blendTex->getWidth(), blendTex->getHeight(), false, GFXFormatR8G8B8 );
+      blendTex->copyToBmp( bitmap );
+   }
+
+   _queueBaseTexCacheWrite( bitmap, _getBaseTexCacheFileName(), mBaseTexFormat );
+}
+
+void TerrainBlock::_updateBaseTexture( const RectI &layerRect )
+{
+   if ( !mBaseShader && !_initBaseShader() )
+      return;
+
+   // We can only blend part of a base texture we rendered
+   // ourselves... else regenerate the whole thing.
+   if ( !_isBaseTexTarget( _getBaseTexTargetSize() ) )
+   {
+      _updateBaseTexture( false );
+      return;
+   }
+
+   _renderBaseTexture( mBaseTex, &layerRect );
+}
+
+void TerrainBlock::_renderBaseTexture( GFXTextureObject *blendTex, const RectI *layerRect )
+{
    // This can sometimes occur outside a begin/end scene.
    const bool sceneBegun = GFX->canCurrentlyRender();
    if ( !sceneBegun )
@@ -195,11 +390,29 @@ void TerrainBlock::_updateBaseTexture(bool writeToCache)
 
    GFXTransformSaver saver;
 
-   const U32 maxTextureSize = GFX->getCardProfiler()->queryProfile( "maxTextureSize", 1024 );
+   Point2I destSize( blendTex->getWidth(), blendTex->getHeight() );
 
-   U32 baseTexSize = getNextPow2( mBaseTexSize );
-   baseTexSize = getMin( maxTextureSize, baseTexSize );
-   Point2I destSize( baseTexSize, baseTexSize );
+   // The texels we blend, which is all of them unless we 
+   // were given the part of the layer texture which changed.
+   RectI destRect( 0, 0, destSize.x, destSize.y );
+   if ( layerRect )
+   {
+      // The blend filters the layer texels around each base
+      // texel, so grow the rect a bit before scaling it.
+      const F32 scale = (F32)destSize.x / (F32)mLayerTex->getWidth();
+      const S32 x0 = (S32)mFloor( ( layerRect->point.x - 2 ) * scale );
+      const S32 y0 = (S32)mFloor( ( layerRect->point.y - 2 ) * scale );
+      const S32 x1 = (S32)mCeil( ( layerRect->point.x + layerRect->extent.x + 2 ) * scale );
+      const S32 y1 = (S32)mCeil( ( layerRect->point.y + layerRect->extent.y + 2 ) * scale );
+
+      destRect.intersect( RectI( x0, y0, x1 - x0, y1 - y0 ) );
+      if ( !destRect.isValidRect() )
+      {
+         if ( !sceneBegun )
+            GFX->endScene();
+         return;
+      }
+   }
 
    // Setup geometry
    GFXVertexBufferHandle<GFXVertexPT> vb;
@@ -207,15 +420,25 @@ void TerrainBlock::_updateBaseTexture(bool writeToCache)
       F32 copyOffsetX = 2.0f * GFX->getFillConventionOffset() / (F32)destSize.x;
       F32 copyOffsetY = 2.0f * GFX->getFillConventionOffset() / (F32)destSize.y;
 
+      const F32 u0 = (F32)destRect.point.x / (F32)destSize.x;
+      const F32 v0 = (F32)destRect.point.y / (F32)destSize.y;
+      const F32 u1 = (F32)( destRect.point.x + destRect.extent.x ) / (F32)destSize.x;
+      const F32 v1 = (F32)( destRect.point.y + destRect.extent.y ) / (F32)destSize.y;
+
+      const F32 left    = -1.0f + 2.0f * u0 - copyOffsetX;
+      const F32 right   = -1.0f + 2.0f * u1 - copyOffsetX;
+      const F32 top     =  1.0f - 2.0f * v0 + copyOffsetY;
+      const F32 bottom  =  1.0f - 2.0f * v1 + copyOffsetY;
+
       GFXVertexPT points[4];
-      points[0].point      = Point3F( -1.0 - copyOffsetX, -1.0 + copyOffsetY, 0.0 );
-      points[0].texCoord   = Point2F(  0.0, 1.0f );
-      points[1].point      = Point3F( -1.0 - copyOffsetX,  1.0 + copyOffsetY, 0.0 );
-      points[1].texCoord   = Point2F(  0.0, 0.0f );
-      points[2].point      = Point3F(  1.0 - copyOffsetX,  1.0 + copyOffsetY, 0.0 );
-      points[2].texCoord   = Point2F(  1.0, 0.0f );
-      points[3].point      = Point3F(  1.0 - copyOffsetX, -1.0 + copyOffsetY, 0.0 );
-      points[3].texCoord   = Point2F(  1.0, 1.0f );
+      points[0].point      = Point3F( left, bottom, 0.0 );
+      points[0].texCoord   = Point2F( u0, v1 );
+      points[1].point      = Point3F( left, top, 0.0 );
+      points[1].texCoord   = Point2F( u0, v0 );
+      points[2].point      = Point3F( right, top, 0.0 );
+      points[2].texCoord   = Point2F( u1, v0 );
+      points[3].point      = Point3F( right, bottom, 0.0 );
+      points[3].texCoord   = Point2F( u1, v1 );
 
       vb.set( GFX, 4, GFXBufferTypeVolatile );
       GFXVertexPT *ptr = vb.lock();
@@ -226,31 +449,22 @@ void TerrainBlock::_updateBaseTexture(bool writeToCache)
       }
    }
 
-   GFXTexHandle blendTex;
-
-   // If the base texture is already a valid render target then 
-   // use it to render to else we create one.
-   if (  mBaseTex.isValid() && 
-         mBaseTex->isRenderTarget() &&
-         mBaseTex->getFormat() == GFXFormatR8G8B8A8 &&
-         mBaseTex->getWidth() == destSize.x &&
-         mBaseTex->getHeight() == destSize.y )
-      blendTex = mBaseTex;
-   else
-      blendTex.set( destSize.x, destSize.y, GFXFormatR8G8B8A8, &GFXDefaultRenderTargetProfile, "" );
-
    GFX->pushActiveRenderTarget();   
 
    // Set our shader stuff
    GFX->setShader( mBaseShader );
    GFX->setShaderConstBuffer( mBaseShaderConsts );
-   GFX->setStateBlock( mBaseShaderSB );
    GFX->setVertexBuffer( vb );
 
    mBaseTarget->attachTexture( GFXTextureTarget::Color0, blendTex );
    GFX->setActiveRenderTarget( mBaseTarget );
 
-   GFX->clear( GFXClearTarget, ColorI(0,0,0,255), 1.0f, 0 );
+   // A clear hits the whole target, so when we blend part of it
+   // the first layer replaces the old texels instead... which 
+   // is the same as adding it to black.
+   bool replace = layerRect != NULL;
+   if ( !replace )
+      GFX->clear( GFXClearTarget, ColorI(0,0,0,255), 1.0f, 0 );
 
    GFX->setTexture( 0, mLayerTex );
    mBaseShaderConsts->setSafe( mBaseLayerSizeConst, (F32)mLayerTex->getWidth() );      
@@ -261,6 +475,9 @@ void TerrainBlock::_updateBaseTexture(bool writeToCache)
       if ( !tex )
          continue;
 
+      GFX->setStateBlock( replace ? mBaseShaderReplaceSB : mBaseShaderSB );
+      replace = false;
+
       GFX->setTexture( 1, tex );
 
       F32 baseSize = mFile->mMaterials[i]->getDiffuseSize();
@@ -289,63 +506,6 @@ void TerrainBlock::_updateBaseTexture(bool writeToCache)
    // End it if we begun it... Yeehaw!
    if ( !sceneBegun )
       GFX->endScene();
-
-   /// Do we cache this sucker?
-   if (mBaseTexFormat == NONE || !writeToCache)
-   {
-      // We didn't cache the result, so set the base texture
-      // to the render target we updated.  This should be good
-      // for realtime painting cases.
-      mBaseTex = blendTex;
-   }
-   else if (mBaseTexFormat == DDS)
-   {
-      String cachePath = _getBaseTexCacheFileName();
-
-      FileStream fs;
-      if ( fs.open( _getBaseTexCacheFileName(), Torque::FS::File::Write ) )
-      {
-         // Read back the render target, dxt compress it, and write it to disk.
-         GBitmap blendBmp( destSize.x, destSize.y, false, GFXFormatR8G8B8A8 );
-         blendTex.copyToBmp( &blendBmp );
-
-         /*
-         // Test code for dumping uncompressed bitmap to disk.
-         {
-         FileStream fs;
-         if ( fs.open( "./basetex.png", Torque::FS::File::Write ) )
-         {
-         blendBmp.writeBitmap( "png", fs );
-         fs.close();
-         }         
-         }
-         */
-
-         blendBmp.extrudeMipLevels();
-
-         DDSFile *blendDDS = DDSFile::createDDSFileFromGBitmap( &blendBmp );
-         DDSUtil::squishDDS( blendDDS, GFXFormatDXT1 );
-
-         // Write result to file stream
-         blendDDS->write( fs );
-         
-         delete blendDDS;
-      }
-      fs.close();
-   }
-   else
-   {
-      FileStream stream;
-      if (!stream.open(_getBaseTexCacheFileName(), Torque::FS::File::Write))
-      {
-         mBaseTex = blendTex;
-         return;
-      }
-
-      GBitmap bitmap(blendTex->getWidth(), blendTex->getHeight(), false, GFXFormatR8G8B8);
-      blendTex->copyToBmp(&bitmap);
-      bitmap.writeBitmap(formatToExtension(mBaseTexFormat), stream);
-   }
 }
 
 void TerrainBlock::_renderBlock( SceneRenderState *state )
@@ -367,6 +527,11 @@ void TerrainBlock::_renderBlock( SceneRenderState *state )
    Point3F objCamPos = state->getDiffuseCameraPosition();
    objectXfm.mulP( objCamPos );
 
+   // Take the streamed tiles and cells once a frame
+   // before the cells are culled.
+   if ( mStreamer && state->isDiffusePass() )
+      mStreamer->update( objCamPos );
+
    // Get the shadow material.
    if ( !mDefaultMatInst )
       mDefaultMatInst = TerrainCellMaterial::getShadowMat();
@@ -386,17 +551,21 @@ void TerrainBlock::_renderBlock( SceneRenderState *state )
    }
 
    // If the layer texture has been cleared or is 
-   // dirty then update it.
+   // dirty then update it... or just the painted part.
    if ( mLayerTex.isNull() || mLayerTexDirty )
       _updateLayerTexture();
+   else if ( mLayerTexDirtyRect.isValidRect() )
+      _updateLayerTexture( mLayerTexDirtyRect );
 
    // If the layer texture is dirty or we lost the base
    // texture then regenerate it.
    if ( mLayerTexDirty || mBaseTex.isNull() )
-   {
       _updateBaseTexture( false );
-      mLayerTexDirty = false;
-   }   
+   else if ( mLayerTexDirtyRect.isValidRect() )
+      _updateBaseTexture( mLayerTexDirtyRect );
+
+   mLayerTexDirty = false;
+   mLayerTexDirtyRect.set( 0, 0, 0, 0 );
 
    static Vector<TerrCell*> renderCells;
    renderCells.clear();
@@ -0,0 +1,495 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "platform/platform.h"
+#include "terrain/terrStreaming.h"
+
+#include "terrain/terrData.h"
+#include "terrain/terrCell.h"
+#include "terrain/terrFile.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/profiler.h"
+#include "core/util/tVector.h"
+
+
+namespace {
+
+struct TileRequest
+{
+   U32 index;
+   F32 distance;
+};
+
+S32 QSORT_CALLBACK _tileRequestCompare( const void *a, const void *b )
+{
+   const F32 diff = ((const TileRequest*)a)->distance - ((const TileRequest*)b)->distance;
+   return diff < 0.0f ? -1 : ( diff > 0.0f ? 1 : 0 );
+}
+
+} // namespace
+
+F32 TerrainStreamer::smTileBudget = 64.0f;
+F32 TerrainStreamer::smCellBudget = 128.0f;
+F32 TerrainStreamer::smTileRadius = 512.0f;
+S32 TerrainStreamer::smMaxJobs = 4;
+
+
+//-----------------------------------------------------------------------------
+// TerrainStreamer::TileLoadItem
+//-----------------------------------------------------------------------------
+
+/// Reads one tile of the file and builds its grid squares.
+struct TerrainStreamer::TileLoadItem : public ThreadPoolTaskSet
+{
+   typedef ThreadPoolTaskSet Parent;
+
+   TerrainFile *mFile;
+
+   U32 mIndex;
+
+   /// The tile read or NULL if it failed.
+   TerrainFile::TileData *mData;
+
+   TileLoadItem( TerrainFile *file, U32 index )
+      :  Parent( 1 ),
+         mFile( file ),
+         mIndex( index ),
+         mData( NULL )
+   {
+   }
+
+   ~TileLoadItem()
+   {
+      // Only still set if the file didn't take it.
+      delete mData;
+   }
+
+protected:
+   virtual void runTask( U32 )
+   {
+      if ( mFile->beginStreamRead() )
+      {
+         mData = mFile->readTile( mIndex );
+         mFile->endStreamRead();
+      }
+   }
+};
+
+
+//-----------------------------------------------------------------------------
+// TerrainStreamer::CellBuildItem
+//-----------------------------------------------------------------------------
+
+/// Fills the vertices of one cell.  The tiles it reads
+/// are pinned by the main thread until it is collected.
+struct TerrainStreamer::CellBuildItem : public ThreadPoolTaskSet
+{
+   typedef ThreadPoolTaskSet Parent;
+
+   TerrainFile *mFile;
+
+   TerrCell *mCell;
+
+   /// The pinned tiles.
+   Vector<U32> mTiles;
+
+   /// The vertices if mBuilt is set.
+   Vector<TerrVertex> mVerts;
+   bool mHasEmpty;
+   Vector<U32> mEmptyList;
+   bool mBuilt;
+
+   CellBuildItem( TerrainFile *file, TerrCell *cell )
+      :  Parent( 1 ),
+         mFile( file ),
+         mCell( cell ),
+         mHasEmpty( false ),
+         mBuilt( false )
+   {
+   }
+
+protected:
+   virtual void runTask( U32 )
+   {
+      if ( mFile->beginStreamRead() )
+      {
+         mVerts.setSize( TerrCell::smVBSize );
+         mCell->_fillVertices( mFile, mVerts.address(), &mHasEmpty, &mEmptyList );
+         mBuilt = true;
+         mFile->endStreamRead();
+      }
+   }
+};
+
+
+//-----------------------------------------------------------------------------
+// TerrainStreamer
+//-----------------------------------------------------------------------------
+
+TerrainStreamer::TerrainStreamer( TerrainBlock *terrain )
+   :  mTerrain( terrain ),
+      mFile( terrain->getFile() ),
+      mFrame( 0 )
+{
+   mFile->getMakeResidentSignal().notify( this, &TerrainStreamer::_onMakeResident );
+}
+
+TerrainStreamer::~TerrainStreamer()
+{
+   mFile->getMakeResidentSignal().remove( this, &TerrainStreamer::_onMakeResident );
+   reset();
+}
+
+void TerrainStreamer::_onMakeResident()
+{
+   // Rebuild the cells from the full height map.
+   for ( U32 i=0; i < mStreamedCells.size(); i++ )
+      mStreamedCells[i]->releaseVertexBuffer();
+
+   reset();
+}
+
+void TerrainStreamer::reset()
+{
+   TerrainFile *file = mTerrain->getFile();
+
+   for ( U32 i=0; i < mTileLoads.size(); i++ )
+      mTileLoads[i]->cancel();
+   for ( U32 i=0; i < mCellBuilds.size(); i++ )
+      mCellBuilds[i]->cancel();
+
+   // The tile loads read the tiles and the cell builds 
+   // point at the cells, so wait for the running ones.
+   for ( U32 i=0; i < mTileLoads.size(); i++ )
+      mTileLoads[i]->wait();
+
+   for ( U32 i=0; i < mCellBuilds.size(); i++ )
+   {
+      CellBuildItemRef item = mCellBuilds[i];
+      item->wait();
+
+      for ( U32 j=0; j < item->mTiles.size(); j++ )
+         file->unpinTile( item->mTiles[j] );
+   }
+
+   mTileLoads.clear();
+   mCellBuilds.clear();
+   mCellRequests.clear();
+   mStreamedCells.clear();
+}
+
+void TerrainStreamer::requestCell( TerrCell *cell, F32 distance )
+{
+   // Each render pass asks again, keep the closest.
+   for ( U32 i=0; i < mCellRequests.size(); i++ )
+   {
+      if ( mCellRequests[i].cell == cell )
+      {
+         mCellRequests[i].distance = getMin( mCellRequests[i].distance, distance );
+         return;
+      }
+   }
+
+   CellRequest request;
+   request.cell = cell;
+   request.distance = distance;
+   mCellRequests.push_back( request );
+}
+
+void TerrainStreamer::update( const Point3F &objCamPos )
+{
+   PROFILE_SCOPE( TerrainStreamer_Update );
+
+   mFrame++;
+
+   TerrainFile *file = mTerrain->getFile();
+   if ( mTileLastUsed.size() != file->getTileCount() )
+   {
+      mTileLastUsed.setSize( file->getTileCount() );
+      for ( U32 i=0; i < mTileLastUsed.size(); i++ )
+         mTileLastUsed[i] = 0;
+   }
+
+   _collectFinished();
+
+   if ( file->isStreaming() )
+      _requestTiles( objCamPos );
+
+   _buildCells();
+   _evict();
+
+   // The next cull asks for what it still needs.
+   mCellRequests.clear();
+}
+
+void TerrainStreamer::_collectFinished()
+{
+   PROFILE_SCOPE( TerrainStreamer_CollectFinished );
+
+   TerrainFile *file = mTerrain->getFile();
+
+   for ( U32 i=0; i < mTileLoads.size(); )
+   {
+      TileLoadItemRef item = mTileLoads[i];
+      if ( !item->isDone() )
+      {
+         i++;
+         continue;
+      }
+      mTileLoads.erase( i );
+
+      if ( !item->mData || !file->isStreaming() )
+         continue;
+
+      // The file takes ownership of the data.
+      file->setTileData( item->mIndex, item->mData );
+      item->mData = NULL;
+
+      // The layer texture was filled from the 
+      // coarse samples, so fix up this tile.
+      mTerrain->_updateLayerTexture( file->getTileRect( item->mIndex ) );
+   }
+
+   for ( U32 i=0; i < mCellBuilds.size(); )
+   {
+      CellBuildItemRef item = mCellBuilds[i];
+      if ( !item->isDone() )
+      {
+         i++;
+         continue;
+      }
+      mCellBuilds.erase( i );
+
+      for ( U32 j=0; j < item->mTiles.size(); j++ )
+         file->unpinTile( item->mTiles[j] );
+
+      if ( !item->mBuilt )
+         continue;
+
+      item->mCell->setVertices( item->mVerts.address(), item->mHasEmpty, item->mEmptyList );
+      mStreamedCells.push_back( item->mCell );
+   }
+}
+
+void TerrainStreamer::_requestTile( U32 index )
+{
+   TerrainFile *file = mTerrain->getFile();
+   if ( file->isTileResident( index ) || mTileLoads.size() >= smMaxJobs )
+      return;
+
+   for ( U32 i=0; i < mTileLoads.size(); i++ )
+      if ( mTileLoads[i]->mIndex == index )
+         return;
+
+   TileLoadItemRef item( new TileLoadItem( file, index ) );
+   mTileLoads.push_back( item );
+   item->start();
+}
+
+void TerrainStreamer::_requestTiles( const Point3F &objCamPos )
+{
+   PROFILE_SCOPE( TerrainStreamer_RequestTiles );
+
+   TerrainFile *file = mTerrain->getFile();
+   const F32 squareSize = mTerrain->getSquareSize();
+   const S32 tileSize = file->getTileSize();
+   const S32 tilesPerSide = file->getTilesPerSide();
+
+   // Find the tiles in the radius around the 
+   // camera and load the closest ones first.
+   const F32 radius = smTileRadius / squareSize;
+   const Point2F camPt( objCamPos.x / squareSize, objCamPos.y / squareSize );
+
+   const S32 x0 = mClamp( (S32)mFloor( ( camPt.x - radius ) / tileSize ), 0, tilesPerSide - 1 );
+   const S32 y0 = mClamp( (S32)mFloor( ( camPt.y - radius ) / tileSize ), 0, tilesPerSide - 1 );
+   const S32 x1 = mClamp( (S32)mFloor( ( camPt.x + radius ) / tileSize ), 0, tilesPerSide - 1 );
+   const S32 y1 = mClamp( (S32)mFloor( ( camPt.y + radius ) / tileSize ), 0, tilesPerSide - 1 );
+
+   Vector<TileRequest> tiles;
+   for ( S32 y = y0; y <= y1; y++ )
+   {
+      for ( S32 x = x0; x <= x1; x++ )
+      {
+         const U32 index = x + y * tilesPerSide;
+         const RectF rect( (F32)( x * tileSize ), (F32)( y * tileSize ), (F32)tileSize, (F32)tileSize );
+
+         const Point2F closest(  mClampF( camPt.x, rect.point.x, rect.point.x + rect.extent.x ),
+                                 mClampF( camPt.y, rect.point.y, rect.point.y + rect.extent.y ) );
+         const F32 dist = ( closest - camPt ).len();
+         if ( dist > radius )
+            continue;
+
+         mTileLastUsed[index] = mFrame;
+         if ( file->isTileResident( index ) )
+            continue;
+
+         TileRequest request;
+         request.index = index;
+         request.distance = dist;
+         tiles.push_back( request );
+      }
+   }
+
+   dQsort( tiles.address(), tiles.size(), sizeof( TileRequest ), _tileRequestCompare );
+
+   for ( U32 i=0; i < tiles.size(); i++ )
+      _requestTile( tiles[i].index );
+}
+
+S32 QSORT_CALLBACK TerrainStreamer::_cellRequestCompare( const void *a, const void *b )
+{
+   const F32 diff = ((const CellRequest*)a)->distance - ((const CellRequest*)b)->distance;
+   return diff < 0.0f ? -1 : ( diff > 0.0f ? 1 : 0 );
+}
+
+bool TerrainStreamer::_isBuilding( const TerrCell *cell ) const
+{
+   for ( U32 i=0; i < mCellBuilds.size(); i++ )
+      if ( mCellBuilds[i]->mCell == cell )
+         return true;
+
+   return false;
+}
+
+void TerrainStreamer::_buildCells()
+{
+   PROFILE_SCOPE( TerrainStreamer_BuildCells );
+
+   TerrainFile *file = mTerrain->getFile();
+   const bool streaming = file->isStreaming();
+
+   dQsort( mCellRequests.address(), mCellRequests.size(), sizeof( CellRequest ), _cellRequestCompare );
+
+   Vector<U32> tiles;
+   U32 syncBuilds = 0;
+
+   for ( U32 i=0; i < mCellRequests.size(); i++ )
+   {
+      TerrCell *cell = mCellRequests[i].cell;
+      if ( cell->hasVertexBuffer() || _isBuilding( cell ) )
+         continue;
+
+      // If the file was made resident, for editing or
+      // physics, then we can just build the cells here.
+      if ( !streaming )
+      {
+         if ( syncBuilds >= smMaxJobs )
+            break;
+
+         cell->_updateVertexBuffer();
+         cell->_updatePrimitiveBuffer();
+         mStreamedCells.push_back( cell );
+         syncBuilds++;
+         continue;
+      }
+
+      if ( mCellBuilds.size() >= smMaxJobs )
+         break;
+
+      // The vertices and normals read a sample past the cell edges.
+      cell->_getTiles( 1, &tiles );
+
+      // Cells finer than the coarse samples wait
+      // until all their tiles are loaded.
+      if ( cell->_needsTiles() )
+      {
+         bool resident = true;
+         for ( U32 j=0; j < tiles.size(); j++ )
+         {
+            mTileLastUsed[ tiles[j] ] = mFrame;
+            if ( !file->isTileResident( tiles[j] ) )
+            {
+               resident = false;
+               _requestTile( tiles[j] );
+            }
+         }
+
+         if ( !resident )
+            continue;
+      }
+
+      // Keep the tiles we read from being evicted.
+      for ( U32 j=0; j < tiles.size(); j++ )
+         file->pinTile( tiles[j] );
+
+      CellBuildItemRef item( new CellBuildItem( file, cell ) );
+      item->mTiles = tiles;
+      mCellBuilds.push_back( item );
+      item->start();
+   }
+}
+
+void TerrainStreamer::_evict()
+{
+   PROFILE_SCOPE( TerrainStreamer_Evict );
+
+   TerrainFile *file = mTerrain->getFile();
+
+   // Evict the least recently used tiles which are not 
+   // pinned or needed this frame.
+   const U32 tileBudget = (U32)( smTileBudget * 1024.0f * 1024.0f );
+   const U32 tileMemSize = file->getTileMemSize();
+   while ( file->isStreaming() && file->getResidentTileCount() * tileMemSize > tileBudget )
+   {
+      S32 oldest = -1;
+      for ( U32 i=0; i < mTileLastUsed.size(); i++ )
+      {
+         if (  !file->isTileResident( i ) || 
+               file->isTilePinned( i ) ||
+               mTileLastUsed[i] >= mFrame )
+            continue;
+
+         if ( oldest == -1 || mTileLastUsed[i] < mTileLastUsed[oldest] )
+            oldest = i;
+      }
+
+      if ( oldest == -1 )
+         break;
+
+      file->evictTile( oldest );
+   }
+
+   // Now the vertex buffers which haven't been used
+   // for a few frames.  The first level is always kept.
+   const U32 cellBudget = (U32)( smCellBudget * 1024.0f * 1024.0f );
+   const U32 cellMemSize = TerrCell::getVertexBufferSize();
+   while ( mStreamedCells.size() * cellMemSize > cellBudget )
+   {
+      S32 oldest = -1;
+      for ( U32 i=0; i < mStreamedCells.size(); i++ )
+      {
+         const TerrCell *cell = mStreamedCells[i];
+         if ( cell->getLastUsed() + 2 >= mFrame )
+            continue;
+
+         if ( oldest == -1 || cell->getLastUsed() < mStreamedCells[oldest]->getLastUsed() )
+            oldest = i;
+      }
+
+      if ( oldest == -1 )
+         break;
+
+      mStreamedCells[oldest]->releaseVertexBuffer();
+      mStreamedCells.erase_fast( oldest );
+   }
+}
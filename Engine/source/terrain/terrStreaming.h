@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _TERRSTREAMING_H_
+#define _TERRSTREAMING_H_
+
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _THREADPOOLTASKSET_H_
+#include "platform/threads/threadPoolTaskSet.h"
+#endif
+#ifndef __RESOURCE_H__
+#include "core/resource.h"
+#endif
+
+class TerrainBlock;
+class TerrainFile;
+class TerrCell;
+class Point3F;
+
+
+/// Loads the tiles of a streamed TerrainFile and builds the
+/// vertex buffers of the TerrCells in the background as the
+/// camera moves around a TerrainBlock.
+///
+/// The tiles are read and the cell vertices are filled on the
+/// ThreadPool.  Everything they produce is handed over on the
+/// main thread in update(), which also evicts the least recently
+/// used tiles and vertex buffers once over the budgets.
+///
+/// Cells with vertices coarser than the coarse samples of the
+/// file are built right away, finer ones wait for their tiles.
+///
+/// @see TerrainFile::isStreaming
+class TerrainStreamer
+{
+public:
+
+   TerrainStreamer( TerrainBlock *terrain );
+   ~TerrainStreamer();
+
+   /// Hands over the finished work, queues new work and evicts
+   /// whatever is over budget.  Called once per frame before
+   /// the cells are culled.
+   void update( const Point3F &objCamPos );
+
+   /// Asks for the vertex buffer of a cell to be built.
+   void requestCell( TerrCell *cell, F32 distance );
+
+   /// Cancels and waits for all the running work.  This
+   /// must be done before the cells are deleted.
+   void reset();
+
+   /// Returns the frame counter used to track
+   /// the least recently used tiles and cells.
+   U32 getFrame() const { return mFrame; }
+
+   /// The memory budget in megabytes for the tiles.
+   static F32 smTileBudget;
+
+   /// The memory budget in megabytes for the cell vertex buffers.
+   static F32 smCellBudget;
+
+   /// The distance in meters around the camera to load tiles.
+   static F32 smTileRadius;
+
+   /// The most tile loads and cell builds to run at once.
+   static S32 smMaxJobs;
+
+protected:
+
+   struct TileLoadItem;
+   struct CellBuildItem;
+   typedef ThreadSafeRef<TileLoadItem> TileLoadItemRef;
+   typedef ThreadSafeRef<CellBuildItem> CellBuildItemRef;
+
+   struct CellRequest
+   {
+      TerrCell *cell;
+      F32 distance;
+   };
+
+   TerrainBlock *mTerrain;
+
+   /// The file we stream, held so that we can stop
+   /// listening to it even if the terrain changes files.
+   Resource<TerrainFile> mFile;
+
+   U32 mFrame;
+
+   /// The tiles being read.
+   Vector<TileLoadItemRef> mTileLoads;
+
+   /// The cells being built.
+   Vector<CellBuildItemRef> mCellBuilds;
+
+   /// The cells requested since the last update.
+   Vector<CellRequest> mCellRequests;
+
+   /// The frame each tile was last needed.
+   Vector<U32> mTileLastUsed;
+
+   /// The cells which got their vertex buffers from us.
+   Vector<TerrCell*> mStreamedCells;
+
+   /// Stops all the work and drops the cells built
+   /// from the coarse samples before the tiles go away.
+   void _onMakeResident();
+
+   /// Takes the finished tiles and cell vertices.
+   void _collectFinished();
+
+   /// Queues the loads for the tiles around the camera.
+   void _requestTiles( const Point3F &objCamPos );
+
+   /// Queues a tile load if we're not already loading it.
+   void _requestTile( U32 index );
+
+   /// Builds the requested cells closest first.
+   void _buildCells();
+
+   bool _isBuilding( const TerrCell *cell ) const;
+
+   /// Frees tiles and vertex buffers until we're back under budget.
+   void _evict();
+
+   static S32 QSORT_CALLBACK _cellRequestCompare( const void *a, const void *b );
+};
+
+#endif // _TERRSTREAMING_H_
@@ -0,0 +1,194 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "math/mMathFn.h"
+#include "gfx/gfxDevice.h"
+#include "terrain/terrData.h"
+#include "terrain/terrCell.h"
+#include "terrain/terrFile.h"
+#include "terrain/terrMaterial.h"
+
+/// A gently rolling terrain file with one layer.
+class CellTestTerrainFile : public TerrainFile
+{
+public:
+   CellTestTerrainFile( U32 size )
+   {
+      mMaterials.push_back( TerrainMaterial::findOrCreate( NULL ) );
+      setSize( size, true );
+
+      for ( U32 y = 0; y < size; y++ )
+         for ( U32 x = 0; x < size; x++ )
+            setHeight( x, y, floatToFixed( mSin( x * 0.03f ) * mCos( y * 0.02f ) * 20.0f + 50.0f ) );
+
+      _buildGridMap();
+   }
+};
+
+/// Builds the cells of a terrain which isn't added to the scene.
+class CellTestTerrainBlock : public TerrainBlock
+{
+public:
+   ~CellTestTerrainBlock() { SAFE_DELETE( mCell ); }
+
+   TerrCell* buildCells()
+   {
+      _rebuildQuadtree();
+      return mCell;
+   }
+};
+
+/// The cells are built on whatever device is up, which 
+/// is the Null device when the tests run without a window.
+FIXTURE(TerrCellUpdate)
+{
+public:
+   CellTestTerrainBlock *block;
+   TerrCell *root;
+   String path;
+   Vector<TerrCell*> cells;
+
+   void SetUp()
+   {
+      block = NULL;
+      root = NULL;
+      ASSERT_TRUE( GFXDevice::get() != NULL ) << "The terrain cells need a GFX device.";
+
+      CellTestTerrainFile file( 512 );
+      path = "terrCellTest.ter";
+      EXPECT_TRUE( file.save( path ) ) << "Failed to save " << path.c_str();
+
+      block = new CellTestTerrainBlock;
+      ASSERT_TRUE( block->setFile( FileName( path ) ) );
+      root = block->buildCells();
+      ASSERT_TRUE( root != NULL );
+
+      cells.clear();
+      gather( root );
+   }
+
+   void TearDown()
+   {
+      delete block;
+      dFileDelete( path );
+   }
+
+   void gather( TerrCell *cell )
+   {
+      cells.push_back( cell );
+      for ( U32 i = 0; !cell->isLeaf() && i < 4; i++ )
+         gather( cell->getChild( i ) );
+   }
+
+   GFXVertexBuffer* getVertexBuffer( const TerrCell *cell )
+   {
+      GFXPrimitive prim;
+      GFXVertexBufferHandleBase vb;
+      GFXPrimitiveBufferHandle pb;
+      cell->getRenderPrimitive( &prim, &vb, &pb );
+      return vb.getPointer();
+   }
+
+   /// Raises the heights in the rect like a brush
+   /// stroke and updates the grid and the cells.
+   void raise( const RectI &rect, F32 height )
+   {
+      TerrainFile *file = block->getFile();
+      for ( S32 y = rect.point.y; y < rect.point.y + rect.extent.y; y++ )
+         for ( S32 x = rect.point.x; x < rect.point.x + rect.extent.x; x++ )
+            file->setHeight( x, y, floatToFixed( fixedToFloat( file->getHeight( x, y ) ) + height ) );
+
+      const Point2I maxPt( rect.point.x + rect.extent.x, rect.point.y + rect.extent.y );
+      file->updateGrid( rect.point, maxPt );
+      root->updateGrid( rect );
+   }
+};
+
+TEST_FIX(TerrCellUpdate, SmallEditOnlyRewritesNearbyCells)
+{
+   // Remember the buffers and mark them as not locked.
+   Vector<GFXVertexBuffer*> buffers;
+   for ( U32 i = 0; i < cells.size(); i++ )
+   {
+      GFXVertexBuffer *vb = getVertexBuffer( cells[i] );
+      buffers.push_back( vb );
+      if ( vb )
+         vb->lockedVertexStart = vb->lockedVertexEnd = 0;
+   }
+
+   const RectI rect( 200, 200, 4, 4 );
+   raise( rect, 100.0f );
+
+   const U32 numVerts = TerrCell::getVertexBufferSize() / sizeof( TerrVertex );
+   U32 numRewritten = 0;
+   U32 numWithBuffers = 0;
+
+   for ( U32 i = 0; i < cells.size(); i++ )
+   {
+      const TerrCell *cell = cells[i];
+      GFXVertexBuffer *vb = getVertexBuffer( cell );
+      ASSERT_EQ( buffers[i], vb ) << "The cell at level " << cell->getLevel() << " got a new vertex buffer.";
+      if ( !vb )
+         continue;
+
+      numWithBuffers++;
+
+      // The normals read one sample past the rect.
+      const RectI cellRect(   cell->getPoint().x - 2, 
+                              cell->getPoint().y - 2, 
+                              cell->getSize() + 4, 
+                              cell->getSize() + 4 );
+
+      if ( !cellRect.overlaps( rect ) )
+      {
+         EXPECT_EQ( 0, vb->lockedVertexEnd ) << "Cell at " << cell->getPoint().x << ", " << cell->getPoint().y << " was rewritten.";
+         continue;
+      }
+
+      // The leaf under the edit is always rewritten.
+      if ( cell->isLeaf() )
+      {
+         EXPECT_NE( 0, vb->lockedVertexEnd ) << "Cell at " << cell->getPoint().x << ", " << cell->getPoint().y << " wasn't updated.";
+      }
+
+      if ( vb->lockedVertexEnd != 0 )
+      {
+         numRewritten++;
+         EXPECT_LT( vb->lockedVertexEnd - vb->lockedVertexStart, numVerts ) << "The whole buffer was locked.";
+      }
+   }
+
+   EXPECT_GT( numRewritten, 0 );
+   EXPECT_LT( numRewritten * 4, numWithBuffers );
+}
+
+TEST_FIX(TerrCellUpdate, EditUpdatesBoundsUpTheTree)
+{
+   const F32 oldTop = root->getBounds().maxExtents.z;
+
+   // A spike well above the rest of the terrain.
+   const RectI rect( 300, 100, 2, 2 );
+   raise( rect, 500.0f );
+
+   const Point3F spike( 301.0f * block->getSquareSize(), 101.0f * block->getSquareSize(), 0.0f );
+   EXPECT_GT( root->getBounds().maxExtents.z, oldTop + 400.0f );
+
+   // Every cell over the spike grew to contain it and
+   // the ones away from it kept their bounds.
+   for ( U32 i = 0; i < cells.size(); i++ )
+   {
+      const Box3F &bounds = cells[i]->getBounds();
+      const bool over = spike.x >= bounds.minExtents.x && spike.x <= bounds.maxExtents.x &&
+                        spike.y >= bounds.minExtents.y && spike.y <= bounds.maxExtents.y;
+      if ( over )
+      {
+         EXPECT_GT( bounds.maxExtents.z, oldTop + 400.0f ) << "Cell at level " << cells[i]->getLevel() << " missed the edit.";
+      }
+      else if ( cells[i]->isLeaf() )
+      {
+         EXPECT_LE( bounds.maxExtents.z, oldTop ) << "Cell at level " << cells[i]->getLevel() << " grew without being edited.";
+      }
+   }
+}
+
+#endif
@@ -0,0 +1,334 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "math/mMathFn.h"
+#include "terrain/terrFile.h"
+#include "terrain/terrMaterial.h"
+#include "platform/threads/thread.h"
+
+/// A terrain file with some hills, two layers and a few holes.
+class TestTerrainFile : public TerrainFile
+{
+public:
+   TestTerrainFile( U32 size )
+   {
+      mMaterials.push_back( TerrainMaterial::findOrCreate( NULL ) );
+      mMaterials.push_back( TerrainMaterial::findOrCreate( NULL ) );
+      setSize( size, true );
+
+      MRandomLCG rand( 1234 );
+      for ( U32 y = 0; y < size; y++ )
+      {
+         for ( U32 x = 0; x < size; x++ )
+         {
+            const F32 hill = mSin( x * 0.02f ) * mCos( y * 0.03f ) * 100.0f + 200.0f;
+            setHeight( x, y, floatToFixed( hill + rand.randF( 0.0f, 2.0f ) ) );
+
+            U8 layer = ( x + y ) % 97 < 40 ? 0 : 1;
+            if ( x > 100 && x < 110 && y > 300 && y < 320 )
+               layer = U8_MAX;
+            setLayerIndex( x, y, layer );
+         }
+      }
+
+      _buildGridMap();
+   }
+};
+
+FIXTURE(TerrainFile)
+{
+public:
+   bool savedStreaming;
+   Vector<String> files;
+
+   void SetUp()
+   {
+      savedStreaming = TerrainFile::smStreaming;
+   }
+
+   void TearDown()
+   {
+      for ( U32 i = 0; i < files.size(); i++ )
+         dFileDelete( files[i] );
+      files.clear();
+      TerrainFile::smStreaming = savedStreaming;
+   }
+
+   String save( TerrainFile *file, const char *name, U32 tileSize )
+   {
+      String path = String::ToString( "terrFileTest_%s.ter", name );
+      file->setTileSize( tileSize );
+      EXPECT_TRUE( file->save( path ) ) << "Failed to save " << path.c_str();
+      files.push_back( path );
+      return path;
+   }
+
+   TerrainFile* load( const String &path, bool streaming )
+   {
+      TerrainFile::smStreaming = streaming;
+      return TerrainFile::load( path );
+   }
+
+   bool sameSquare( const TerrainSquare *a, const TerrainSquare *b )
+   {
+      return   a->minHeight == b->minHeight &&
+               a->maxHeight == b->maxHeight &&
+               a->heightDeviance == b->heightDeviance &&
+               a->flags == b->flags;
+   }
+
+   /// Compares all the samples and grid squares of two files.
+   void expectSame( const TerrainFile *a, const TerrainFile *b )
+   {
+      ASSERT_EQ( a->getSize(), b->getSize() );
+      const U32 size = a->getSize();
+
+      for ( U32 y = 0; y < size; y++ )
+      {
+         for ( U32 x = 0; x < size; x++ )
+         {
+            ASSERT_EQ( a->getHeight( x, y ), b->getHeight( x, y ) ) << "Height at " << x << ", " << y;
+            ASSERT_EQ( a->getLayerIndex( x, y ), b->getLayerIndex( x, y ) ) << "Layer at " << x << ", " << y;
+         }
+      }
+
+      for ( U32 level = 0; ( size >> level ) > 0; level++ )
+      {
+         for ( U32 y = 0; y < size; y += 1 << level )
+            for ( U32 x = 0; x < size; x += 1 << level )
+               ASSERT_TRUE( sameSquare( a->findSquare( level, x, y ), b->findSquare( level, x, y ) ) )
+                  << "Square at level " << level << " " << x << ", " << y;
+      }
+   }
+};
+
+TEST_FIX(TerrainFile, TiledRoundTrip)
+{
+   TestTerrainFile source( 512 );
+   const String plainPath = save( &source, "plain", 0 );
+   const String tiledPath = save( &source, "tiled", 128 );
+
+   TerrainFile *plain = load( plainPath, false );
+   TerrainFile *tiled = load( tiledPath, false );
+   ASSERT_TRUE( plain && tiled );
+
+   EXPECT_EQ( 128, tiled->getTileSize() );
+   EXPECT_FALSE( tiled->isStreaming() );
+
+   expectSame( &source, plain );
+   expectSame( &source, tiled );
+
+   delete plain;
+   delete tiled;
+}
+
+TEST_FIX(TerrainFile, StreamedTiles)
+{
+   TestTerrainFile source( 512 );
+   const String path = save( &source, "streamed", 64 );
+
+   TerrainFile *file = load( path, true );
+   ASSERT_TRUE( file != NULL );
+   ASSERT_TRUE( file->isStreaming() );
+   EXPECT_EQ( 64, file->getTileCount() );
+   EXPECT_EQ( 0, file->getResidentTileCount() );
+
+   // Without the tiles the heights come from the coarse samples,
+   // which have to stay inside the bounds of the tile square.
+   for ( U32 y = 0; y < 512; y += 5 )
+   {
+      for ( U32 x = 0; x < 512; x += 7 )
+      {
+         const TerrainSquare *sq = file->findSquare( 0, x, y );
+         const U16 height = file->getHeight( x, y );
+         EXPECT_LE( sq->minHeight, height ) << "Coarse height at " << x << ", " << y;
+         EXPECT_GE( sq->maxHeight, height ) << "Coarse height at " << x << ", " << y;
+
+         if ( ( x % file->getCoarseStep() ) == 0 && ( y % file->getCoarseStep() ) == 0 )
+         {
+            EXPECT_EQ( source.getHeight( x, y ), height ) << "Coarse sample at " << x << ", " << y;
+         }
+      }
+   }
+
+   // The upper levels are there without the tiles.
+   for ( U32 y = 0; y < 512; y += 64 )
+      for ( U32 x = 0; x < 512; x += 64 )
+         EXPECT_TRUE( sameSquare( source.findSquare( 6, x, y ), file->findSquare( 6, x, y ) ) );
+
+   for ( U32 i = 0; i < file->getTileCount(); i++ )
+      file->loadTile( i );
+   EXPECT_EQ( file->getTileCount(), file->getResidentTileCount() );
+
+   expectSame( &source, file );
+
+   // Evicting falls back to the coarse samples again.
+   file->evictTile( 3 );
+   EXPECT_FALSE( file->isTileResident( 3 ) );
+   EXPECT_EQ( file->getTileCount() - 1, file->getResidentTileCount() );
+
+   // Editing makes the whole file resident.
+   file->makeResident();
+   EXPECT_FALSE( file->isStreaming() );
+   expectSame( &source, file );
+
+   delete file;
+}
+
+TEST_FIX(TerrainFile, EvictSkipsPinnedTiles)
+{
+   TestTerrainFile source( 512 );
+   const String path = save( &source, "evict", 64 );
+
+   TerrainFile *file = load( path, true );
+   ASSERT_TRUE( file != NULL && file->isStreaming() );
+
+   for ( U32 i = 0; i < 4; i++ )
+      file->loadTile( i );
+   EXPECT_EQ( 4, file->getResidentTileCount() );
+
+   // Evict the way the streamer does, skipping the
+   // tiles pinned by the running cell builds.
+   file->pinTile( 1 );
+   file->pinTile( 1 );
+   for ( U32 i = 0; i < 4; i++ )
+   {
+      if ( !file->isTilePinned( i ) )
+         file->evictTile( i );
+   }
+
+   EXPECT_TRUE( file->isTileResident( 1 ) );
+   EXPECT_FALSE( file->isTileResident( 0 ) );
+   EXPECT_FALSE( file->isTileResident( 2 ) );
+   EXPECT_EQ( 1, file->getResidentTileCount() );
+
+   // Pins are counted.
+   file->unpinTile( 1 );
+   EXPECT_TRUE( file->isTilePinned( 1 ) );
+   file->unpinTile( 1 );
+   EXPECT_FALSE( file->isTilePinned( 1 ) );
+
+   file->evictTile( 1 );
+   EXPECT_EQ( 0, file->getResidentTileCount() );
+
+   // The evicted tile is back on the coarse samples and
+   // reloading it brings back the exact heights.
+   const RectI rect = file->getTileRect( 1 );
+   const U32 step = file->getCoarseStep();
+   for ( S32 y = rect.point.y; y < rect.point.y + rect.extent.y; y += step )
+      for ( S32 x = rect.point.x; x < rect.point.x + rect.extent.x; x += step )
+         EXPECT_EQ( source.getHeight( x, y ), file->getHeight( x, y ) ) << "Coarse sample at " << x << ", " << y;
+
+   file->loadTile( 1 );
+   for ( S32 y = rect.point.y; y < rect.point.y + rect.extent.y; y++ )
+      for ( S32 x = rect.point.x; x < rect.point.x + rect.extent.x; x++ )
+         ASSERT_EQ( source.getHeight( x, y ), file->getHeight( x, y ) ) << "Height at " << x << ", " << y;
+
+   delete file;
+}
+
+TEST_FIX(TerrainFile, CollisionFallbackBoundsTrueHeights)
+{
+   TestTerrainFile source( 512 );
+   const String path = save( &source, "collision", 64 );
+
+   TerrainFile *file = load( path, true );
+   ASSERT_TRUE( file != NULL && file->isStreaming() );
+
+   // Collision walks the grid squares, so the squares used in
+   // place of a missing tile must bound the real heights or
+   // rays and poly queries would go through the ground.
+   const U32 index = file->getTileIndex( 100, 100 );
+   ASSERT_FALSE( file->isTileResident( index ) );
+
+   const RectI rect = file->getTileRect( index );
+   for ( U32 level = 0; level < 6; level++ )
+   {
+      const S32 step = 1 << level;
+      for ( S32 y = rect.point.y; y < rect.point.y + rect.extent.y; y += step )
+      {
+         for ( S32 x = rect.point.x; x < rect.point.x + rect.extent.x; x += step )
+         {
+            const TerrainSquare *sq = file->findSquare( level, x, y );
+            for ( S32 cy = y; cy <= y + step; cy++ )
+            {
+               for ( S32 cx = x; cx <= x + step; cx++ )
+               {
+                  const U16 height = source.getHeight( cx, cy );
+                  ASSERT_LE( sq->minHeight, height ) << "Level " << level << " square at " << x << ", " << y;
+                  ASSERT_GE( sq->maxHeight, height ) << "Level " << level << " square at " << x << ", " << y;
+               }
+            }
+         }
+      }
+   }
+
+   // Once loaded the tile has the exact squares.
+   file->loadTile( index );
+   for ( S32 y = rect.point.y; y < rect.point.y + rect.extent.y; y++ )
+      for ( S32 x = rect.point.x; x < rect.point.x + rect.extent.x; x++ )
+         ASSERT_TRUE( sameSquare( source.findSquare( 0, x, y ), file->findSquare( 0, x, y ) ) ) << "Square at " << x << ", " << y;
+
+   delete file;
+}
+
+TEST_FIX(TerrainFile, StreamReadsStopAtMakeResident)
+{
+   TestTerrainFile source( 512 );
+   const String path = save( &source, "resident", 64 );
+
+   TerrainFile *file = load( path, true );
+   ASSERT_TRUE( file != NULL && file->isStreaming() );
+
+   // The streamers are told before the tiles go away.
+   struct Listener
+   {
+      TerrainFile *mFile;
+      U32 mTiles;
+      void onMakeResident() { mTiles = mFile->getTileCount(); }
+   };
+   Listener listener = { file, 0 };
+   file->getMakeResidentSignal().notify( &listener, &Listener::onMakeResident );
+
+   // A job already reading keeps makeResident() waiting.
+   struct Reader : public Thread
+   {
+      TerrainFile *mFile;
+      TerrainFile::TileData *mData;
+      Reader( TerrainFile *file ) : mFile( file ), mData( NULL ) {}
+
+      virtual void run( void* )
+      {
+         Platform::sleep( 50 );
+         mData = mFile->readTile( 0 );
+         mFile->endStreamRead();
+      }
+   };
+
+   ASSERT_TRUE( file->beginStreamRead() );
+   Reader reader( file );
+   reader.start();
+
+   file->makeResident();
+   reader.join();
+
+   EXPECT_EQ( 64, listener.mTiles );
+   EXPECT_FALSE( file->isStreaming() );
+   EXPECT_TRUE( reader.mData != NULL ) << "The tile was freed under a running read";
+   delete reader.mData;
+
+   // The jobs queued before makeResident() now skip their reads.
+   EXPECT_FALSE( file->beginStreamRead() );
+   EXPECT_TRUE( file->readTile( 0 ) == NULL );
+   file->setTileData( 0, new TerrainFile::TileData );
+   file->loadTile( 0 );
+
+   expectSame( &source, file );
+
+   file->getMakeResidentSignal().remove( &listener, &Listener::onMakeResident );
+   delete file;
+}
+
+#endif
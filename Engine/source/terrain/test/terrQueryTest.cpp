@@ -0,0 +1,428 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "math/mMathFn.h"
+#include "collision/collision.h"
+#include "terrain/terrData.h"
+#include "terrain/terrFile.h"
+#include "terrain/terrMaterial.h"
+
+/// A terrain file with some hills, both triangle splits and a hole.
+class QueryTestTerrainFile : public TerrainFile
+{
+public:
+   QueryTestTerrainFile( U32 size )
+   {
+      mMaterials.push_back( TerrainMaterial::findOrCreate( NULL ) );
+      mMaterials.push_back( TerrainMaterial::findOrCreate( NULL ) );
+      setSize( size, true );
+
+      MRandomLCG rand( 4321 );
+      for ( U32 y = 0; y < size; y++ )
+      {
+         for ( U32 x = 0; x < size; x++ )
+         {
+            const F32 hill = mSin( x * 0.05f ) * mCos( y * 0.04f ) * 60.0f + 100.0f;
+            setHeight( x, y, floatToFixed( hill + rand.randF( 0.0f, 4.0f ) ) );
+
+            U8 layer = ( x / 16 + y / 16 ) % 2;
+            if ( x > 40 && x < 60 && y > 200 && y < 230 )
+               layer = U8_MAX;
+            setLayerIndex( x, y, layer );
+         }
+      }
+
+      _buildGridMap();
+   }
+};
+
+/// A terrain block which isn't added to the scene,
+/// queried with the batched and the per point calls.
+FIXTURE(TerrainQuery)
+{
+public:
+   MRandomLCG rand;
+   TerrainBlock *block;
+   String path;
+   bool savedSIMD;
+
+   void SetUp()
+   {
+      savedSIMD = TerrainBlock::smSIMDQueries;
+      rand.setSeed( 1234 );
+
+      QueryTestTerrainFile file( 512 );
+      path = "terrQueryTest.ter";
+      EXPECT_TRUE( file.save( path ) ) << "Failed to save " << path.c_str();
+
+      block = new TerrainBlock;
+      EXPECT_TRUE( block->setFile( FileName( path ) ) );
+   }
+
+   void TearDown()
+   {
+      delete block;
+      dFileDelete( path );
+      TerrainBlock::smSIMDQueries = savedSIMD;
+   }
+
+   /// Positions over the whole block and a bit past its edges.
+   void randomPositions( U32 count, Vector<Point2F> &outPos )
+   {
+      const F32 size = block->getWorldBlockSize();
+      outPos.setSize( count );
+      for ( U32 i = 0; i < count; i++ )
+         outPos[i].set( rand.randF( -10.0f, size + 10.0f ), rand.randF( -10.0f, size + 10.0f ) );
+   }
+
+   /// Down rays for ground snapping and line of sight rays
+   /// across the hills in about equal numbers.
+   void randomRays( U32 count, Vector<Point3F> &outStarts, Vector<Point3F> &outEnds )
+   {
+      const F32 size = block->getWorldBlockSize();
+      outStarts.setSize( count );
+      outEnds.setSize( count );
+      for ( U32 i = 0; i < count; i++ )
+      {
+         const Point3F start( rand.randF( 0.0f, size ), rand.randF( 0.0f, size ), rand.randF( 80.0f, 200.0f ) );
+         outStarts[i] = start;
+         if ( i % 2 )
+            outEnds[i].set( start.x, start.y, 0.0f );
+         else
+            outEnds[i] = start + Point3F( rand.randF( -80.0f, 80.0f ), rand.randF( -80.0f, 80.0f ), rand.randF( -150.0f, 0.0f ) );
+      }
+   }
+
+   /// Runs getHeights() on the positions with outputs sized to match.
+   U32 getHeights( const Vector<Point2F> &pos, Vector<F32> &outHeights, Vector<Point3F> &outNormals, Vector<U8> &outLayers, Vector<bool> &outHits )
+   {
+      outHeights.setSize( pos.size() );
+      outNormals.setSize( pos.size() );
+      outLayers.setSize( pos.size() );
+      outHits.setSize( pos.size() );
+      return block->getHeights( pos.address(), pos.size(), outHeights.address(), outNormals.address(), outLayers.address(), outHits.address() );
+   }
+
+   /// The world position of a grid point plus a fraction of a square.
+   Point2F gridPos( F32 x, F32 y )
+   {
+      return Point2F( x * block->getSquareSize(), y * block->getSquareSize() );
+   }
+
+   /// True if the square at the grid point may touch the hole QueryTestTerrainFile cuts.
+   static bool inHole( U32 x, U32 y ) { return x >= 40 && x <= 60 && y >= 200 && y <= 230; }
+};
+
+TEST_FIX(TerrainQuery, GridPointsReturnStoredHeights)
+{
+   // Right on a grid point the interpolation has
+   // nothing to do, whichever way the square is split.
+   Vector<Point2F> pos;
+   Vector<F32> expected;
+   for ( U32 i = 0; i < 1001; i++ )
+   {
+      const U32 x = rand.randI( 0, 510 );
+      const U32 y = rand.randI( 0, 510 );
+      if ( inHole( x, y ) )
+         continue;
+      pos.push_back( gridPos( x, y ) );
+      expected.push_back( fixedToFloat( block->getFile()->getHeight( x, y ) ) );
+   }
+
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+
+      Vector<F32> heights;
+      Vector<Point3F> normals;
+      Vector<U8> layers;
+      Vector<bool> hits;
+      EXPECT_EQ( pos.size(), getHeights( pos, heights, normals, layers, hits ) );
+
+      for ( U32 i = 0; i < pos.size(); i++ )
+      {
+         ASSERT_TRUE( hits[i] ) << "Position " << i << ", SIMD " << simd;
+         EXPECT_NEAR( expected[i], heights[i], 1e-3f ) << "Position " << i << ", SIMD " << simd;
+         EXPECT_GT( normals[i].z, 0.0f ) << "Normal " << i << " points down, SIMD " << simd;
+      }
+   }
+}
+
+TEST_FIX(TerrainQuery, HoleAndOutsideMiss)
+{
+   const F32 size = block->getWorldBlockSize();
+
+   Vector<Point2F> pos;
+   pos.push_back( gridPos( 50.5f, 215.5f ) );
+   pos.push_back( gridPos( 45.2f, 205.7f ) );
+   pos.push_back( Point2F( -10.0f, 100.0f ) );
+   pos.push_back( Point2F( 100.0f, -10.0f ) );
+   pos.push_back( Point2F( size + 5.0f, 100.0f ) );
+   pos.push_back( Point2F( 100.0f, size + 5.0f ) );
+
+   // Seven positions, so the last packet of four is only partly used.
+   pos.push_back( gridPos( 55.0f, 220.0f ) );
+
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+
+      Vector<F32> heights;
+      Vector<Point3F> normals;
+      Vector<U8> layers;
+      Vector<bool> hits;
+      EXPECT_EQ( 0u, getHeights( pos, heights, normals, layers, hits ) ) << "SIMD " << simd;
+      for ( U32 i = 0; i < pos.size(); i++ )
+         EXPECT_FALSE( hits[i] ) << "Position " << i << ", SIMD " << simd;
+   }
+}
+
+TEST_FIX(TerrainQuery, LayersComeFromNearestGridPoint)
+{
+   // Positions either side of the middle of a square, away
+   // from the 16 square edges of the checkerboard.
+   Vector<Point2F> pos;
+   Vector<U8> expected;
+   for ( U32 i = 0; i < 500; i++ )
+   {
+      const U32 x = rand.randI( 0, 30 ) * 16 + rand.randI( 1, 13 );
+      const U32 y = rand.randI( 0, 30 ) * 16 + rand.randI( 1, 13 );
+      if ( inHole( x, y ) || inHole( x + 1, y + 1 ) )
+         continue;
+
+      pos.push_back( gridPos( x + 0.4f, y + 0.4f ) );
+      expected.push_back( block->getFile()->getLayerIndex( x, y ) );
+      pos.push_back( gridPos( x + 0.6f, y + 0.6f ) );
+      expected.push_back( block->getFile()->getLayerIndex( x + 1, y + 1 ) );
+   }
+
+   Vector<F32> heights;
+   Vector<Point3F> normals;
+   Vector<U8> layers;
+   Vector<bool> hits;
+   getHeights( pos, heights, normals, layers, hits );
+
+   for ( U32 i = 0; i < pos.size(); i++ )
+   {
+      ASSERT_TRUE( hits[i] ) << "Position " << i;
+      EXPECT_EQ( expected[i], layers[i] ) << "Position " << i;
+   }
+}
+
+TEST_FIX(TerrainQuery, BatchedHeightsEqualGetNormalHeightMaterial)
+{
+   Vector<Point2F> pos;
+   randomPositions( 10003, pos );
+
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+
+      Vector<F32> heights;
+      Vector<Point3F> normals;
+      Vector<U8> layers;
+      Vector<bool> hits;
+      const U32 numHits = getHeights( pos, heights, normals, layers, hits );
+
+      U32 expectedHits = 0;
+      for ( U32 i = 0; i < pos.size(); i++ )
+      {
+         Point3F normal;
+         F32 height;
+         StringTableEntry matName = StringTable->EmptyString();
+         const bool hit = block->getNormalHeightMaterial( pos[i], &normal, &height, matName );
+
+         ASSERT_EQ( hit, hits[i] ) << "Position " << i << " hit differs, SIMD " << simd;
+         if ( !hit )
+            continue;
+
+         expectedHits++;
+         EXPECT_NEAR( height, heights[i], 1e-4f ) << "Height " << i << ", SIMD " << simd;
+         EXPECT_TRUE( normal.equal( normals[i], 1e-5f ) ) << "Normal " << i << ", SIMD " << simd;
+
+         const char *layerName = block->getMaterialName( layers[i] );
+         EXPECT_EQ( matName, layerName ? layerName : StringTable->EmptyString() ) << "Material " << i;
+      }
+
+      EXPECT_EQ( expectedHits, numHits );
+   }
+}
+
+TEST_FIX(TerrainQuery, DownRaysLandOnTheGround)
+{
+   // Ground snapping: the ray hits where getHeights() says the ground is.
+   Vector<Point2F> pos;
+   for ( U32 i = 0; i < 1001; i++ )
+   {
+      const Point2F p( rand.randF( 1.0f, 510.0f ), rand.randF( 1.0f, 510.0f ) );
+      if ( !inHole( (U32)p.x, (U32)p.y ) && !inHole( (U32)p.x + 1, (U32)p.y + 1 ) )
+         pos.push_back( gridPos( p.x, p.y ) );
+   }
+
+   Vector<Point3F> starts, ends;
+   for ( U32 i = 0; i < pos.size(); i++ )
+   {
+      starts.push_back( Point3F( pos[i].x, pos[i].y, 300.0f ) );
+      ends.push_back( Point3F( pos[i].x, pos[i].y, -10.0f ) );
+   }
+
+   // And one down the middle of the hole.
+   const Point2F hole = gridPos( 50.5f, 215.5f );
+   starts.push_back( Point3F( hole.x, hole.y, 300.0f ) );
+   ends.push_back( Point3F( hole.x, hole.y, -10.0f ) );
+
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+
+      Vector<F32> heights;
+      Vector<Point3F> normals;
+      Vector<U8> layers;
+      Vector<bool> hits;
+      getHeights( pos, heights, normals, layers, hits );
+
+      Vector<RayInfo> infos;
+      Vector<bool> rayHits;
+      infos.setSize( starts.size() );
+      rayHits.setSize( starts.size() );
+      EXPECT_EQ( pos.size(), block->castRays( starts.address(), ends.address(), starts.size(), infos.address(), rayHits.address() ) ) << "SIMD " << simd;
+
+      for ( U32 i = 0; i < pos.size(); i++ )
+      {
+         ASSERT_TRUE( rayHits[i] ) << "Ray " << i << ", SIMD " << simd;
+         EXPECT_NEAR( heights[i], infos[i].point.z, 1e-2f ) << "Ray " << i << ", SIMD " << simd;
+         EXPECT_NEAR( ( 300.0f - heights[i] ) / 310.0f, infos[i].t, 1e-4f ) << "Ray " << i << ", SIMD " << simd;
+      }
+
+      EXPECT_FALSE( rayHits.last() ) << "Ray down the hole, SIMD " << simd;
+   }
+}
+
+TEST_FIX(TerrainQuery, PacketRaysEqualCastRay)
+{
+   Vector<Point3F> starts, ends;
+   randomRays( 4001, starts, ends );
+
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+
+      Vector<RayInfo> infos;
+      Vector<bool> hits;
+      infos.setSize( starts.size() );
+      hits.setSize( starts.size() );
+
+      const U32 numHits = block->castRays( starts.address(), ends.address(), starts.size(), infos.address(), hits.address() );
+
+      U32 expectedHits = 0;
+      for ( U32 i = 0; i < starts.size(); i++ )
+      {
+         RayInfo info;
+         const bool hit = block->castRay( starts[i], ends[i], &info );
+
+         ASSERT_EQ( hit, hits[i] ) << "Ray " << i << " hit differs, SIMD " << simd;
+         if ( !hit )
+            continue;
+
+         expectedHits++;
+         EXPECT_NEAR( info.t, infos[i].t, 1e-4f ) << "Ray " << i << ", SIMD " << simd;
+         EXPECT_TRUE( info.normal.equal( infos[i].normal, 1e-3f ) ) << "Normal " << i << ", SIMD " << simd;
+         EXPECT_TRUE( info.point.equal( infos[i].point, 1e-2f ) ) << "Point " << i << ", SIMD " << simd;
+         EXPECT_EQ( info.material, infos[i].material );
+      }
+
+      EXPECT_EQ( expectedHits, numHits );
+      EXPECT_GT( numHits, 0u );
+   }
+}
+
+/// Times a million height queries and 100k rays, per point
+/// and batched, as GroundCover and the AI would make them.
+TEST_FIX(TerrainQuery, GroundSnapQueryTime)
+{
+   const U32 numPositions = 1000000;
+   const U32 numRays = 100000;
+
+   Vector<Point2F> pos;
+   randomPositions( numPositions, pos );
+
+   Vector<F32> pointHeights;
+   Vector<bool> pointHits;
+   pointHeights.setSize( numPositions );
+   pointHits.setSize( numPositions );
+
+   U32 start = Platform::getRealMilliseconds();
+   for ( U32 i = 0; i < numPositions; i++ )
+   {
+      Point3F normal;
+      StringTableEntry matName;
+      pointHits[i] = block->getNormalHeightMaterial( pos[i], &normal, &pointHeights[i], matName );
+   }
+   const U32 pointTime = Platform::getRealMilliseconds() - start;
+
+   Vector<F32> heights;
+   Vector<Point3F> normals;
+   Vector<U8> layers;
+   Vector<bool> hits;
+
+   U32 batchTimes[2];
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+      start = Platform::getRealMilliseconds();
+      getHeights( pos, heights, normals, layers, hits );
+      batchTimes[simd] = Platform::getRealMilliseconds() - start;
+
+      for ( U32 i = 0; i < numPositions; i += 101 )
+      {
+         ASSERT_EQ( pointHits[i], hits[i] ) << "Position " << i << ", SIMD " << simd;
+         if ( hits[i] )
+         {
+            EXPECT_NEAR( pointHeights[i], heights[i], 1e-4f ) << "Position " << i << ", SIMD " << simd;
+         }
+      }
+   }
+
+   Con::printf( "TerrainQuery %u heights: per point %ums, batched C %ums, batched SIMD %ums",
+      numPositions, pointTime, batchTimes[0], batchTimes[1] );
+
+   Vector<Point3F> starts, ends;
+   randomRays( numRays, starts, ends );
+
+   Vector<RayInfo> rayInfos, packetInfos;
+   Vector<bool> rayHits;
+   rayInfos.setSize( numRays );
+   packetInfos.setSize( numRays );
+   rayHits.setSize( numRays );
+   hits.setSize( numRays );
+
+   start = Platform::getRealMilliseconds();
+   for ( U32 i = 0; i < numRays; i++ )
+      rayHits[i] = block->castRay( starts[i], ends[i], &rayInfos[i] );
+   const U32 rayTime = Platform::getRealMilliseconds() - start;
+
+   U32 packetTimes[2];
+   for ( U32 simd = 0; simd < 2; simd++ )
+   {
+      TerrainBlock::smSIMDQueries = ( simd != 0 );
+      start = Platform::getRealMilliseconds();
+      block->castRays( starts.address(), ends.address(), numRays, packetInfos.address(), hits.address() );
+      packetTimes[simd] = Platform::getRealMilliseconds() - start;
+
+      for ( U32 i = 0; i < numRays; i += 101 )
+      {
+         ASSERT_EQ( rayHits[i], hits[i] ) << "Ray " << i << ", SIMD " << simd;
+         if ( hits[i] )
+         {
+            EXPECT_NEAR( rayInfos[i].t, packetInfos[i].t, 1e-4f ) << "Ray " << i << ", SIMD " << simd;
+         }
+      }
+   }
+
+   Con::printf( "TerrainQuery %u rays: per ray %ums, packets C %ums, packets SIMD %ums",
+      numRays, rayTime, packetTimes[0], packetTimes[1] );
+}
+
+#endif
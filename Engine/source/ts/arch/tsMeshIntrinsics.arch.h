@@ -45,5 +45,17 @@ extern void m_matF_x_BatchedVertWeightList_gccvec(const MatrixF &mat, const dsiz
 # // Other CPU types go here...
 #endif
 
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+# // Structure-of-arrays kernels, built for their instruction set whatever
+# // the compiler flags are, and picked at runtime.
+#  if defined(__GNUC__)
+#     define TS_SIMD_TARGET(isa) __attribute__((target(isa)))
+#  else
+#     define TS_SIMD_TARGET(isa)
+#  endif
+extern void m_matF_x_BatchedVertWeightSoA_SSE(const MatrixF &mat, const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch, U8 * const __restrict outPtr, const dsize_t outStride);
+extern void m_matF_x_BatchedVertWeightSoA_AVX(const MatrixF &mat, const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch, U8 * const __restrict outPtr, const dsize_t outStride);
+#endif
+
 #endif // _TSMESHINTRINSICS_ARCH_H_
 
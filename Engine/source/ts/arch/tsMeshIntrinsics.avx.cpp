@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+#include "ts/tsMesh.h"
+
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+#include "ts/tsMeshIntrinsics.h"
+#include "ts/arch/tsMeshIntrinsics.arch.h"
+#include <immintrin.h>
+
+TS_SIMD_TARGET("avx")
+void m_matF_x_BatchedVertWeightSoA_AVX(const MatrixF &mat, 
+                                    const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch,
+                                    U8 * const __restrict outPtr,
+                                    const dsize_t outStride)
+{
+   // Each matrix element across all eight lanes
+   const F32 *m = mat;
+   __m256 avxMat[12];
+   for(S32 i = 0; i < 12; i++)
+      avxMat[i] = _mm256_set1_ps(m[i]);
+
+   // Weighted position, normal and tangent of eight vertices
+   __m256 result[9];
+   const F32 *resultF = reinterpret_cast<const F32 *>(result);
+
+   for(dsize_t i = 0; i < batch.numElements; i += 8)
+   {
+      const __m256 w = _mm256_load_ps(batch.weight + i);
+
+      // No FMA, to keep the same rounding as the C version.
+      __m256 x = _mm256_load_ps(batch.vx + i);
+      __m256 y = _mm256_load_ps(batch.vy + i);
+      __m256 z = _mm256_load_ps(batch.vz + i);
+      for(S32 r = 0; r < 3; r++)
+      {
+         __m256 p = _mm256_add_ps(_mm256_mul_ps(avxMat[r * 4], x), _mm256_mul_ps(avxMat[r * 4 + 1], y));
+         p = _mm256_add_ps(_mm256_add_ps(p, _mm256_mul_ps(avxMat[r * 4 + 2], z)), avxMat[r * 4 + 3]);
+         result[r] = _mm256_mul_ps(p, w);
+      }
+
+      x = _mm256_load_ps(batch.nx + i);
+      y = _mm256_load_ps(batch.ny + i);
+      z = _mm256_load_ps(batch.nz + i);
+      for(S32 r = 0; r < 3; r++)
+      {
+         __m256 n = _mm256_add_ps(_mm256_mul_ps(avxMat[r * 4], x), _mm256_mul_ps(avxMat[r * 4 + 1], y));
+         n = _mm256_add_ps(n, _mm256_mul_ps(avxMat[r * 4 + 2], z));
+         result[3 + r] = _mm256_mul_ps(n, w);
+      }
+
+      x = _mm256_load_ps(batch.tx + i);
+      y = _mm256_load_ps(batch.ty + i);
+      z = _mm256_load_ps(batch.tz + i);
+      for(S32 r = 0; r < 3; r++)
+      {
+         __m256 t = _mm256_add_ps(_mm256_mul_ps(avxMat[r * 4], x), _mm256_mul_ps(avxMat[r * 4 + 1], y));
+         t = _mm256_add_ps(t, _mm256_mul_ps(avxMat[r * 4 + 2], z));
+         result[6 + r] = _mm256_mul_ps(t, w);
+      }
+
+      // Accumulate into the output, skipping the padding.
+      const S32 lanes = getMin(S32(8), S32(batch.numElements - i));
+      for(S32 l = 0; l < lanes; l++)
+      {
+         TSMesh::__TSMeshVertexBase *outElem = reinterpret_cast<TSMesh::__TSMeshVertexBase *>(outPtr + batch.vidx[i + l] * outStride);
+         outElem->_vert.x += resultF[0 * 8 + l];
+         outElem->_vert.y += resultF[1 * 8 + l];
+         outElem->_vert.z += resultF[2 * 8 + l];
+         outElem->_normal.x += resultF[3 * 8 + l];
+         outElem->_normal.y += resultF[4 * 8 + l];
+         outElem->_normal.z += resultF[5 * 8 + l];
+         outElem->_tangent.x += resultF[6 * 8 + l];
+         outElem->_tangent.y += resultF[7 * 8 + l];
+         outElem->_tangent.z += resultF[8 * 8 + l];
+      }
+   }
+
+   // Avoid the AVX to SSE transition penalty in the caller.
+   _mm256_zeroupper();
+}
+
+#endif // TORQUE_CPU_X86 || TORQUE_CPU_X64
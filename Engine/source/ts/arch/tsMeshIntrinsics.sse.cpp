@@ -180,4 +180,82 @@ void m_matF_x_BatchedVertWeightList_SSE(const MatrixF &mat,
    }
 }
 
-#endif // TORQUE_CPU_X86
\ No newline at end of file
+#endif // TORQUE_CPU_X86
+
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+#include "ts/tsMeshIntrinsics.h"
+#include "ts/arch/tsMeshIntrinsics.arch.h"
+#include <emmintrin.h>
+
+//------------------------------------------------------------------------------
+
+TS_SIMD_TARGET("sse2")
+void m_matF_x_BatchedVertWeightSoA_SSE(const MatrixF &mat, 
+                                    const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch,
+                                    U8 * const __restrict outPtr,
+                                    const dsize_t outStride)
+{
+   // Each matrix element across all four lanes
+   const F32 *m = mat;
+   __m128 sseMat[12];
+   for(S32 i = 0; i < 12; i++)
+      sseMat[i] = _mm_set1_ps(m[i]);
+
+   // Weighted position, normal and tangent of four vertices
+   __m128 result[9];
+   const F32 *resultF = reinterpret_cast<const F32 *>(result);
+
+   for(dsize_t i = 0; i < batch.numElements; i += 4)
+   {
+      const __m128 w = _mm_load_ps(batch.weight + i);
+
+      // Same operation order as the C version, so the results match it.
+      __m128 x = _mm_load_ps(batch.vx + i);
+      __m128 y = _mm_load_ps(batch.vy + i);
+      __m128 z = _mm_load_ps(batch.vz + i);
+      for(S32 r = 0; r < 3; r++)
+      {
+         __m128 p = _mm_add_ps(_mm_mul_ps(sseMat[r * 4], x), _mm_mul_ps(sseMat[r * 4 + 1], y));
+         p = _mm_add_ps(_mm_add_ps(p, _mm_mul_ps(sseMat[r * 4 + 2], z)), sseMat[r * 4 + 3]);
+         result[r] = _mm_mul_ps(p, w);
+      }
+
+      x = _mm_load_ps(batch.nx + i);
+      y = _mm_load_ps(batch.ny + i);
+      z = _mm_load_ps(batch.nz + i);
+      for(S32 r = 0; r < 3; r++)
+      {
+         __m128 n = _mm_add_ps(_mm_mul_ps(sseMat[r * 4], x), _mm_mul_ps(sseMat[r * 4 + 1], y));
+         n = _mm_add_ps(n, _mm_mul_ps(sseMat[r * 4 + 2], z));
+         result[3 + r] = _mm_mul_ps(n, w);
+      }
+
+      x = _mm_load_ps(batch.tx + i);
+      y = _mm_load_ps(batch.ty + i);
+      z = _mm_load_ps(batch.tz + i);
+      for(S32 r = 0; r < 3; r++)
+      {
+         __m128 t = _mm_add_ps(_mm_mul_ps(sseMat[r * 4], x), _mm_mul_ps(sseMat[r * 4 + 1], y));
+         t = _mm_add_ps(t, _mm_mul_ps(sseMat[r * 4 + 2], z));
+         result[6 + r] = _mm_mul_ps(t, w);
+      }
+
+      // Accumulate into the output, skipping the padding.
+      const S32 lanes = getMin(S32(4), S32(batch.numElements - i));
+      for(S32 l = 0; l < lanes; l++)
+      {
+         TSMesh::__TSMeshVertexBase *outElem = reinterpret_cast<TSMesh::__TSMeshVertexBase *>(outPtr + batch.vidx[i + l] * outStride);
+         outElem->_vert.x += resultF[0 * 4 + l];
+         outElem->_vert.y += resultF[1 * 4 + l];
+         outElem->_vert.z += resultF[2 * 4 + l];
+         outElem->_normal.x += resultF[3 * 4 + l];
+         outElem->_normal.y += resultF[4 * 4 + l];
+         outElem->_normal.z += resultF[5 * 4 + l];
+         outElem->_tangent.x += resultF[6 * 4 + l];
+         outElem->_tangent.y += resultF[7 * 4 + l];
+         outElem->_tangent.z += resultF[8 * 4 + l];
+      }
+   }
+}
+
+#endif // TORQUE_CPU_X86 || TORQUE_CPU_X64
@@ -0,0 +1,373 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "ts/tsMesh.h"
+#include "ts/tsMeshIntrinsics.h"
+#include "ts/arch/tsMeshIntrinsics.arch.h"
+
+typedef TSSkinMesh::BatchData::BatchedVertWeight BatchedVertWeight;
+typedef TSSkinMesh::BatchData::BatchedTransform BatchedTransform;
+typedef void (*SoAKernel)(const MatrixF &, const TSSkinMesh::BatchData::BatchedVertWeightSoA &, U8 * const, const dsize_t);
+
+/// A random skin, batched by bone like TSSkinMesh::createBatchData() does it.
+FIXTURE(TSMeshIntrinsics)
+{
+public:
+   MRandomLCG rand;
+   U32 numVerts;
+   Vector<Point3F> tangents;
+   Vector<BatchedTransform*> bones;
+   Vector<MatrixF> matrices;
+
+   static const dsize_t outStride = sizeof( TSMesh::__TSMeshVertexBase );
+
+   void SetUp()
+   {
+      rand.setSeed( 1234 );
+      numVerts = 0;
+   }
+
+   void TearDown()
+   {
+      for ( U32 i = 0; i < bones.size(); i++ )
+         delete bones[i];
+      bones.clear();
+   }
+
+   Point3F randPoint( F32 range )
+   {
+      return Point3F( rand.randF( -range, range ), rand.randF( -range, range ), rand.randF( -range, range ) );
+   }
+
+   /// Adds a bone with the given weights, one per vertex index.
+   void addBone( const MatrixF &mat, const Vector<BatchedVertWeight> &elems )
+   {
+      BatchedTransform *bone = new BatchedTransform;
+      bone->numElements = elems.size();
+      bone->alignedMem = reinterpret_cast<BatchedVertWeight *>( dMalloc_aligned( sizeof( BatchedVertWeight ) * getMax( U32( bone->numElements ), 1U ), 16 ) );
+      dMemcpy( bone->alignedMem, elems.address(), sizeof( BatchedVertWeight ) * bone->numElements );
+      bone->soa.set( bone->alignedMem, bone->numElements, tangents.address() );
+      bones.push_back( bone );
+      matrices.push_back( mat );
+   }
+
+   BatchedVertWeight makeElem( U32 vidx, F32 weight )
+   {
+      BatchedVertWeight elem;
+      elem.vert = randPoint( 2.0f );
+      elem.normal = randPoint( 1.0f );
+      elem.normal.normalizeSafe();
+      elem.vidx = vidx;
+      elem.weight = weight;
+      return elem;
+   }
+
+   MatrixF randMatrix()
+   {
+      MatrixF mat( EulerF( rand.randF( -M_PI_F, M_PI_F ), rand.randF( -M_PI_F, M_PI_F ), rand.randF( -M_PI_F, M_PI_F ) ) );
+      mat.setPosition( randPoint( 10.0f ) );
+      return mat;
+   }
+
+   void setVertCount( U32 verts )
+   {
+      numVerts = verts;
+      tangents.setSize( numVerts );
+      for ( U32 v = 0; v < numVerts; v++ )
+      {
+         tangents[v] = randPoint( 1.0f );
+         tangents[v].normalizeSafe();
+      }
+   }
+
+   void createSkin( U32 verts, U32 numBones, U32 influences )
+   {
+      setVertCount( verts );
+
+      Vector< Vector<BatchedVertWeight> > lists;
+      lists.setSize( numBones );
+      for ( U32 v = 0; v < numVerts; v++ )
+      {
+         const BatchedVertWeight elem = makeElem( v, 1.0f / influences );
+
+         // Consecutive bones so no bone is used twice by a vertex.
+         const U32 firstBone = rand.randI( 0, numBones - 1 );
+         for ( U32 i = 0; i < influences; i++ )
+            lists[( firstBone + i ) % numBones].push_back( elem );
+      }
+
+      for ( U32 b = 0; b < numBones; b++ )
+         addBone( randMatrix(), lists[b] );
+   }
+
+   U8* allocVerts()
+   {
+      U8 *out = reinterpret_cast<U8 *>( dMalloc_aligned( outStride * numVerts, 16 ) );
+      dMemset( out, 0, outStride * numVerts );
+      return out;
+   }
+
+   void skinSoA( SoAKernel kernel, U8 *out )
+   {
+      zero_vert_normal_tangent_bulk( numVerts, out, outStride );
+      for ( U32 b = 0; b < bones.size(); b++ )
+         kernel( matrices[b], bones[b]->soa, out, outStride );
+   }
+
+   void skinList( U8 *out )
+   {
+      zero_vert_normal_bulk( numVerts, out, outStride );
+      for ( U32 b = 0; b < bones.size(); b++ )
+         m_matF_x_BatchedVertWeightList( matrices[b], bones[b]->numElements, bones[b]->alignedMem, out, outStride );
+   }
+
+   TSMesh::__TSMeshVertexBase& vert( U8 *data, U32 i )
+   {
+      return *reinterpret_cast<TSMesh::__TSMeshVertexBase *>( data + i * outStride );
+   }
+
+   /// The kernels available on this CPU, the C version first.
+   void getKernels( Vector<SoAKernel> &kernels, Vector<const char*> &names )
+   {
+      kernels.push_back( m_matF_x_BatchedVertWeightSoA_C );
+      names.push_back( "C" );
+
+#if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+      const U32 properties = Platform::SystemInfo.processor.properties;
+      if ( properties & CPU_PROP_SSE2 )
+      {
+         kernels.push_back( m_matF_x_BatchedVertWeightSoA_SSE );
+         names.push_back( "SSE" );
+      }
+      if ( properties & CPU_PROP_AVX )
+      {
+         kernels.push_back( m_matF_x_BatchedVertWeightSoA_AVX );
+         names.push_back( "AVX" );
+      }
+#endif
+   }
+};
+
+TEST_FIX(TSMeshIntrinsics, RuntimeSelectsWidestKernel)
+{
+#if defined(TORQUE_OS_XENON)
+   EXPECT_TRUE( m_matF_x_BatchedVertWeightSoA == NULL );
+#elif defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+   const U32 properties = Platform::SystemInfo.processor.properties;
+   if ( properties & CPU_PROP_AVX )
+      EXPECT_TRUE( m_matF_x_BatchedVertWeightSoA == m_matF_x_BatchedVertWeightSoA_AVX );
+   else if ( properties & CPU_PROP_SSE2 )
+      EXPECT_TRUE( m_matF_x_BatchedVertWeightSoA == m_matF_x_BatchedVertWeightSoA_SSE );
+   else
+      EXPECT_TRUE( m_matF_x_BatchedVertWeightSoA == m_matF_x_BatchedVertWeightSoA_C );
+#else
+   EXPECT_TRUE( m_matF_x_BatchedVertWeightSoA == m_matF_x_BatchedVertWeightSoA_C );
+#endif
+}
+
+TEST_FIX(TSMeshIntrinsics, TangentsSkipTranslation)
+{
+   // One bone with full weight, so the result is just the bone
+   // transform: positions are moved, normals and tangents only
+   // rotated.
+   setVertCount( 11 );
+   Vector<BatchedVertWeight> elems;
+   for ( U32 v = 0; v < numVerts; v++ )
+      elems.push_back( makeElem( v, 1.0f ) );
+   MatrixF mat = randMatrix();
+   mat.setPosition( Point3F( 100.0f, -200.0f, 300.0f ) );
+   addBone( mat, elems );
+
+   Vector<SoAKernel> kernels;
+   Vector<const char*> names;
+   getKernels( kernels, names );
+
+   for ( U32 k = 0; k < kernels.size(); k++ )
+   {
+      U8 *out = allocVerts();
+      skinSoA( kernels[k], out );
+
+      for ( U32 i = 0; i < numVerts; i++ )
+      {
+         Point3F pos, normal, tangent;
+         mat.mulP( elems[i].vert, &pos );
+         mat.mulV( elems[i].normal, &normal );
+         mat.mulV( tangents[i], &tangent );
+
+         EXPECT_TRUE( vert( out, i )._vert.equal( pos, 1e-4f ) ) << names[k] << " vertex " << i;
+         EXPECT_TRUE( vert( out, i )._normal.equal( normal, 1e-5f ) ) << names[k] << " normal " << i;
+         EXPECT_TRUE( vert( out, i )._tangent.equal( tangent, 1e-5f ) ) << names[k] << " tangent " << i;
+      }
+
+      dFree_aligned( out );
+   }
+}
+
+TEST_FIX(TSMeshIntrinsics, WeightsBlendBones)
+{
+   // Every vertex is a quarter of the first bone and
+   // three quarters of the second.
+   setVertCount( 13 );
+   Vector<BatchedVertWeight> first, second;
+   for ( U32 v = 0; v < numVerts; v++ )
+   {
+      first.push_back( makeElem( v, 0.25f ) );
+      second.push_back( first.last() );
+      second.last().weight = 0.75f;
+   }
+   addBone( randMatrix(), first );
+   addBone( randMatrix(), second );
+
+   Vector<SoAKernel> kernels;
+   Vector<const char*> names;
+   getKernels( kernels, names );
+
+   for ( U32 k = 0; k < kernels.size(); k++ )
+   {
+      U8 *out = allocVerts();
+      skinSoA( kernels[k], out );
+
+      for ( U32 i = 0; i < numVerts; i++ )
+      {
+         Point3F posA, posB, tanA, tanB;
+         matrices[0].mulP( first[i].vert, &posA );
+         matrices[1].mulP( first[i].vert, &posB );
+         matrices[0].mulV( tangents[i], &tanA );
+         matrices[1].mulV( tangents[i], &tanB );
+
+         EXPECT_TRUE( vert( out, i )._vert.equal( posA * 0.25f + posB * 0.75f, 1e-4f ) ) << names[k] << " vertex " << i;
+         EXPECT_TRUE( vert( out, i )._tangent.equal( tanA * 0.25f + tanB * 0.75f, 1e-5f ) ) << names[k] << " tangent " << i;
+      }
+
+      dFree_aligned( out );
+   }
+}
+
+TEST_FIX(TSMeshIntrinsics, PaddingLeavesOtherVertsAlone)
+{
+   // A bone which only moves every third vertex.  None of the batch
+   // sizes fill the last 4 or 8 wide block, and the padding lanes
+   // point at vertex 0, which isn't in the batch.
+   Vector<SoAKernel> kernels;
+   Vector<const char*> names;
+   getKernels( kernels, names );
+
+   for ( U32 count = 1; count < 18; count++ )
+   {
+      bones.clear();
+      matrices.clear();
+      setVertCount( count * 3 + 1 );
+
+      Vector<BatchedVertWeight> elems;
+      for ( U32 v = 1; v < numVerts; v += 3 )
+         elems.push_back( makeElem( v, 1.0f ) );
+      addBone( randMatrix(), elems );
+
+      for ( U32 k = 0; k < kernels.size(); k++ )
+      {
+         U8 *out = allocVerts();
+         skinSoA( kernels[k], out );
+
+         for ( U32 i = 0; i < numVerts; i++ )
+         {
+            if ( i % 3 == 1 )
+               EXPECT_FALSE( vert( out, i )._tangent.isZero() ) << names[k] << " batch of " << count << " skipped vertex " << i;
+            else
+            {
+               EXPECT_TRUE( vert( out, i )._vert.isZero() ) << names[k] << " batch of " << count << " moved vertex " << i;
+               EXPECT_TRUE( vert( out, i )._tangent.isZero() ) << names[k] << " batch of " << count << " moved tangent " << i;
+            }
+         }
+
+         dFree_aligned( out );
+      }
+
+      delete bones[0];
+   }
+
+   bones.clear();
+}
+
+TEST_FIX(TSMeshIntrinsics, WideKernelsCloseToC)
+{
+   // Not a multiple of the kernel widths, so the padding gets used.
+   createSkin( 1003, 7, 3 );
+
+   Vector<SoAKernel> kernels;
+   Vector<const char*> names;
+   getKernels( kernels, names );
+
+   U8 *reference = allocVerts();
+   skinSoA( kernels[0], reference );
+
+   // The batch-by-transform loop doesn't do tangents, but the
+   // positions and normals have to agree with it.
+   U8 *list = allocVerts();
+   skinList( list );
+   for ( U32 i = 0; i < numVerts; i++ )
+   {
+      EXPECT_TRUE( vert( list, i )._vert.equal( vert( reference, i )._vert, 1e-4f ) ) << "Vertex " << i;
+      EXPECT_TRUE( vert( list, i )._normal.equal( vert( reference, i )._normal, 1e-4f ) ) << "Normal " << i;
+   }
+   dFree_aligned( list );
+
+   for ( U32 k = 1; k < kernels.size(); k++ )
+   {
+      U8 *out = allocVerts();
+      skinSoA( kernels[k], out );
+
+      for ( U32 i = 0; i < numVerts; i++ )
+      {
+         const TSMesh::__TSMeshVertexBase &a = vert( reference, i );
+         const TSMesh::__TSMeshVertexBase &b = vert( out, i );
+         EXPECT_TRUE( a._vert.equal( b._vert, 1e-5f ) ) << names[k] << " vertex " << i;
+         EXPECT_TRUE( a._normal.equal( b._normal, 1e-5f ) ) << names[k] << " normal " << i;
+         EXPECT_TRUE( a._tangent.equal( b._tangent, 1e-5f ) ) << names[k] << " tangent " << i;
+      }
+
+      dFree_aligned( out );
+   }
+
+   dFree_aligned( reference );
+}
+
+/// Times each kernel on a large character.
+TEST_FIX(TSMeshIntrinsics, LargeCharacterSkinTime)
+{
+   // 100k vertices, 4 bones each, 80 bones.
+   createSkin( 100000, 80, 4 );
+   const U32 numIterations = 50;
+
+   U8 *list = allocVerts();
+
+   U32 start = Platform::getRealMilliseconds();
+   for ( U32 n = 0; n < numIterations; n++ )
+      skinList( list );
+   Con::printf( "TSMeshIntrinsics skinning %u verts x %u: batched list %ums",
+      numVerts, numIterations, Platform::getRealMilliseconds() - start );
+
+   Vector<SoAKernel> kernels;
+   Vector<const char*> names;
+   getKernels( kernels, names );
+
+   U8 *out = allocVerts();
+   for ( U32 k = 0; k < kernels.size(); k++ )
+   {
+      start = Platform::getRealMilliseconds();
+      for ( U32 n = 0; n < numIterations; n++ )
+         skinSoA( kernels[k], out );
+      Con::printf( "TSMeshIntrinsics skinning %u verts x %u: %s SoA %ums",
+         numVerts, numIterations, names[k], Platform::getRealMilliseconds() - start );
+
+      // Still skinning the same mesh after all those runs.
+      for ( U32 i = 0; i < numVerts; i += 97 )
+         EXPECT_TRUE( vert( out, i )._vert.equal( vert( list, i )._vert, 1e-4f ) ) << names[k] << " vertex " << i;
+   }
+
+   dFree_aligned( out );
+   dFree_aligned( list );
+}
+
+#endif
@@ -0,0 +1,424 @@
+#ifdef TORQUE_TESTS_ENABLED
+#include "testing/unitTesting.h"
+#include "platform/platform.h"
+#include "platform/threads/thread.h"
+#include "console/console.h"
+#include "console/sim.h"
+#include "math/mRandom.h"
+#include "ts/tsShape.h"
+#include "ts/tsShapeInstance.h"
+
+/// Records the threads a node callback is called on.
+class TSShapeInstanceTestCallback : public TSCallback
+{
+public:
+   U32 calls;
+   U32 offMainThread;
+
+   TSShapeInstanceTestCallback() : calls( 0 ), offMainThread( 0 ) {}
+
+   virtual void setNodeTransform( TSShapeInstance*, S32, MatrixF &localTransform )
+   {
+      calls++;
+      if ( !ThreadManager::isMainThread() )
+         offMainThread++;
+      localTransform.identity();
+      localTransform.setPosition( Point3F( 0.0f, 0.0f, 1.0f ) );
+   }
+};
+
+/// A crowd of skinned arms: a strip of quads weighted between
+/// two bones, built in code so the test needs no art.  Each
+/// sequence swings both bones about a different axis.
+FIXTURE(TSShapeInstanceAnimate)
+{
+public:
+   TSShape *shape;
+   Vector<TSShapeInstance*> shapes;
+   bool savedThreaded;
+
+   enum
+   {
+      NumRows = 8,
+      NumKeyframes = 9,
+   };
+
+   void SetUp()
+   {
+      savedThreaded = TSShapeInstance::smThreadedAnimation;
+
+      shape = new TSShape;
+      buildArm();
+      addSequence( "swingX", Point3F( 1.0f, 0.0f, 0.0f ) );
+      addSequence( "swingY", Point3F( 0.0f, 1.0f, 0.0f ) );
+      shape->init();
+   }
+
+   void TearDown()
+   {
+      clearShapes();
+      delete shape;
+      TSShapeInstance::smThreadedAnimation = savedThreaded;
+   }
+
+   void clearShapes()
+   {
+      for ( U32 i = 0; i < shapes.size(); i++ )
+         delete shapes[i];
+      shapes.clear();
+   }
+
+   void addNode( const char *name, S32 parent, const Point3F &pos )
+   {
+      shape->nodes.increment();
+      TSShape::Node &node = shape->nodes.last();
+      node.nameIndex = shape->addName( name );
+      node.parentIndex = parent;
+      node.firstObject = node.firstChild = node.nextSibling = -1;
+
+      Quat16 rot;
+      rot.identity();
+      shape->defaultRotations.push_back( rot );
+      shape->defaultTranslations.push_back( pos );
+   }
+
+   void buildArm()
+   {
+      addNode( "root", -1, Point3F::Zero );
+      addNode( "elbow", 0, Point3F( 0.0f, 0.0f, 1.0f ) );
+
+      TSSkinMesh *mesh = new TSSkinMesh;
+      for ( U32 row = 0; row <= NumRows; row++ )
+      {
+         const F32 z = 2.0f * row / NumRows;
+         const F32 elbowWeight = mClampF( z - 0.5f, 0.0f, 1.0f );
+         for ( U32 side = 0; side < 2; side++ )
+         {
+            const S32 vert = mesh->batchData.initialVerts.size();
+            mesh->batchData.initialVerts.push_back( Point3F( side ? 0.1f : -0.1f, 0.0f, z ) );
+            mesh->batchData.initialNorms.push_back( Point3F( 0.0f, -1.0f, 0.0f ) );
+            mesh->tverts.push_back( Point2F( side, z * 0.5f ) );
+
+            if ( elbowWeight < 1.0f )
+            {
+               mesh->vertexIndex.push_back( vert );
+               mesh->boneIndex.push_back( 0 );
+               mesh->weight.push_back( 1.0f - elbowWeight );
+            }
+            if ( elbowWeight > 0.0f )
+            {
+               mesh->vertexIndex.push_back( vert );
+               mesh->boneIndex.push_back( 1 );
+               mesh->weight.push_back( elbowWeight );
+            }
+         }
+
+         if ( row < NumRows )
+         {
+            const U32 v = row * 2;
+            const U32 quad[] = { v, v + 1, v + 3, v, v + 3, v + 2 };
+            for ( U32 i = 0; i < 6; i++ )
+               mesh->indices.push_back( quad[i] );
+         }
+      }
+
+      // Bones are bound at their rest positions.
+      mesh->batchData.nodeIndex.push_back( 0 );
+      mesh->batchData.nodeIndex.push_back( 1 );
+      mesh->batchData.initialTransforms.setSize( 2 );
+      mesh->batchData.initialTransforms[0].identity();
+      mesh->batchData.initialTransforms[1].identity();
+      mesh->batchData.initialTransforms[1].setPosition( Point3F( 0.0f, 0.0f, -1.0f ) );
+
+      TSDrawPrimitive prim;
+      prim.start = 0;
+      prim.numElements = mesh->indices.size();
+      prim.matIndex = TSDrawPrimitive::Triangles | TSDrawPrimitive::Indexed | TSDrawPrimitive::NoMaterial;
+      mesh->primitives.push_back( prim );
+
+      mesh->verts = mesh->batchData.initialVerts;
+      mesh->norms = mesh->batchData.initialNorms;
+      mesh->numFrames = 1;
+      mesh->numMatFrames = 1;
+      mesh->vertsPerFrame = mesh->batchData.initialVerts.size();
+      mesh->TSMesh::computeBounds();
+      mesh->createTangents( mesh->verts, mesh->norms );
+      shape->meshes.push_back( mesh );
+
+      // One skinned object with one detail level.
+      shape->objects.increment();
+      TSShape::Object &obj = shape->objects.last();
+      obj.nameIndex = shape->addName( "arm" );
+      obj.numMeshes = 1;
+      obj.startMeshIndex = 0;
+      obj.nodeIndex = -1;
+      obj.nextSibling = -1;
+      obj.firstDecal = -1;
+
+      shape->objectStates.increment();
+      shape->objectStates.last().vis = 1.0f;
+      shape->objectStates.last().frameIndex = 0;
+      shape->objectStates.last().matFrameIndex = 0;
+
+      shape->details.increment();
+      TSShape::Detail &detail = shape->details.last();
+      dMemset( &detail, 0, sizeof( detail ) );
+      detail.nameIndex = shape->addName( "detail2" );
+      detail.subShapeNum = 0;
+      detail.objectDetailNum = 0;
+      detail.size = 2.0f;
+      detail.averageError = -1.0f;
+      detail.maxError = -1.0f;
+
+      shape->subShapeFirstNode.push_back( 0 );
+      shape->subShapeNumNodes.push_back( shape->nodes.size() );
+      shape->subShapeFirstObject.push_back( 0 );
+      shape->subShapeNumObjects.push_back( shape->objects.size() );
+      shape->subShapeFirstTranslucentObject.push_back( shape->objects.size() );
+
+      shape->bounds.set( Point3F( -2.0f, -2.0f, -2.0f ), Point3F( 2.0f, 2.0f, 2.0f ) );
+      shape->center.set( 0.0f, 0.0f, 0.0f );
+      shape->radius = shape->tubeRadius = 2.0f;
+      shape->updateSmallestVisibleDL();
+   }
+
+   /// A cyclic sequence rotating both bones about @a axis.
+   void addSequence( const char *name, const Point3F &axis )
+   {
+      shape->sequences.increment();
+      TSShape::Sequence &seq = shape->sequences.last();
+      seq.nameIndex = shape->addName( name );
+      seq.numKeyframes = NumKeyframes;
+      seq.duration = 1.0f;
+      seq.baseRotation = shape->nodeRotations.size();
+      seq.baseTranslation = shape->nodeTranslations.size();
+      seq.baseScale = 0;
+      seq.baseObjectState = shape->objectStates.size();
+      seq.baseDecalState = 0;
+      seq.firstGroundFrame = shape->groundTranslations.size();
+      seq.numGroundFrames = 0;
+      seq.firstTrigger = shape->triggers.size();
+      seq.numTriggers = 0;
+      seq.toolBegin = 0.0f;
+      seq.priority = 0;
+      seq.flags = TSShape::Cyclic;
+      seq.dirtyFlags = TSShapeInstance::TransformDirty;
+
+      seq.rotationMatters.clearAll();
+      seq.translationMatters.clearAll();
+      seq.scaleMatters.clearAll();
+      seq.visMatters.clearAll();
+      seq.frameMatters.clearAll();
+      seq.matFrameMatters.clearAll();
+
+      for ( S32 node = 0; node < shape->nodes.size(); node++ )
+      {
+         seq.rotationMatters.set( node );
+         for ( S32 key = 0; key < NumKeyframes; key++ )
+         {
+            const F32 angle = mSin( M_2PI_F * key / ( NumKeyframes - 1 ) ) * ( node + 1 ) * 0.5f;
+            Quat16 rot;
+            rot.set( QuatF( AngAxisF( axis, angle ) ) );
+            shape->nodeRotations.push_back( rot );
+         }
+      }
+
+      seq.sourceData.end = NumKeyframes - 1;
+      seq.sourceData.total = NumKeyframes;
+   }
+
+   void addShapes( U32 count )
+   {
+      MRandomLCG rand( 1234 );
+      for ( U32 i = 0; i < count; i++ )
+      {
+         TSShapeInstance *inst = new TSShapeInstance( shape, false );
+         TSThread *thread = inst->addThread();
+         inst->setSequence( thread, i % shape->sequences.size(), rand.randF() );
+         inst->setCurrentDetail( 0 );
+         shapes.push_back( inst );
+      }
+   }
+
+   void advance( F32 dt )
+   {
+      Sim::advanceTime( U32( dt * 1000.0f ) );
+      for ( U32 i = 0; i < shapes.size(); i++ )
+         shapes[i]->advanceTime( dt );
+   }
+
+   /// Animate and skin every shape on this thread, the way the
+   /// animation jobs do it.
+   void animateSerial()
+   {
+      const U32 time = Sim::getCurrentTime();
+      Vector<MatrixF> &boneTransforms = TSShapeInstance::smMainWorkspace.boneTransforms;
+      for ( U32 i = 0; i < shapes.size(); i++ )
+      {
+         TSShapeInstance *inst = shapes[i];
+         inst->animate();
+
+         const TSDetail &detail = shape->details[inst->getCurrentDetail()];
+         for ( U32 j = 0; j < inst->mMeshObjects.size(); j++ )
+         {
+            TSMesh *mesh = inst->mMeshObjects[j].getMesh( detail.objectDetailNum );
+            if ( mesh && mesh->getMeshType() == TSMesh::SkinMeshType )
+               static_cast<TSSkinMesh*>( mesh )->initSkin();
+            inst->mMeshObjects[j].skin( detail.objectDetailNum, time, boneTransforms );
+         }
+      }
+   }
+
+   void animateBatch()
+   {
+      TSShapeInstance::beginAnimateBatch();
+      for ( U32 i = 0; i < shapes.size(); i++ )
+         shapes[i]->queueAnimate();
+      TSShapeInstance::endAnimateBatch();
+   }
+
+   const TSMesh::TSMeshVertexArray& skinnedVerts( U32 index )
+   {
+      return *shapes[index]->mMeshObjects[0].mSkinnedVerts;
+   }
+};
+
+TEST_FIX(TSShapeInstanceAnimate, JobsSkinTheWholeCrowd)
+{
+   TSShapeInstance::smThreadedAnimation = true;
+   addShapes( 64 );
+
+   for ( U32 frame = 0; frame < 4; frame++ )
+   {
+      advance( 0.1f );
+      animateSerial();
+
+      Vector< Vector<MatrixF> > nodes;
+      Vector< Vector<Point3F> > verts;
+      nodes.setSize( shapes.size() );
+      verts.setSize( shapes.size() );
+      for ( U32 i = 0; i < shapes.size(); i++ )
+      {
+         nodes[i] = shapes[i]->mNodeTransforms;
+         for ( U32 v = 0; v < skinnedVerts( i ).size(); v++ )
+            verts[i].push_back( skinnedVerts( i )[v].vert() );
+      }
+
+      // Animating again at the same sequence positions on the
+      // jobs has to give the same nodes and the same skins.
+      Sim::advanceTime( 1 );
+      animateBatch();
+
+      for ( U32 i = 0; i < shapes.size(); i++ )
+      {
+         const TSShapeInstance::MeshObjectInstance &obj = shapes[i]->mMeshObjects[0];
+         ASSERT_EQ( Sim::getCurrentTime(), obj.mSkinnedTime ) << "Shape " << i << " was not skinned by the batch";
+         ASSERT_EQ( nodes[i].size(), shapes[i]->mNodeTransforms.size() );
+         ASSERT_EQ( verts[i].size(), skinnedVerts( i ).size() );
+
+         for ( U32 j = 0; j < nodes[i].size(); j++ )
+            EXPECT_TRUE( nodes[i][j] == shapes[i]->mNodeTransforms[j] ) << "Shape " << i << " node " << j;
+         for ( U32 v = 0; v < verts[i].size(); v++ )
+            EXPECT_TRUE( verts[i][v].equal( skinnedVerts( i )[v].vert(), 1e-5f ) ) << "Shape " << i << " vertex " << v;
+      }
+   }
+
+   // The tip of the arm is skinned to the animated elbow, so it
+   // has left its bind position on all but the shapes that happen
+   // to be at a rest pose.
+   TSSkinMesh *mesh = shapes[0]->mMeshObjects[0].mSkinnedMesh;
+   const U32 tip = mesh->batchData.initialVerts.size() - 1;
+   U32 moved = 0;
+   for ( U32 i = 0; i < shapes.size(); i++ )
+   {
+      if ( !skinnedVerts( i )[tip].vert().equal( mesh->batchData.initialVerts[tip], 1e-3f ) )
+         moved++;
+   }
+   EXPECT_GT( moved, shapes.size() / 2 );
+}
+
+TEST_FIX(TSShapeInstanceAnimate, AnimatesImmediatelyWhenDisabled)
+{
+   TSShapeInstance::smThreadedAnimation = false;
+   addShapes( 16 );
+   advance( 0.25f );
+
+   // With threaded animation off queueAnimate() may not wait for
+   // the end of the batch.
+   TSShapeInstance::beginAnimateBatch();
+   Vector< Vector<MatrixF> > nodes;
+   nodes.setSize( shapes.size() );
+   for ( U32 i = 0; i < shapes.size(); i++ )
+   {
+      shapes[i]->queueAnimate();
+      nodes[i] = shapes[i]->mNodeTransforms;
+   }
+   TSShapeInstance::endAnimateBatch();
+
+   for ( U32 i = 0; i < shapes.size(); i++ )
+   {
+      shapes[i]->animate();
+      for ( U32 j = 0; j < nodes[i].size(); j++ )
+         EXPECT_TRUE( nodes[i][j] == shapes[i]->mNodeTransforms[j] ) << "Shape " << i << " node " << j;
+   }
+}
+
+TEST_FIX(TSShapeInstanceAnimate, NodeCallbacksRunOnMainThread)
+{
+   TSShapeInstance::smThreadedAnimation = true;
+   addShapes( 32 );
+
+   TSShapeInstanceTestCallback callback;
+   shapes[5]->setNodeAnimationState( 1, 0, &callback );
+
+   for ( U32 frame = 0; frame < 3; frame++ )
+   {
+      advance( 0.1f );
+      animateBatch();
+   }
+
+   EXPECT_EQ( 3U, callback.calls );
+   EXPECT_EQ( 0U, callback.offMainThread ) << "Node callbacks are game code and must not run on the jobs";
+
+   // The other shapes still went through the jobs.
+   EXPECT_EQ( Sim::getCurrentTime(), shapes[4]->mMeshObjects[0].mSkinnedTime );
+}
+
+/// Headless crowd benchmark: animates and skins crowds of
+/// increasing size on this thread and on the jobs.
+TEST_FIX(TSShapeInstanceAnimate, CrowdAnimationTime)
+{
+   TSShapeInstance::smThreadedAnimation = true;
+
+   const U32 counts[] = { 16, 128, 512 };
+   const U32 numFrames = 100;
+   for ( U32 c = 0; c < sizeof( counts ) / sizeof( counts[0] ); c++ )
+   {
+      clearShapes();
+      addShapes( counts[c] );
+
+      U32 start = Platform::getRealMilliseconds();
+      for ( U32 n = 0; n < numFrames; n++ )
+      {
+         advance( 0.032f );
+         animateSerial();
+      }
+      const U32 serialTime = Platform::getRealMilliseconds() - start;
+
+      start = Platform::getRealMilliseconds();
+      for ( U32 n = 0; n < numFrames; n++ )
+      {
+         advance( 0.032f );
+         animateBatch();
+      }
+      const U32 batchTime = Platform::getRealMilliseconds() - start;
+
+      for ( U32 i = 0; i < shapes.size(); i++ )
+         ASSERT_EQ( Sim::getCurrentTime(), shapes[i]->mMeshObjects[0].mSkinnedTime ) << "Shape " << i;
+
+      Con::printf( "TSShapeInstanceAnimate %u shapes, %u frames: serial %ums, batched %ums",
+         counts[c], numFrames, serialTime, batchTime );
+   }
+}
+
+#endif
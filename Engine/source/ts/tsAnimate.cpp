@@ -21,6 +21,8 @@
 //-----------------------------------------------------------------------------
 
 #include "ts/tsShapeInstance.h"
+#include "platform/threads/threadPoolTaskSet.h"
+#include "console/simBase.h"
 
 //----------------------------------------------------------------------------------
 // some utility functions
@@ -69,11 +71,11 @@ void TSShapeInstance::animateNodes(S32 ss)
    mNodeTransforms.setSize(mShape->nodes.size());
 
    // temporary storage for node transforms
-   smNodeCurrentRotations.setSize(mShape->nodes.size());
-   smNodeCurrentTranslations.setSize(mShape->nodes.size());
-   smNodeLocalTransforms.setSize(mShape->nodes.size());
-   smRotationThreads.setSize(mShape->nodes.size());
-   smTranslationThreads.setSize(mShape->nodes.size());
+   mWorkspace->nodeCurrentRotations.setSize(mShape->nodes.size());
+   mWorkspace->nodeCurrentTranslations.setSize(mShape->nodes.size());
+   mWorkspace->nodeLocalTransforms.setSize(mShape->nodes.size());
+   mWorkspace->rotationThreads.setSize(mShape->nodes.size());
+   mWorkspace->translationThreads.setSize(mShape->nodes.size());
 
    TSIntegerSet rotBeenSet;
    TSIntegerSet tranBeenSet;
@@ -81,7 +83,7 @@ void TSShapeInstance::animateNodes(S32 ss)
    rotBeenSet.setAll(mShape->nodes.size());
    tranBeenSet.setAll(mShape->nodes.size());
    scaleBeenSet.setAll(mShape->nodes.size());
-   smNodeLocalTransformDirty.clearAll();
+   mWorkspace->nodeLocalTransformDirty.clearAll();
 
    S32 i,j,nodeIndex,a,b,start,end,firstBlend = mThreadList.size();
    for (i=0; i<mThreadList.size(); i++)
@@ -120,13 +122,13 @@ void TSShapeInstance::animateNodes(S32 ss)
    {
       if (rotBeenSet.test(i))
       {
-         mShape->defaultRotations[i].getQuatF(&smNodeCurrentRotations[i]);
-         smRotationThreads[i] = NULL;
+         mShape->defaultRotations[i].getQuatF(&mWorkspace->nodeCurrentRotations[i]);
+         mWorkspace->rotationThreads[i] = NULL;
       }
       if (tranBeenSet.test(i))
       {
-         smNodeCurrentTranslations[i] = mShape->defaultTranslations[i];
-         smTranslationThreads[i] = NULL;
+         mWorkspace->nodeCurrentTranslations[i] = mShape->defaultTranslations[i];
+         mWorkspace->translationThreads[i] = NULL;
       }
    }
 
@@ -159,9 +161,9 @@ void TSShapeInstance::animateNodes(S32 ss)
             QuatF q1,q2;
             mShape->getRotation(*th->getSequence(),th->keyNum1,j,&q1);
             mShape->getRotation(*th->getSequence(),th->keyNum2,j,&q2);
-            TSTransform::interpolate(q1,q2,th->keyPos,&smNodeCurrentRotations[nodeIndex]);
+            TSTransform::interpolate(q1,q2,th->keyPos,&mWorkspace->nodeCurrentRotations[nodeIndex]);
             rotBeenSet.set(nodeIndex);
-            smRotationThreads[nodeIndex] = th;
+            mWorkspace->rotationThreads[nodeIndex] = th;
          }
       }
 
@@ -180,8 +182,8 @@ void TSShapeInstance::animateNodes(S32 ss)
             {
                const Point3F & p1 = mShape->getTranslation(*th->getSequence(),th->keyNum1,j);
                const Point3F & p2 = mShape->getTranslation(*th->getSequence(),th->keyNum2,j);
-               TSTransform::interpolate(p1,p2,th->keyPos,&smNodeCurrentTranslations[nodeIndex]);
-               smTranslationThreads[nodeIndex] = th;
+               TSTransform::interpolate(p1,p2,th->keyPos,&mWorkspace->nodeCurrentTranslations[nodeIndex]);
+               mWorkspace->translationThreads[nodeIndex] = th;
             }
             tranBeenSet.set(nodeIndex);
          }
@@ -195,9 +197,9 @@ void TSShapeInstance::animateNodes(S32 ss)
    for (i=a; i<b; i++)
    {
       if (!mHandsOffNodes.test(i))
-         TSTransform::setMatrix(smNodeCurrentRotations[i],smNodeCurrentTranslations[i],&smNodeLocalTransforms[i]);
+         TSTransform::setMatrix(mWorkspace->nodeCurrentRotations[i],mWorkspace->nodeCurrentTranslations[i],&mWorkspace->nodeLocalTransforms[i]);
       else
-         smNodeLocalTransforms[i] = mNodeTransforms[i];     // in case mNodeTransform was changed externally
+         mWorkspace->nodeLocalTransforms[i] = mNodeTransforms[i];     // in case mNodeTransform was changed externally
    }
 
    // add scale onto transforms
@@ -213,8 +215,8 @@ void TSShapeInstance::animateNodes(S32 ss)
       S32 nodeIndex = mNodeCallbacks[i].nodeIndex;
       if (nodeIndex>=start && nodeIndex<end)
       {
-         mNodeCallbacks[i].callback->setNodeTransform(this, nodeIndex, smNodeLocalTransforms[nodeIndex]);
-         smNodeLocalTransformDirty.set(nodeIndex);
+         mNodeCallbacks[i].callback->setNodeTransform(this, nodeIndex, mWorkspace->nodeLocalTransforms[nodeIndex]);
+         mWorkspace->nodeLocalTransformDirty.set(nodeIndex);
       }
    }
 
@@ -237,9 +239,9 @@ void TSShapeInstance::animateNodes(S32 ss)
    {
       S32 parentIdx = mShape->nodes[i].parentIndex;
       if (parentIdx < 0)
-         mNodeTransforms[i] = smNodeLocalTransforms[i];
+         mNodeTransforms[i] = mWorkspace->nodeLocalTransforms[i];
       else
-         mNodeTransforms[i].mul(mNodeTransforms[parentIdx],smNodeLocalTransforms[i]);
+         mNodeTransforms[i].mul(mNodeTransforms[parentIdx],mWorkspace->nodeLocalTransforms[i]);
    }
 }
 
@@ -248,37 +250,37 @@ void TSShapeInstance::handleDefaultScale(S32 a, S32 b, TSIntegerSet & scaleBeenS
    // set default scale values (i.e., identity) and do any initialization
    // relating to animated scale (since scale normally not animated)
 
-   smScaleThreads.setSize(mShape->nodes.size());
+   mWorkspace->scaleThreads.setSize(mShape->nodes.size());
    scaleBeenSet.takeAway(mCallbackNodes);
    scaleBeenSet.takeAway(mHandsOffNodes);
    if (animatesUniformScale())
    {
-      smNodeCurrentUniformScales.setSize(mShape->nodes.size());
+      mWorkspace->nodeCurrentUniformScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentUniformScales[i] = 1.0f;
-            smScaleThreads[i] = NULL;
+            mWorkspace->nodeCurrentUniformScales[i] = 1.0f;
+            mWorkspace->scaleThreads[i] = NULL;
          }
    }
    else if (animatesAlignedScale())
    {
-      smNodeCurrentAlignedScales.setSize(mShape->nodes.size());
+      mWorkspace->nodeCurrentAlignedScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentAlignedScales[i].set(1.0f,1.0f,1.0f);
-            smScaleThreads[i] = NULL;
+            mWorkspace->nodeCurrentAlignedScales[i].set(1.0f,1.0f,1.0f);
+            mWorkspace->scaleThreads[i] = NULL;
          }
    }
    else
    {
-      smNodeCurrentArbitraryScales.setSize(mShape->nodes.size());
+      mWorkspace->nodeCurrentArbitraryScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentArbitraryScales[i].identity();
-            smScaleThreads[i] = NULL;
+            mWorkspace->nodeCurrentArbitraryScales[i].identity();
+            mWorkspace->scaleThreads[i] = NULL;
          }
    }
 
@@ -299,19 +301,19 @@ void TSShapeInstance::updateTransitionNodeTransforms(TSIntegerSet& transitionNod
    // for blended or scale-animated nodes, as all others are already up to date
    for (S32 i=transitionNodes.start(); i<MAX_TS_SET_SIZE; transitionNodes.next(i))
    {
-      if (smNodeLocalTransformDirty.test(i))
+      if (mWorkspace->nodeLocalTransformDirty.test(i))
       {
          if (scaleCurrentlyAnimated())
          {
             // @todo:No support for scale yet => need to do proper affine decomposition here
-            smNodeCurrentTranslations[i] = smNodeLocalTransforms[i].getPosition();
-            smNodeCurrentRotations[i].set(smNodeLocalTransforms[i]);
+            mWorkspace->nodeCurrentTranslations[i] = mWorkspace->nodeLocalTransforms[i].getPosition();
+            mWorkspace->nodeCurrentRotations[i].set(mWorkspace->nodeLocalTransforms[i]);
          }
          else
          {
             // Scale is identity => can do a cheap decomposition
-            smNodeCurrentTranslations[i] = smNodeLocalTransforms[i].getPosition();
-            smNodeCurrentRotations[i].set(smNodeLocalTransforms[i]);
+            mWorkspace->nodeCurrentTranslations[i] = mWorkspace->nodeLocalTransforms[i].getPosition();
+            mWorkspace->nodeCurrentRotations[i].set(mWorkspace->nodeLocalTransforms[i]);
          }
       }
    }
@@ -329,7 +331,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    {
       if (nodeIndex<a)
          continue;
-      TSThread * thread = smRotationThreads[nodeIndex];
+      TSThread * thread = mWorkspace->rotationThreads[nodeIndex];
       thread = thread && thread->transitionData.inTransition ? thread : NULL;
       if (!thread)
       {
@@ -347,7 +349,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
          AssertFatal(thread!=NULL,"TSShapeInstance::handleRotTransitionNodes (rotation)");
       }
       QuatF tmpQ;
-      TSTransform::interpolate(mNodeReferenceRotations[nodeIndex].getQuatF(&tmpQ),smNodeCurrentRotations[nodeIndex],thread->transitionData.pos,&smNodeCurrentRotations[nodeIndex]);
+      TSTransform::interpolate(mNodeReferenceRotations[nodeIndex].getQuatF(&tmpQ),mWorkspace->nodeCurrentRotations[nodeIndex],thread->transitionData.pos,&mWorkspace->nodeCurrentRotations[nodeIndex]);
    }
 
    // then translation
@@ -355,7 +357,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    end   = b;
    for (nodeIndex=start; nodeIndex<end; mTransitionTranslationNodes.next(nodeIndex))
    {
-      TSThread * thread = smTranslationThreads[nodeIndex];
+      TSThread * thread = mWorkspace->translationThreads[nodeIndex];
       thread = thread && thread->transitionData.inTransition ? thread : NULL;
       if (!thread)
       {
@@ -372,7 +374,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
          }
          AssertFatal(thread!=NULL,"TSShapeInstance::handleTransitionNodes (translation).");
       }
-      Point3F & p = smNodeCurrentTranslations[nodeIndex];
+      Point3F & p = mWorkspace->nodeCurrentTranslations[nodeIndex];
       Point3F & p1 = mNodeReferenceTranslations[nodeIndex];
       Point3F & p2 = p;
       F32 k = thread->transitionData.pos;
@@ -388,7 +390,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
       end   = b;
       for (nodeIndex=start; nodeIndex<end; mTransitionScaleNodes.next(nodeIndex))
       {
-         TSThread * thread = smScaleThreads[nodeIndex];
+         TSThread * thread = mWorkspace->scaleThreads[nodeIndex];
          thread = thread && thread->transitionData.inTransition ? thread : NULL;
          if (!thread)
          {
@@ -406,14 +408,14 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
             AssertFatal(thread!=NULL,"TSShapeInstance::handleTransitionNodes (scale).");
          }
          if (animatesUniformScale())
-            smNodeCurrentUniformScales[nodeIndex] += thread->transitionData.pos * (mNodeReferenceUniformScales[nodeIndex]-smNodeCurrentUniformScales[nodeIndex]);
+            mWorkspace->nodeCurrentUniformScales[nodeIndex] += thread->transitionData.pos * (mNodeReferenceUniformScales[nodeIndex]-mWorkspace->nodeCurrentUniformScales[nodeIndex]);
          else if (animatesAlignedScale())
-            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],smNodeCurrentAlignedScales[nodeIndex],thread->transitionData.pos,&smNodeCurrentAlignedScales[nodeIndex]);
+            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],mWorkspace->nodeCurrentAlignedScales[nodeIndex],thread->transitionData.pos,&mWorkspace->nodeCurrentAlignedScales[nodeIndex]);
          else
          {
             QuatF q;
-            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],smNodeCurrentArbitraryScales[nodeIndex].mScale,thread->transitionData.pos,&smNodeCurrentArbitraryScales[nodeIndex].mScale);
-            TSTransform::interpolate(mNodeReferenceArbitraryScaleRots[nodeIndex].getQuatF(&q),smNodeCurrentArbitraryScales[nodeIndex].mRotate,thread->transitionData.pos,&smNodeCurrentArbitraryScales[nodeIndex].mRotate);
+            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],mWorkspace->nodeCurrentArbitraryScales[nodeIndex].mScale,thread->transitionData.pos,&mWorkspace->nodeCurrentArbitraryScales[nodeIndex].mScale);
+            TSTransform::interpolate(mNodeReferenceArbitraryScaleRots[nodeIndex].getQuatF(&q),mWorkspace->nodeCurrentArbitraryScales[nodeIndex].mRotate,thread->transitionData.pos,&mWorkspace->nodeCurrentArbitraryScales[nodeIndex].mRotate);
          }
       }
    }
@@ -423,15 +425,15 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    end   = b;
    for (nodeIndex=start; nodeIndex<end; transitionNodes.next(nodeIndex))
    {
-      TSTransform::setMatrix(smNodeCurrentRotations[nodeIndex], smNodeCurrentTranslations[nodeIndex], &smNodeLocalTransforms[nodeIndex]);
+      TSTransform::setMatrix(mWorkspace->nodeCurrentRotations[nodeIndex], mWorkspace->nodeCurrentTranslations[nodeIndex], &mWorkspace->nodeLocalTransforms[nodeIndex]);
       if (scaleCurrentlyAnimated())
       {
          if (animatesUniformScale())
-            TSTransform::applyScale(smNodeCurrentUniformScales[nodeIndex],&smNodeLocalTransforms[nodeIndex]);
+            TSTransform::applyScale(mWorkspace->nodeCurrentUniformScales[nodeIndex],&mWorkspace->nodeLocalTransforms[nodeIndex]);
          else if (animatesAlignedScale())
-               TSTransform::applyScale(smNodeCurrentAlignedScales[nodeIndex],&smNodeLocalTransforms[nodeIndex]);
+               TSTransform::applyScale(mWorkspace->nodeCurrentAlignedScales[nodeIndex],&mWorkspace->nodeLocalTransforms[nodeIndex]);
          else
-            TSTransform::applyScale(smNodeCurrentArbitraryScales[nodeIndex],&smNodeLocalTransforms[nodeIndex]);
+            TSTransform::applyScale(mWorkspace->nodeCurrentArbitraryScales[nodeIndex],&mWorkspace->nodeLocalTransforms[nodeIndex]);
       }
    }
 }
@@ -442,24 +444,24 @@ void TSShapeInstance::handleNodeScale(S32 a, S32 b)
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentUniformScales[i],&smNodeLocalTransforms[i]);
+            TSTransform::applyScale(mWorkspace->nodeCurrentUniformScales[i],&mWorkspace->nodeLocalTransforms[i]);
    }
    else if (animatesAlignedScale())
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentAlignedScales[i],&smNodeLocalTransforms[i]);
+            TSTransform::applyScale(mWorkspace->nodeCurrentAlignedScales[i],&mWorkspace->nodeLocalTransforms[i]);
    }
    else
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentArbitraryScales[i],&smNodeLocalTransforms[i]);
+            TSTransform::applyScale(mWorkspace->nodeCurrentArbitraryScales[i],&mWorkspace->nodeLocalTransforms[i]);
    }
 
    TSIntegerSet scaledNodes;
    scaledNodes.difference(mHandsOffNodes);
-   smNodeLocalTransformDirty.overlap(scaledNodes);
+   mWorkspace->nodeLocalTransformDirty.overlap(scaledNodes);
 }
 
 void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSIntegerSet & scaleBeenSet)
@@ -527,28 +529,28 @@ void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSInt
          {
             case 0:  // uniform -> uniform
             {
-               smNodeCurrentUniformScales[nodeIndex] = uniformScale;
+               mWorkspace->nodeCurrentUniformScales[nodeIndex] = uniformScale;
                break;
             }
             case 4:  // uniform -> aligned
             case 5:  // aligned -> aligned
-               smNodeCurrentAlignedScales[nodeIndex] = alignedScale;
+               mWorkspace->nodeCurrentAlignedScales[nodeIndex] = alignedScale;
                break;
             case 8:  // uniform -> arbitrary
             case 9:  // aligned -> arbitrary
             {
-               smNodeCurrentArbitraryScales[nodeIndex].identity();
-               smNodeCurrentArbitraryScales[nodeIndex].mScale = alignedScale;
+               mWorkspace->nodeCurrentArbitraryScales[nodeIndex].identity();
+               mWorkspace->nodeCurrentArbitraryScales[nodeIndex].mScale = alignedScale;
                break;
             }
             case 10: // arbitrary -> arbitary
             {
-               smNodeCurrentArbitraryScales[nodeIndex] = arbitraryScale;
+               mWorkspace->nodeCurrentArbitraryScales[nodeIndex] = arbitraryScale;
                break;
             }
             default: AssertFatal(0,"TSShapeInstance::handleAnimatedScale"); break;
          }
-         smScaleThreads[nodeIndex] = thread;
+         mWorkspace->scaleThreads[nodeIndex] = thread;
          scaleBeenSet.set(nodeIndex);
       }
    }
@@ -562,13 +564,13 @@ void TSShapeInstance::handleMaskedPositionNode(TSThread * th, S32 nodeIndex, S32
    TSTransform::interpolate(p1,p2,th->keyPos,&p);
 
    if (!mMaskPosXNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].x = p.x;
+      mWorkspace->nodeCurrentTranslations[nodeIndex].x = p.x;
 
    if (!mMaskPosYNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].y = p.y;
+      mWorkspace->nodeCurrentTranslations[nodeIndex].y = p.y;
 
    if (!mMaskPosZNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].z = p.z;
+      mWorkspace->nodeCurrentTranslations[nodeIndex].z = p.z;
 }
 
 void TSShapeInstance::handleBlendSequence(TSThread * thread, S32 a, S32 b)
@@ -648,8 +650,8 @@ void TSShapeInstance::handleBlendSequence(TSThread * thread, S32 a, S32 b)
       }
 
       // apply blend transform
-      smNodeLocalTransforms[nodeIndex].mul(mat);
-      smNodeLocalTransformDirty.set(nodeIndex);
+      mWorkspace->nodeLocalTransforms[nodeIndex].mul(mat);
+      mWorkspace->nodeLocalTransformDirty.set(nodeIndex);
    }
 }
 
@@ -906,6 +908,135 @@ void TSShapeInstance::animateSubtrees(bool forceFull)
    }
 }
 
+//-------------------------------------------------------------------------------------
+// Threaded animation
+//-------------------------------------------------------------------------------------
+
+bool TSShapeInstance::smThreadedAnimation = true;
+
+/// Number of shapes animated by one job.
+static const U32 sShapesPerAnimateJob = 8;
+
+static bool sAnimateBatch = false;
+
+/// Shapes queued since beginAnimateBatch().
+static Vector<TSShapeInstance*> sAnimateQueue;
+
+/// Workspaces for the animation jobs, kept from batch to batch.
+static Vector<TSShapeInstance::NodeWorkspace*> sAnimateWorkspaces;
+
+/// Animates the queued shapes in chunks of sShapesPerAnimateJob.  Each
+/// chunk has its own workspace since chunks run concurrently.
+struct TSShapeInstance::AnimateJob : public ThreadPoolTaskSet
+{
+   TSShapeInstance * const *mShapes;
+   U32 mCount;
+   NodeWorkspace * const *mWorkspaces;
+   U32 mTime;
+
+   AnimateJob( TSShapeInstance * const *shapes, U32 count, NodeWorkspace * const *workspaces, U32 time )
+      : ThreadPoolTaskSet( ( count + sShapesPerAnimateJob - 1 ) / sShapesPerAnimateJob ),
+        mShapes( shapes ),
+        mCount( count ),
+        mWorkspaces( workspaces ),
+        mTime( time )
+   {
+   }
+
+protected:
+   virtual void runTask( U32 index )
+   {
+      const U32 first = index * sShapesPerAnimateJob;
+      const U32 last = getMin( first + sShapesPerAnimateJob, mCount );
+      for ( U32 i = first; i < last; i++ )
+         mShapes[i]->animateBatched( *mWorkspaces[index], mTime );
+   }
+};
+
+void TSShapeInstance::beginAnimateBatch()
+{
+   AssertFatal( !sAnimateBatch, "TSShapeInstance::beginAnimateBatch - already batching" );
+   sAnimateBatch = smThreadedAnimation;
+}
+
+void TSShapeInstance::endAnimateBatch()
+{
+   PROFILE_SCOPE( TSShapeInstance_endAnimateBatch );
+
+   sAnimateBatch = false;
+   if ( sAnimateQueue.empty() )
+      return;
+
+   const U32 numJobs = ( sAnimateQueue.size() + sShapesPerAnimateJob - 1 ) / sShapesPerAnimateJob;
+   while ( sAnimateWorkspaces.size() < numJobs )
+      sAnimateWorkspaces.push_back( new NodeWorkspace );
+
+   ThreadSafeRef< AnimateJob > job( new AnimateJob( sAnimateQueue.address(), sAnimateQueue.size(), sAnimateWorkspaces.address(), Sim::getCurrentTime() ) );
+   job->run();
+
+   for ( U32 i = 0; i < sAnimateQueue.size(); i++ )
+      sAnimateQueue[i]->mAnimateQueued = false;
+   sAnimateQueue.clear();
+}
+
+void TSShapeInstance::_onAnimationBatch( bool begin, bool &outPrepAnimations )
+{
+   if ( begin )
+   {
+      beginAnimateBatch();
+      outPrepAnimations |= smThreadedAnimation;
+   }
+   else
+      endAnimateBatch();
+}
+
+void TSShapeInstance::queueAnimate()
+{
+   // Node callbacks are game code and have to run on the main thread.
+   if ( !sAnimateBatch || mNodeCallbacks.size() )
+   {
+      animate();
+      return;
+   }
+
+   if ( mAnimateQueued || mCurrentDetailLevel < 0 )
+      return;
+
+   const TSDetail &detail = mShape->details[mCurrentDetailLevel];
+   const S32 ss = detail.subShapeNum;
+
+   // Billboards have nothing to animate.
+   if ( ss < 0 )
+      return;
+
+   // The skins share their source data between instances
+   // so it has to be set up before the jobs start.
+   const S32 start = mShape->subShapeFirstObject[ss];
+   const S32 end = start + mShape->subShapeNumObjects[ss];
+   for ( S32 i = start; i < end; i++ )
+   {
+      TSMesh *mesh = mMeshObjects[i].getMesh( detail.objectDetailNum );
+      if ( mesh && mesh->getMeshType() == TSMesh::SkinMeshType )
+         static_cast<TSSkinMesh*>( mesh )->initSkin();
+   }
+
+   mAnimateQueued = true;
+   sAnimateQueue.push_back( this );
+}
+
+void TSShapeInstance::animateBatched( NodeWorkspace &workspace, U32 time )
+{
+   mWorkspace = &workspace;
+   animate();
+   mWorkspace = &smMainWorkspace;
+
+   const TSDetail &detail = mShape->details[mCurrentDetailLevel];
+   const S32 start = mShape->subShapeFirstObject[detail.subShapeNum];
+   const S32 end = start + mShape->subShapeNumObjects[detail.subShapeNum];
+   for ( S32 i = start; i < end; i++ )
+      mMeshObjects[i].skin( detail.objectDetailNum, time, workspace.boneTransforms );
+}
+
 void TSShapeInstance::addPath(TSThread *gt, F32 start, F32 end, MatrixF *mat)
 {
    // never get here while in transition...
@@ -1202,18 +1202,75 @@ void TSSkinMesh::updateSkin( const Vector<MatrixF> &transforms, TSVertexBufferHa
 #endif
 
    static Vector<MatrixF> sBoneTransforms;
-   sBoneTransforms.setSize( batchData.nodeIndex.size() );
+   const MatrixF * matrices = _computeBoneTransforms( transforms, sBoneTransforms );
+
+   U8 *outPtr = reinterpret_cast<U8 *>(mVertexData.address());
+   dsize_t outStride = mVertexData.vertSize();
+
+#if defined(USE_MEM_VERTEX_BUFFERS)
+   const bool bBatchByVert = !batchData.vertexBatchOperations.empty();
+   if ( !bBatchByVert )
+   {
+      // Initialize it if NULL. 
+      // Skinning includes readbacks from memory (argh) so don't allocate with PAGE_WRITECOMBINE
+      if( instanceVB.isNull() )
+         instanceVB.set( GFX, outStride, mVertexFormat, mNumVerts, GFXBufferTypeDynamic );
+
+      // Grow if needed
+      if( instanceVB.getPointer()->mNumVerts < mNumVerts )
+         instanceVB.resize( mNumVerts );
+
+      // Lock, and skin directly into the final memory destination
+      outPtr = (U8 *)instanceVB.lock();
+      if(!outPtr) return;
+   }
+#endif
+
+   _skin( matrices, outPtr, outStride );
+
+#if defined(USE_MEM_VERTEX_BUFFERS)
+   if ( !bBatchByVert )
+      instanceVB.unlock();
+#endif
+}
+
+void TSSkinMesh::updateSkin( const Vector<MatrixF> &transforms, TSMeshVertexArray &vertexData, Vector<MatrixF> &boneTransforms )
+{
+   PROFILE_SCOPE( TSSkinMesh_UpdateInstanceSkin );
+
+   AssertFatal( batchDataInitialized && mVertexData.isReady(), "TSSkinMesh::updateSkin - call initSkin() first." );
+
+   // Start from a copy of the mesh vertices so that the
+   // texture coordinates and tangents are there as well.
+   if ( vertexData.size() != mVertexData.size() || vertexData.vertSize() != mVertexData.vertSize() )
+   {
+      void *mem = dMalloc_aligned( mVertexData.mem_size(), 16 );
+      dMemcpy( mem, mVertexData.address(), mVertexData.mem_size() );
+      vertexData.set( mem, mVertexData.vertSize(), mVertexData.size() );
+      vertexData.setReady( true );
+   }
+
+   const MatrixF * matrices = _computeBoneTransforms( transforms, boneTransforms );
+   _skin( matrices, reinterpret_cast<U8 *>(vertexData.address()), vertexData.vertSize() );
+}
+
+const MatrixF* TSSkinMesh::_computeBoneTransforms( const Vector<MatrixF> &transforms, Vector<MatrixF> &boneTransforms )
+{
+   PROFILE_SCOPE(TSSkinMesh_UpdateTransforms);
+
+   boneTransforms.setSize( batchData.nodeIndex.size() );
 
    // set up bone transforms
-   PROFILE_START(TSSkinMesh_UpdateTransforms);
    for( S32 i=0; i<batchData.nodeIndex.size(); i++ )
    {
       S32 node = batchData.nodeIndex[i];
-      sBoneTransforms[i].mul( transforms[node], batchData.initialTransforms[i] );
+      boneTransforms[i].mul( transforms[node], batchData.initialTransforms[i] );
    }
-   const MatrixF * matrices = &sBoneTransforms[0];
-   PROFILE_END();
+   return boneTransforms.address();
+}
 
+void TSSkinMesh::_skin( const MatrixF *matrices, U8 *outPtr, dsize_t outStride )
+{
    // Perform skinning
    const bool bBatchByVert = !batchData.vertexBatchOperations.empty();
    if(bBatchByVert)
@@ -1250,30 +1307,27 @@ void TSSkinMesh::updateSkin( const Vector<MatrixF> &transforms, TSVertexBufferHa
          }
 
          // Assign results 
-         __TSMeshVertexBase &dest = mVertexData[curVert.vertexIndex];
+         __TSMeshVertexBase &dest = *reinterpret_cast<__TSMeshVertexBase *>(outPtr + curVert.vertexIndex * outStride);
          dest.vert(skinnedVert);
          dest.normal(skinnedNorm);
       }
    }
-   else // Batch by transform
+   else if ( m_matF_x_BatchedVertWeightSoA )
    {
-      U8 *outPtr = reinterpret_cast<U8 *>(mVertexData.address());
-      dsize_t outStride = mVertexData.vertSize();
+      // Set position/normal/tangent to zero so we can accumulate
+      zero_vert_normal_tangent_bulk(mNumVerts, outPtr, outStride);
 
-#if defined(USE_MEM_VERTEX_BUFFERS)
-      // Initialize it if NULL. 
-      // Skinning includes readbacks from memory (argh) so don't allocate with PAGE_WRITECOMBINE
-      if( instanceVB.isNull() )
-         instanceVB.set( GFX, outStride, mVertexFormat, mNumVerts, GFXBufferTypeDynamic );
-
-      // Grow if needed
-      if( instanceVB.getPointer()->mNumVerts < mNumVerts )
-         instanceVB.resize( mNumVerts );
+      for(Vector<S32>::const_iterator itr = batchData.transformKeys.begin();
+          itr != batchData.transformKeys.end(); itr++)
+      {
+         const S32 boneXfmIdx = *itr;
+         const BatchData::BatchedTransform &curTransform = *batchData.transformBatchOperations.retreive(boneXfmIdx);
 
-      // Lock, and skin directly into the final memory destination
-      outPtr = (U8 *)instanceVB.lock();
-      if(!outPtr) return;
-#endif
+         m_matF_x_BatchedVertWeightSoA(matrices[boneXfmIdx], curTransform.soa, outPtr, outStride);
+      }
+   }
+   else // Batch by transform
+   {
       // Set position/normal to zero so we can accumulate
       zero_vert_normal_bulk(mNumVerts, outPtr, outStride);
 
@@ -1290,9 +1344,6 @@ void TSSkinMesh::updateSkin( const Vector<MatrixF> &transforms, TSVertexBufferHa
          m_matF_x_BatchedVertWeightList(curBoneMat, numVerts, curTransform.alignedMem,
             outPtr, outStride);
       }
-#if defined(USE_MEM_VERTEX_BUFFERS)
-      instanceVB.unlock();
-#endif
    }
 }
 
@@ -1470,9 +1521,63 @@ void TSSkinMesh::createBatchData()
       BatchData::BatchedTransform &curTransform = *batchData.transformBatchOperations.retreive(batchData.transformKeys[i]);
       dQsort(curTransform.alignedMem, curTransform.numElements, sizeof(BatchData::BatchedVertWeight), _sort_BatchedVertWeight);
    }
+
+   // The wide kernels skin the tangents too, so they need the bind pose
+   // tangents which are only kept in the vertex data.
+   if ( m_matF_x_BatchedVertWeightSoA && numBatchOps > 0 )
+   {
+      AssertFatal( mVertexData.isReady() && mVertexData.size() == mNumVerts, "TSSkinMesh::createBatchData - vertex data not initialized." );
+
+      Vector<Point3F> initialTangents( mNumVerts );
+      initialTangents.setSize( mNumVerts );
+      for ( S32 i = 0; i < mNumVerts; i++ )
+         initialTangents[i] = mVertexData[i]._tangent;
+
+      for ( S32 i = 0; i < numBatchOps; i++ )
+      {
+         BatchData::BatchedTransform &curTransform = *batchData.transformBatchOperations.retreive(batchData.transformKeys[i]);
+         curTransform.soa.set( curTransform.alignedMem, curTransform.numElements, initialTangents.address() );
+      }
+   }
 #endif
 }
 
+void TSSkinMesh::BatchData::BatchedVertWeightSoA::set( const BatchedVertWeight *batch, dsize_t count, const Point3F *tangents )
+{
+   if ( mMem )
+      dFree_aligned( mMem );
+
+   // Ten float arrays and the vertex indices, each padded out to Width.
+   const dsize_t padded = ( count + Width - 1 ) & ~dsize_t( Width - 1 );
+   const dsize_t arraySize = padded * sizeof( F32 );
+   mMem = dMalloc_aligned( arraySize * 11, 32 );
+   AssertFatal( mMem, "Aligned malloc failed! Debug!" );
+   dMemset( mMem, 0, arraySize * 11 );
+
+   F32 **arrays[] = { &vx, &vy, &vz, &nx, &ny, &nz, &tx, &ty, &tz, &weight };
+   U8 *mem = reinterpret_cast<U8 *>( mMem );
+   for ( U32 i = 0; i < 10; i++, mem += arraySize )
+      *arrays[i] = reinterpret_cast<F32 *>( mem );
+   vidx = reinterpret_cast<S32 *>( mem );
+
+   numElements = count;
+   for ( dsize_t i = 0; i < count; i++ )
+   {
+      const BatchedVertWeight &elem = batch[i];
+      vx[i] = elem.vert.x;
+      vy[i] = elem.vert.y;
+      vz[i] = elem.vert.z;
+      nx[i] = elem.normal.x;
+      ny[i] = elem.normal.y;
+      nz[i] = elem.normal.z;
+      tx[i] = tangents[elem.vidx].x;
+      ty[i] = tangents[elem.vidx].y;
+      tz[i] = tangents[elem.vidx].z;
+      weight[i] = elem.weight;
+      vidx[i] = elem.vidx;
+   }
+}
+
 void TSSkinMesh::render( TSVertexBufferHandle &instanceVB, GFXPrimitiveBufferHandle &instancePB )
 {
    innerRender( instanceVB, instancePB );
@@ -1490,14 +1595,7 @@ void TSSkinMesh::render(   TSMaterialList *materials,
    if( mNumVerts == 0 )
       return;
 
-   // Initialize the vertex data if it needs it
-   if(!mVertexData.isReady() )
-      _convertToAlignedMeshData(mVertexData, batchData.initialVerts, batchData.initialNorms);
-   AssertFatal(mVertexData.size() == mNumVerts, "Vert # mismatch");
-
-   // Initialize the skin batch if that isn't ready
-   if(!batchDataInitialized)
-      createBatchData();
+   initSkin();
 
    const bool vertsChanged = vertexBuffer.isNull() || vertexBuffer->mNumVerts != mNumVerts;
    const bool primsChanged = primitiveBuffer.isNull() || primitiveBuffer->mIndexCount != indices.size();
@@ -1515,6 +1613,42 @@ void TSSkinMesh::render(   TSMaterialList *materials,
    innerRender( materials, rdata, vertexBuffer, primitiveBuffer );   
 }
 
+void TSSkinMesh::render(   TSMaterialList *materials, 
+                           const TSRenderState &rdata,
+                           bool isSkinDirty,
+                           const TSMeshVertexArray &skinnedVerts, 
+                           TSVertexBufferHandle &vertexBuffer,
+                           GFXPrimitiveBufferHandle &primitiveBuffer )
+{
+   PROFILE_SCOPE(TSSkinMesh_renderSkinned);
+
+   if( mNumVerts == 0 )
+      return;
+
+   AssertFatal( skinnedVerts.size() == mNumVerts, "TSSkinMesh::render - Vert # mismatch" );
+
+   const bool vertsChanged = vertexBuffer.isNull() || vertexBuffer->mNumVerts != mNumVerts;
+   const bool primsChanged = primitiveBuffer.isNull() || primitiveBuffer->mIndexCount != indices.size();
+
+   // The skinning is done, we only have to upload it.
+   if ( primsChanged || vertsChanged || isSkinDirty )
+      _createVBIB( skinnedVerts, vertexBuffer, primitiveBuffer );
+
+   innerRender( materials, rdata, vertexBuffer, primitiveBuffer );   
+}
+
+void TSSkinMesh::initSkin()
+{
+   // Initialize the vertex data if it needs it
+   if(!mVertexData.isReady() )
+      _convertToAlignedMeshData(mVertexData, batchData.initialVerts, batchData.initialNorms);
+   AssertFatal(mVertexData.size() == mNumVerts, "Vert # mismatch");
+
+   // Initialize the skin batch if that isn't ready
+   if(!batchDataInitialized)
+      createBatchData();
+}
+
 bool TSSkinMesh::buildPolyList( S32 frame, AbstractPolyList *polyList, U32 &surfaceKey, TSMaterialList *materials )
 {
    // UpdateSkin() here may not be needed... 
@@ -2370,7 +2504,12 @@ void TSMesh::createVBIB()
 
 void TSMesh::_createVBIB( TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb )
 {
-   AssertFatal(mVertexData.isReady(), "Call convertToAlignedMeshData() before calling _createVBIB()");
+   _createVBIB( mVertexData, vb, pb );
+}
+
+void TSMesh::_createVBIB( const TSMeshVertexArray &vertexData, TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb )
+{
+   AssertFatal(vertexData.isReady(), "Call convertToAlignedMeshData() before calling _createVBIB()");
 
    if ( mNumVerts == 0 || !GFXDevice::devicePresent() )
       return;
@@ -2400,9 +2539,9 @@ void TSMesh::_createVBIB( TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb
       U8 *vertData = (U8*)vb.lock();
       if(!vertData) return;
 #if defined(TORQUE_OS_XENON)
-      XMemCpyStreaming_WriteCombined( vertData, mVertexData.address(), mVertexData.mem_size() );
+      XMemCpyStreaming_WriteCombined( vertData, vertexData.address(), vertexData.mem_size() );
 #else
-      dMemcpy( vertData, mVertexData.address(), mVertexData.mem_size() );
+      dMemcpy( vertData, vertexData.address(), vertexData.mem_size() );
 #endif
       vb.unlock();
 #if defined(USE_MEM_VERTEX_BUFFERS)
@@ -121,6 +121,7 @@ class TSMesh
 
    void _convertToAlignedMeshData( TSMeshVertexArray &vertexData, const Vector<Point3F> &_verts, const Vector<Point3F> &_norms );
    void _createVBIB( TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb );
+   void _createVBIB( const TSMeshVertexArray &vertexData, TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb );
 
   public:
 
@@ -463,12 +464,38 @@ public:
 
       #pragma pack()
 
+      /// The same list as structure-of-arrays, plus the bind pose tangents,
+      /// for the wide skinning kernels.  The arrays are 32 byte aligned and
+      /// padded with zero weights to a multiple of Width elements.
+      struct BatchedVertWeightSoA
+      {
+         enum { Width = 8 };
+
+         F32 *vx, *vy, *vz;
+         F32 *nx, *ny, *nz;
+         F32 *tx, *ty, *tz;
+         F32 *weight;
+         S32 *vidx;
+         dsize_t numElements;
+
+         BatchedVertWeightSoA() : numElements(0), mMem(NULL) {}
+         ~BatchedVertWeightSoA() { if(mMem) dFree_aligned(mMem); }
+
+         /// Fill the arrays from @a count elements of @a batch.
+         /// @a tangents is indexed by BatchedVertWeight::vidx.
+         void set( const BatchedVertWeight *batch, dsize_t count, const Point3F *tangents );
+
+      protected:
+         void *mMem;
+      };
+
       struct BatchedTransform
       {
       public:
          BatchedVertWeight *alignedMem;
          dsize_t numElements;
          Vector<BatchedVertWeight> *_tmpVec;
+         BatchedVertWeightSoA soa;
 
          BatchedTransform() : alignedMem(NULL), numElements(0), _tmpVec(NULL) {}
          virtual ~BatchedTransform() 
@@ -497,6 +524,12 @@ public:
    void createBatchData();
    virtual void convertToAlignedMeshData();
 
+   /// Returns the bone transforms for @a transforms, computed into @a boneTransforms.
+   const MatrixF* _computeBoneTransforms( const Vector<MatrixF> &transforms, Vector<MatrixF> &boneTransforms );
+
+   /// Skin into vertex memory laid out like mVertexData.
+   void _skin( const MatrixF *boneTransforms, U8 *outPtr, dsize_t outStride );
+
 public:
    typedef TSMesh Parent;
 
@@ -512,6 +545,15 @@ public:
    /// set verts and normals...
    void updateSkin( const Vector<MatrixF> &transforms, TSVertexBufferHandle &instanceVB, GFXPrimitiveBufferHandle &instancePB );
 
+   /// Set the verts and normals of @a vertexData, a per-instance copy of the
+   /// vertex data, using @a boneTransforms as scratch space.  The mesh itself
+   /// isn't touched, so once initSkin() was called several instances can be
+   /// skinned at the same time.
+   void updateSkin( const Vector<MatrixF> &transforms, TSMeshVertexArray &vertexData, Vector<MatrixF> &boneTransforms );
+
+   /// Builds the aligned vertex data and the skin batch if needed.
+   void initSkin();
+
    // render methods..
    void render( TSVertexBufferHandle &instanceVB, GFXPrimitiveBufferHandle &instancePB );
    void render(   TSMaterialList *, 
@@ -521,6 +563,14 @@ public:
                   TSVertexBufferHandle &vertexBuffer,
                   GFXPrimitiveBufferHandle &primitiveBuffer );
 
+   /// Render using vertices skinned by the per-instance updateSkin().
+   void render(   TSMaterialList *, 
+                  const TSRenderState &data,
+                  bool isSkinDirty,
+                  const TSMeshVertexArray &skinnedVerts, 
+                  TSVertexBufferHandle &vertexBuffer,
+                  GFXPrimitiveBufferHandle &primitiveBuffer );
+
    // collision methods...
    bool buildPolyList( S32 frame, AbstractPolyList *polyList, U32 &surfaceKey, TSMaterialList *materials );
    bool castRay( S32 frame, const Point3F &start, const Point3F &end, RayInfo *rayInfo, TSMaterialList *materials );
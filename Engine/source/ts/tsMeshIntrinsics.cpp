@@ -27,6 +27,8 @@
 
 void (*zero_vert_normal_bulk)(const dsize_t count, U8 * __restrict const outPtr, const dsize_t outStride) = NULL;
 void (*m_matF_x_BatchedVertWeightList)(const MatrixF &mat, const dsize_t count, const TSSkinMesh::BatchData::BatchedVertWeight * __restrict batch, U8 * const __restrict outPtr, const dsize_t outStride) = NULL;
+void (*zero_vert_normal_tangent_bulk)(const dsize_t count, U8 * __restrict const outPtr, const dsize_t outStride) = NULL;
+void (*m_matF_x_BatchedVertWeightSoA)(const MatrixF &mat, const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch, U8 * const __restrict outPtr, const dsize_t outStride) = NULL;
 
 //------------------------------------------------------------------------------
 // Default C++ Implementations (pretty slow)
@@ -74,6 +76,54 @@ void m_matF_x_BatchedVertWeightList_C(const MatrixF &mat,
    }
 }
 
+//------------------------------------------------------------------------------
+
+void zero_vert_normal_tangent_bulk_C(const dsize_t count, U8 * __restrict const outPtr, const dsize_t outStride)
+{
+   char *outData = reinterpret_cast<char *>(outPtr);
+
+   for(S32 i = 0; i < count; i++)
+   {
+      TSMesh::__TSMeshVertexBase *outElem = reinterpret_cast<TSMesh::__TSMeshVertexBase *>(outData);
+      outElem->_vert.zero();
+      outElem->_normal.zero();
+      outElem->_tangent.zero();
+      outData += outStride;
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void m_matF_x_BatchedVertWeightSoA_C(const MatrixF &mat, 
+                                    const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch,
+                                    U8 * const __restrict outPtr,
+                                    const dsize_t outStride)
+{
+   const F32 *m = mat;
+
+   for(S32 i = 0; i < batch.numElements; i++)
+   {
+      TSMesh::__TSMeshVertexBase *outElem = reinterpret_cast<TSMesh::__TSMeshVertexBase *>(outPtr + batch.vidx[i] * outStride);
+      const F32 w = batch.weight[i];
+
+      // Same operation order as MatrixF::mulP/mulV so the kernels can match it.
+      const F32 vx = batch.vx[i], vy = batch.vy[i], vz = batch.vz[i];
+      outElem->_vert.x += ( m[0] * vx + m[1] * vy + m[2] * vz + m[3] ) * w;
+      outElem->_vert.y += ( m[4] * vx + m[5] * vy + m[6] * vz + m[7] ) * w;
+      outElem->_vert.z += ( m[8] * vx + m[9] * vy + m[10] * vz + m[11] ) * w;
+
+      const F32 nx = batch.nx[i], ny = batch.ny[i], nz = batch.nz[i];
+      outElem->_normal.x += ( m[0] * nx + m[1] * ny + m[2] * nz ) * w;
+      outElem->_normal.y += ( m[4] * nx + m[5] * ny + m[6] * nz ) * w;
+      outElem->_normal.z += ( m[8] * nx + m[9] * ny + m[10] * nz ) * w;
+
+      const F32 tx = batch.tx[i], ty = batch.ty[i], tz = batch.tz[i];
+      outElem->_tangent.x += ( m[0] * tx + m[1] * ty + m[2] * tz ) * w;
+      outElem->_tangent.y += ( m[4] * tx + m[5] * ty + m[6] * tz ) * w;
+      outElem->_tangent.z += ( m[8] * tx + m[9] * ty + m[10] * tz ) * w;
+   }
+}
+
 //------------------------------------------------------------------------------
 // Initializer.
 //------------------------------------------------------------------------------
@@ -87,11 +137,23 @@ MODULE_BEGIN( TSMeshIntrinsics )
       // Assign defaults (C++ versions)
       zero_vert_normal_bulk = zero_vert_normal_bulk_C;
       m_matF_x_BatchedVertWeightList = m_matF_x_BatchedVertWeightList_C;
+      zero_vert_normal_tangent_bulk = zero_vert_normal_tangent_bulk_C;
+      m_matF_x_BatchedVertWeightSoA = m_matF_x_BatchedVertWeightSoA_C;
 
    #if defined(TORQUE_OS_XENON)
+      // Keep the hand written batch-by-transform loop.
       zero_vert_normal_bulk = zero_vert_normal_bulk_X360;
       m_matF_x_BatchedVertWeightList = m_matF_x_BatchedVertWeightList_X360;
+      m_matF_x_BatchedVertWeightSoA = NULL;
    #else
+   #if defined(TORQUE_CPU_X86) || defined(TORQUE_CPU_X64)
+      // The wide kernels process 8 or 4 vertices at a time.
+      if(Platform::SystemInfo.processor.properties & CPU_PROP_AVX)
+         m_matF_x_BatchedVertWeightSoA = m_matF_x_BatchedVertWeightSoA_AVX;
+      else if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+         m_matF_x_BatchedVertWeightSoA = m_matF_x_BatchedVertWeightSoA_SSE;
+   #endif
+
       // Find the best implementation for the current CPU
       if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE)
       {
@@ -113,6 +175,7 @@ MODULE_BEGIN( TSMeshIntrinsics )
    #if !defined(TORQUE_OS_XENON) && defined(TORQUE_CPU_PPC)
          zero_vert_normal_bulk = zero_vert_normal_bulk_gccvec;
          m_matF_x_BatchedVertWeightList = m_matF_x_BatchedVertWeightList_gccvec;
+         m_matF_x_BatchedVertWeightSoA = NULL;
    #endif
       }
    #endif
@@ -47,5 +47,32 @@ extern void (*zero_vert_normal_bulk)
                            U8 * __restrict const outPtr, 
                            const dsize_t outStride);
 
+/// The structure-of-arrays skin loop, which also skins the tangents.  It
+/// is NULL if the platform only has the batch-by-transform loop above.
+///
+/// @param mat       Bone transform
+/// @param batch     The vertices and weights for the bone
+/// @param outPtr    Pointer to index 0 of a TSMesh aligned vertex buffer
+/// @param outStride Size, in bytes, of one entry in the vertex buffer
+extern void (*m_matF_x_BatchedVertWeightSoA)
+                                   (const MatrixF &mat,
+                                    const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch,
+                                    U8 * const __restrict outPtr,
+                                    const dsize_t outStride);
+
+/// Set the vertex position, normal and tangent to (0, 0, 0)
+///
+/// @param count     Number of elements
+/// @param outPtr    Pointer to a TSMesh aligned vertex buffer
+/// @param outStride Size, in bytes, of one entry in the vertex buffer
+extern void (*zero_vert_normal_tangent_bulk)
+                          (const dsize_t count, 
+                           U8 * __restrict const outPtr, 
+                           const dsize_t outStride);
+
+/// The C++ versions of the skin loops, the reference for the others.
+extern void m_matF_x_BatchedVertWeightList_C(const MatrixF &mat, const dsize_t count, const TSSkinMesh::BatchData::BatchedVertWeight * __restrict batch, U8 * const __restrict outPtr, const dsize_t outStride);
+extern void m_matF_x_BatchedVertWeightSoA_C(const MatrixF &mat, const TSSkinMesh::BatchData::BatchedVertWeightSoA &batch, U8 * const __restrict outPtr, const dsize_t outStride);
+
 #endif
 
@@ -71,6 +71,13 @@ MODULE_BEGIN( TSShapeInstance )
          "The default value is -1 which disables it.\n"
          "@ingroup Rendering\n" );
 
+      Con::addVariable("$pref::TS::threadedAnimation", TypeBool, &TSShapeInstance::smThreadedAnimation,
+         "@brief User perference which animates and skins visible shapes on the thread pool.\n"
+         "The default value is true.\n"
+         "@ingroup Rendering\n" );
+
+      SceneRenderState::getAnimationBatchSignal().notify( &TSShapeInstance::_onAnimationBatch );
+
       Con::addVariable("$pref::TS::maxInstancingVerts", TypeS32, &TSMesh::smMaxInstancingVerts,
          "@brief Enables mesh instancing on non-skin meshes that have less that this count of verts.\n"
          "The default value is 200.  Higher values can degrade performance.\n"
@@ -88,17 +95,7 @@ F32                           TSShapeInstance::smLastScreenErrorTolerance = 0.0f
 F32                           TSShapeInstance::smLastScaledDistance = 0.0f;
 F32                           TSShapeInstance::smLastPixelSize = 0.0f;
 
-Vector<QuatF>                 TSShapeInstance::smNodeCurrentRotations(__FILE__, __LINE__);
-Vector<Point3F>               TSShapeInstance::smNodeCurrentTranslations(__FILE__, __LINE__);
-Vector<F32>                   TSShapeInstance::smNodeCurrentUniformScales(__FILE__, __LINE__);
-Vector<Point3F>               TSShapeInstance::smNodeCurrentAlignedScales(__FILE__, __LINE__);
-Vector<TSScale>               TSShapeInstance::smNodeCurrentArbitraryScales(__FILE__, __LINE__);
-Vector<MatrixF>               TSShapeInstance::smNodeLocalTransforms(__FILE__, __LINE__);
-TSIntegerSet                  TSShapeInstance::smNodeLocalTransformDirty;
-
-Vector<TSThread*>             TSShapeInstance::smRotationThreads(__FILE__, __LINE__);
-Vector<TSThread*>             TSShapeInstance::smTranslationThreads(__FILE__, __LINE__);
-Vector<TSThread*>             TSShapeInstance::smScaleThreads(__FILE__, __LINE__);
+TSShapeInstance::NodeWorkspace TSShapeInstance::smMainWorkspace;
 
 //-------------------------------------------------------------------------------------
 // constructors, destructors, initialization
@@ -148,6 +145,8 @@ TSShapeInstance::~TSShapeInstance()
    setMaterialList(NULL);
 
    delete [] mDirtyFlags;
+
+   AssertFatal( !mAnimateQueued, "TSShapeInstance::~TSShapeInstance - deleted while queued for animation!" );
 }
 
 void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
@@ -174,6 +173,9 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
    mData = 0;
    mScaleCurrentlyAnimated = false;
 
+   mWorkspace = &smMainWorkspace;
+   mAnimateQueued = false;
+
    if(loadMaterials)
       setMaterialList(mShape->materialList);
 
@@ -751,12 +753,21 @@ void TSShapeInstance::MeshObjectInstance::render(  S32 objectDetail,
    const U32 currTime = Sim::getCurrentTime();
    bool isSkinDirty = currTime != mLastTime;
 
-   mesh->render(  materials, 
-                  rdata, 
-                  isSkinDirty,
-                  *mTransforms, 
-                  mVertexBuffer,
-                  mPrimitiveBuffer );
+   // An animation job may already have skinned the mesh for us.
+   if ( mSkinnedMesh == mesh && mSkinnedTime == currTime )
+      mSkinnedMesh->render(   materials,
+                              rdata,
+                              isSkinDirty,
+                              *mSkinnedVerts,
+                              mVertexBuffer,
+                              mPrimitiveBuffer );
+   else
+      mesh->render(  materials, 
+                     rdata, 
+                     isSkinDirty,
+                     *mTransforms, 
+                     mVertexBuffer,
+                     mPrimitiveBuffer );
 
    // Update the last render time.
    mLastTime = currTime;
@@ -766,10 +777,42 @@ void TSShapeInstance::MeshObjectInstance::render(  S32 objectDetail,
 
 TSShapeInstance::MeshObjectInstance::MeshObjectInstance() 
    : meshList(0), object(0), frame(0), matFrame(0),
-     visible(1.0f), forceHidden(false), mLastTime( 0 )
+     visible(1.0f), forceHidden(false), mLastTime( 0 ),
+     mSkinnedVerts( NULL ), mSkinnedMesh( NULL ), mSkinnedTime( 0 )
 {
 }
 
+TSShapeInstance::MeshObjectInstance::~MeshObjectInstance()
+{
+   delete mSkinnedVerts;
+}
+
+void TSShapeInstance::MeshObjectInstance::skin( S32 objectDetail, U32 time, Vector<MatrixF> &boneTransforms )
+{
+#if defined(USE_MEM_VERTEX_BUFFERS)
+   // Skins are written straight into the vertex buffer.
+   return;
+#endif
+
+   if ( forceHidden || visible <= 0.01f )
+      return;
+
+   TSMesh *mesh = getMesh( objectDetail );
+   if ( !mesh || mesh->getMeshType() != TSMesh::SkinMeshType )
+      return;
+
+   // Nothing to do if the skin was already updated at this time.
+   if ( mLastTime == time || ( mSkinnedMesh == mesh && mSkinnedTime == time ) )
+      return;
+
+   if ( !mSkinnedVerts )
+      mSkinnedVerts = new TSMesh::TSMeshVertexArray;
+
+   mSkinnedMesh = static_cast<TSSkinMesh*>( mesh );
+   mSkinnedMesh->updateSkin( *mTransforms, *mSkinnedVerts, boneTransforms );
+   mSkinnedTime = time;
+}
+
 void TSShapeInstance::prepCollision()
 {
    PROFILE_SCOPE( TSShapeInstance_PrepCollision );
@@ -165,11 +165,25 @@ class TSShapeInstance
       /// was last rendered.
       U32 mLastTime;
 
+      /// @name Batched Skinning
+      /// Vertices skinned by an animation job, the mesh they belong to
+      /// and the time they were skinned at.  They are uploaded instead of
+      /// skinning again when the mesh is rendered at that time.
+      /// @{
+      TSMesh::TSMeshVertexArray *mSkinnedVerts;
+      TSSkinMesh *mSkinnedMesh;
+      U32 mSkinnedTime;
+      /// @}
+
       MeshObjectInstance();
-      virtual ~MeshObjectInstance() {}
+      virtual ~MeshObjectInstance();
 
       void render( S32 objectDetail, TSMaterialList *, const TSRenderState &rdata, F32 alpha );
 
+      /// Skin the mesh of @a objectDetail into mSkinnedVerts if it is a
+      /// visible skin mesh.  Called from animation jobs.
+      void skin( S32 objectDetail, U32 time, Vector<MatrixF> &boneTransforms );
+
       /// Gets the mesh with specified detail level
       TSMesh * getMesh(S32 num) const { return num<object->numMeshes ? *(meshList+num) : NULL; }
 
@@ -218,24 +232,37 @@ class TSShapeInstance
    Vector<Quat16>         mNodeReferenceArbitraryScaleRots;
    /// @}
 
-   /// @name Workspace for Node Transforms
-   /// @{
-   static Vector<QuatF>   smNodeCurrentRotations;
-   static Vector<Point3F> smNodeCurrentTranslations;
-   static Vector<F32>     smNodeCurrentUniformScales;
-   static Vector<Point3F> smNodeCurrentAlignedScales;
-   static Vector<TSScale> smNodeCurrentArbitraryScales;
-   static Vector<MatrixF> smNodeLocalTransforms;
-   static TSIntegerSet    smNodeLocalTransformDirty;
-   /// @}
+   /// Scratch space used while animating a shape.  Shapes animated on the
+   /// main thread share smMainWorkspace, each animation job has its own.
+   struct NodeWorkspace
+   {
+      /// @name Workspace for Node Transforms
+      /// @{
+      Vector<QuatF>   nodeCurrentRotations;
+      Vector<Point3F> nodeCurrentTranslations;
+      Vector<F32>     nodeCurrentUniformScales;
+      Vector<Point3F> nodeCurrentAlignedScales;
+      Vector<TSScale> nodeCurrentArbitraryScales;
+      Vector<MatrixF> nodeLocalTransforms;
+      TSIntegerSet    nodeLocalTransformDirty;
+      /// @}
+
+      /// @name Threads
+      /// keep track of who controls what on currently animating shape
+      /// @{
+      Vector<TSThread*> rotationThreads;
+      Vector<TSThread*> translationThreads;
+      Vector<TSThread*> scaleThreads;
+      /// @}
+
+      /// Bone transforms for skinning.
+      Vector<MatrixF> boneTransforms;
+   };
 
-   /// @name Threads
-   /// keep track of who controls what on currently animating shape
-   /// @{
-   static Vector<TSThread*> smRotationThreads;
-   static Vector<TSThread*> smTranslationThreads;
-   static Vector<TSThread*> smScaleThreads;
-   /// @}
+   static NodeWorkspace smMainWorkspace;
+
+   /// The workspace used by the thread animating this shape.
+   NodeWorkspace *mWorkspace;
 	
 	TSMaterialList* mMaterialList;    ///< by default, points to hShape material list
 //-------------------------------------------------------------------------------------
@@ -278,6 +305,18 @@ protected:
 
    U32 debrisRefCount;
 
+   /// @name Threaded Animation
+   /// @{
+   struct AnimateJob;
+
+   /// True while the shape is queued for the current animation batch.
+   bool mAnimateQueued;
+
+   /// Animate the current detail level using @a workspace and skin its
+   /// visible meshes.  Runs on animation jobs.
+   void animateBatched( NodeWorkspace &workspace, U32 time );
+   /// @}
+
    // the threads...
    Vector<TSThread*> mThreadList;
    Vector<TSThread*> mTransitionThreads;
@@ -490,6 +529,28 @@ protected:
 
    void animate() { animate( mCurrentDetailLevel ); }
    void animate(S32 dl);
+
+   /// @name Threaded Animation
+   /// Shapes queued between beginAnimateBatch() and endAnimateBatch() are
+   /// animated on the ThreadPool.  Their visible skin meshes are skinned
+   /// into per-instance vertex arrays which render() uploads afterwards.
+   /// @{
+
+   /// Enables batched animation ($pref::TS::threadedAnimation).
+   static bool smThreadedAnimation;
+
+   static void beginAnimateBatch();
+   static void endAnimateBatch();
+
+   /// Opens and closes the batch around the prepAnimation() pass of
+   /// SceneRenderState::renderObjects().
+   static void _onAnimationBatch( bool begin, bool &outPrepAnimations );
+
+   /// Animate the current detail level.  If a batch is open this is put off
+   /// until endAnimateBatch().
+   void queueAnimate();
+
+   /// @}
    void animateNodes(S32 ss);
    void animateVisibility(S32 ss);
    void animateFrame(S32 ss);
@@ -661,14 +661,14 @@ void TSShapeInstance::updateTransitions()
    for (i=0; i<mShape->nodes.size(); i++)
    {
       if (mTransitionRotationNodes.test(i))
-         mNodeReferenceRotations[i].set(smNodeCurrentRotations[i]);
+         mNodeReferenceRotations[i].set(mWorkspace->nodeCurrentRotations[i]);
       if (mTransitionTranslationNodes.test(i))
-         mNodeReferenceTranslations[i] = smNodeCurrentTranslations[i];
+         mNodeReferenceTranslations[i] = mWorkspace->nodeCurrentTranslations[i];
    }
 
    if (animatesScale())
    {
-      // Make sure smNodeXXXScale arrays have been resized
+      // Make sure workspace scale arrays have been resized
       TSIntegerSet dummySet;
       handleDefaultScale(0, 0, dummySet);
 
@@ -678,7 +678,7 @@ void TSShapeInstance::updateTransitions()
          for (i=0; i<mShape->nodes.size(); i++)
          {
             if (mTransitionScaleNodes.test(i))
-               mNodeReferenceUniformScales[i] = smNodeCurrentUniformScales[i];
+               mNodeReferenceUniformScales[i] = mWorkspace->nodeCurrentUniformScales[i];
          }
       }
       else if (animatesAlignedScale())
@@ -687,7 +687,7 @@ void TSShapeInstance::updateTransitions()
          for (i=0; i<mShape->nodes.size(); i++)
          {
             if (mTransitionScaleNodes.test(i))
-               mNodeReferenceScaleFactors[i] = smNodeCurrentAlignedScales[i];
+               mNodeReferenceScaleFactors[i] = mWorkspace->nodeCurrentAlignedScales[i];
          }
       }
       else
@@ -698,8 +698,8 @@ void TSShapeInstance::updateTransitions()
          {
             if (mTransitionScaleNodes.test(i))
             {
-               mNodeReferenceScaleFactors[i] = smNodeCurrentArbitraryScales[i].mScale;
-               mNodeReferenceArbitraryScaleRots[i].set(smNodeCurrentArbitraryScales[i].mRotate);
+               mNodeReferenceScaleFactors[i] = mWorkspace->nodeCurrentArbitraryScales[i].mScale;
+               mNodeReferenceArbitraryScaleRots[i].set(mWorkspace->nodeCurrentArbitraryScales[i].mRotate);
             }
          }
       }
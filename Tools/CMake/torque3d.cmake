@@ -173,8 +173,10 @@ addPath("${srcDir}/sfx")
 addPath("${srcDir}/component")
 addPath("${srcDir}/component/interfaces")
 addPath("${srcDir}/console")
+addPath("${srcDir}/console/test")
 addPath("${srcDir}/core")
 addPath("${srcDir}/core/stream")
+addPath("${srcDir}/core/stream/test")
 addPath("${srcDir}/core/strings")
 addPath("${srcDir}/core/util")
 addPath("${srcDir}/core/util/test")
@@ -211,6 +213,7 @@ addPath("${srcDir}/gfx/Null")
 addPath("${srcDir}/gfx/test")
 addPath("${srcDir}/gfx/bitmap")
 addPath("${srcDir}/gfx/bitmap/loaders")
+addPath("${srcDir}/gfx/bitmap/test")
 addPath("${srcDir}/gfx/util")
 addPath("${srcDir}/gfx/video")
 addPath("${srcDir}/gfx")
@@ -229,17 +232,23 @@ addPath("${srcDir}/materials")
 addPath("${srcDir}/lighting")
 addPath("${srcDir}/lighting/common")
 addPath("${srcDir}/renderInstance")
+addPath("${srcDir}/renderInstance/test")
 addPath("${srcDir}/scene")
 addPath("${srcDir}/scene/culling")
 addPath("${srcDir}/scene/zones")
 addPath("${srcDir}/scene/mixin")
+addPath("${srcDir}/scene/test")
 addPath("${srcDir}/shaderGen")
+addPath("${srcDir}/shaderGen/test")
 addPath("${srcDir}/terrain")
+addPath("${srcDir}/terrain/test")
 addPath("${srcDir}/environment")
 addPath("${srcDir}/forest")
 addPath("${srcDir}/forest/ts")
+addPath("${srcDir}/forest/test")
 addPath("${srcDir}/ts")
 addPath("${srcDir}/ts/arch")
+addPath("${srcDir}/ts/test")
 addPath("${srcDir}/physics")
 addPath("${srcDir}/gui/3d")
 addPath("${srcDir}/postFx")
@@ -247,9 +256,11 @@ addPath("${srcDir}/T3D")
 addPath("${srcDir}/T3D/examples")
 addPath("${srcDir}/T3D/fps")
 addPath("${srcDir}/T3D/fx")
+addPath("${srcDir}/T3D/fx/test")
 addPath("${srcDir}/T3D/vehicles")
 addPath("${srcDir}/T3D/physics")
 addPath("${srcDir}/T3D/decal")
+addPath("${srcDir}/T3D/decal/test")
 addPath("${srcDir}/T3D/sfx")
 addPath("${srcDir}/T3D/gameBase")
 addPath("${srcDir}/T3D/turret")